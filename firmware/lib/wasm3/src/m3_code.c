@@ -28,20 +28,8 @@ IM3CodePage  NewCodePage  (u32 i_minNumLines)
         page->info.numLines = (pageSize - sizeof (M3CodePageHeader)) / sizeof (code_t);
 
 #if d_m3RecordBacktraces
-        u32 pageSizeBt = sizeof (M3CodeMappingPage) + sizeof (M3CodeMapEntry) * page->info.numLines;
-        page->info.mapping = (M3CodeMappingPage *)m3_Malloc (pageSizeBt);
-
-        if (page->info.mapping)
-        {
-            page->info.mapping->size = 0;
-            page->info.mapping->capacity = page->info.numLines;
-        }
-        else
-        {
-            m3_Free (page);
-            return NULL;
-        }
-        page->info.mapping->basePC = GetPageStartPC(page);
+        // allocated by the first EmitMappingEntry(), for runtimes that map
+        page->info.mapping = NULL;
 #endif // d_m3RecordBacktraces
 
         m3log (runtime, "new page: %p; seq: %d; bytes: %d; lines: %d", GetPagePC (page), page->info.sequence, pageSize, page->info.numLines);
@@ -107,6 +95,21 @@ void  EmitWord64  (IM3CodePage i_page, const u64 i_word)
 void  EmitMappingEntry  (IM3CodePage i_page, u32 i_moduleOffset)
 {
     M3CodeMappingPage * page = i_page->info.mapping;
+
+    if (not page)
+    {
+        // 8 bytes per code line: only runtimes with mapCode set pay for it.
+        // On failure this page's ops just go unmapped.
+        u32 pageSizeBt = sizeof (M3CodeMappingPage) + sizeof (M3CodeMapEntry) * i_page->info.numLines;
+        page = (M3CodeMappingPage *)m3_Malloc (pageSizeBt);
+        if (not page)
+            return;
+
+        page->basePC = GetPageStartPC (i_page);
+        page->size = 0;
+        page->capacity = i_page->info.numLines;
+        i_page->info.mapping = page;
+    }
                                                                         d_m3Assert (page->size < page->capacity);
 
     M3CodeMapEntry * entry = & page->entries[page->size++];
@@ -193,6 +196,9 @@ bool  MapPCToOffset  (IM3CodePage i_page, pc_t i_pc, u32 * o_moduleOffset)
 {
     M3CodeMappingPage * mapping = i_page->info.mapping;
 
+    if (not mapping)
+        return false;
+
     u32 pcOffset = i_pc - mapping->basePC;
 
     u32 left = 0;
@@ -2006,6 +2006,109 @@ _   (SetStackPolymorphic (o));
 }
 
 
+#if d_m3FuseOps
+// Peephole op fusion. EmitOp () asks FuseOp () before emitting each op; if
+// the op just emitted (still the last thing on the page, and not a jump
+// target) pairs with it, that op's word is rewritten to the fused op and
+// the new op's immediates follow its own. The pairs are the hottest ones
+// in `make profile`: c2wasm's loop test (i32.lt_s; i32.eqz; br_if), IF in
+// bas2wasm (i32.eqz; br_if), an add whose sum goes straight to a slot, and
+// runs of slot copies and global stores.
+
+typedef struct M3FusedCompare
+{
+    IM3Operation    compare;
+    IM3Operation    inverse;        // for a following i32.eqz
+    IM3Operation    branchIf;       // for a following br_if
+}
+M3FusedCompare;
+
+#define d_m3FusedCmp(TYPE, NAME, INVERSE, FORM) \
+    { op_##TYPE##_##NAME##_##FORM, op_##TYPE##_##INVERSE##_##FORM, op_BranchIf_##TYPE##_##NAME##_##FORM }
+
+#define d_m3FusedCmpList(TYPE, NAME, INVERSE) \
+    d_m3FusedCmp (TYPE, NAME, INVERSE, rs), d_m3FusedCmp (TYPE, NAME, INVERSE, sr), d_m3FusedCmp (TYPE, NAME, INVERSE, ss)
+
+static const M3FusedCompare c_fusedCompares [] =
+{
+    d_m3FusedCmp (i32, Equal, NotEqual, rs),        d_m3FusedCmp (i32, Equal, NotEqual, ss),
+    d_m3FusedCmp (i32, NotEqual, Equal, rs),        d_m3FusedCmp (i32, NotEqual, Equal, ss),
+
+    d_m3FusedCmpList (i32, LessThan, GreaterThanOrEqual),   d_m3FusedCmpList (u32, LessThan, GreaterThanOrEqual),
+    d_m3FusedCmpList (i32, GreaterThan, LessThanOrEqual),   d_m3FusedCmpList (u32, GreaterThan, LessThanOrEqual),
+    d_m3FusedCmpList (i32, LessThanOrEqual, GreaterThan),   d_m3FusedCmpList (u32, LessThanOrEqual, GreaterThan),
+    d_m3FusedCmpList (i32, GreaterThanOrEqual, LessThan),   d_m3FusedCmpList (u32, GreaterThanOrEqual, LessThan),
+};
+
+static const M3FusedCompare * FindFusedCompare (IM3Operation i_operation)
+{
+    for (u32 i = 0; i < sizeof (c_fusedCompares) / sizeof (c_fusedCompares [0]); ++i)
+    {
+        if (c_fusedCompares [i].compare == i_operation)
+            return & c_fusedCompares [i];
+    }
+
+    return NULL;
+}
+
+
+bool  FuseOp  (IM3Compilation o, IM3Operation i_operation)
+{
+    pc_t pc = o->fusePC;
+    o->fusePC = NULL;
+
+    if (not pc or o->page != o->fusePage)
+        return false;
+
+    IM3Operation * last = (IM3Operation *) pc;
+    IM3Operation fused = NULL;
+
+    if (i_operation == op_i32_EqualToZero_r)
+    {
+        const M3FusedCompare * compare = FindFusedCompare (* last);
+
+        if (compare)
+        {
+            // integer compares have exact inverses: drop the eqz, and keep
+            // watching the compare in case a br_if follows
+            * last = compare->inverse;
+            o->fusePC = pc;
+            return true;
+        }
+    }
+    else if (i_operation == op_BranchIf_r)
+    {
+        const M3FusedCompare * compare = FindFusedCompare (* last);
+
+        if (compare)                                fused = compare->branchIf;
+        else if (* last == op_i32_EqualToZero_r)    fused = op_BranchIfNot_r;
+        else if (* last == op_i32_EqualToZero_s)    fused = op_BranchIfNot_s;
+    }
+    else if (i_operation == op_SetSlot_i32)
+    {
+        if (* last == op_i32_Add_rs)                fused = op_i32_AddSetSlot_rs;
+        else if (* last == op_i32_Add_ss)           fused = op_i32_AddSetSlot_ss;
+    }
+    else if (i_operation == op_CopySlot_32 and * last == op_CopySlot_32)
+    {
+        fused = op_CopySlot2_32;
+    }
+    else if (i_operation == op_SetGlobal_s32 and * last == op_SetGlobal_s32)
+    {
+        fused = op_SetGlobal2_s32;
+    }
+
+    if (fused)
+    {                                                           m3log (emit, "fused into %p at: %p", fused, pc);
+        * last = fused;
+        return true;
+    }
+
+    return false;
+}
+#endif // d_m3FuseOps
+
+
 // OPTZ: currently all stack slot indices take up a full word, but
 // dual stack source operands could be packed together
 M3Result  Compile_Operator  (IM3Compilation o, m3opcode_t i_opcode)
@@ -2407,6 +2510,11 @@ const M3OpInfo c_operations [] =
     d_m3DebugTypedOp (SetGlobal),   d_m3DebugOp (SetGlobal_s32),    d_m3DebugOp (SetGlobal_s64),
 
     d_m3DebugTypedOp (SetRegister), d_m3DebugTypedOp (SetSlot),     d_m3DebugTypedOp (PreserveSetSlot),
+
+# if d_m3FuseOps
+    d_m3DebugOp (BranchIfNot_r),    d_m3DebugOp (BranchIfNot_s),    d_m3DebugOp (CopySlot2_32),     d_m3DebugOp (SetGlobal2_s32),
+    d_m3DebugOp (i32_AddSetSlot_rs), d_m3DebugOp (i32_AddSetSlot_ss),
+# endif
 # endif
 
 # ifdef d_m3EnableExtendedOpcodes
@@ -2550,7 +2658,7 @@ M3Result  CompileBlock  (IM3Compilation o, IM3FuncType i_blockType, m3opcode_t i
     M3CompilationScope * block = & o->block;
 
     block->outer            = & outerScope;
-    block->pc               = GetPagePC (o->page);
+    block->pc               = GetPC (o);
     block->patches          = NULL;
     block->type             = i_blockType;
     block->depth            ++;
@@ -110,6 +110,11 @@ typedef struct
     u16                 regStackIndexPlusOne        [2];
 
     m3opcode_t          previousOpcode;
+
+#if d_m3FuseOps
+    IM3CodePage         fusePage;                   // where the last op was emitted, for FuseOp ()
+    pc_t                fusePC;                     // NULL once GetPC () has made the next op a jump target
+#endif
 }
 M3Compilation;
 
@@ -176,6 +181,9 @@ bool        IsFpRegisterSlotAlias       (u16 i_slot);
 bool        IsIntRegisterSlotAlias      (u16 i_slot);
 
 bool        IsStackPolymorphic          (IM3Compilation o);
+#if d_m3FuseOps
+bool        FuseOp                      (IM3Compilation o, IM3Operation i_operation);
+#endif
 
 M3Result    CompileBlock                (IM3Compilation io, IM3FuncType i_blockType, m3opcode_t i_blockOpcode);
 
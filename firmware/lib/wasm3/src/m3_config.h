@@ -66,7 +66,7 @@
 # endif
 
 # ifndef d_m3RecordBacktraces
-#   define d_m3RecordBacktraces                 0
+#   define d_m3RecordBacktraces                 1       // only runtimes with mapCode set map their code
 # endif
 
 # ifndef d_m3EnableExceptionBreakpoint
@@ -77,7 +77,8 @@
 // profiling and tracing ------------------------------------------------------
 
 # ifndef d_m3EnableOpProfiling
-#   define d_m3EnableOpProfiling                0       // opcode usage counters
+#   define d_m3EnableOpProfiling                0       // 1 - opcode usage counters
+                                                        // 2 - also counts of consecutive op pairs
 # endif
 
 # ifndef d_m3EnableOpTracing
@@ -152,4 +153,20 @@
 #   define d_m3PsramDramWindow           4096    // bytes of DRAM fast-path at start of linear memory
 # endif
 
+# ifndef d_m3PsramTlbEntries
+#   define d_m3PsramTlbEntries           8       // direct-mapped TLB of pinned PSRAM cache pages (power of 2, 0 = off)
+# endif
+
+# ifndef d_m3PsramTlbPageSize
+#   define d_m3PsramTlbPageSize          512     // must equal the platform's PSRAM cache page size
+# endif
+
+# ifndef d_m3FuelQuantum
+#   define d_m3FuelQuantum               4096    // loop back-edges + calls between m3_Yield() checks
+# endif
+
+# ifndef d_m3FuseOps
+#   define d_m3FuseOps                   1       // peephole-fuse hot op pairs at compile time (see FuseOp)
+# endif
+
 #endif // m3_config_h
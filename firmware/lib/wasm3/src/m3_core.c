@@ -24,6 +24,16 @@ M3Result m3_Yield ()
     return m3Err_none;
 }
 
+M3_WEAK
+void m3_LockEnvironment (IM3Environment i_environment)
+{
+}
+
+M3_WEAK
+void m3_UnlockEnvironment (IM3Environment i_environment)
+{
+}
+
 #if d_m3FixedHeap
 
 static u8 fixedHeap[d_m3FixedHeap];
@@ -538,8 +548,8 @@ u32  FindModuleOffset  (IM3Runtime i_runtime, pc_t i_pc)
     {
         u32 result = 0;
 
-        bool pcFound = MapPCToOffset (curr, i_pc, & result);
-                                                                                d_m3Assert (pcFound);
+        // not found when the runtime doesn't map its code (mapCode)
+        MapPCToOffset (curr, i_pc, & result);
 
         return result;
     }
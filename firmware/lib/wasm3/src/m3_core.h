@@ -129,6 +129,19 @@ typedef void /*const*/ *                    code_t;
 typedef code_t const * /*__restrict__*/     pc_t;
 
 
+#if d_m3UsePsramMemory && d_m3PsramTlbEntries > 0
+// Software TLB entry: a PSRAM page (virtual address / d_m3PsramTlbPageSize)
+// mapped to the DRAM of the cache line it is pinned in. 0 = empty, since
+// PSRAM virtual addresses never start at page 0.
+typedef struct M3PsramTlbEntry
+{
+    uint32_t        page;           // mapped for loads
+    uint32_t        wpage;          // == page once pinned for stores too
+    uint8_t *       data;
+}
+M3PsramTlbEntry;
+#endif
+
 typedef struct M3MemoryHeader
 {
     IM3Runtime      runtime;
@@ -137,6 +150,10 @@ typedef struct M3MemoryHeader
 #if d_m3UsePsramMemory
     uint32_t        psram_addr;     // PSRAM virtual address of data beyond DRAM window
     uint8_t *       dram_buf;       // DRAM fast-path for first d_m3PsramDramWindow bytes
+    uint32_t        psram_yield_ctr;    // loads/stores since the last d_m3PsramYield() yield
+# if d_m3PsramTlbEntries > 0
+    M3PsramTlbEntry tlb [d_m3PsramTlbEntries];  // zeroed = empty; m3_psram_tlb_release() before psram_addr changes
+# endif
 #endif
     bool            prealloc;       // externally owned — ResizeMemory clones instead of realloc/free
 }
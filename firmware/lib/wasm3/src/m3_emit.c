@@ -53,6 +53,11 @@ M3Result  EmitOp  (IM3Compilation o, IM3Operation i_operation)
     // it's OK for page to be null; when compile-walking the bytecode without emitting
     if (o->page)
     {
+# if d_m3FuseOps
+        if (FuseOp (o, i_operation))
+            return m3Err_none;
+# endif
+
 # if d_m3EnableOpTracing
         if (i_operation != op_DumpStack)
             o->numEmits++;
@@ -63,8 +68,13 @@ M3Result  EmitOp  (IM3Compilation o, IM3Operation i_operation)
         if (not result)
         {                                                           if (d_m3LogEmit) log_emit (o, i_operation);
 # if d_m3RecordBacktraces
-            EmitMappingEntry (o->page, o->lastOpcodeStart - o->module->wasmStart);
+            if (o->runtime->mapCode)
+                EmitMappingEntry (o->page, o->lastOpcodeStart - o->module->wasmStart);
 # endif // d_m3RecordBacktraces
+# if d_m3FuseOps
+            o->fusePage = o->page;
+            o->fusePC = GetPagePC (o->page);
+# endif
             EmitWord (o->page, i_operation);
         }
     }
@@ -105,7 +115,11 @@ void * ReservePointer (IM3Compilation o)
 }
 
 
+// the next op's pc is only taken to jump to it, so that op must not be fused into the last
 pc_t GetPC (IM3Compilation o)
 {
+# if d_m3FuseOps
+    o->fusePC = NULL;
+# endif
     return GetPagePC (o->page);
 }
@@ -87,6 +87,8 @@ void  m3_FreeEnvironment  (IM3Environment i_environment)
 // returns the same io_funcType or replaces it with an equivalent that's already in the type linked list
 void  Environment_AddFuncType  (IM3Environment i_environment, IM3FuncType * io_funcType)
 {
+    m3_LockEnvironment (i_environment);
+
     IM3FuncType addType = * io_funcType;
     IM3FuncType newType = i_environment->funcTypes;
 
@@ -109,6 +111,8 @@ void  Environment_AddFuncType  (IM3Environment i_environment, IM3FuncType * io_f
     }
 
     * io_funcType = newType;
+
+    m3_UnlockEnvironment (i_environment);
 }
 
 
@@ -140,7 +144,11 @@ IM3CodePage RemoveCodePageOfCapacity (M3CodePage ** io_list, u32 i_minimumLineCo
 
 IM3CodePage  Environment_AcquireCodePage (IM3Environment i_environment, u32 i_minimumLineCount)
 {
-    return RemoveCodePageOfCapacity (& i_environment->pagesReleased, i_minimumLineCount);
+    m3_LockEnvironment (i_environment);
+    IM3CodePage page = RemoveCodePageOfCapacity (& i_environment->pagesReleased, i_minimumLineCount);
+    m3_UnlockEnvironment (i_environment);
+
+    return page;
 }
 
 
@@ -152,7 +160,8 @@ void  Environment_ReleaseCodePages  (IM3Environment i_environment, IM3CodePage i
     {
         end->info.lineIndex = 0; // reset page
 #if d_m3RecordBacktraces
-        end->info.mapping->size = 0;
+        if (end->info.mapping)
+            end->info.mapping->size = 0;
 #endif // d_m3RecordBacktraces
 
         IM3CodePage next = end->info.next;
@@ -165,8 +174,10 @@ void  Environment_ReleaseCodePages  (IM3Environment i_environment, IM3CodePage i
     if (end)
     {
         // push list to front
+        m3_LockEnvironment (i_environment);
         end->info.next = i_environment->pagesReleased;
         i_environment->pagesReleased = i_codePageList;
+        m3_UnlockEnvironment (i_environment);
     }
 }
 
@@ -181,6 +192,7 @@ IM3Runtime  m3_NewRuntime  (IM3Environment i_environment, u32 i_stackSizeInBytes
 
         runtime->environment = i_environment;
         runtime->userdata = i_userdata;
+        runtime->fuel = d_m3FuelQuantum;
 
         runtime->stack = m3_Malloc (i_stackSizeInBytes + 4*sizeof (m3slot_t)); // TODO: more precise stack checks
 
@@ -235,6 +247,10 @@ void  Runtime_Release  (IM3Runtime i_runtime)
     Environment_ReleaseCodePages (i_runtime->environment, i_runtime->pagesFull);
 
     m3_Free (i_runtime->stack);
+#if d_m3UsePsramMemory
+    if (i_runtime->memory.mallocated)
+        m3_psram_tlb_release (i_runtime->memory.mallocated);    // prealloc too: its pins are ours
+#endif
     if (i_runtime->memory.mallocated && !i_runtime->memory.mallocated->prealloc)
     {
 #if d_m3UsePsramMemory
@@ -307,7 +323,9 @@ M3Result  EvaluateExpression  (IM3Module i_module, void * o_expressed, u8 i_type
 
         if (not result)
         {
-            m3ret_t r = Call (m3code, stack, NULL, d_m3OpDefaultArgs);
+            // straight into the code: there's no memory (and so no runtime)
+            // to burn fuel against, and a constant expression can't loop
+            m3ret_t r = ((IM3Operation) (* m3code)) (m3code + 1, stack, NULL, d_m3OpDefaultArgs);
 
             if (r == 0)
             {                                                                               m3log (runtime, "expression result: %s", SPrintValue (stack, i_type));
@@ -405,14 +423,16 @@ M3Result  ResizeMemory  (IM3Runtime io_runtime, u32 i_numPages)
                 memcpy (new_dram, memory->mallocated->dram_buf, d_m3PsramDramWindow);
                 newHdr->dram_buf = new_dram;
 
-                // Clone PSRAM (allocate larger, copy old data)
+                // Clone PSRAM (allocate larger, copy old data, zero the grown pages)
                 if (psram_bytes) {
                     uint32_t pa = m3_psram_alloc (psram_bytes);
                     if (pa == 0) { m3_Free (new_dram); m3_Free (newHdr); _throw ("psram alloc failed"); }
-                    size_t old_psram = memory->mallocated->length - d_m3PsramDramWindow;
-                    if (old_psram && memory->mallocated->psram_addr)
-                        m3_psram_memcpy (pa, memory->mallocated->psram_addr,
-                                         old_psram < psram_bytes ? old_psram : psram_bytes);
+                    size_t keep = 0;
+                    if (memory->mallocated->psram_addr && memory->mallocated->length > d_m3PsramDramWindow)
+                        keep = M3_MIN (memory->mallocated->length - d_m3PsramDramWindow, psram_bytes);
+                    if (keep)
+                        m3_psram_memcpy (pa, memory->mallocated->psram_addr, keep);
+                    m3_psram_memset (pa + keep, 0, psram_bytes - keep);
                     newHdr->psram_addr = pa;
                 }
 
@@ -420,6 +440,7 @@ M3Result  ResizeMemory  (IM3Runtime io_runtime, u32 i_numPages)
                 newHdr->runtime  = io_runtime;
                 newHdr->maxStack = (m3slot_t *) io_runtime->stack + io_runtime->numStackSlots;
                 newHdr->prealloc = false;
+                m3_psram_tlb_release (memory->mallocated);
                 memory->mallocated = newHdr;
             }
             else
@@ -445,17 +466,28 @@ M3Result  ResizeMemory  (IM3Runtime io_runtime, u32 i_numPages)
                 memset (memory->mallocated->dram_buf, 0, d_m3PsramDramWindow);
             }
 
-            // PSRAM — free old and allocate new (size changes on grow)
-            if (memory->mallocated->psram_addr) {
-                m3_psram_free (memory->mallocated->psram_addr);
-                memory->mallocated->psram_addr = 0;
-            }
-
+            // PSRAM — allocate at the new size, carry the old contents over
+            // and zero the rest, then free the old block (size changes on
+            // grow). The allocator hands back stale data, and compilers
+            // leave zero runs out of data segments: linear memory must
+            // start, and grow, zeroed.
+            uint32_t pa = 0;
             if (psram_bytes) {
-                uint32_t pa = m3_psram_alloc (psram_bytes);
+                pa = m3_psram_alloc (psram_bytes);
                 _throwif ("psram alloc failed", pa == 0);
-                memory->mallocated->psram_addr = pa;
+                size_t keep = 0;
+                if (memory->mallocated->psram_addr && memory->mallocated->length > d_m3PsramDramWindow)
+                    keep = M3_MIN (memory->mallocated->length - d_m3PsramDramWindow, psram_bytes);
+                if (keep)
+                    m3_psram_memcpy (pa, memory->mallocated->psram_addr, keep);
+                m3_psram_memset (pa + keep, 0, psram_bytes - keep);
+            }
+
+            if (memory->mallocated->psram_addr) {
+                m3_psram_tlb_release (memory->mallocated);
+                m3_psram_free (memory->mallocated->psram_addr);
             }
+            memory->mallocated->psram_addr = pa;
 
             memory->mallocated->length   = numPageBytes;
             memory->mallocated->runtime  = io_runtime;
@@ -172,6 +172,8 @@ typedef struct M3Runtime
     M3Memory                memory;
     u32                     memoryLimit;
 
+    i32                     fuel;           // back-edges/calls left before the next m3_Yield()
+
 #if d_m3EnableStrace >= 2
     u32                     callDepth;
 #endif
@@ -183,6 +185,8 @@ typedef struct M3Runtime
 
 #if d_m3RecordBacktraces
     M3BacktraceInfo         backtrace;
+    bool                    mapCode;        // record each op's module offset as it compiles,
+                                            // so traps can report one; set before compiling
 #endif
 }
 M3Runtime;
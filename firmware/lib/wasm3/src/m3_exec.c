@@ -14,6 +14,42 @@
 //--------------------------------------------------------------------------------------------------------
 static M3ProfilerSlot s_opProfilerCounts [d_m3ProfilerSlotMask + 1] = {};
 
+# if d_m3EnableOpProfiling >= 2
+// Pairs of consecutively executed ops: the candidates for fused operations.
+// Open addressing, since a pair has no single pointer to index by.
+typedef struct M3ProfilerPair
+{
+    cstr_t      first;
+    cstr_t      second;
+    u64         hitCount;
+}
+M3ProfilerPair;
+
+static M3ProfilerPair s_opPairCounts [d_m3ProfilerSlotMask + 1] = {};
+static cstr_t s_lastOpName = NULL;
+
+static void  ProfilePair  (cstr_t i_first, cstr_t i_second)
+{
+    u64 hash = ((u64) i_first * 31) ^ (u64) i_second;
+
+    for (u32 n = 0; n <= d_m3ProfilerSlotMask; ++n)
+    {
+        M3ProfilerPair * pair = & s_opPairCounts [(hash + n) & d_m3ProfilerSlotMask];
+
+        if (not pair->first)
+        {
+            pair->first = i_first;
+            pair->second = i_second;
+        }
+        if (pair->first == i_first and pair->second == i_second)
+        {
+            pair->hitCount++;
+            return;
+        }
+    }
+}
+# endif
+
 void  ProfileHit  (cstr_t i_operationName)
 {
     u64 ptr = (u64) i_operationName;
@@ -30,6 +66,12 @@ void  ProfileHit  (cstr_t i_operationName)
 
     slot->opName = i_operationName;
     slot->hitCount++;
+
+# if d_m3EnableOpProfiling >= 2
+    if (s_lastOpName)
+        ProfilePair (s_lastOpName, i_operationName);
+    s_lastOpName = i_operationName;
+# endif
 }
 
 
@@ -60,6 +102,32 @@ void  m3_PrintProfilerInfo  ()
         }
     }
     while (maxSlot->hitCount);
+
+# if d_m3EnableOpProfiling >= 2
+    fprintf (stderr, "\n");
+
+    for (u32 shown = 0; shown < 40; ++shown)
+    {
+        M3ProfilerPair * maxPair = NULL;
+
+        for (u32 i = 0; i <= d_m3ProfilerSlotMask; ++i)
+        {
+            M3ProfilerPair * pair = & s_opPairCounts [i];
+
+            if (pair->hitCount and (not maxPair or pair->hitCount > maxPair->hitCount))
+                maxPair = pair;
+        }
+
+        if (not maxPair)
+            break;
+
+        fprintf (stderr, "%13llu  %s -> %s\n", maxPair->hitCount, maxPair->first, maxPair->second);
+        maxPair->hitCount = 0;
+    }
+
+    memset (s_opPairCounts, 0, sizeof (s_opPairCounts));
+    s_lastOpName = NULL;
+# endif
 }
 
 # else
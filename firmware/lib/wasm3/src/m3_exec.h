@@ -48,16 +48,18 @@ d_m3BeginExternC
 
 # if d_m3EnableOpProfiling
                                     d_m3RetSig  profileOp   (d_m3OpSig, cstr_t i_operationName);
+                                    d_m3RetSig  profileJumpOp (d_m3OpSig, pc_t i_target, cstr_t i_operationName);
 #   define nextOp()                 return profileOp (d_m3OpAllArgs, __FUNCTION__)
+#   define jumpOp(PC)               return profileJumpOp (d_m3OpAllArgs, (pc_t)(PC), __FUNCTION__)
 # elif d_m3EnableOpTracing
                                     d_m3RetSig  debugOp     (d_m3OpSig, cstr_t i_operationName);
 #   define nextOp()                 return debugOp (d_m3OpAllArgs, __FUNCTION__)
+#   define jumpOp(PC)               jumpOpDirect(PC)
 # else
 #   define nextOp()                 nextOpDirect()
+#   define jumpOp(PC)               jumpOpDirect(PC)
 # endif
 
-#define jumpOp(PC)                  jumpOpDirect(PC)
-
 #if d_m3RecordBacktraces
     #define pushBacktraceFrame()            (PushBacktraceFrame (_mem->runtime, _pc - 1))
     #define fillBacktraceFrame(FUNCTION)    (FillBacktraceFunctionInfo (_mem->runtime, function))
@@ -110,10 +112,21 @@ d_m3BeginExternC
 #endif
 
 
+// Execution budget. Every call and every loop back-edge burns one unit of
+// the runtime's fuel; when it runs out, m3_Yield() gets to yield the CPU or
+// stop the program. Code between two of these points is straight-line, so
+// the time between checks stays bounded even in loops that make no calls.
+#define d_m3BurnFuel()                                      \
+    if (UNLIKELY(--_mem->runtime->fuel <= 0)) {             \
+        _mem->runtime->fuel = d_m3FuelQuantum;              \
+        m3ret_t _yld = m3_Yield ();                         \
+        if (UNLIKELY(_yld)) return _yld;                    \
+    }
+
+
 d_m3RetSig  Call  (d_m3OpSig)
 {
-    m3ret_t possible_trap = m3_Yield ();
-    if (UNLIKELY(possible_trap)) return possible_trap;
+    d_m3BurnFuel ();
 
     nextOpDirect();
 }
@@ -707,7 +720,47 @@ d_m3Op  (MemGrow)
 
 
 // Abstract memory access — routes through PSRAM or direct DRAM
-#if d_m3UsePsramMemory
+#if d_m3UsePsramMemory && d_m3PsramTlbEntries > 0
+// Hot-path: inline DRAM branch for first d_m3PsramDramWindow bytes. Past it,
+// a direct-mapped software TLB of PSRAM cache pages pinned in DRAM: a hit is
+// a tag compare and a memcpy from the page; misses and page-straddling
+// accesses take the locked path through the PSRAM cache (m3_psram_tlb_*).
+// Individual loads/stores (1/2/4/8 bytes) can't straddle the 4KB-aligned boundary.
+# define d_m3PsramTlbSlot(mem, va)   (&(mem)->tlb [((va) / d_m3PsramTlbPageSize) & (d_m3PsramTlbEntries - 1)])
+# define m3MemRead(mem, off, buf, sz) do {                                      \
+    u32 _off = (u32)(off);                                                      \
+    if (LIKELY(_off < d_m3PsramDramWindow))                                     \
+        memcpy((buf), (mem)->dram_buf + _off, (sz));                            \
+    else {                                                                      \
+        u32 _va = (mem)->psram_addr + (_off - d_m3PsramDramWindow);             \
+        u32 _po = _va & (d_m3PsramTlbPageSize - 1);                             \
+        M3PsramTlbEntry * _e = d_m3PsramTlbSlot (mem, _va);                     \
+        if (LIKELY(_e->page == _va / d_m3PsramTlbPageSize &&                    \
+                   _po + (sz) <= d_m3PsramTlbPageSize))                         \
+            memcpy((buf), _e->data + _po, (sz));                                \
+        else                                                                    \
+            m3_psram_tlb_read((mem), _va, (uint8_t*)(buf), (sz));               \
+    }                                                                           \
+} while(0)
+# define m3MemWrite(mem, off, buf, sz) do {                                     \
+    u32 _off = (u32)(off);                                                      \
+    if (LIKELY(_off < d_m3PsramDramWindow))                                     \
+        memcpy((mem)->dram_buf + _off, (buf), (sz));                            \
+    else {                                                                      \
+        u32 _va = (mem)->psram_addr + (_off - d_m3PsramDramWindow);             \
+        u32 _po = _va & (d_m3PsramTlbPageSize - 1);                             \
+        M3PsramTlbEntry * _e = d_m3PsramTlbSlot (mem, _va);                     \
+        if (LIKELY(_e->wpage == _va / d_m3PsramTlbPageSize &&                   \
+                   _po + (sz) <= d_m3PsramTlbPageSize))                         \
+            memcpy(_e->data + _po, (buf), (sz));                                \
+        else                                                                    \
+            m3_psram_tlb_write((mem), _va, (const uint8_t*)(buf), (sz));        \
+    }                                                                           \
+} while(0)
+// Bulk ops use split-aware helpers (may straddle the DRAM/PSRAM boundary).
+# define m3MemMove(mem, dst, src, sz)    m3_split_move ((mem)->dram_buf, (mem)->psram_addr, (dst), (src), (sz))
+# define m3MemSet(mem, off, val, sz)     m3_split_set  ((mem)->dram_buf, (mem)->psram_addr, (off), (val), (sz))
+#elif d_m3UsePsramMemory
 // Hot-path: inline DRAM branch for first d_m3PsramDramWindow bytes, PSRAM for the rest.
 // Individual loads/stores (1/2/4/8 bytes) can't straddle the 4KB-aligned boundary.
 # define m3MemRead(mem, off, buf, sz) do {                                      \
@@ -740,8 +793,8 @@ d_m3Op  (MemGrow)
 // when WASM programs do long runs of load/store with no function calls.
 #if d_m3UsePsramMemory
 # define d_m3PsramYield()                                   \
-    if (++m3_psram_yield_ctr >= 512) {                      \
-        m3_psram_yield_ctr = 0;                             \
+    if (++_mem->psram_yield_ctr >= 512) {                   \
+        _mem->psram_yield_ctr = 0;                          \
         m3ret_t _yld = m3_Yield ();                         \
         if (UNLIKELY(_yld)) return _yld;                    \
     }
@@ -1231,9 +1284,9 @@ d_m3Op  (ContinueLoop)
 {
     m3StackCheck();
 
-    // TODO: this is where execution can "escape" the M3 code and callback to the client / fiber switch
-    // OR it can go in the Loop operation. I think it's best to do here. adding code to the loop operation
-    // has the potential to increase its native-stack usage. (don't forget ContinueLoopIf too.)
+    // back-edges are metered here rather than in op_Loop, which would grow
+    // its native stack frame (and it nests once per loop level)
+    d_m3BurnFuel ();
 
     void * loopId = immediate (void *);
     return loopId;
@@ -1247,6 +1300,7 @@ d_m3Op  (ContinueLoopIf)
 
     if (condition)
     {
+        d_m3BurnFuel ();
         return loopId;
     }
     else nextOp ();
@@ -1325,6 +1379,131 @@ d_m3Op  (SetGlobal_f64)
 #endif
 
 
+#if d_m3FuseOps
+// Fused ops. FuseOp() in m3_compile.c emits these in place of an op pair
+// that `make profile` (firmware/test/host) finds hot in c2wasm and bas2wasm
+// output. Each keeps the immediates of both ops, in order, minus the second
+// op word, so a fused pair costs one dispatch instead of two.
+
+// i32 compare + br_if. The compare's result only fed the branch, so _r0 is
+// left alone. Immediates are the compare's slots, then the branch target.
+#define d_m3BranchIfCmpOpMacro(TYPE, NAME, OP)              \
+d_m3Op(BranchIf_##TYPE##_##NAME##_rs)                       \
+{                                                           \
+    TYPE operand = slot (TYPE);                             \
+    pc_t branch = immediate (pc_t);                         \
+    if (operand OP ((TYPE) _r0)) { jumpOp (branch); }       \
+    else nextOp ();                                         \
+}                                                           \
+d_m3Op(BranchIf_##TYPE##_##NAME##_ss)                       \
+{                                                           \
+    TYPE operand2 = slot (TYPE);                            \
+    TYPE operand1 = slot (TYPE);                            \
+    pc_t branch = immediate (pc_t);                         \
+    if (operand1 OP operand2) { jumpOp (branch); }          \
+    else nextOp ();                                         \
+}
+
+#define d_m3BranchIfCmpOp(TYPE, NAME, OP)                   \
+d_m3Op(BranchIf_##TYPE##_##NAME##_sr)                       \
+{                                                           \
+    TYPE operand = slot (TYPE);                             \
+    pc_t branch = immediate (pc_t);                         \
+    if (((TYPE) _r0) OP operand) { jumpOp (branch); }       \
+    else nextOp ();                                         \
+}                                                           \
+d_m3BranchIfCmpOpMacro(TYPE, NAME, OP)
+
+d_m3BranchIfCmpOpMacro (i32, Equal,     ==)
+d_m3BranchIfCmpOpMacro (i32, NotEqual,  !=)
+
+d_m3BranchIfCmpOp (i32, LessThan,           < )     d_m3BranchIfCmpOp (u32, LessThan,           < )
+d_m3BranchIfCmpOp (i32, GreaterThan,        > )     d_m3BranchIfCmpOp (u32, GreaterThan,        > )
+d_m3BranchIfCmpOp (i32, LessThanOrEqual,    <=)     d_m3BranchIfCmpOp (u32, LessThanOrEqual,    <=)
+d_m3BranchIfCmpOp (i32, GreaterThanOrEqual, >=)     d_m3BranchIfCmpOp (u32, GreaterThanOrEqual, >=)
+
+
+// i32.add + a move of its result to a slot: address arithmetic and
+// `i = i + 1` stored to a local. _r0 keeps the sum too, for local.tee.
+d_m3Op  (i32_AddSetSlot_rs)
+{
+    i32 operand = slot (i32);
+    i32 sum = operand + (i32) _r0;
+    _r0 = sum;
+    slot (i32) = sum;
+
+    nextOp ();
+}
+
+
+d_m3Op  (i32_AddSetSlot_ss)
+{
+    i32 operand2 = slot (i32);
+    i32 operand1 = slot (i32);
+    i32 sum = operand1 + operand2;
+    _r0 = sum;
+    slot (i32) = sum;
+
+    nextOp ();
+}
+
+
+// i32.eqz + br_if: bas2wasm's IF on a -1/0 truth value
+d_m3Op  (BranchIfNot_r)
+{
+    i32 condition   = (i32) _r0;
+    pc_t branch     = immediate (pc_t);
+
+    if (not condition)
+    {
+        jumpOp (branch);
+    }
+    else nextOp ();
+}
+
+
+d_m3Op  (BranchIfNot_s)
+{
+    i32 condition   = slot (i32);
+    pc_t branch     = immediate (pc_t);
+
+    if (not condition)
+    {
+        jumpOp (branch);
+    }
+    else nextOp ();
+}
+
+
+// Back-to-back slot copies: call arguments and block results
+d_m3Op  (CopySlot2_32)
+{
+    u32 * dst = slot_ptr (u32);
+    u32 * src = slot_ptr (u32);
+    * dst = * src;
+
+    dst = slot_ptr (u32);
+    src = slot_ptr (u32);
+    * dst = * src;
+
+    nextOp ();
+}
+
+
+// Back-to-back global stores: the stack pointer and BASIC's variables
+d_m3Op  (SetGlobal2_s32)
+{
+    u32 * global = immediate (u32 *);
+    * global = slot (u32);
+
+    global = immediate (u32 *);
+    * global = slot (u32);
+
+    nextOp ();
+}
+#endif // d_m3FuseOps
+
+
 #if d_m3SkipMemoryBoundsCheck
 #  define m3MemCheck(x) true
 #else
@@ -1533,6 +1712,14 @@ d_m3RetSig  profileOp  (d_m3OpSig, cstr_t i_operationName)
 
     nextOpDirect();
 }
+
+// taken branches and loop continues, so the pair counts see the op that follows them
+d_m3RetSig  profileJumpOp  (d_m3OpSig, pc_t i_target, cstr_t i_operationName)
+{
+    ProfileHit (i_operationName);
+
+    jumpOpDirect (i_target);
+}
 # endif
 
 d_m3EndExternC
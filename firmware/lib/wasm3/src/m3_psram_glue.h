@@ -32,9 +32,14 @@ void     m3_split_write  (uint8_t *dram_buf, uint32_t psram_addr, uint32_t offse
 void     m3_split_set    (uint8_t *dram_buf, uint32_t psram_addr, uint32_t offset, uint8_t val, uint32_t len);
 void     m3_split_move   (uint8_t *dram_buf, uint32_t psram_addr, uint32_t dst_off, uint32_t src_off, uint32_t len);
 
-// Yield counter for PSRAM load/store path — must be extern because m3_exec.h
-// is included (as static inline) in multiple translation units.
-extern uint32_t m3_psram_yield_ctr;
+// Software TLB slow paths, for loads/stores past the DRAM window whose page
+// is not mapped (or, for stores, not mapped writable), or that straddle a
+// page. addr is a PSRAM virtual address. Release unpins every mapped page:
+// call it before the header or its PSRAM block goes away.
+struct M3MemoryHeader;
+void     m3_psram_tlb_read    (struct M3MemoryHeader *mem, uint32_t addr, uint8_t *buf, size_t len);
+void     m3_psram_tlb_write   (struct M3MemoryHeader *mem, uint32_t addr, const uint8_t *buf, size_t len);
+void     m3_psram_tlb_release (struct M3MemoryHeader *mem);
 
 #ifdef __cplusplus
 }
@@ -276,6 +276,12 @@ d_m3ErrorConst  (trapStackOverflow,             "[trap] stack overflow")
 //-------------------------------------------------------------------------------------------------------------------------------
     M3Result            m3_Yield                    (void);
 
+    // An environment may be shared by runtimes running on different threads.
+    // wasm3 brackets every change to it (function types, released code pages)
+    // with these; the default (weak) versions do nothing.
+    void                m3_LockEnvironment          (IM3Environment i_environment);
+    void                m3_UnlockEnvironment        (IM3Environment i_environment);
+
     // o_function is valid during the lifetime of the originating runtime
     M3Result            m3_FindFunction             (IM3Function *          o_function,
                                                      IM3Runtime             i_runtime,
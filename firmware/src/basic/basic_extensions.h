@@ -374,25 +374,31 @@ int getNumLeds()
 
 void setLEDr(int pos, int val)
 {
-    if (pos < 0 || pos >= config.led_count1 || !leds1) return;
-    leds1[pos].r = (uint8_t)val;
+    int n;
+    CRGB *buf = led_src_buf(LED_SRC_BASIC, 1, &n);
+    if (pos < 0 || pos >= n || !buf) return;
+    buf[pos].r = (uint8_t)val;
 }
 
 void setLEDg(int pos, int val)
 {
-    if (pos < 0 || pos >= config.led_count1 || !leds1) return;
-    leds1[pos].g = (uint8_t)val;
+    int n;
+    CRGB *buf = led_src_buf(LED_SRC_BASIC, 1, &n);
+    if (pos < 0 || pos >= n || !buf) return;
+    buf[pos].g = (uint8_t)val;
 }
 
 void setLEDb(int pos, int val)
 {
-    if (pos < 0 || pos >= config.led_count1 || !leds1) return;
-    leds1[pos].b = (uint8_t)val;
+    int n;
+    CRGB *buf = led_src_buf(LED_SRC_BASIC, 1, &n);
+    if (pos < 0 || pos >= n || !buf) return;
+    buf[pos].b = (uint8_t)val;
 }
 
 void updateLEDs()
 {
-    led_show(); //Mark LED buffers dirty; render task will push via RMT
+    led_src_show(LED_SRC_BASIC); //Publish the BASIC layer; render task composes and pushes via RMT
 }
 
 unsigned long getTimestamp()
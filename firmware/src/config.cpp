@@ -99,6 +99,7 @@ static const cfg_descriptor_t cfg_table[] = {
     CFG_ENTRY("led",    "color2",       CFG_HEX,   led_color2),
     CFG_ENTRY("led",    "color3",       CFG_HEX,   led_color3),
     CFG_ENTRY("led",    "color4",       CFG_HEX,   led_color4),
+    CFG_ENTRY_R("led",  "fps",          CFG_INT,   led_fps,        1, 120),
     // [artnet]
     CFG_ENTRY("artnet", "enabled",      CFG_BOOL,  artnet_enabled),
     CFG_ENTRY_R("artnet","uni1",        CFG_INT,   artnet_uni1,    0, 32767),
@@ -109,6 +110,19 @@ static const cfg_descriptor_t cfg_table[] = {
     CFG_ENTRY_R("artnet","dmx2",        CFG_INT,   artnet_dmx2,    0, 512),
     CFG_ENTRY_R("artnet","dmx3",        CFG_INT,   artnet_dmx3,    0, 512),
     CFG_ENTRY_R("artnet","dmx4",        CFG_INT,   artnet_dmx4,    0, 512),
+    // [sacn]
+    CFG_ENTRY("sacn",   "enabled",      CFG_BOOL,  sacn_enabled),
+    CFG_ENTRY_R("sacn", "uni1",         CFG_INT,   sacn_uni1,      1, 63999),
+    CFG_ENTRY_R("sacn", "uni2",         CFG_INT,   sacn_uni2,      1, 63999),
+    CFG_ENTRY_R("sacn", "uni3",         CFG_INT,   sacn_uni3,      1, 63999),
+    CFG_ENTRY_R("sacn", "uni4",         CFG_INT,   sacn_uni4,      1, 63999),
+    CFG_ENTRY_R("sacn", "dmx1",         CFG_INT,   sacn_dmx1,      0, 512),
+    CFG_ENTRY_R("sacn", "dmx2",         CFG_INT,   sacn_dmx2,      0, 512),
+    CFG_ENTRY_R("sacn", "dmx3",         CFG_INT,   sacn_dmx3,      0, 512),
+    CFG_ENTRY_R("sacn", "dmx4",         CFG_INT,   sacn_dmx4,      0, 512),
+    // [wasm]
+    CFG_ENTRY_R("wasm", "pool_start",   CFG_HEX,   wasm_pool_start, 0x1000, 0x1000000),
+    CFG_ENTRY_R("wasm", "pool_kb",      CFG_INT,   wasm_pool_kb,   1, 256),
     // [debug]
     CFG_ENTRY("debug",  "system",       CFG_BOOL,  dbg_system),
     CFG_ENTRY("debug",  "basic",        CFG_BOOL,  dbg_basic),
@@ -133,14 +147,14 @@ static const char *CONFIG_PATH = "/config.ini";
 // Returns NULL-terminated array of "section.key" strings for tab completion.
 // Uses a static buffer — valid until the next call.
 #define CFG_KEY_NAME_MAX 32
-static char         cfg_key_buf[80][CFG_KEY_NAME_MAX];
-static const char  *cfg_key_ptrs[81];   // +1 for NULL terminator
+static char         cfg_key_buf[96][CFG_KEY_NAME_MAX];
+static const char  *cfg_key_ptrs[97];   // +1 for NULL terminator
 static bool         cfg_keys_built = false;
 
 const char * const * config_get_key_list(void)
 {
     if (!cfg_keys_built) {
-        int n = CFG_TABLE_SIZE < 80 ? CFG_TABLE_SIZE : 80;
+        int n = CFG_TABLE_SIZE < 96 ? CFG_TABLE_SIZE : 96;
         for (int i = 0; i < n; i++) {
             snprintf(cfg_key_buf[i], CFG_KEY_NAME_MAX, "%s.%s",
                      cfg_table[i].section, cfg_table[i].key);
@@ -257,6 +271,7 @@ static void config_fill_defaults(conez_config_t *cfg)
     cfg->led_color2       = DEFAULT_LED_COLOR;
     cfg->led_color3       = DEFAULT_LED_COLOR;
     cfg->led_color4       = DEFAULT_LED_COLOR;
+    cfg->led_fps          = DEFAULT_LED_FPS;
 
     cfg->artnet_enabled   = DEFAULT_ARTNET_ENABLED;
     cfg->artnet_uni1      = DEFAULT_ARTNET_UNI;
@@ -268,6 +283,19 @@ static void config_fill_defaults(conez_config_t *cfg)
     cfg->artnet_dmx3      = DEFAULT_ARTNET_DMX_OFF;
     cfg->artnet_dmx4      = DEFAULT_ARTNET_DMX_OFF;
 
+    cfg->sacn_enabled     = DEFAULT_SACN_ENABLED;
+    cfg->sacn_uni1        = DEFAULT_SACN_UNI;
+    cfg->sacn_uni2        = DEFAULT_SACN_UNI;
+    cfg->sacn_uni3        = DEFAULT_SACN_UNI;
+    cfg->sacn_uni4        = DEFAULT_SACN_UNI;
+    cfg->sacn_dmx1        = DEFAULT_SACN_DMX1;
+    cfg->sacn_dmx2        = DEFAULT_SACN_DMX_OFF;
+    cfg->sacn_dmx3        = DEFAULT_SACN_DMX_OFF;
+    cfg->sacn_dmx4        = DEFAULT_SACN_DMX_OFF;
+
+    cfg->wasm_pool_start  = DEFAULT_WASM_POOL_START;
+    cfg->wasm_pool_kb     = DEFAULT_WASM_POOL_KB;
+
     cfg->dbg_system       = DEFAULT_DBG_SYSTEM;
     cfg->dbg_basic        = DEFAULT_DBG_BASIC;
     cfg->dbg_wasm         = DEFAULT_DBG_WASM;
@@ -949,6 +977,11 @@ int cmd_config(int argc, char **argv)
             config_apply_debug();
             printfnl(SOURCE_COMMANDS, "Debug setting applied.\n");
         }
+        else if (strcasecmp(section, "led") == 0 && strcasecmp(key, "fps") == 0)
+        {
+            // The render task reads led_fps every frame
+            printfnl(SOURCE_COMMANDS, "Frame rate applied.\n");
+        }
         else
         {
             printfnl(SOURCE_COMMANDS, "Reboot to apply.\n");
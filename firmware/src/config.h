@@ -79,6 +79,7 @@
 // LED counts per channel
 #define DEFAULT_LED_COUNT       50
 #define DEFAULT_LED_COLOR       0x000000
+#define DEFAULT_LED_FPS         30      // render frames/s, aligned to the epoch clock
 
 // ArtNet
 #define DEFAULT_ARTNET_ENABLED  false
@@ -86,6 +87,16 @@
 #define DEFAULT_ARTNET_DMX1     1       // ch1 starts at DMX address 1
 #define DEFAULT_ARTNET_DMX_OFF  0       // 0 = channel disabled
 
+// sACN (E1.31)
+#define DEFAULT_SACN_ENABLED    false
+#define DEFAULT_SACN_UNI        1       // universe for each LED channel (0 is not valid)
+#define DEFAULT_SACN_DMX1       1
+#define DEFAULT_SACN_DMX_OFF    0
+
+// WASM host string pool, in each program's linear memory
+#define DEFAULT_WASM_POOL_START 0x8000
+#define DEFAULT_WASM_POOL_KB    28
+
 // Debug (true = on at boot)
 #define DEFAULT_DBG_SYSTEM      true
 #define DEFAULT_DBG_BASIC       true
@@ -165,6 +176,7 @@ typedef struct {
     int     led_color2;
     int     led_color3;
     int     led_color4;
+    int     led_fps;
 
     // [artnet]
     bool    artnet_enabled;
@@ -177,6 +189,21 @@ typedef struct {
     int     artnet_dmx3;
     int     artnet_dmx4;
 
+    // [sacn]
+    bool    sacn_enabled;
+    int     sacn_uni1;
+    int     sacn_uni2;
+    int     sacn_uni3;
+    int     sacn_uni4;
+    int     sacn_dmx1;      // DMX start address (1-512); 0 = channel disabled
+    int     sacn_dmx2;
+    int     sacn_dmx3;
+    int     sacn_dmx4;
+
+    // [wasm]
+    int     wasm_pool_start;    // linear-memory address of the string pool
+    int     wasm_pool_kb;
+
     // [debug]
     bool    dbg_system;
     bool    dbg_basic;
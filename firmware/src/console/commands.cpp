@@ -36,6 +36,7 @@
 #include "psram.h"
 #include "conez_mqtt.h"
 #include "artnet.h"
+#include "sacn.h"
 #include "inflate.h"
 #include "deflate.h"
 #include "glob.h"
@@ -3004,11 +3005,127 @@ int cmd_led(int argc, char **argv)
         return 0;
     }
 
-    // led clear — all channels to black
+    // led stats [reset] — per-channel output counters, push timing, frame clock
+    if (argc >= 2 && !strcasecmp(argv[1], "stats")) {
+        if (argc >= 3 && !strcasecmp(argv[2], "reset")) {
+            led_reset_frame_stats();
+            printfnl(SOURCE_COMMANDS, "Frame clock stats reset\n");
+            return 0;
+        }
+        led_stats st;
+        led_get_stats(&st);
+        uint8_t ts = get_time_source();
+        const char *src = "local timer";
+        if (ts == 2)      src = "GPS+PPS";
+        else if (ts == 1) src = "NTP";
+        else if (get_time_valid()) src = "build/beacon";
+        printfnl(SOURCE_COMMANDS, "LED Output:\n");
+        printfnl(SOURCE_COMMANDS, "  Frame:   %llu at %d fps  (clock: %s)\n",
+                 (unsigned long long)led_frame_number(), led_frame_rate(), src);
+        printfnl(SOURCE_COMMANDS, "  Phase:   last %+ld us  p50 %lu us  p99 %lu us  max %lu us\n",
+                 (long)st.clock.err_last_us, (unsigned long)st.clock.err_p50_us,
+                 (unsigned long)st.clock.err_p99_us, (unsigned long)st.clock.err_max_us);
+        printfnl(SOURCE_COMMANDS, "  Sched:   %lu frames  %lu missed  %lu resyncs\n",
+                 (unsigned long)st.clock.frames, (unsigned long)st.clock.missed,
+                 (unsigned long)st.clock.resyncs);
+        printfnl(SOURCE_COMMANDS, "  Push:    last %lu us  max %lu us\n",
+                 (unsigned long)st.push_last_us, (unsigned long)st.push_max_us);
+        printfnl(SOURCE_COMMANDS, "  Pushes:  %lu  (%lu full refresh)  %lu idle frames\n",
+                 (unsigned long)st.pushes, (unsigned long)st.refreshes,
+                 (unsigned long)st.idle_frames);
+        for (int ch = 0; ch < 4; ch++) {
+            printfnl(SOURCE_COMMANDS, "  Strip %d: %lu frames  %lu skipped  %lu errors  %lu timeouts\n", ch + 1,
+                     (unsigned long)st.frames[ch], (unsigned long)st.skipped[ch],
+                     (unsigned long)st.errors[ch], (unsigned long)st.timeouts[ch]);
+        }
+        return 0;
+    }
+
+    // led layers — composition order and per-layer counters
+    if (argc >= 2 && !strcasecmp(argv[1], "layers")) {
+        led_layer_info info[LED_SRC_COUNT];
+        int order[LED_SRC_COUNT];
+        for (int i = 0; i < LED_SRC_COUNT; i++) {
+            led_layer_get_info(i, &info[i]);
+            order[i] = i;
+        }
+        for (int i = 1; i < LED_SRC_COUNT; i++) {            // bottom to top
+            int x = order[i], j = i - 1;
+            while (j >= 0 && info[order[j]].priority > info[x].priority) { order[j + 1] = order[j]; j--; }
+            order[j + 1] = x;
+        }
+        printfnl(SOURCE_COMMANDS, "LED Layers (bottom to top):\n");
+        printfnl(SOURCE_COMMANDS, "  %-7s %4s  %-7s %3s  %-4s  %8s %8s\n",
+                 "Name", "Prio", "Blend", "Op", "Chan", "Frames", "Dropped");
+        for (int i = 0; i < LED_SRC_COUNT; i++) {
+            const led_layer_info *l = &info[order[i]];
+            char chans[5] = "----";
+            for (int ch = 0; ch < 4; ch++)
+                if (l->channels & (1u << ch)) chans[ch] = (char)('1' + ch);
+            if (!l->active)
+                printfnl(SOURCE_COMMANDS, "  %-7s %4d  %-7s %3d  (unused)\n",
+                         l->name, l->priority, led_blend_name(l->blend), l->opacity);
+            else
+                printfnl(SOURCE_COMMANDS, "  %-7s %4d  %-7s %3d  %-4s  %8lu %8lu\n",
+                         l->name, l->priority, led_blend_name(l->blend), l->opacity, chans,
+                         (unsigned long)l->commits, (unsigned long)l->dropped);
+        }
+        return 0;
+    }
+
+    // led layer <name> prio <n> | blend <mode> | opacity <0-255> | off
+    if (argc >= 2 && !strcasecmp(argv[1], "layer")) {
+        int src = (argc >= 3) ? led_src_parse(argv[2]) : -1;
+        if (src < 0) {
+            printfnl(SOURCE_COMMANDS, "Usage: led layer <base|cue|basic|wasm|wasm1-3|artnet|sacn> "
+                     "prio <n> | blend <replace|over|add|max> | opacity <0-255> | off\n");
+            return 1;
+        }
+        if (argc >= 4 && !strcasecmp(argv[3], "off")) {
+            led_src_release(src);
+            printfnl(SOURCE_COMMANDS, "Layer %s released\n", led_src_name(src));
+            return 0;
+        }
+        if (argc < 5) {
+            printfnl(SOURCE_COMMANDS, "Usage: led layer %s prio <n> | blend <mode> | opacity <0-255> | off\n",
+                     led_src_name(src));
+            return 1;
+        }
+        int prio = -1, blend = -1, opacity = -1;
+        if (!strcasecmp(argv[3], "prio")) {
+            prio = parse_int(argv[4]);
+            if (prio < 0) {
+                printfnl(SOURCE_COMMANDS, "Priority must be >= 0\n");
+                return 1;
+            }
+        } else if (!strcasecmp(argv[3], "blend")) {
+            blend = led_blend_parse(argv[4]);
+            if (blend < 0) {
+                printfnl(SOURCE_COMMANDS, "Unknown blend mode: %s (replace, over, add, max)\n", argv[4]);
+                return 1;
+            }
+        } else if (!strcasecmp(argv[3], "opacity")) {
+            opacity = parse_int(argv[4]);
+            if (opacity < 0 || opacity > 255) {
+                printfnl(SOURCE_COMMANDS, "Opacity must be 0-255\n");
+                return 1;
+            }
+        } else {
+            printfnl(SOURCE_COMMANDS, "Unknown layer setting: %s\n", argv[3]);
+            return 1;
+        }
+        led_layer_configure(src, prio, blend, opacity);
+        led_layer_info info;
+        led_layer_get_info(src, &info);
+        printfnl(SOURCE_COMMANDS, "Layer %s: prio %d  blend %s  opacity %d\n",
+                 info.name, info.priority, led_blend_name(info.blend), info.opacity);
+        return 0;
+    }
+
+    // led clear — release every layer and blank the base layer
     if (argc >= 2 && !strcasecmp(argv[1], "clear")) {
-        for (int ch = 0; ch < 4; ch++)
-            if (bufs[ch]) { for (int j = 0; j < counts[ch]; j++) bufs[ch][j] = CRGB::Black; }
-        led_show();
+        for (int src = 0; src < LED_SRC_COUNT; src++)
+            led_src_release(src);
         printfnl(SOURCE_COMMANDS, "All LEDs cleared\n");
         return 0;
     }
@@ -3055,13 +3172,16 @@ int cmd_led(int argc, char **argv)
         return 0;
     }
 
-    // led (no args) — show config + RGB values
+    // led (no args) — show config + RGB values of the composed output
     printfnl(SOURCE_COMMANDS, "LED Config:\n");
     for (int ch = 0; ch < 4; ch++) {
         printfnl(SOURCE_COMMANDS, "  Strip %d: %d LEDs\n", ch + 1, counts[ch]);
     }
     for (int ch = 0; ch < 4; ch++) {
         if (!bufs[ch] || counts[ch] == 0) continue;
+        CRGB *px = (CRGB *)malloc((size_t)counts[ch] * sizeof(CRGB));
+        if (!px) continue;
+        counts[ch] = led_read_output(ch + 1, px, counts[ch]);
         if (getAnsiEnabled()) {
             getLock();
             ConezStream *out = getStream();
@@ -3069,7 +3189,7 @@ int cmd_led(int argc, char **argv)
             uint8_t pr = 0, pg = 0, pb = 0;
             bool first = true;
             for (int i = 0; i < counts[ch]; i++) {
-                CRGB c = bufs[ch][i];
+                CRGB c = px[i];
                 if (first || c.r != pr || c.g != pg || c.b != pb) {
                     out->printf("\033[38;2;%d;%d;%dm", c.r, c.g, c.b);
                     pr = c.r; pg = c.g; pb = c.b;
@@ -3085,11 +3205,12 @@ int cmd_led(int argc, char **argv)
         for (int i = 0; i < counts[ch]; i++) {
             if (i % 8 == 0)
                 printfnl(SOURCE_COMMANDS, "  %3d:", i);
-            CRGB c = bufs[ch][i];
+            CRGB c = px[i];
             printfnl(SOURCE_COMMANDS, " #%02X%02X%02X", c.r, c.g, c.b);
             if (i % 8 == 7 || i == counts[ch] - 1)
                 printfnl(SOURCE_COMMANDS, "\n");
         }
+        free(px);
     }
 #else
     printfnl(SOURCE_COMMANDS, "RGB LEDs not available on this board\n");
@@ -3592,7 +3713,7 @@ int cmd_help( int argc, char **argv )
     printfnl( SOURCE_COMMANDS, "  config [set|unset|reset]           Show or change settings\n" );
     printfnl( SOURCE_COMMANDS, "  copy|cp {src} {dst}                Copy file\n" );
     printfnl( SOURCE_COMMANDS, "  cpu [80|160|240|auto|min|max]      CPU frequency / DFS control\n" );
-    printfnl( SOURCE_COMMANDS, "  cue [load|start|stop|status]       Cue timeline engine\n" );
+    printfnl( SOURCE_COMMANDS, "  cue [load|start|stop|status|stats] Cue timeline engine\n" );
     printfnl( SOURCE_COMMANDS, "  debug [off|{source} [on|off]]      Show/set debug sources\n" );
     printfnl( SOURCE_COMMANDS, "  deflate|gzip {file} [out] [level]  Compress to gzip\n" );
     printfnl( SOURCE_COMMANDS, "  del|delete|rm {file}               Delete file\n" );
@@ -3607,7 +3728,7 @@ int cmd_help( int argc, char **argv )
     printfnl( SOURCE_COMMANDS, "  hexdump {file} [count]             Hex dump (default 256)\n" );
     printfnl( SOURCE_COMMANDS, "  history                            Show command history\n" );
     printfnl( SOURCE_COMMANDS, "  inflate|gunzip {file} [output]     Decompress gzip/zlib\n" );
-    printfnl( SOURCE_COMMANDS, "  led [set|clear|count]              Show/set LED config\n" );
+    printfnl( SOURCE_COMMANDS, "  led [set|clear|count|stats|layers] Show/set LED config\n" );
     printfnl( SOURCE_COMMANDS, "  load {file}                        Receive file via serial\n" );
     printfnl( SOURCE_COMMANDS, "  log [to|save|close|stop]           Debug log buffer/file\n" );
     printfnl( SOURCE_COMMANDS, "  lora|radio [freq|power|bw|sf|...]  LoRa status or configure\n" );
@@ -3632,7 +3753,7 @@ int cmd_help( int argc, char **argv )
     printfnl( SOURCE_COMMANDS, "  uptime                             Show system uptime\n" );
     printfnl( SOURCE_COMMANDS, "  version|ver                        Show firmware version\n" );
 #ifdef INCLUDE_WASM
-    printfnl( SOURCE_COMMANDS, "  wasm [status|info <file>]          WASM runtime status/info\n" );
+    printfnl( SOURCE_COMMANDS, "  wasm [status|run|stop|info]        WASM instances status/control\n" );
 #endif
     printfnl( SOURCE_COMMANDS, "  wifi [enable|disable|ssid|pass]    WiFi status or control\n" );
     printfnl( SOURCE_COMMANDS, "  winamp                             Audio visualizer (ANSI)\n" );
@@ -3645,14 +3766,54 @@ int cmd_wasm(int argc, char **argv)
 {
     if (argc < 2 || !strcasecmp(argv[1], "status")) {
         printfnl(SOURCE_COMMANDS, "WASM Runtime:\n");
-        printfnl(SOURCE_COMMANDS, "  Running: %s\n", wasm_is_running() ? "yes" : "no");
-        if (wasm_is_running()) {
-            const char *p = wasm_get_current_path();
-            printfnl(SOURCE_COMMANDS, "  Module:  %s\n", (p && p[0]) ? p : "(unknown)");
+        printfnl(SOURCE_COMMANDS, "  Slot  State    CPU s   CPU %%  Mem/Budget KB  Module\n");
+        for (int i = 0; i < WASM_MAX_INSTANCES; i++) {
+            wasm_status st;
+            if (!wasm_get_status(i, &st) || (!st.running && !st.path[0])) continue;
+            // CPU share of one core since the program started
+            unsigned pct10 = st.run_ms ? (unsigned)(st.cpu_us / st.run_ms) : 0;
+            printfnl(SOURCE_COMMANDS, "  %-4d  %-7s %6.1f  %3u.%u  %5u/%-6u   %s\n",
+                     i, st.running ? "running" : "done",
+                     st.cpu_us / 1000000.0, pct10 / 10, pct10 % 10,
+                     (unsigned)(st.mem_bytes / 1024), (unsigned)(st.mem_budget / 1024), st.path);
+        }
+        // Frag %: free pool bytes held in freed blocks, out of all free bytes
+        printfnl(SOURCE_COMMANDS, "String pool:\n");
+        printfnl(SOURCE_COMMANDS, "  Slot  Used/Size KB  Peak KB  Blocks  Frag %%  Fails\n");
+        for (int i = 0; i < WASM_MAX_INSTANCES; i++) {
+            wasm_status st;
+            if (!wasm_get_status(i, &st) || !st.pool_size) continue;
+            uint32_t avail = st.pool_size - st.pool_used;
+            unsigned frag = avail ? (unsigned)((uint64_t)st.pool_free_listed * 100 / avail) : 0;
+            printfnl(SOURCE_COMMANDS, "  %-4d  %5.1f/%-6.1f  %7.1f  %6u  %5u  %5u\n",
+                     i, st.pool_used / 1024.0, st.pool_size / 1024.0, st.pool_peak / 1024.0,
+                     (unsigned)st.pool_blocks, frag, (unsigned)st.pool_fails);
         }
         return 0;
     }
 
+    if (!strcasecmp(argv[1], "run")) {
+        if (argc < 3) {
+            printfnl(SOURCE_COMMANDS, "Usage: wasm run <file.wasm> [slot [mem_kb]]\n");
+            return 1;
+        }
+        int slot   = argc >= 4 ? atoi(argv[3]) : 0;
+        int mem_kb = argc >= 5 ? atoi(argv[4]) : 0;
+        if (slot < 0 || slot >= WASM_MAX_INSTANCES) {
+            printfnl(SOURCE_COMMANDS, "Slot must be 0-%d\n", WASM_MAX_INSTANCES - 1);
+            return 1;
+        }
+        char path[64];
+        normalize_path(path, sizeof(path), argv[2]);
+        return wasm_start(slot, path, mem_kb) ? 0 : 1;
+    }
+
+    if (!strcasecmp(argv[1], "stop")) {
+        if (argc >= 3) wasm_stop(atoi(argv[2]));
+        else           wasm_request_stop();
+        return 0;
+    }
+
     if (!strcasecmp(argv[1], "info")) {
         if (argc < 3) {
             printfnl(SOURCE_COMMANDS, "Usage: wasm info <file.wasm>\n");
@@ -3672,7 +3833,7 @@ int cmd_wasm(int argc, char **argv)
         return 0;
     }
 
-    printfnl(SOURCE_COMMANDS, "Usage: wasm [status | info <file>]\n");
+    printfnl(SOURCE_COMMANDS, "Usage: wasm [status | run <file> [slot [mem_kb]] | stop [slot] | info <file>]\n");
     return 1;
 }
 #endif
@@ -3876,7 +4037,8 @@ int cmd_compile(int argc, char **argv)
 // Subcommand lists for tab completion (NULL-terminated, stored in .rodata)
 static const char * const subs_color[]  = { "on", "off", NULL };
 static const char * const subs_config[] = { "get", "set", "unset", "reset", NULL };
-static const char * const subs_cue[]    = { "load", "start", "stop", "status", NULL };
+static const char * const subs_cue[]    = { "load", "start", "stop", "status", "stats", NULL };
+static const char * const subs_cue_stats[] = { "reset", NULL };
 static const char * const subs_debug[]  = {
     "off", "system", "basic", "wasm", "commands", "shell",
     "gps", "gps_raw", "lora", "lora_raw", "lora_dist", "wifi",
@@ -3926,6 +4088,7 @@ static const char * const * tc_cue(int wordIndex, const char **words, int nWords
     if (wordIndex == 2 && nWords >= 2) {
         if (strcasecmp(words[1], "load") == 0) return TAB_COMPLETE_FILES;
         if (strcasecmp(words[1], "start") == 0) return TAB_COMPLETE_VALUE_INT;
+        if (strcasecmp(words[1], "stats") == 0) return subs_cue_stats;
     }
     return NULL;
 }
@@ -3936,7 +4099,12 @@ static const char * const subs_gps_set[] = { "baud", "rate", "mode", "nmea", NUL
 static const char * const subs_gps_restart[] = { "hot", "warm", "cold", "factory", NULL };
 static const char * const subs_gps_mode[] = { "gps", "bds", "glonass", "gps+bds",
                                               "gps+glonass", "bds+glonass", "all", NULL };
-static const char * const subs_led[]    = { "set", "clear", "count", NULL };
+static const char * const subs_led[]    = { "set", "clear", "count", "stats", "layers", "layer", NULL };
+static const char * const subs_led_stats[] = { "reset", NULL };
+static const char * const subs_led_layer[] = { "base", "cue", "basic", "wasm", "wasm1", "wasm2", "wasm3",
+                                               "artnet", "sacn", NULL };
+static const char * const subs_led_layer_set[] = { "prio", "blend", "opacity", "off", NULL };
+static const char * const subs_led_blend[] = { "replace", "over", "add", "max", NULL };
 static const char * const subs_lora[]   = { "on", "off", "scan", "freq", "power", "bw", "sf", "cr", "mode",
                                             "save", "restart", "send", NULL };
 static const char * const subs_lora_mode[] = { "lora", "fsk", NULL };
@@ -3953,11 +4121,13 @@ static const char * const * tc_log(int wordIndex, const char **words, int nWords
 
 static const char * const subs_artnet[] = { "enable", "disable", "start", "stop",
                                             "universe", "dmx", NULL };
+static const char * const subs_sacn[]   = { "enable", "disable", "start", "stop",
+                                            "universe", "dmx", NULL };
 static const char * const subs_mqtt[]   = { "broker", "port", "user", "pass", "enable",
                                             "disable", "connect", "disconnect", "pub", NULL };
 static const char * const subs_psram[]  = { "test", "freq", "cache", NULL };
 static const char * const subs_psram_test[] = { "forever", NULL };
-static const char * const subs_wasm[]   = { "status", "info", NULL };
+static const char * const subs_wasm[]   = { "status", "run", "stop", "info", NULL };
 static const char * const subs_wifi[]   = { "enable", "disable", "ssid", "password", NULL };
 
 static const char * const * tc_artnet(int wordIndex, const char **words, int nWords) {
@@ -3983,9 +4153,15 @@ static int cmd_artnet(int argc, char **argv)
             state = "enabled (no WiFi)";
         else
             state = "disabled";
+        dmx_stats st;
+        artnet_get_stats(&st);
         printfnl(SOURCE_COMMANDS, "ArtNet receiver: %s\n", state);
-        printfnl(SOURCE_COMMANDS, "  Packets received : %u\n", (unsigned)artnet_rx_packets());
-        printfnl(SOURCE_COMMANDS, "  LED frames applied: %u\n", (unsigned)artnet_rx_frames());
+        printfnl(SOURCE_COMMANDS, "  Packets received : %u (%u unmapped, %u invalid)\n",
+                 (unsigned)st.packets, (unsigned)st.ignored, (unsigned)st.invalid);
+        printfnl(SOURCE_COMMANDS, "  LED frames applied: %u (%u partial)\n",
+                 (unsigned)st.frames, (unsigned)st.partial);
+        printfnl(SOURCE_COMMANDS, "  Frame sync       : %s (%u ArtSync)\n",
+                 st.sync_mode ? "ArtSync" : "on complete frame", (unsigned)st.syncs);
         printfnl(SOURCE_COMMANDS, "\n  Ch  Universe  DMX start\n");
         const int unis[4]  = { config.artnet_uni1, config.artnet_uni2,
                                 config.artnet_uni3, config.artnet_uni4 };
@@ -3997,6 +4173,17 @@ static int cmd_artnet(int argc, char **argv)
             else
                 printfnl(SOURCE_COMMANDS, "  %d   %d         %d\n", ch + 1, unis[ch], dmxs[ch]);
         }
+
+        dmx_uni_stats us[DMX_MAX_UNIVERSES];
+        int nu = artnet_get_universe_stats(us, DMX_MAX_UNIVERSES);
+        if (nu > 0) {
+            printfnl(SOURCE_COMMANDS, "\n  Universe   Packets     Late     Dups     Lost    Short\n");
+            for (int i = 0; i < nu; i++)
+                printfnl(SOURCE_COMMANDS, "  %-8u %9u %8u %8u %8u %8u\n",
+                         (unsigned)us[i].universe, (unsigned)us[i].packets,
+                         (unsigned)us[i].late, (unsigned)us[i].dups,
+                         (unsigned)us[i].lost, (unsigned)us[i].short_pkts);
+        }
         printfnl(SOURCE_COMMANDS, "\nUse 'config set artnet.*' to change mapping.\n");
         return 0;
     }
@@ -4071,6 +4258,143 @@ static int cmd_artnet(int argc, char **argv)
     return 1;
 }
 
+static const char * const * tc_sacn(int wordIndex, const char **words, int nWords) {
+    if (wordIndex == 1) return subs_sacn;
+    if (wordIndex == 2 && nWords >= 2) {
+        if (strcasecmp(words[1], "universe") == 0 || strcasecmp(words[1], "dmx") == 0)
+            return TAB_COMPLETE_VALUE_INT;  // channel 1-4
+    }
+    if (wordIndex == 3 && nWords >= 3) {
+        if (strcasecmp(words[1], "universe") == 0 || strcasecmp(words[1], "dmx") == 0)
+            return TAB_COMPLETE_VALUE_INT;  // universe / DMX address
+    }
+    return NULL;
+}
+
+static int cmd_sacn(int argc, char **argv)
+{
+    if (argc == 1) {
+        const char *state;
+        if (sacn_running())
+            state = "running";
+        else if (config.sacn_enabled)
+            state = "enabled (no WiFi)";
+        else
+            state = "disabled";
+        dmx_stats st;
+        sacn_get_stats(&st);
+        printfnl(SOURCE_COMMANDS, "sACN receiver: %s\n", state);
+        printfnl(SOURCE_COMMANDS, "  Packets received : %u (%u ignored, %u invalid)\n",
+                 (unsigned)st.packets, (unsigned)st.ignored, (unsigned)st.invalid);
+        printfnl(SOURCE_COMMANDS, "  LED frames applied: %u (%u partial)\n",
+                 (unsigned)st.frames, (unsigned)st.partial);
+        printfnl(SOURCE_COMMANDS, "  Frame sync       : %s (%u sync packets)\n",
+                 st.sync_mode ? "sync packets" : "on complete frame", (unsigned)st.syncs);
+        printfnl(SOURCE_COMMANDS, "\n  Ch  Universe  DMX start\n");
+        const int unis[4]  = { config.sacn_uni1, config.sacn_uni2,
+                                config.sacn_uni3, config.sacn_uni4 };
+        const int dmxs[4]  = { config.sacn_dmx1, config.sacn_dmx2,
+                                config.sacn_dmx3, config.sacn_dmx4 };
+        for (int ch = 0; ch < 4; ch++) {
+            if (dmxs[ch] == 0)
+                printfnl(SOURCE_COMMANDS, "  %d   %d         disabled\n", ch + 1, unis[ch]);
+            else
+                printfnl(SOURCE_COMMANDS, "  %d   %d         %d\n", ch + 1, unis[ch], dmxs[ch]);
+        }
+
+        // Static: too big for the console task's stack
+        static dmx_uni_stats us[DMX_MAX_UNIVERSES];
+        static sacn_universe su[DMX_MAX_UNIVERSES];
+        int nu = sacn_get_universe_stats(us, su, DMX_MAX_UNIVERSES);
+        if (nu > 0) {
+            printfnl(SOURCE_COMMANDS, "\n  Universe   Packets     Late     Dups     Lost    Short  Src  Prio  Outranked\n");
+            for (int i = 0; i < nu; i++) {
+                int prio = (su[i].winner >= 0) ? su[i].src[su[i].winner].priority : -1;
+                printfnl(SOURCE_COMMANDS, "  %-8u %9u %8u %8u %8u %8u  %3u  %4d  %9u\n",
+                         (unsigned)us[i].universe, (unsigned)us[i].packets,
+                         (unsigned)us[i].late, (unsigned)us[i].dups,
+                         (unsigned)us[i].lost, (unsigned)us[i].short_pkts,
+                         (unsigned)su[i].sources, prio, (unsigned)su[i].outranked);
+            }
+        }
+        printfnl(SOURCE_COMMANDS, "\nUse 'config set sacn.*' to change mapping.\n");
+        return 0;
+    }
+
+    if (argc == 2 && strcasecmp(argv[1], "enable") == 0) {
+        config.sacn_enabled = true;
+        config_save();
+        sacn_start();
+        return 0;
+    }
+    if (argc == 2 && strcasecmp(argv[1], "disable") == 0) {
+        config.sacn_enabled = false;
+        config_save();
+        sacn_stop();
+        return 0;
+    }
+    if (argc == 2 && strcasecmp(argv[1], "start") == 0) {
+        sacn_start();
+        return 0;
+    }
+    if (argc == 2 && strcasecmp(argv[1], "stop") == 0) {
+        sacn_stop();
+        return 0;
+    }
+
+    // sacn universe <ch> <n>  — hot-apply universe for channel 1-4
+    if (argc == 4 && strcasecmp(argv[1], "universe") == 0) {
+        int ch  = parse_int(argv[2]);
+        int uni = parse_int(argv[3]);
+        if (ch < 1 || ch > 4) {
+            printfnl(SOURCE_COMMANDS, "Channel must be 1-4\n");
+            return 1;
+        }
+        if (uni < 1 || uni > SACN_MAX_UNIVERSE) {
+            printfnl(SOURCE_COMMANDS, "Universe must be 1-%d\n", SACN_MAX_UNIVERSE);
+            return 1;
+        }
+        int *fields[4] = { &config.sacn_uni1, &config.sacn_uni2,
+                           &config.sacn_uni3, &config.sacn_uni4 };
+        *fields[ch - 1] = uni;
+        printfnl(SOURCE_COMMANDS, "LED ch%d universe set to %d (not saved)\n", ch, uni);
+        return 0;
+    }
+
+    // sacn dmx <ch> <addr>  — hot-apply DMX start address for channel 1-4
+    if (argc == 4 && strcasecmp(argv[1], "dmx") == 0) {
+        int ch   = parse_int(argv[2]);
+        int addr = parse_int(argv[3]);
+        if (ch < 1 || ch > 4) {
+            printfnl(SOURCE_COMMANDS, "Channel must be 1-4\n");
+            return 1;
+        }
+        if (addr < 0 || addr > 512) {
+            printfnl(SOURCE_COMMANDS, "DMX address must be 0-512 (0 = disabled)\n");
+            return 1;
+        }
+        int *fields[4] = { &config.sacn_dmx1, &config.sacn_dmx2,
+                           &config.sacn_dmx3, &config.sacn_dmx4 };
+        *fields[ch - 1] = addr;
+        if (addr == 0)
+            printfnl(SOURCE_COMMANDS, "LED ch%d disabled (not saved)\n", ch);
+        else
+            printfnl(SOURCE_COMMANDS, "LED ch%d DMX start set to %d (not saved)\n", ch, addr);
+        return 0;
+    }
+
+    printfnl(SOURCE_COMMANDS, "Usage:\n");
+    printfnl(SOURCE_COMMANDS, "  sacn                      Show status, channel mapping and sources\n");
+    printfnl(SOURCE_COMMANDS, "  sacn enable               Start receiver, save enabled=on\n");
+    printfnl(SOURCE_COMMANDS, "  sacn disable              Stop receiver, save enabled=off\n");
+    printfnl(SOURCE_COMMANDS, "  sacn start                Start receiver (no config change)\n");
+    printfnl(SOURCE_COMMANDS, "  sacn stop                 Stop receiver (no config change)\n");
+    printfnl(SOURCE_COMMANDS, "  sacn universe <ch> <n>    Set universe for LED ch 1-4 (not saved)\n");
+    printfnl(SOURCE_COMMANDS, "  sacn dmx <ch> <addr>      Set DMX start addr 1-512 (0=off, not saved)\n");
+    printfnl(SOURCE_COMMANDS, "Use 'config set sacn.*' to persist changes across reboots.\n");
+    return 1;
+}
+
 static const char * const * tc_wifi(int wordIndex, const char **words, int nWords) {
     if (wordIndex == 1) return subs_wifi;
     if (wordIndex == 2 && nWords >= 2) {
@@ -4147,13 +4471,20 @@ static const char * const * tc_led(int wordIndex, const char **words, int nWords
     if (wordIndex == 2 && nWords >= 2) {
         if (strcasecmp(words[1], "set") == 0)   return TAB_COMPLETE_VALUE_INT;  // channel
         if (strcasecmp(words[1], "count") == 0) return TAB_COMPLETE_VALUE_INT;  // channel
+        if (strcasecmp(words[1], "stats") == 0) return subs_led_stats;
+        if (strcasecmp(words[1], "layer") == 0) return subs_led_layer;
     }
     if (wordIndex == 3 && nWords >= 3) {
         if (strcasecmp(words[1], "set") == 0)   return TAB_COMPLETE_VALUE;      // index/range/all
         if (strcasecmp(words[1], "count") == 0) return TAB_COMPLETE_VALUE_INT;  // count
+        if (strcasecmp(words[1], "layer") == 0) return subs_led_layer_set;
     }
     if (wordIndex == 4 && nWords >= 4) {
         if (strcasecmp(words[1], "set") == 0)   return TAB_COMPLETE_VALUE_HEX;  // #RRGGBB
+        if (strcasecmp(words[1], "layer") == 0) {
+            if (strcasecmp(words[3], "blend") == 0) return subs_led_blend;
+            if (strcasecmp(words[3], "off") != 0)   return TAB_COMPLETE_VALUE_INT;
+        }
     }
     return NULL;
 }
@@ -4186,6 +4517,7 @@ void init_commands(ConezStream *dev)
     shell.addCommand("?", cmd_help);
     shell.addCommand("art", cmd_art);
     shell.addCommand("artnet", cmd_artnet, NULL, NULL, tc_artnet);
+    shell.addCommand("sacn", cmd_sacn, NULL, NULL, tc_sacn);
     shell.addCommand("cat", listFile, "*");
     shell.addCommand("clear", cmd_clear);
     shell.addCommand("cls", cmd_clear);
@@ -8,6 +8,7 @@
 #include "led.h"
 #include "gps.h"
 #include "printManager.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 
@@ -20,7 +21,10 @@ static cue_entry *cue_list = nullptr;
 // Per-cue runtime state, parallel to cue_list: the effective start time for
 // THIS cone (base start + spatial offset, precomputed at cue_start since the
 // offset is fixed during playback) and whether the cue has already fired.
-struct cue_rt { int64_t eff_start; uint8_t fired; };
+// catchup marks cues that were already overdue when playback started (e.g.
+// "cue start <offset>"); they fire immediately and are kept out of the
+// lateness histogram so a mid-track join doesn't read as a timing fault.
+struct cue_rt { int64_t eff_start; uint8_t fired; uint8_t catchup; };
 static cue_rt *cue_rt_arr = nullptr;
 
 static int   cue_count   = 0;
@@ -33,6 +37,84 @@ static bool  spatial_enabled = false; // false when no GPS fix -> spatial offset
 static float my_x = 0, my_y = 0;
 static float origin_x = 0, origin_y = 0;
 
+// ---------- Timing histograms ----------
+
+// Fixed-bucket histogram: counts[i] holds samples in (edges[i-1], edges[i]],
+// counts[nedges] is the open-ended overflow bucket. No allocation and a short
+// linear scan per sample, so recording is cheap enough for every fire/loop.
+#define CUE_HIST_MAX_BUCKETS 16
+
+struct cue_hist {
+    const uint32_t *edges;
+    int      nedges;
+    uint32_t counts[CUE_HIST_MAX_BUCKETS];
+    uint32_t total;
+    uint32_t max;
+};
+
+// Lateness of a fired cue vs. its due time, in ms. One frame at 30 FPS is
+// 33 ms -- anything past that is visible as a cone firing a frame late.
+static const uint32_t late_edges_ms[] = {
+    0, 1, 2, 3, 5, 8, 12, 16, 20, 33, 50, 100, 250, 500, 1000
+};
+// Loop-to-loop jitter of cue_loop(), in us.
+static const uint32_t jitter_edges_us[] = {
+    50, 100, 250, 500, 1000, 2000, 4000, 8000, 16000, 33000, 66000,
+    133000, 250000, 500000, 1000000
+};
+
+static_assert(sizeof(late_edges_ms) / sizeof(late_edges_ms[0]) < CUE_HIST_MAX_BUCKETS, "too many lateness buckets");
+static_assert(sizeof(jitter_edges_us) / sizeof(jitter_edges_us[0]) < CUE_HIST_MAX_BUCKETS, "too many jitter buckets");
+
+static cue_hist late_hist   = { late_edges_ms,   (int)(sizeof(late_edges_ms) / sizeof(late_edges_ms[0])),     {}, 0, 0 };
+static cue_hist jitter_hist = { jitter_edges_us, (int)(sizeof(jitter_edges_us) / sizeof(jitter_edges_us[0])), {}, 0, 0 };
+static int64_t  last_loop_us = 0;     // esp_timer time of the previous playing cue_loop(), 0 = none
+static int64_t  last_gap_us  = -1;    // previous loop gap, -1 = none
+static uint32_t gap_max_us   = 0;
+
+static void hist_reset(cue_hist *h)
+{
+    memset(h->counts, 0, sizeof(h->counts));
+    h->total = 0;
+    h->max = 0;
+}
+
+static void hist_record(cue_hist *h, uint32_t v)
+{
+    int i = 0;
+    while (i < h->nedges && v > h->edges[i]) i++;
+    h->counts[i]++;
+    h->total++;
+    if (v > h->max) h->max = v;
+}
+
+// Value at or below which pct% of samples fall, reported as the upper edge of
+// the containing bucket. Clamped to the observed max so p99 never exceeds it
+// and the overflow bucket has a meaningful value.
+static uint32_t hist_percentile(const cue_hist *h, uint32_t pct)
+{
+    if (h->total == 0) return 0;
+    uint32_t rank = (uint32_t)(((uint64_t)h->total * pct + 99) / 100);
+    if (rank == 0) rank = 1;
+    uint32_t cum = 0;
+    for (int i = 0; i <= h->nedges; i++) {
+        cum += h->counts[i];
+        if (cum >= rank)
+            return (i < h->nedges && h->edges[i] < h->max) ? h->edges[i] : h->max;
+    }
+    return h->max;
+}
+
+// Caller holds cue_mutex.
+static void timing_reset_locked(void)
+{
+    hist_reset(&late_hist);
+    hist_reset(&jitter_hist);
+    last_loop_us = 0;
+    last_gap_us  = -1;
+    gap_max_us   = 0;
+}
+
 // ---------- Helpers ----------
 
 // Evaluate group targeting: does this cue apply to us?
@@ -108,40 +190,24 @@ static void dispatch_cue(const cue_entry *cue)
 
     case CUE_TYPE_STOP:
         if (cue->channel >= 1 && cue->channel <= 4) {
-            int cnt = 0;
-            switch (cue->channel) {
-                case 1: cnt = config.led_count1; break;
-                case 2: cnt = config.led_count2; break;
-                case 3: cnt = config.led_count3; break;
-                case 4: cnt = config.led_count4; break;
-            }
-            led_set_channel(cue->channel, cnt, CRGB::Black);
-            led_show();
+            led_src_fill(LED_SRC_CUE, cue->channel, CRGB::Black);
+            led_src_show(LED_SRC_CUE);
         }
         break;
 
     case CUE_TYPE_FILL: {
         CRGB col(cue->params[0], cue->params[1], cue->params[2]);
         if (cue->channel >= 1 && cue->channel <= 4) {
-            int cnt = 0;
-            switch (cue->channel) {
-                case 1: cnt = config.led_count1; break;
-                case 2: cnt = config.led_count2; break;
-                case 3: cnt = config.led_count3; break;
-                case 4: cnt = config.led_count4; break;
-            }
-            led_set_channel(cue->channel, cnt, col);
-            led_show();
+            led_src_fill(LED_SRC_CUE, cue->channel, col);
+            led_src_show(LED_SRC_CUE);
         }
         break;
     }
 
     case CUE_TYPE_BLACKOUT:
-        led_set_channel(1, config.led_count1, CRGB::Black);
-        led_set_channel(2, config.led_count2, CRGB::Black);
-        led_set_channel(3, config.led_count3, CRGB::Black);
-        led_set_channel(4, config.led_count4, CRGB::Black);
-        led_show();
+        for (int ch = 1; ch <= 4; ch++)
+            led_src_fill(LED_SRC_CUE, ch, CRGB::Black);
+        led_src_show(LED_SRC_CUE);
         break;
 
     case CUE_TYPE_EFFECT:
@@ -184,6 +250,21 @@ void cue_loop(void)
     uint64_t now_ms = get_epoch_ms();
     if (now_ms == 0) { xSemaphoreGive(cue_mutex); return; }
 
+    // Loop-to-loop jitter: how much the gap since the previous call differs
+    // from the gap before it. The gap itself bounds how late any cue can be.
+    int64_t now_us = esp_timer_get_time();
+    if (last_loop_us != 0) {
+        int64_t gap = now_us - last_loop_us;
+        if (gap > (int64_t)gap_max_us) gap_max_us = (gap > UINT32_MAX) ? UINT32_MAX : (uint32_t)gap;
+        if (last_gap_us >= 0) {
+            int64_t d = gap - last_gap_us;
+            if (d < 0) d = -d;
+            hist_record(&jitter_hist, (d > UINT32_MAX) ? UINT32_MAX : (uint32_t)d);
+        }
+        last_gap_us = gap;
+    }
+    last_loop_us = now_us;
+
     // Simple subtraction — epoch time never wraps at midnight.
     // 64-bit elapsed avoids the ~49-day wrap of uint32_t.
     uint64_t elapsed_ms = (now_ms > music_start_ms) ? (now_ms - music_start_ms) : 0;
@@ -196,8 +277,17 @@ void cue_loop(void)
         if (cue_rt_arr[i].fired) continue;
         if ((uint64_t)cue_rt_arr[i].eff_start > elapsed_ms) continue;  // not yet — keep scanning
 
-        if (cue_matches(cue_list[i].group))
+        if (cue_matches(cue_list[i].group)) {
+            // Sample the clock per fire: earlier dispatches in this pass
+            // (led_show etc.) count against the cues behind them.
+            if (!cue_rt_arr[i].catchup) {
+                uint64_t due_ms  = music_start_ms + (uint64_t)cue_rt_arr[i].eff_start;
+                uint64_t fire_ms = get_epoch_ms();
+                uint64_t late    = (fire_ms > due_ms) ? fire_ms - due_ms : 0;
+                hist_record(&late_hist, (late > UINT32_MAX) ? UINT32_MAX : (uint32_t)late);
+            }
             dispatch_cue(&cue_list[i]);
+        }
         cue_rt_arr[i].fired = 1;
         cue_fired_count++;
     }
@@ -340,13 +430,19 @@ void cue_start(uint64_t epoch_start_ms)
 
     // Precompute each cue's effective start for this cone (the offset is fixed
     // for the run) and clear the fired flags.
+    uint64_t now_ms = get_epoch_ms();
+    int64_t start_elapsed = (now_ms > epoch_start_ms) ? (int64_t)(now_ms - epoch_start_ms) : 0;
     for (int i = 0; i < cue_count; i++) {
         int64_t eff = (int64_t)cue_list[i].start_ms + compute_spatial_offset(&cue_list[i]);
         if (eff < 0) eff = 0;
         cue_rt_arr[i].eff_start = eff;
         cue_rt_arr[i].fired = 0;
+        cue_rt_arr[i].catchup = (eff < start_elapsed) ? 1 : 0;
     }
 
+    // Timing stats describe one run
+    timing_reset_locked();
+
     playing = true;
     xSemaphoreGive(cue_mutex);
 
@@ -359,6 +455,7 @@ void cue_stop(void)
     xSemaphoreTake(cue_mutex, portMAX_DELAY);
     playing = false;
     xSemaphoreGive(cue_mutex);
+    led_src_release(LED_SRC_CUE);
     printfnl(SOURCE_SYSTEM, "cue: playback stopped\n");
 }
 
@@ -376,6 +473,31 @@ uint32_t cue_get_elapsed_ms(void)
     return (uint32_t)(now_ms - music_start_ms);
 }
 
+void cue_get_timing(cue_timing_stats *out)
+{
+    if (!out) return;
+    if (!cue_mutex) { memset(out, 0, sizeof(*out)); return; }
+    xSemaphoreTake(cue_mutex, portMAX_DELAY);
+    out->fires         = late_hist.total;
+    out->late_p50_ms   = hist_percentile(&late_hist, 50);
+    out->late_p99_ms   = hist_percentile(&late_hist, 99);
+    out->late_max_ms   = late_hist.max;
+    out->loops         = jitter_hist.total;
+    out->jitter_p50_us = hist_percentile(&jitter_hist, 50);
+    out->jitter_p99_us = hist_percentile(&jitter_hist, 99);
+    out->jitter_max_us = jitter_hist.max;
+    out->gap_max_us    = gap_max_us;
+    xSemaphoreGive(cue_mutex);
+}
+
+void cue_reset_timing(void)
+{
+    if (!cue_mutex) return;
+    xSemaphoreTake(cue_mutex, portMAX_DELAY);
+    timing_reset_locked();
+    xSemaphoreGive(cue_mutex);
+}
+
 
 // ---------- CLI ----------
 
@@ -390,9 +512,12 @@ int cmd_cue(int argc, char **argv)
         if (playing) {
             uint64_t now_ms = get_epoch_ms();
             uint32_t elapsed = (now_ms > music_start_ms) ? (uint32_t)(now_ms - music_start_ms) : 0;
-            printfnl(SOURCE_COMMANDS, "  Elapsed: %lu ms\n", (unsigned long)elapsed);
+            printfnl(SOURCE_COMMANDS, "  Elapsed: %lu ms (frame %lu)\n", (unsigned long)elapsed,
+                     (unsigned long)((uint64_t)elapsed * led_frame_rate() / 1000));
             printfnl(SOURCE_COMMANDS, "  Fired:   %d / %d\n", cue_fired_count, cue_count);
         }
+        printfnl(SOURCE_COMMANDS, "  Frame:   %llu at %d fps\n",
+                 (unsigned long long)led_frame_number(), led_frame_rate());
         return 0;
     }
 
@@ -428,6 +553,44 @@ int cmd_cue(int argc, char **argv)
         return 0;
     }
 
-    printfnl(SOURCE_COMMANDS, "Usage: cue [load <path> | start [ms] | stop | status]\n");
+    // cue stats [reset]
+    if (!strcasecmp(argv[1], "stats")) {
+        if (argc >= 3 && !strcasecmp(argv[2], "reset")) {
+            cue_reset_timing();
+            printfnl(SOURCE_COMMANDS, "cue: timing stats reset\n");
+            return 0;
+        }
+        cue_timing_stats st;
+        cue_get_timing(&st);
+        printfnl(SOURCE_COMMANDS, "Cue Timing:\n");
+        printfnl(SOURCE_COMMANDS, "  Fires:    %lu\n", (unsigned long)st.fires);
+        printfnl(SOURCE_COMMANDS, "  Late:     p50 %lu ms  p99 %lu ms  max %lu ms\n",
+                 (unsigned long)st.late_p50_ms, (unsigned long)st.late_p99_ms, (unsigned long)st.late_max_ms);
+        printfnl(SOURCE_COMMANDS, "  Loops:    %lu\n", (unsigned long)st.loops);
+        printfnl(SOURCE_COMMANDS, "  Jitter:   p50 %lu us  p99 %lu us  max %lu us\n",
+                 (unsigned long)st.jitter_p50_us, (unsigned long)st.jitter_p99_us, (unsigned long)st.jitter_max_us);
+        printfnl(SOURCE_COMMANDS, "  Max gap:  %lu us\n", (unsigned long)st.gap_max_us);
+
+        // Non-empty lateness buckets. Copy under the mutex, print outside it.
+        uint32_t counts[CUE_HIST_MAX_BUCKETS];
+        xSemaphoreTake(cue_mutex, portMAX_DELAY);
+        memcpy(counts, late_hist.counts, sizeof(counts));
+        xSemaphoreGive(cue_mutex);
+        if (st.fires > 0) {
+            printfnl(SOURCE_COMMANDS, "  Lateness histogram:\n");
+            for (int i = 0; i <= late_hist.nedges; i++) {
+                if (!counts[i]) continue;
+                if (i < late_hist.nedges)
+                    printfnl(SOURCE_COMMANDS, "    <= %4lu ms  %lu\n",
+                             (unsigned long)late_hist.edges[i], (unsigned long)counts[i]);
+                else
+                    printfnl(SOURCE_COMMANDS, "     > %4lu ms  %lu\n",
+                             (unsigned long)late_hist.edges[i - 1], (unsigned long)counts[i]);
+            }
+        }
+        return 0;
+    }
+
+    printfnl(SOURCE_COMMANDS, "Usage: cue [load <path> | start [ms] | stop | status | stats [reset]]\n");
     return 1;
 }
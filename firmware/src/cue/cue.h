@@ -58,6 +58,25 @@ struct cue_entry {
     uint8_t  params[16];        // 16  effect-specific parameters
 };  // 64 bytes
 
+// ---------- Timing instrumentation ----------
+
+// Snapshot of the engine's timing histograms (see cue_get_timing()).
+// Lateness is measured per fired cue as (now - (music_start_ms + eff_start))
+// in ms. Loop jitter is |gap(n) - gap(n-1)| between consecutive cue_loop()
+// calls in us, i.e. how unevenly the engine gets scheduled while playing.
+// Percentiles are bucket upper bounds, clamped to the observed max.
+struct cue_timing_stats {
+    uint32_t fires;             // cues dispatched (catch-up fires excluded)
+    uint32_t late_p50_ms;
+    uint32_t late_p99_ms;
+    uint32_t late_max_ms;
+    uint32_t loops;             // jitter samples recorded
+    uint32_t jitter_p50_us;
+    uint32_t jitter_p99_us;
+    uint32_t jitter_max_us;
+    uint32_t gap_max_us;        // longest single gap between cue_loop() calls
+};
+
 // ---------- Public API ----------
 
 void cue_setup(void);
@@ -67,6 +86,8 @@ void cue_start(uint64_t epoch_start_ms);
 void cue_stop(void);
 bool cue_is_playing(void);
 uint32_t cue_get_elapsed_ms(void);
+void cue_get_timing(cue_timing_stats *out);
+void cue_reset_timing(void);
 int  cmd_cue(int argc, char **argv);
 
 #endif
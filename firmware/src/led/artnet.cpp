@@ -4,8 +4,13 @@
  * Listens on UDP port 6454. Each LED channel is mapped to a configurable
  * (universe, DMX address) pair via config.artnet_uni1..4 / artnet_dmx1..4.
  * DMX addresses are 1-indexed (standard convention); 0 means the channel is
- * disabled. Received RGB triplets are written directly into leds1..4 and
- * led_show() is called to trigger the render task.
+ * disabled. A channel longer than the rest of its universe continues at
+ * address 1 of the next ones. Packet handling (ArtSync, sequence numbers)
+ * lives in artnet_rx.cpp and frame assembly in dmx_ingest.cpp, shared with
+ * the sACN receiver; this file owns the socket. Received RGB triplets are
+ * written into the ArtNet LED layer, which is published to the render task
+ * once per complete frame and released (so lower layers show again) when
+ * the receiver stops.
  *
  * The task waits for WiFi if not yet connected, and reopens the socket if
  * the connection drops and resumes.
@@ -16,6 +21,7 @@
 #include "lwip/sockets.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "artnet.h"
 #include "config.h"
 #include "led.h"
@@ -23,59 +29,47 @@
 #include "printManager.h"
 #include "main.h"
 
-#define ARTNET_PORT      6454
-#define ARTNET_HEADER    18
-#define ARTNET_OPOUTPUT  0x5000u
-#define BUF_SIZE         (ARTNET_HEADER + 512)
+#define BUF_SIZE         (18 + 512)
 
 static TaskHandle_t      s_task = NULL;
 static volatile bool     s_running = false;
-static volatile uint32_t s_rx_packets = 0;
-static volatile uint32_t s_rx_frames  = 0;
+
+// Packet handling state. Only the receiver task changes it; the mutex lets
+// the CLI read consistent stats.
+static dmx_ingest        s_rx;
+static SemaphoreHandle_t s_rx_mutex = NULL;
 
 // ---------------------------------------------------------------------------
-// Apply one received ArtNet universe to any matching LED channels
+// Sink: received pixels go straight into the ArtNet layer's work buffers and
+// are published once dmx_ingest decides the frame is complete
 // ---------------------------------------------------------------------------
 
-static void apply_universe(int universe, const uint8_t *dmx, int dmx_len)
+static CRGB *sink_buf(void *ctx, int ch, int *count)
 {
-    const int unis[4]   = { config.artnet_uni1, config.artnet_uni2,
-                             config.artnet_uni3, config.artnet_uni4 };
-    const int addrs[4]  = { config.artnet_dmx1, config.artnet_dmx2,
-                             config.artnet_dmx3, config.artnet_dmx4 };
-
-    // Snapshot LED pointers/counts under mutex to avoid race with led_resize_channel
-    CRGB *ptrs[4];
-    int counts[4];
-    led_snapshot(ptrs, counts);
-
-    bool dirty = false;
-
-    for (int ch = 0; ch < 4; ch++) {
-        if (addrs[ch] == 0)        continue;   // 0 = channel disabled
-        if (unis[ch] != universe)  continue;   // wrong universe
-        if (!ptrs[ch])             continue;   // buffer not allocated
-
-        // DMX address is 1-indexed; convert to 0-indexed byte offset
-        int base  = addrs[ch] - 1;
-        if (base < 0 || base >= 512) continue;  // invalid DMX address
-        int count = counts[ch];
-        if (count <= 0) continue;
-
-        for (int i = 0; i < count; i++) {
-            int off = base + i * 3;
-            if (off + 2 >= dmx_len) break;  // incomplete triplet — stop
-            ptrs[ch][i].r = dmx[off];
-            ptrs[ch][i].g = dmx[off + 1];
-            ptrs[ch][i].b = dmx[off + 2];
-        }
-        dirty = true;
-    }
+    (void)ctx;
+    CRGB *buf = led_src_buf(LED_SRC_ARTNET, ch + 1, count);
+    return (buf && *count > 0) ? buf : NULL;
+}
 
-    if (dirty) {
-        s_rx_frames++;
-        led_show();
-    }
+static void sink_commit(void *ctx)
+{
+    (void)ctx;
+    led_src_show(LED_SRC_ARTNET);
+}
+
+static const dmx_sink s_sink = { sink_buf, sink_commit, NULL };
+
+// Pick up mapping changes ("artnet universe/dmx", "config set", led resize).
+// A changed mapping resets frame and sequence state.
+static void apply_config(void)
+{
+    dmx_chan_map map[DMX_CHANNELS] = {
+        { config.artnet_uni1, config.artnet_dmx1, config.led_count1 },
+        { config.artnet_uni2, config.artnet_dmx2, config.led_count2 },
+        { config.artnet_uni3, config.artnet_dmx3, config.led_count3 },
+        { config.artnet_uni4, config.artnet_dmx4, config.led_count4 },
+    };
+    dmx_ingest_configure(&s_rx, map);
 }
 
 // ---------------------------------------------------------------------------
@@ -133,10 +127,11 @@ static void artnet_task_fun(void *arg)
                 continue;
             }
 
-            // 200 ms receive timeout so the loop can check s_running
+            // Receive timeout short enough to commit a partial frame on
+            // time (dmx_ingest_poll) and to notice s_running going false
             struct timeval tv;
             tv.tv_sec  = 0;
-            tv.tv_usec = 200000;
+            tv.tv_usec = DMX_FRAME_TIMEOUT_MS * 1000;
             setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
 
             printfnl(SOURCE_SYSTEM, "[ArtNet] Listening on UDP port %d\n", ARTNET_PORT);
@@ -156,26 +151,23 @@ static void artnet_task_fun(void *arg)
                 sock = -1;
                 vTaskDelay(pdMS_TO_TICKS(1000));
             }
+            xSemaphoreTake(s_rx_mutex, portMAX_DELAY);
+            dmx_ingest_poll(&s_rx, uptime_ms(), &s_sink);
+            xSemaphoreGive(s_rx_mutex);
             continue;
         }
 
-        // Validate Art-Net header
-        if (n < ARTNET_HEADER)                       continue;
-        if (memcmp(buf, "Art-Net", 8) != 0)          continue;
-        uint16_t opcode = (uint16_t)(buf[8] | ((unsigned)buf[9] << 8));
-        if (opcode != ARTNET_OPOUTPUT)               continue;
-
-        int universe = (int)(buf[14] | ((buf[15] & 0x7F) << 8));
-        int dmx_len  = (int)((buf[16] << 8) | buf[17]);
-        if (dmx_len < 2 || dmx_len > 512)            continue;
-        if (n < ARTNET_HEADER + dmx_len)             continue;
-
-        s_rx_packets++;
-        apply_universe(universe, buf + ARTNET_HEADER, dmx_len);
+        uint32_t now = uptime_ms();
+        xSemaphoreTake(s_rx_mutex, portMAX_DELAY);
+        apply_config();
+        artnet_rx_packet(&s_rx, buf, (size_t)n, now, &s_sink);
+        dmx_ingest_poll(&s_rx, now, &s_sink);
+        xSemaphoreGive(s_rx_mutex);
     }
 
     free(buf);
     if (sock >= 0) close(sock);
+    led_src_release(LED_SRC_ARTNET);
     s_task    = NULL;
     s_running = false;
     vTaskDelete(NULL);
@@ -187,6 +179,8 @@ static void artnet_task_fun(void *arg)
 
 void artnet_setup(void)
 {
+    s_rx_mutex = xSemaphoreCreateMutex();
+    artnet_rx_init(&s_rx);
     if (config.artnet_enabled)
         artnet_start();
 }
@@ -194,9 +188,11 @@ void artnet_setup(void)
 void artnet_start(void)
 {
     if (s_task) return;     // already running
-    s_running    = true;
-    s_rx_packets = 0;
-    s_rx_frames  = 0;
+    if (!s_rx_mutex) return;
+    xSemaphoreTake(s_rx_mutex, portMAX_DELAY);
+    artnet_rx_init(&s_rx);
+    xSemaphoreGive(s_rx_mutex);
+    s_running = true;
     if (xTaskCreate(artnet_task_fun, "ArtNet", 4096, NULL, 5, &s_task) != pdPASS) {
         // Don't leave s_running=true with no task: artnet_running() would then
         // report a receiver that doesn't exist.
@@ -212,10 +208,27 @@ void artnet_stop(void)
 {
     if (!s_task) return;
     s_running = false;
-    // Task exits within ~200 ms on the next recvfrom timeout
+    // Task exits within ~100 ms on the next recvfrom timeout
     printfnl(SOURCE_SYSTEM, "[ArtNet] Stopping\n");
 }
 
-bool     artnet_running(void)    { return s_task != NULL; }
-uint32_t artnet_rx_packets(void) { return s_rx_packets; }
-uint32_t artnet_rx_frames(void)  { return s_rx_frames; }
+bool artnet_running(void) { return s_task != NULL; }
+
+void artnet_get_stats(dmx_stats *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (!s_rx_mutex) return;
+    xSemaphoreTake(s_rx_mutex, portMAX_DELAY);
+    *out = s_rx.st;
+    xSemaphoreGive(s_rx_mutex);
+}
+
+int artnet_get_universe_stats(dmx_uni_stats *out, int max)
+{
+    if (!s_rx_mutex) return 0;
+    xSemaphoreTake(s_rx_mutex, portMAX_DELAY);
+    int n = s_rx.nuni < max ? s_rx.nuni : max;
+    memcpy(out, s_rx.uni, (size_t)n * sizeof(*out));
+    xSemaphoreGive(s_rx_mutex);
+    return n;
+}
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "artnet_rx.h"
 
 // Call in setup() after config_init() and led_setup(). Starts the receiver
 // task immediately if config.artnet_enabled is true.
@@ -10,12 +11,16 @@ void artnet_setup(void);
 
 // Start/stop the receiver task. artnet_start() is idempotent (no-op if
 // already running). artnet_stop() signals the task to exit; it finishes
-// within ~200 ms (recvfrom timeout). Neither call saves config.
+// within ~100 ms (recvfrom timeout). Neither call saves config.
 void artnet_start(void);
 void artnet_stop(void);
 
-bool     artnet_running(void);
-uint32_t artnet_rx_packets(void);   // valid OpOutput packets received
-uint32_t artnet_rx_frames(void);    // LED buffer updates applied
+bool artnet_running(void);
+
+// Receiver counters since the last artnet_start().
+void artnet_get_stats(dmx_stats *out);
+
+// Per-universe counters, in mapping order. Returns the number written.
+int  artnet_get_universe_stats(dmx_uni_stats *out, int max);
 
 #endif
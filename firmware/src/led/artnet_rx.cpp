@@ -0,0 +1,59 @@
+#include <string.h>
+#include "artnet_rx.h"
+
+#define ARTNET_HEADER 18
+
+
+void artnet_rx_init(dmx_ingest *in)
+{
+    dmx_ingest_init(in, ARTNET_SYNC_TIMEOUT_MS);
+}
+
+
+// Sequence numbers run 1..255 and wrap to 1; 0 means the sender doesn't
+// sequence. Returns false if the packet is older than (or the same as) the
+// last one accepted for the universe. Packets are never held back to wait
+// for a missing one: by the time it could arrive the frame is due.
+static bool seq_accept(dmx_uni_stats *u, uint8_t seq, uint32_t now_ms)
+{
+    if (seq && u->last_seq && u->last_ms && now_ms - u->last_ms < DMX_ACTIVE_MS) {
+        int d = ((int)seq - (int)u->last_seq + 255) % 255;
+        if (d == 0)  { u->dups++; return false; }
+        if (d > 127) { u->late++; return false; }
+        u->lost += (uint32_t)(d - 1);
+    }
+    u->last_seq = seq;
+    return true;
+}
+
+
+dmx_rx_result artnet_rx_packet(dmx_ingest *in, const uint8_t *pkt, size_t len,
+                               uint32_t now_ms, const dmx_sink *sink)
+{
+    if (len < 12 || memcmp(pkt, "Art-Net", 8) != 0) {
+        in->st.invalid++;
+        return DMX_RX_INVALID;
+    }
+    uint16_t opcode = (uint16_t)(pkt[8] | ((unsigned)pkt[9] << 8));
+    if (opcode == ARTNET_OP_SYNC)
+        return dmx_ingest_sync(in, now_ms, sink);
+    if (opcode != ARTNET_OP_DMX || len < ARTNET_HEADER) {
+        in->st.invalid++;
+        return DMX_RX_INVALID;
+    }
+
+    int universe = (int)(pkt[14] | ((pkt[15] & 0x7F) << 8));
+    int dmx_len  = (int)((pkt[16] << 8) | pkt[17]);
+    if (dmx_len < 2 || dmx_len > 512 || len < (size_t)(ARTNET_HEADER + dmx_len)) {
+        in->st.invalid++;
+        return DMX_RX_INVALID;
+    }
+
+    int idx = dmx_ingest_find(in, universe);
+    if (idx < 0) {
+        in->st.ignored++;
+        return DMX_RX_IGNORED;
+    }
+    if (!seq_accept(&in->uni[idx], pkt[12], now_ms)) return DMX_RX_DROPPED;
+    return dmx_ingest_data(in, idx, pkt + ARTNET_HEADER, dmx_len, now_ms, sink);
+}
@@ -0,0 +1,27 @@
+#ifndef _conez_artnet_rx_h
+#define _conez_artnet_rx_h
+
+// ArtNet packet handling: ArtDmx and ArtSync parsing and sequence checking
+// on top of the shared DMX ingest (dmx_ingest.h), which maps universes to
+// pixels and assembles frames. Once a controller sends ArtSync, frames are
+// committed only on ArtSync, until none has arrived for 4 s.
+//
+// Pure C++, no FreeRTOS/lwIP dependency: artnet.cpp feeds it from the UDP
+// socket, firmware/test/host feeds it recorded captures.
+
+#include "dmx_ingest.h"
+
+#define ARTNET_PORT               6454
+#define ARTNET_SYNC_TIMEOUT_MS    4000    // back to unsynced mode without ArtSync (spec)
+
+#define ARTNET_OP_DMX   0x5000u
+#define ARTNET_OP_SYNC  0x5200u
+
+// Reset `in` for ArtNet use.
+void artnet_rx_init(dmx_ingest *in);
+
+// Handle one UDP payload received at now_ms.
+dmx_rx_result artnet_rx_packet(dmx_ingest *in, const uint8_t *pkt, size_t len,
+                               uint32_t now_ms, const dmx_sink *sink);
+
+#endif
@@ -0,0 +1,198 @@
+#include <string.h>
+#include "dmx_ingest.h"
+
+
+void dmx_ingest_init(dmx_ingest *in, uint32_t sync_timeout_ms)
+{
+    memset(in, 0, sizeof(*in));
+    in->sync_timeout_ms = sync_timeout_ms;
+}
+
+
+int dmx_ingest_find(const dmx_ingest *in, int universe)
+{
+    for (int i = 0; i < in->nuni; i++)
+        if (in->uni[i].universe == universe) return i;
+    return -1;
+}
+
+
+bool dmx_ingest_configure(dmx_ingest *in, const dmx_chan_map map[DMX_CHANNELS])
+{
+    if (memcmp(in->map, map, sizeof(in->map)) == 0) return false;
+
+    memcpy(in->map, map, sizeof(in->map));
+    memset(in->uni, 0, sizeof(in->uni));
+    in->nuni     = 0;
+    in->nspans   = 0;
+    in->pending  = 0;
+    in->gap_seen = 0;
+
+    for (int ch = 0; ch < DMX_CHANNELS; ch++) {
+        const dmx_chan_map *m = &map[ch];
+        if (m->dmx_addr < 1 || m->dmx_addr > 512 || m->count <= 0) continue;
+
+        // First universe from the start address, then 170 pixels from
+        // address 1 of each following universe.
+        int off = m->dmx_addr - 1;
+        int pix = 0;
+        for (int u = m->universe; pix < m->count && u <= 0xFFFF; u++, off = 0) {
+            int n = (512 - off) / 3;
+            if (n > m->count - pix) n = m->count - pix;
+            if (n <= 0) continue;
+
+            int idx = dmx_ingest_find(in, u);
+            if (idx < 0) {
+                if (in->nuni >= DMX_MAX_UNIVERSES) break;
+                idx = in->nuni++;
+                in->uni[idx].universe = (uint16_t)u;
+            }
+            if (in->nspans >= DMX_MAX_UNIVERSES) break;
+            dmx_span *s = &in->span[in->nspans++];
+            s->uni     = (uint8_t)idx;
+            s->ch      = (uint8_t)ch;
+            s->dmx_off = (uint16_t)off;
+            s->pixel   = (uint16_t)pix;
+            s->npix    = (uint16_t)n;
+            pix += n;
+        }
+    }
+    return true;
+}
+
+
+// Universes heard from recently enough to be expected in every frame. One
+// that stops arriving drops out after DMX_ACTIVE_MS instead of stalling
+// the others.
+static uint32_t active_mask(const dmx_ingest *in, uint32_t now_ms)
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < in->nuni; i++)
+        if (in->uni[i].last_ms && now_ms - in->uni[i].last_ms < DMX_ACTIVE_MS)
+            mask |= 1u << i;
+    return mask;
+}
+
+
+// The universe that opens the sender's frames: the active one after the
+// longest silence. Spreading the rest of a frame over the frame period
+// doesn't move it, and one late or lost packet barely does.
+static int frame_opener(const dmx_ingest *in, uint32_t now_ms)
+{
+    uint32_t active = active_mask(in, now_ms);
+    int best = -1;
+    for (int i = 0; i < in->nuni; i++)
+        if ((active & (1u << i)) && (best < 0 || in->gap_ms[i] > in->gap_ms[best]))
+            best = i;
+    return best;
+}
+
+
+static void commit_frame(dmx_ingest *in, const dmx_sink *sink, uint32_t now_ms)
+{
+    uint32_t active = active_mask(in, now_ms);
+    if ((in->pending & active) != active) in->st.partial++;
+    sink->commit(sink->ctx);
+    in->st.frames++;
+    in->pending = 0;
+}
+
+
+dmx_rx_result dmx_ingest_sync(dmx_ingest *in, uint32_t now_ms, const dmx_sink *sink)
+{
+    in->st.syncs++;
+    in->st.sync_mode = true;
+    in->last_sync_ms = now_ms;
+    if (!in->pending) return DMX_RX_IGNORED;
+    commit_frame(in, sink, now_ms);
+    return DMX_RX_COMMITTED;
+}
+
+
+void dmx_ingest_unsync(dmx_ingest *in)
+{
+    in->st.sync_mode = false;
+}
+
+
+dmx_rx_result dmx_ingest_data(dmx_ingest *in, int idx, const uint8_t *dmx, int len,
+                              uint32_t now_ms, const dmx_sink *sink)
+{
+    dmx_uni_stats *u = &in->uni[idx];
+    u->last_ms = now_ms;
+    u->packets++;
+    in->st.packets++;
+
+    if (in->st.sync_mode && now_ms - in->last_sync_ms > in->sync_timeout_ms)
+        in->st.sync_mode = false;
+
+    // The silence before each universe, smoothed over frames; a pause longer
+    // than the partial-frame timeout is the sender stopping, not its cadence.
+    // A frame opens when the universe with the longest one arrives after a
+    // longer silence than any inside the pending frame: reordered within a
+    // burst, it is just another universe of the frame.
+    uint32_t bit = 1u << idx;
+    uint32_t gap = now_ms - in->last_rx_ms;
+    if (in->last_rx_ms && gap < DMX_FRAME_TIMEOUT_MS) {
+        in->gap_ms[idx] = (in->gap_seen & bit) ? (3 * in->gap_ms[idx] + gap) / 4 : gap;
+        in->gap_seen |= bit;
+    }
+    in->last_rx_ms = now_ms;
+    bool opens = gap > in->pending_gap_ms && idx == frame_opener(in, now_ms);
+
+    // Unsynced, a controller frame is a burst of universes. A universe
+    // arriving again before its frame completed, or the next frame opening,
+    // means the controller has moved on and something never came: show what
+    // we have rather than mix two frames. The opener also keeps frame
+    // boundaries in phase after a lost first universe or at startup.
+    bool committed = false;
+    if (!in->st.sync_mode && in->pending && ((in->pending & bit) || opens)) {
+        commit_frame(in, sink, now_ms);
+        committed = true;
+    }
+
+    bool short_pkt = false;
+    for (int i = 0; i < in->nspans; i++) {
+        const dmx_span *s = &in->span[i];
+        if (s->uni != idx) continue;
+        int count;
+        CRGB *buf = sink->buf(sink->ctx, s->ch, &count);
+        if (!buf) continue;
+        int end = s->pixel + s->npix;
+        if (end > count) end = count;
+        int off = s->dmx_off;
+        for (int p = s->pixel; p < end; p++, off += 3) {
+            if (off + 2 >= len) { short_pkt = true; break; }   // incomplete triplet
+            buf[p].r = dmx[off];
+            buf[p].g = dmx[off + 1];
+            buf[p].b = dmx[off + 2];
+        }
+    }
+    if (short_pkt) u->short_pkts++;
+
+    if (!in->pending) {
+        in->pending_ms = now_ms;
+        in->pending_gap_ms = 0;
+    } else if (gap > in->pending_gap_ms) {
+        in->pending_gap_ms = gap;
+    }
+    in->pending |= bit;
+
+    if (!in->st.sync_mode) {
+        uint32_t active = active_mask(in, now_ms);
+        if ((in->pending & active) == active) {
+            commit_frame(in, sink, now_ms);
+            committed = true;
+        }
+    }
+    return committed ? DMX_RX_COMMITTED : DMX_RX_STAGED;
+}
+
+
+void dmx_ingest_poll(dmx_ingest *in, uint32_t now_ms, const dmx_sink *sink)
+{
+    if (in->st.sync_mode && now_ms - in->last_sync_ms > in->sync_timeout_ms)
+        in->st.sync_mode = false;
+    if (!in->st.sync_mode && in->pending && now_ms - in->pending_ms >= DMX_FRAME_TIMEOUT_MS)
+        commit_frame(in, sink, now_ms);
+}
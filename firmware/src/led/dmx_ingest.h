@@ -0,0 +1,133 @@
+#ifndef _conez_dmx_ingest_h
+#define _conez_dmx_ingest_h
+
+// DMX-over-IP ingest shared by the ArtNet and sACN receivers: universe-to-
+// pixel mapping, frame assembly and per-universe counters. The protocol
+// parsers (artnet_rx, sacn_rx) validate packets, check sequence numbers and
+// pick a source, then hand the DMX slots of one universe to
+// dmx_ingest_data().
+//
+// Each LED channel starts at (universe, DMX address) and, if it has more
+// pixels than fit, continues at address 1 of the following universes, 170
+// pixels (510 slots) each. Received pixels go straight into the sink's
+// buffers -- for the firmware, the receiver's LED layer work buffers -- so a
+// slot is copied exactly once. The sink is only told to commit once every
+// universe of the frame has arrived, or, in sync mode, only on the
+// protocol's sync packet. Without sync, frame boundaries are found from the
+// traffic itself: a universe repeating, or the universe that opens the
+// sender's frames arriving again, ends a frame, so one frame is not shown
+// with some universes from the next. The opening universe is the one that
+// follows the longest silence, however the sender spaces the rest over the
+// frame period.
+//
+// Pure C++, no FreeRTOS/lwIP dependency: the receiver tasks feed it from
+// their sockets, firmware/test/host feeds it recorded captures.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "crgb.h"
+
+#define DMX_CHANNELS            4
+#define DMX_MAX_UNIVERSES       32      // distinct universes one receiver maps
+#define DMX_PIXELS_PER_UNIVERSE 170
+#define DMX_ACTIVE_MS           1000    // universe counts toward frames while this fresh
+#define DMX_FRAME_TIMEOUT_MS    100     // commit a partial frame after this long
+
+// Where one LED channel's pixels come from. dmx_addr 0 disables it.
+struct dmx_chan_map {
+    int universe;           // first universe
+    int dmx_addr;           // 1-512, address of the first pixel's red
+    int count;              // pixels
+};
+
+// A contiguous run of one channel's pixels carried by one universe.
+struct dmx_span {
+    uint8_t  uni;           // index into dmx_ingest.uni[]
+    uint8_t  ch;            // LED channel, 0-based
+    uint16_t dmx_off;       // byte offset of the first pixel in the DMX data
+    uint16_t pixel;         // first pixel on the channel
+    uint16_t npix;
+};
+
+struct dmx_uni_stats {
+    uint16_t universe;
+    uint32_t packets;       // accepted
+    uint32_t late;          // dropped: sequence older than the last accepted
+    uint32_t dups;          // dropped: same sequence as the last accepted
+    uint32_t lost;          // sequence numbers skipped (lost or still in flight)
+    uint32_t short_pkts;    // shorter than the mapped pixels need
+    uint8_t  last_seq;      // protocol's sequence number of the last accepted
+    uint32_t last_ms;       // when the last packet was accepted, 0 = never
+};
+
+struct dmx_stats {
+    uint32_t packets;       // valid data packets for a mapped universe
+    uint32_t ignored;       // valid, but unmapped universe or not the chosen source
+    uint32_t invalid;       // not the protocol, unsupported or malformed
+    uint32_t syncs;         // sync packets received
+    uint32_t frames;        // frames committed to the LEDs
+    uint32_t partial;       // of which committed with universes missing
+    bool     sync_mode;     // currently holding output for sync packets
+};
+
+// Where received pixels go. buf() returns channel ch's (0-based) staging
+// buffer and its length in pixels, or null; commit() publishes everything
+// written since the last commit as one frame.
+struct dmx_sink {
+    CRGB *(*buf)(void *ctx, int ch, int *count);
+    void  (*commit)(void *ctx);
+    void  *ctx;
+};
+
+enum dmx_rx_result {
+    DMX_RX_INVALID,         // not a usable packet
+    DMX_RX_IGNORED,         // valid but nothing of ours in it
+    DMX_RX_DROPPED,         // stale or duplicate sequence
+    DMX_RX_STAGED,          // pixels written, frame not complete yet
+    DMX_RX_COMMITTED,       // a frame was committed
+};
+
+struct dmx_ingest {
+    dmx_chan_map  map[DMX_CHANNELS];
+    dmx_span      span[DMX_MAX_UNIVERSES];
+    int           nspans;
+    dmx_uni_stats uni[DMX_MAX_UNIVERSES];
+    int           nuni;
+
+    uint32_t pending;           // universes (bit per uni[] index) staged this frame
+    uint32_t pending_ms;        // when the first of them arrived
+    uint32_t pending_gap_ms;    // longest silence between them
+    uint32_t last_rx_ms;        // last data packet accepted
+    uint32_t gap_ms[DMX_MAX_UNIVERSES];  // smoothed silence before each universe
+    uint32_t gap_seen;          // universes with a gap_ms sample
+    uint32_t last_sync_ms;
+    uint32_t sync_timeout_ms;   // back to unsynced after this long without sync
+    dmx_stats st;
+};
+
+void dmx_ingest_init(dmx_ingest *in, uint32_t sync_timeout_ms);
+
+// Set the channel mapping. If it differs from the current one the universe
+// table is rebuilt and frame/sequence state reset; returns true in that
+// case. Universes beyond DMX_MAX_UNIVERSES are not mapped.
+bool dmx_ingest_configure(dmx_ingest *in, const dmx_chan_map map[DMX_CHANNELS]);
+
+// Index of `universe` in uni[], or -1 if it is not mapped.
+int  dmx_ingest_find(const dmx_ingest *in, int universe);
+
+// Accept the DMX slots (start code stripped) of mapped universe uni[idx].
+// The caller has already checked the sequence number.
+dmx_rx_result dmx_ingest_data(dmx_ingest *in, int idx, const uint8_t *dmx, int len,
+                              uint32_t now_ms, const dmx_sink *sink);
+
+// A sync packet: enter sync mode and commit the pending frame.
+dmx_rx_result dmx_ingest_sync(dmx_ingest *in, uint32_t now_ms, const dmx_sink *sink);
+
+// The sender stopped synchronizing: commit on completion again.
+void dmx_ingest_unsync(dmx_ingest *in);
+
+// Timeouts: commit a frame whose missing universes never came, drop out of
+// sync mode. Call periodically (e.g. on every receive timeout).
+void dmx_ingest_poll(dmx_ingest *in, uint32_t now_ms, const dmx_sink *sink);
+
+#endif
@@ -0,0 +1,115 @@
+#include <string.h>
+#include "frame_clock.h"
+
+// Phase error buckets, us. Up to ~1 ms is esp_timer dispatch and task wake
+// latency; past a few ms something held the core; 33 ms is a whole frame.
+static const uint32_t err_edges_us[FRAME_CLOCK_HIST_EDGES] = {
+    25, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 33000, 100000
+};
+
+
+uint64_t frame_clock_index(uint64_t t_us, int fps)
+{
+    return t_us * (uint64_t)fps / 1000000ULL;
+}
+
+
+uint64_t frame_clock_start_us(uint64_t frame, int fps)
+{
+    // Round up so frame_clock_index(frame_clock_start_us(n)) == n.
+    return (frame * 1000000ULL + (uint64_t)fps - 1) / (uint64_t)fps;
+}
+
+
+int frame_clock_clamp_fps(int fps)
+{
+    if (fps < FRAME_CLOCK_MIN_FPS) return FRAME_CLOCK_MIN_FPS;
+    if (fps > FRAME_CLOCK_MAX_FPS) return FRAME_CLOCK_MAX_FPS;
+    return fps;
+}
+
+
+void frame_clock_init(frame_clock *fc)
+{
+    memset(fc, 0, sizeof(*fc));
+}
+
+
+uint32_t frame_clock_next(frame_clock *fc, uint64_t now_us, int fps)
+{
+    fps = frame_clock_clamp_fps(fps);
+    uint64_t cur = frame_clock_index(now_us, fps);
+
+    if (fc->fps != fps) {
+        if (fc->fps) fc->st.resyncs++;
+        fc->fps  = fps;
+        fc->next = cur + 1;
+    } else if (cur >= fc->next) {
+        // Overran the boundary we meant to wake for. Skipping to the next one
+        // keeps this cone in phase; rendering now would put it a partial
+        // frame behind the rest of the field.
+        uint64_t behind = cur + 1 - fc->next;
+        if (behind > (uint64_t)fps) fc->st.resyncs++;     // clock jumped ahead
+        else                        fc->st.missed += (uint32_t)behind;
+        fc->next = cur + 1;
+    } else if (fc->next > cur + 1) {
+        fc->st.resyncs++;                                  // clock stepped back
+        fc->next = cur + 1;
+    }
+
+    return (uint32_t)(frame_clock_start_us(fc->next, fps) - now_us);
+}
+
+
+uint64_t frame_clock_wake(frame_clock *fc, uint64_t now_us)
+{
+    int64_t err = (int64_t)(now_us - frame_clock_start_us(fc->next, fc->fps));
+    if (err >  INT32_MAX) err = INT32_MAX;
+    if (err < -INT32_MAX) err = -INT32_MAX;
+    uint32_t mag = (uint32_t)(err < 0 ? -err : err);
+
+    int i = 0;
+    while (i < FRAME_CLOCK_HIST_EDGES && mag > err_edges_us[i]) i++;
+    fc->hist[i]++;
+    fc->hist_total++;
+
+    fc->st.frames++;
+    fc->st.err_last_us = (int32_t)err;
+    if (mag > fc->st.err_max_us) fc->st.err_max_us = mag;
+
+    return fc->next++;
+}
+
+
+// Upper edge of the bucket holding the pct'th percentile, clamped to the
+// observed max (same convention as the cue timing histograms).
+static uint32_t err_percentile(const frame_clock *fc, uint32_t pct)
+{
+    if (fc->hist_total == 0) return 0;
+    uint32_t rank = (uint32_t)(((uint64_t)fc->hist_total * pct + 99) / 100);
+    if (rank == 0) rank = 1;
+    uint32_t cum = 0;
+    for (int i = 0; i <= FRAME_CLOCK_HIST_EDGES; i++) {
+        cum += fc->hist[i];
+        if (cum >= rank)
+            return (i < FRAME_CLOCK_HIST_EDGES && err_edges_us[i] < fc->st.err_max_us)
+                   ? err_edges_us[i] : fc->st.err_max_us;
+    }
+    return fc->st.err_max_us;
+}
+
+
+void frame_clock_get_stats(const frame_clock *fc, frame_clock_stats *out)
+{
+    *out = fc->st;
+    out->err_p50_us = err_percentile(fc, 50);
+    out->err_p99_us = err_percentile(fc, 99);
+}
+
+
+void frame_clock_reset_stats(frame_clock *fc)
+{
+    memset(fc->hist, 0, sizeof(fc->hist));
+    fc->hist_total = 0;
+    memset(&fc->st, 0, sizeof(fc->st));
+}
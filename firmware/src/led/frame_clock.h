@@ -0,0 +1,64 @@
+#ifndef _conez_frame_clock_h
+#define _conez_frame_clock_h
+
+// Epoch-aligned LED frame schedule.
+//
+// Frame n starts at epoch time ceil(n * 1e6 / fps) us, so every cone with a
+// disciplined clock (GPS+PPS, NTP, beacon) renders frame n at the same
+// instant and carries the same frame number. The render task asks for the
+// delay to the next boundary, sleeps, then reports when it actually woke;
+// the difference is the phase error.
+//
+// Pure C++, no FreeRTOS/IDF dependency: led.cpp drives it from an esp_timer,
+// firmware/test/host drives it with synthetic time.
+
+#include <stdint.h>
+
+#define FRAME_CLOCK_MIN_FPS  1
+#define FRAME_CLOCK_MAX_FPS  120
+
+// |wake - boundary| histogram edges in us; one extra overflow bucket.
+#define FRAME_CLOCK_HIST_EDGES 12
+
+struct frame_clock_stats {
+    uint32_t frames;        // boundaries woken for
+    uint32_t missed;        // boundaries skipped because the task ran long
+    uint32_t resyncs;       // schedule restarted (fps change, clock step)
+    int32_t  err_last_us;   // signed phase error of the last wake (+ = late)
+    uint32_t err_p50_us;    // |phase error| percentiles, bucket resolution
+    uint32_t err_p99_us;
+    uint32_t err_max_us;
+};
+
+struct frame_clock {
+    int      fps;           // rate the current schedule was built for, 0 = none
+    uint64_t next;          // frame number to wake for
+    uint32_t hist[FRAME_CLOCK_HIST_EDGES + 1];
+    uint32_t hist_total;
+    frame_clock_stats st;
+};
+
+// Frame containing epoch time t_us, and the epoch time frame n starts.
+uint64_t frame_clock_index(uint64_t t_us, int fps);
+uint64_t frame_clock_start_us(uint64_t frame, int fps);
+
+// Clamp a configured rate into [FRAME_CLOCK_MIN_FPS, FRAME_CLOCK_MAX_FPS].
+int      frame_clock_clamp_fps(int fps);
+
+void     frame_clock_init(frame_clock *fc);
+
+// Choose the next boundary to wake for at time now_us and return the delay
+// to it in us. A task that overran one or more boundaries skips them (they
+// are counted as missed) rather than rendering late. An fps change, the
+// clock stepping back, or it jumping ahead by more than a second restarts
+// the schedule.
+uint32_t frame_clock_next(frame_clock *fc, uint64_t now_us, int fps);
+
+// Record the wake for the boundary chosen by frame_clock_next(). Returns
+// that frame's number.
+uint64_t frame_clock_wake(frame_clock *fc, uint64_t now_us);
+
+void     frame_clock_get_stats(const frame_clock *fc, frame_clock_stats *out);
+void     frame_clock_reset_stats(frame_clock *fc);
+
+#endif
@@ -1,13 +1,19 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <new>
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
 #include "main.h"
 #include "led.h"
+#include "led_stage.h"
+#include "led_layer.h"
+#include "frame_clock.h"
 #include "config.h"
+#include "gps.h"
+#include "printManager.h"
 
 #ifdef BOARD_HAS_RGB_LEDS
 #include "driver/rmt_tx.h"
@@ -19,21 +25,85 @@ CRGB *leds2 = nullptr;
 CRGB *leds3 = nullptr;
 CRGB *leds4 = nullptr;
 
-// Dirty flag -- set by led_show(), cleared by the render task.
+// Dirty flag -- set by led_src_show(), cleared by the render task.
 // volatile is sufficient: single writer (render task clears), multiple setters (any task sets).
 static volatile bool led_dirty = false;
 
+// Timebase for the frame schedule: the disciplined epoch clock, so every cone
+// with GPS+PPS/NTP/beacon time renders frame n at the same instant. Before any
+// time source has set the clock the local timer keeps the task free-running.
+static uint64_t frame_time_us(void)
+{
+    uint64_t t = get_epoch_us();
+    return t ? t : (uint64_t)esp_timer_get_time();
+}
+
 // Physical capacity of each leds* allocation, fixed at led_setup().
 // led_resize_channel() only moves the logical count within this capacity and
 // never reallocates -- other tasks hold the raw leds* pointer without the mutex,
 // so freeing it at runtime would be a use-after-free.
 static int led_cap[4] = { 0, 0, 0, 0 };
 
+// Logical LED count of channel ch (0-3), never beyond the allocation.
+static int led_channel_count(int ch)
+{
+    const int counts[4] = { config.led_count1, config.led_count2,
+                            config.led_count3, config.led_count4 };
+    int n = counts[ch];
+    if (n > led_cap[ch]) n = led_cap[ch];
+    return n < 0 ? 0 : n;
+}
+
+// ---- Layer settings ----
+//
+// Kept per source rather than in the layer so "led layer" can configure a
+// source before it first draws; copied into the layer when it is allocated.
+static const char *const src_names[LED_SRC_COUNT] = { "base", "cue", "basic", "wasm", "wasm1", "wasm2",
+                                                      "wasm3", "artnet", "sacn" };
+static int     src_priority[LED_SRC_COUNT] = { 0, 10, 20, 30, 31, 32, 33, 40, 50 };
+static uint8_t src_blend[LED_SRC_COUNT]    = { LED_BLEND_REPLACE, LED_BLEND_REPLACE, LED_BLEND_REPLACE,
+                                               LED_BLEND_REPLACE, LED_BLEND_REPLACE, LED_BLEND_REPLACE,
+                                               LED_BLEND_REPLACE, LED_BLEND_REPLACE, LED_BLEND_REPLACE };
+static uint8_t src_opacity[LED_SRC_COUNT]  = { 255, 255, 255, 255, 255, 255, 255, 255, 255 };
+
 #ifdef BOARD_HAS_RGB_LEDS
 
-// Mutex protects buffer pointer/count swaps in led_resize_channel().
+// Serializes allocation of layers on first use.
 static SemaphoreHandle_t led_mutex = nullptr;
 
+// Serializes whole pushes (render task vs. led_show_now) so the layer front
+// slots and per-channel staging buffers have a single owner, and guards the
+// composition order and settings. Held across the transmit wait; producers
+// never take it.
+static SemaphoreHandle_t led_tx_mutex = nullptr;
+
+// One layer per source. layer_live is set once the layer is allocated and
+// never cleared, so a producer that saw it set can use the layer unlocked.
+static led_layer layers[LED_SRC_COUNT];
+static volatile bool layer_live[LED_SRC_COUNT] = {};
+static bool layer_failed[LED_SRC_COUNT] = {};
+
+// Producer-side lock per source. Only serializes the tasks that share one
+// source (cue dispatch vs. cue_stop, the CLI vs. effects on the base layer);
+// different sources never contend.
+static SemaphoreHandle_t src_lock[LED_SRC_COUNT] = {};
+
+// Live layers in composition order (ascending priority). led_tx_mutex.
+static led_layer *layer_order[LED_SRC_COUNT];
+static int layer_order_n = 0;
+
+// Composed frame per channel, sized to led_cap. Written only by led_push_hw().
+static CRGB *led_out[4] = {};
+
+// Channels to recompose and resend on the next push even if no layer
+// published a frame for them: composition settings changed or a channel
+// was resized. Set from any task, taken by led_push_hw().
+static std::atomic<uint8_t> led_force{ LED_LAYER_ALL };
+
+// Full refresh interval: every channel is re-sent even if unchanged, in case
+// a strip glitched or was hot-plugged.
+#define LED_REFRESH_MS 500
+
 // ---- WS2812B RMT Encoder ----
 //
 // Custom encoder: bytes_encoder converts pixel bytes to RMT symbols,
@@ -152,75 +222,94 @@ static esp_err_t ws2812_encoder_new(rmt_encoder_handle_t *ret_encoder)
     return ESP_OK;
 }
 
-// ---- RMT channels and encoder ----
+// ---- RMT channels and encoders ----
 
+// One encoder per channel: the encoder carries per-transmit state (bytes
+// encoder position, reset-pulse stage) that the RMT ISR advances as it
+// refills channel memory, so channels transmitting concurrently can't share one.
 static rmt_channel_handle_t rmt_chan[4] = {};
-static rmt_encoder_handle_t rmt_enc = NULL;
-
-// GRB conversion buffer (lazily allocated, reused across channels)
-static uint8_t *grb_buf = NULL;
-static int grb_buf_size = 0;
-
-static void led_push_hw(void)
-{
-    if (!rmt_enc) return;
-    // Hold led_mutex across the whole push: serializes against led_set_channel
-    // writers AND prevents concurrent callers from clobbering shared grb_buf.
-    // rmt_transmit with the bytes_encoder reads grb_buf asynchronously until
-    // rmt_tx_wait_all_done returns, so the buffer must stay intact.
-    xSemaphoreTake(led_mutex, portMAX_DELAY);
+static rmt_encoder_handle_t rmt_enc[4] = {};
 
-    CRGB *bufs[]  = { leds1, leds2, leds3, leds4 };
-    int counts[]  = { config.led_count1, config.led_count2,
-                      config.led_count3, config.led_count4 };
+// Per-channel GRB staging buffers, sized to led_cap at boot (never grown --
+// led_resize_channel() can't exceed led_cap either).
+static led_stage stage;
+static bool stage_ready = false;
 
-    // Find max LED count to size conversion buffer
-    int max_count = 0;
-    for (int i = 0; i < 4; i++) {
-        if (counts[i] > max_count) max_count = counts[i];
-    }
+static uint32_t push_last_us = 0;
+static uint32_t push_max_us  = 0;
+static uint32_t push_count   = 0;
+static uint32_t refresh_count = 0;
+static uint32_t idle_frames  = 0;   // frame ticks with nothing published
 
-    // Ensure conversion buffer is large enough
-    int needed = max_count * 3;
-    if (needed > grb_buf_size) {
-        uint8_t *new_buf = (uint8_t *)malloc(needed);
-        if (!new_buf) {  // keep old buffer, skip this frame
-            xSemaphoreGive(led_mutex);
-            return;
-        }
-        free(grb_buf);
-        grb_buf = new_buf;
-        grb_buf_size = needed;
-    }
+// Frame schedule, advanced only by the render task. The spinlock keeps the
+// stats coherent for readers on the other core.
+static frame_clock fclock;
+static portMUX_TYPE fclock_mux = portMUX_INITIALIZER_UNLOCKED;
 
+static int rmt_ops_transmit(void *ctx, int ch, const uint8_t *data, size_t len)
+{
+    (void)ctx;
+    if (!rmt_chan[ch] || !rmt_enc[ch]) return -1;
     rmt_transmit_config_t tx_cfg = {};
     tx_cfg.loop_count = 0;
+    return (rmt_transmit(rmt_chan[ch], rmt_enc[ch], data, len, &tx_cfg) == ESP_OK) ? 0 : -1;
+}
 
-    for (int ch = 0; ch < 4; ch++) {
-        if (!bufs[ch] || counts[ch] == 0 || !rmt_chan[ch]) continue;
+static int rmt_ops_wait(void *ctx, int ch, uint32_t timeout_ms)
+{
+    (void)ctx;
+    return (rmt_tx_wait_all_done(rmt_chan[ch], pdMS_TO_TICKS(timeout_ms)) == ESP_OK) ? 0 : -1;
+}
 
-        // Convert RGB -> GRB for WS2812B
-        for (int i = 0; i < counts[ch]; i++) {
-            grb_buf[i * 3 + 0] = bufs[ch][i].g;
-            grb_buf[i * 3 + 1] = bufs[ch][i].r;
-            grb_buf[i * 3 + 2] = bufs[ch][i].b;
-        }
+// A stalled channel is reset: rmt_disable aborts the in-flight transmit (so it
+// stops reading the staging buffer) and rmt_enable restores it for the next
+// frame -- otherwise the channel would stay wedged.
+static void rmt_ops_abort(void *ctx, int ch)
+{
+    (void)ctx;
+    rmt_disable(rmt_chan[ch]);
+    rmt_enable(rmt_chan[ch]);
+}
 
-        if (rmt_transmit(rmt_chan[ch], rmt_enc, grb_buf, counts[ch] * 3, &tx_cfg) != ESP_OK)
-            continue;   // couldn't queue -- nothing reading grb_buf, safe to move on
-        // rmt_transmit reads grb_buf asynchronously, so we MUST wait before the
-        // next channel overwrites the shared buffer. If the channel stalls, reset
-        // it: rmt_disable aborts the in-flight transmit (so it stops reading
-        // grb_buf) and rmt_enable restores it for the next frame -- otherwise the
-        // stuck transmit would keep reading a buffer we're about to overwrite,
-        // and the channel would stay wedged.
-        if (rmt_tx_wait_all_done(rmt_chan[ch], pdMS_TO_TICKS(100)) != ESP_OK) {
-            rmt_disable(rmt_chan[ch]);
-            rmt_enable(rmt_chan[ch]);
-        }
+static const led_tx_ops rmt_ops = { rmt_ops_transmit, rmt_ops_wait, rmt_ops_abort, NULL };
+
+// full: re-send every channel whether or not it changed.
+static void led_push_hw(bool full)
+{
+    if (!stage_ready) return;
+    xSemaphoreTake(led_tx_mutex, portMAX_DELAY);
+    int64_t t0 = esp_timer_get_time();
+
+    // Compose the newest published frame of every layer. Producers hand
+    // frames over through the layers' triple buffers, so nothing here waits
+    // on a producer and no half-drawn frame gets in. Only channels a new
+    // frame touched are recomposed; of those, only ones whose pixels actually
+    // differ from what the strip shows are converted and sent.
+    uint8_t force = led_force.exchange(0) | (full ? LED_LAYER_ALL : 0);
+    int counts[4];
+    for (int ch = 0; ch < 4; ch++) counts[ch] = led_channel_count(ch);
+    uint8_t touched = led_layer_compose(layer_order, layer_order_n, led_out, counts, force);
+    for (int ch = 0; ch < 4; ch++) {
+        const CRGB *src = rmt_chan[ch] ? led_out[ch] : nullptr;
+        if (full)
+            led_stage_load(&stage, &rmt_ops, ch, src, counts[ch]);
+        else if (touched & (1u << ch))
+            led_stage_update(&stage, &rmt_ops, ch, src, counts[ch]);
+        else
+            led_stage_skip(&stage, ch);
     }
 
-    xSemaphoreGive(led_mutex);
+    // All channels start back-to-back and clock out in parallel; the wait
+    // costs the longest string, not the sum of all four.
+    led_stage_kick(&stage, &rmt_ops);
+    led_stage_wait(&stage, &rmt_ops, 100);
+
+    uint32_t dt = (uint32_t)(esp_timer_get_time() - t0);
+    push_last_us = dt;
+    if (dt > push_max_us) push_max_us = dt;
+    push_count++;
+    if (full) refresh_count++;
+    xSemaphoreGive(led_tx_mutex);
 }
 
 static void rmt_init(void)
@@ -240,12 +329,17 @@ static void rmt_init(void)
         }
         if (rmt_enable(rmt_chan[i]) != ESP_OK) {
             rmt_chan[i] = NULL;
+            continue;
+        }
+        if (ws2812_encoder_new(&rmt_enc[i]) != ESP_OK) {
+            rmt_enc[i] = NULL;
         }
     }
 
-    if (ws2812_encoder_new(&rmt_enc) != ESP_OK) {
-        rmt_enc = NULL;
-    }
+    // A channel whose staging buffer failed to allocate just stays dark;
+    // led_stage_load() skips it.
+    led_stage_init(&stage, led_cap);
+    stage_ready = true;
 }
 
 #endif  // BOARD_HAS_RGB_LEDS
@@ -254,18 +348,19 @@ static void rmt_init(void)
 void led_setup( void )
 {
 #ifdef BOARD_HAS_RGB_LEDS
-    // Boot-only, and deliberately NOT re-invocable. The leds* buffers back the
-    // render task and are read by writers that do NOT hold led_mutex (ArtNet's
-    // snapshot, BASIC/WASM host imports, the CLI), so freeing/reallocating them
-    // at runtime would be a use-after-free -- and a mutex here couldn't protect
-    // those unlocked readers. Runtime count changes go through
-    // led_resize_channel() (which never frees, capped at the boot capacity);
-    // growing past that needs a reboot. So allocate exactly once.
+    // Boot-only, and deliberately NOT re-invocable. The leds* and layer
+    // buffers are written by producers that hold no lock (BASIC/WASM host
+    // imports, ArtNet, the CLI), so freeing/reallocating them at runtime
+    // would be a use-after-free -- and a mutex here couldn't protect those
+    // writers. Runtime count changes go through led_resize_channel() (which
+    // never frees, capped at the boot capacity); growing past that needs a
+    // reboot. So allocate exactly once.
     static bool initialized = false;
     if (initialized) return;
     initialized = true;
 
     if (!led_mutex) led_mutex = xSemaphoreCreateMutex();
+    if (!led_tx_mutex) led_tx_mutex = xSemaphoreCreateMutex();
 
     leds1 = new CRGB[config.led_count1]();
     leds2 = new CRGB[config.led_count2]();
@@ -278,21 +373,70 @@ void led_setup( void )
     led_cap[2] = config.led_count3;
     led_cap[3] = config.led_count4;
 
+    for (int ch = 0; ch < 4; ch++)
+        led_out[ch] = led_cap[ch] ? (CRGB *)calloc(led_cap[ch], sizeof(CRGB)) : nullptr;
+    for (int i = 0; i < LED_SRC_COUNT; i++)
+        src_lock[i] = xSemaphoreCreateMutex();
+
+    // The base layer draws straight into leds1..4 and always covers every
+    // channel, so whatever is below the other layers is what the CLI,
+    // effects and boot code last showed.
+    CRGB *const work[4] = { leds1, leds2, leds3, leds4 };
+    led_layer *base = &layers[LED_SRC_BASE];
+    if (led_layer_init(base, src_names[LED_SRC_BASE], led_cap, work,
+                       src_priority[LED_SRC_BASE], (led_blend)src_blend[LED_SRC_BASE])) {
+        base->opacity = src_opacity[LED_SRC_BASE];
+        base->mask = LED_LAYER_ALL;
+        layer_order[layer_order_n++] = base;
+        layer_live[LED_SRC_BASE] = true;
+    }
+
     rmt_init();
 #endif
 }
 
 
+#ifdef BOARD_HAS_RGB_LEDS
+// Allocate a source's layer on first use. Returns false if it can't be.
+static bool layer_open( int src )
+{
+    if (layer_live[src]) return true;
+    if (!led_mutex || layer_failed[src]) return false;
+
+    xSemaphoreTake(led_mutex, portMAX_DELAY);
+    if (!layer_live[src] && !layer_failed[src]) {
+        led_layer *l = &layers[src];
+        if (led_layer_init(l, src_names[src], led_cap, nullptr,
+                           src_priority[src], (led_blend)src_blend[src])) {
+            l->opacity = src_opacity[src];
+            xSemaphoreTake(led_tx_mutex, portMAX_DELAY);
+            layer_order[layer_order_n++] = l;
+            led_layer_sort(layer_order, layer_order_n);
+            xSemaphoreGive(led_tx_mutex);
+            layer_live[src] = true;
+        } else {
+            layer_failed[src] = true;
+            printfnl(SOURCE_SYSTEM, "led: out of memory for %s layer\n", src_names[src]);
+        }
+    }
+    bool ok = layer_live[src];
+    xSemaphoreGive(led_mutex);
+    return ok;
+}
+#endif
+
+
 void led_show( void )
 {
-    led_dirty = true;
+    led_src_show(LED_SRC_BASE);
 }
 
 
 void led_show_now( void )
 {
 #ifdef BOARD_HAS_RGB_LEDS
-    led_push_hw();
+    led_show();
+    led_push_hw(true);
 #endif
 }
 
@@ -300,45 +444,211 @@ void led_show_now( void )
 void led_set_channel( int ch, int cnt, CRGB col )
 {
 #ifdef BOARD_HAS_RGB_LEDS
-    xSemaphoreTake(led_mutex, portMAX_DELAY);
+    if (!layer_live[LED_SRC_BASE]) return;
+    xSemaphoreTake(src_lock[LED_SRC_BASE], portMAX_DELAY);
+    int max_leds;
+    CRGB *buf = led_src_buf(LED_SRC_BASE, ch, &max_leds);
+    if (cnt > max_leds) cnt = max_leds;
+    for (int ii = 0; buf && ii < cnt; ii++)
+        buf[ii] = col;
+    xSemaphoreGive(src_lock[LED_SRC_BASE]);
+#endif
+}
 
-    CRGB *buf = nullptr;
-    int max_leds = 0;
 
-    switch (ch)
-    {
-        default:
-        case 1: buf = leds1; max_leds = config.led_count1; break;
-        case 2: buf = leds2; max_leds = config.led_count2; break;
-        case 3: buf = leds3; max_leds = config.led_count3; break;
-        case 4: buf = leds4; max_leds = config.led_count4; break;
+CRGB *led_src_buf( int src, int ch, int *count )
+{
+    *count = 0;
+#ifdef BOARD_HAS_RGB_LEDS
+    if (src < 0 || src >= LED_SRC_COUNT || ch < 1 || ch > 4) return nullptr;
+    if (!layer_open(src)) return nullptr;
+    CRGB *buf = led_layer_draw(&layers[src], ch - 1);
+    if (buf) *count = led_channel_count(ch - 1);
+    return buf;
+#else
+    (void)src; (void)ch;
+    return nullptr;
+#endif
+}
+
+
+void led_src_fill( int src, int ch, CRGB col )
+{
+#ifdef BOARD_HAS_RGB_LEDS
+    if (src < 0 || src >= LED_SRC_COUNT || !layer_open(src)) return;
+    xSemaphoreTake(src_lock[src], portMAX_DELAY);
+    int n;
+    CRGB *buf = led_src_buf(src, ch, &n);
+    for (int i = 0; buf && i < n; i++)
+        buf[i] = col;
+    xSemaphoreGive(src_lock[src]);
+#else
+    (void)src; (void)ch; (void)col;
+#endif
+}
+
+
+void led_src_show( int src )
+{
+#ifdef BOARD_HAS_RGB_LEDS
+    if (src < 0 || src >= LED_SRC_COUNT || !layer_live[src]) return;
+    xSemaphoreTake(src_lock[src], portMAX_DELAY);
+    led_layer_commit(&layers[src]);
+    xSemaphoreGive(src_lock[src]);
+#else
+    (void)src;
+#endif
+    led_dirty = true;
+}
+
+
+void led_src_release( int src )
+{
+#ifdef BOARD_HAS_RGB_LEDS
+    if (src < 0 || src >= LED_SRC_COUNT || !layer_live[src]) return;
+    xSemaphoreTake(src_lock[src], portMAX_DELAY);
+    if (src == LED_SRC_BASE) {
+        // The base layer always covers every channel; releasing it blanks it.
+        for (int ch = 0; ch < 4; ch++) {
+            CRGB *buf = layers[src].work[ch];
+            for (int i = 0; buf && i < led_cap[ch]; i++) buf[i] = CRGB::Black;
+        }
+        led_layer_commit(&layers[src]);
+    } else {
+        led_layer_release(&layers[src]);
     }
+    xSemaphoreGive(src_lock[src]);
+    led_dirty = true;
+#else
+    (void)src;
+#endif
+}
 
-    if (!buf) { xSemaphoreGive(led_mutex); return; }
-    if (cnt > max_leds) cnt = max_leds;
 
-    for (int ii = 0; ii < cnt; ii++)
-        buf[ii] = col;
+const char *led_src_name( int src )
+{
+    return (src >= 0 && src < LED_SRC_COUNT) ? src_names[src] : "?";
+}
 
-    xSemaphoreGive(led_mutex);
+
+int led_src_parse( const char *name )
+{
+    for (int i = 0; i < LED_SRC_COUNT; i++)
+        if (!strcasecmp(name, src_names[i])) return i;
+    return -1;
+}
+
+
+void led_layer_get_info( int src, led_layer_info *out )
+{
+    memset(out, 0, sizeof(*out));
+    if (src < 0 || src >= LED_SRC_COUNT) return;
+    out->name     = src_names[src];
+    out->priority = src_priority[src];
+    out->blend    = src_blend[src];
+    out->opacity  = src_opacity[src];
+#ifdef BOARD_HAS_RGB_LEDS
+    if (!layer_live[src]) return;
+    const led_layer *l = &layers[src];
+    out->active   = true;
+    out->channels = l->mask;
+    out->commits  = l->commits;
+    out->dropped  = l->dropped;
 #endif
 }
 
 
-void led_snapshot( CRGB *bufs[4], int counts[4] )
+int led_layer_configure( int src, int priority, int blend, int opacity )
 {
+    if (src < 0 || src >= LED_SRC_COUNT) return -1;
+    if (priority < -1 || blend < -1 || blend >= LED_BLEND_COUNT || opacity < -1 || opacity > 255)
+        return -1;
 #ifdef BOARD_HAS_RGB_LEDS
-    xSemaphoreTake(led_mutex, portMAX_DELAY);
-    bufs[0] = leds1; bufs[1] = leds2; bufs[2] = leds3; bufs[3] = leds4;
-    counts[0] = config.led_count1; counts[1] = config.led_count2;
-    counts[2] = config.led_count3; counts[3] = config.led_count4;
-    xSemaphoreGive(led_mutex);
+    if (led_tx_mutex) xSemaphoreTake(led_tx_mutex, portMAX_DELAY);
+#endif
+    if (priority >= 0) src_priority[src] = priority;
+    if (blend >= 0)    src_blend[src]    = (uint8_t)blend;
+    if (opacity >= 0)  src_opacity[src]  = (uint8_t)opacity;
+#ifdef BOARD_HAS_RGB_LEDS
+    if (layer_live[src]) {
+        layers[src].priority = src_priority[src];
+        layers[src].blend    = src_blend[src];
+        layers[src].opacity  = src_opacity[src];
+        led_layer_sort(layer_order, layer_order_n);
+        led_force.fetch_or(LED_LAYER_ALL);
+    }
+    if (led_tx_mutex) xSemaphoreGive(led_tx_mutex);
+#endif
+    led_dirty = true;
+    return 0;
+}
+
+
+int led_read_output( int ch, CRGB *dst, int max )
+{
+#ifdef BOARD_HAS_RGB_LEDS
+    if (ch < 1 || ch > 4 || !led_out[ch - 1] || !led_tx_mutex) return 0;
+    int n = led_channel_count(ch - 1);
+    if (n > max) n = max;
+    xSemaphoreTake(led_tx_mutex, portMAX_DELAY);
+    memcpy((void *)dst, led_out[ch - 1], (size_t)n * sizeof(CRGB));
+    xSemaphoreGive(led_tx_mutex);
+    return n;
 #else
-    for (int i = 0; i < 4; i++) { bufs[i] = nullptr; counts[i] = 0; }
+    (void)ch; (void)dst; (void)max;
+    return 0;
+#endif
+}
+
+
+void led_get_stats( led_stats *out )
+{
+    memset(out, 0, sizeof(*out));
+#ifdef BOARD_HAS_RGB_LEDS
+    if (!led_tx_mutex) return;
+    xSemaphoreTake(led_tx_mutex, portMAX_DELAY);
+    for (int ch = 0; ch < 4; ch++) {
+        out->frames[ch]   = stage.stats[ch].frames;
+        out->errors[ch]   = stage.stats[ch].errors;
+        out->timeouts[ch] = stage.stats[ch].timeouts;
+        out->skipped[ch]  = stage.stats[ch].skipped;
+    }
+    out->push_last_us = push_last_us;
+    out->push_max_us  = push_max_us;
+    out->pushes       = push_count;
+    out->refreshes    = refresh_count;
+    out->idle_frames  = idle_frames;
+    xSemaphoreGive(led_tx_mutex);
+
+    portENTER_CRITICAL(&fclock_mux);
+    frame_clock_get_stats(&fclock, &out->clock);
+    portEXIT_CRITICAL(&fclock_mux);
+#endif
+}
+
+
+void led_reset_frame_stats( void )
+{
+#ifdef BOARD_HAS_RGB_LEDS
+    portENTER_CRITICAL(&fclock_mux);
+    frame_clock_reset_stats(&fclock);
+    portEXIT_CRITICAL(&fclock_mux);
 #endif
 }
 
 
+uint64_t led_frame_number( void )
+{
+    return frame_clock_index(frame_time_us(), led_frame_rate());
+}
+
+
+int led_frame_rate( void )
+{
+    return frame_clock_clamp_fps(config.led_fps);
+}
+
+
 int led_resize_channel( int ch, int count )
 {
 #ifdef BOARD_HAS_RGB_LEDS
@@ -364,13 +674,14 @@ int led_resize_channel( int ch, int count )
 
     // Only the logical count changes; the pointer is stable, so the unlocked
     // writers in other tasks can't be left holding a freed buffer.
-    xSemaphoreTake(led_mutex, portMAX_DELAY);
+    xSemaphoreTake(src_lock[LED_SRC_BASE], portMAX_DELAY);
     int old_count = *count_ptr;
     if (buf && count > old_count)                                  // new LEDs black
-        memset(buf + old_count, 0, (size_t)(count - old_count) * sizeof(CRGB));
+        memset((void *)(buf + old_count), 0, (size_t)(count - old_count) * sizeof(CRGB));
     *count_ptr = count;
-    xSemaphoreGive(led_mutex);
+    xSemaphoreGive(src_lock[LED_SRC_BASE]);
 
+    led_force.fetch_or((uint8_t)(1u << (ch - 1)));
     led_show();
     return 0;
 #else
@@ -380,18 +691,58 @@ int led_resize_channel( int ch, int count )
 
 
 #ifdef BOARD_HAS_RGB_LEDS
+// esp_timer fires at the frame boundary with us resolution; a plain
+// vTaskDelay() would quantize the wake to the 1 ms tick.
+static void frame_timer_cb( void *arg )
+{
+    xTaskNotifyGive((TaskHandle_t)arg);
+}
+
 static void led_task_fun( void *param )
 {
     (void)param;
-    unsigned long last_show = 0;
+    esp_timer_handle_t frame_timer = nullptr;
+    esp_timer_create_args_t targs = {};
+    targs.callback = frame_timer_cb;
+    targs.arg      = xTaskGetCurrentTaskHandle();
+    targs.name     = "led_frame";
+    if (esp_timer_create(&targs, &frame_timer) != ESP_OK)
+        frame_timer = nullptr;           // fall back to tick-resolution delays
+
+    unsigned long last_full = 0;
     for (;;)
     {
-        vTaskDelay(pdMS_TO_TICKS(33));   // ~30 FPS
-        if (led_dirty || uptime_ms() - last_show >= 500)
+        // led.fps is read every frame so "config set led.fps" hot-applies
+        uint64_t now = frame_time_us();
+        portENTER_CRITICAL(&fclock_mux);
+        uint32_t wait_us = frame_clock_next(&fclock, now, config.led_fps);
+        portEXIT_CRITICAL(&fclock_mux);
+
+        if (frame_timer) {
+            ulTaskNotifyTake(pdTRUE, 0);        // drop a late notify from last frame
+            esp_timer_start_once(frame_timer, wait_us);
+            // The timeout only guards against a lost notification
+            if (!ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_us / 1000 + 100)))
+                esp_timer_stop(frame_timer);
+        } else {
+            vTaskDelay(pdMS_TO_TICKS((wait_us + 999) / 1000));
+        }
+
+        now = frame_time_us();
+        portENTER_CRITICAL(&fclock_mux);
+        frame_clock_wake(&fclock, now);
+        portEXIT_CRITICAL(&fclock_mux);
+
+        bool full = uptime_ms() - last_full >= LED_REFRESH_MS;
+        if (led_dirty || full)
         {
             led_dirty = false;
-            led_push_hw();
-            last_show = uptime_ms();
+            led_push_hw(full);
+            if (full) last_full = uptime_ms();
+        }
+        else
+        {
+            idle_frames++;
         }
     }
 }
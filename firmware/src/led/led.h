@@ -3,8 +3,12 @@
 
 #include "board.h"
 #include "crgb.h"
+#include "frame_clock.h"
+#include "led_layer.h"
 
-// Global LED buffers -- dynamically allocated in led_setup() from config
+// Global LED buffers -- dynamically allocated in led_setup() from config.
+// These are the work buffers of the base layer (CLI, effects, boot colors);
+// other producers draw into their own layer via led_src_buf().
 extern CRGB *leds1;
 extern CRGB *leds2;
 extern CRGB *leds3;
@@ -13,27 +17,105 @@ extern CRGB *leds4;
 // Initialize LED buffers and RMT channels. Call from setup() before led_start_task().
 void led_setup( void );
 
-// Start the LED render task (~30 FPS). Call from setup() after led_setup().
+// Start the LED render task. Frames are paced by led.fps and aligned to the
+// epoch clock (see frame_clock.h). Call from setup() after led_setup().
 void led_start_task( void );
 
-// Mark LED buffers dirty. The render task will push to hardware on the
-// next frame. Safe to call from any task/core.
+// Publish the base layer (leds1..4) and mark the output dirty. The render
+// task will compose and push to hardware on the next frame. Safe to call
+// from any task/core.
 void led_show( void );
 
 // Push to hardware immediately. ONLY safe during setup() before
 // led_start_task() has been called.
 void led_show_now( void );
 
-// Set `cnt` LEDs on channel `ch` (1-4) to `col`. Does NOT trigger show.
+// Set `cnt` LEDs on channel `ch` (1-4) of the base layer to `col`. Does NOT
+// trigger show.
 void led_set_channel( int ch, int cnt, CRGB col );
 
+// ---- Layers ----
+//
+// Each producer owns a layer (see led_layer.h): it draws into its own
+// buffers and publishes whole frames with led_src_show(); the render task
+// composes all layers once per frame by priority and blend mode. A layer
+// covers only the channels it has drawn, so lower layers show through the
+// rest. Non-base layers are allocated on first use.
+
+enum led_source {
+    LED_SRC_BASE,       // leds1..4: CLI, effects, boot
+    LED_SRC_CUE,
+    LED_SRC_BASIC,
+    LED_SRC_WASM,       // WASM slot 0; slot n draws into LED_SRC_WASM + n
+    LED_SRC_WASM1,
+    LED_SRC_WASM2,
+    LED_SRC_WASM3,
+    LED_SRC_ARTNET,
+    LED_SRC_SACN,
+    LED_SRC_COUNT
+};
+
+// Work buffer for channel `ch` (1-4) of source `src`, and its logical LED
+// count. Marks the channel as covered by the layer. Null if unavailable.
+// Only the owning producer may write it.
+CRGB *led_src_buf( int src, int ch, int *count );
+
+// Fill channel `ch` (1-4) of source `src` with `col`. Does NOT trigger show.
+void led_src_fill( int src, int ch, CRGB col );
+
+// Publish the source's frame and mark the output dirty.
+void led_src_show( int src );
+
+// Stop covering any channel; layers below show through from the next frame.
+void led_src_release( int src );
+
+struct led_layer_info {
+    const char *name;
+    bool     active;        // allocated (the source has drawn at least once)
+    int      priority;
+    int      blend;         // led_blend
+    int      opacity;       // 0-255
+    uint8_t  channels;      // bitmask of channels the layer covers
+    uint32_t commits;       // frames published
+    uint32_t dropped;       // published frames replaced before composed
+};
+
+const char *led_src_name( int src );
+int  led_src_parse( const char *name );     // -1 if unknown
+void led_layer_get_info( int src, led_layer_info *out );
+
+// Change a layer's composition; -1 leaves a setting unchanged. Applies from
+// the next frame. Returns 0, or -1 for a bad source or value.
+int  led_layer_configure( int src, int priority, int blend, int opacity );
+
+// Copy up to `max` pixels of channel `ch` (1-4) of the last composed frame
+// into `dst`. Returns the number copied.
+int  led_read_output( int ch, CRGB *dst, int max );
+
 // Resize channel `ch` (1-4) to `count` LEDs. Copies existing data,
 // new LEDs are black. Returns 0 on success, -1 on error.
 int led_resize_channel( int ch, int count );
 
-// Snapshot LED buffer pointers and counts under mutex.
-// Safe to call from any task. Pointers may become stale after a resize,
-// but won't be dangling during the current operation.
-void led_snapshot( CRGB *bufs[4], int counts[4] );
+// Output statistics (per channel 0-3), from the render task's pushes.
+struct led_stats {
+    uint32_t frames[4];     // transmits completed
+    uint32_t errors[4];     // transmits that could not be queued
+    uint32_t timeouts[4];   // transmits that stalled and were aborted
+    uint32_t skipped[4];    // pushes that left the channel off the wire: unchanged
+    uint32_t pushes;        // compose + send passes (frames with something published)
+    uint32_t refreshes;     // of which periodic full refreshes (every channel re-sent)
+    uint32_t idle_frames;   // frame ticks with nothing published, no push at all
+    uint32_t push_last_us;  // compose + convert + transmit time of the last push
+    uint32_t push_max_us;   // worst push since boot
+    frame_clock_stats clock; // frame schedule: phase error, missed frames
+};
+
+void led_get_stats( led_stats *out );
+void led_reset_frame_stats( void );
+
+// Current frame number on the shared epoch-aligned schedule (same value on
+// every cone with a disciplined clock), and the rate it counts at.
+uint64_t led_frame_number( void );
+int      led_frame_rate( void );
 
 #endif
@@ -0,0 +1,201 @@
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "led_layer.h"
+
+// state: low bits hold the ready slot index; FRESH marks it as published
+// since the compositor last took it.
+#define LED_LAYER_FRESH 0x4u
+#define LED_LAYER_IDX   0x3u
+
+static const char *const blend_names[LED_BLEND_COUNT] = { "replace", "over", "add", "max" };
+
+
+bool led_layer_init(led_layer *l, const char *name, const int caps[LED_LAYER_CHANNELS],
+                    CRGB *const work[LED_LAYER_CHANNELS], int priority, led_blend blend)
+{
+    size_t total = 0;
+    for (int ch = 0; ch < LED_LAYER_CHANNELS; ch++)
+        total += (caps[ch] > 0) ? (size_t)caps[ch] : 0;
+    size_t per_set = work ? 3 : 4;          // 3 hand-off slots (+ work buffers)
+
+    l->name = name;
+    l->mem = total ? calloc(total * per_set, sizeof(CRGB)) : nullptr;
+    if (total && !l->mem) return false;
+
+    CRGB *p = (CRGB *)l->mem;
+    for (int ch = 0; ch < LED_LAYER_CHANNELS; ch++) {
+        int n = (caps[ch] > 0) ? caps[ch] : 0;
+        l->cap[ch] = n;
+        for (int s = 0; s < 3; s++) { l->slot[s][ch] = n ? p : nullptr; p += n; }
+        if (work) {
+            l->work[ch] = n ? work[ch] : nullptr;
+        } else {
+            l->work[ch] = n ? p : nullptr;
+            p += n;
+        }
+    }
+    memset(l->slot_mask, 0, sizeof(l->slot_mask));
+
+    l->priority  = priority;
+    l->blend     = (uint8_t)blend;
+    l->opacity   = 255;
+    l->mask      = 0;
+    l->back      = 0;
+    l->front     = 2;
+    l->has_front = false;
+    l->state.store(1, std::memory_order_relaxed);
+    l->commits = l->dropped = l->taken = 0;
+    return true;
+}
+
+
+void led_layer_free(led_layer *l)
+{
+    free(l->mem);
+    l->mem = nullptr;
+    for (int ch = 0; ch < LED_LAYER_CHANNELS; ch++) {
+        l->cap[ch] = 0;
+        l->work[ch] = nullptr;
+        for (int s = 0; s < 3; s++) l->slot[s][ch] = nullptr;
+    }
+}
+
+
+CRGB *led_layer_draw(led_layer *l, int ch)
+{
+    if (ch < 0 || ch >= LED_LAYER_CHANNELS || !l->work[ch]) return nullptr;
+    l->mask |= (uint8_t)(1u << ch);
+    return l->work[ch];
+}
+
+
+void led_layer_commit(led_layer *l)
+{
+    uint8_t b = l->back;
+    for (int ch = 0; ch < LED_LAYER_CHANNELS; ch++)
+        if ((l->mask & (1u << ch)) && l->cap[ch])
+            memcpy(l->slot[b][ch], l->work[ch], (size_t)l->cap[ch] * sizeof(CRGB));
+    l->slot_mask[b] = l->mask;
+
+    // Release: the slot contents above must be visible before the index is.
+    uint32_t old = l->state.exchange(b | LED_LAYER_FRESH, std::memory_order_acq_rel);
+    l->back = (uint8_t)(old & LED_LAYER_IDX);
+    if (old & LED_LAYER_FRESH) l->dropped++;
+    l->commits++;
+}
+
+
+void led_layer_release(led_layer *l)
+{
+    l->mask = 0;
+    led_layer_commit(l);
+}
+
+
+bool led_layer_acquire(led_layer *l)
+{
+    if (!(l->state.load(std::memory_order_acquire) & LED_LAYER_FRESH)) return false;
+    uint32_t old = l->state.exchange(l->front, std::memory_order_acq_rel);
+    l->front = (uint8_t)(old & LED_LAYER_IDX);
+    l->has_front = true;
+    l->taken++;
+    return true;
+}
+
+
+static inline uint8_t mix8(uint8_t below, uint8_t above, uint8_t opacity)
+{
+    return (uint8_t)(((unsigned)below * (255u - opacity) + (unsigned)above * opacity + 127u) / 255u);
+}
+
+
+void led_layer_blend(const led_layer *l, int ch, CRGB *out, int count)
+{
+    if (!l->has_front || ch < 0 || ch >= LED_LAYER_CHANNELS) return;
+    if (!(l->slot_mask[l->front] & (1u << ch))) return;
+    if (count > l->cap[ch]) count = l->cap[ch];
+    const CRGB *src = l->slot[l->front][ch];
+    uint8_t op = l->opacity;
+    if (op == 0 || count <= 0) return;
+
+    if (l->blend == LED_BLEND_REPLACE && op == 255) {
+        memcpy(out, src, (size_t)count * sizeof(CRGB));
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        CRGB s = src[i], d = out[i], r;
+        switch (l->blend) {
+        default:
+        case LED_BLEND_REPLACE:
+            r = s;
+            break;
+        case LED_BLEND_OVER:
+            if (!s.r && !s.g && !s.b) continue;
+            r = s;
+            break;
+        case LED_BLEND_ADD:
+            r = d;
+            r += s;
+            break;
+        case LED_BLEND_MAX:
+            r = d;
+            r |= s;
+            break;
+        }
+        if (op != 255)
+            r = CRGB(mix8(d.r, r.r, op), mix8(d.g, r.g, op), mix8(d.b, r.b, op));
+        out[i] = r;
+    }
+}
+
+
+uint8_t led_layer_compose(led_layer *const *layers, int n,
+                          CRGB *const out[LED_LAYER_CHANNELS], const int counts[LED_LAYER_CHANNELS],
+                          uint8_t force)
+{
+    // A new frame can change the channels it covers and the ones its
+    // predecessor covered (released channels revert to the layers below).
+    uint8_t touched = force & LED_LAYER_ALL;
+    for (int i = 0; i < n; i++) {
+        led_layer *l = layers[i];
+        if (!l) continue;
+        uint8_t before = l->has_front ? l->slot_mask[l->front] : 0;
+        if (led_layer_acquire(l))
+            touched |= before | l->slot_mask[l->front];
+    }
+
+    for (int ch = 0; ch < LED_LAYER_CHANNELS; ch++) {
+        if (!(touched & (1u << ch))) continue;
+        if (!out[ch] || counts[ch] <= 0) continue;
+        memset((void *)out[ch], 0, (size_t)counts[ch] * sizeof(CRGB));
+        for (int i = 0; i < n; i++)
+            if (layers[i]) led_layer_blend(layers[i], ch, out[ch], counts[ch]);
+    }
+    return touched;
+}
+
+
+void led_layer_sort(led_layer **v, int n)
+{
+    for (int i = 1; i < n; i++) {
+        led_layer *x = v[i];
+        int j = i - 1;
+        while (j >= 0 && v[j]->priority > x->priority) { v[j + 1] = v[j]; j--; }
+        v[j + 1] = x;
+    }
+}
+
+
+const char *led_blend_name(int blend)
+{
+    return (blend >= 0 && blend < LED_BLEND_COUNT) ? blend_names[blend] : "?";
+}
+
+
+int led_blend_parse(const char *s)
+{
+    for (int i = 0; i < LED_BLEND_COUNT; i++)
+        if (!strcasecmp(s, blend_names[i])) return i;
+    return -1;
+}
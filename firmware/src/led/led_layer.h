@@ -0,0 +1,109 @@
+#ifndef _conez_led_layer_h
+#define _conez_led_layer_h
+
+// Per-producer LED layers, composed once per frame by the render task.
+//
+// Each producer (CLI/base, cue engine, BASIC, WASM, ArtNet) draws into its
+// own work buffers at its own pace and publishes a finished frame with
+// led_layer_commit(). The compositor takes the newest published frame of
+// every layer and blends them bottom-up by priority. Producers never share
+// a buffer with each other or with the compositor, so nothing half-drawn is
+// ever sent and neither side waits on the other.
+//
+// Hand-off is a lock-free triple buffer: the producer's back slot, the
+// published (ready) slot and the compositor's front slot rotate through a
+// single atomic exchange on each side. A commit that lands before the
+// compositor picked up the previous one replaces it (counted as dropped).
+//
+// Pure C++, no FreeRTOS/IDF dependency: led.cpp owns the layer table,
+// firmware/test/host drives it directly.
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include "crgb.h"
+
+#define LED_LAYER_CHANNELS 4
+#define LED_LAYER_ALL      ((1u << LED_LAYER_CHANNELS) - 1)
+
+enum led_blend {
+    LED_BLEND_REPLACE,      // layer pixels replace everything below
+    LED_BLEND_OVER,         // non-black pixels replace; black is transparent
+    LED_BLEND_ADD,          // per-component saturating add
+    LED_BLEND_MAX,          // per-component max (DMX-style HTP merge)
+    LED_BLEND_COUNT
+};
+
+struct led_layer {
+    const char *name;
+    int      cap[LED_LAYER_CHANNELS];       // pixels per channel
+    CRGB    *work[LED_LAYER_CHANNELS];      // producer draws here; pointers never change
+    CRGB    *slot[3][LED_LAYER_CHANNELS];   // hand-off buffers
+    uint8_t  slot_mask[3];                  // channels each slot's frame covers
+    void    *mem;                           // backing allocation
+
+    // Composition settings, read by the compositor only
+    int      priority;                      // higher composes later (on top)
+    uint8_t  blend;                         // led_blend
+    uint8_t  opacity;                       // 0-255, 255 = fully applied
+
+    // Producer side
+    uint8_t  mask;                          // channels drawn since the last release
+    uint8_t  back;
+
+    // Compositor side
+    uint8_t  front;
+    bool     has_front;                     // a frame has been taken at least once
+
+    std::atomic<uint32_t> state;            // ready slot index | LED_LAYER_FRESH
+
+    uint32_t commits;                       // frames published
+    uint32_t dropped;                       // published frames replaced before composed
+    uint32_t taken;                         // published frames the compositor picked up
+};
+
+// Allocate the hand-off slots (and work buffers, unless `work` supplies
+// them, e.g. the legacy leds1..4 for the base layer). caps in pixels.
+// Returns false on allocation failure; the layer is then unusable.
+bool  led_layer_init(led_layer *l, const char *name, const int caps[LED_LAYER_CHANNELS],
+                     CRGB *const work[LED_LAYER_CHANNELS], int priority, led_blend blend);
+void  led_layer_free(led_layer *l);
+
+// ---- Producer side (one task per layer at a time) ----
+
+// Work buffer for channel ch (0-based). Marks the channel as drawn by this
+// layer from the next commit on. Null for an out-of-range or empty channel.
+CRGB *led_layer_draw(led_layer *l, int ch);
+
+// Publish the work buffers of all drawn channels as one frame.
+void  led_layer_commit(led_layer *l);
+
+// Stop covering any channel; layers below show through from the next frame.
+void  led_layer_release(led_layer *l);
+
+// ---- Compositor side (render task only) ----
+
+// Take the newest published frame. Returns true if it is new since the
+// last call.
+bool  led_layer_acquire(led_layer *l);
+
+// Blend channel ch of the layer's current frame onto out[0..count).
+void  led_layer_blend(const led_layer *l, int ch, CRGB *out, int count);
+
+// Acquire every layer and compose them onto out[] (cleared to black first)
+// in array order -- pass them sorted with led_layer_sort(). counts[] are
+// the logical channel lengths; out[ch] must hold counts[ch] pixels.
+// Only channels a new frame covers (or covered before it) are recomposed,
+// plus those in `force`; the rest of out[] is left as the caller last saw
+// it. Returns the mask of recomposed channels.
+uint8_t led_layer_compose(led_layer *const *layers, int n,
+                          CRGB *const out[LED_LAYER_CHANNELS], const int counts[LED_LAYER_CHANNELS],
+                          uint8_t force);
+
+// Stable sort by ascending priority.
+void  led_layer_sort(led_layer **v, int n);
+
+const char *led_blend_name(int blend);
+int         led_blend_parse(const char *s);    // -1 if unknown
+
+#endif
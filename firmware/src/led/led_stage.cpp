@@ -0,0 +1,132 @@
+#include <stdlib.h>
+#include <string.h>
+#include "led_stage.h"
+
+// Default wait when a buffer is reloaded while its transmit is still running.
+// Only reachable if a caller skips led_stage_wait(); matches led.cpp's budget.
+#define LED_STAGE_RELOAD_WAIT_MS 100
+
+
+bool led_stage_init(led_stage *st, const int caps[LED_STAGE_CHANNELS])
+{
+    memset(st, 0, sizeof(*st));
+    bool ok = true;
+    for (int ch = 0; ch < LED_STAGE_CHANNELS; ch++) {
+        if (caps[ch] <= 0) continue;
+        st->grb[ch] = (uint8_t *)malloc((size_t)caps[ch] * 3);
+        if (!st->grb[ch]) { ok = false; continue; }
+        st->cap[ch] = caps[ch];
+    }
+    return ok;
+}
+
+
+void led_stage_free(led_stage *st)
+{
+    for (int ch = 0; ch < LED_STAGE_CHANNELS; ch++) {
+        free(st->grb[ch]);
+        st->grb[ch] = NULL;
+        st->cap[ch] = 0;
+        st->len[ch] = 0;
+        st->shown[ch] = 0;
+    }
+}
+
+
+// Wait for channel ch; on timeout abort it so the buffer is released either way.
+static void stage_finish(led_stage *st, const led_tx_ops *ops, int ch, uint32_t timeout_ms)
+{
+    if (!st->in_flight[ch]) return;
+    if (ops->wait(ops->ctx, ch, timeout_ms) == 0) {
+        st->stats[ch].frames++;
+        st->shown[ch] = st->len[ch];
+    } else {
+        ops->abort(ops->ctx, ch);
+        st->stats[ch].timeouts++;
+        st->shown[ch] = 0;          // strip state unknown after a partial frame
+    }
+    st->in_flight[ch] = false;
+}
+
+
+// Convert src into channel ch's buffer (RGB -> GRB for WS2812B) and stage
+// it. Returns true if the staged bytes differ from what the strip shows.
+static bool stage_convert(led_stage *st, const led_tx_ops *ops, int ch, const CRGB *src, int count)
+{
+    // Never rewrite a buffer the backend may still be reading.
+    stage_finish(st, ops, ch, LED_STAGE_RELOAD_WAIT_MS);
+
+    st->len[ch] = 0;
+    if (!src || !st->grb[ch] || count <= 0) return false;
+    if (count > st->cap[ch]) count = st->cap[ch];
+
+    // Compare while converting: a second pass over the buffer would cost
+    // about as much as the conversion itself.
+    size_t len = (size_t)count * 3;
+    uint8_t diff = (st->shown[ch] != len);
+    uint8_t *out = st->grb[ch];
+    for (int i = 0; i < count; i++) {
+        uint8_t g = src[i].g, r = src[i].r, b = src[i].b;
+        diff |= (out[i * 3 + 0] ^ g) | (out[i * 3 + 1] ^ r) | (out[i * 3 + 2] ^ b);
+        out[i * 3 + 0] = g;
+        out[i * 3 + 1] = r;
+        out[i * 3 + 2] = b;
+    }
+    st->len[ch] = len;
+    if (diff) st->shown[ch] = 0;    // buffer no longer matches the strip
+    return diff != 0;
+}
+
+
+void led_stage_load(led_stage *st, const led_tx_ops *ops, int ch, const CRGB *src, int count)
+{
+    if (ch < 0 || ch >= LED_STAGE_CHANNELS) return;
+    stage_convert(st, ops, ch, src, count);
+}
+
+
+bool led_stage_update(led_stage *st, const led_tx_ops *ops, int ch, const CRGB *src, int count)
+{
+    if (ch < 0 || ch >= LED_STAGE_CHANNELS) return false;
+    if (stage_convert(st, ops, ch, src, count)) return true;
+    if (st->len[ch]) {
+        st->len[ch] = 0;
+        st->stats[ch].skipped++;
+    }
+    return false;
+}
+
+
+void led_stage_skip(led_stage *st, int ch)
+{
+    if (ch < 0 || ch >= LED_STAGE_CHANNELS) return;
+    if (st->in_flight[ch]) return;      // kick skips it anyway; len is still owned
+    if (st->shown[ch]) st->stats[ch].skipped++;
+    st->len[ch] = 0;
+}
+
+
+int led_stage_kick(led_stage *st, const led_tx_ops *ops)
+{
+    int queued = 0;
+    for (int ch = 0; ch < LED_STAGE_CHANNELS; ch++) {
+        if (st->len[ch] == 0 || st->in_flight[ch]) continue;
+        if (ops->transmit(ops->ctx, ch, st->grb[ch], st->len[ch]) != 0) {
+            st->stats[ch].errors++;     // not queued -- nothing reading the buffer
+            st->shown[ch] = 0;
+            continue;
+        }
+        st->in_flight[ch] = true;
+        queued++;
+    }
+    return queued;
+}
+
+
+void led_stage_wait(led_stage *st, const led_tx_ops *ops, uint32_t timeout_ms)
+{
+    // Channels run concurrently, so waiting on them in order costs the
+    // longest one, not the sum.
+    for (int ch = 0; ch < LED_STAGE_CHANNELS; ch++)
+        stage_finish(st, ops, ch, timeout_ms);
+}
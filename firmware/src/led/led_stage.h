@@ -0,0 +1,77 @@
+#ifndef _conez_led_stage_h
+#define _conez_led_stage_h
+
+// Per-channel GRB staging buffers for concurrent LED output.
+//
+// Each channel owns its own conversion buffer, so all four strings can be
+// handed to the transmit backend back-to-back and clock out in parallel;
+// frame time becomes the longest string rather than the sum of all four.
+// A staging buffer is only rewritten once the backend has finished with it
+// (led_stage_load() waits out an in-flight transmit first). Because it keeps
+// the last frame a strip received, led_stage_update() can tell an unchanged
+// channel apart and leave it off the wire.
+//
+// Pure C++, no FreeRTOS/IDF dependency: led.cpp plugs in the RMT backend,
+// firmware/test/host plugs in a mock.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "crgb.h"
+
+#define LED_STAGE_CHANNELS 4
+
+// Transmit backend. Channels are 0-based.
+struct led_tx_ops {
+    // Queue an asynchronous transmit of len bytes. Returns 0 if queued. The
+    // backend may keep reading `data` until wait() or abort() returns.
+    int  (*transmit)(void *ctx, int ch, const uint8_t *data, size_t len);
+    // Block until channel ch is done. Returns 0 on completion, nonzero on timeout.
+    int  (*wait)(void *ctx, int ch, uint32_t timeout_ms);
+    // Stop an in-flight transmit; the backend must no longer read the buffer.
+    void (*abort)(void *ctx, int ch);
+    void *ctx;
+};
+
+struct led_stage_chan_stats {
+    uint32_t frames;        // transmits that completed
+    uint32_t errors;        // transmit() refused to queue
+    uint32_t timeouts;      // wait() timed out and the channel was aborted
+    uint32_t skipped;       // frames not sent: channel unchanged
+};
+
+struct led_stage {
+    uint8_t *grb[LED_STAGE_CHANNELS];       // staging buffer, cap*3 bytes
+    int      cap[LED_STAGE_CHANNELS];       // capacity in pixels
+    size_t   len[LED_STAGE_CHANNELS];       // bytes staged for the next/current transmit
+    size_t   shown[LED_STAGE_CHANNELS];     // bytes of grb[] the strip last received intact, 0 = unknown
+    bool     in_flight[LED_STAGE_CHANNELS];
+    led_stage_chan_stats stats[LED_STAGE_CHANNELS];
+};
+
+// Allocate one staging buffer per channel (caps in pixels, 0 = unused).
+// Returns false if any allocation failed; buffers that did allocate stay usable.
+bool led_stage_init(led_stage *st, const int caps[LED_STAGE_CHANNELS]);
+void led_stage_free(led_stage *st);
+
+// Convert `count` pixels of `src` (RGB) into channel ch's buffer as GRB,
+// clamped to the channel capacity. Waits for (or aborts) a transmit still
+// in flight on that channel before touching its buffer. A null src or zero
+// count leaves the channel with nothing staged.
+void led_stage_load(led_stage *st, const led_tx_ops *ops, int ch, const CRGB *src, int count);
+
+// As led_stage_load(), but if the strip already shows exactly this frame
+// nothing is staged and the channel counts as skipped. Returns true if the
+// channel was staged for sending.
+bool led_stage_update(led_stage *st, const led_tx_ops *ops, int ch, const CRGB *src, int count);
+
+// Stage nothing for channel ch this frame (its source didn't change).
+void led_stage_skip(led_stage *st, int ch);
+
+// Start every staged channel. Returns how many transmits were queued.
+int  led_stage_kick(led_stage *st, const led_tx_ops *ops);
+
+// Wait for every in-flight channel. A channel that misses timeout_ms is
+// aborted so it stops reading its buffer and is usable next frame.
+void led_stage_wait(led_stage *st, const led_tx_ops *ops, uint32_t timeout_ms);
+
+#endif
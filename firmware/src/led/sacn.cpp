@@ -0,0 +1,289 @@
+/*
+ * sacn.cpp — sACN (E1.31) UDP receiver for ConeZ firmware
+ *
+ * Listens on UDP port 5568 and joins the multicast group of every mapped
+ * universe (239.255.hi.lo), plus the synchronization universe senders name.
+ * Each LED channel is mapped to a (universe, DMX address) pair via
+ * config.sacn_uni1..4 / sacn_dmx1..4, exactly like ArtNet, and spans
+ * following universes the same way. Packet parsing and source arbitration
+ * live in sacn_rx.cpp, frame assembly in dmx_ingest.cpp (shared with
+ * ArtNet); pixels are written straight into the sACN LED layer, published
+ * once per complete frame and released when the receiver stops.
+ *
+ * The task waits for WiFi if not yet connected, and reopens the socket (and
+ * rejoins its groups) if the connection drops and resumes.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include "lwip/sockets.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "sacn.h"
+#include "config.h"
+#include "led.h"
+#include "conez_wifi.h"
+#include "printManager.h"
+#include "main.h"
+
+#define BUF_SIZE         (126 + 512)
+#define MAX_GROUPS       (DMX_MAX_UNIVERSES + 1)    // mapped universes + sync
+
+static TaskHandle_t      s_task = NULL;
+static volatile bool     s_running = false;
+
+// Packet handling state. Only the receiver task changes it; the mutex lets
+// the CLI read consistent stats.
+static sacn_rx           s_rx;
+static SemaphoreHandle_t s_rx_mutex = NULL;
+
+// Multicast groups the socket has joined
+static uint16_t          s_joined[MAX_GROUPS];
+static int               s_njoined = 0;
+
+// ---------------------------------------------------------------------------
+// Sink: received pixels go straight into the sACN layer's work buffers and
+// are published once dmx_ingest decides the frame is complete
+// ---------------------------------------------------------------------------
+
+static CRGB *sink_buf(void *ctx, int ch, int *count)
+{
+    (void)ctx;
+    CRGB *buf = led_src_buf(LED_SRC_SACN, ch + 1, count);
+    return (buf && *count > 0) ? buf : NULL;
+}
+
+static void sink_commit(void *ctx)
+{
+    (void)ctx;
+    led_src_show(LED_SRC_SACN);
+}
+
+static const dmx_sink s_sink = { sink_buf, sink_commit, NULL };
+
+// Pick up mapping changes ("sacn universe/dmx", "config set", led resize).
+// A changed mapping resets frame, sequence and source state.
+static void apply_config(void)
+{
+    dmx_chan_map map[DMX_CHANNELS] = {
+        { config.sacn_uni1, config.sacn_dmx1, config.led_count1 },
+        { config.sacn_uni2, config.sacn_dmx2, config.led_count2 },
+        { config.sacn_uni3, config.sacn_dmx3, config.led_count3 },
+        { config.sacn_uni4, config.sacn_dmx4, config.led_count4 },
+    };
+    sacn_rx_configure(&s_rx, map);
+}
+
+// ---------------------------------------------------------------------------
+// Multicast membership
+// ---------------------------------------------------------------------------
+
+static bool group_member(int sock, int universe, bool join)
+{
+    struct ip_mreq mreq;
+    memset(&mreq, 0, sizeof(mreq));
+    mreq.imr_multiaddr.s_addr = htonl(sacn_multicast_addr(universe));
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    return setsockopt(sock, IPPROTO_IP, join ? IP_ADD_MEMBERSHIP : IP_DROP_MEMBERSHIP,
+                      &mreq, sizeof(mreq)) == 0;
+}
+
+// Bring the joined groups in line with the mapped universes and the sync
+// universe. Cheap when nothing changed, so it runs after every packet.
+static void update_groups(int sock)
+{
+    uint16_t want[MAX_GROUPS];
+    int nwant = 0;
+    for (int i = 0; i < s_rx.in.nuni; i++)
+        if (s_rx.in.uni[i].universe >= 1 && s_rx.in.uni[i].universe <= SACN_MAX_UNIVERSE)
+            want[nwant++] = s_rx.in.uni[i].universe;
+    if (s_rx.sync_universe) {
+        bool dup = false;
+        for (int i = 0; i < nwant; i++) dup |= want[i] == s_rx.sync_universe;
+        if (!dup) want[nwant++] = s_rx.sync_universe;
+    }
+
+    for (int i = 0; i < s_njoined; ) {
+        bool keep = false;
+        for (int j = 0; j < nwant; j++) keep |= want[j] == s_joined[i];
+        if (keep) { i++; continue; }
+        group_member(sock, s_joined[i], false);
+        s_joined[i] = s_joined[--s_njoined];
+    }
+    for (int j = 0; j < nwant; j++) {
+        bool have = false;
+        for (int i = 0; i < s_njoined; i++) have |= s_joined[i] == want[j];
+        if (have) continue;
+        if (group_member(sock, want[j], true))
+            s_joined[s_njoined++] = want[j];
+        else
+            printfnl(SOURCE_SYSTEM, "[sACN] Can't join universe %u\n", (unsigned)want[j]);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Receiver task
+// ---------------------------------------------------------------------------
+
+static void sacn_task_fun(void *arg)
+{
+    (void)arg;
+
+    uint8_t *buf = (uint8_t *)malloc(BUF_SIZE);
+    if (!buf) {
+        printfnl(SOURCE_SYSTEM, "[sACN] Out of memory\n");
+        s_task = NULL;
+        s_running = false;
+        vTaskDelete(NULL);
+        return;
+    }
+
+    int sock = -1;
+
+    while (s_running) {
+        // Wait for WiFi; close socket if it was open before the disconnect
+        if (!wifi_is_connected()) {
+            if (sock >= 0) {
+                close(sock);
+                sock = -1;
+            }
+            vTaskDelay(pdMS_TO_TICKS(1000));
+            continue;
+        }
+
+        // (Re)open and bind the socket; closing it left all groups
+        if (sock < 0) {
+            s_njoined = 0;
+            sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+            if (sock < 0) {
+                vTaskDelay(pdMS_TO_TICKS(1000));
+                continue;
+            }
+
+            int yes = 1;
+            setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+            struct sockaddr_in addr;
+            memset(&addr, 0, sizeof(addr));
+            addr.sin_family      = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_ANY);
+            addr.sin_port        = htons(SACN_PORT);
+
+            if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+                printfnl(SOURCE_SYSTEM, "[sACN] bind failed\n");
+                close(sock);
+                sock = -1;
+                vTaskDelay(pdMS_TO_TICKS(5000));
+                continue;
+            }
+
+            // Receive timeout short enough to commit a partial frame on
+            // time (dmx_ingest_poll) and to notice s_running going false
+            struct timeval tv;
+            tv.tv_sec  = 0;
+            tv.tv_usec = DMX_FRAME_TIMEOUT_MS * 1000;
+            setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+            printfnl(SOURCE_SYSTEM, "[sACN] Listening on UDP port %d\n", SACN_PORT);
+        }
+
+        xSemaphoreTake(s_rx_mutex, portMAX_DELAY);
+        apply_config();
+        update_groups(sock);
+        xSemaphoreGive(s_rx_mutex);
+
+        struct sockaddr_in from;
+        socklen_t fromlen = sizeof(from);
+        int n = recvfrom(sock, buf, BUF_SIZE, 0,
+                         (struct sockaddr *)&from, &fromlen);
+
+        if (!s_running) break;
+
+        if (n < 0) {
+            // EAGAIN/EWOULDBLOCK = normal timeout; anything else = socket error
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                close(sock);
+                sock = -1;
+                vTaskDelay(pdMS_TO_TICKS(1000));
+            }
+            xSemaphoreTake(s_rx_mutex, portMAX_DELAY);
+            dmx_ingest_poll(&s_rx.in, uptime_ms(), &s_sink);
+            xSemaphoreGive(s_rx_mutex);
+            continue;
+        }
+
+        uint32_t now = uptime_ms();
+        xSemaphoreTake(s_rx_mutex, portMAX_DELAY);
+        sacn_rx_packet(&s_rx, buf, (size_t)n, now, &s_sink);
+        dmx_ingest_poll(&s_rx.in, now, &s_sink);
+        xSemaphoreGive(s_rx_mutex);
+    }
+
+    free(buf);
+    if (sock >= 0) close(sock);
+    s_njoined = 0;
+    led_src_release(LED_SRC_SACN);
+    s_task    = NULL;
+    s_running = false;
+    vTaskDelete(NULL);
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+
+void sacn_setup(void)
+{
+    s_rx_mutex = xSemaphoreCreateMutex();
+    sacn_rx_init(&s_rx);
+    if (config.sacn_enabled)
+        sacn_start();
+}
+
+void sacn_start(void)
+{
+    if (s_task) return;     // already running
+    if (!s_rx_mutex) return;
+    xSemaphoreTake(s_rx_mutex, portMAX_DELAY);
+    sacn_rx_init(&s_rx);
+    xSemaphoreGive(s_rx_mutex);
+    s_running = true;
+    if (xTaskCreate(sacn_task_fun, "sACN", 4096, NULL, 5, &s_task) != pdPASS) {
+        s_running = false;
+        s_task = NULL;
+        printfnl(SOURCE_SYSTEM, "[sACN] task create failed\n");
+        return;
+    }
+    printfnl(SOURCE_SYSTEM, "[sACN] Started\n");
+}
+
+void sacn_stop(void)
+{
+    if (!s_task) return;
+    s_running = false;
+    // Task exits within ~100 ms on the next recvfrom timeout
+    printfnl(SOURCE_SYSTEM, "[sACN] Stopping\n");
+}
+
+bool sacn_running(void) { return s_task != NULL; }
+
+void sacn_get_stats(dmx_stats *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (!s_rx_mutex) return;
+    xSemaphoreTake(s_rx_mutex, portMAX_DELAY);
+    *out = s_rx.in.st;
+    xSemaphoreGive(s_rx_mutex);
+}
+
+int sacn_get_universe_stats(dmx_uni_stats *out, sacn_universe *src, int max)
+{
+    if (!s_rx_mutex) return 0;
+    xSemaphoreTake(s_rx_mutex, portMAX_DELAY);
+    int n = s_rx.in.nuni < max ? s_rx.in.nuni : max;
+    memcpy(out, s_rx.in.uni, (size_t)n * sizeof(*out));
+    memcpy(src, s_rx.uni, (size_t)n * sizeof(*src));
+    xSemaphoreGive(s_rx_mutex);
+    return n;
+}
@@ -0,0 +1,27 @@
+#ifndef SACN_H
+#define SACN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sacn_rx.h"
+
+// Call in setup() after config_init() and led_setup(). Starts the receiver
+// task immediately if config.sacn_enabled is true.
+void sacn_setup(void);
+
+// Start/stop the receiver task. sacn_start() is idempotent (no-op if
+// already running). sacn_stop() signals the task to exit; it finishes
+// within ~100 ms (recvfrom timeout). Neither call saves config.
+void sacn_start(void);
+void sacn_stop(void);
+
+bool sacn_running(void);
+
+// Receiver counters since the last sacn_start().
+void sacn_get_stats(dmx_stats *out);
+
+// Per-universe counters and source arbitration state, in mapping order.
+// Returns the number written.
+int  sacn_get_universe_stats(dmx_uni_stats *out, sacn_universe *src, int max);
+
+#endif
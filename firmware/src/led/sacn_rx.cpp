@@ -0,0 +1,222 @@
+#include <string.h>
+#include "sacn_rx.h"
+
+// Offsets into an E1.31 data packet (root, framing, DMP layers)
+#define SACN_ROOT_VECTOR    18
+#define SACN_CID            22
+#define SACN_FRAME_VECTOR   40
+#define SACN_PRIORITY       108
+#define SACN_SYNC_ADDR      109
+#define SACN_SEQUENCE       111
+#define SACN_OPTIONS        112
+#define SACN_UNIVERSE       113
+#define SACN_DMP_VECTOR     117
+#define SACN_DMP_TYPE       118
+#define SACN_DMP_FIRST      119
+#define SACN_DMP_INCR       121
+#define SACN_DMP_COUNT      123
+#define SACN_START_CODE     125
+#define SACN_DATA_HEADER    126
+
+// ...and into a universe synchronization packet
+#define SACN_SYNC_ADDRESS   45
+#define SACN_SYNC_LEN       49
+
+#define SACN_OPT_PREVIEW    0x80
+#define SACN_OPT_TERMINATED 0x40
+
+static const uint8_t acn_id[12] = { 'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0 };
+
+
+static inline uint16_t be16(const uint8_t *p) { return (uint16_t)((p[0] << 8) | p[1]); }
+static inline uint32_t be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+
+static void reset_sources(sacn_rx *rx)
+{
+    memset(rx->uni, 0, sizeof(rx->uni));
+    for (int i = 0; i < DMX_MAX_UNIVERSES; i++) rx->uni[i].winner = -1;
+    rx->sync_universe = 0;
+}
+
+
+void sacn_rx_init(sacn_rx *rx)
+{
+    dmx_ingest_init(&rx->in, SACN_SOURCE_TIMEOUT_MS);
+    reset_sources(rx);
+    rx->overflow = 0;
+}
+
+
+bool sacn_rx_configure(sacn_rx *rx, const dmx_chan_map map[DMX_CHANNELS])
+{
+    if (!dmx_ingest_configure(&rx->in, map)) return false;
+    reset_sources(rx);
+    return true;
+}
+
+
+// Forget sources not heard from for the data loss timeout.
+static void expire_sources(sacn_universe *su, uint32_t now_ms)
+{
+    for (int i = 0; i < SACN_MAX_SOURCES; i++) {
+        sacn_source *s = &su->src[i];
+        if (s->last_ms && now_ms - s->last_ms >= SACN_SOURCE_TIMEOUT_MS) {
+            s->last_ms = 0;
+            if (su->winner == i) su->winner = -1;
+        }
+    }
+}
+
+
+static int find_source(sacn_universe *su, const uint8_t *cid, bool add)
+{
+    int free_slot = -1;
+    for (int i = 0; i < SACN_MAX_SOURCES; i++) {
+        if (!su->src[i].last_ms) {
+            if (free_slot < 0) free_slot = i;
+        } else if (memcmp(su->src[i].cid, cid, 16) == 0) {
+            return i;
+        }
+    }
+    if (add && free_slot >= 0) {
+        memcpy(su->src[free_slot].cid, cid, 16);
+        su->src[free_slot].last_seq = 0;
+    }
+    return add ? free_slot : -1;
+}
+
+
+// E1.31 6.7.2: a sequence number 1-19 behind the last one (or equal) is
+// out of order; anything further back is taken as the source restarting.
+static bool seq_accept(dmx_uni_stats *u, const sacn_source *s, bool known, uint8_t seq)
+{
+    if (!known) return true;
+    int d = (int8_t)(uint8_t)(seq - s->last_seq);
+    if (d == 0)            { u->dups++; return false; }
+    if (d < 0 && d > -20)  { u->late++; return false; }
+    if (d > 1) u->lost += (uint32_t)(d - 1);
+    return true;
+}
+
+
+// Highest priority wins; the current winner keeps a tie.
+static void arbitrate(sacn_universe *su)
+{
+    int best = su->winner;
+    int live = 0;
+    for (int i = 0; i < SACN_MAX_SOURCES; i++) {
+        if (!su->src[i].last_ms) continue;
+        live++;
+        if (best < 0 || su->src[i].priority > su->src[best].priority) best = i;
+    }
+    if (best != su->winner) su->switches++;
+    su->winner  = (int8_t)best;
+    su->sources = (uint8_t)live;
+}
+
+
+static dmx_rx_result handle_sync(sacn_rx *rx, const uint8_t *pkt, size_t len,
+                                 uint32_t now_ms, const dmx_sink *sink)
+{
+    if (len < SACN_SYNC_LEN || be32(pkt + SACN_FRAME_VECTOR) != SACN_VECTOR_FRAME_SYNC) {
+        rx->in.st.invalid++;
+        return DMX_RX_INVALID;
+    }
+    uint16_t addr = be16(pkt + SACN_SYNC_ADDRESS);
+    if (!addr || addr != rx->sync_universe) {
+        rx->in.st.ignored++;
+        return DMX_RX_IGNORED;
+    }
+    return dmx_ingest_sync(&rx->in, now_ms, sink);
+}
+
+
+dmx_rx_result sacn_rx_packet(sacn_rx *rx, const uint8_t *pkt, size_t len,
+                             uint32_t now_ms, const dmx_sink *sink)
+{
+    dmx_ingest *in = &rx->in;
+    if (len < SACN_SYNC_LEN || be16(pkt) != 0x0010 || be16(pkt + 2) != 0 ||
+        memcmp(pkt + 4, acn_id, sizeof(acn_id)) != 0) {
+        in->st.invalid++;
+        return DMX_RX_INVALID;
+    }
+    uint32_t root = be32(pkt + SACN_ROOT_VECTOR);
+    if (root == SACN_VECTOR_ROOT_EXTENDED)
+        return handle_sync(rx, pkt, len, now_ms, sink);    // discovery is rejected there too
+    if (root != SACN_VECTOR_ROOT_DATA || len < SACN_DATA_HEADER ||
+        be32(pkt + SACN_FRAME_VECTOR) != SACN_VECTOR_FRAME_DATA ||
+        pkt[SACN_DMP_VECTOR] != 0x02 || pkt[SACN_DMP_TYPE] != 0xA1 ||
+        be16(pkt + SACN_DMP_FIRST) != 0 || be16(pkt + SACN_DMP_INCR) != 1) {
+        in->st.invalid++;
+        return DMX_RX_INVALID;
+    }
+
+    int universe = be16(pkt + SACN_UNIVERSE);
+    int count    = be16(pkt + SACN_DMP_COUNT);      // start code + slots
+    if (universe < 1 || universe > SACN_MAX_UNIVERSE || count < 1 || count > 513 ||
+        len < (size_t)(SACN_DATA_HEADER + count - 1)) {
+        in->st.invalid++;
+        return DMX_RX_INVALID;
+    }
+
+    uint8_t options = pkt[SACN_OPTIONS];
+    int idx = dmx_ingest_find(in, universe);
+    if (idx < 0 || (options & SACN_OPT_PREVIEW)) {
+        in->st.ignored++;
+        return DMX_RX_IGNORED;
+    }
+
+    sacn_universe *su = &rx->uni[idx];
+    expire_sources(su, now_ms);
+    const uint8_t *cid = pkt + SACN_CID;
+
+    if (options & SACN_OPT_TERMINATED) {
+        int s = find_source(su, cid, false);
+        if (s >= 0) {
+            su->src[s].last_ms = 0;
+            su->terminated++;
+            if (su->winner == s) su->winner = -1;
+            arbitrate(su);
+        }
+        in->st.ignored++;
+        return DMX_RX_IGNORED;
+    }
+
+    int s = find_source(su, cid, false);
+    bool known = s >= 0;
+    if (!known) s = find_source(su, cid, true);
+    if (s < 0) {
+        rx->overflow++;
+        in->st.ignored++;
+        return DMX_RX_IGNORED;
+    }
+    sacn_source *src = &su->src[s];
+    if (!seq_accept(&in->uni[idx], src, known, pkt[SACN_SEQUENCE])) return DMX_RX_DROPPED;
+    src->last_seq = pkt[SACN_SEQUENCE];
+    src->last_ms  = now_ms ? now_ms : 1;
+    src->priority = pkt[SACN_PRIORITY] <= 200 ? pkt[SACN_PRIORITY] : 200;
+    arbitrate(su);
+
+    if (su->winner != s) {
+        su->outranked++;
+        in->st.ignored++;
+        return DMX_RX_IGNORED;
+    }
+    if (pkt[SACN_START_CODE] != 0 || count < 2) {     // per-address priority, text, ...
+        in->st.ignored++;
+        return DMX_RX_IGNORED;
+    }
+
+    uint16_t sync = be16(pkt + SACN_SYNC_ADDR);
+    if (sync)
+        rx->sync_universe = sync;
+    else if (in->st.sync_mode)
+        dmx_ingest_unsync(in);
+
+    in->uni[idx].last_seq = pkt[SACN_SEQUENCE];
+    return dmx_ingest_data(in, idx, pkt + SACN_DATA_HEADER, count - 1, now_ms, sink);
+}
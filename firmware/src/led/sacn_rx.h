@@ -0,0 +1,74 @@
+#ifndef _conez_sacn_rx_h
+#define _conez_sacn_rx_h
+
+// sACN (ANSI E1.31) packet handling: data and universe-sync parsing,
+// per-source sequence checking and source arbitration, on top of the shared
+// DMX ingest (dmx_ingest.h).
+//
+// Several sources (desks, media servers -- told apart by CID) may send the
+// same universe. The one with the highest priority wins; among equals the
+// current winner keeps it until it stops (stream-terminated flag or 2.5 s
+// of silence), so output never flickers between two sources. Other
+// sources' packets are counted as outranked and dropped. Preview data and
+// alternate start codes are ignored.
+//
+// Data packets naming a synchronization universe are held until a sync
+// packet for it arrives, as long as the sender keeps sending them; a data
+// packet without one returns to committing on frame completion.
+//
+// Pure C++, no FreeRTOS/lwIP dependency: sacn.cpp feeds it from the UDP
+// socket, firmware/test/host feeds it recorded captures.
+
+#include "dmx_ingest.h"
+
+#define SACN_PORT               5568
+#define SACN_MAX_SOURCES        4       // tracked per universe
+#define SACN_SOURCE_TIMEOUT_MS  2500    // E131_NETWORK_DATA_LOSS_TIMEOUT
+#define SACN_DEFAULT_PRIORITY   100
+#define SACN_MAX_UNIVERSE       63999
+
+#define SACN_VECTOR_ROOT_DATA       0x00000004u
+#define SACN_VECTOR_ROOT_EXTENDED   0x00000008u
+#define SACN_VECTOR_FRAME_DATA      0x00000002u
+#define SACN_VECTOR_FRAME_SYNC      0x00000001u
+
+struct sacn_source {
+    uint8_t  cid[16];
+    uint8_t  priority;
+    uint8_t  last_seq;
+    uint32_t last_ms;       // 0 = slot free
+};
+
+struct sacn_universe {
+    sacn_source src[SACN_MAX_SOURCES];
+    int8_t   winner;        // index into src[], -1 = none
+    uint8_t  sources;       // live sources at the last packet
+    uint32_t outranked;     // packets dropped from a source that isn't the winner
+    uint32_t switches;      // winner changes
+    uint32_t terminated;    // streams ended by their source
+};
+
+struct sacn_rx {
+    dmx_ingest    in;
+    sacn_universe uni[DMX_MAX_UNIVERSES];   // parallel to in.uni[]
+    uint16_t      sync_universe;            // named by the last data packet, 0 = none
+    uint32_t      overflow;                 // packets from a source that didn't fit src[]
+};
+
+void sacn_rx_init(sacn_rx *rx);
+
+// Set the channel mapping (universes 1-63999). Resets source state too when
+// it changes; returns true in that case.
+bool sacn_rx_configure(sacn_rx *rx, const dmx_chan_map map[DMX_CHANNELS]);
+
+// Handle one UDP payload received at now_ms.
+dmx_rx_result sacn_rx_packet(sacn_rx *rx, const uint8_t *pkt, size_t len,
+                             uint32_t now_ms, const dmx_sink *sink);
+
+// Multicast group of a universe: 239.255.hi.lo, as a host-order address.
+static inline uint32_t sacn_multicast_addr(int universe)
+{
+    return 0xEFFF0000u | ((uint32_t)universe & 0xFFFFu);
+}
+
+#endif
@@ -47,6 +47,7 @@
 #include "psram.h"
 #include "conez_mqtt.h"
 #include "artnet.h"
+#include "sacn.h"
 #include "loadavg.h"
 #include "pm.h"
 #include "syst_status.h"
@@ -505,6 +506,8 @@ void setup()
 
   // ArtNet receiver — started if artnet_enabled in config
   artnet_setup();
+  // sACN receiver — started if sacn_enabled in config
+  sacn_setup();
 
   sunSetTZOffset(config.timezone);
 
@@ -262,8 +262,11 @@ static void send_heartbeat(void)
         return;
     }
 
+    cue_timing_stats cue_timing;
+    cue_get_timing(&cue_timing);
+
     char payload[MQTT_NODE_STATUS_JSON_MAX];
-    if (mqtt_node_status_format_json(&status, payload, sizeof(payload)) < 0) {
+    if (mqtt_node_status_format_json(&status, &cue_timing, payload, sizeof(payload)) < 0) {
         printfnl(SOURCE_MQTT, "Status JSON build failed\n");
         return;
     }
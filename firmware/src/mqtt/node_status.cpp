@@ -12,7 +12,8 @@ static const char *temp_or_null(int16_t centi, char *buf, size_t bufsz)
     return buf;
 }
 
-int mqtt_node_status_format_json(const node_status *status, char *buf, size_t bufsz)
+int mqtt_node_status_format_json(const node_status *status, const cue_timing_stats *cue,
+                                 char *buf, size_t bufsz)
 {
     if (!status || !buf || bufsz == 0) {
         return -1;
@@ -45,8 +46,7 @@ int mqtt_node_status_format_json(const node_status *status, char *buf, size_t bu
         "\"lat\":%.6f,"
         "\"longitude\":%.6f,"
         "\"tilt_x_deg\":%.2f,"
-        "\"tilt_y_deg\":%.2f"
-        "}",
+        "\"tilt_y_deg\":%.2f",
         (unsigned)status->status,
         (unsigned)status->ver_major,
         (unsigned)status->ver_minor,
@@ -75,5 +75,39 @@ int mqtt_node_status_format_json(const node_status *status, char *buf, size_t bu
     if (n < 0 || (size_t)n >= bufsz) {
         return -1;
     }
+
+    // Cue timing (lateness in ms, loop jitter in us) so fleet-wide sync can be
+    // compared cone by cone. Omitted until the engine has something to report.
+    if (cue && (cue->fires > 0 || cue->loops > 0)) {
+        int m = snprintf(
+            buf + n, bufsz - n,
+            ",\"cue\":{"
+            "\"fires\":%u,"
+            "\"late_p50_ms\":%u,"
+            "\"late_p99_ms\":%u,"
+            "\"late_max_ms\":%u,"
+            "\"jitter_p50_us\":%u,"
+            "\"jitter_p99_us\":%u,"
+            "\"jitter_max_us\":%u"
+            "}",
+            (unsigned)cue->fires,
+            (unsigned)cue->late_p50_ms,
+            (unsigned)cue->late_p99_ms,
+            (unsigned)cue->late_max_ms,
+            (unsigned)cue->jitter_p50_us,
+            (unsigned)cue->jitter_p99_us,
+            (unsigned)cue->jitter_max_us
+        );
+        if (m < 0 || (size_t)(n + m) >= bufsz) {
+            return -1;
+        }
+        n += m;
+    }
+
+    if ((size_t)n + 1 >= bufsz) {
+        return -1;
+    }
+    buf[n++] = '}';
+    buf[n] = '\0';
     return n;
 }
@@ -4,9 +4,12 @@
 #include <stddef.h>
 
 #include "syst_status.h"
+#include "cue.h"
 
-#define MQTT_NODE_STATUS_JSON_MAX 512
+#define MQTT_NODE_STATUS_JSON_MAX 768
 
-int mqtt_node_status_format_json(const node_status *status, char *buf, size_t bufsz);
+// cue may be NULL (or report no samples); the "cue" object is then omitted.
+int mqtt_node_status_format_json(const node_status *status, const cue_timing_stats *cue,
+                                 char *buf, size_t bufsz);
 
 #endif
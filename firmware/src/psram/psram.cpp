@@ -15,6 +15,7 @@
 #include "esp_spiram.h"
 #endif
 #include "psram.h"
+#include "psram_core.h"
 #include "printManager.h"
 #include "conez_usb.h"
 
@@ -90,10 +91,6 @@ static void psram_fb_free_all(void) {
 #define PSRAM_CMD_RESET      0x99
 #define PSRAM_CMD_READ_ID    0x9F
 
-// LY68L6400 wraps a read/write burst within this device page: a single SPI
-// transaction that crosses the boundary corrupts its tail. Bursts must not span it.
-#define PSRAM_DEVICE_PAGE    1024
-
 #define PSRAM_SPI_FREQ_DEFAULT  40000000  // 40 MHz boot default (exact APB/2 divider)
 #define PSRAM_SPI_FREQ_MAX      80000000  // ESP32-S3 FSPI bus max
 
@@ -102,14 +99,9 @@ static void psram_fb_free_all(void) {
 // Must stay below 0x3C000000 so IS_ADDRESS_MAPPED() still returns false.
 #define PSRAM_ADDR_OFFSET    0x10000000UL
 
-// Runtime SPI frequency and derived chunk sizes.
-// Use slow read (0x03, no wait byte) at <= 33 MHz, fast read (0x0B, 1 wait byte) above.
-static uint32_t psram_freq       = PSRAM_SPI_FREQ_DEFAULT;
-static bool     psram_fast_read  = true;    // recalculated by psram_set_freq()
-static int      psram_read_overhead = 5;    // recalculated by psram_set_freq()
-static int      psram_read_chunk = 35;      // recalculated by psram_set_freq()
-static int      psram_write_chunk = 36;     // recalculated by psram_set_freq()
-
+// Burst sizing (from the SPI frequency), page cache and allocator -- see
+// psram_core.h. Everything in it is guarded by psram_mutex.
+static psram_core  s_core;
 
 static bool        psram_ok = false;
 
@@ -244,20 +236,7 @@ static uint32_t psram_actual_freq(uint32_t requested) {
 // Called during setup (with full SPI reconfiguration) and at runtime.
 // Caller must hold psram_mutex (or call before mutex-protected operations begin).
 static void psram_set_freq(uint32_t freq_hz) {
-    psram_freq = psram_actual_freq(freq_hz);
-    psram_fast_read = (psram_freq > 33000000);
-    psram_read_overhead = psram_fast_read ? 5 : 4;
-    // Bytes clockable within the LY68L6400's ~8 us max CE#-low time (tCEM), but
-    // budgeted for 7 us: cs_low(), the cmd.update sync and SPI2_WAIT spins hold
-    // CS# low around the actual clocking, so a full 8 us of data would overshoot
-    // tCEM and risk DRAM refresh loss (bit decay) at elevated temperature.
-    int bytes_per_cem = (psram_freq / 1000000) * 7 / 8;
-    int read_data  = bytes_per_cem - psram_read_overhead;
-    int write_data = bytes_per_cem - 4;
-    // Cap to FIFO size (64 bytes) — hardware cmd/addr/dummy phases are outside
-    // FIFO — and floor at 1 so the raw-transfer loop always makes progress.
-    psram_read_chunk  = (read_data  > 64) ? 64 : (read_data  < 1 ? 1 : read_data);
-    psram_write_chunk = (write_data > 64) ? 64 : (write_data < 1 ? 1 : write_data);
+    psram_core_set_freq(&s_core, psram_actual_freq(freq_hz));
     // SPI clock register is set by the caller (direct GPSPI2.clock.val write).
 }
 
@@ -321,7 +300,7 @@ static uint16_t psram_read_id() {
 
 // Write len bytes to PSRAM at addr.
 // len must be <= 64 (SPI FIFO capacity: 16 × 32-bit words).
-static void psram_write_chunk_fn(uint32_t addr, const uint8_t *buf, size_t len) {
+static void psram_write_chunk_fn(void *ctx, uint32_t addr, const uint8_t *buf, size_t len) {
     if (len == 0 || len > 64) return;  // guard: FIFO is 16 words
     // Configure: command(8-bit WRITE) + address(24-bit) + data(MOSI only)
     GPSPI2.user.val = (1 << 27)   // usr_mosi
@@ -360,17 +339,17 @@ static void psram_write_chunk_fn(uint32_t addr, const uint8_t *buf, size_t len)
 
 // Read len bytes from PSRAM at addr.
 // len must be <= 64 (SPI FIFO capacity: 16 × 32-bit words).
-static void psram_read_chunk_fn(uint32_t addr, uint8_t *buf, size_t len) {
+static void psram_read_chunk_fn(void *ctx, uint32_t addr, uint8_t *buf, size_t len) {
     if (len == 0 || len > 64) return;  // guard: FIFO is 16 words
     // Configure: command(8-bit) + address(24-bit) + [dummy(8-clk)] + data(MISO only)
     uint32_t user_val = (1 << 28)   // usr_miso
                       | (1 << 30)   // usr_addr
                       | (1 << 31);  // usr_command
-    if (psram_fast_read)
+    if (s_core.fast_read)
         user_val |= (1 << 29);     // usr_dummy
     GPSPI2.user.val = user_val;
     GPSPI2.user2.usr_command_bitlen = 7;
-    GPSPI2.user2.usr_command_value = psram_fast_read ? PSRAM_CMD_FAST_READ : PSRAM_CMD_READ;
+    GPSPI2.user2.usr_command_value = s_core.fast_read ? PSRAM_CMD_FAST_READ : PSRAM_CMD_READ;
     GPSPI2.user1.usr_addr_bitlen = 23;
     GPSPI2.user1.usr_dummy_cyclelen = 7;  // 8 dummy clocks - 1 (used only when usr_dummy=1)
     GPSPI2.addr = addr << 8;
@@ -407,139 +386,56 @@ static void psram_read_chunk_fn(uint32_t addr, uint8_t *buf, size_t len) {
     spi2_last_bitlen = -1;
 }
 
-// ---- Internal bulk API (raw 0-based SPI addresses, loops over chunks) ----
+static const psram_chip_ops spi2_chip_ops = { psram_read_chunk_fn, psram_write_chunk_fn };
 
-// Cap a chunk so one SPI burst never crosses a 1 KB device-page boundary.
-// The chunk size (e.g. 35 B) is unaligned, so even a 512-aligned cache-page
-// transfer lands a chunk astride the boundary (raw 1002 + 35 -> 1037); the chip
-// wraps within the page and the tail bytes hit page-start addresses.
-static inline size_t psram_clamp_page(uint32_t addr, size_t n) {
-    size_t to_end = PSRAM_DEVICE_PAGE - (addr & (PSRAM_DEVICE_PAGE - 1));
-    return (n > to_end) ? to_end : n;
+static inline void psram_raw_read(uint32_t addr, uint8_t *buf, size_t len) {
+    psram_core_raw_read(&s_core, addr, buf, len);
 }
 
-static void psram_raw_read(uint32_t addr, uint8_t *buf, size_t len) {
-    while (len > 0) {
-        size_t n = (len > (size_t)psram_read_chunk) ? psram_read_chunk : len;
-        n = psram_clamp_page(addr, n);
-        psram_read_chunk_fn(addr, buf, n);
-        addr += n; buf += n; len -= n;
-    }
-}
-
-static void psram_raw_write(uint32_t addr, const uint8_t *buf, size_t len) {
-    while (len > 0) {
-        size_t n = (len > (size_t)psram_write_chunk) ? psram_write_chunk : len;
-        n = psram_clamp_page(addr, n);
-        psram_write_chunk_fn(addr, buf, n);
-        addr += n; buf += n; len -= n;
-    }
+static inline void psram_raw_write(uint32_t addr, const uint8_t *buf, size_t len) {
+    psram_core_raw_write(&s_core, addr, buf, len);
 }
 
 // ---- DRAM page cache (write-back, LRU eviction) ----
 
-#define CACHE_TAG_EMPTY  0xFFFFFFFFUL  // Internal sentinel for empty cache slots
-
-#if PSRAM_CACHE_PAGES > 0
-
-static_assert((PSRAM_CACHE_PAGE_SIZE & (PSRAM_CACHE_PAGE_SIZE - 1)) == 0,
-              "PSRAM_CACHE_PAGE_SIZE must be power of 2");
-
-#define PSRAM_PAGE_MASK  (~((uint32_t)PSRAM_CACHE_PAGE_SIZE - 1))
-
-typedef struct {
-    uint32_t tag;        // Page-aligned raw PSRAM address, or CACHE_TAG_EMPTY
-    uint32_t last_used;  // Monotonic counter for LRU
-    bool     dirty;
-    uint8_t  data[PSRAM_CACHE_PAGE_SIZE];
-} psram_cache_line_t;
-
-static psram_cache_line_t psram_cache[PSRAM_CACHE_PAGES];
-static uint32_t cache_clock = 0;
-static uint32_t cache_hit_count = 0;
-static uint32_t cache_miss_count = 0;
-
-static void psram_cache_init(void) {
-    for (int i = 0; i < PSRAM_CACHE_PAGES; i++) {
-        psram_cache[i].tag = CACHE_TAG_EMPTY;
-        psram_cache[i].last_used = 0;
-        psram_cache[i].dirty = false;
-    }
-    cache_clock = 0;
-    cache_hit_count = 0;
-    cache_miss_count = 0;
-}
-
-// Find cached page or load it, evicting LRU victim if needed.
-// Caller must hold psram_mutex.
-static psram_cache_line_t *psram_cache_get(uint32_t page_addr) {
-    // Search for hit
-    for (int i = 0; i < PSRAM_CACHE_PAGES; i++) {
-        if (psram_cache[i].tag == page_addr) {
-            psram_cache[i].last_used = ++cache_clock;
-            cache_hit_count++;
-            return &psram_cache[i];
-        }
-    }
-
-    // Miss — find empty slot or LRU victim
-    cache_miss_count++;
-    int victim = 0;
-    uint32_t oldest = UINT32_MAX;
-    for (int i = 0; i < PSRAM_CACHE_PAGES; i++) {
-        if (psram_cache[i].tag == CACHE_TAG_EMPTY) {
-            victim = i;
-            break;
-        }
-        if (psram_cache[i].last_used < oldest) {
-            oldest = psram_cache[i].last_used;
-            victim = i;
-        }
-    }
-
-    // Evict: flush dirty page
-    if (psram_cache[victim].tag != CACHE_TAG_EMPTY && psram_cache[victim].dirty)
-        psram_raw_write(psram_cache[victim].tag, psram_cache[victim].data, PSRAM_CACHE_PAGE_SIZE);
-
-    // Load new page
-    psram_raw_read(page_addr, psram_cache[victim].data, PSRAM_CACHE_PAGE_SIZE);
-    psram_cache[victim].tag = page_addr;
-    psram_cache[victim].last_used = ++cache_clock;
-    psram_cache[victim].dirty = false;
-    return &psram_cache[victim];
-}
-
 void psram_cache_flush(void) {
     PSRAM_LOCK();
-    for (int i = 0; i < PSRAM_CACHE_PAGES; i++) {
-        if (psram_cache[i].tag != CACHE_TAG_EMPTY && psram_cache[i].dirty) {
-            psram_raw_write(psram_cache[i].tag, psram_cache[i].data, PSRAM_CACHE_PAGE_SIZE);
-            psram_cache[i].dirty = false;
-        }
-    }
+    psram_core_flush(&s_core);
     PSRAM_UNLOCK();
 }
 
 void psram_cache_invalidate(void) {
     PSRAM_LOCK();
-    for (int i = 0; i < PSRAM_CACHE_PAGES; i++) {
-        psram_cache[i].tag = CACHE_TAG_EMPTY;
-        psram_cache[i].dirty = false;
-    }
+    psram_core_invalidate(&s_core);
     PSRAM_UNLOCK();
 }
 
-uint32_t psram_cache_hits(void)   { return cache_hit_count; }
-uint32_t psram_cache_misses(void) { return cache_miss_count; }
+uint8_t *psram_cache_pin(uint32_t addr, bool write) {
+    if (IS_ADDRESS_MAPPED(addr) || !psram_ok)
+        return NULL;
+    uint32_t raw = addr - PSRAM_ADDR_OFFSET;
+    if (raw >= BOARD_PSRAM_SIZE)
+        return NULL;
+    PSRAM_LOCK();
+    uint8_t *page = psram_core_pin(&s_core, raw, write);
+    PSRAM_UNLOCK();
+    return page;
+}
 
-#else  // PSRAM_CACHE_PAGES == 0
+void psram_cache_unpin(uint32_t addr) {
+    if (IS_ADDRESS_MAPPED(addr))
+        return;
+    PSRAM_LOCK();
+    psram_core_unpin(&s_core, addr - PSRAM_ADDR_OFFSET);
+    PSRAM_UNLOCK();
+}
 
-static void psram_cache_init(void) {}
-void     psram_cache_flush(void) {}
-void     psram_cache_invalidate(void) {}
+#if PSRAM_CACHE_PAGES > 0
+uint32_t psram_cache_hits(void)   { return s_core.hits; }
+uint32_t psram_cache_misses(void) { return s_core.misses; }
+#else
 uint32_t psram_cache_hits(void)   { return 0; }
 uint32_t psram_cache_misses(void) { return 0; }
-
 #endif
 
 // ---- Public bulk API (offset addresses, cache-aware, thread-safe) ----
@@ -553,19 +449,7 @@ void psram_read(uint32_t addr, uint8_t *buf, size_t len) {
     if (len > BOARD_PSRAM_SIZE || raw > BOARD_PSRAM_SIZE - len)
         return;  // out of bounds
     PSRAM_LOCK();
-#if PSRAM_CACHE_PAGES > 0
-    while (len > 0) {
-        uint32_t page_addr = raw & PSRAM_PAGE_MASK;
-        uint32_t page_off  = raw & (PSRAM_CACHE_PAGE_SIZE - 1);
-        size_t n = PSRAM_CACHE_PAGE_SIZE - page_off;
-        if (n > len) n = len;
-        psram_cache_line_t *line = psram_cache_get(page_addr);
-        memcpy(buf, &line->data[page_off], n);
-        raw += n; buf += n; len -= n;
-    }
-#else
-    psram_raw_read(raw, buf, len);
-#endif
+    psram_core_read(&s_core, raw, buf, len);
     PSRAM_UNLOCK();
 }
 
@@ -578,20 +462,7 @@ void psram_write(uint32_t addr, const uint8_t *buf, size_t len) {
     if (len > BOARD_PSRAM_SIZE || raw > BOARD_PSRAM_SIZE - len)
         return;  // out of bounds
     PSRAM_LOCK();
-#if PSRAM_CACHE_PAGES > 0
-    while (len > 0) {
-        uint32_t page_addr = raw & PSRAM_PAGE_MASK;
-        uint32_t page_off  = raw & (PSRAM_CACHE_PAGE_SIZE - 1);
-        size_t n = PSRAM_CACHE_PAGE_SIZE - page_off;
-        if (n > len) n = len;
-        psram_cache_line_t *line = psram_cache_get(page_addr);
-        memcpy(&line->data[page_off], buf, n);
-        line->dirty = true;
-        raw += n; buf += n; len -= n;
-    }
-#else
-    psram_raw_write(raw, buf, len);
-#endif
+    psram_core_write(&s_core, raw, buf, len);
     PSRAM_UNLOCK();
 }
 
@@ -607,28 +478,7 @@ void psram_write16(uint32_t addr, uint16_t val)  { psram_write(addr, (uint8_t*)&
 void psram_write32(uint32_t addr, uint32_t val)  { psram_write(addr, (uint8_t*)&val, 4); }
 void psram_write64(uint32_t addr, uint64_t val)  { psram_write(addr, (uint8_t*)&val, 8); }
 
-// ---- Free-list allocator ----
-// Entries kept sorted by address in internal RAM. Adjacent free blocks merge on free().
-
-#define PSRAM_ALIGN  4
-#define PSRAM_ALIGN_UP(x)  (((x) + PSRAM_ALIGN - 1) & ~(PSRAM_ALIGN - 1))
-
-typedef struct {
-    uint32_t addr;
-    uint32_t size;
-    bool     used;      // true = allocated, false = free
-} psram_block_t;
-
-static psram_block_t psram_blocks[PSRAM_ALLOC_ENTRIES];
-static int psram_block_count = 0;
-
-static void psram_alloc_init(void) {
-    memset(psram_blocks, 0, sizeof(psram_blocks));
-    psram_blocks[0].addr = 0;
-    psram_blocks[0].size = BOARD_PSRAM_SIZE;
-    psram_blocks[0].used = false;
-    psram_block_count = 1;
-}
+// ---- Allocator (free list in psram_core, heap fallback here) ----
 
 uint32_t psram_malloc(size_t size) {
     if (size == 0)
@@ -636,41 +486,10 @@ uint32_t psram_malloc(size_t size) {
 
     PSRAM_LOCK();
 
-    if (psram_ok) {
-        size_t aligned = PSRAM_ALIGN_UP(size);
-
-        // First-fit scan
-        for (int i = 0; i < psram_block_count; i++) {
-            if (psram_blocks[i].used || psram_blocks[i].size < aligned)
-                continue;
-
-            // Exact fit — just mark used
-            if (psram_blocks[i].size == aligned) {
-                psram_blocks[i].used = true;
-                PSRAM_UNLOCK();
-                return psram_blocks[i].addr + PSRAM_ADDR_OFFSET;
-            }
-
-            // Split: need room for one more entry
-            if (psram_block_count >= PSRAM_ALLOC_ENTRIES)
-                break;  // fall through to system malloc
-
-            // Shift entries after i to make room for the remainder block
-            memmove(&psram_blocks[i + 2], &psram_blocks[i + 1],
-                    (psram_block_count - i - 1) * sizeof(psram_block_t));
-            psram_block_count++;
-
-            // Remainder (free) goes into slot i+1
-            psram_blocks[i + 1].addr = psram_blocks[i].addr + aligned;
-            psram_blocks[i + 1].size = psram_blocks[i].size - aligned;
-            psram_blocks[i + 1].used = false;
-
-            // Allocated block in slot i
-            psram_blocks[i].size = aligned;
-            psram_blocks[i].used = true;
-            PSRAM_UNLOCK();
-            return psram_blocks[i].addr + PSRAM_ADDR_OFFSET;
-        }
+    uint32_t raw;
+    if (psram_ok && psram_core_alloc(&s_core, size, &raw)) {
+        PSRAM_UNLOCK();
+        return raw + PSRAM_ADDR_OFFSET;
     }
 
     // Fallback to system malloc (PSRAM full, out of entries, or not available)
@@ -697,86 +516,44 @@ void psram_free(uint32_t addr) {
         return;
     }
 
-    uint32_t raw = addr - PSRAM_ADDR_OFFSET;
-
-    // Find the block
-    int i;
-    for (i = 0; i < psram_block_count; i++) {
-        if (psram_blocks[i].addr == raw && psram_blocks[i].used)
-            break;
-    }
-    if (i >= psram_block_count) {
-        PSRAM_UNLOCK();
-        return;  // not found or not allocated
-    }
-
-    psram_blocks[i].used = false;
-
-    // Merge with next block if free
-    if (i + 1 < psram_block_count && !psram_blocks[i + 1].used) {
-        psram_blocks[i].size += psram_blocks[i + 1].size;
-        memmove(&psram_blocks[i + 1], &psram_blocks[i + 2],
-                (psram_block_count - i - 2) * sizeof(psram_block_t));
-        psram_block_count--;
-    }
-
-    // Merge with previous block if free
-    if (i > 0 && !psram_blocks[i - 1].used) {
-        psram_blocks[i - 1].size += psram_blocks[i].size;
-        memmove(&psram_blocks[i], &psram_blocks[i + 1],
-                (psram_block_count - i - 1) * sizeof(psram_block_t));
-        psram_block_count--;
-    }
-
+    psram_core_free(&s_core, addr - PSRAM_ADDR_OFFSET);
     PSRAM_UNLOCK();
 }
 
 void psram_free_all(void) {
     PSRAM_LOCK();
-    psram_cache_flush();
-    psram_cache_invalidate();
+    psram_core_flush(&s_core);
+    psram_core_invalidate(&s_core);
     if (psram_ok)
-        psram_alloc_init();
+        psram_core_free_all(&s_core);
     psram_fb_free_all();
     PSRAM_UNLOCK();
 }
 
 size_t psram_bytes_used(void) {
     PSRAM_LOCK();
-    size_t total = 0;
-    for (int i = 0; i < psram_block_count; i++)
-        if (psram_blocks[i].used)
-            total += psram_blocks[i].size;
+    size_t total = psram_core_bytes_used(&s_core);
     PSRAM_UNLOCK();
     return total;
 }
 
 size_t psram_bytes_free(void) {
     PSRAM_LOCK();
-    size_t total = 0;
-    for (int i = 0; i < psram_block_count; i++)
-        if (!psram_blocks[i].used)
-            total += psram_blocks[i].size;
+    size_t total = psram_core_bytes_free(&s_core);
     PSRAM_UNLOCK();
     return total;
 }
 
 size_t psram_bytes_contiguous(void) {
     PSRAM_LOCK();
-    size_t largest = 0;
-    for (int i = 0; i < psram_block_count; i++)
-        if (!psram_blocks[i].used && psram_blocks[i].size > largest)
-            largest = psram_blocks[i].size;
+    size_t largest = psram_core_bytes_contiguous(&s_core);
     PSRAM_UNLOCK();
     return largest;
 }
 
 int psram_alloc_count(void) {
     PSRAM_LOCK();
-    int n = 0;
-    for (int i = 0; i < psram_block_count; i++)
-        if (psram_blocks[i].used)
-            n++;
+    int n = psram_core_alloc_count(&s_core);
     PSRAM_UNLOCK();
     return n;
 }
@@ -800,6 +577,7 @@ int psram_setup(void) {
     // We own the FSPI bus exclusively — no other peripheral shares it.
     // Direct register access via GPSPI2 — no Arduino SPI locks involved.
     // Runtime freq changes from ShellTask write the clock register directly.
+    psram_core_init(&s_core, BOARD_PSRAM_SIZE, &spi2_chip_ops, NULL);
     spi2_init(PSR_SCK, PSR_MISO, PSR_MOSI, PSRAM_SPI_FREQ_DEFAULT);
     psram_set_freq(PSRAM_SPI_FREQ_DEFAULT);
 
@@ -848,8 +626,6 @@ int psram_setup(void) {
         return -3;
     }
 
-    psram_alloc_init();
-    psram_cache_init();
     psram_ok = true;
     usb_printf("OK (8 MB)\n");
     return 0;
@@ -962,10 +738,10 @@ void psram_print_map(void) {
         uint32_t rend   = rstart + region_size;
         uint32_t used = 0;
 
-        for (int i = 0; i < psram_block_count; i++) {
-            if (!psram_blocks[i].used) continue;
-            uint32_t bstart = psram_blocks[i].addr;
-            uint32_t bend   = bstart + psram_blocks[i].size;
+        for (int i = 0; i < s_core.nblocks; i++) {
+            if (!s_core.blocks[i].used) continue;
+            uint32_t bstart = s_core.blocks[i].addr;
+            uint32_t bend   = bstart + s_core.blocks[i].size;
             if (bend <= rstart || bstart >= rend) continue;
             uint32_t os = (bstart > rstart) ? bstart : rstart;
             uint32_t oe = (bend < rend) ? bend : rend;
@@ -995,8 +771,9 @@ void psram_print_cache_map(void) {
     char map[PSRAM_CACHE_PAGES + 1];
     PSRAM_LOCK();
     for (int i = 0; i < PSRAM_CACHE_PAGES; i++) {
-        if (psram_cache[i].tag == CACHE_TAG_EMPTY) map[i] = '-';
-        else if (psram_cache[i].dirty)             map[i] = 'D';
+        if (s_core.cache[i].tag == PSRAM_CACHE_TAG_EMPTY) map[i] = '-';
+        else if (s_core.cache[i].pins)                    map[i] = 'P';
+        else if (s_core.cache[i].dirty)                   map[i] = 'D';
         else                                       map[i] = 'C';
     }
     PSRAM_UNLOCK();
@@ -1005,9 +782,10 @@ void psram_print_cache_map(void) {
     if (getAnsiEnabled())
         printfnl(SOURCE_COMMANDS, "             \033[38;5;240m-\033[0m empty  "
                    "\033[32mC\033[0m clean  "
-                   "\033[31mD\033[0m dirty\n");
+                   "\033[31mD\033[0m dirty  "
+                   "\033[36mP\033[0m pinned\n");
     else
-        printfnl(SOURCE_COMMANDS, "             - empty  C clean  D dirty\n");
+        printfnl(SOURCE_COMMANDS, "             - empty  C clean  D dirty  P pinned\n");
 #endif
 }
 
@@ -1025,24 +803,25 @@ void psram_print_cache_detail(void) {
     int used = 0, dirty = 0;
     uint32_t max_used = 0;
     for (int i = 0; i < PSRAM_CACHE_PAGES; i++) {
-        if (psram_cache[i].tag != CACHE_TAG_EMPTY) {
+        const psram_cache_line *line = &s_core.cache[i];
+        if (line->tag != PSRAM_CACHE_TAG_EMPTY) {
             used++;
-            if (psram_cache[i].dirty) dirty++;
-            if (psram_cache[i].last_used > max_used) max_used = psram_cache[i].last_used;
+            if (line->dirty) dirty++;
+            if (line->last_used > max_used) max_used = line->last_used;
         }
     }
-    printfnl(SOURCE_COMMANDS, "Used:  %d / %d  (dirty: %d)\n", used, PSRAM_CACHE_PAGES, dirty);
-    printfnl(SOURCE_COMMANDS, "Clock: %u\n\n", cache_clock);
+    printfnl(SOURCE_COMMANDS, "Used:  %d / %d  (dirty: %d, pinned: %d)\n",
+             used, PSRAM_CACHE_PAGES, dirty, s_core.npinned);
+    printfnl(SOURCE_COMMANDS, "Clock: %u\n\n", s_core.cache_clock);
 
     if (used > 0) {
-        printfnl(SOURCE_COMMANDS, "Page  Address     Dirty  Age\n");
-        printfnl(SOURCE_COMMANDS, "----  ----------  -----  --------\n");
+        printfnl(SOURCE_COMMANDS, "Page  Address     Dirty  Pins  Age\n");
+        printfnl(SOURCE_COMMANDS, "----  ----------  -----  ----  --------\n");
         for (int i = 0; i < PSRAM_CACHE_PAGES; i++) {
-            if (psram_cache[i].tag == CACHE_TAG_EMPTY) continue;
-            printfnl(SOURCE_COMMANDS, "%3d   0x%08X  %-5s  %u\n",
-                     i, psram_cache[i].tag,
-                     psram_cache[i].dirty ? "yes" : "no",
-                     psram_cache[i].last_used);
+            const psram_cache_line *line = &s_core.cache[i];
+            if (line->tag == PSRAM_CACHE_TAG_EMPTY) continue;
+            printfnl(SOURCE_COMMANDS, "%3d   0x%08X  %-5s  %4u  %u\n",
+                     i, line->tag, line->dirty ? "yes" : "no", line->pins, line->last_used);
         }
     }
     PSRAM_UNLOCK();
@@ -1054,13 +833,13 @@ void psram_print_cache_detail(void) {
 uint32_t psram_size(void) { return BOARD_PSRAM_SIZE; }
 bool psram_available(void) { return psram_ok; }
 
-uint32_t psram_get_freq(void) { return psram_freq; }
+uint32_t psram_get_freq(void) { return s_core.freq; }
 
 int psram_change_freq(uint32_t freq_hz) {
     if (!psram_ok) return -1;
     if (freq_hz < 5000000 || freq_hz > PSRAM_SPI_FREQ_MAX) return -1;
     PSRAM_LOCK();
-    psram_cache_flush();
+    psram_core_flush(&s_core);
     psram_set_freq(freq_hz);
     // Write the SPI2 clock register directly — safe under psram_mutex.
     GPSPI2.clock.val = spi_freq_to_clkdiv(freq_hz);
@@ -1301,6 +1080,8 @@ void     psram_cache_flush(void) {}
 void     psram_cache_invalidate(void) {}
 uint32_t psram_cache_hits(void)   { return 0; }
 uint32_t psram_cache_misses(void) { return 0; }
+uint8_t *psram_cache_pin(uint32_t, bool) { return NULL; }
+void     psram_cache_unpin(uint32_t) {}
 
 void psram_print_map(void) {}           // No block table for native PSRAM
 void psram_print_cache_map(void) {}
@@ -1362,6 +1143,8 @@ void     psram_cache_flush(void) {}
 void     psram_cache_invalidate(void) {}
 uint32_t psram_cache_hits(void)   { return 0; }
 uint32_t psram_cache_misses(void) { return 0; }
+uint8_t *psram_cache_pin(uint32_t, bool) { return NULL; }
+void     psram_cache_unpin(uint32_t) {}
 void     psram_print_map(void) {}
 void     psram_print_cache_map(void) {}
 void     psram_print_cache_detail(void) {}
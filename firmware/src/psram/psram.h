@@ -178,12 +178,25 @@ int      psram_alloc_entries_max(void); // Max allocation slots (PSRAM_ALLOC_ENT
 #ifndef PSRAM_CACHE_PAGE_SIZE
 #define PSRAM_CACHE_PAGE_SIZE  512  // Bytes per page (must be power of 2)
 #endif
+#ifndef PSRAM_CACHE_PIN_MAX
+#define PSRAM_CACHE_PIN_MAX    (PSRAM_CACHE_PAGES / 2)  // Pinned pages, all holders together
+#endif
 
 void     psram_cache_flush(void);       // Write all dirty pages back to PSRAM
-void     psram_cache_invalidate(void);  // Discard all cached pages (drops dirty data!)
+void     psram_cache_invalidate(void);  // Discard unpinned cached pages (drops dirty data!)
 uint32_t psram_cache_hits(void);
 uint32_t psram_cache_misses(void);
 
+// Pin the cache page holding a PSRAM virtual address and return a direct
+// pointer to its PSRAM_CACHE_PAGE_SIZE bytes (addr rounded down to the page).
+// The page stays resident -- and the pointer valid -- until the matching
+// psram_cache_unpin(). Pass write=true before storing through the pointer so
+// the page is written back. NULL if the address is not SPI PSRAM, the cache
+// is disabled, or PSRAM_CACHE_PIN_MAX pages are already pinned; fall back to
+// psram_read/psram_write then. Used by the wasm3 software TLB.
+uint8_t *psram_cache_pin(uint32_t addr, bool write);
+void     psram_cache_unpin(uint32_t addr);
+
 // ---- Memory operations ----
 //
 // Accept any address type (PSRAM virtual or mapped RAM). Use IS_ADDRESS_MAPPED()
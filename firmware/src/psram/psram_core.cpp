@@ -0,0 +1,344 @@
+#include <string.h>
+#include "psram_core.h"
+
+#define PSRAM_ALIGN  4
+#define PSRAM_ALIGN_UP(x)  (((x) + PSRAM_ALIGN - 1) & ~(PSRAM_ALIGN - 1))
+
+
+void psram_core_init(psram_core *pc, uint32_t size, const psram_chip_ops *ops, void *ctx)
+{
+    pc->ops  = ops;
+    pc->ctx  = ctx;
+    pc->size = size;
+#if PSRAM_CACHE_PAGES > 0
+    for (int i = 0; i < PSRAM_CACHE_PAGES; i++) {
+        pc->cache[i].last_used = 0;
+        pc->cache[i].pins = 0;
+    }
+    pc->cache_clock = 0;
+    pc->hits = 0;
+    pc->misses = 0;
+    pc->npinned = 0;
+#endif
+    psram_core_invalidate(pc);
+    psram_core_free_all(pc);
+}
+
+
+void psram_core_set_freq(psram_core *pc, uint32_t freq_hz)
+{
+    pc->freq = freq_hz;
+    pc->fast_read = (freq_hz > 33000000);
+    int read_overhead = pc->fast_read ? 5 : 4;
+    // Bytes clockable within the LY68L6400's ~8 us max CE#-low time (tCEM), but
+    // budgeted for 7 us: cs_low(), the cmd.update sync and SPI2_WAIT spins hold
+    // CS# low around the actual clocking, so a full 8 us of data would overshoot
+    // tCEM and risk DRAM refresh loss (bit decay) at elevated temperature.
+    int bytes_per_cem = (int)(freq_hz / 1000000) * 7 / 8;
+    int read_data  = bytes_per_cem - read_overhead;
+    int write_data = bytes_per_cem - 4;
+    // Cap to FIFO size (64 bytes) — hardware cmd/addr/dummy phases are outside
+    // FIFO — and floor at 1 so the raw-transfer loop always makes progress.
+    pc->read_chunk  = (read_data  > 64) ? 64 : (read_data  < 1 ? 1 : read_data);
+    pc->write_chunk = (write_data > 64) ? 64 : (write_data < 1 ? 1 : write_data);
+}
+
+
+// ---- Bursts ----
+
+// Cap a chunk so one SPI burst never crosses a 1 KB device-page boundary.
+// The chunk size (e.g. 35 B) is unaligned, so even a 512-aligned cache-page
+// transfer lands a chunk astride the boundary (raw 1002 + 35 -> 1037); the chip
+// wraps within the page and the tail bytes hit page-start addresses.
+static inline size_t clamp_page(uint32_t addr, size_t n)
+{
+    size_t to_end = PSRAM_DEVICE_PAGE - (addr & (PSRAM_DEVICE_PAGE - 1));
+    return (n > to_end) ? to_end : n;
+}
+
+void psram_core_raw_read(psram_core *pc, uint32_t addr, uint8_t *buf, size_t len)
+{
+    while (len > 0) {
+        size_t n = (len > (size_t)pc->read_chunk) ? pc->read_chunk : len;
+        n = clamp_page(addr, n);
+        pc->ops->read(pc->ctx, addr, buf, n);
+        addr += n; buf += n; len -= n;
+    }
+}
+
+void psram_core_raw_write(psram_core *pc, uint32_t addr, const uint8_t *buf, size_t len)
+{
+    while (len > 0) {
+        size_t n = (len > (size_t)pc->write_chunk) ? pc->write_chunk : len;
+        n = clamp_page(addr, n);
+        pc->ops->write(pc->ctx, addr, buf, n);
+        addr += n; buf += n; len -= n;
+    }
+}
+
+
+// ---- DRAM page cache (write-back, LRU eviction) ----
+
+#if PSRAM_CACHE_PAGES > 0
+
+static_assert((PSRAM_CACHE_PAGE_SIZE & (PSRAM_CACHE_PAGE_SIZE - 1)) == 0,
+              "PSRAM_CACHE_PAGE_SIZE must be power of 2");
+static_assert(PSRAM_CACHE_PIN_MAX < PSRAM_CACHE_PAGES,
+              "PSRAM_CACHE_PIN_MAX must leave evictable pages");
+
+#define PSRAM_PAGE_MASK  (~((uint32_t)PSRAM_CACHE_PAGE_SIZE - 1))
+
+// Find cached page or load it, evicting LRU victim if needed.
+static psram_cache_line *cache_get(psram_core *pc, uint32_t page_addr)
+{
+    // Search for hit
+    for (int i = 0; i < PSRAM_CACHE_PAGES; i++) {
+        if (pc->cache[i].tag == page_addr) {
+            pc->cache[i].last_used = ++pc->cache_clock;
+            pc->hits++;
+            return &pc->cache[i];
+        }
+    }
+
+    // Miss — find empty slot or LRU victim (never a pinned page; the pin
+    // limit guarantees an unpinned one)
+    pc->misses++;
+    int victim = 0;
+    uint32_t oldest = UINT32_MAX;
+    for (int i = 0; i < PSRAM_CACHE_PAGES; i++) {
+        if (pc->cache[i].tag == PSRAM_CACHE_TAG_EMPTY) {
+            victim = i;
+            break;
+        }
+        if (pc->cache[i].pins == 0 && pc->cache[i].last_used < oldest) {
+            oldest = pc->cache[i].last_used;
+            victim = i;
+        }
+    }
+    psram_cache_line *line = &pc->cache[victim];
+
+    // Evict: flush dirty page
+    if (line->tag != PSRAM_CACHE_TAG_EMPTY && line->dirty)
+        psram_core_raw_write(pc, line->tag, line->data, PSRAM_CACHE_PAGE_SIZE);
+
+    // Load new page
+    psram_core_raw_read(pc, page_addr, line->data, PSRAM_CACHE_PAGE_SIZE);
+    line->tag = page_addr;
+    line->last_used = ++pc->cache_clock;
+    line->dirty = false;
+    return line;
+}
+
+void psram_core_read(psram_core *pc, uint32_t addr, uint8_t *buf, size_t len)
+{
+    while (len > 0) {
+        uint32_t page_addr = addr & PSRAM_PAGE_MASK;
+        uint32_t page_off  = addr & (PSRAM_CACHE_PAGE_SIZE - 1);
+        size_t n = PSRAM_CACHE_PAGE_SIZE - page_off;
+        if (n > len) n = len;
+        psram_cache_line *line = cache_get(pc, page_addr);
+        memcpy(buf, &line->data[page_off], n);
+        addr += n; buf += n; len -= n;
+    }
+}
+
+void psram_core_write(psram_core *pc, uint32_t addr, const uint8_t *buf, size_t len)
+{
+    while (len > 0) {
+        uint32_t page_addr = addr & PSRAM_PAGE_MASK;
+        uint32_t page_off  = addr & (PSRAM_CACHE_PAGE_SIZE - 1);
+        size_t n = PSRAM_CACHE_PAGE_SIZE - page_off;
+        if (n > len) n = len;
+        psram_cache_line *line = cache_get(pc, page_addr);
+        memcpy(&line->data[page_off], buf, n);
+        line->dirty = true;
+        addr += n; buf += n; len -= n;
+    }
+}
+
+void psram_core_flush(psram_core *pc)
+{
+    for (int i = 0; i < PSRAM_CACHE_PAGES; i++) {
+        psram_cache_line *line = &pc->cache[i];
+        if (line->tag != PSRAM_CACHE_TAG_EMPTY && line->dirty) {
+            psram_core_raw_write(pc, line->tag, line->data, PSRAM_CACHE_PAGE_SIZE);
+            line->dirty = (line->pins > 0);
+        }
+    }
+}
+
+void psram_core_invalidate(psram_core *pc)
+{
+    for (int i = 0; i < PSRAM_CACHE_PAGES; i++) {
+        if (pc->cache[i].pins) continue;    // someone holds a pointer into it
+        pc->cache[i].tag = PSRAM_CACHE_TAG_EMPTY;
+        pc->cache[i].dirty = false;
+    }
+}
+
+uint8_t *psram_core_pin(psram_core *pc, uint32_t addr, bool write)
+{
+    uint32_t page_addr = addr & PSRAM_PAGE_MASK;
+    if (pc->npinned >= PSRAM_CACHE_PIN_MAX) {
+        // Only pages that are already pinned can take another holder
+        int i;
+        for (i = 0; i < PSRAM_CACHE_PAGES; i++)
+            if (pc->cache[i].tag == page_addr && pc->cache[i].pins) break;
+        if (i == PSRAM_CACHE_PAGES) return NULL;
+    }
+    psram_cache_line *line = cache_get(pc, page_addr);
+    if (line->pins == 0) pc->npinned++;
+    line->pins++;
+    if (write) line->dirty = true;
+    return line->data;
+}
+
+void psram_core_unpin(psram_core *pc, uint32_t addr)
+{
+    uint32_t page_addr = addr & PSRAM_PAGE_MASK;
+    for (int i = 0; i < PSRAM_CACHE_PAGES; i++) {
+        psram_cache_line *line = &pc->cache[i];
+        if (line->tag == page_addr && line->pins) {
+            if (--line->pins == 0) pc->npinned--;
+            return;
+        }
+    }
+}
+
+#else  // PSRAM_CACHE_PAGES == 0
+
+void psram_core_read(psram_core *pc, uint32_t addr, uint8_t *buf, size_t len)
+{
+    psram_core_raw_read(pc, addr, buf, len);
+}
+
+void psram_core_write(psram_core *pc, uint32_t addr, const uint8_t *buf, size_t len)
+{
+    psram_core_raw_write(pc, addr, buf, len);
+}
+
+void psram_core_flush(psram_core *pc) {}
+void psram_core_invalidate(psram_core *pc) {}
+uint8_t *psram_core_pin(psram_core *pc, uint32_t addr, bool write) { return NULL; }
+void psram_core_unpin(psram_core *pc, uint32_t addr) {}
+
+#endif
+
+
+// ---- Free-list allocator ----
+
+void psram_core_free_all(psram_core *pc)
+{
+    memset(pc->blocks, 0, sizeof(pc->blocks));
+    pc->blocks[0].addr = 0;
+    pc->blocks[0].size = pc->size;
+    pc->blocks[0].used = false;
+    pc->nblocks = 1;
+}
+
+bool psram_core_alloc(psram_core *pc, size_t size, uint32_t *addr)
+{
+    size_t aligned = PSRAM_ALIGN_UP(size);
+
+    // First-fit scan
+    for (int i = 0; i < pc->nblocks; i++) {
+        psram_block *b = &pc->blocks[i];
+        if (b->used || b->size < aligned)
+            continue;
+
+        // Exact fit — just mark used
+        if (b->size == aligned) {
+            b->used = true;
+            *addr = b->addr;
+            return true;
+        }
+
+        // Split: need room for one more entry
+        if (pc->nblocks >= PSRAM_ALLOC_ENTRIES)
+            return false;
+
+        // Shift entries after i to make room for the remainder block
+        memmove(&pc->blocks[i + 2], &pc->blocks[i + 1],
+                (pc->nblocks - i - 1) * sizeof(psram_block));
+        pc->nblocks++;
+
+        // Remainder (free) goes into slot i+1
+        pc->blocks[i + 1].addr = b->addr + (uint32_t)aligned;
+        pc->blocks[i + 1].size = b->size - (uint32_t)aligned;
+        pc->blocks[i + 1].used = false;
+
+        // Allocated block in slot i
+        b->size = (uint32_t)aligned;
+        b->used = true;
+        *addr = b->addr;
+        return true;
+    }
+    return false;
+}
+
+bool psram_core_free(psram_core *pc, uint32_t addr)
+{
+    // Find the block
+    int i;
+    for (i = 0; i < pc->nblocks; i++) {
+        if (pc->blocks[i].addr == addr && pc->blocks[i].used)
+            break;
+    }
+    if (i >= pc->nblocks)
+        return false;  // not found or not allocated
+
+    pc->blocks[i].used = false;
+
+    // Merge with next block if free
+    if (i + 1 < pc->nblocks && !pc->blocks[i + 1].used) {
+        pc->blocks[i].size += pc->blocks[i + 1].size;
+        memmove(&pc->blocks[i + 1], &pc->blocks[i + 2],
+                (pc->nblocks - i - 2) * sizeof(psram_block));
+        pc->nblocks--;
+    }
+
+    // Merge with previous block if free
+    if (i > 0 && !pc->blocks[i - 1].used) {
+        pc->blocks[i - 1].size += pc->blocks[i].size;
+        memmove(&pc->blocks[i], &pc->blocks[i + 1],
+                (pc->nblocks - i - 1) * sizeof(psram_block));
+        pc->nblocks--;
+    }
+    return true;
+}
+
+size_t psram_core_bytes_used(const psram_core *pc)
+{
+    size_t total = 0;
+    for (int i = 0; i < pc->nblocks; i++)
+        if (pc->blocks[i].used)
+            total += pc->blocks[i].size;
+    return total;
+}
+
+size_t psram_core_bytes_free(const psram_core *pc)
+{
+    size_t total = 0;
+    for (int i = 0; i < pc->nblocks; i++)
+        if (!pc->blocks[i].used)
+            total += pc->blocks[i].size;
+    return total;
+}
+
+size_t psram_core_bytes_contiguous(const psram_core *pc)
+{
+    size_t largest = 0;
+    for (int i = 0; i < pc->nblocks; i++)
+        if (!pc->blocks[i].used && pc->blocks[i].size > largest)
+            largest = pc->blocks[i].size;
+    return largest;
+}
+
+int psram_core_alloc_count(const psram_core *pc)
+{
+    int n = 0;
+    for (int i = 0; i < pc->nblocks; i++)
+        if (pc->blocks[i].used)
+            n++;
+    return n;
+}
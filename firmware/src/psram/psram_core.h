@@ -0,0 +1,106 @@
+#ifndef _conez_psram_core_h
+#define _conez_psram_core_h
+
+// Hardware-independent half of the improvised SPI PSRAM driver: burst
+// sizing, the write-back DRAM page cache and the free-list allocator.
+//
+// Addresses here are raw chip offsets (0..size-1), not the 0x10000000-based
+// virtual addresses of the public API, and nothing here locks -- psram.cpp
+// adds both, plus the heap fallback.
+//
+// Pure C++, no FreeRTOS/IDF dependency: psram.cpp plugs in the FSPI
+// register transfers, firmware/test/host plugs in a simulated chip.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "psram.h"      // PSRAM_CACHE_PAGES, PSRAM_CACHE_PAGE_SIZE, PSRAM_ALLOC_ENTRIES
+
+// LY68L6400 wraps a read/write burst within this device page: a single SPI
+// transaction that crosses the boundary corrupts its tail. Bursts must not span it.
+#define PSRAM_DEVICE_PAGE    1024
+
+#define PSRAM_CACHE_TAG_EMPTY  0xFFFFFFFFUL
+
+// Chip backend: one SPI burst of len <= 64 bytes (the FIFO), never crossing
+// a PSRAM_DEVICE_PAGE boundary.
+struct psram_chip_ops {
+    void (*read) (void *ctx, uint32_t addr, uint8_t *buf, size_t len);
+    void (*write)(void *ctx, uint32_t addr, const uint8_t *buf, size_t len);
+};
+
+struct psram_cache_line {
+    uint32_t tag;           // page-aligned raw address, or PSRAM_CACHE_TAG_EMPTY
+    uint32_t last_used;     // cache clock at the last access, for LRU
+    bool     dirty;
+    uint8_t  pins;          // psram_core_pin() holders; pinned lines are never evicted
+    uint8_t  data[PSRAM_CACHE_PAGE_SIZE];
+};
+
+// Allocator table entry. Kept sorted by address; adjacent free blocks merge.
+struct psram_block {
+    uint32_t addr;
+    uint32_t size;
+    bool     used;
+};
+
+struct psram_core {
+    const psram_chip_ops *ops;
+    void    *ctx;
+    uint32_t size;              // chip capacity
+
+    // Burst sizing, from psram_core_set_freq()
+    uint32_t freq;
+    bool     fast_read;         // 0x0B with a wait byte above 33 MHz, else 0x03
+    int      read_chunk;        // data bytes per read burst
+    int      write_chunk;       // ...and per write burst
+
+#if PSRAM_CACHE_PAGES > 0
+    psram_cache_line cache[PSRAM_CACHE_PAGES];
+    uint32_t cache_clock;
+    uint32_t hits;
+    uint32_t misses;
+    int      npinned;           // lines with pins > 0, at most PSRAM_CACHE_PIN_MAX
+#endif
+
+    psram_block blocks[PSRAM_ALLOC_ENTRIES];
+    int      nblocks;
+};
+
+// Attach a chip of `size` bytes; empties the cache and the allocator.
+void psram_core_init(psram_core *pc, uint32_t size, const psram_chip_ops *ops, void *ctx);
+
+// Size bursts for the actual SPI clock so CE# stays low under tCEM.
+void psram_core_set_freq(psram_core *pc, uint32_t freq_hz);
+
+// Uncached transfers of any length, split into bursts.
+void psram_core_raw_read (psram_core *pc, uint32_t addr, uint8_t *buf, size_t len);
+void psram_core_raw_write(psram_core *pc, uint32_t addr, const uint8_t *buf, size_t len);
+
+// Transfers through the page cache (straight through when it is disabled).
+// The caller bounds-checks.
+void psram_core_read (psram_core *pc, uint32_t addr, uint8_t *buf, size_t len);
+void psram_core_write(psram_core *pc, uint32_t addr, const uint8_t *buf, size_t len);
+
+void psram_core_flush(psram_core *pc);          // write dirty pages back
+void psram_core_invalidate(psram_core *pc);     // drop all unpinned pages, dirty or not
+
+// Load the page holding addr and keep it resident until unpinned, returning
+// its data: the caller may then access the page directly, without locking.
+// A pinned page counts as dirty from the first pin with `write` on, and
+// stays dirty through flushes while pinned, since writes through the pointer
+// go unseen. NULL when the cache is disabled or PSRAM_CACHE_PIN_MAX lines
+// are already pinned.
+uint8_t *psram_core_pin(psram_core *pc, uint32_t addr, bool write);
+void     psram_core_unpin(psram_core *pc, uint32_t addr);
+
+// First-fit allocation, 4-byte aligned. Returns false when nothing fits or
+// the table is full; *addr is a raw offset.
+bool   psram_core_alloc(psram_core *pc, size_t size, uint32_t *addr);
+bool   psram_core_free(psram_core *pc, uint32_t addr);
+void   psram_core_free_all(psram_core *pc);
+size_t psram_core_bytes_used(const psram_core *pc);
+size_t psram_core_bytes_free(const psram_core *pc);
+size_t psram_core_bytes_contiguous(const psram_core *pc);
+int    psram_core_alloc_count(const psram_core *pc);
+
+#endif
@@ -15,6 +15,7 @@
 static portMUX_TYPE time_mux = portMUX_INITIALIZER_UNLOCKED;
 static volatile uint64_t epoch_at_pps = 0;      // epoch ms at last PPS/NTP update
 static volatile uint32_t millis_at_pps = 0;     // uptime_ms() at that same moment
+static volatile uint16_t us_frac_at_pps = 0;    // sub-ms part of that moment (GPS+PPS only)
 static volatile bool     epoch_valid = false;
 static volatile uint8_t  time_source = 0;        // 0=none, 1=NTP, 2=GPS+PPS
 static volatile uint32_t ntp_last_sync = 0;      // uptime_ms() at last NTP sync (0=never)
@@ -34,6 +35,7 @@ static void ntp_sync_cb(struct timeval *tv)
     }
     epoch_at_pps = ep;
     millis_at_pps = now_m;
+    us_frac_at_pps = 0;
     epoch_valid = true;
     if (time_source < 1) time_source = 1;
     ntp_last_sync = now_m;
@@ -59,6 +61,7 @@ void time_seed_compile(void)
     portENTER_CRITICAL(&time_mux);
     epoch_at_pps = ep;
     millis_at_pps = uptime_ms();
+    us_frac_at_pps = 0;
     epoch_valid = true;
     // time_source stays 0 — NTP (1) and GPS (2) will override
     portEXIT_CRITICAL(&time_mux);
@@ -78,6 +81,7 @@ bool time_set_from_beacon(uint64_t epoch_ms)
     if (time_source < 2 && ntp_last_sync == 0) {
         epoch_at_pps  = epoch_ms;
         millis_at_pps = now_m;
+        us_frac_at_pps = 0;
         epoch_valid   = true;
         applied = true;
     }
@@ -143,6 +147,7 @@ volatile int gps_second = 0;
 
 // --- PPS interrupt state ---
 static volatile uint32_t pps_millis = 0;     // uptime_ms() captured in ISR
+static volatile uint16_t pps_us_frac = 0;    // sub-ms remainder of that capture
 static volatile uint32_t pps_count = 0;      // increments each PPS edge
 static volatile bool     pps_edge_flag = false; // rising-edge flag, clear-on-read
 
@@ -159,8 +164,10 @@ static uint32_t nmea_last_datetime_count = 0; // tracks nmea.datetime_count (epo
 static void IRAM_ATTR pps_isr(void *arg)
 {
     (void)arg;
-    pps_millis = uptime_ms();
+    int64_t t = esp_timer_get_time();
     portENTER_CRITICAL_ISR(&time_mux);
+    pps_millis = (uint32_t)(t / 1000);
+    pps_us_frac = (uint16_t)(t % 1000);
     pps_count = pps_count + 1;
     pps_edge_flag = true;
     portEXIT_CRITICAL_ISR(&time_mux);
@@ -334,10 +341,10 @@ int gps_loop()
                                                        nmea.hour, nmea.minute, nmea.second);
                     if (ep != 0)   // reject a checksum-passing but out-of-range datetime
                     {
-                        uint32_t pm = pps_millis;  // snapshot atomic 32-bit read
                         portENTER_CRITICAL(&time_mux);
                         epoch_at_pps = ep;
-                        millis_at_pps = pm;
+                        millis_at_pps = pps_millis;
+                        us_frac_at_pps = pps_us_frac;  // keep the edge's us for get_epoch_us()
                         epoch_valid = true;
                         time_source = 2;  // GPS+PPS — highest priority
                         portEXIT_CRITICAL(&time_mux);
@@ -578,6 +585,31 @@ uint64_t get_epoch_ms(void)
     return ep + elapsed;
 }
 
+// Same clock as get_epoch_ms() at us resolution, for the LED frame scheduler.
+// Interpolates with the us timer; a GPS+PPS anchor also keeps the edge's
+// sub-ms timestamp, so cones agree on frame boundaries to well under 1 ms.
+uint64_t get_epoch_us(void)
+{
+    uint64_t ep;
+    uint32_t mp;
+    uint16_t frac;
+    bool valid;
+
+    portENTER_CRITICAL(&time_mux);
+    ep = epoch_at_pps;
+    mp = millis_at_pps;
+    frac = us_frac_at_pps;
+    valid = epoch_valid;
+    portEXIT_CRITICAL(&time_mux);
+
+    if (!valid) return 0;
+
+    int64_t now = esp_timer_get_time();
+    uint32_t elapsed_ms = (uint32_t)(now / 1000) - mp;   // same wrap as get_epoch_ms
+    int64_t elapsed_us = (int64_t)elapsed_ms * 1000 + (now % 1000) - frac;
+    return ep * 1000ULL + (uint64_t)elapsed_us;
+}
+
 
 uint8_t get_time_source(void)
 {
@@ -657,6 +689,7 @@ void ntp_loop(void)
     portENTER_CRITICAL(&time_mux);
     epoch_at_pps = ep;
     millis_at_pps = now_m;
+    us_frac_at_pps = 0;
     epoch_valid = true;
     // Don't promote time_source here — only ntp_sync_cb() should set it to 1.
     // The system clock may be valid from RTC retention across soft resets,
@@ -773,6 +806,29 @@ uint64_t get_epoch_ms(void)
     return ep + elapsed;
 }
 
+// Same clock as get_epoch_ms() at us resolution (see the GPS build).
+uint64_t get_epoch_us(void)
+{
+    uint64_t ep;
+    uint32_t mp;
+    uint16_t frac;
+    bool valid;
+
+    portENTER_CRITICAL(&time_mux);
+    ep = epoch_at_pps;
+    mp = millis_at_pps;
+    frac = us_frac_at_pps;
+    valid = epoch_valid;
+    portEXIT_CRITICAL(&time_mux);
+
+    if (!valid) return 0;
+
+    int64_t now = esp_timer_get_time();
+    uint32_t elapsed_ms = (uint32_t)(now / 1000) - mp;   // same wrap as get_epoch_ms
+    int64_t elapsed_us = (int64_t)elapsed_ms * 1000 + (now % 1000) - frac;
+    return ep * 1000ULL + (uint64_t)elapsed_us;
+}
+
 
 uint8_t get_time_source(void)
 {
@@ -838,6 +894,7 @@ void ntp_loop(void)
     portENTER_CRITICAL(&time_mux);
     epoch_at_pps = ep;
     millis_at_pps = now_m;
+    us_frac_at_pps = 0;
     epoch_valid = true;
     // time_source promotion stays with ntp_sync_cb() only.
     portEXIT_CRITICAL(&time_mux);
@@ -11,6 +11,10 @@
 
 #define BAS2WASM_EMBEDDED
 
+// Plain globals, not per-thread state: ESP-IDF takes each task's TLS out
+// of its stack, and only ShellTask (cmd_compile) ever runs the compiler.
+#define BAS2WASM_NO_TLS
+
 #include "board.h"
 #if defined(BOARD_HAS_IMPROVISED_PSRAM) || defined(BOARD_HAS_NATIVE_PSRAM)
 #define BAS2WASM_USE_PSRAM
@@ -26,6 +30,7 @@
 #include "expr.c"
 #include "stmt.c"
 #include "assemble.c"
+#include "runtime.c"
 
 // main.c provides compile(), bas2wasm_compile_buffer(), bas2wasm_reset()
 #include "main.c"
@@ -15,6 +15,10 @@
 
 #define C2WASM_EMBEDDED
 
+// Plain globals, not per-thread state: ESP-IDF takes each task's TLS out
+// of its stack, and only ShellTask (cmd_compile) ever runs the compiler.
+#define C2WASM_NO_TLS
+
 // In embedded mode, symbol names are intentionally truncated to 32 bytes.
 // Suppress -Wformat-truncation which warns about this safe, intended behavior.
 #pragma GCC diagnostic push
@@ -0,0 +1,179 @@
+#include <stdlib.h>
+#include <string.h>
+#include "str_pool.h"
+
+#define MAP_LIVE        0x8000
+#define MAP_FREE        0x4000      // only while coalescing
+#define MAP_CLASS_MASK  0x000F
+
+// Class of a block of g granules: the smallest k with 2^k >= g
+static inline int class_of(uint32_t g)
+{
+    return g > 1 ? 32 - __builtin_clz(g - 1) : 0;
+}
+
+static inline uint32_t class_bytes(int k)
+{
+    return (uint32_t)STR_POOL_GRANULE << k;
+}
+
+static void push_free(str_pool *sp, int k, uint32_t blk)
+{
+    sp->map[blk] = sp->free_head[k];
+    sp->free_head[k] = (uint16_t)(blk + 1);
+    sp->st.free_listed += class_bytes(k);
+}
+
+static uint32_t pop_free(str_pool *sp, int k)
+{
+    uint32_t blk = sp->free_head[k] - 1u;
+    sp->free_head[k] = sp->map[blk];
+    sp->st.free_listed -= class_bytes(k);
+    return blk;
+}
+
+
+// Merge runs of adjacent free blocks and re-carve each into the largest
+// blocks that fit; a run that reaches the bump pointer goes back to it.
+// O(pool size), so only run when an allocation would otherwise fail.
+static void coalesce(str_pool *sp)
+{
+    // Tag every free block with its class (the lists are rebuilt below)
+    for (int k = 0; k < STR_POOL_CLASSES; k++) {
+        while (sp->free_head[k]) {
+            uint32_t blk = pop_free(sp, k);
+            sp->map[blk] = (uint16_t)(MAP_FREE | k);
+        }
+    }
+
+    uint32_t g = 0;
+    while (g < sp->bump) {
+        if (!(sp->map[g] & MAP_FREE)) {
+            g += 1u << (sp->map[g] & MAP_CLASS_MASK);
+            continue;
+        }
+        uint32_t run = g;
+        while (g < sp->bump && (sp->map[g] & MAP_FREE)) {
+            uint32_t next = g + (1u << (sp->map[g] & MAP_CLASS_MASK));
+            sp->map[g] = 0;
+            g = next;
+        }
+        if (g == sp->bump) {
+            sp->bump = run;
+            break;
+        }
+        while (run < g) {
+            int k = 31 - __builtin_clz(g - run);
+            if (k >= STR_POOL_CLASSES) k = STR_POOL_CLASSES - 1;
+            push_free(sp, k, run);
+            run += 1u << k;
+        }
+    }
+}
+
+
+bool str_pool_init(str_pool *sp, uint32_t start, uint32_t size)
+{
+    memset(sp, 0, sizeof(*sp));
+    if (size > STR_POOL_MAX_SIZE) size = STR_POOL_MAX_SIZE;
+    uint32_t first = (start + STR_POOL_GRANULE - 1) / STR_POOL_GRANULE;
+    uint32_t end   = (start + size) / STR_POOL_GRANULE;
+    sp->start = first * STR_POOL_GRANULE;
+    if (end <= first) return true;
+
+    sp->map = (uint16_t *)calloc(end - first, sizeof(uint16_t));
+    if (!sp->map) return false;
+    sp->ngran = end - first;
+    sp->st.size = sp->ngran * STR_POOL_GRANULE;
+    return true;
+}
+
+void str_pool_release(str_pool *sp)
+{
+    free(sp->map);
+    sp->map = NULL;
+    sp->ngran = 0;
+    sp->bump = 0;
+    memset(sp->free_head, 0, sizeof(sp->free_head));
+}
+
+// First granule of a free block of class k, or ngran when there is none
+static uint32_t take(str_pool *sp, int k)
+{
+    if (sp->free_head[k]) return pop_free(sp, k);
+
+    if (sp->bump + (1u << k) <= sp->ngran) {
+        uint32_t blk = sp->bump;
+        sp->bump += 1u << k;
+        return blk;
+    }
+
+    // Split the smallest larger free block: keep its first 2^k granules,
+    // hand the rest back as one block of each class k..j-1
+    int j = k + 1;
+    while (j < STR_POOL_CLASSES && !sp->free_head[j]) j++;
+    if (j == STR_POOL_CLASSES) return sp->ngran;
+    uint32_t blk = pop_free(sp, j);
+    while (--j >= k)
+        push_free(sp, j, blk + (1u << j));
+    return blk;
+}
+
+uint32_t str_pool_alloc(str_pool *sp, uint32_t size)
+{
+    if (size == 0) size = 1;
+    int k = class_of((size + STR_POOL_GRANULE - 1) / STR_POOL_GRANULE);
+    uint32_t blk = sp->ngran;
+    if (size <= STR_POOL_MAX_SIZE && k < STR_POOL_CLASSES) {
+        blk = take(sp, k);
+        // Enough free space, just not in one block: merge and retry
+        uint32_t avail = sp->st.free_listed + (sp->ngran - sp->bump) * STR_POOL_GRANULE;
+        if (blk == sp->ngran && avail >= class_bytes(k)) {
+            coalesce(sp);
+            sp->st.coalesces++;
+            blk = take(sp, k);
+        }
+    }
+    if (blk == sp->ngran) {
+        sp->st.fails++;
+        return 0;
+    }
+
+    sp->map[blk] = (uint16_t)(MAP_LIVE | k);
+    sp->st.used += class_bytes(k);
+    sp->st.blocks++;
+    if (sp->st.used > sp->st.peak) sp->st.peak = sp->st.used;
+    return sp->start + blk * STR_POOL_GRANULE;
+}
+
+static int live_class(const str_pool *sp, uint32_t ptr, uint32_t *blk)
+{
+    if (!str_pool_contains(sp, ptr) || (ptr - sp->start) % STR_POOL_GRANULE) return -1;
+    *blk = (ptr - sp->start) / STR_POOL_GRANULE;
+    if (*blk >= sp->bump || !(sp->map[*blk] & MAP_LIVE)) return -1;
+    return sp->map[*blk] & MAP_CLASS_MASK;
+}
+
+uint32_t str_pool_free(str_pool *sp, uint32_t ptr)
+{
+    uint32_t blk;
+    int k = live_class(sp, ptr, &blk);
+    if (k < 0) return 0;
+
+    sp->st.used -= class_bytes(k);
+    sp->st.blocks--;
+    if (blk + (1u << k) == sp->bump) {
+        sp->bump = blk;
+        sp->map[blk] = 0;
+    } else {
+        push_free(sp, k, blk);
+    }
+    return class_bytes(k);
+}
+
+uint32_t str_pool_block_size(const str_pool *sp, uint32_t ptr)
+{
+    uint32_t blk;
+    int k = live_class(sp, ptr, &blk);
+    return k < 0 ? 0 : class_bytes(k);
+}
@@ -0,0 +1,68 @@
+#ifndef _conez_str_pool_h
+#define _conez_str_pool_h
+
+// Bookkeeping half of the WASM host string pool: a segregated size-class
+// allocator over a region of a program's linear memory.
+//
+// Blocks are 2^k granules of STR_POOL_GRANULE bytes. Each class keeps a
+// free list; an allocation pops its class, else carves from the bump
+// pointer, else splits the smallest larger free block. A map with one
+// entry per granule says which granules start a live block and of what
+// class, so free() needs no search either. Freeing the topmost block gives
+// its space back to the bump pointer; otherwise free blocks are merged only
+// when a request finds no block big enough although the space is there --
+// a scan of the whole map, off the common path.
+//
+// Everything lives host-side: a program scribbling over freed strings can't
+// corrupt the free lists. Offsets are linear-memory addresses; nothing here
+// touches the memory itself (wasm_imports_string.cpp zeroes and copies).
+//
+// Pure C++, no wasm3/FreeRTOS dependency: firmware/test/host tests it, and
+// the simulator builds the same file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define STR_POOL_GRANULE    16
+#define STR_POOL_CLASSES    15                      // 16 B .. 256 KB blocks
+#define STR_POOL_MAX_SIZE   (256 * 1024)
+
+struct str_pool_stats {
+    uint32_t size;          // bytes in the pool
+    uint32_t used;          // bytes in live blocks (rounded up to their class)
+    uint32_t peak;          // high-water mark of used
+    uint32_t blocks;        // live blocks
+    uint32_t free_listed;   // bytes in freed blocks (the rest of the free
+                            // space was never handed out)
+    uint32_t fails;         // allocations refused
+    uint32_t coalesces;     // times free blocks were merged to fit a request
+};
+
+struct str_pool {
+    uint32_t  start;        // linear-memory address of granule 0
+    uint32_t  ngran;        // granules in the pool
+    uint32_t  bump;         // first granule never handed out (or given back)
+    uint16_t *map;          // per granule: 0x8000|class for a live block's
+                            // first granule, else free-list link (next + 1)
+    uint16_t  free_head[STR_POOL_CLASSES];   // first free block + 1, 0 = none
+    str_pool_stats st;
+};
+
+// Take over [start, start + size), rounded inward to granules. Returns false
+// (and leaves an empty pool) when the map can't be allocated.
+bool     str_pool_init(str_pool *sp, uint32_t start, uint32_t size);
+void     str_pool_release(str_pool *sp);
+
+// Address of a block of at least `size` bytes, or 0 when none is left
+uint32_t str_pool_alloc(str_pool *sp, uint32_t size);
+// Size of the block freed, 0 if ptr isn't a live block (ignored)
+uint32_t str_pool_free(str_pool *sp, uint32_t ptr);
+// Usable size of a live block, 0 if ptr isn't one
+uint32_t str_pool_block_size(const str_pool *sp, uint32_t ptr);
+
+static inline bool str_pool_contains(const str_pool *sp, uint32_t ptr)
+{
+    return ptr >= sp->start && ptr < sp->start + sp->ngran * STR_POOL_GRANULE;
+}
+
+#endif
@@ -6,6 +6,7 @@
 #include "printManager.h"
 #include "main.h"
 #include "gps.h"
+#include "led.h"
 
 // --- Time ---
 
@@ -16,6 +17,20 @@ m3ApiRawFunction(m3_get_epoch_ms)
     m3ApiReturn((int64_t)get_epoch_ms());
 }
 
+// I64 get_frame() - frame number on the epoch-aligned LED schedule
+m3ApiRawFunction(m3_get_frame)
+{
+    m3ApiReturnType(int64_t);
+    m3ApiReturn((int64_t)led_frame_number());
+}
+
+// i32 get_frame_rate() - frames per second of that schedule (led.fps)
+m3ApiRawFunction(m3_get_frame_rate)
+{
+    m3ApiReturnType(int32_t);
+    m3ApiReturn((int32_t)led_frame_rate());
+}
+
 // i32 millis_()  - renamed to avoid collision with Arduino uptime_ms()
 m3ApiRawFunction(m3_millis)
 {
@@ -144,6 +159,12 @@ M3Result link_datetime_imports(IM3Module module)
     result = m3_LinkRawFunction(module, "env", "get_last_comm_ms", "I()", m3_get_last_comm_ms);
     if (result && result != m3Err_functionLookupFailed) return result;
 
+    // LED frame clock
+    result = m3_LinkRawFunction(module, "env", "get_frame", "I()", m3_get_frame);
+    if (result && result != m3Err_functionLookupFailed) return result;
+    result = m3_LinkRawFunction(module, "env", "get_frame_rate", "i()", m3_get_frame_rate);
+    if (result && result != m3Err_functionLookupFailed) return result;
+
     return m3Err_none;
 }
 
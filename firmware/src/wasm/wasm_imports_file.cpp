@@ -6,16 +6,13 @@
 #include <dirent.h>
 #include <unistd.h>
 
-// ---- Tunables ----
-#define WASM_MAX_OPEN_FILES  4
-#define WASM_MAX_OPEN_DIRS   4
-#define WASM_MAX_PATH_LEN  128
-
-// ---- State ----
-static FILE *wasm_files[WASM_MAX_OPEN_FILES] = {};
-static DIR  *wasm_dirs [WASM_MAX_OPEN_DIRS]  = {};
-// Parallel to wasm_dirs: the fully-prefixed LittleFS path, needed to stat entries
-static char  wasm_dir_path[WASM_MAX_OPEN_DIRS][WASM_MAX_PATH_LEN + 16];
+// Open files and directories are per program: handles index the tables in
+// its wasm_instance (WASM_MAX_OPEN_FILES / WASM_MAX_OPEN_DIRS).
+//
+// Reads and writes go straight between the file and linear memory
+// (wasm_mem_fread/fwrite), with no staging buffer; each file gets a
+// WASM_FILE_BUF_SIZE stdio buffer so small reads still reach the flash a
+// block at a time.
 
 // ---- Mode table (matches conez_api.h FILE_MODE_*) ----
 static const char *mode_str(int mode)
@@ -61,10 +58,10 @@ static bool wasm_extract_path_z(IM3Runtime rt, uint32_t ptr, char *out)
 }
 
 // ---- Slot helpers ----
-static int  alloc_file_slot(void) { for (int i=0;i<WASM_MAX_OPEN_FILES;i++) if (!wasm_files[i]) return i; return -1; }
-static int  alloc_dir_slot (void) { for (int i=0;i<WASM_MAX_OPEN_DIRS; i++) if (!wasm_dirs [i]) return i; return -1; }
-static bool file_handle_ok(int h) { return h >= 0 && h < WASM_MAX_OPEN_FILES && wasm_files[h]; }
-static bool dir_handle_ok (int h) { return h >= 0 && h < WASM_MAX_OPEN_DIRS  && wasm_dirs [h]; }
+static int  alloc_file_slot(wasm_instance *in) { for (int i=0;i<WASM_MAX_OPEN_FILES;i++) if (!in->files[i]) return i; return -1; }
+static int  alloc_dir_slot (wasm_instance *in) { for (int i=0;i<WASM_MAX_OPEN_DIRS; i++) if (!in->dirs [i]) return i; return -1; }
+static bool file_handle_ok(wasm_instance *in, int h) { return h >= 0 && h < WASM_MAX_OPEN_FILES && in->files[h]; }
+static bool dir_handle_ok (wasm_instance *in, int h) { return h >= 0 && h < WASM_MAX_OPEN_DIRS  && in->dirs [h]; }
 
 static int map_whence(int w)
 {
@@ -72,14 +69,18 @@ static int map_whence(int w)
 }
 
 // Called from wasm_run() on program exit
-void wasm_close_all_files(void)
+void wasm_close_all_files(wasm_instance *inst)
 {
     for (int i = 0; i < WASM_MAX_OPEN_FILES; i++)
-        if (wasm_files[i]) { fclose(wasm_files[i]); wasm_files[i] = NULL; }
+        if (inst->files[i]) { fclose(inst->files[i]); inst->files[i] = NULL; }
     for (int i = 0; i < WASM_MAX_OPEN_DIRS; i++)
-        if (wasm_dirs[i])  { closedir(wasm_dirs[i]); wasm_dirs[i] = NULL; }
+        if (inst->dirs[i])  { closedir(inst->dirs[i]); inst->dirs[i] = NULL; }
+    memset(inst->maps, 0, sizeof(inst->maps));
 }
 
+// The file changed under a mapped view: drop what the window holds
+static void map_invalidate(wasm_instance *in, int h) { in->maps[h].len = 0; }
+
 // ============================================================================
 //                              Open-file API
 // ============================================================================
@@ -90,6 +91,7 @@ m3ApiRawFunction(m3_file_open)
     m3ApiReturnType(int32_t);
     m3ApiGetArg(int32_t, path_ptr);
     m3ApiGetArg(int32_t, mode);
+    wasm_instance *inst = wasm_inst(runtime);
 
     char path[WASM_MAX_PATH_LEN];
     if (!wasm_extract_path_z(runtime, (uint32_t)path_ptr, path)) m3ApiReturn(-1);
@@ -97,13 +99,14 @@ m3ApiRawFunction(m3_file_open)
     const char *fmode = mode_str(mode);
     if (!fmode) m3ApiReturn(-1);
 
-    int slot = alloc_file_slot();
+    int slot = alloc_file_slot(inst);
     if (slot < 0) m3ApiReturn(-1);
 
     char fpath[WASM_MAX_PATH_LEN + 16];
     lfs_path(fpath, sizeof(fpath), path);
-    wasm_files[slot] = fopen(fpath, fmode);
-    if (!wasm_files[slot]) m3ApiReturn(-1);
+    inst->files[slot] = fopen(fpath, fmode);
+    if (!inst->files[slot]) m3ApiReturn(-1);
+    setvbuf(inst->files[slot], NULL, _IOFBF, WASM_FILE_BUF_SIZE);
     m3ApiReturn(slot);
 }
 
@@ -111,9 +114,11 @@ m3ApiRawFunction(m3_file_open)
 m3ApiRawFunction(m3_file_close)
 {
     m3ApiGetArg(int32_t, handle);
-    if (file_handle_ok(handle)) {
-        fclose(wasm_files[handle]);
-        wasm_files[handle] = NULL;
+    wasm_instance *inst = wasm_inst(runtime);
+    if (file_handle_ok(inst, handle)) {
+        fclose(inst->files[handle]);
+        inst->files[handle] = NULL;
+        memset(&inst->maps[handle], 0, sizeof(inst->maps[handle]));
     }
     m3ApiSuccess();
 }
@@ -125,28 +130,14 @@ m3ApiRawFunction(m3_file_read)
     m3ApiGetArg(int32_t, handle);
     m3ApiGetArg(int32_t, buf_ptr);
     m3ApiGetArg(int32_t, max_len);
+    wasm_instance *inst = wasm_inst(runtime);
 
-    if (!file_handle_ok(handle)) m3ApiReturn(-1);
+    if (!file_handle_ok(inst, handle)) m3ApiReturn(-1);
     if (max_len <= 0 || !wasm_mem_check(runtime, (uint32_t)buf_ptr, (size_t)max_len))
         m3ApiReturn(-1);
 
-    // Stage through DRAM — WASM memory may be PSRAM-backed
-    int total = 0;
-    uint32_t pos = (uint32_t)buf_ptr;
-    int remaining = max_len;
-    while (remaining > 0) {
-        uint8_t tmp[256];
-        int chunk = remaining > (int)sizeof(tmp) ? (int)sizeof(tmp) : remaining;
-        int n = (int)fread(tmp, 1, chunk, wasm_files[handle]);
-        if (n > 0) {
-            wasm_mem_write(runtime, pos, tmp, n);
-            pos += n;
-            total += n;
-        }
-        if (n < chunk) break;  // EOF or short read
-        remaining -= n;
-    }
-    m3ApiReturn(total);
+    m3ApiReturn((int32_t)wasm_mem_fread(runtime, (uint32_t)buf_ptr, (size_t)max_len,
+                                        inst->files[handle]));
 }
 
 // i32 file_write(handle, buf_ptr, len) -> bytes or -1
@@ -156,25 +147,15 @@ m3ApiRawFunction(m3_file_write)
     m3ApiGetArg(int32_t, handle);
     m3ApiGetArg(int32_t, buf_ptr);
     m3ApiGetArg(int32_t, len);
+    wasm_instance *inst = wasm_inst(runtime);
 
-    if (!file_handle_ok(handle)) m3ApiReturn(-1);
+    if (!file_handle_ok(inst, handle)) m3ApiReturn(-1);
     if (len <= 0 || !wasm_mem_check(runtime, (uint32_t)buf_ptr, (size_t)len))
         m3ApiReturn(-1);
 
-    int total = 0;
-    uint32_t pos = (uint32_t)buf_ptr;
-    int remaining = len;
-    while (remaining > 0) {
-        uint8_t tmp[256];
-        int chunk = remaining > (int)sizeof(tmp) ? (int)sizeof(tmp) : remaining;
-        wasm_mem_read(runtime, pos, tmp, chunk);
-        int n = (int)fwrite(tmp, 1, chunk, wasm_files[handle]);
-        total += n;
-        if (n < chunk) break;
-        pos += n;
-        remaining -= n;
-    }
-    m3ApiReturn(total);
+    map_invalidate(inst, handle);
+    m3ApiReturn((int32_t)wasm_mem_fwrite(runtime, (uint32_t)buf_ptr, (size_t)len,
+                                         inst->files[handle]));
 }
 
 // i32 file_size(handle) -> size or -1
@@ -182,8 +163,9 @@ m3ApiRawFunction(m3_file_size)
 {
     m3ApiReturnType(int32_t);
     m3ApiGetArg(int32_t, handle);
-    if (!file_handle_ok(handle)) m3ApiReturn(-1);
-    m3ApiReturn((int32_t)fsize(wasm_files[handle]));
+    wasm_instance *inst = wasm_inst(runtime);
+    if (!file_handle_ok(inst, handle)) m3ApiReturn(-1);
+    m3ApiReturn((int32_t)fsize(inst->files[handle]));
 }
 
 // i32 file_seek(handle, offset, whence) -> 0 or -1
@@ -193,13 +175,14 @@ m3ApiRawFunction(m3_file_seek)
     m3ApiGetArg(int32_t, handle);
     m3ApiGetArg(int32_t, offset);
     m3ApiGetArg(int32_t, whence);
-    if (!file_handle_ok(handle)) m3ApiReturn(-1);
+    wasm_instance *inst = wasm_inst(runtime);
+    if (!file_handle_ok(inst, handle)) m3ApiReturn(-1);
     int w = map_whence(whence);
     if (w < 0) m3ApiReturn(-1);
 
     // Validate target position is in [0, size]; reject out-of-range seeks so a
     // bad offset can't leave the file pointer in an undefined state.
-    FILE *f = wasm_files[handle];
+    FILE *f = inst->files[handle];
     long cur = ftell(f);
     if (cur < 0) m3ApiReturn(-1);
 
@@ -225,8 +208,9 @@ m3ApiRawFunction(m3_file_tell)
 {
     m3ApiReturnType(int32_t);
     m3ApiGetArg(int32_t, handle);
-    if (!file_handle_ok(handle)) m3ApiReturn(-1);
-    long p = ftell(wasm_files[handle]);
+    wasm_instance *inst = wasm_inst(runtime);
+    if (!file_handle_ok(inst, handle)) m3ApiReturn(-1);
+    long p = ftell(inst->files[handle]);
     m3ApiReturn(p < 0 ? -1 : (int32_t)p);
 }
 
@@ -235,8 +219,9 @@ m3ApiRawFunction(m3_file_eof)
 {
     m3ApiReturnType(int32_t);
     m3ApiGetArg(int32_t, handle);
-    if (!file_handle_ok(handle)) m3ApiReturn(1);  // invalid handle -> treat as EOF
-    m3ApiReturn(feof(wasm_files[handle]) ? 1 : 0);
+    wasm_instance *inst = wasm_inst(runtime);
+    if (!file_handle_ok(inst, handle)) m3ApiReturn(1);  // invalid handle -> treat as EOF
+    m3ApiReturn(feof(inst->files[handle]) ? 1 : 0);
 }
 
 // i32 file_truncate(handle, length) -> 0 or -1
@@ -245,9 +230,11 @@ m3ApiRawFunction(m3_file_truncate)
     m3ApiReturnType(int32_t);
     m3ApiGetArg(int32_t, handle);
     m3ApiGetArg(int32_t, length);
-    if (!file_handle_ok(handle) || length < 0) m3ApiReturn(-1);
-    fflush(wasm_files[handle]);
-    int fd = fileno(wasm_files[handle]);
+    wasm_instance *inst = wasm_inst(runtime);
+    if (!file_handle_ok(inst, handle) || length < 0) m3ApiReturn(-1);
+    fflush(inst->files[handle]);
+    map_invalidate(inst, handle);
+    int fd = fileno(inst->files[handle]);
     if (fd < 0) m3ApiReturn(-1);
     m3ApiReturn(ftruncate(fd, length) == 0 ? 0 : -1);
 }
@@ -257,8 +244,9 @@ m3ApiRawFunction(m3_file_flush)
 {
     m3ApiReturnType(int32_t);
     m3ApiGetArg(int32_t, handle);
-    if (!file_handle_ok(handle)) m3ApiReturn(-1);
-    m3ApiReturn(fflush(wasm_files[handle]) == 0 ? 0 : -1);
+    wasm_instance *inst = wasm_inst(runtime);
+    if (!file_handle_ok(inst, handle)) m3ApiReturn(-1);
+    m3ApiReturn(fflush(inst->files[handle]) == 0 ? 0 : -1);
 }
 
 // Shared line reader — reads into local buf (null not included), strips trailing \r,
@@ -287,7 +275,8 @@ m3ApiRawFunction(m3_file_readln)
     m3ApiGetArg(int32_t, handle);
     m3ApiGetArg(int32_t, buf_ptr);
     m3ApiGetArg(int32_t, buf_len);
-    if (!file_handle_ok(handle)) m3ApiReturn(-1);
+    wasm_instance *inst = wasm_inst(runtime);
+    if (!file_handle_ok(inst, handle)) m3ApiReturn(-1);
     if (buf_len < 1 || !wasm_mem_check(runtime, (uint32_t)buf_ptr, (size_t)buf_len))
         m3ApiReturn(-1);
 
@@ -295,7 +284,7 @@ m3ApiRawFunction(m3_file_readln)
     // Leave room for the NUL: readln_into can fill all `cap` bytes, so cap must
     // be at most sizeof(line)-1 or line[n] below writes one past the buffer.
     int cap = (buf_len - 1 < (int)sizeof(line) - 1) ? (buf_len - 1) : (int)sizeof(line) - 1;
-    int n = readln_into(wasm_files[handle], line, cap);
+    int n = readln_into(inst->files[handle], line, cap);
     line[n] = '\0';
     wasm_mem_write(runtime, (uint32_t)buf_ptr, line, (size_t)n + 1);
     m3ApiReturn(n);
@@ -306,11 +295,12 @@ m3ApiRawFunction(m3_file_readln_str)
 {
     m3ApiReturnType(int32_t);
     m3ApiGetArg(int32_t, handle);
-    if (!file_handle_ok(handle)) m3ApiReturn(0);
+    wasm_instance *inst = wasm_inst(runtime);
+    if (!file_handle_ok(inst, handle)) m3ApiReturn(0);
 
     char buf[256];
-    int n = readln_into(wasm_files[handle], buf, (int)sizeof(buf) - 1);
-    if (n == 0 && feof(wasm_files[handle])) m3ApiReturn(0);
+    int n = readln_into(inst->files[handle], buf, (int)sizeof(buf) - 1);
+    if (n == 0 && feof(inst->files[handle])) m3ApiReturn(0);
     buf[n] = '\0';
 
     uint32_t dst = pool_alloc(runtime, n + 1);
@@ -326,25 +316,83 @@ m3ApiRawFunction(m3_file_writeln)
     m3ApiReturnType(int32_t);
     m3ApiGetArg(int32_t, handle);
     m3ApiGetArg(int32_t, str_ptr);
-    if (!file_handle_ok(handle)) m3ApiReturn(-1);
+    wasm_instance *inst = wasm_inst(runtime);
+    if (!file_handle_ok(inst, handle)) m3ApiReturn(-1);
 
     int len = wasm_mem_strlen(runtime, (uint32_t)str_ptr);
     if (len < 0) m3ApiReturn(-1);
 
-    uint32_t pos = (uint32_t)str_ptr;
-    int remaining = len;
-    while (remaining > 0) {
-        char tmp[256];
-        int chunk = remaining > (int)sizeof(tmp) ? (int)sizeof(tmp) : remaining;
-        wasm_mem_read(runtime, pos, tmp, chunk);
-        if ((int)fwrite(tmp, 1, chunk, wasm_files[handle]) != chunk) m3ApiReturn(-1);
-        pos += chunk;
-        remaining -= chunk;
-    }
-    if (fwrite("\n", 1, 1, wasm_files[handle]) != 1) m3ApiReturn(-1);
+    map_invalidate(inst, handle);
+    if (wasm_mem_fwrite(runtime, (uint32_t)str_ptr, (size_t)len, inst->files[handle]) != (size_t)len)
+        m3ApiReturn(-1);
+    if (fwrite("\n", 1, 1, inst->files[handle]) != 1) m3ApiReturn(-1);
+    m3ApiReturn(0);
+}
+
+// ============================================================================
+//                              Mapped views
+// ============================================================================
+// A read-only, paged view of an open file for programs that walk it in
+// fixed-size records (frame playback). The program lends a buffer; each
+// file_map_get() returns a pointer into it, and only when the range isn't
+// already there is the window refilled -- one wasm_mem_fread of the whole
+// buffer starting at the requested offset. Writing through the handle
+// empties the window. Refills move the file position.
+
+// i32 file_map(handle, buf_ptr, buf_len) -> 0 or -1
+m3ApiRawFunction(m3_file_map)
+{
+    m3ApiReturnType(int32_t);
+    m3ApiGetArg(int32_t, handle);
+    m3ApiGetArg(int32_t, buf_ptr);
+    m3ApiGetArg(int32_t, buf_len);
+    wasm_instance *inst = wasm_inst(runtime);
+    if (!file_handle_ok(inst, handle)) m3ApiReturn(-1);
+    if (buf_ptr == 0 || buf_len <= 0 || !wasm_mem_check(runtime, (uint32_t)buf_ptr, (size_t)buf_len))
+        m3ApiReturn(-1);
+
+    FileMap *m = &inst->maps[handle];
+    m->buf   = (uint32_t)buf_ptr;
+    m->cap   = (uint32_t)buf_len;
+    m->start = 0;
+    m->len   = 0;
     m3ApiReturn(0);
 }
 
+// i32 file_map_get(handle, offset, len) -> ptr to file bytes [offset, offset+len), or 0
+m3ApiRawFunction(m3_file_map_get)
+{
+    m3ApiReturnType(int32_t);
+    m3ApiGetArg(int32_t, handle);
+    m3ApiGetArg(int32_t, offset);
+    m3ApiGetArg(int32_t, len);
+    wasm_instance *inst = wasm_inst(runtime);
+    if (!file_handle_ok(inst, handle)) m3ApiReturn(0);
+    FileMap *m = &inst->maps[handle];
+    if (!m->buf || offset < 0 || len <= 0 || (uint32_t)len > m->cap) m3ApiReturn(0);
+
+    uint32_t off = (uint32_t)offset;
+    if (off < m->start || (uint64_t)off + len > (uint64_t)m->start + m->len) {
+        FILE *f = inst->files[handle];
+        m->len = 0;
+        if (fseek(f, offset, SEEK_SET) != 0) m3ApiReturn(0);
+        m->start = off;
+        m->len   = (uint32_t)wasm_mem_fread(runtime, m->buf, m->cap, f);
+        if ((uint32_t)len > m->len) m3ApiReturn(0);     // past EOF
+    }
+    m3ApiReturn((int32_t)(m->buf + (off - m->start)));
+}
+
+// void file_unmap(handle)
+m3ApiRawFunction(m3_file_unmap)
+{
+    m3ApiGetArg(int32_t, handle);
+    wasm_instance *inst = wasm_inst(runtime);
+    if (file_handle_ok(inst, handle))
+        memset(&inst->maps[handle], 0, sizeof(inst->maps[handle]));
+    m3ApiSuccess();
+}
+
 // ============================================================================
 //                           Path-based API
 // ============================================================================
@@ -435,16 +483,17 @@ m3ApiRawFunction(m3_dir_open)
 {
     m3ApiReturnType(int32_t);
     m3ApiGetArg(int32_t, path_ptr);
+    wasm_instance *inst = wasm_inst(runtime);
 
     char path[WASM_MAX_PATH_LEN];
     if (!wasm_extract_path_z(runtime, (uint32_t)path_ptr, path)) m3ApiReturn(-1);
 
-    int slot = alloc_dir_slot();
+    int slot = alloc_dir_slot(inst);
     if (slot < 0) m3ApiReturn(-1);
 
-    lfs_path(wasm_dir_path[slot], sizeof(wasm_dir_path[slot]), path);
-    wasm_dirs[slot] = opendir(wasm_dir_path[slot]);
-    if (!wasm_dirs[slot]) m3ApiReturn(-1);
+    lfs_path(inst->dir_path[slot], sizeof(inst->dir_path[slot]), path);
+    inst->dirs[slot] = opendir(inst->dir_path[slot]);
+    if (!inst->dirs[slot]) m3ApiReturn(-1);
     m3ApiReturn(slot);
 }
 
@@ -455,11 +504,12 @@ m3ApiRawFunction(m3_dir_read)
     m3ApiReturnType(int32_t);
     m3ApiGetArg(int32_t, handle);
     m3ApiGetArg(int32_t, out_ptr);
-    if (!dir_handle_ok(handle)) m3ApiReturn(-1);
+    wasm_instance *inst = wasm_inst(runtime);
+    if (!dir_handle_ok(inst, handle)) m3ApiReturn(-1);
     if (!wasm_mem_check(runtime, (uint32_t)out_ptr, 260)) m3ApiReturn(-1);
 
     struct dirent *ent;
-    while ((ent = readdir(wasm_dirs[handle])) != NULL) {
+    while ((ent = readdir(inst->dirs[handle])) != NULL) {
         // Filter '.' and '..'
         if (ent->d_name[0] == '.' &&
             (ent->d_name[1] == '\0' ||
@@ -469,7 +519,7 @@ m3ApiRawFunction(m3_dir_read)
         // stat to determine type (matches dir_list() in commands.cpp)
         char fullpath[WASM_MAX_PATH_LEN + 16 + 256 + 2];
         snprintf(fullpath, sizeof(fullpath), "%s/%s",
-                 wasm_dir_path[handle], ent->d_name);
+                 inst->dir_path[handle], ent->d_name);
         struct stat st;
         int32_t type;
         if (stat(fullpath, &st) != 0) {
@@ -493,9 +543,10 @@ m3ApiRawFunction(m3_dir_read)
 m3ApiRawFunction(m3_dir_close)
 {
     m3ApiGetArg(int32_t, handle);
-    if (dir_handle_ok(handle)) {
-        closedir(wasm_dirs[handle]);
-        wasm_dirs[handle] = NULL;
+    wasm_instance *inst = wasm_inst(runtime);
+    if (dir_handle_ok(inst, handle)) {
+        closedir(inst->dirs[handle]);
+        inst->dirs[handle] = NULL;
     }
     m3ApiSuccess();
 }
@@ -525,6 +576,9 @@ M3Result link_file_imports(IM3Module module)
     LINK("file_readln",     "i(iii)",  m3_file_readln)
     LINK("file_readln_str", "i(i)",    m3_file_readln_str)
     LINK("file_writeln",    "i(ii)",   m3_file_writeln)
+    LINK("file_map",        "i(iii)",  m3_file_map)
+    LINK("file_map_get",    "i(iii)",  m3_file_map_get)
+    LINK("file_unmap",      "v(i)",    m3_file_unmap)
 
     LINK("file_stat",       "i(ii)",   m3_file_stat)
     LINK("file_delete",     "i(i)",    m3_file_delete)
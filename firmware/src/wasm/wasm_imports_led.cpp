@@ -1,12 +1,12 @@
 #ifdef INCLUDE_WASM
 
 #include "wasm_internal.h"
+#include "wasm_wrapper.h"
 #include "led.h"
 #include "config.h"
 #include <string.h>
 
-// ---------- Auto-gamma state ----------
-static bool wasm_use_gamma = false;
+// ---------- Auto-gamma (per program, wasm_instance::use_gamma) ----------
 
 static const uint8_t gamma8[] = {
     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
@@ -27,22 +27,24 @@ static const uint8_t gamma8[] = {
   215,218,220,223,225,228,231,233,236,239,241,244,247,249,252,255
 };
 
-static inline uint8_t wasm_gamma(uint8_t v) {
-    return wasm_use_gamma ? gamma8[v] : v;
+static inline uint8_t wasm_gamma(IM3Runtime rt, uint8_t v) {
+    return wasm_inst(rt)->use_gamma ? gamma8[v] : v;
 }
 
-static CRGB *led_buf_for_channel(int ch, int *count_out) {
-    switch (ch) {
-        case 1: *count_out = config.led_count1; return leds1;
-        case 2: *count_out = config.led_count2; return leds2;
-        case 3: *count_out = config.led_count3; return leds3;
-        case 4: *count_out = config.led_count4; return leds4;
-        default: *count_out = 0; return NULL;
-    }
+// Each slot draws into its own LED layer, so one program's led_show() never
+// publishes another's half-drawn channel; the render task composes them.
+static_assert(LED_SRC_WASM + WASM_MAX_INSTANCES - 1 == LED_SRC_WASM3, "one LED layer per WASM slot");
+
+static inline int wasm_led_src(IM3Runtime rt) {
+    return LED_SRC_WASM + wasm_inst(rt)->slot;
+}
+
+static CRGB *led_buf_for_channel(IM3Runtime rt, int ch, int *count_out) {
+    return led_src_buf(wasm_led_src(rt), ch, count_out);
 }
 
-void wasm_reset_gamma(void) {
-    wasm_use_gamma = false;
+void wasm_reset_gamma(wasm_instance *inst) {
+    inst->use_gamma = false;
 }
 
 // --- LED core ---
@@ -56,16 +58,10 @@ m3ApiRawFunction(m3_led_set_pixel)
     m3ApiGetArg(int32_t, g);
     m3ApiGetArg(int32_t, b);
 
-    CRGB *buf = NULL;
-    int count = 0;
-    switch (channel) {
-        case 1: buf = leds1; count = config.led_count1; break;
-        case 2: buf = leds2; count = config.led_count2; break;
-        case 3: buf = leds3; count = config.led_count3; break;
-        case 4: buf = leds4; count = config.led_count4; break;
-    }
+    int count;
+    CRGB *buf = led_buf_for_channel(runtime, channel, &count);
     if (buf && pos >= 0 && pos < count) {
-        buf[pos] = CRGB(wasm_gamma((uint8_t)r), wasm_gamma((uint8_t)g), wasm_gamma((uint8_t)b));
+        buf[pos] = CRGB(wasm_gamma(runtime, (uint8_t)r), wasm_gamma(runtime, (uint8_t)g), wasm_gamma(runtime, (uint8_t)b));
     }
 
     m3ApiSuccess();
@@ -79,17 +75,9 @@ m3ApiRawFunction(m3_led_fill)
     m3ApiGetArg(int32_t, g);
     m3ApiGetArg(int32_t, b);
 
-    CRGB col(wasm_gamma((uint8_t)r), wasm_gamma((uint8_t)g), wasm_gamma((uint8_t)b));
-    if (channel >= 1 && channel <= 4) {
-        int cnt = 0;
-        switch (channel) {
-            case 1: cnt = config.led_count1; break;
-            case 2: cnt = config.led_count2; break;
-            case 3: cnt = config.led_count3; break;
-            case 4: cnt = config.led_count4; break;
-        }
-        led_set_channel(channel, cnt, col);
-    }
+    CRGB col(wasm_gamma(runtime, (uint8_t)r), wasm_gamma(runtime, (uint8_t)g), wasm_gamma(runtime, (uint8_t)b));
+    if (channel >= 1 && channel <= 4)
+        led_src_fill(wasm_led_src(runtime), channel, col);
 
     m3ApiSuccess();
 }
@@ -97,7 +85,7 @@ m3ApiRawFunction(m3_led_fill)
 // void led_show()
 m3ApiRawFunction(m3_led_show)
 {
-    led_show();
+    led_src_show(wasm_led_src(runtime));
     m3ApiSuccess();
 }
 
@@ -128,21 +116,15 @@ m3ApiRawFunction(m3_led_set_pixel_hsv)
     m3ApiGetArg(int32_t, s);
     m3ApiGetArg(int32_t, v);
 
-    CRGB *buf = NULL;
-    int count = 0;
-    switch (channel) {
-        case 1: buf = leds1; count = config.led_count1; break;
-        case 2: buf = leds2; count = config.led_count2; break;
-        case 3: buf = leds3; count = config.led_count3; break;
-        case 4: buf = leds4; count = config.led_count4; break;
-    }
+    int count;
+    CRGB *buf = led_buf_for_channel(runtime, channel, &count);
     if (buf && pos >= 0 && pos < count) {
         CHSV hsv((uint8_t)h, (uint8_t)s, (uint8_t)v);
         CRGB rgb;
         hsv2rgb_rainbow(hsv, rgb);
-        rgb.r = wasm_gamma(rgb.r);
-        rgb.g = wasm_gamma(rgb.g);
-        rgb.b = wasm_gamma(rgb.b);
+        rgb.r = wasm_gamma(runtime, rgb.r);
+        rgb.g = wasm_gamma(runtime, rgb.g);
+        rgb.b = wasm_gamma(runtime, rgb.b);
         buf[pos] = rgb;
     }
 
@@ -161,17 +143,10 @@ m3ApiRawFunction(m3_led_fill_hsv)
         CHSV hsv((uint8_t)h, (uint8_t)s, (uint8_t)v);
         CRGB rgb;
         hsv2rgb_rainbow(hsv, rgb);
-        rgb.r = wasm_gamma(rgb.r);
-        rgb.g = wasm_gamma(rgb.g);
-        rgb.b = wasm_gamma(rgb.b);
-        int cnt = 0;
-        switch (channel) {
-            case 1: cnt = config.led_count1; break;
-            case 2: cnt = config.led_count2; break;
-            case 3: cnt = config.led_count3; break;
-            case 4: cnt = config.led_count4; break;
-        }
-        led_set_channel(channel, cnt, rgb);
+        rgb.r = wasm_gamma(runtime, rgb.r);
+        rgb.g = wasm_gamma(runtime, rgb.g);
+        rgb.b = wasm_gamma(runtime, rgb.b);
+        led_src_fill(wasm_led_src(runtime), channel, rgb);
     }
 
     m3ApiSuccess();
@@ -218,7 +193,7 @@ m3ApiRawFunction(m3_led_gamma8) {
 // void led_set_gamma(i32 enable)
 m3ApiRawFunction(m3_led_set_gamma) {
     m3ApiGetArg(int32_t, enable);
-    wasm_use_gamma = (enable != 0);
+    wasm_inst(runtime)->use_gamma = (enable != 0);
     m3ApiSuccess();
 }
 
@@ -231,14 +206,8 @@ m3ApiRawFunction(m3_led_set_buffer) {
     m3ApiGetArg(int32_t, rgb_ptr);
     m3ApiGetArg(int32_t, count);
 
-    CRGB *buf = NULL;
-    int max_count = 0;
-    switch (channel) {
-        case 1: buf = leds1; max_count = config.led_count1; break;
-        case 2: buf = leds2; max_count = config.led_count2; break;
-        case 3: buf = leds3; max_count = config.led_count3; break;
-        case 4: buf = leds4; max_count = config.led_count4; break;
-    }
+    int max_count;
+    CRGB *buf = led_buf_for_channel(runtime, channel, &max_count);
     if (!buf || count <= 0) { m3ApiSuccess(); }
 
     if (count > max_count) count = max_count;
@@ -250,7 +219,7 @@ m3ApiRawFunction(m3_led_set_buffer) {
     for (int i = 0; i < count; i++) {
         uint8_t rgb[3];
         wasm_mem_read(runtime, (uint32_t)rgb_ptr + i * 3, rgb, 3);
-        buf[i] = CRGB(wasm_gamma(rgb[0]), wasm_gamma(rgb[1]), wasm_gamma(rgb[2]));
+        buf[i] = CRGB(wasm_gamma(runtime, rgb[0]), wasm_gamma(runtime, rgb[1]), wasm_gamma(runtime, rgb[2]));
     }
 
     m3ApiSuccess();
@@ -267,7 +236,7 @@ m3ApiRawFunction(m3_led_shift) {
     m3ApiGetArg(int32_t, g);
     m3ApiGetArg(int32_t, b);
     int cnt;
-    CRGB *buf = led_buf_for_channel(channel, &cnt);
+    CRGB *buf = led_buf_for_channel(runtime, channel, &cnt);
     if (!buf || cnt == 0) { m3ApiSuccess(); }
     CRGB fill_col(r, g, b);
     // Clamp magnitude to cnt via 64-bit first: negating INT_MIN is UB and leaves
@@ -294,7 +263,7 @@ m3ApiRawFunction(m3_led_rotate) {
     m3ApiGetArg(int32_t, channel);
     m3ApiGetArg(int32_t, amount);
     int cnt;
-    CRGB *buf = led_buf_for_channel(channel, &cnt);
+    CRGB *buf = led_buf_for_channel(runtime, channel, &cnt);
     if (!buf || cnt == 0) { m3ApiSuccess(); }
     int shift = amount % cnt;
     if (shift < 0) shift += cnt;
@@ -313,7 +282,7 @@ m3ApiRawFunction(m3_led_rotate) {
 m3ApiRawFunction(m3_led_reverse) {
     m3ApiGetArg(int32_t, channel);
     int cnt;
-    CRGB *buf = led_buf_for_channel(channel, &cnt);
+    CRGB *buf = led_buf_for_channel(runtime, channel, &cnt);
     if (!buf || cnt < 2) { m3ApiSuccess(); }
     for (int i = 0; i < cnt / 2; i++) {
         CRGB tmp = buf[i];
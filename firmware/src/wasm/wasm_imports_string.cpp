@@ -2,27 +2,15 @@
 
 #include "wasm_internal.h"
 #include "printManager.h"
+#include "config.h"
 #include <string.h>
 #include <stdio.h>
 #include <ctype.h>
 
 // ---- String Pool ----
-// Host-managed free-list allocator operating on WASM linear memory.
-// Pool region: 0x8000 .. 0xF000 (28KB)
-
-#define STR_POOL_START  0x8000
-#define STR_POOL_END    0xF000
-#define STR_MAX_ALLOCS  128
-
-struct StrAlloc {
-    uint32_t offset;
-    uint32_t size;
-    bool in_use;
-};
-
-static StrAlloc str_allocs[STR_MAX_ALLOCS];
-static int str_nallocs = 0;
-static uint32_t str_bump = STR_POOL_START;
+// Size-class allocator (str_pool.cpp) over a region of WASM linear memory,
+// [wasm] pool_start / pool_kb in the config: 0x8000 .. 0xF000 (28KB) by
+// default. Its bookkeeping lives per program, in the wasm_instance.
 
 // Bounded strlen in WASM memory (legacy — used by wasm_format.cpp via old API)
 int wasm_strlen(const uint8_t *mem, uint32_t mem_size, uint32_t ptr)
@@ -37,97 +25,26 @@ int wasm_strlen(const uint8_t *mem, uint32_t mem_size, uint32_t ptr)
 uint32_t pool_alloc(IM3Runtime runtime, int size)
 {
     if (size <= 0) size = 1;
-    size = (size + 3) & ~3;  // 4-byte align
-
-    // First-fit scan of freed blocks
-    for (int i = 0; i < str_nallocs; i++) {
-        if (!str_allocs[i].in_use && str_allocs[i].size >= (uint32_t)size) {
-            str_allocs[i].in_use = true;
-            wasm_mem_set(runtime, str_allocs[i].offset, 0, size);
-            return str_allocs[i].offset;
-        }
-    }
-
-    // Bump allocate
-    if (str_bump + size > STR_POOL_END) return 0;  // out of pool
-    if (str_nallocs >= STR_MAX_ALLOCS) return 0;    // too many allocs
-
-    uint32_t off = str_bump;
-    str_bump += size;
-
-    str_allocs[str_nallocs].offset = off;
-    str_allocs[str_nallocs].size = size;
-    str_allocs[str_nallocs].in_use = true;
-    str_nallocs++;
-
-    wasm_mem_set(runtime, off, 0, size);
+    uint32_t off = str_pool_alloc(&wasm_inst(runtime)->pool, (uint32_t)size);
+    if (off) wasm_mem_set(runtime, off, 0, (size + 3) & ~3);
     return off;
 }
 
-static void pool_free(uint32_t ptr)
-{
-    if (ptr < STR_POOL_START || ptr >= STR_POOL_END) return;  // outside pool (constant or null)
-
-    int idx = -1;
-    for (int i = 0; i < str_nallocs; i++) {
-        if (str_allocs[i].offset == ptr && str_allocs[i].in_use) { idx = i; break; }
-    }
-    if (idx < 0) return;
-    str_allocs[idx].in_use = false;
-
-    // Coalesce adjacent free blocks so long-lived modules don't fragment.
-    // Dead slots are marked size=0 — first-fit skips them (min alloc is 4).
-
-    // Forward: merge a free successor into us
-    for (int i = 0; i < str_nallocs; i++) {
-        if (i != idx && !str_allocs[i].in_use && str_allocs[i].size > 0
-            && str_allocs[idx].offset + str_allocs[idx].size == str_allocs[i].offset) {
-            str_allocs[idx].size += str_allocs[i].size;
-            str_allocs[i].size = 0;
-            break;
-        }
-    }
-    // Backward: absorb us into a free predecessor
-    for (int i = 0; i < str_nallocs; i++) {
-        if (i != idx && !str_allocs[i].in_use && str_allocs[i].size > 0
-            && str_allocs[i].offset + str_allocs[i].size == str_allocs[idx].offset) {
-            str_allocs[i].size += str_allocs[idx].size;
-            str_allocs[idx].size = 0;
-            idx = i;
-            break;
-        }
-    }
-
-    // Shrink bump if the coalesced block is at the top
-    if (str_allocs[idx].offset + str_allocs[idx].size == str_bump) {
-        str_bump = str_allocs[idx].offset;
-        str_allocs[idx].size = 0;
-    }
-
-    // Prune trailing dead records
-    while (str_nallocs > 0 && str_allocs[str_nallocs - 1].size == 0)
-        str_nallocs--;
-}
-
-static uint32_t pool_size(uint32_t ptr)
+static void pool_free(wasm_instance *inst, uint32_t ptr)
 {
-    for (int i = 0; i < str_nallocs; i++) {
-        if (str_allocs[i].offset == ptr && str_allocs[i].in_use)
-            return str_allocs[i].size;
-    }
-    return 0;
+    str_pool_free(&inst->pool, ptr);   // constants, null and stale pointers are ignored
 }
 
 static uint32_t pool_realloc(IM3Runtime runtime, uint32_t ptr, int size)
 {
+    wasm_instance *inst = wasm_inst(runtime);
     if (ptr == 0) return pool_alloc(runtime, size);
     if (size <= 0) {
-        pool_free(ptr);
+        pool_free(inst, ptr);
         return 0;
     }
 
-    size = (size + 3) & ~3;
-    uint32_t old_size = pool_size(ptr);
+    uint32_t old_size = str_pool_block_size(&inst->pool, ptr);
     if (old_size == 0) return 0;
     if (old_size >= (uint32_t)size) return ptr;
 
@@ -135,130 +52,153 @@ static uint32_t pool_realloc(IM3Runtime runtime, uint32_t ptr, int size)
     if (nptr == 0) return 0;
 
     wasm_mem_copy(runtime, nptr, ptr, old_size);
-    pool_free(ptr);
+    pool_free(inst, ptr);
     return nptr;
 }
 
-void wasm_string_pool_reset(void)
+// Place the pool once the module is loaded: clear of the program's data
+// (the low heap starts after it), of the FORMAT buffer, and inside linear
+// memory. The low heap gets what lies between its start and the pool.
+void wasm_string_pool_init(IM3Runtime runtime)
+{
+    wasm_instance *inst = wasm_inst(runtime);
+    uint32_t want  = (uint32_t)config.wasm_pool_kb * 1024;
+    uint32_t start = (uint32_t)config.wasm_pool_start;
+    uint32_t end   = start + want;
+
+    if (start < inst->low_heap_start) start = inst->low_heap_start;
+    if (start < WASM_FMT_BUF_END && end > WASM_FMT_BUF_START) {
+        if (start < WASM_FMT_BUF_START) end = WASM_FMT_BUF_START;
+        else                            start = WASM_FMT_BUF_END;
+    }
+    uint32_t mem_size = wasm_mem_size(runtime);
+    if (end > mem_size) end = mem_size;
+    if (end < start) end = start;
+
+    if (!str_pool_init(&inst->pool, start, end - start))
+        printfnl(SOURCE_WASM, "wasm: string pool map alloc failed\n");
+    else if (inst->pool.st.size < want)
+        printfnl(SOURCE_WASM, "wasm: string pool trimmed to %uKB at 0x%X\n",
+                 (unsigned)(inst->pool.st.size / 1024), (unsigned)inst->pool.start);
+
+    inst->low_heap_end = start < WASM_FMT_BUF_START ? start : WASM_FMT_BUF_START;
+}
+
+// Stats outlive this: wasm_status shows them for the finished run
+void wasm_string_pool_free(wasm_instance *inst)
 {
-    str_nallocs = 0;
-    str_bump = STR_POOL_START;
+    str_pool_release(&inst->pool);
 }
 
 
 // ---- Low Heap (DIM arrays, user malloc/calloc) ----
-// Grows upward from _heap_ptr toward STR_POOL_START (0x8000).
+// Grows upward from _heap_ptr toward the string pool (0x8000 by default).
 // Falls in the DRAM window (first 4KB) for small programs, giving
 // near-DRAM speed on PSRAM-backed linear memory.
 
-#define LOW_HEAP_MAX_ALLOCS 32
-
-static StrAlloc low_allocs[LOW_HEAP_MAX_ALLOCS];
-static int low_nallocs = 0;
-static uint32_t low_heap_start = 0;
-static uint32_t low_heap_bump = 0;
-
-void low_heap_init(uint32_t start)
+void low_heap_init(wasm_instance *inst, uint32_t start)
 {
-    low_nallocs = 0;
-    low_heap_start = start;
-    low_heap_bump = start;
+    inst->low_nallocs = 0;
+    inst->low_heap_start = start;
+    inst->low_heap_bump = start;
 }
 
-void low_heap_reset(void)
+void low_heap_reset(wasm_instance *inst)
 {
-    low_nallocs = 0;
-    low_heap_bump = low_heap_start;
+    inst->low_nallocs = 0;
+    inst->low_heap_bump = inst->low_heap_start;
 }
 
 static uint32_t low_heap_alloc(IM3Runtime runtime, int size)
 {
-    if (low_heap_start == 0) return 0;  // disabled (old binary, no _heap_ptr export)
+    wasm_instance *inst = wasm_inst(runtime);
+    if (inst->low_heap_start == 0) return 0;  // disabled (old binary, no _heap_ptr export)
     if (size <= 0) size = 1;
     size = (size + 3) & ~3;  // 4-byte align
 
     // First-fit scan of freed blocks
-    for (int i = 0; i < low_nallocs; i++) {
-        if (!low_allocs[i].in_use && low_allocs[i].size >= (uint32_t)size) {
-            low_allocs[i].in_use = true;
-            wasm_mem_set(runtime, low_allocs[i].offset, 0, size);
-            return low_allocs[i].offset;
+    for (int i = 0; i < inst->low_nallocs; i++) {
+        if (!inst->low_allocs[i].in_use && inst->low_allocs[i].size >= (uint32_t)size) {
+            inst->low_allocs[i].in_use = true;
+            wasm_mem_set(runtime, inst->low_allocs[i].offset, 0, size);
+            return inst->low_allocs[i].offset;
         }
     }
 
     // Bump allocate — stop before string pool
-    if (low_heap_bump + size > STR_POOL_START) return 0;
-    if (low_nallocs >= LOW_HEAP_MAX_ALLOCS) return 0;
+    if (inst->low_heap_bump + size > inst->low_heap_end) return 0;
+    if (inst->low_nallocs >= LOW_HEAP_MAX_ALLOCS) return 0;
 
-    uint32_t off = low_heap_bump;
-    low_heap_bump += size;
+    uint32_t off = inst->low_heap_bump;
+    inst->low_heap_bump += size;
 
-    low_allocs[low_nallocs].offset = off;
-    low_allocs[low_nallocs].size = size;
-    low_allocs[low_nallocs].in_use = true;
-    low_nallocs++;
+    inst->low_allocs[inst->low_nallocs].offset = off;
+    inst->low_allocs[inst->low_nallocs].size = size;
+    inst->low_allocs[inst->low_nallocs].in_use = true;
+    inst->low_nallocs++;
 
     wasm_mem_set(runtime, off, 0, size);
     return off;
 }
 
-static void low_heap_free(uint32_t ptr)
+static void low_heap_free(wasm_instance *inst, uint32_t ptr)
 {
     int idx = -1;
-    for (int i = 0; i < low_nallocs; i++) {
-        if (low_allocs[i].offset == ptr && low_allocs[i].in_use) { idx = i; break; }
+    for (int i = 0; i < inst->low_nallocs; i++) {
+        if (inst->low_allocs[i].offset == ptr && inst->low_allocs[i].in_use) { idx = i; break; }
     }
     if (idx < 0) return;
-    low_allocs[idx].in_use = false;
+    inst->low_allocs[idx].in_use = false;
 
     // Coalesce forward
-    for (int i = 0; i < low_nallocs; i++) {
-        if (i != idx && !low_allocs[i].in_use && low_allocs[i].size > 0
-            && low_allocs[idx].offset + low_allocs[idx].size == low_allocs[i].offset) {
-            low_allocs[idx].size += low_allocs[i].size;
-            low_allocs[i].size = 0;
+    for (int i = 0; i < inst->low_nallocs; i++) {
+        if (i != idx && !inst->low_allocs[i].in_use && inst->low_allocs[i].size > 0
+            && inst->low_allocs[idx].offset + inst->low_allocs[idx].size == inst->low_allocs[i].offset) {
+            inst->low_allocs[idx].size += inst->low_allocs[i].size;
+            inst->low_allocs[i].size = 0;
             break;
         }
     }
     // Coalesce backward
-    for (int i = 0; i < low_nallocs; i++) {
-        if (i != idx && !low_allocs[i].in_use && low_allocs[i].size > 0
-            && low_allocs[i].offset + low_allocs[i].size == low_allocs[idx].offset) {
-            low_allocs[i].size += low_allocs[idx].size;
-            low_allocs[idx].size = 0;
+    for (int i = 0; i < inst->low_nallocs; i++) {
+        if (i != idx && !inst->low_allocs[i].in_use && inst->low_allocs[i].size > 0
+            && inst->low_allocs[i].offset + inst->low_allocs[i].size == inst->low_allocs[idx].offset) {
+            inst->low_allocs[i].size += inst->low_allocs[idx].size;
+            inst->low_allocs[idx].size = 0;
             idx = i;
             break;
         }
     }
 
-    if (low_allocs[idx].offset + low_allocs[idx].size == low_heap_bump) {
-        low_heap_bump = low_allocs[idx].offset;
-        low_allocs[idx].size = 0;
+    if (inst->low_allocs[idx].offset + inst->low_allocs[idx].size == inst->low_heap_bump) {
+        inst->low_heap_bump = inst->low_allocs[idx].offset;
+        inst->low_allocs[idx].size = 0;
     }
 
-    while (low_nallocs > 0 && low_allocs[low_nallocs - 1].size == 0)
-        low_nallocs--;
+    while (inst->low_nallocs > 0 && inst->low_allocs[inst->low_nallocs - 1].size == 0)
+        inst->low_nallocs--;
 }
 
-static uint32_t low_heap_size(uint32_t ptr)
+static uint32_t low_heap_size(wasm_instance *inst, uint32_t ptr)
 {
-    for (int i = 0; i < low_nallocs; i++) {
-        if (low_allocs[i].offset == ptr && low_allocs[i].in_use)
-            return low_allocs[i].size;
+    for (int i = 0; i < inst->low_nallocs; i++) {
+        if (inst->low_allocs[i].offset == ptr && inst->low_allocs[i].in_use)
+            return inst->low_allocs[i].size;
     }
     return 0;
 }
 
 static uint32_t low_heap_realloc(IM3Runtime runtime, uint32_t ptr, int size)
 {
+    wasm_instance *inst = wasm_inst(runtime);
     if (ptr == 0) return low_heap_alloc(runtime, size);
     if (size <= 0) {
-        low_heap_free(ptr);
+        low_heap_free(inst, ptr);
         return 0;
     }
 
     size = (size + 3) & ~3;
-    uint32_t old_size = low_heap_size(ptr);
+    uint32_t old_size = low_heap_size(inst, ptr);
     if (old_size == 0) return 0;
     if (old_size >= (uint32_t)size) return ptr;
 
@@ -267,7 +207,7 @@ static uint32_t low_heap_realloc(IM3Runtime runtime, uint32_t ptr, int size)
 
     uint32_t copy_size = old_size < (uint32_t)size ? old_size : (uint32_t)size;
     wasm_mem_copy(runtime, nptr, ptr, copy_size);
-    low_heap_free(ptr);
+    low_heap_free(inst, ptr);
     return nptr;
 }
 
@@ -286,7 +226,7 @@ m3ApiRawFunction(m3_str_alloc)
 m3ApiRawFunction(m3_str_free)
 {
     m3ApiGetArg(int32_t, ptr);
-    pool_free((uint32_t)ptr);
+    pool_free(wasm_inst(runtime), (uint32_t)ptr);
     m3ApiSuccess();
 }
 
@@ -304,10 +244,11 @@ m3ApiRawFunction(m3_malloc)
 m3ApiRawFunction(m3_free)
 {
     m3ApiGetArg(int32_t, ptr);
-    if ((uint32_t)ptr < STR_POOL_START)
-        low_heap_free((uint32_t)ptr);
+    wasm_instance *inst = wasm_inst(runtime);
+    if (str_pool_contains(&inst->pool, (uint32_t)ptr))
+        pool_free(inst, (uint32_t)ptr);
     else
-        pool_free((uint32_t)ptr);
+        low_heap_free(inst, (uint32_t)ptr);
     m3ApiSuccess();
 }
 
@@ -332,10 +273,10 @@ m3ApiRawFunction(m3_realloc)
     m3ApiGetArg(int32_t, ptr);
     m3ApiGetArg(int32_t, size);
     uint32_t result;
-    if ((uint32_t)ptr < STR_POOL_START)
-        result = low_heap_realloc(runtime, (uint32_t)ptr, size);
-    else
+    if (str_pool_contains(&wasm_inst(runtime)->pool, (uint32_t)ptr))
         result = pool_realloc(runtime, (uint32_t)ptr, size);
+    else
+        result = low_heap_realloc(runtime, (uint32_t)ptr, size);
     m3ApiReturn((int32_t)result);
 }
 
@@ -33,7 +33,7 @@ m3ApiRawFunction(m3_set_param)
 m3ApiRawFunction(m3_should_stop)
 {
     m3ApiReturnType(int32_t);
-    m3ApiReturn((wasm_stop_requested || get_basic_param(0) == 1) ? 1 : 0);
+    m3ApiReturn(wasm_should_stop(runtime) ? 1 : 0);
 }
 
 // --- Cue engine ---
@@ -76,7 +76,7 @@ m3ApiRawFunction(m3_wait_pps) {
         vTaskDelay(pdMS_TO_TICKS(1));
         inc_thread_count(xPortGetCoreID());
         if (get_pps_flag()) m3ApiReturn(1);
-        if (wasm_stop_requested || get_basic_param(0) == 1) m3ApiReturn(0);
+        if (wasm_should_stop(runtime)) m3ApiReturn(0);
         if (timeout_ms > 0 && (int32_t)(uptime_ms() - t) > timeout_ms) m3ApiReturn(0);
     }
 }
@@ -101,7 +101,7 @@ m3ApiRawFunction(m3_wait_param) {
             case 3: match = (p != value); break;  // neq
         }
         if (match) m3ApiReturn(1);
-        if (wasm_stop_requested || get_basic_param(0) == 1) m3ApiReturn(0);
+        if (wasm_should_stop(runtime)) m3ApiReturn(0);
         if (timeout_ms > 0 && (int32_t)(uptime_ms() - t) > timeout_ms) m3ApiReturn(0);
         vTaskDelay(pdMS_TO_TICKS(1));
         inc_thread_count(xPortGetCoreID());
@@ -1,11 +1,78 @@
 #ifndef wasm_internal_h
 #define wasm_internal_h
 
+#include <stdio.h>
+#include <dirent.h>
 #include "wasm3.h"
 #include "m3_config.h"
+#include "str_pool.h"
 
-// Shared state (defined in wasm_wrapper.cpp)
-extern volatile bool wasm_stop_requested;
+// ---- Per-instance state ----
+// Several programs can run at once, each in its own runtime and task. All
+// host-side state a program can touch lives in its wasm_instance, reached
+// from any import through the runtime's userdata (wasm_inst()).
+
+#define WASM_MAX_OPEN_FILES  4
+#define WASM_MAX_OPEN_DIRS   4
+#define WASM_MAX_PATH_LEN  128
+#define WASM_FILE_BUF_SIZE 4096     // stdio buffer per open file: one LittleFS block
+
+#define LOW_HEAP_MAX_ALLOCS  32
+
+// Fixed addresses in every bas2wasm and c2wasm program: the FORMAT/printf
+// argument buffer (0xF000) and bas2wasm's file handle table (0xF100).
+// Neither heap may overlap them.
+#define WASM_FMT_BUF_START  0xF000
+#define WASM_FMT_BUF_END    0xF110
+
+struct StrAlloc {
+    uint32_t offset;
+    uint32_t size;
+    bool in_use;
+};
+
+// A file_map() view: a window of an open file held in a buffer the program
+// supplied, refilled by file_map_get() when a request falls outside it
+struct FileMap {
+    uint32_t buf;       // window in linear memory, 0 = not mapped
+    uint32_t cap;       // window size
+    uint32_t start;     // file offset of the window's first byte
+    uint32_t len;       // bytes of the file currently in the window
+};
+
+struct wasm_instance {
+    int      slot;              // index in wasm_wrapper.cpp's slot table
+    uint32_t slice_start_ms;    // m3_Yield() time slice
+    uint32_t cpu_counter;       // FreeRTOS run-time counter at the last sample
+    uint64_t cpu_us;            // CPU time used so far
+
+    // wasm_imports_file.cpp
+    FILE *files[WASM_MAX_OPEN_FILES];
+    DIR  *dirs [WASM_MAX_OPEN_DIRS];
+    // Parallel to dirs: the fully-prefixed LittleFS path, needed to stat entries
+    char  dir_path[WASM_MAX_OPEN_DIRS][WASM_MAX_PATH_LEN + 16];
+    FileMap maps[WASM_MAX_OPEN_FILES];      // parallel to files
+
+    // wasm_imports_led.cpp
+    bool use_gamma;
+
+    // wasm_imports_string.cpp
+    str_pool pool;
+    StrAlloc low_allocs[LOW_HEAP_MAX_ALLOCS];
+    int      low_nallocs;
+    uint32_t low_heap_start;
+    uint32_t low_heap_end;      // where the string pool (or FMT buffer) begins
+    uint32_t low_heap_bump;
+};
+
+static inline wasm_instance *wasm_inst(IM3Runtime rt)
+{
+    return (wasm_instance *)m3_GetUserData(rt);
+}
+
+// True once the program running in `rt` has been asked to stop
+// (defined in wasm_wrapper.cpp)
+bool wasm_should_stop(IM3Runtime rt);
 
 // Link functions (each defined in its own wasm_imports_*.cpp / wasm_format.cpp)
 M3Result link_led_imports(IM3Module module);
@@ -21,12 +88,13 @@ M3Result link_string_imports(IM3Module module);
 M3Result link_compression_imports(IM3Module module);
 M3Result link_deflate_imports(IM3Module module);
 
-// Cleanup functions (called from wasm_run() on program exit)
-void wasm_close_all_files(void);   // defined in wasm_imports_file.cpp
-void wasm_reset_gamma(void);       // defined in wasm_imports_led.cpp
-void wasm_string_pool_reset(void); // defined in wasm_imports_string.cpp
-void low_heap_init(uint32_t start); // defined in wasm_imports_string.cpp
-void low_heap_reset(void);          // defined in wasm_imports_string.cpp
+// Setup and cleanup of an instance's host-side state (called from wasm_run())
+void wasm_close_all_files(wasm_instance *inst);                // wasm_imports_file.cpp
+void wasm_reset_gamma(wasm_instance *inst);                    // wasm_imports_led.cpp
+void wasm_string_pool_init(IM3Runtime runtime);                // wasm_imports_string.cpp
+void wasm_string_pool_free(wasm_instance *inst);               // wasm_imports_string.cpp
+void low_heap_init(wasm_instance *inst, uint32_t start);       // wasm_imports_string.cpp
+void low_heap_reset(wasm_instance *inst);                      // wasm_imports_string.cpp
 
 // String pool helpers (defined in wasm_imports_string.cpp, used by file imports)
 uint32_t pool_alloc(IM3Runtime runtime, int size);
@@ -44,5 +112,8 @@ uint8_t  wasm_mem_read8(IM3Runtime rt, uint32_t offset);
 void     wasm_mem_write8(IM3Runtime rt, uint32_t offset, uint8_t val);
 void     wasm_mem_copy(IM3Runtime rt, uint32_t dst, uint32_t src, size_t len);
 void     wasm_mem_set(IM3Runtime rt, uint32_t offset, uint8_t val, size_t len);
+// fread/fwrite directly into/out of linear memory; bytes moved, 0 if out of bounds
+size_t   wasm_mem_fread(IM3Runtime rt, uint32_t offset, size_t len, FILE *f);
+size_t   wasm_mem_fwrite(IM3Runtime rt, uint32_t offset, size_t len, FILE *f);
 
 #endif
@@ -0,0 +1,101 @@
+#include <string.h>
+#include "wasm_lines.h"
+
+#define LINES_SECTION   "conez.lines"
+#define LINES_VERSION   1
+
+static bool rd_uleb(const uint8_t **pp, const uint8_t *end, uint32_t *v)
+{
+    const uint8_t *p = *pp;
+    uint32_t r = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (p >= end) return false;
+        uint8_t b = *p++;
+        r |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *pp = p;
+            *v = r;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool rd_sleb(const uint8_t **pp, const uint8_t *end, int32_t *v)
+{
+    const uint8_t *p = *pp;
+    uint32_t r = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (p >= end) return false;
+        uint8_t b = *p++;
+        r |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            if (shift < 25 && (b & 0x40)) r |= ~0u << (shift + 7);
+            *pp = p;
+            *v = (int32_t)r;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Check every entry decodes inside the section, so lookups needn't
+static bool entries_ok(const uint8_t *p, const uint8_t *end, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t d;
+        int32_t dl;
+        if (!rd_uleb(&p, end, &d) || !rd_sleb(&p, end, &dl)) return false;
+    }
+    return true;
+}
+
+bool wasm_lines_find(wasm_lines *wl, const uint8_t *wasm, size_t len)
+{
+    wl->ents = wl->end = NULL;
+    wl->count = 0;
+    if (len < 8 || memcmp(wasm, "\0asm", 4) != 0) return false;
+
+    const uint8_t *p = wasm + 8;
+    const uint8_t *end = wasm + len;
+    while (p < end) {
+        uint8_t id = *p++;
+        uint32_t size;
+        if (!rd_uleb(&p, end, &size) || size > (size_t)(end - p)) return false;
+        const uint8_t *sec_end = p + size;
+        if (id == 0) {
+            uint32_t nlen;
+            const uint8_t *q = p;
+            if (rd_uleb(&q, sec_end, &nlen) && nlen == sizeof(LINES_SECTION) - 1
+                && nlen <= (size_t)(sec_end - q) && memcmp(q, LINES_SECTION, nlen) == 0) {
+                q += nlen;
+                uint32_t version, count;
+                if (!rd_uleb(&q, sec_end, &version) || version != LINES_VERSION) return false;
+                if (!rd_uleb(&q, sec_end, &count) || !entries_ok(q, sec_end, count)) return false;
+                wl->ents = q;
+                wl->end = sec_end;
+                wl->count = count;
+                return true;
+            }
+        }
+        p = sec_end;
+    }
+    return false;
+}
+
+int wasm_lines_lookup(const wasm_lines *wl, uint32_t offset)
+{
+    const uint8_t *p = wl->ents;
+    uint32_t at = 0;
+    int32_t line = 0;
+    for (uint32_t i = 0; i < wl->count; i++) {
+        uint32_t d = 0;
+        int32_t dl = 0;
+        rd_uleb(&p, wl->end, &d);       // entries_ok() checked they decode
+        rd_sleb(&p, wl->end, &dl);
+        at += d;
+        if (at > offset) break;
+        line += dl;
+    }
+    return line;
+}
@@ -0,0 +1,36 @@
+#ifndef _conez_wasm_lines_h
+#define _conez_wasm_lines_h
+
+// Source lines for release builds. `bas2wasm --release` and `c2wasm
+// --release` drop the per-statement __line stores and append a custom
+// section instead:
+//
+//   "conez.lines": uleb version (1), uleb count, then count entries of
+//                  (uleb offset delta, sleb line delta)
+//
+// Offsets are module byte offsets, ascending; an entry's line holds from
+// its offset up to the next entry's. A trap's module offset (what wasm3's
+// backtrace records) maps to the line of the last entry at or before it.
+//
+// Nothing is copied: the table is decoded from the module bytes, which the
+// runtime keeps until the program ends. Pure C++, no wasm3/FreeRTOS
+// dependency: firmware/test/host tests it, and the simulator builds the
+// same file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct wasm_lines {
+    const uint8_t *ents;    // first entry, NULL when the module has no table
+    const uint8_t *end;     // end of the section
+    uint32_t       count;
+};
+
+// Find the table in a module. Returns false (and an empty table) when
+// there is none, or it's malformed or a newer version.
+bool wasm_lines_find(wasm_lines *wl, const uint8_t *wasm, size_t len);
+
+// Source line for a module offset, 0 when the table has none
+int  wasm_lines_lookup(const wasm_lines *wl, uint32_t offset);
+
+#endif
@@ -41,7 +41,72 @@ void m3_psram_free(uint32_t addr)
     psram_free(addr);
 }
 
-uint32_t m3_psram_yield_ctr = 0;
+// ---- Software TLB (slow paths of m3MemRead/m3MemWrite in m3_exec.h) ----
+// Each entry holds a pin on one PSRAM cache page, so hits need neither the
+// PSRAM mutex nor the cache's tag scan. Host imports keep going through
+// psram_read/psram_write: they land in the same pinned cache lines, so both
+// views stay coherent without the TLB being flushed.
+
+#if d_m3PsramTlbEntries > 0
+
+static_assert(d_m3PsramTlbPageSize == PSRAM_CACHE_PAGE_SIZE,
+              "d_m3PsramTlbPageSize must match PSRAM_CACHE_PAGE_SIZE");
+static_assert((d_m3PsramTlbEntries & (d_m3PsramTlbEntries - 1)) == 0,
+              "d_m3PsramTlbEntries must be a power of 2");
+
+// Map addr's page into its slot, pinned for stores if `write`. NULL when the
+// cache won't pin (pin limit, heap-fallback block): the caller goes uncached.
+static M3PsramTlbEntry *tlb_fill(M3MemoryHeader *mem, uint32_t addr, bool write)
+{
+    uint32_t page = addr / d_m3PsramTlbPageSize;
+    M3PsramTlbEntry *e = &mem->tlb[page & (d_m3PsramTlbEntries - 1)];
+    if (e->page)
+        psram_cache_unpin(e->page * d_m3PsramTlbPageSize);
+    e->page = e->wpage = 0;
+
+    uint8_t *data = psram_cache_pin(addr, write);
+    if (!data) return NULL;
+    e->page  = page;
+    e->wpage = write ? page : 0;
+    e->data  = data;
+    return e;
+}
+
+void m3_psram_tlb_read(M3MemoryHeader *mem, uint32_t addr, uint8_t *buf, size_t len)
+{
+    uint32_t off = addr & (d_m3PsramTlbPageSize - 1);
+    M3PsramTlbEntry *e;
+    if (off + len <= d_m3PsramTlbPageSize && (e = tlb_fill(mem, addr, false)))
+        memcpy(buf, e->data + off, len);
+    else
+        psram_read(addr, buf, len);
+}
+
+void m3_psram_tlb_write(M3MemoryHeader *mem, uint32_t addr, const uint8_t *buf, size_t len)
+{
+    uint32_t off = addr & (d_m3PsramTlbPageSize - 1);
+    M3PsramTlbEntry *e;
+    if (off + len <= d_m3PsramTlbPageSize && (e = tlb_fill(mem, addr, true)))
+        memcpy(e->data + off, buf, len);
+    else
+        psram_write(addr, buf, len);
+}
+
+void m3_psram_tlb_release(M3MemoryHeader *mem)
+{
+    for (int i = 0; i < d_m3PsramTlbEntries; i++) {
+        M3PsramTlbEntry *e = &mem->tlb[i];
+        if (e->page)
+            psram_cache_unpin(e->page * d_m3PsramTlbPageSize);
+        e->page = e->wpage = 0;
+    }
+}
+
+#else
+
+void m3_psram_tlb_release(M3MemoryHeader *mem) {}
+
+#endif // d_m3PsramTlbEntries
 
 // ---- Split-aware helpers for bulk ops that may straddle the DRAM/PSRAM boundary ----
 
@@ -87,15 +152,27 @@ void m3_split_set(uint8_t *dram_buf, uint32_t psram_addr, uint32_t offset, uint8
     }
 }
 
+// memory.copy semantics: the ranges may overlap. Inside the DRAM window it is
+// a plain memmove; otherwise it bounces through a buffer, walking backwards
+// when dst lies inside src so no chunk overwrites source bytes not yet read.
 void m3_split_move(uint8_t *dram_buf, uint32_t psram_addr, uint32_t dst_off, uint32_t src_off, uint32_t len)
 {
+    if (len == 0 || dst_off == src_off) return;
+    if (dst_off + len <= d_m3PsramDramWindow && src_off + len <= d_m3PsramDramWindow) {
+        memmove(dram_buf + dst_off, dram_buf + src_off, len);
+        return;
+    }
+    bool backward = dst_off > src_off && dst_off - src_off < len;
     uint8_t tmp[256];
     while (len > 0) {
         uint32_t chunk = (len > sizeof(tmp)) ? (uint32_t)sizeof(tmp) : len;
-        m3_split_read(dram_buf, psram_addr, src_off, tmp, chunk);
-        m3_split_write(dram_buf, psram_addr, dst_off, tmp, chunk);
-        src_off += chunk;
-        dst_off += chunk;
+        uint32_t at = backward ? len - chunk : 0;
+        m3_split_read(dram_buf, psram_addr, src_off + at, tmp, chunk);
+        m3_split_write(dram_buf, psram_addr, dst_off + at, tmp, chunk);
+        if (!backward) {
+            src_off += chunk;
+            dst_off += chunk;
+        }
         len -= chunk;
     }
 }
@@ -232,18 +309,10 @@ void wasm_mem_copy(IM3Runtime rt, uint32_t dst, uint32_t src, size_t len)
         return;
 #if d_m3UsePsramMemory
     M3MemoryHeader *hdr = rt->memory.mallocated;
-    uint8_t tmp[256];
-    while (len > 0) {
-        size_t chunk = (len > sizeof(tmp)) ? sizeof(tmp) : len;
-        m3_split_read(hdr->dram_buf, hdr->psram_addr, src, tmp, (uint32_t)chunk);
-        m3_split_write(hdr->dram_buf, hdr->psram_addr, dst, tmp, (uint32_t)chunk);
-        src += (uint32_t)chunk;
-        dst += (uint32_t)chunk;
-        len -= chunk;
-    }
+    m3_split_move(hdr->dram_buf, hdr->psram_addr, dst, src, (uint32_t)len);
 #else
     uint8_t *b = m3MemData(rt->memory.mallocated);
-    memcpy(b + dst, b + src, len);
+    memmove(b + dst, b + src, len);
 #endif
 }
 
@@ -269,4 +338,79 @@ void wasm_mem_set(IM3Runtime rt, uint32_t offset, uint8_t val, size_t len)
 #endif
 }
 
+// ---- stdio straight into / out of linear memory (file imports) ----
+// No staging copy: fread/fwrite target the DRAM window, or a pinned PSRAM
+// cache page, or the memory itself when it is mapped. Pages that won't pin
+// bounce through one page-sized buffer. Returns the bytes transferred;
+// short on EOF or error, 0 if the range is outside linear memory.
+
+#if d_m3UsePsramMemory
+static size_t psram_stdio(uint32_t addr, size_t len, FILE *f, bool rd)
+{
+    if (IS_ADDRESS_MAPPED(addr)) {
+        uint8_t *p = (uint8_t *)(uintptr_t)addr;
+        return rd ? fread(p, 1, len, f) : fwrite(p, 1, len, f);
+    }
+    size_t done = 0;
+    while (done < len) {
+        uint32_t a = addr + (uint32_t)done;
+        uint32_t in_page = a & (PSRAM_CACHE_PAGE_SIZE - 1);
+        size_t n = PSRAM_CACHE_PAGE_SIZE - in_page;
+        if (n > len - done) n = len - done;
+
+        size_t got;
+        uint8_t *page = psram_cache_pin(a, rd);
+        if (page) {
+            got = rd ? fread(page + in_page, 1, n, f) : fwrite(page + in_page, 1, n, f);
+            psram_cache_unpin(a);
+        } else {
+            uint8_t tmp[PSRAM_CACHE_PAGE_SIZE];
+            if (rd) {
+                got = fread(tmp, 1, n, f);
+                psram_write(a, tmp, got);
+            } else {
+                psram_read(a, tmp, n);
+                got = fwrite(tmp, 1, n, f);
+            }
+        }
+        done += got;
+        if (got < n) break;
+    }
+    return done;
+}
+#endif
+
+static size_t mem_stdio(IM3Runtime rt, uint32_t offset, size_t len, FILE *f, bool rd)
+{
+    if (!wasm_mem_check(rt, offset, len)) return 0;
+#if d_m3UsePsramMemory
+    M3MemoryHeader *hdr = rt->memory.mallocated;
+    size_t done = 0;
+    if (offset < d_m3PsramDramWindow) {
+        size_t n = d_m3PsramDramWindow - offset;
+        if (n > len) n = len;
+        uint8_t *p = hdr->dram_buf + offset;
+        done = rd ? fread(p, 1, n, f) : fwrite(p, 1, n, f);
+        if (done < n) return done;
+    }
+    if (done < len)
+        done += psram_stdio(hdr->psram_addr + offset + (uint32_t)done - d_m3PsramDramWindow,
+                            len - done, f, rd);
+    return done;
+#else
+    uint8_t *p = m3MemData(rt->memory.mallocated) + offset;
+    return rd ? fread(p, 1, len, f) : fwrite(p, 1, len, f);
+#endif
+}
+
+size_t wasm_mem_fread(IM3Runtime rt, uint32_t offset, size_t len, FILE *f)
+{
+    return mem_stdio(rt, offset, len, f, true);
+}
+
+size_t wasm_mem_fwrite(IM3Runtime rt, uint32_t offset, size_t len, FILE *f)
+{
+    return mem_stdio(rt, offset, len, f, false);
+}
+
 #endif // INCLUDE_WASM
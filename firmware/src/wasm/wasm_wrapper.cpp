@@ -10,6 +10,8 @@
 #include "main.h"
 #include "basic_wrapper.h"   // get_basic_param / set_basic_param
 #include "pm.h"
+#include "led.h"
+#include "wasm_lines.h"
 #if d_m3UsePsramMemory
 #include "psram.h"
 #include "m3_psram_glue.h"
@@ -19,23 +21,47 @@
 // WASM runtime stack size (bytes inside wasm3 interpreter)
 #define WASM3_STACK_SIZE    (8 * 1024)
 
-// Yield to FreeRTOS every N wasm3 Call opcodes (~1K for responsive stop handling)
-#define WASM_YIELD_INTERVAL 1000
+// Native stack of each instance's task
+#define WASM_TASK_STACK     10240
 
-// ---------- State ----------
+// Longest a WASM program runs before giving up the CPU for a tick. wasm3
+// calls m3_Yield() every d_m3FuelQuantum loop back-edges/calls (well under
+// a millisecond of work), which also bounds how long a stop request waits.
+#define WASM_TIME_SLICE_MS  20
 
-static TaskHandle_t wasm_task_handle = NULL;
+// ---------- State ----------
+// Each slot runs one program in its own task, created when the program
+// starts and deleted when it ends. All slots share one wasm3 environment
+// (function types, released code pages), which lives while any of them
+// runs. wasm_mutex guards the slot table, the environment and the
+// preallocated memory block.
+
+struct wasm_slot {
+    TaskHandle_t    task;           // set by the task itself
+    wasm_instance  *inst;           // host-side program state, while running
+    IM3Runtime      runtime;
+    volatile bool   running;
+    volatile bool   stop_requested;
+    char            path[256];
+    uint32_t        mem_budget;     // bytes of linear memory the program may use
+    uint32_t        started_ms;
+    uint64_t        cpu_us;         // CPU time of the last finished run
+    str_pool_stats  pool;           // string pool of the last finished run
+};
+
+static wasm_slot s_slots[WASM_MAX_INSTANCES];
 static SemaphoreHandle_t wasm_mutex = NULL;
-static char next_wasm[256] = {0};
-static volatile bool wasm_running = false;
-volatile bool wasm_stop_requested = false;
-static char wasm_current_path[256] = {0};
+static SemaphoreHandle_t s_env_lock = NULL;
+static IM3Environment s_env = NULL;
+static int s_env_users = 0;
 
-// Persistent pre-allocated WASM linear memory (1 page = 64KB).
+// Persistent pre-allocated WASM linear memory (1 page = 64KB), used by
+// whichever instance starts while it is free.
 // DRAM path: allocated at boot (prevents heap fragmentation).
 // PSRAM path: lazy-allocated on first wasm_run() (PSRAM allocator doesn't fragment).
 // Both paths reuse the block across runs (zeroed, not freed).
 static const u32 PREALLOC_PAGES = 1;
+static bool s_prealloc_busy = false;
 #if d_m3UsePsramMemory
 // PSRAM path: header in DRAM, DRAM window + PSRAM for linear memory data
 static M3MemoryHeader *s_prealloc_hdr = NULL;
@@ -47,23 +73,78 @@ static M3MemoryHeader *s_prealloc_mem = NULL;
 #endif
 
 
+// wasm3 locks the shared environment around every change to it
+extern "C" void m3_LockEnvironment(IM3Environment env)
+{
+    xSemaphoreTake(s_env_lock, portMAX_DELAY);
+}
+
+extern "C" void m3_UnlockEnvironment(IM3Environment env)
+{
+    xSemaphoreGive(s_env_lock);
+}
+
+
+// ---------- CPU accounting ----------
+// FreeRTOS keeps a 32-bit run-time counter (microseconds) per task. Each
+// instance folds the increments into a 64-bit total at least once per time
+// slice, so the counter can't wrap between two samples.
+
+static uint32_t task_run_time(TaskHandle_t task)
+{
+#if configGENERATE_RUN_TIME_STATS
+    TaskStatus_t st;
+    vTaskGetInfo(task, &st, pdFALSE, eInvalid);
+    return (uint32_t)st.ulRunTimeCounter;
+#else
+    return 0;
+#endif
+}
+
+static void sample_cpu(wasm_instance *inst)
+{
+    uint32_t now = task_run_time(xTaskGetCurrentTaskHandle());
+    inst->cpu_us += (uint32_t)(now - inst->cpu_counter);
+    inst->cpu_counter = now;
+}
+
+
 // ---------- Automatic yield via m3_Yield override ----------
-// wasm3 declares m3_Yield() as M3_WEAK and calls it on every Call opcode.
-// We provide a strong definition that periodically yields to FreeRTOS and
-// checks the stop flag so runaway programs can be killed.
+// wasm3 declares m3_Yield() as M3_WEAK and calls it each time a runtime's
+// fuel runs out. We provide a strong definition that yields to FreeRTOS
+// once per time slice and checks the stop flag so runaway programs --
+// including tight loops that never call anything -- can be killed.
+// Instances run in tasks of equal priority, so giving up the CPU at the end
+// of each slice also lets the other instances have their turn.
+
+static wasm_instance *current_instance(void)
+{
+    TaskHandle_t me = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < WASM_MAX_INSTANCES; i++)
+        if (s_slots[i].task == me) return s_slots[i].inst;
+    return NULL;
+}
 
-static uint32_t yield_counter = 0;
+bool wasm_should_stop(IM3Runtime rt)
+{
+    return s_slots[wasm_inst(rt)->slot].stop_requested || get_basic_param(0) == 1;
+}
 
 extern "C" M3Result m3_Yield(void)
 {
-    if (++yield_counter >= WASM_YIELD_INTERVAL) {
-        yield_counter = 0;
+    wasm_instance *inst = current_instance();
+    if (!inst) return m3Err_none;
+
+    uint32_t now = uptime_ms();
+    if (now - inst->slice_start_ms >= WASM_TIME_SLICE_MS) {
+        sample_cpu(inst);
         vTaskDelay(pdMS_TO_TICKS(1));
         inc_thread_count(xPortGetCoreID());
+        inst->slice_start_ms = uptime_ms();
     }
 
     // Check stop request — return a trap to abort execution
-    if (wasm_stop_requested || get_basic_param(0) == 1) {
+    if (s_slots[inst->slot].stop_requested || get_basic_param(0) == 1) {
         return m3Err_trapExit;
     }
 
@@ -92,34 +173,155 @@ static M3Result link_imports(IM3Module module)
 }
 
 
-// ---------- Cleanup helper — reset host-side state, free runtime/env/buf ----------
+// ---------- Shared environment ----------
 
-static void wasm_cleanup_runtime(IM3Runtime runtime, IM3Environment env, uint8_t *wasm_buf)
+static IM3Environment acquire_env(void)
 {
-    wasm_close_all_files();
-    wasm_reset_gamma();
-    wasm_string_pool_reset();
-    low_heap_reset();
-    wasm_current_path[0] = '\0';
-    if (runtime) m3_FreeRuntime(runtime);
-    if (env)     m3_FreeEnvironment(env);
-    free(wasm_buf);
-    wasm_running = false;
+    xSemaphoreTake(wasm_mutex, portMAX_DELAY);
+    if (!s_env) s_env = m3_NewEnvironment();
+    if (s_env) s_env_users++;
+    IM3Environment env = s_env;
+    xSemaphoreGive(wasm_mutex);
+    return env;
 }
 
+// The last instance out frees the environment, with the code pages the
+// runtimes handed back to it.
+static void release_env(void)
+{
+    xSemaphoreTake(wasm_mutex, portMAX_DELAY);
+    if (s_env_users > 0 && --s_env_users == 0) {
+        m3_FreeEnvironment(s_env);
+        s_env = NULL;
+    }
+    xSemaphoreGive(wasm_mutex);
+}
 
-// ---------- Run a .wasm file ----------
 
-static void wasm_run(const char *path)
+// ---------- Preallocated memory ----------
+
+// Hand the preallocated block to `runtime` if the module fits it and no
+// other instance has it. When m3_LoadModule calls ResizeMemory(initPages),
+// it sees numPages already == initPages, so m3_Realloc(ptr, size, size)
+// returns the same pointer (no-op). The prealloc flag tells ResizeMemory to
+// clone (not realloc/free) on memory.grow, and tells Runtime_Release to skip
+// freeing this block.
+static bool take_prealloc(IM3Runtime runtime, IM3Module module)
 {
-    wasm_running = true;
-    wasm_stop_requested = false;
-    set_basic_param(0, 0);    // clear stale stop flag from previous 'stop' command
-    yield_counter = 0;
+    if (module->memoryInfo.initPages != PREALLOC_PAGES) return false;
+
+    xSemaphoreTake(wasm_mutex, portMAX_DELAY);
+    bool taken = false;
+    if (!s_prealloc_busy) {
 #if d_m3UsePsramMemory
-    m3_psram_yield_ctr = 0;
+        // Lazy-allocate on first run, reuse thereafter
+        size_t psram_bytes = PREALLOC_PAGES * d_m3MemPageSize - d_m3PsramDramWindow;
+        if (!s_prealloc_hdr) {
+            s_prealloc_hdr = (M3MemoryHeader *)calloc(1, sizeof(M3MemoryHeader));
+            s_prealloc_dram = (uint8_t *)malloc(d_m3PsramDramWindow);
+            s_prealloc_psram = psram_malloc(psram_bytes);
+        }
+        if (s_prealloc_hdr && s_prealloc_dram && s_prealloc_psram) {
+            memset(s_prealloc_dram, 0, d_m3PsramDramWindow);
+            psram_memset(s_prealloc_psram, 0, psram_bytes);
+            s_prealloc_hdr->dram_buf = s_prealloc_dram;
+            s_prealloc_hdr->psram_addr = s_prealloc_psram;
+            s_prealloc_hdr->length = PREALLOC_PAGES * d_m3MemPageSize;
+            s_prealloc_hdr->runtime = runtime;
+            s_prealloc_hdr->prealloc = true;
+            runtime->memory.mallocated = s_prealloc_hdr;
+            runtime->memory.numPages = PREALLOC_PAGES;
+            taken = true;
+        }
+#else
+        if (s_prealloc_mem) {
+            // Zero the data portion (header stays intact from initial calloc)
+            memset((uint8_t *)s_prealloc_mem + sizeof(M3MemoryHeader), 0,
+                   PREALLOC_PAGES * d_m3MemPageSize);
+            s_prealloc_mem->runtime = runtime;
+            s_prealloc_mem->prealloc = true;
+            runtime->memory.mallocated = s_prealloc_mem;
+            runtime->memory.numPages = PREALLOC_PAGES;
+            taken = true;
+        }
 #endif
-    strlcpy(wasm_current_path, path, sizeof(wasm_current_path));
+        s_prealloc_busy = taken;
+    }
+    xSemaphoreGive(wasm_mutex);
+    return taken;
+}
+
+static void give_prealloc(void)
+{
+    xSemaphoreTake(wasm_mutex, portMAX_DELAY);
+    s_prealloc_busy = false;
+    xSemaphoreGive(wasm_mutex);
+}
+
+
+// ---------- Cleanup helper — reset host-side state, free runtime/buf ----------
+
+static void wasm_cleanup_runtime(wasm_slot *slot, IM3Runtime runtime, bool prealloc, uint8_t *wasm_buf)
+{
+    wasm_instance *inst = slot->inst;
+    wasm_close_all_files(inst);
+    wasm_reset_gamma(inst);
+    wasm_string_pool_free(inst);
+    low_heap_reset(inst);
+    sample_cpu(inst);
+
+    xSemaphoreTake(wasm_mutex, portMAX_DELAY);
+    slot->cpu_us  = inst->cpu_us;
+    slot->pool    = inst->pool.st;
+    slot->inst    = NULL;
+    slot->runtime = NULL;
+    xSemaphoreGive(wasm_mutex);
+
+    // prealloc flag in M3MemoryHeader tells Runtime_Release to skip freeing
+    if (runtime)  m3_FreeRuntime(runtime);
+    if (prealloc) give_prealloc();
+    release_env();
+    free(wasm_buf);
+    free(inst);
+}
+
+
+// ---------- Run a .wasm file ----------
+
+static void wasm_run(wasm_slot *slot)
+{
+    const char *path = slot->path;
+
+    // Clear a stale stop flag from a previous 'stop' command, unless another
+    // slot still runs without a stop request of its own -- the flag (param 0,
+    // which a program can also set) may be what is meant to stop it.
+    xSemaphoreTake(wasm_mutex, portMAX_DELAY);
+    bool flag_in_use = false;
+    for (int i = 0; i < WASM_MAX_INSTANCES; i++)
+        if (&s_slots[i] != slot && s_slots[i].running && !s_slots[i].stop_requested)
+            flag_in_use = true;
+    if (!flag_in_use) set_basic_param(0, 0);
+    xSemaphoreGive(wasm_mutex);
+
+    wasm_instance *inst = (wasm_instance *)calloc(1, sizeof(wasm_instance));
+    if (!inst) {
+        printfnl(SOURCE_WASM, "wasm: instance alloc failed\n");
+        return;
+    }
+    inst->slot = (int)(slot - s_slots);
+    inst->slice_start_ms = uptime_ms();
+    inst->cpu_counter = task_run_time(xTaskGetCurrentTaskHandle());
+    low_heap_init(inst, 0);
+
+    IM3Environment env = acquire_env();
+    xSemaphoreTake(wasm_mutex, portMAX_DELAY);
+    slot->inst = inst;
+    xSemaphoreGive(wasm_mutex);
+    if (!env) {
+        printfnl(SOURCE_WASM, "wasm: env alloc failed\n");
+        wasm_cleanup_runtime(slot, NULL, false, NULL);
+        return;
+    }
 
     // Load file from LittleFS
     char fpath[256];
@@ -127,7 +329,7 @@ static void wasm_run(const char *path)
     FILE *f = fopen(fpath, "r");
     if (!f) {
         printfnl(SOURCE_WASM, "wasm: cannot open %s\n", path);
-        wasm_running = false;
+        wasm_cleanup_runtime(slot, NULL, false, NULL);
         return;
     }
 
@@ -135,7 +337,7 @@ static void wasm_run(const char *path)
     if (wasm_size == 0) {
         printfnl(SOURCE_WASM, "wasm: %s is empty\n", path);
         fclose(f);
-        wasm_running = false;
+        wasm_cleanup_runtime(slot, NULL, false, NULL);
         return;
     }
 
@@ -144,7 +346,7 @@ static void wasm_run(const char *path)
     if (!wasm_buf) {
         printfnl(SOURCE_WASM, "wasm: alloc failed (%u bytes)\n", (unsigned)wasm_size);
         fclose(f);
-        wasm_running = false;
+        wasm_cleanup_runtime(slot, NULL, false, NULL);
         return;
     }
 
@@ -153,77 +355,48 @@ static void wasm_run(const char *path)
 
     if (bytes_read != wasm_size) {
         printfnl(SOURCE_WASM, "wasm: read error (%u/%u)\n", (unsigned)bytes_read, (unsigned)wasm_size);
-        free(wasm_buf);
-        wasm_running = false;
+        wasm_cleanup_runtime(slot, NULL, false, wasm_buf);
         return;
     }
 
-    // Create wasm3 environment and runtime
-    IM3Environment env = m3_NewEnvironment();
-    if (!env) {
-        printfnl(SOURCE_WASM, "wasm: env alloc failed\n");
-        free(wasm_buf);
-        wasm_running = false;
-        return;
-    }
-
-    IM3Runtime runtime = m3_NewRuntime(env, WASM3_STACK_SIZE, NULL);
+    // Create the runtime; imports find this instance through its userdata
+    IM3Runtime runtime = m3_NewRuntime(env, WASM3_STACK_SIZE, inst);
     if (!runtime) {
         printfnl(SOURCE_WASM, "wasm: runtime alloc failed\n");
-        m3_FreeEnvironment(env);
-        free(wasm_buf);
-        wasm_running = false;
+        wasm_cleanup_runtime(slot, NULL, false, wasm_buf);
         return;
     }
 
+    // Release builds (--release) replace the __line stores with a line
+    // table. Only then is it worth having wasm3 map its compiled code back
+    // to module offsets (8 bytes per code line) so a trap can be looked up.
+    wasm_lines lines;
+    if (wasm_lines_find(&lines, wasm_buf, wasm_size)) {
+#if d_m3RecordBacktraces
+        runtime->mapCode = true;
+#endif
+    }
+
     // Parse module
     IM3Module module = NULL;
     M3Result result = m3_ParseModule(env, &module, wasm_buf, wasm_size);
     if (result) {
         printfnl(SOURCE_WASM, "wasm: parse error: %s\n", result);
-        m3_FreeRuntime(runtime);
-        m3_FreeEnvironment(env);
-        free(wasm_buf);
-        wasm_running = false;
+        wasm_cleanup_runtime(slot, runtime, false, wasm_buf);
         return;
     }
 
-    // Inject persistent pre-allocated linear memory into the runtime.  When
-    // m3_LoadModule calls ResizeMemory(initPages), it sees numPages already ==
-    // initPages, so m3_Realloc(ptr, size, size) returns the same pointer (no-op).
-    // The prealloc flag tells ResizeMemory to clone (not realloc/free) on memory.grow,
-    // and tells Runtime_Release to skip freeing this block.
-#if d_m3UsePsramMemory
-    if (module->memoryInfo.initPages == PREALLOC_PAGES) {
-        // Lazy-allocate on first run, reuse thereafter
-        size_t psram_bytes = PREALLOC_PAGES * d_m3MemPageSize - d_m3PsramDramWindow;
-        if (!s_prealloc_hdr) {
-            s_prealloc_hdr = (M3MemoryHeader *)calloc(1, sizeof(M3MemoryHeader));
-            s_prealloc_dram = (uint8_t *)malloc(d_m3PsramDramWindow);
-            s_prealloc_psram = psram_malloc(psram_bytes);
-        }
-        if (s_prealloc_hdr && s_prealloc_dram && s_prealloc_psram) {
-            memset(s_prealloc_dram, 0, d_m3PsramDramWindow);
-            psram_memset(s_prealloc_psram, 0, psram_bytes);
-            s_prealloc_hdr->dram_buf = s_prealloc_dram;
-            s_prealloc_hdr->psram_addr = s_prealloc_psram;
-            s_prealloc_hdr->length = PREALLOC_PAGES * d_m3MemPageSize;
-            s_prealloc_hdr->runtime = runtime;
-            s_prealloc_hdr->prealloc = true;
-            runtime->memory.mallocated = s_prealloc_hdr;
-            runtime->memory.numPages = PREALLOC_PAGES;
-        }
-    }
-#else
-    if (s_prealloc_mem && module->memoryInfo.initPages == PREALLOC_PAGES) {
-        // Zero the data portion (header stays intact from initial calloc)
-        memset((uint8_t *)s_prealloc_mem + sizeof(M3MemoryHeader), 0,
-               PREALLOC_PAGES * d_m3MemPageSize);
-        s_prealloc_mem->prealloc = true;
-        runtime->memory.mallocated = s_prealloc_mem;
-        runtime->memory.numPages = PREALLOC_PAGES;
+    // Memory budget: the initial size must fit, and memory.grow fails past it
+    u32 budget_pages = slot->mem_budget / d_m3MemPageSize;
+    if (module->memoryInfo.initPages > budget_pages) {
+        printfnl(SOURCE_WASM, "wasm: module wants %uKB, budget is %uKB\n",
+                 (unsigned)(module->memoryInfo.initPages * 64), (unsigned)(slot->mem_budget / 1024));
+        m3_FreeModule(module);
+        wasm_cleanup_runtime(slot, runtime, false, wasm_buf);
+        return;
     }
-#endif
+
+    bool prealloc = take_prealloc(runtime, module);
 
     // Load module into runtime (runtime takes ownership)
     result = m3_LoadModule(runtime, module);
@@ -232,27 +405,26 @@ static void wasm_run(const char *path)
         printfnl(SOURCE_WASM, "wasm: load error: %s (module wants %u pages = %uKB)\n",
                  result, pages, (unsigned)(pages * 64));
         m3_FreeModule(module);
-        // prealloc flag in header tells Runtime_Release to skip freeing
-        m3_FreeRuntime(runtime);
-        m3_FreeEnvironment(env);
-        free(wasm_buf);
-        wasm_running = false;
+        wasm_cleanup_runtime(slot, runtime, prealloc, wasm_buf);
         return;
     }
+    if (runtime->memory.maxPages > budget_pages)
+        runtime->memory.maxPages = budget_pages;
+
+    xSemaphoreTake(wasm_mutex, portMAX_DELAY);
+    slot->runtime = runtime;
+    xSemaphoreGive(wasm_mutex);
 
     // Link host imports
     result = link_imports(module);
     if (result) {
         printfnl(SOURCE_WASM, "wasm: link error: %s\n", result);
-        // prealloc flag in header tells Runtime_Release to skip freeing
-        m3_FreeRuntime(runtime);
-        m3_FreeEnvironment(env);
-        free(wasm_buf);
-        wasm_running = false;
+        wasm_cleanup_runtime(slot, runtime, prealloc, wasm_buf);
         return;
     }
 
-    // Look up __line global (exported by bas2wasm-compiled programs)
+    // Look up __line global (exported by bas2wasm/c2wasm programs; never
+    // stored to in release builds)
     IM3Global g_line = m3_FindGlobal(module, "__line");
 
     // Look up _heap_ptr global — initialize low-heap allocator for DIM arrays
@@ -260,12 +432,10 @@ static void wasm_run(const char *path)
     if (g_heap) {
         M3TaggedValue val;
         if (m3_GetGlobal(g_heap, &val) == m3Err_none)
-            low_heap_init((uint32_t)val.value.i32);
-        else
-            low_heap_init(0);
-    } else {
-        low_heap_init(0);  // old binary — low heap disabled, all goes to string pool
+            low_heap_init(inst, (uint32_t)val.value.i32);
     }
+    // else: old binary — low heap disabled, all goes to string pool
+    wasm_string_pool_init(runtime);
 
     // Try to find and call setup() then loop(), or fall back to _start() / main()
     IM3Function func_setup = NULL;
@@ -283,16 +453,18 @@ static void wasm_run(const char *path)
 
     if (!func_setup && !func_loop && !func_start) {
         printfnl(SOURCE_WASM, "wasm: no entry point (setup/loop/_start/main)\n");
-        // prealloc flag in header tells Runtime_Release to skip freeing
-        m3_FreeRuntime(runtime);
-        m3_FreeEnvironment(env);
-        free(wasm_buf);
-        wasm_running = false;
+        wasm_cleanup_runtime(slot, runtime, prealloc, wasm_buf);
         return;
     }
 
-    // Helper: read current BASIC line from __line global (0 if unavailable)
+    // Helper: source line of the last error -- the trap's offset looked up
+    // in the line table, else the __line global (0 if unavailable)
     auto get_basic_line = [&]() -> int {
+        IM3BacktraceInfo bt = lines.ents ? m3_GetBacktrace(runtime) : NULL;
+        if (bt && bt->frames) {
+            int ln = wasm_lines_lookup(&lines, bt->frames->moduleOffset);
+            if (ln) return ln;
+        }
         if (!g_line) return 0;
         M3TaggedValue val;
         if (m3_GetGlobal(g_line, &val) == m3Err_none)
@@ -300,7 +472,7 @@ static void wasm_run(const char *path)
         return 0;
     };
 
-    printfnl(SOURCE_WASM, "wasm: running %s on Core:%d\n", path, xPortGetCoreID());
+    printfnl(SOURCE_WASM, "wasm: running %s in slot %d on Core:%d\n", path, inst->slot, xPortGetCoreID());
     pm_cpu_lock();
 
     // Run start section if present
@@ -308,7 +480,7 @@ static void wasm_run(const char *path)
     if (result) {
         printfnl(SOURCE_WASM, "wasm: start section error: %s\n", result);
         pm_cpu_unlock();
-        wasm_cleanup_runtime(runtime, env, wasm_buf);
+        wasm_cleanup_runtime(slot, runtime, prealloc, wasm_buf);
         return;
     }
 
@@ -320,7 +492,7 @@ static void wasm_run(const char *path)
             if (ln) printfnl(SOURCE_WASM, "wasm: setup() error: %s (BASIC line %d)\n", result, ln);
             else    printfnl(SOURCE_WASM, "wasm: setup() error: %s\n", result);
         } else {
-            while (!wasm_stop_requested && get_basic_param(0) != 1) {
+            while (!wasm_should_stop(runtime)) {
                 result = m3_CallV(func_loop);
                 if (result) {
                     int ln = get_basic_line();
@@ -345,7 +517,7 @@ static void wasm_run(const char *path)
         }
     } else if (func_loop) {
         // loop() only, no setup()
-        while (!wasm_stop_requested && get_basic_param(0) != 1) {
+        while (!wasm_should_stop(runtime)) {
             result = m3_CallV(func_loop);
             if (result) {
                 int ln = get_basic_line();
@@ -368,10 +540,15 @@ static void wasm_run(const char *path)
 
     pm_cpu_unlock();
 
-    // Cleanup — prealloc flag in M3MemoryHeader tells Runtime_Release to skip freeing
-    wasm_cleanup_runtime(runtime, env, wasm_buf);
+    bool stopped = slot->stop_requested;
+    int slot_no = inst->slot;
+    wasm_cleanup_runtime(slot, runtime, prealloc, wasm_buf);
 
-    if (wasm_stop_requested) {
+    if (stopped) {
+        // A stopped program's last frame shouldn't stay over the layers below;
+        // one that ran to completion keeps showing it. Each slot has its own
+        // layer, so the other programs' frames stay up.
+        led_src_release(LED_SRC_WASM + slot_no);
         printfnl(SOURCE_WASM, "wasm: stopped\n");
     } else {
         printfnl(SOURCE_WASM, "wasm: DONE\n");
@@ -379,28 +556,20 @@ static void wasm_run(const char *path)
 }
 
 
-// ---------- FreeRTOS task ----------
+// ---------- FreeRTOS task (one per running instance) ----------
 
 static void wasm_task_fun(void *parameter)
 {
-    for (;;) {
-        vTaskDelay(pdMS_TO_TICKS(5));
-        inc_thread_count(xPortGetCoreID());
+    wasm_slot *slot = (wasm_slot *)parameter;
+    slot->task = xTaskGetCurrentTaskHandle();
 
-        if (xSemaphoreTake(wasm_mutex, portMAX_DELAY) == pdTRUE) {
-            if (next_wasm[0] != 0) {
-                char local_path[256];
-                strncpy(local_path, next_wasm, sizeof(local_path));
-                local_path[sizeof(local_path) - 1] = '\0';
-                next_wasm[0] = 0;
-                xSemaphoreGive(wasm_mutex);
-
-                wasm_run(local_path);
-            } else {
-                xSemaphoreGive(wasm_mutex);
-            }
-        }
-    }
+    wasm_run(slot);
+
+    xSemaphoreTake(wasm_mutex, portMAX_DELAY);
+    slot->task = NULL;
+    slot->running = false;
+    xSemaphoreGive(wasm_mutex);
+    vTaskDelete(NULL);
 }
 
 
@@ -409,6 +578,7 @@ static void wasm_task_fun(void *parameter)
 void setup_wasm()
 {
     wasm_mutex = xSemaphoreCreateMutex();
+    s_env_lock = xSemaphoreCreateMutex();
 
     // DRAM prealloc at boot — prevents heap fragmentation from 64KB contiguous block.
     // PSRAM prealloc is lazy (allocated on first wasm_run) since PSRAM doesn't fragment.
@@ -416,48 +586,104 @@ void setup_wasm()
     size_t prealloc_bytes = PREALLOC_PAGES * d_m3MemPageSize + sizeof(M3MemoryHeader);
     s_prealloc_mem = (M3MemoryHeader *)calloc(1, prealloc_bytes);
 #endif
-
-    xTaskCreatePinnedToCore(wasm_task_fun, "WasmTask", 10240, NULL, 1, &wasm_task_handle, tskNO_AFFINITY);
 }
 
-bool set_wasm_program(const char *path)
+bool wasm_start(int n, const char *path, int mem_kb)
 {
-    // Stop the currently running program and wait for it to finish
-    if (wasm_running) {
-        wasm_stop_requested = true;
-        set_basic_param(0, 1);
-        // Clear any previously queued path so it doesn't start between stop and new queue
-        if (xSemaphoreTake(wasm_mutex, 1000) == pdTRUE) {
-            next_wasm[0] = 0;
-            xSemaphoreGive(wasm_mutex);
-        }
-        while (wasm_running) {
+    if (n < 0 || n >= WASM_MAX_INSTANCES || !wasm_mutex) return false;
+    wasm_slot *slot = &s_slots[n];
+
+    // Stop the program running in this slot and wait for it to finish
+    if (slot->running) {
+        slot->stop_requested = true;
+        while (slot->running) {
             vTaskDelay(pdMS_TO_TICKS(5));
         }
     }
 
-    if (xSemaphoreTake(wasm_mutex, 1000) == pdTRUE) {
-        strncpy(next_wasm, path, sizeof(next_wasm) - 1);
-        next_wasm[sizeof(next_wasm) - 1] = '\0';
-        xSemaphoreGive(wasm_mutex);
-        return true;
+    if (xSemaphoreTake(wasm_mutex, 1000) != pdTRUE) return false;
+    strlcpy(slot->path, path, sizeof(slot->path));
+    slot->mem_budget = (uint32_t)(mem_kb > 0 ? mem_kb : WASM_DEFAULT_MEM_KB) * 1024;
+    slot->stop_requested = false;
+    slot->started_ms = uptime_ms();
+    slot->cpu_us = 0;
+    memset(&slot->pool, 0, sizeof(slot->pool));
+    slot->running = true;
+
+    char name[16];
+    snprintf(name, sizeof(name), "WasmTask%d", n);
+    BaseType_t ok = xTaskCreatePinnedToCore(wasm_task_fun, name, WASM_TASK_STACK, slot, 1, NULL, tskNO_AFFINITY);
+    if (ok != pdPASS) slot->running = false;
+    xSemaphoreGive(wasm_mutex);
+
+    if (ok != pdPASS) {
+        printfnl(SOURCE_WASM, "wasm: cannot start task for slot %d\n", n);
+        return false;
     }
-    return false;
+    return true;
+}
+
+bool set_wasm_program(const char *path)
+{
+    return wasm_start(0, path, 0);
+}
+
+void wasm_stop(int n)
+{
+    if (n >= 0 && n < WASM_MAX_INSTANCES && s_slots[n].running)
+        s_slots[n].stop_requested = true;
 }
 
 bool wasm_is_running(void)
 {
-    return wasm_running;
+    for (int i = 0; i < WASM_MAX_INSTANCES; i++)
+        if (s_slots[i].running) return true;
+    return false;
 }
 
 void wasm_request_stop(void)
 {
-    wasm_stop_requested = true;
+    for (int i = 0; i < WASM_MAX_INSTANCES; i++)
+        wasm_stop(i);
 }
 
 const char *wasm_get_current_path(void)
 {
-    return wasm_current_path;
+    for (int i = 0; i < WASM_MAX_INSTANCES; i++)
+        if (s_slots[i].running) return s_slots[i].path;
+    return NULL;
+}
+
+bool wasm_get_status(int n, wasm_status *st)
+{
+    memset(st, 0, sizeof(*st));
+    if (n < 0 || n >= WASM_MAX_INSTANCES || !wasm_mutex) return false;
+    wasm_slot *slot = &s_slots[n];
+
+    xSemaphoreTake(wasm_mutex, portMAX_DELAY);
+    st->running    = slot->running;
+    st->mem_budget = slot->mem_budget;
+    st->cpu_us     = slot->cpu_us;
+    const str_pool_stats *pool = &slot->pool;
+    strlcpy(st->path, slot->path, sizeof(st->path));
+    if (slot->running) {
+        st->run_ms = uptime_ms() - slot->started_ms;
+        if (slot->inst && slot->task) {
+            wasm_instance *inst = slot->inst;
+            st->cpu_us = inst->cpu_us + (uint32_t)(task_run_time(slot->task) - inst->cpu_counter);
+        }
+        if (slot->runtime)
+            st->mem_bytes = slot->runtime->memory.numPages * d_m3MemPageSize;
+        if (slot->inst) pool = &slot->inst->pool.st;
+    }
+    st->pool_size        = pool->size;
+    st->pool_used        = pool->used;
+    st->pool_peak        = pool->peak;
+    st->pool_blocks      = pool->blocks;
+    st->pool_free_listed = pool->free_listed;
+    st->pool_fails       = pool->fails;
+    xSemaphoreGive(wasm_mutex);
+    return true;
 }
 
 #endif // INCLUDE_WASM
@@ -4,10 +4,46 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// Programs run side by side in numbered slots (one per LED channel plus a
+// background script, say), each in its own task and wasm3 runtime.
+#define WASM_MAX_INSTANCES  4
+
+// Linear memory an instance may use unless given a budget
+#if d_m3UsePsramMemory
+#define WASM_DEFAULT_MEM_KB 256
+#else
+#define WASM_DEFAULT_MEM_KB 64
+#endif
+
+struct wasm_status {
+    bool     running;
+    char     path[64];          // program (the last one, if not running)
+    uint32_t run_ms;            // time since it started
+    uint64_t cpu_us;            // CPU time used (by the last run, if not running)
+    uint32_t mem_bytes;         // linear memory in use
+    uint32_t mem_budget;        // ...and allowed
+    // String pool (by the last run, if not running)
+    uint32_t pool_size;
+    uint32_t pool_used;         // bytes in live blocks
+    uint32_t pool_peak;         // high-water mark of pool_used
+    uint32_t pool_blocks;       // live blocks
+    uint32_t pool_free_listed;  // free bytes held by size classes (fragmentation)
+    uint32_t pool_fails;        // allocations refused
+};
+
 void setup_wasm();
+
+// Start `path` in slot n (0..WASM_MAX_INSTANCES-1), stopping what runs
+// there first. mem_kb <= 0 means WASM_DEFAULT_MEM_KB.
+bool wasm_start(int n, const char *path, int mem_kb);
+void wasm_stop(int n);
+bool wasm_get_status(int n, wasm_status *st);
+
+// Slot 0 (what "run" and the startup script use)
 bool set_wasm_program(const char *path);
-bool wasm_is_running(void);
-void wasm_request_stop(void);
-const char *wasm_get_current_path(void);
+
+bool wasm_is_running(void);                 // any slot
+void wasm_request_stop(void);               // all slots
+const char *wasm_get_current_path(void);    // first running slot, NULL if none
 
 #endif
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""Generate the ArtNet captures used by test_artnet_rx.
+
+Each pixel of universe U in frame F is (F, U, 0x5A), so the test can tell
+which controller frame every part of a committed LED frame came from.
+Timestamps follow a 44 Hz controller sending its universes back to back.
+
+    artnet_2uni.pcap   300 pixels over universes 0-1, no ArtSync, with a
+                       reordered frame, a lost packet, a duplicate and a
+                       late packet
+    artnet_sync.pcap   400 pixels over universes 4-6, ArtSync after each
+                       frame
+
+Run from this directory; the output is committed.
+"""
+
+import struct
+
+FRAME_US = 22727        # 44 Hz
+GAP_US   = 300          # between universes of one frame
+
+
+def artdmx(universe, seq, data):
+    return (b"Art-Net\0" + struct.pack("<H", 0x5000) + struct.pack(">H", 14) +
+            bytes([seq, 0]) + struct.pack("<H", universe) +
+            struct.pack(">H", len(data)) + data)
+
+
+def artsync():
+    return b"Art-Net\0" + struct.pack("<H", 0x5200) + struct.pack(">H", 14) + b"\0\0"
+
+
+def udp_frame(payload, sport=6454, dport=6454):
+    udp = struct.pack(">HHHH", sport, dport, 8 + len(payload), 0) + payload
+    ip = struct.pack(">BBHHHBBH4s4s", 0x45, 0, 20 + len(udp), 0, 0x4000, 64, 17, 0,
+                     bytes([10, 0, 0, 1]), bytes([10, 0, 0, 255]))
+    eth = b"\xff" * 6 + b"\x02\x00\x00\x00\x00\x01" + b"\x08\x00"
+    return eth + ip + udp
+
+
+def write_pcap(path, packets, port=6454):
+    with open(path, "wb") as f:
+        f.write(struct.pack("<IHHiIII", 0xA1B2C3D4, 2, 4, 0, 0, 65535, 1))
+        for t_us, payload in packets:
+            pkt = udp_frame(payload, port, port)
+            f.write(struct.pack("<IIII", t_us // 1000000, t_us % 1000000, len(pkt), len(pkt)))
+            f.write(pkt)
+
+
+def pixels(frame, universe, n):
+    return bytes([frame & 0xFF, universe, 0x5A]) * n
+
+
+def seq_of(frame):
+    return (frame % 255) + 1     # 1..255, never 0
+
+
+def two_universes():
+    out = []
+    t0 = 1000000
+    for f in range(40):
+        t = t0 + f * FRAME_US
+        a = (0, seq_of(f), pixels(f, 0, 170))
+        b = (1, seq_of(f), pixels(f, 1, 130))
+        if f == 10:                      # reordered within the frame
+            order = [b, a]
+        elif f == 15:                    # universe 0 lost
+            order = [b]
+        elif f == 24:                    # universe 0 delayed into frame 25
+            order = [b]
+        elif f == 25:
+            order = [a, (0, seq_of(24), pixels(24, 0, 170)), b]
+        elif f == 20:                    # universe 1 duplicated
+            order = [a, b, b]
+        else:
+            order = [a, b]
+        for i, (u, s, d) in enumerate(order):
+            out.append((t + i * GAP_US, artdmx(u, s, d)))
+    return out
+
+
+def synced():
+    out = []
+    t0 = 1000000
+    for f in range(20):
+        t = t0 + f * FRAME_US
+        for i, u in enumerate((4, 5, 6)):
+            out.append((t + i * GAP_US, artdmx(u, seq_of(f), pixels(f, u, 170))))
+        out.append((t + 3 * GAP_US, artsync()))
+    return out
+
+
+if __name__ == "__main__":
+    write_pcap("artnet_2uni.pcap", two_universes())
+    write_pcap("artnet_sync.pcap", synced())
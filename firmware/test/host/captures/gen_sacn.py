@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""Generate the sACN (E1.31) captures used by test_sacn_rx.
+
+Each pixel of universe U in frame F from source S is (F, U, S), so the
+test can tell which controller frame and which source every part of a
+committed LED frame came from. Timestamps follow 44 Hz senders.
+
+    sacn_sources.pcap  200 pixels over universes 1-2 from three sources:
+                       A (priority 100) throughout, C (100) throughout,
+                       B (150) for frames 10-24, then stream-terminated;
+                       a preview-only source; one of A's packets late
+    sacn_sync.pcap     340 pixels over universes 10-11 with universe sync
+                       on 7000 for 20 frames, a sync for another universe,
+                       then 10 frames without sync
+
+Run from this directory; the output is committed.
+"""
+
+import struct
+from gen_artnet import FRAME_US, GAP_US, write_pcap
+
+PREVIEW    = 0x80
+TERMINATED = 0x40
+
+
+def cid(n):
+    return bytes([0xC0, 0x7E, n]) + bytes(13)
+
+
+def root(vector, cid_, body):
+    pdu_len = 22 + len(body)          # flags/length through the end
+    return (struct.pack(">HH", 0x0010, 0) + b"ASC-E1.17\0\0\0" +
+            struct.pack(">HI", 0x7000 | pdu_len, vector) + cid_ + body)
+
+
+def data(src, universe, seq, slots, priority=100, sync=0, options=0):
+    dmp = struct.pack(">HBBHHH", 0x7000 | (10 + 1 + len(slots)), 0x02, 0xA1, 0, 1,
+                      1 + len(slots)) + b"\0" + slots
+    name = ("source %d" % src).encode().ljust(64, b"\0")
+    frame = (struct.pack(">HI", 0x7000 | (77 + len(dmp)), 2) + name +
+             struct.pack(">BHBBH", priority, sync, seq & 0xFF, options, universe) + dmp)
+    return root(4, cid(src), frame)
+
+
+def sync_pkt(src, seq, address):
+    frame = struct.pack(">HIBHH", 0x7000 | 11, 1, seq & 0xFF, address, 0)
+    return root(8, cid(src), frame)
+
+
+def pixels(frame, universe, src, n):
+    return bytes([frame & 0xFF, universe, src]) * n
+
+
+def sources():
+    A, B, C, D = 1, 2, 3, 4
+    seq = {}                              # per source and universe
+    out = []
+    t0 = 1000000
+
+    def next_seq(src, u):
+        seq[src, u] = seq.get((src, u), 0) + 1
+        return seq[src, u]
+
+    def send(t, src, u, f, **kw):
+        out.append((t, data(src, u, next_seq(src, u), pixels(f, u, src, 170 if u == 1 else 30), **kw)))
+
+    for f in range(40):
+        t = t0 + f * FRAME_US
+        slot = 0
+        for u in (1, 2):
+            if f == 33 and u == 1:
+                # A's universe 1 of frame 32 arrives after frame 33's
+                s = next_seq(A, 1)
+                out.append((t + slot * GAP_US, data(A, 1, s, pixels(33, 1, A, 170))))
+                slot += 1
+                out.append((t + slot * GAP_US, data(A, 1, s - 1, pixels(32, 1, A, 170))))
+            else:
+                send(t + slot * GAP_US, A, u, f)
+            slot += 1
+        for u in (1, 2):
+            send(t + slot * GAP_US, C, u, f)
+            slot += 1
+        if 10 <= f < 25:
+            for u in (1, 2):
+                send(t + slot * GAP_US, B, u, f, priority=150)
+                slot += 1
+        if f == 25:
+            for u in (1, 2):
+                send(t + slot * GAP_US, B, u, f, priority=150, options=TERMINATED)
+                slot += 1
+        out.append((t + slot * GAP_US, data(D, 1, next_seq(D, 1), pixels(f, 1, D, 4),
+                                            priority=200, options=PREVIEW)))
+    return out
+
+
+def synced():
+    S = 5
+    out = []
+    t0 = 1000000
+    for f in range(30):
+        t = t0 + f * FRAME_US
+        sync = 7000 if f < 20 else 0
+        for i, u in enumerate((10, 11)):
+            out.append((t + i * GAP_US, data(S, u, f + 1, pixels(f, u, S, 170), sync=sync)))
+        if f < 20:
+            out.append((t + 2 * GAP_US, sync_pkt(S, f, 7000)))
+            if f == 5:
+                out.append((t + 3 * GAP_US, sync_pkt(S, f, 7001)))
+    return out
+
+
+if __name__ == "__main__":
+    write_pcap("sacn_sources.pcap", sources(), port=5568)
+    write_pcap("sacn_sync.pcap", synced(), port=5568)
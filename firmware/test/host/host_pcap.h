@@ -0,0 +1,109 @@
+// Minimal pcap reader for the host tests: walks a classic (libpcap) capture
+// of Ethernet frames and hands back the UDP payloads with their timestamps.
+// Enough for captures recorded with tcpdump/Wireshark on a lighting network
+// and for the synthetic ones generated under captures/.
+
+#ifndef HOST_PCAP_H
+#define HOST_PCAP_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct host_pcap_pkt {
+    uint64_t       ts_us;       // capture timestamp
+    uint16_t       dport;       // UDP destination port
+    const uint8_t *data;        // UDP payload
+    size_t         len;
+};
+
+struct host_pcap {
+    uint8_t *buf;
+    size_t   size;
+    size_t   pos;
+    bool     swap;              // file written on the other endianness
+    bool     nsec;              // nanosecond timestamps
+};
+
+static inline uint32_t host_pcap_u32(const host_pcap *p, const uint8_t *b)
+{
+    uint32_t v;
+    memcpy(&v, b, 4);
+    return p->swap ? __builtin_bswap32(v) : v;
+}
+
+// Load the whole file. Returns false (and prints why) if it is missing or
+// not an Ethernet pcap.
+static inline bool host_pcap_open(host_pcap *p, const char *path)
+{
+    memset(p, 0, sizeof(*p));
+    FILE *f = fopen(path, "rb");
+    if (!f) { printf("        %s: cannot open\n", path); return false; }
+    fseek(f, 0, SEEK_END);
+    long sz = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    p->buf = (uint8_t *)malloc(sz > 0 ? (size_t)sz : 1);
+    p->size = (sz > 0 && fread(p->buf, 1, (size_t)sz, f) == (size_t)sz) ? (size_t)sz : 0;
+    fclose(f);
+
+    uint32_t magic;
+    if (p->size < 24) { printf("        %s: truncated\n", path); return false; }
+    memcpy(&magic, p->buf, 4);
+    if      (magic == 0xA1B2C3D4u) { p->swap = false; p->nsec = false; }
+    else if (magic == 0xD4C3B2A1u) { p->swap = true;  p->nsec = false; }
+    else if (magic == 0xA1B23C4Du) { p->swap = false; p->nsec = true; }
+    else if (magic == 0x4D3CB2A1u) { p->swap = true;  p->nsec = true; }
+    else { printf("        %s: not a pcap file\n", path); return false; }
+    if (host_pcap_u32(p, p->buf + 20) != 1) {
+        printf("        %s: link type is not Ethernet\n", path);
+        return false;
+    }
+    p->pos = 24;
+    return true;
+}
+
+static inline void host_pcap_close(host_pcap *p)
+{
+    free(p->buf);
+    p->buf = nullptr;
+}
+
+// Next IPv4 UDP packet (optionally 802.1Q tagged); other frames are
+// skipped. Returns false at the end of the capture.
+static inline bool host_pcap_next(host_pcap *p, host_pcap_pkt *out)
+{
+    while (p->pos + 16 <= p->size) {
+        const uint8_t *h = p->buf + p->pos;
+        uint32_t sec = host_pcap_u32(p, h), frac = host_pcap_u32(p, h + 4);
+        uint32_t caplen = host_pcap_u32(p, h + 8);
+        const uint8_t *f = h + 16;
+        p->pos += 16 + (size_t)caplen;
+        if (p->pos > p->size) return false;
+
+        size_t off = 12;
+        if (caplen < off + 2) continue;
+        uint16_t type = (uint16_t)((f[off] << 8) | f[off + 1]);
+        if (type == 0x8100 && caplen >= off + 6) {
+            off += 4;
+            type = (uint16_t)((f[off] << 8) | f[off + 1]);
+        }
+        off += 2;
+        if (type != 0x0800 || caplen < off + 20) continue;
+        const uint8_t *ip = f + off;
+        size_t ihl = (size_t)(ip[0] & 0x0F) * 4;
+        if ((ip[0] >> 4) != 4 || ip[9] != 17 || caplen < off + ihl + 8) continue;
+        const uint8_t *udp = ip + ihl;
+        size_t ulen = (size_t)((udp[4] << 8) | udp[5]);
+        if (ulen < 8 || caplen < off + ihl + ulen) continue;
+
+        out->ts_us = (uint64_t)sec * 1000000u + (p->nsec ? frac / 1000u : frac);
+        out->dport = (uint16_t)((udp[2] << 8) | udp[3]);
+        out->data  = udp + 8;
+        out->len   = ulen - 8;
+        return true;
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,40 @@
+// Minimal assertion helpers shared by the host tests.
+// Each test is a function; RUN() prints OK/FAIL and tallies, DONE() prints
+// the summary line and yields the process exit code.
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+
+static int ht_pass = 0;
+static int ht_fail = 0;
+static int ht_cur_failed = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("        %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        ht_cur_failed = 1; \
+    } \
+} while (0)
+
+#define CHECK_EQ(a, b) do { \
+    long long _a = (long long)(a), _b = (long long)(b); \
+    if (_a != _b) { \
+        printf("        %s:%d: %s == %lld, expected %lld\n", __FILE__, __LINE__, #a, _a, _b); \
+        ht_cur_failed = 1; \
+    } \
+} while (0)
+
+#define RUN(fn) do { \
+    ht_cur_failed = 0; \
+    fn(); \
+    if (ht_cur_failed) { printf("  FAIL %s\n", #fn); ht_fail++; } \
+    else               { printf("  OK  %s\n", #fn); ht_pass++; } \
+} while (0)
+
+#define DONE(suite) ( \
+    printf("=== %s: %d passed, %d failed ===\n", suite, ht_pass, ht_fail), \
+    ht_fail ? 1 : 0)
+
+#endif
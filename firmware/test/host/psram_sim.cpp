@@ -0,0 +1,130 @@
+#include <stdlib.h>
+#include <string.h>
+#include "psram_sim.h"
+
+// Same virtual address base as psram.cpp, so wasm3 sees the same values
+#define PSRAM_ADDR_OFFSET  0x10000000UL
+
+static uint8_t        *s_chip;
+static psram_core      s_core;
+static psram_sim_stats s_stats;
+static uint32_t        s_burst_ns;
+
+
+static uint64_t burst_ns(uint32_t bits)
+{
+    return s_burst_ns + (uint64_t)bits * 1000000000ull / s_core.freq;
+}
+
+static void sim_read(void *ctx, uint32_t addr, uint8_t *buf, size_t len)
+{
+    memcpy(buf, s_chip + addr, len);
+    s_stats.read_bursts++;
+    s_stats.read_bytes += len;
+    s_stats.spi_ns += burst_ns(8 + 24 + (s_core.fast_read ? 8 : 0) + 8 * (uint32_t)len);
+}
+
+static void sim_write(void *ctx, uint32_t addr, const uint8_t *buf, size_t len)
+{
+    memcpy(s_chip + addr, buf, len);
+    s_stats.write_bursts++;
+    s_stats.write_bytes += len;
+    s_stats.spi_ns += burst_ns(8 + 24 + 8 * (uint32_t)len);
+}
+
+static const psram_chip_ops sim_ops = { sim_read, sim_write };
+
+
+void psram_sim_init(uint32_t freq_hz, uint32_t burst_ns)
+{
+    if (!s_chip) s_chip = (uint8_t *)malloc(PSRAM_SIM_SIZE);
+    memset(s_chip, 0, PSRAM_SIM_SIZE);
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_burst_ns = burst_ns;
+    psram_core_init(&s_core, PSRAM_SIM_SIZE, &sim_ops, NULL);
+    psram_core_set_freq(&s_core, freq_hz);
+}
+
+psram_core *psram_sim_core(void) { return &s_core; }
+const psram_sim_stats *psram_sim_get_stats(void) { return &s_stats; }
+
+
+// ---- psram.h, as much as the wasm3 glue needs ----
+// Every address here is a chip address: with 8 MB to hand out there is no
+// heap fallback.
+
+static bool in_chip(uint32_t addr, size_t len)
+{
+    uint32_t raw = addr - PSRAM_ADDR_OFFSET;
+    return addr >= PSRAM_ADDR_OFFSET && len <= PSRAM_SIM_SIZE && raw <= PSRAM_SIM_SIZE - len;
+}
+
+void psram_read(uint32_t addr, uint8_t *buf, size_t len)
+{
+    if (!in_chip(addr, len)) return;
+    s_stats.reads++;
+    psram_core_read(&s_core, addr - PSRAM_ADDR_OFFSET, buf, len);
+}
+
+void psram_write(uint32_t addr, const uint8_t *buf, size_t len)
+{
+    if (!in_chip(addr, len)) return;
+    s_stats.writes++;
+    psram_core_write(&s_core, addr - PSRAM_ADDR_OFFSET, buf, len);
+}
+
+void psram_memset(uint32_t dst, uint8_t val, size_t len)
+{
+    uint8_t buf[64];
+    memset(buf, val, sizeof(buf));
+    while (len > 0) {
+        size_t n = (len > sizeof(buf)) ? sizeof(buf) : len;
+        psram_write(dst, buf, n);
+        dst += n; len -= n;
+    }
+}
+
+void psram_memcpy(uint32_t dst, uint32_t src, size_t len)
+{
+    uint8_t buf[64];
+    while (len > 0) {
+        size_t n = (len > sizeof(buf)) ? sizeof(buf) : len;
+        psram_read(src, buf, n);
+        psram_write(dst, buf, n);
+        src += n; dst += n; len -= n;
+    }
+}
+
+uint32_t psram_malloc(size_t size)
+{
+    uint32_t raw;
+    if (size == 0 || !psram_core_alloc(&s_core, size, &raw)) return 0;
+    return raw + PSRAM_ADDR_OFFSET;
+}
+
+void psram_free(uint32_t addr)
+{
+    if (addr) psram_core_free(&s_core, addr - PSRAM_ADDR_OFFSET);
+}
+
+uint8_t *psram_cache_pin(uint32_t addr, bool write)
+{
+    if (!in_chip(addr, 1)) return NULL;
+    return psram_core_pin(&s_core, addr - PSRAM_ADDR_OFFSET, write);
+}
+
+void psram_cache_unpin(uint32_t addr)
+{
+    if (in_chip(addr, 1)) psram_core_unpin(&s_core, addr - PSRAM_ADDR_OFFSET);
+}
+
+void psram_cache_flush(void)      { psram_core_flush(&s_core); }
+void psram_cache_invalidate(void) { psram_core_invalidate(&s_core); }
+
+#if PSRAM_CACHE_PAGES > 0
+uint32_t psram_cache_hits(void)   { return s_core.hits; }
+uint32_t psram_cache_misses(void) { return s_core.misses; }
+#else
+uint32_t psram_cache_hits(void)   { return 0; }
+uint32_t psram_cache_misses(void) { return 0; }
+#endif
@@ -0,0 +1,31 @@
+// Simulated LY68L6400 SPI PSRAM for host builds: psram_core (burst sizing,
+// page cache, allocator) over an in-memory chip, plus the parts of the
+// psram.h API the wasm3 glue uses. Nothing is faster than memcpy here, so
+// instead each burst is charged the time it would hold the bus on the
+// board: command, address and (fast read) wait byte, the data, and a fixed
+// per-burst cost for the register setup and CE# toggling around it.
+
+#ifndef HOST_PSRAM_SIM_H
+#define HOST_PSRAM_SIM_H
+
+#include <stdint.h>
+#include "psram_core.h"
+
+#define PSRAM_SIM_SIZE          (8 * 1024 * 1024)
+#define PSRAM_SIM_FREQ_DEFAULT  40000000
+#define PSRAM_SIM_BURST_NS      1000    // setup + CE# overhead per burst (estimate)
+
+struct psram_sim_stats {
+    uint64_t reads, writes;             // psram_read/psram_write calls
+    uint64_t read_bursts, write_bursts;
+    uint64_t read_bytes, write_bytes;   // over SPI
+    uint64_t spi_ns;                    // modelled bus time
+};
+
+// (Re)start with an empty chip, cache and allocator.
+void psram_sim_init(uint32_t freq_hz, uint32_t burst_ns);
+
+psram_core *psram_sim_core(void);
+const psram_sim_stats *psram_sim_get_stats(void);
+
+#endif
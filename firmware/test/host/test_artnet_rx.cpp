@@ -0,0 +1,354 @@
+// Host test for artnet_rx and the shared DMX ingest: universe spanning,
+// frame assembly with and without ArtSync, sequence checking, and replay
+// of recorded captures.
+
+#include <string.h>
+#include <vector>
+#include "artnet_rx.h"
+#include "host_pcap.h"
+#include "host_test.h"
+
+#define CAPTURES "captures/"
+
+// Test sink: four channels of pixels, and a log of what each commit showed.
+struct test_sink {
+    CRGB pix[DMX_CHANNELS][600];
+    int  count[DMX_CHANNELS];
+    std::vector<std::vector<CRGB>> shown;   // channel 0 at every commit
+};
+
+static CRGB *ts_buf(void *ctx, int ch, int *count)
+{
+    test_sink *s = (test_sink *)ctx;
+    *count = s->count[ch];
+    return s->count[ch] ? s->pix[ch] : nullptr;
+}
+
+static void ts_commit(void *ctx)
+{
+    test_sink *s = (test_sink *)ctx;
+    s->shown.emplace_back(s->pix[0], s->pix[0] + s->count[0]);
+}
+
+struct fixture {
+    dmx_ingest  rx;
+    test_sink   ts;
+    dmx_sink    sink;
+
+    explicit fixture(const dmx_chan_map map[DMX_CHANNELS])
+    {
+        memset((void *)&ts.pix, 0, sizeof(ts.pix));
+        for (int ch = 0; ch < DMX_CHANNELS; ch++) ts.count[ch] = map[ch].count;
+        sink = { ts_buf, ts_commit, &ts };
+        artnet_rx_init(&rx);
+        dmx_ingest_configure(&rx, map);
+    }
+
+    dmx_rx_result dmx(int universe, uint8_t seq, uint8_t value, int len, uint32_t ms)
+    {
+        uint8_t pkt[18 + 512];
+        memcpy(pkt, "Art-Net", 8);
+        pkt[8] = 0x00; pkt[9] = 0x50;               // OpDmx, little-endian
+        pkt[10] = 0; pkt[11] = 14;
+        pkt[12] = seq;
+        pkt[13] = 0;
+        pkt[14] = (uint8_t)universe;
+        pkt[15] = (uint8_t)(universe >> 8);
+        pkt[16] = (uint8_t)(len >> 8);
+        pkt[17] = (uint8_t)len;
+        memset(pkt + 18, value, (size_t)len);
+        return artnet_rx_packet(&rx, pkt, 18 + (size_t)len, ms, &sink);
+    }
+
+    dmx_rx_result sync(uint32_t ms)
+    {
+        uint8_t pkt[14] = { 'A', 'r', 't', '-', 'N', 'e', 't', 0, 0x00, 0x52, 0, 14, 0, 0 };
+        return artnet_rx_packet(&rx, pkt, sizeof(pkt), ms, &sink);
+    }
+};
+
+
+static void test_spanning()
+{
+    // 300 pixels from universe 7 address 4: 169 there, 131 in universe 8.
+    // Channel 2 shares universe 8 after them; channel 3 starts too late in
+    // universe 2 for a single pixel and begins in universe 3.
+    dmx_chan_map map[DMX_CHANNELS] = {
+        { 7, 4, 300 }, { 8, 394, 20 }, { 2, 511, 10 }, { 0, 0, 50 },
+    };
+    fixture f(map);
+    CHECK_EQ(f.rx.nuni, 3);
+    CHECK_EQ(f.rx.nspans, 4);
+    CHECK_EQ(f.rx.span[0].npix, 169);
+    CHECK_EQ(f.rx.span[1].pixel, 169);
+    CHECK_EQ(f.rx.span[1].npix, 131);
+    CHECK_EQ(f.rx.span[1].dmx_off, 0);
+    CHECK_EQ(f.rx.uni[f.rx.span[3].uni].universe, 3);
+
+    CHECK_EQ(f.dmx(7, 0, 10, 512, 1000), DMX_RX_COMMITTED);
+    CHECK_EQ(f.dmx(8, 0, 20, 512, 1001), DMX_RX_STAGED);
+    CHECK(f.ts.pix[0][168] == CRGB(10, 10, 10));
+    CHECK(f.ts.pix[0][169] == CRGB(20, 20, 20));
+    CHECK(f.ts.pix[0][299] == CRGB(20, 20, 20));
+    CHECK(f.ts.pix[1][19] == CRGB(20, 20, 20));
+
+    // A changed mapping rebuilds; the same one is a no-op.
+    CHECK(!dmx_ingest_configure(&f.rx, map));
+    map[0].count = 100;
+    CHECK(dmx_ingest_configure(&f.rx, map));
+    CHECK_EQ(f.rx.nspans, 3);
+}
+
+static void test_frame_completion()
+{
+    dmx_chan_map map[DMX_CHANNELS] = { { 0, 1, 340 }, {}, {}, {} };
+    fixture f(map);
+
+    // Until universe 1 has been seen, universe 0 alone is a whole frame.
+    // Universe 0 opening the next burst ends the frame universe 1 started.
+    CHECK_EQ(f.dmx(0, 0, 0, 510, 1000), DMX_RX_COMMITTED);
+    CHECK_EQ(f.dmx(1, 0, 0, 510, 1000), DMX_RX_STAGED);
+    CHECK_EQ(f.dmx(0, 0, 1, 510, 1023), DMX_RX_COMMITTED);
+    CHECK_EQ(f.dmx(1, 0, 1, 510, 1023), DMX_RX_COMMITTED);
+    CHECK_EQ(f.rx.st.partial, 1);
+
+    // From then on every frame commits on its last universe.
+    f.ts.shown.clear();
+    for (int fr = 2; fr < 10; fr++) {
+        uint32_t t = 1000 + (uint32_t)fr * 23;
+        CHECK_EQ(f.dmx(0, 0, (uint8_t)fr, 510, t), DMX_RX_STAGED);
+        CHECK_EQ(f.dmx(1, 0, (uint8_t)fr, 510, t), DMX_RX_COMMITTED);
+    }
+    CHECK_EQ((int)f.ts.shown.size(), 8);
+    for (auto &fr : f.ts.shown) CHECK(fr[0] == fr[339]);
+    CHECK_EQ(f.rx.st.partial, 1);
+
+    // Universe 0 repeating before universe 1 came: the half frame is shown
+    // alone rather than mixed with the next one.
+    f.dmx(0, 0, 50, 510, 1300);
+    CHECK_EQ(f.dmx(0, 0, 51, 510, 1301), DMX_RX_COMMITTED);
+    CHECK(f.ts.shown.back()[0] == CRGB(50, 50, 50));
+    CHECK(f.ts.shown.back()[339] == CRGB(9, 9, 9));
+
+    // Nothing more arrives: the poll shows the half frame after the timeout.
+    size_t n = f.ts.shown.size();
+    dmx_ingest_poll(&f.rx, 1301 + DMX_FRAME_TIMEOUT_MS - 1, &f.sink);
+    CHECK_EQ((int)f.ts.shown.size(), (int)n);
+    dmx_ingest_poll(&f.rx, 1301 + DMX_FRAME_TIMEOUT_MS, &f.sink);
+    CHECK_EQ((int)f.ts.shown.size(), (int)n + 1);
+
+    // A universe that stopped arriving no longer holds frames back.
+    CHECK_EQ(f.dmx(0, 0, 60, 510, 3000), DMX_RX_COMMITTED);
+    CHECK_EQ(f.dmx(0, 0, 61, 510, 3023), DMX_RX_COMMITTED);
+}
+
+static void test_frame_phase()
+{
+    // A lost first universe must not leave frames committed half from one
+    // controller frame and half from the next from then on.
+    dmx_chan_map map[DMX_CHANNELS] = { { 0, 1, 340 }, {}, {}, {} };
+    fixture f(map);
+    for (int fr = 0; fr < 20; fr++) {
+        uint32_t t = (uint32_t)fr * 23;
+        if (fr != 5) f.dmx(0, 0, (uint8_t)fr, 510, t);
+        f.dmx(1, 0, (uint8_t)fr, 510, t);
+    }
+    int mixed = 0;
+    for (size_t i = f.ts.shown.size() - 10; i < f.ts.shown.size(); i++)
+        if (!(f.ts.shown[i][0] == f.ts.shown[i][339])) mixed++;
+    CHECK_EQ(mixed, 0);
+}
+
+static void test_paced_frames()
+{
+    // A sender that spreads each frame over the frame period: universes 5
+    // and 15 ms apart at 25 Hz, a few ms of jitter, joined mid-frame and
+    // universe 0 lost once. Only the frame it joined in and the one missing
+    // universe 0 are partial; every other commit is one whole frame.
+    dmx_chan_map map[DMX_CHANNELS] = { { 0, 1, 510 }, {}, {}, {} };
+    fixture f(map);
+    static const uint32_t at[3] = { 0, 5, 20 };
+    for (int fr = 0; fr < 40; fr++) {
+        for (int u = 0; u < 3; u++) {
+            if ((fr == 0 || fr == 20) && u == 0) continue;
+            uint32_t t = 1000 + (uint32_t)fr * 40 + at[u] + (uint32_t)((fr * 7 + u * 3) % 4);
+            f.dmx(u, 0, (uint8_t)fr, 510, t);
+        }
+    }
+    CHECK_EQ(f.rx.st.frames, 41);
+    CHECK_EQ(f.rx.st.partial, 2);
+    int whole = 0;
+    for (auto &fr : f.ts.shown)
+        if (fr[0] == fr[170] && fr[0] == fr[509]) whole++;
+    CHECK_EQ(whole, 40);
+    CHECK(f.ts.shown.back()[0] == CRGB(39, 39, 39));
+
+    // Two universes 7 ms apart at 44 Hz, every fifth frame 12 ms apart:
+    // one commit per frame, each whole.
+    dmx_chan_map map2[DMX_CHANNELS] = { { 0, 1, 340 }, {}, {}, {} };
+    fixture g(map2);
+    for (int fr = 0; fr < 40; fr++) {
+        uint32_t t = 1000 + (uint32_t)fr * 23;
+        g.dmx(0, 0, (uint8_t)fr, 510, t);
+        CHECK_EQ(g.dmx(1, 0, (uint8_t)fr, 510, t + (fr % 5 == 4 ? 12 : 7)),
+                 fr ? DMX_RX_COMMITTED : DMX_RX_STAGED);
+    }
+    // Universe 0 alone, then universe 1 of frame 0 once it is known
+    CHECK_EQ((int)g.ts.shown.size(), 41);
+    CHECK_EQ(g.rx.st.partial, 1);
+    for (size_t i = 2; i < g.ts.shown.size(); i++) {
+        uint8_t v = (uint8_t)(i - 1);
+        CHECK(g.ts.shown[i][0] == CRGB(v, v, v) && g.ts.shown[i][339] == CRGB(v, v, v));
+    }
+}
+
+static void test_sync()
+{
+    dmx_chan_map map[DMX_CHANNELS] = { { 0, 1, 10 }, {}, {}, {} };
+    fixture f(map);
+    CHECK_EQ(f.sync(0), DMX_RX_IGNORED);
+    CHECK(f.rx.st.sync_mode);
+
+    // Held until ArtSync, however many times the universe arrives.
+    CHECK_EQ(f.dmx(0, 0, 1, 30, 10), DMX_RX_STAGED);
+    CHECK_EQ(f.dmx(0, 0, 2, 30, 20), DMX_RX_STAGED);
+    dmx_ingest_poll(&f.rx, 500, &f.sink);
+    CHECK_EQ((int)f.ts.shown.size(), 0);
+    CHECK_EQ(f.sync(600), DMX_RX_COMMITTED);
+    CHECK(f.ts.shown.back()[0] == CRGB(2, 2, 2));
+
+    // No ArtSync for 4 s: back to committing on completion.
+    dmx_ingest_poll(&f.rx, 600 + ARTNET_SYNC_TIMEOUT_MS + 1, &f.sink);
+    CHECK(!f.rx.st.sync_mode);
+    CHECK_EQ(f.dmx(0, 0, 3, 30, 5000), DMX_RX_COMMITTED);
+    CHECK_EQ(f.rx.st.syncs, 2);
+}
+
+static void test_sequence()
+{
+    dmx_chan_map map[DMX_CHANNELS] = { { 0, 1, 10 }, {}, {}, {} };
+    fixture f(map);
+    CHECK_EQ(f.dmx(0, 10, 1, 30, 1000), DMX_RX_COMMITTED);
+    CHECK_EQ(f.dmx(0, 10, 2, 30, 1001), DMX_RX_DROPPED);     // duplicate
+    CHECK_EQ(f.dmx(0, 9, 2, 30, 1002), DMX_RX_DROPPED);      // late
+    CHECK_EQ(f.dmx(0, 13, 3, 30, 1003), DMX_RX_COMMITTED);   // 11, 12 lost
+    CHECK(f.ts.pix[0][0] == CRGB(3, 3, 3));
+    CHECK_EQ(f.rx.uni[0].dups, 1);
+    CHECK_EQ(f.rx.uni[0].late, 1);
+    CHECK_EQ(f.rx.uni[0].lost, 2);
+    CHECK_EQ(f.rx.uni[0].packets, 2);
+
+    // A sender back after a silence starts afresh; 255 wraps to 1, not 0.
+    CHECK_EQ(f.dmx(0, 254, 4, 30, 3000), DMX_RX_COMMITTED);
+    CHECK_EQ(f.dmx(0, 255, 5, 30, 3001), DMX_RX_COMMITTED);
+    CHECK_EQ(f.dmx(0, 1, 6, 30, 3002), DMX_RX_COMMITTED);
+    CHECK_EQ(f.dmx(0, 255, 7, 30, 3003), DMX_RX_DROPPED);
+    CHECK_EQ(f.rx.uni[0].lost, 2);
+    CHECK_EQ(f.rx.uni[0].late, 2);
+
+    // 0 = unsequenced: never dropped.
+    CHECK_EQ(f.dmx(0, 0, 8, 30, 3004), DMX_RX_COMMITTED);
+    CHECK_EQ(f.dmx(0, 0, 9, 30, 3005), DMX_RX_COMMITTED);
+}
+
+static void test_invalid_and_short()
+{
+    dmx_chan_map map[DMX_CHANNELS] = { { 3, 1, 10 }, {}, {}, {} };
+    fixture f(map);
+    uint8_t junk[20] = "Not-Art";
+    CHECK_EQ(artnet_rx_packet(&f.rx, junk, sizeof(junk), 0, &f.sink), DMX_RX_INVALID);
+    CHECK_EQ(f.dmx(3, 0, 1, 1, 0), DMX_RX_INVALID);       // DMX length < 2
+    CHECK_EQ(f.dmx(4, 0, 1, 30, 0), DMX_RX_IGNORED);      // unmapped universe
+    CHECK_EQ(f.rx.st.invalid, 2);
+    CHECK_EQ(f.rx.st.ignored, 1);
+
+    // 14 slots: four whole pixels, the fifth is left alone.
+    f.ts.pix[0][4] = CRGB(0, 0, 0);
+    CHECK_EQ(f.dmx(3, 0, 7, 14, 0), DMX_RX_COMMITTED);
+    CHECK(f.ts.pix[0][3] == CRGB(7, 7, 7));
+    CHECK(f.ts.pix[0][4] == CRGB(0, 0, 0));
+    CHECK_EQ(f.rx.uni[0].short_pkts, 1);
+}
+
+
+// Replay a capture, feeding poll between packets as the firmware does.
+static bool replay(fixture &f, const char *path)
+{
+    host_pcap cap;
+    if (!host_pcap_open(&cap, path)) {
+        host_pcap_close(&cap);
+        return false;
+    }
+    host_pcap_pkt p;
+    while (host_pcap_next(&cap, &p)) {
+        if (p.dport != ARTNET_PORT) continue;
+        uint32_t now = (uint32_t)(p.ts_us / 1000);
+        dmx_ingest_poll(&f.rx, now, &f.sink);
+        artnet_rx_packet(&f.rx, p.data, p.len, now, &f.sink);
+    }
+    host_pcap_close(&cap);
+    return true;
+}
+
+static void test_capture_unsynced()
+{
+    // 40 frames of 300 pixels over universes 0-1 at 44 Hz, with a reordered
+    // frame, a lost and a late universe 0 packet and a duplicate (see
+    // captures/gen_artnet.py). Every committed frame that is not counted as
+    // partial must come from a single controller frame.
+    dmx_chan_map map[DMX_CHANNELS] = { { 0, 1, 300 }, {}, {}, {} };
+    fixture f(map);
+    CHECK(replay(f, CAPTURES "artnet_2uni.pcap"));
+
+    CHECK_EQ(f.rx.st.packets, 78);
+    CHECK_EQ(f.rx.st.frames, 41);
+    CHECK_EQ(f.rx.st.partial, 3);
+    CHECK_EQ(f.rx.uni[0].lost, 2);
+    CHECK_EQ(f.rx.uni[0].late, 1);
+    CHECK_EQ(f.rx.uni[1].dups, 1);
+
+    // The very first commit is universe 0 alone: universe 1 not seen yet.
+    int whole = 0, last = -1, backwards = 0;
+    for (size_t i = 1; i < f.ts.shown.size(); i++) {
+        const std::vector<CRGB> &fr = f.ts.shown[i];
+        CHECK(fr[0].g == 0 && fr[299].g == 1);
+        if (fr[0].r == fr[299].r) whole++;
+        if (fr[299].r < last) backwards++;
+        last = fr[299].r;
+    }
+    CHECK_EQ(whole, 38);
+    CHECK_EQ(backwards, 0);
+    CHECK(f.ts.shown.back()[0] == CRGB(39, 0, 0x5A));
+}
+
+static void test_capture_sync()
+{
+    // 20 frames over universes 4-6, each followed by ArtSync. Before the
+    // first ArtSync the receiver is unsynced and shows universe 4 alone;
+    // after it, exactly one commit per ArtSync.
+    dmx_chan_map map[DMX_CHANNELS] = { {}, { 4, 1, 400 }, {}, {} };
+    fixture f(map);
+    CHECK(replay(f, CAPTURES "artnet_sync.pcap"));
+    CHECK(f.rx.st.sync_mode);
+    CHECK_EQ(f.rx.st.syncs, 20);
+    CHECK_EQ(f.rx.st.frames, 21);
+    CHECK_EQ(f.rx.st.partial, 1);
+    CHECK(f.ts.pix[1][0] == CRGB(19, 4, 0x5A));
+    CHECK(f.ts.pix[1][399] == CRGB(19, 6, 0x5A));
+}
+
+
+int main()
+{
+    printf("=== artnet_rx host tests ===\n");
+    RUN(test_spanning);
+    RUN(test_frame_completion);
+    RUN(test_frame_phase);
+    RUN(test_paced_frames);
+    RUN(test_sync);
+    RUN(test_sequence);
+    RUN(test_invalid_and_short);
+    RUN(test_capture_unsynced);
+    RUN(test_capture_sync);
+    return DONE("artnet_rx");
+}
@@ -0,0 +1,171 @@
+// Host test for frame_clock: epoch-aligned frame boundaries, overrun/step
+// handling and phase-error statistics, driven with synthetic time.
+
+#include "frame_clock.h"
+#include "host_test.h"
+
+// A plausible 2026 epoch in us, deliberately not on a frame boundary.
+#define T0 1780000000123457ULL
+
+
+static void test_index_and_start_agree()
+{
+    const int rates[] = { 1, 24, 25, 30, 44, 60, 120 };
+    for (int r : rates) {
+        for (uint64_t n = 53400000000ULL; n < 53400000000ULL + 500; n++) {
+            uint64_t s = frame_clock_start_us(n, r);
+            CHECK_EQ(frame_clock_index(s, r), n);
+            CHECK_EQ(frame_clock_index(s - 1, r), n - 1);
+        }
+    }
+    CHECK_EQ(frame_clock_start_us(3, 30), 100000);
+    CHECK_EQ(frame_clock_start_us(1, 30), 33334);
+}
+
+static void test_two_cones_share_boundaries()
+{
+    // Cones that start their render loops at different times within a frame
+    // wake at the same instants with the same frame numbers.
+    frame_clock a, b;
+    frame_clock_init(&a);
+    frame_clock_init(&b);
+    uint64_t ta = T0, tb = T0 + 5000;
+    for (int i = 0; i < 10; i++) {
+        ta += frame_clock_next(&a, ta, 30);
+        tb += frame_clock_next(&b, tb, 30);
+        uint64_t fa = frame_clock_wake(&a, ta);
+        uint64_t fb = frame_clock_wake(&b, tb);
+        CHECK_EQ(fa, fb);
+        CHECK_EQ(ta, tb);
+        CHECK_EQ(ta, frame_clock_start_us(fa, 30));
+    }
+    frame_clock_stats st;
+    frame_clock_get_stats(&a, &st);
+    CHECK_EQ(st.frames, 10);
+    CHECK_EQ(st.missed, 0);
+    CHECK_EQ(st.err_max_us, 0);
+}
+
+static void test_consecutive_frames()
+{
+    frame_clock fc;
+    frame_clock_init(&fc);
+    uint64_t t = T0;
+    uint64_t prev = 0;
+    for (int i = 0; i < 100; i++) {
+        t += frame_clock_next(&fc, t, 60);
+        uint64_t f = frame_clock_wake(&fc, t);
+        if (i > 0) CHECK_EQ(f, prev + 1);
+        prev = f;
+        t += 4000;                              // render work
+    }
+}
+
+static void test_overrun_skips_to_next_boundary()
+{
+    frame_clock fc;
+    frame_clock_init(&fc);
+    uint64_t t = T0;
+    t += frame_clock_next(&fc, t, 30);
+    uint64_t f = frame_clock_wake(&fc, t);
+
+    // Render overruns by 2.5 frames: boundaries f+1 and f+2 are gone.
+    t += 83333;
+    uint32_t d = frame_clock_next(&fc, t, 30);
+    CHECK(d > 0 && d < 33334);
+    t += d;
+    CHECK_EQ(frame_clock_wake(&fc, t), f + 3);
+    CHECK_EQ(t, frame_clock_start_us(f + 3, 30));
+
+    frame_clock_stats st;
+    frame_clock_get_stats(&fc, &st);
+    CHECK_EQ(st.missed, 2);
+    CHECK_EQ(st.resyncs, 0);
+}
+
+static void test_clock_steps_resync()
+{
+    frame_clock fc;
+    frame_clock_init(&fc);
+    uint64_t t = T0;
+    t += frame_clock_next(&fc, t, 30);
+    frame_clock_wake(&fc, t);
+
+    // Backward step (e.g. NTP correcting a fast beacon time): wait is still
+    // at most one frame, not the size of the step.
+    t -= 250000;
+    uint32_t d = frame_clock_next(&fc, t, 30);
+    CHECK(d <= 33334);
+    t += d;
+    frame_clock_wake(&fc, t);
+
+    // Large forward step: restart rather than report hundreds of misses.
+    t += 5000000;
+    d = frame_clock_next(&fc, t, 30);
+    CHECK(d <= 33334);
+
+    frame_clock_stats st;
+    frame_clock_get_stats(&fc, &st);
+    CHECK_EQ(st.resyncs, 2);
+    CHECK_EQ(st.missed, 0);
+}
+
+static void test_fps_change_resyncs()
+{
+    frame_clock fc;
+    frame_clock_init(&fc);
+    uint64_t t = T0;
+    t += frame_clock_next(&fc, t, 30);
+    frame_clock_wake(&fc, t);
+    t += frame_clock_next(&fc, t, 50);
+    uint64_t f = frame_clock_wake(&fc, t);
+    CHECK_EQ(t, frame_clock_start_us(f, 50));
+    CHECK_EQ(fc.st.resyncs, 1);
+
+    // Out-of-range rates are clamped, not divided by.
+    CHECK_EQ(frame_clock_clamp_fps(0), FRAME_CLOCK_MIN_FPS);
+    CHECK_EQ(frame_clock_clamp_fps(1000), FRAME_CLOCK_MAX_FPS);
+    CHECK(frame_clock_next(&fc, t, 0) <= 1000000);
+}
+
+static void test_phase_error_stats()
+{
+    frame_clock fc;
+    frame_clock_init(&fc);
+    uint64_t t = T0;
+    // 98 wakes 40 us late, one 3 ms late, one 300 us early.
+    for (int i = 0; i < 100; i++) {
+        t += frame_clock_next(&fc, t, 30);
+        uint64_t w = t + 40;
+        if (i == 10) w = t + 3000;
+        if (i == 20) w = t - 300;
+        frame_clock_wake(&fc, w);
+        t = w + 1000;
+    }
+    frame_clock_stats st;
+    frame_clock_get_stats(&fc, &st);
+    CHECK_EQ(st.frames, 100);
+    CHECK_EQ(st.err_p50_us, 50);
+    CHECK_EQ(st.err_p99_us, 500);
+    CHECK_EQ(st.err_max_us, 3000);
+    CHECK_EQ(st.err_last_us, 40);
+
+    frame_clock_reset_stats(&fc);
+    frame_clock_get_stats(&fc, &st);
+    CHECK_EQ(st.frames, 0);
+    CHECK_EQ(st.err_p99_us, 0);
+}
+
+
+int main()
+{
+    printf("=== frame_clock host tests ===\n");
+    RUN(test_index_and_start_agree);
+    RUN(test_two_cones_share_boundaries);
+    RUN(test_consecutive_frames);
+    RUN(test_overrun_skips_to_next_boundary);
+    RUN(test_clock_steps_resync);
+    RUN(test_fps_change_resyncs);
+    RUN(test_phase_error_stats);
+    return DONE("frame_clock");
+}
@@ -0,0 +1,274 @@
+// Host test for led_layer: blend modes, priority ordering and the lock-free
+// triple-buffer hand-off between a producer and the compositor.
+
+#include <string.h>
+#include <thread>
+#include "led_layer.h"
+#include "host_test.h"
+
+static const int caps4[LED_LAYER_CHANNELS] = { 8, 8, 8, 8 };
+
+
+static void fill(CRGB *p, int n, CRGB c)
+{
+    for (int i = 0; i < n; i++) p[i] = c;
+}
+
+// Compose a single channel of 8 pixels from the given layers.
+static void compose1(led_layer **v, int n, CRGB *out)
+{
+    CRGB *outs[LED_LAYER_CHANNELS] = { out, nullptr, nullptr, nullptr };
+    int counts[LED_LAYER_CHANNELS] = { 8, 0, 0, 0 };
+    led_layer_compose(v, n, outs, counts, LED_LAYER_ALL);
+}
+
+
+static void test_blend_modes()
+{
+    led_layer lo, hi;
+    led_layer_init(&lo, "lo", caps4, nullptr, 0, LED_BLEND_REPLACE);
+    led_layer_init(&hi, "hi", caps4, nullptr, 1, LED_BLEND_REPLACE);
+    fill(led_layer_draw(&lo, 0), 8, CRGB(200, 100, 0));
+    led_layer_commit(&lo);
+    CRGB *h = led_layer_draw(&hi, 0);
+    fill(h, 8, CRGB(100, 200, 50));
+    h[0] = CRGB(0, 0, 0);
+    led_layer_commit(&hi);
+
+    led_layer *v[] = { &lo, &hi };
+    CRGB out[8];
+
+    hi.blend = LED_BLEND_REPLACE;
+    compose1(v, 2, out);
+    CHECK(out[0] == CRGB(0, 0, 0));
+    CHECK(out[1] == CRGB(100, 200, 50));
+
+    hi.blend = LED_BLEND_OVER;
+    compose1(v, 2, out);
+    CHECK(out[0] == CRGB(200, 100, 0));
+    CHECK(out[1] == CRGB(100, 200, 50));
+
+    hi.blend = LED_BLEND_ADD;
+    compose1(v, 2, out);
+    CHECK(out[0] == CRGB(200, 100, 0));
+    CHECK(out[1] == CRGB(255, 255, 50));
+
+    hi.blend = LED_BLEND_MAX;
+    compose1(v, 2, out);
+    CHECK(out[1] == CRGB(200, 200, 50));
+
+    // Half opacity mixes the blended result with what is below.
+    hi.blend = LED_BLEND_REPLACE;
+    hi.opacity = 128;
+    compose1(v, 2, out);
+    CHECK(out[1] == CRGB(150, 150, 25));
+    hi.opacity = 0;
+    compose1(v, 2, out);
+    CHECK(out[1] == CRGB(200, 100, 0));
+
+    led_layer_free(&lo);
+    led_layer_free(&hi);
+}
+
+static void test_priority_order()
+{
+    led_layer a, b, c;
+    led_layer_init(&a, "a", caps4, nullptr, 30, LED_BLEND_REPLACE);
+    led_layer_init(&b, "b", caps4, nullptr, 10, LED_BLEND_REPLACE);
+    led_layer_init(&c, "c", caps4, nullptr, 20, LED_BLEND_REPLACE);
+    fill(led_layer_draw(&a, 0), 8, CRGB(1, 0, 0));
+    fill(led_layer_draw(&b, 0), 8, CRGB(2, 0, 0));
+    fill(led_layer_draw(&c, 0), 8, CRGB(3, 0, 0));
+    led_layer_commit(&a);
+    led_layer_commit(&b);
+    led_layer_commit(&c);
+
+    led_layer *v[] = { &a, &b, &c };
+    led_layer_sort(v, 3);
+    CHECK(v[0] == &b && v[1] == &c && v[2] == &a);
+
+    CRGB out[8];
+    compose1(v, 3, out);
+    CHECK(out[0] == CRGB(1, 0, 0));
+
+    // The top layer releasing lets the next one show through.
+    led_layer_release(&a);
+    compose1(v, 3, out);
+    CHECK(out[0] == CRGB(3, 0, 0));
+
+    led_layer_free(&a);
+    led_layer_free(&b);
+    led_layer_free(&c);
+}
+
+static void test_channel_mask_and_caps()
+{
+    // A layer only covers the channels it drew, and only up to its capacity.
+    const int small[LED_LAYER_CHANNELS] = { 4, 8, 0, 8 };
+    led_layer base, top;
+    led_layer_init(&base, "base", caps4, nullptr, 0, LED_BLEND_REPLACE);
+    led_layer_init(&top, "top", small, nullptr, 1, LED_BLEND_REPLACE);
+    for (int ch = 0; ch < 4; ch++) fill(led_layer_draw(&base, ch), 8, CRGB(9, 9, 9));
+    led_layer_commit(&base);
+    fill(led_layer_draw(&top, 0), 4, CRGB(50, 0, 0));
+    CHECK(led_layer_draw(&top, 2) == nullptr);
+    led_layer_commit(&top);
+
+    led_layer *v[] = { &base, &top };
+    CRGB o0[8], o1[8], o2[8], o3[8];
+    CRGB *outs[LED_LAYER_CHANNELS] = { o0, o1, o2, o3 };
+    int counts[LED_LAYER_CHANNELS] = { 8, 8, 8, 8 };
+    CHECK_EQ(led_layer_compose(v, 2, outs, counts, 0), LED_LAYER_ALL);
+    CHECK(o0[3] == CRGB(50, 0, 0));
+    CHECK(o0[4] == CRGB(9, 9, 9));
+    CHECK(o1[0] == CRGB(9, 9, 9));
+    CHECK(o2[0] == CRGB(9, 9, 9));
+
+    // Nothing new published since: no channel is recomposed.
+    CHECK_EQ(led_layer_compose(v, 2, outs, counts, 0), 0);
+
+    led_layer_free(&base);
+    led_layer_free(&top);
+}
+
+static void test_external_work_buffers()
+{
+    CRGB w0[8], w1[8], w2[8], w3[8];
+    CRGB *work[LED_LAYER_CHANNELS] = { w0, w1, w2, w3 };
+    led_layer l;
+    led_layer_init(&l, "base", caps4, work, 0, LED_BLEND_REPLACE);
+    CHECK(led_layer_draw(&l, 1) == w1);
+    fill(w1, 8, CRGB(7, 7, 7));
+    led_layer_commit(&l);
+
+    // Drawing after the commit does not reach the compositor until the next.
+    fill(w1, 8, CRGB(1, 1, 1));
+    led_layer *v[] = { &l };
+    CRGB o[4][8];
+    CRGB *outs[LED_LAYER_CHANNELS] = { o[0], o[1], o[2], o[3] };
+    int counts[LED_LAYER_CHANNELS] = { 8, 8, 8, 8 };
+    led_layer_compose(v, 1, outs, counts, 0);
+    CHECK(o[1][0] == CRGB(7, 7, 7));
+    led_layer_free(&l);
+}
+
+static void test_latest_wins_and_drops()
+{
+    led_layer l;
+    led_layer_init(&l, "l", caps4, nullptr, 0, LED_BLEND_REPLACE);
+    for (int i = 1; i <= 5; i++) {
+        fill(led_layer_draw(&l, 0), 8, CRGB((uint8_t)i, 0, 0));
+        led_layer_commit(&l);
+    }
+    led_layer *v[] = { &l };
+    CRGB out[8];
+    compose1(v, 1, out);
+    CHECK(out[0] == CRGB(5, 0, 0));
+    CHECK_EQ(l.commits, 5);
+    CHECK_EQ(l.dropped, 4);
+    CHECK_EQ(l.taken, 1);
+
+    // With no new commit the compositor keeps showing the last frame.
+    compose1(v, 1, out);
+    CHECK(out[0] == CRGB(5, 0, 0));
+    CHECK_EQ(l.taken, 1);
+    led_layer_free(&l);
+}
+
+static void test_no_torn_frames()
+{
+    // The producer writes frames whose every pixel carries the frame number;
+    // every composed frame must be uniform and never go backwards.
+    const int big[LED_LAYER_CHANNELS] = { 300, 300, 0, 0 };
+    led_layer l;
+    led_layer_init(&l, "p", big, nullptr, 0, LED_BLEND_REPLACE);
+    const int frames = 20000;
+
+    std::thread producer([&] {
+        for (int f = 1; f <= frames; f++) {
+            CRGB c((uint8_t)f, (uint8_t)(f >> 8), (uint8_t)(f >> 16));
+            fill(led_layer_draw(&l, 0), 300, c);
+            fill(led_layer_draw(&l, 1), 300, c);
+            led_layer_commit(&l);
+        }
+    });
+
+    led_layer *v[] = { &l };
+    static CRGB o0[300], o1[300];
+    CRGB *outs[LED_LAYER_CHANNELS] = { o0, o1, nullptr, nullptr };
+    int counts[LED_LAYER_CHANNELS] = { 300, 300, 0, 0 };
+    int last = 0, torn = 0, backwards = 0;
+    while (last < frames) {
+        if (!led_layer_compose(v, 1, outs, counts, 0)) continue;
+        int f = o0[0].r | (o0[0].g << 8) | (o0[0].b << 16);
+        for (int i = 0; i < 300; i++)
+            if (!(o0[i] == o0[0]) || !(o1[i] == o0[0])) { torn++; break; }
+        if (f < last) backwards++;
+        last = f;
+    }
+    producer.join();
+    CHECK_EQ(torn, 0);
+    CHECK_EQ(backwards, 0);
+    CHECK_EQ(l.commits, frames);
+    CHECK_EQ(l.taken + l.dropped, frames);
+    led_layer_free(&l);
+}
+
+static void test_dirty_channels()
+{
+    // Only channels a new frame covers -- now or in the frame it replaces --
+    // are recomposed; the others keep what the caller last composed.
+    led_layer base, top;
+    led_layer_init(&base, "base", caps4, nullptr, 0, LED_BLEND_REPLACE);
+    led_layer_init(&top, "top", caps4, nullptr, 1, LED_BLEND_REPLACE);
+    for (int ch = 0; ch < 4; ch++) fill(led_layer_draw(&base, ch), 8, CRGB(1, 1, 1));
+    led_layer_commit(&base);
+
+    led_layer *v[] = { &base, &top };
+    CRGB o[4][8];
+    CRGB *outs[LED_LAYER_CHANNELS] = { o[0], o[1], o[2], o[3] };
+    int counts[LED_LAYER_CHANNELS] = { 8, 8, 8, 8 };
+    CHECK_EQ(led_layer_compose(v, 2, outs, counts, 0), LED_LAYER_ALL);
+
+    fill(led_layer_draw(&top, 2), 8, CRGB(5, 0, 0));
+    led_layer_commit(&top);
+    o[0][0] = CRGB(99, 99, 99);                 // must survive: ch 1 not touched
+    CHECK_EQ(led_layer_compose(v, 2, outs, counts, 0), 0x4);
+    CHECK(o[2][0] == CRGB(5, 0, 0));
+    CHECK(o[0][0] == CRGB(99, 99, 99));
+
+    // Releasing touches the channels the layer used to cover.
+    led_layer_release(&top);
+    CHECK_EQ(led_layer_compose(v, 2, outs, counts, 0), 0x4);
+    CHECK(o[2][0] == CRGB(1, 1, 1));
+
+    // force recomposes regardless.
+    CHECK_EQ(led_layer_compose(v, 2, outs, counts, 0x1), 0x1);
+    CHECK(o[0][0] == CRGB(1, 1, 1));
+
+    led_layer_free(&base);
+    led_layer_free(&top);
+}
+
+static void test_blend_names()
+{
+    for (int i = 0; i < LED_BLEND_COUNT; i++)
+        CHECK_EQ(led_blend_parse(led_blend_name(i)), i);
+    CHECK_EQ(led_blend_parse("OVER"), LED_BLEND_OVER);
+    CHECK_EQ(led_blend_parse("multiply"), -1);
+}
+
+
+int main()
+{
+    printf("=== led_layer host tests ===\n");
+    RUN(test_blend_modes);
+    RUN(test_priority_order);
+    RUN(test_channel_mask_and_caps);
+    RUN(test_external_work_buffers);
+    RUN(test_latest_wins_and_drops);
+    RUN(test_no_torn_frames);
+    RUN(test_dirty_channels);
+    RUN(test_blend_names);
+    return DONE("led_layer");
+}
@@ -0,0 +1,404 @@
+// Host test for led_stage: per-channel GRB staging against a mock RMT backend.
+//
+// The mock records every transmit/wait/abort in order and snapshots each
+// buffer at transmit time. When the transmit completes (or is aborted) it
+// checks the bytes are unchanged -- i.e. the staging buffer outlived the
+// asynchronous read -- and it flags a second transmit on a channel that is
+// still busy.
+
+#include <string.h>
+#include "led_stage.h"
+#include "host_test.h"
+
+#define MOCK_MAX_EVENTS 64
+#define MOCK_MAX_BYTES  (64 * 3)
+
+struct mock_ev { char op; int ch; };     // op: 'T'ransmit, 'W'ait done, 'X' timeout, 'A'bort
+
+struct mock_rmt {
+    mock_ev ev[MOCK_MAX_EVENTS];
+    int     nev;
+
+    bool           busy[4];
+    const uint8_t *ptr[4];
+    size_t         len[4];
+    uint8_t        snap[4][MOCK_MAX_BYTES];
+
+    bool fail_tx[4];        // transmit() refuses
+    bool stall[4];          // wait() times out until aborted
+
+    int corrupt;            // buffer modified while in flight
+    int overlap;            // transmit on a busy channel
+    int spurious;           // wait/abort on an idle channel
+};
+
+static void mock_log(mock_rmt *m, char op, int ch)
+{
+    if (m->nev < MOCK_MAX_EVENTS) m->ev[m->nev++] = { op, ch };
+}
+
+static void mock_check_intact(mock_rmt *m, int ch)
+{
+    if (memcmp(m->snap[ch], m->ptr[ch], m->len[ch]) != 0) m->corrupt++;
+}
+
+static int mock_transmit(void *ctx, int ch, const uint8_t *data, size_t len)
+{
+    mock_rmt *m = (mock_rmt *)ctx;
+    if (m->fail_tx[ch]) return -1;
+    if (m->busy[ch]) m->overlap++;
+    if (len > MOCK_MAX_BYTES) len = MOCK_MAX_BYTES;
+    m->busy[ch] = true;
+    m->ptr[ch]  = data;
+    m->len[ch]  = len;
+    memcpy(m->snap[ch], data, len);
+    mock_log(m, 'T', ch);
+    return 0;
+}
+
+static int mock_wait(void *ctx, int ch, uint32_t timeout_ms)
+{
+    (void)timeout_ms;
+    mock_rmt *m = (mock_rmt *)ctx;
+    if (!m->busy[ch]) { m->spurious++; return 0; }
+    mock_check_intact(m, ch);
+    if (m->stall[ch]) { mock_log(m, 'X', ch); return -1; }
+    m->busy[ch] = false;
+    mock_log(m, 'W', ch);
+    return 0;
+}
+
+static void mock_abort(void *ctx, int ch)
+{
+    mock_rmt *m = (mock_rmt *)ctx;
+    if (!m->busy[ch]) { m->spurious++; return; }
+    mock_check_intact(m, ch);
+    m->busy[ch] = false;
+    m->stall[ch] = false;
+    mock_log(m, 'A', ch);
+}
+
+static led_tx_ops mock_ops(mock_rmt *m)
+{
+    led_tx_ops ops = { mock_transmit, mock_wait, mock_abort, m };
+    return ops;
+}
+
+// Pixel i of channel ch gets a distinct color so buffers can't be confused.
+static void fill_pattern(CRGB *buf, int n, int ch, int frame)
+{
+    for (int i = 0; i < n; i++)
+        buf[i] = CRGB((uint8_t)(ch * 40 + i), (uint8_t)(frame * 7 + i), (uint8_t)(200 - i));
+}
+
+static int index_of(const mock_rmt *m, char op, int ch)
+{
+    for (int i = 0; i < m->nev; i++)
+        if (m->ev[i].op == op && m->ev[i].ch == ch) return i;
+    return -1;
+}
+
+static void push_frame(led_stage *st, const led_tx_ops *ops, CRGB bufs[4][16], const int counts[4])
+{
+    for (int ch = 0; ch < 4; ch++)
+        led_stage_load(st, ops, ch, bufs[ch], counts[ch]);
+    led_stage_kick(st, ops);
+    led_stage_wait(st, ops, 100);
+}
+
+
+static void test_grb_conversion()
+{
+    mock_rmt m = {};
+    led_tx_ops ops = mock_ops(&m);
+    led_stage st;
+    int caps[4] = { 16, 16, 16, 16 };
+    CHECK(led_stage_init(&st, caps));
+
+    CRGB px[3] = { CRGB(1, 2, 3), CRGB(4, 5, 6), CRGB(7, 8, 9) };
+    led_stage_load(&st, &ops, 0, px, 3);
+    CHECK_EQ(led_stage_kick(&st, &ops), 1);
+
+    const uint8_t want[9] = { 2, 1, 3, 5, 4, 6, 8, 7, 9 };
+    CHECK_EQ(m.len[0], 9);
+    CHECK(memcmp(m.snap[0], want, 9) == 0);
+
+    led_stage_wait(&st, &ops, 100);
+    CHECK_EQ(st.stats[0].frames, 1);
+    led_stage_free(&st);
+}
+
+static void test_all_channels_start_before_any_wait()
+{
+    mock_rmt m = {};
+    led_tx_ops ops = mock_ops(&m);
+    led_stage st;
+    int caps[4] = { 16, 16, 16, 16 };
+    led_stage_init(&st, caps);
+
+    CRGB bufs[4][16];
+    int counts[4] = { 16, 8, 12, 4 };
+    for (int ch = 0; ch < 4; ch++) fill_pattern(bufs[ch], 16, ch, 0);
+    push_frame(&st, &ops, bufs, counts);
+
+    // T0 T1 T2 T3 W0 W1 W2 W3: every string is clocking out before we block.
+    CHECK_EQ(m.nev, 8);
+    for (int ch = 0; ch < 4; ch++) {
+        CHECK_EQ(m.ev[ch].op, 'T');
+        CHECK_EQ(m.ev[ch].ch, ch);
+        CHECK_EQ(m.ev[4 + ch].op, 'W');
+        CHECK_EQ(m.ev[4 + ch].ch, ch);
+        CHECK_EQ(m.len[ch], counts[ch] * 3);
+    }
+    CHECK_EQ(m.corrupt, 0);
+    CHECK_EQ(m.overlap, 0);
+    CHECK_EQ(m.spurious, 0);
+    led_stage_free(&st);
+}
+
+static void test_buffers_distinct_and_stable()
+{
+    mock_rmt m = {};
+    led_tx_ops ops = mock_ops(&m);
+    led_stage st;
+    int caps[4] = { 16, 16, 16, 16 };
+    led_stage_init(&st, caps);
+
+    CRGB bufs[4][16];
+    int counts[4] = { 16, 16, 16, 16 };
+    const uint8_t *first[4];
+
+    for (int frame = 0; frame < 5; frame++) {
+        for (int ch = 0; ch < 4; ch++) fill_pattern(bufs[ch], 16, ch, frame);
+        m.nev = 0;
+        push_frame(&st, &ops, bufs, counts);
+        for (int ch = 0; ch < 4; ch++) {
+            if (frame == 0) first[ch] = m.ptr[ch];
+            CHECK(m.ptr[ch] == first[ch]);          // never reallocated
+            CHECK_EQ(m.snap[ch][1], bufs[ch][0].r); // each frame's data, own channel
+        }
+    }
+    // No two channels share or overlap a staging buffer.
+    for (int a = 0; a < 4; a++)
+        for (int b = a + 1; b < 4; b++)
+            CHECK(first[a] + 16 * 3 <= first[b] || first[b] + 16 * 3 <= first[a]);
+
+    CHECK_EQ(m.corrupt, 0);
+    for (int ch = 0; ch < 4; ch++) CHECK_EQ(st.stats[ch].frames, 5);
+    led_stage_free(&st);
+}
+
+static void test_reload_waits_for_inflight()
+{
+    mock_rmt m = {};
+    led_tx_ops ops = mock_ops(&m);
+    led_stage st;
+    int caps[4] = { 16, 16, 0, 0 };
+    led_stage_init(&st, caps);
+
+    CRGB a[16], b[16];
+    fill_pattern(a, 16, 1, 0);
+    fill_pattern(b, 16, 1, 1);
+
+    // Kick without waiting, then restage channel 1 while it is still busy.
+    led_stage_load(&st, &ops, 1, a, 16);
+    led_stage_kick(&st, &ops);
+    CHECK(m.busy[1]);
+    led_stage_load(&st, &ops, 1, b, 16);
+
+    // The load must have completed the old transmit before overwriting.
+    int t = index_of(&m, 'T', 1), w = index_of(&m, 'W', 1);
+    CHECK(t >= 0 && w > t);
+    CHECK_EQ(m.corrupt, 0);
+
+    led_stage_kick(&st, &ops);
+    CHECK_EQ(m.overlap, 0);
+    CHECK_EQ(m.snap[1][0], b[0].g);
+    led_stage_wait(&st, &ops, 100);
+    CHECK_EQ(st.stats[1].frames, 2);
+    led_stage_free(&st);
+}
+
+static void test_stalled_channel_aborted()
+{
+    mock_rmt m = {};
+    led_tx_ops ops = mock_ops(&m);
+    led_stage st;
+    int caps[4] = { 16, 16, 16, 16 };
+    led_stage_init(&st, caps);
+
+    CRGB bufs[4][16];
+    int counts[4] = { 16, 16, 16, 16 };
+    for (int ch = 0; ch < 4; ch++) fill_pattern(bufs[ch], 16, ch, 0);
+
+    m.stall[2] = true;
+    push_frame(&st, &ops, bufs, counts);
+    CHECK(index_of(&m, 'X', 2) >= 0);
+    CHECK(index_of(&m, 'A', 2) > index_of(&m, 'X', 2));
+    CHECK(!m.busy[2]);
+    CHECK_EQ(st.stats[2].timeouts, 1);
+    CHECK_EQ(st.stats[2].frames, 0);
+    CHECK_EQ(st.stats[3].frames, 1);        // later channels still completed
+
+    // Next frame the channel is usable again.
+    push_frame(&st, &ops, bufs, counts);
+    CHECK_EQ(st.stats[2].frames, 1);
+    CHECK_EQ(m.overlap, 0);
+    CHECK_EQ(m.corrupt, 0);
+    led_stage_free(&st);
+}
+
+static void test_transmit_error_not_waited()
+{
+    mock_rmt m = {};
+    led_tx_ops ops = mock_ops(&m);
+    led_stage st;
+    int caps[4] = { 16, 16, 16, 16 };
+    led_stage_init(&st, caps);
+
+    CRGB bufs[4][16];
+    int counts[4] = { 16, 16, 16, 16 };
+    for (int ch = 0; ch < 4; ch++) fill_pattern(bufs[ch], 16, ch, 0);
+
+    m.fail_tx[0] = true;
+    push_frame(&st, &ops, bufs, counts);
+    CHECK_EQ(st.stats[0].errors, 1);
+    CHECK_EQ(index_of(&m, 'W', 0), -1);
+    CHECK_EQ(m.spurious, 0);
+    CHECK_EQ(st.stats[1].frames, 1);
+    led_stage_free(&st);
+}
+
+static void test_clamp_and_skip()
+{
+    mock_rmt m = {};
+    led_tx_ops ops = mock_ops(&m);
+    led_stage st;
+    int caps[4] = { 4, 16, 0, 16 };
+    led_stage_init(&st, caps);
+
+    CRGB bufs[4][16];
+    for (int ch = 0; ch < 4; ch++) fill_pattern(bufs[ch], 16, ch, 0);
+
+    led_stage_load(&st, &ops, 0, bufs[0], 16);     // clamped to capacity
+    led_stage_load(&st, &ops, 1, bufs[1], 0);      // empty
+    led_stage_load(&st, &ops, 2, bufs[2], 16);     // no buffer
+    led_stage_load(&st, &ops, 3, nullptr, 16);     // no source
+    CHECK_EQ(led_stage_kick(&st, &ops), 1);
+    CHECK_EQ(m.len[0], 4 * 3);
+    CHECK_EQ(index_of(&m, 'T', 1), -1);
+    CHECK_EQ(index_of(&m, 'T', 2), -1);
+    CHECK_EQ(index_of(&m, 'T', 3), -1);
+    led_stage_wait(&st, &ops, 100);
+    led_stage_free(&st);
+}
+
+static int count_ops(const mock_rmt *m, char op, int ch)
+{
+    int n = 0;
+    for (int i = 0; i < m->nev; i++)
+        if (m->ev[i].op == op && m->ev[i].ch == ch) n++;
+    return n;
+}
+
+static void update_frame(led_stage *st, const led_tx_ops *ops, CRGB bufs[4][16], const int counts[4])
+{
+    for (int ch = 0; ch < 4; ch++)
+        led_stage_update(st, ops, ch, bufs[ch], counts[ch]);
+    led_stage_kick(st, ops);
+    led_stage_wait(st, ops, 100);
+}
+
+static void test_unchanged_channels_not_sent()
+{
+    mock_rmt m = {};
+    led_tx_ops ops = mock_ops(&m);
+    led_stage st;
+    int caps[4] = { 16, 16, 16, 16 };
+    led_stage_init(&st, caps);
+
+    CRGB bufs[4][16];
+    int counts[4] = { 16, 16, 16, 16 };
+    for (int ch = 0; ch < 4; ch++) fill_pattern(bufs[ch], 16, ch, 0);
+
+    update_frame(&st, &ops, bufs, counts);          // first frame: everything
+    for (int ch = 0; ch < 4; ch++) CHECK_EQ(count_ops(&m, 'T', ch), 1);
+
+    // Only channel 1 animates; a single changed pixel is enough to send it.
+    for (int f = 1; f <= 5; f++) {
+        bufs[1][15].b = (uint8_t)f;
+        update_frame(&st, &ops, bufs, counts);
+    }
+    CHECK_EQ(count_ops(&m, 'T', 1), 6);
+    CHECK_EQ(count_ops(&m, 'T', 0), 1);
+    CHECK_EQ(count_ops(&m, 'T', 3), 1);
+    CHECK_EQ(st.stats[0].skipped, 5);
+    CHECK_EQ(st.stats[1].skipped, 0);
+
+    // A length change is a change even when the common pixels match.
+    counts[2] = 8;
+    update_frame(&st, &ops, bufs, counts);
+    CHECK_EQ(count_ops(&m, 'T', 2), 2);
+    CHECK_EQ(m.len[2], 8 * 3);
+
+    // led_stage_load always sends (the periodic full refresh).
+    for (int ch = 0; ch < 4; ch++)
+        led_stage_load(&st, &ops, ch, bufs[ch], counts[ch]);
+    CHECK_EQ(led_stage_kick(&st, &ops), 4);
+    led_stage_wait(&st, &ops, 100);
+
+    // led_stage_skip stages nothing without converting.
+    for (int ch = 0; ch < 4; ch++) led_stage_skip(&st, ch);
+    CHECK_EQ(led_stage_kick(&st, &ops), 0);
+    CHECK_EQ(st.stats[0].skipped, 7);               // 5 + the length-change frame + this one
+    CHECK_EQ(m.corrupt, 0);
+    led_stage_free(&st);
+}
+
+static void test_failed_frame_resent()
+{
+    // After a timeout or a refused transmit the strip's state is unknown, so
+    // the same frame is sent again rather than skipped.
+    mock_rmt m = {};
+    led_tx_ops ops = mock_ops(&m);
+    led_stage st;
+    int caps[4] = { 16, 16, 16, 16 };
+    led_stage_init(&st, caps);
+
+    CRGB bufs[4][16];
+    int counts[4] = { 16, 16, 0, 0 };
+    for (int ch = 0; ch < 4; ch++) fill_pattern(bufs[ch], 16, ch, 0);
+
+    m.stall[0] = true;
+    m.fail_tx[1] = true;
+    update_frame(&st, &ops, bufs, counts);
+    m.fail_tx[1] = false;
+    update_frame(&st, &ops, bufs, counts);
+    CHECK_EQ(count_ops(&m, 'T', 0), 2);
+    CHECK_EQ(count_ops(&m, 'T', 1), 1);
+    CHECK_EQ(st.stats[0].frames, 1);
+    CHECK_EQ(st.stats[1].frames, 1);
+
+    update_frame(&st, &ops, bufs, counts);          // now both are known good
+    CHECK_EQ(count_ops(&m, 'T', 0), 2);
+    CHECK_EQ(count_ops(&m, 'T', 1), 1);
+    CHECK_EQ(st.stats[0].skipped, 1);
+    CHECK_EQ(st.stats[2].skipped, 0);               // empty channel isn't "skipped"
+    led_stage_free(&st);
+}
+
+
+int main()
+{
+    printf("=== led_stage host tests ===\n");
+    RUN(test_grb_conversion);
+    RUN(test_all_channels_start_before_any_wait);
+    RUN(test_buffers_distinct_and_stable);
+    RUN(test_reload_waits_for_inflight);
+    RUN(test_stalled_channel_aborted);
+    RUN(test_transmit_error_not_waited);
+    RUN(test_clamp_and_skip);
+    RUN(test_unchanged_channels_not_sent);
+    RUN(test_failed_frame_resent);
+    return DONE("led_stage");
+}
@@ -0,0 +1,227 @@
+// Host test for psram_core: burst sizing against tCEM and device pages,
+// write-back page cache coherence (against a shadow copy), page pinning,
+// and the free-list allocator's splitting and merging.
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "psram_core.h"
+#include "host_test.h"
+
+#define CHIP_SIZE (1024 * 1024)
+
+struct mock_chip {
+    std::vector<uint8_t> mem;
+    int  bursts;
+    int  max_len;
+    bool crossed_page;
+};
+
+static void check_burst(mock_chip *c, uint32_t addr, size_t len)
+{
+    c->bursts++;
+    if ((int)len > c->max_len) c->max_len = (int)len;
+    if (addr / PSRAM_DEVICE_PAGE != (addr + len - 1) / PSRAM_DEVICE_PAGE) c->crossed_page = true;
+}
+
+static void mc_read(void *ctx, uint32_t addr, uint8_t *buf, size_t len)
+{
+    mock_chip *c = (mock_chip *)ctx;
+    check_burst(c, addr, len);
+    memcpy(buf, &c->mem[addr], len);
+}
+
+static void mc_write(void *ctx, uint32_t addr, const uint8_t *buf, size_t len)
+{
+    mock_chip *c = (mock_chip *)ctx;
+    check_burst(c, addr, len);
+    memcpy(&c->mem[addr], buf, len);
+}
+
+static const psram_chip_ops mc_ops = { mc_read, mc_write };
+
+static psram_core pc;       // ~33 KB with the cache: keep it off the stack
+
+static void setup(mock_chip *c, uint32_t freq)
+{
+    c->mem.assign(CHIP_SIZE, 0);
+    c->bursts = 0;
+    c->max_len = 0;
+    c->crossed_page = false;
+    psram_core_init(&pc, CHIP_SIZE, &mc_ops, c);
+    psram_core_set_freq(&pc, freq);
+}
+
+
+static void test_burst_sizing()
+{
+    mock_chip c;
+    setup(&c, 40000000);
+    CHECK(pc.fast_read);
+    CHECK_EQ(pc.read_chunk, 30);        // 35 bytes per 7 us, minus cmd/addr/wait
+    CHECK_EQ(pc.write_chunk, 31);
+
+    psram_core_set_freq(&pc, 20000000);
+    CHECK(!pc.fast_read);
+    CHECK_EQ(pc.read_chunk, 13);
+
+    psram_core_set_freq(&pc, 80000000);
+    CHECK_EQ(pc.read_chunk, 64);        // FIFO-bound
+    CHECK_EQ(pc.write_chunk, 64);
+
+    // An unaligned transfer across two device pages never spans one
+    psram_core_set_freq(&pc, 40000000);
+    uint8_t buf[3000];
+    for (int i = 0; i < (int)sizeof(buf); i++) buf[i] = (uint8_t)(i * 7);
+    psram_core_raw_write(&pc, 1002, buf, sizeof(buf));
+    uint8_t back[3000];
+    psram_core_raw_read(&pc, 1002, back, sizeof(back));
+    CHECK(memcmp(buf, back, sizeof(buf)) == 0);
+    CHECK(!c.crossed_page);
+    CHECK(c.max_len <= 31);
+}
+
+
+static void test_cache_coherence()
+{
+    mock_chip c;
+    setup(&c, 40000000);
+    std::vector<uint8_t> shadow(CHIP_SIZE, 0);
+    srand(1);
+
+    // Random reads and writes over twice the cache's reach: evictions and
+    // dirty write-backs on every pass
+    uint32_t span = 2 * PSRAM_CACHE_PAGES * PSRAM_CACHE_PAGE_SIZE;
+    bool ok = true;
+    for (int i = 0; i < 20000; i++) {
+        uint32_t addr = (uint32_t)rand() % (span - 16);
+        size_t len = 1 + rand() % 16;
+        uint8_t buf[16];
+        if (rand() & 1) {
+            for (size_t k = 0; k < len; k++) buf[k] = (uint8_t)rand();
+            psram_core_write(&pc, addr, buf, len);
+            memcpy(&shadow[addr], buf, len);
+        } else {
+            psram_core_read(&pc, addr, buf, len);
+            if (memcmp(buf, &shadow[addr], len) != 0) ok = false;
+        }
+    }
+    CHECK(ok);
+    CHECK(pc.hits > 0);
+    CHECK(pc.misses > 0);
+
+    // The chip catches up on flush, not before
+    CHECK(memcmp(c.mem.data(), shadow.data(), span) != 0);
+    psram_core_flush(&pc);
+    CHECK(memcmp(c.mem.data(), shadow.data(), span) == 0);
+
+    // Invalidate drops unflushed writes
+    uint8_t v = 0xAA;
+    psram_core_write(&pc, 100, &v, 1);
+    psram_core_invalidate(&pc);
+    psram_core_read(&pc, 100, &v, 1);
+    CHECK_EQ(v, shadow[100]);
+}
+
+
+static void test_cache_hits_sequential()
+{
+    mock_chip c;
+    setup(&c, 40000000);
+    uint8_t b;
+    for (uint32_t a = 0; a < 4096; a++) psram_core_read(&pc, a, &b, 1);
+    CHECK_EQ(pc.misses, 4096 / PSRAM_CACHE_PAGE_SIZE);
+    CHECK_EQ(pc.hits, 4096 - 4096 / PSRAM_CACHE_PAGE_SIZE);
+}
+
+
+static void test_pin()
+{
+    mock_chip c;
+    setup(&c, 40000000);
+    for (int i = 0; i < 4096; i++) c.mem[i] = (uint8_t)i;
+
+    // A pinned page is the cache line itself: reads through the cache see
+    // stores through the pointer
+    uint8_t *p = psram_core_pin(&pc, 1000, true);
+    CHECK(p != NULL);
+    CHECK_EQ(p[1000 - 512], (uint8_t)1000);
+    p[0] = 0x5A;
+    uint8_t v;
+    psram_core_read(&pc, 512, &v, 1);
+    CHECK_EQ(v, 0x5A);
+
+    // ...and survives eviction pressure and invalidate
+    uint8_t buf[16];
+    for (uint32_t a = 8192; a < 8192 + 4 * PSRAM_CACHE_PAGES * PSRAM_CACHE_PAGE_SIZE; a += PSRAM_CACHE_PAGE_SIZE)
+        psram_core_read(&pc, a, buf, sizeof(buf));
+    psram_core_invalidate(&pc);
+    CHECK(psram_core_pin(&pc, 600, false) == p);
+    psram_core_unpin(&pc, 600);
+
+    // Flush writes it back but keeps it dirty while pinned
+    psram_core_flush(&pc);
+    CHECK_EQ(c.mem[512], 0x5A);
+    p[1] = 0xA5;
+    psram_core_flush(&pc);
+    CHECK_EQ(c.mem[513], 0xA5);
+    psram_core_unpin(&pc, 512);
+    CHECK_EQ(pc.npinned, 0);
+
+    // The pin limit leaves pages to evict; extra holders of a pinned page are fine
+    int n = 0;
+    for (uint32_t a = 0; psram_core_pin(&pc, a, false); a += PSRAM_CACHE_PAGE_SIZE) n++;
+    CHECK_EQ(n, PSRAM_CACHE_PIN_MAX);
+    CHECK(psram_core_pin(&pc, 0, false) != NULL);
+    psram_core_read(&pc, 1024 * 1024 - 16, buf, sizeof(buf));
+    CHECK(pc.misses > 0);
+}
+
+
+static void test_alloc()
+{
+    mock_chip c;
+    setup(&c, 40000000);
+    uint32_t a, b, d;
+    CHECK(psram_core_alloc(&pc, 10, &a));
+    CHECK(psram_core_alloc(&pc, 100, &b));
+    CHECK(psram_core_alloc(&pc, 1000, &d));
+    CHECK_EQ(a, 0);
+    CHECK_EQ(b, 12);                    // 4-byte aligned
+    CHECK_EQ(d, 112);
+    CHECK_EQ(psram_core_alloc_count(&pc), 3);
+    CHECK_EQ(psram_core_bytes_used(&pc), 1112);
+
+    // Freeing the middle leaves a hole that first-fit reuses
+    CHECK(psram_core_free(&pc, b));
+    CHECK(!psram_core_free(&pc, b));
+    uint32_t e;
+    CHECK(psram_core_alloc(&pc, 40, &e));
+    CHECK_EQ(e, 12);
+
+    // Everything merges back into one block
+    CHECK(psram_core_free(&pc, e));
+    CHECK(psram_core_free(&pc, a));
+    CHECK(psram_core_free(&pc, d));
+    CHECK_EQ(pc.nblocks, 1);
+    CHECK_EQ(psram_core_bytes_contiguous(&pc), CHIP_SIZE);
+    CHECK(!psram_core_alloc(&pc, CHIP_SIZE + 4, &e));
+
+    // A full table refuses splits
+    int n = 0;
+    while (psram_core_alloc(&pc, 4, &e)) n++;
+    CHECK_EQ(n, PSRAM_ALLOC_ENTRIES - 1);
+    CHECK_EQ(psram_core_alloc_count(&pc), n);
+}
+
+
+int main()
+{
+    printf("=== psram_core host tests ===\n");
+    RUN(test_burst_sizing);
+    RUN(test_cache_coherence);
+    RUN(test_cache_hits_sequential);
+    RUN(test_pin);
+    RUN(test_alloc);
+    return DONE("psram_core");
+}
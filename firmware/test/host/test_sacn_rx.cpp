@@ -0,0 +1,393 @@
+// Host test for sacn_rx: E1.31 parsing, source arbitration, sequence
+// checking and universe sync, replay of recorded captures, and receive
+// throughput of the DMX ingest path for ArtNet and sACN.
+
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include "sacn_rx.h"
+#include "artnet_rx.h"
+#include "host_pcap.h"
+#include "host_test.h"
+
+#define CAPTURES "captures/"
+
+struct test_sink {
+    std::vector<CRGB> pix[DMX_CHANNELS];
+    std::vector<std::vector<CRGB>> shown;   // channel 0 at every commit
+};
+
+static CRGB *ts_buf(void *ctx, int ch, int *count)
+{
+    test_sink *s = (test_sink *)ctx;
+    *count = (int)s->pix[ch].size();
+    return *count ? s->pix[ch].data() : nullptr;
+}
+
+static void ts_commit(void *ctx)
+{
+    test_sink *s = (test_sink *)ctx;
+    s->shown.push_back(s->pix[0]);
+}
+
+// E1.31 data packet: source `src` (CID), all slots set to `value`.
+static size_t build_data(uint8_t *p, int src, int universe, uint8_t seq, uint8_t value,
+                         int slots, uint8_t priority = 100, uint16_t sync = 0,
+                         uint8_t options = 0, uint8_t start_code = 0)
+{
+    memset(p, 0, 126);
+    p[1] = 0x10;
+    memcpy(p + 4, "ASC-E1.17", 9);
+    p[16] = 0x72; p[17] = (uint8_t)(110 + slots);       // flags/length, not checked
+    p[21] = 0x04;
+    p[22] = 0xC0; p[23] = (uint8_t)src;
+    p[43] = 0x02;
+    snprintf((char *)p + 44, 64, "source %d", src);
+    p[108] = priority;
+    p[109] = (uint8_t)(sync >> 8); p[110] = (uint8_t)sync;
+    p[111] = seq;
+    p[112] = options;
+    p[113] = (uint8_t)(universe >> 8); p[114] = (uint8_t)universe;
+    p[117] = 0x02; p[118] = 0xA1;
+    p[122] = 0x01;
+    p[123] = (uint8_t)((slots + 1) >> 8); p[124] = (uint8_t)(slots + 1);
+    p[125] = start_code;
+    memset(p + 126, value, (size_t)slots);
+    return 126 + (size_t)slots;
+}
+
+static size_t build_sync(uint8_t *p, int src, uint16_t address)
+{
+    memset(p, 0, 49);
+    p[1] = 0x10;
+    memcpy(p + 4, "ASC-E1.17", 9);
+    p[21] = 0x08;
+    p[22] = 0xC0; p[23] = (uint8_t)src;
+    p[43] = 0x01;
+    p[45] = (uint8_t)(address >> 8); p[46] = (uint8_t)address;
+    return 49;
+}
+
+struct fixture {
+    sacn_rx   rx;
+    test_sink ts;
+    dmx_sink  sink;
+    uint8_t   pkt[126 + 512];
+
+    explicit fixture(const dmx_chan_map map[DMX_CHANNELS])
+    {
+        for (int ch = 0; ch < DMX_CHANNELS; ch++) ts.pix[ch].assign((size_t)map[ch].count, CRGB(0, 0, 0));
+        sink = { ts_buf, ts_commit, &ts };
+        sacn_rx_init(&rx);
+        sacn_rx_configure(&rx, map);
+    }
+
+    dmx_rx_result data(int src, int universe, uint8_t seq, uint8_t value, uint32_t ms,
+                       uint8_t priority = 100, uint16_t sync = 0, uint8_t options = 0)
+    {
+        size_t n = build_data(pkt, src, universe, seq, value, 30, priority, sync, options);
+        return sacn_rx_packet(&rx, pkt, n, ms, &sink);
+    }
+
+    dmx_rx_result sync(int src, uint16_t address, uint32_t ms)
+    {
+        size_t n = build_sync(pkt, src, address);
+        return sacn_rx_packet(&rx, pkt, n, ms, &sink);
+    }
+};
+
+
+static void test_parse()
+{
+    dmx_chan_map map[DMX_CHANNELS] = { { 5, 4, 9 }, {}, {}, {} };
+    fixture f(map);
+    CHECK_EQ(f.data(1, 5, 1, 42, 1000), DMX_RX_COMMITTED);
+    CHECK(f.ts.pix[0][0] == CRGB(42, 42, 42));
+    CHECK_EQ(f.rx.in.uni[0].packets, 1);
+
+    uint8_t *p = f.pkt;
+    size_t n = build_data(p, 1, 5, 2, 1, 30);
+    p[4] = 'X';                                                 // ACN identifier
+    CHECK_EQ(sacn_rx_packet(&f.rx, p, n, 1001, &f.sink), DMX_RX_INVALID);
+    n = build_data(p, 1, 5, 2, 1, 30);
+    p[43] = 0x03;                                               // framing vector
+    CHECK_EQ(sacn_rx_packet(&f.rx, p, n, 1001, &f.sink), DMX_RX_INVALID);
+    n = build_data(p, 1, 0, 2, 1, 30);                          // universe 0
+    CHECK_EQ(sacn_rx_packet(&f.rx, p, n, 1001, &f.sink), DMX_RX_INVALID);
+    n = build_data(p, 1, 5, 2, 1, 30);
+    CHECK_EQ(sacn_rx_packet(&f.rx, p, n - 1, 1001, &f.sink), DMX_RX_INVALID);  // truncated
+    CHECK_EQ(f.rx.in.st.invalid, 4);
+
+    n = build_data(p, 1, 6, 2, 1, 30);                          // unmapped universe
+    CHECK_EQ(sacn_rx_packet(&f.rx, p, n, 1001, &f.sink), DMX_RX_IGNORED);
+    n = build_data(p, 1, 5, 2, 1, 30, 100, 0, 0x80);            // preview data
+    CHECK_EQ(sacn_rx_packet(&f.rx, p, n, 1001, &f.sink), DMX_RX_IGNORED);
+    n = build_data(p, 1, 5, 2, 1, 30, 100, 0, 0, 0xDD);         // per-address priority
+    CHECK_EQ(sacn_rx_packet(&f.rx, p, n, 1001, &f.sink), DMX_RX_IGNORED);
+    CHECK(f.ts.pix[0][0] == CRGB(42, 42, 42));
+    CHECK_EQ(f.rx.in.st.ignored, 3);
+
+    // Multicast group of a universe
+    CHECK_EQ(sacn_multicast_addr(1), 0xEFFF0001u);
+    CHECK_EQ(sacn_multicast_addr(63999), 0xEFFFF9FFu);
+}
+
+static void test_arbitration()
+{
+    dmx_chan_map map[DMX_CHANNELS] = { { 1, 1, 10 }, {}, {}, {} };
+    fixture f(map);
+    sacn_universe *su = &f.rx.uni[0];
+
+    CHECK_EQ(f.data(1, 1, 1, 10, 1000), DMX_RX_COMMITTED);         // A, 100
+    CHECK_EQ(f.data(3, 1, 1, 30, 1001), DMX_RX_IGNORED);           // C, 100: A keeps the tie
+    CHECK_EQ(f.data(2, 1, 1, 20, 1002, 150), DMX_RX_COMMITTED);    // B, 150 takes over
+    CHECK_EQ(f.data(1, 1, 2, 10, 1020), DMX_RX_IGNORED);
+    CHECK(f.ts.pix[0][0] == CRGB(20, 20, 20));
+    CHECK_EQ(su->sources, 3);
+    CHECK_EQ(su->outranked, 2);
+
+    // B ends its stream: the universe goes back to a priority-100 source
+    CHECK_EQ(f.data(2, 1, 2, 20, 1030, 150, 0, 0x40), DMX_RX_IGNORED);
+    CHECK_EQ(su->terminated, 1);
+    CHECK_EQ(f.data(1, 1, 3, 11, 1040), DMX_RX_COMMITTED);
+    CHECK(f.ts.pix[0][0] == CRGB(11, 11, 11));
+
+    // A goes silent: after the data loss timeout C takes over
+    CHECK_EQ(f.data(3, 1, 2, 31, 1050), DMX_RX_IGNORED);
+    CHECK_EQ(f.data(3, 1, 3, 32, 1040 + SACN_SOURCE_TIMEOUT_MS - 1), DMX_RX_IGNORED);
+    CHECK_EQ(f.data(3, 1, 4, 33, 1040 + SACN_SOURCE_TIMEOUT_MS), DMX_RX_COMMITTED);
+    CHECK(f.ts.pix[0][0] == CRGB(33, 33, 33));
+    CHECK_EQ(su->sources, 1);
+
+    // More sources than slots: the extra one is not tracked
+    for (int s = 10; s < 10 + SACN_MAX_SOURCES; s++) f.data(s, 1, 1, 1, 5000);
+    CHECK_EQ(f.rx.overflow, 1);
+}
+
+static void test_sequence()
+{
+    dmx_chan_map map[DMX_CHANNELS] = { { 1, 1, 10 }, {}, {}, {} };
+    fixture f(map);
+    dmx_uni_stats *u = &f.rx.in.uni[0];
+    CHECK_EQ(f.data(1, 1, 100, 1, 1000), DMX_RX_COMMITTED);
+    CHECK_EQ(f.data(1, 1, 100, 2, 1001), DMX_RX_DROPPED);      // duplicate
+    CHECK_EQ(f.data(1, 1, 95, 2, 1002), DMX_RX_DROPPED);       // 5 behind: late
+    CHECK_EQ(f.data(1, 1, 103, 3, 1003), DMX_RX_COMMITTED);    // 101, 102 lost
+    CHECK_EQ(f.data(1, 1, 50, 4, 1004), DMX_RX_COMMITTED);     // far behind: restarted
+    CHECK_EQ(f.data(1, 1, 255, 5, 1005), DMX_RX_COMMITTED);    // 51..254 read as behind by 51: restart
+    CHECK_EQ(f.data(1, 1, 0, 6, 1006), DMX_RX_COMMITTED);      // 0 follows 255
+    CHECK_EQ(u->dups, 1);
+    CHECK_EQ(u->late, 1);
+    CHECK_EQ(u->lost, 2);
+
+    // Sequences are per source: another source's numbers don't interfere
+    CHECK_EQ(f.data(2, 1, 0, 7, 1007, 150), DMX_RX_COMMITTED);
+    CHECK_EQ(u->dups, 1);
+}
+
+static void test_sync()
+{
+    dmx_chan_map map[DMX_CHANNELS] = { { 1, 1, 10 }, {}, {}, {} };
+    fixture f(map);
+
+    // Naming a sync universe alone doesn't hold output...
+    CHECK_EQ(f.data(1, 1, 1, 1, 1000, 100, 7000), DMX_RX_COMMITTED);
+    CHECK_EQ(f.rx.sync_universe, 7000);
+    // ...but once sync packets come, frames wait for them
+    CHECK_EQ(f.sync(1, 7001, 1010), DMX_RX_IGNORED);           // other universe
+    CHECK(!f.rx.in.st.sync_mode);
+    CHECK_EQ(f.sync(1, 7000, 1020), DMX_RX_IGNORED);           // nothing pending
+    CHECK(f.rx.in.st.sync_mode);
+    CHECK_EQ(f.data(1, 1, 2, 2, 1030, 100, 7000), DMX_RX_STAGED);
+    CHECK_EQ(f.data(1, 1, 3, 3, 1040, 100, 7000), DMX_RX_STAGED);
+    CHECK_EQ(f.sync(1, 7000, 1050), DMX_RX_COMMITTED);
+    CHECK(f.ts.shown.back()[0] == CRGB(3, 3, 3));
+
+    // The sender stops synchronizing
+    CHECK_EQ(f.data(1, 1, 4, 4, 1060), DMX_RX_COMMITTED);
+    CHECK(!f.rx.in.st.sync_mode);
+
+    // Sync packets that stop: back to completion after the timeout
+    f.data(1, 1, 5, 5, 1070, 100, 7000);
+    f.sync(1, 7000, 1080);
+    CHECK_EQ(f.data(1, 1, 6, 6, 1090, 100, 7000), DMX_RX_STAGED);
+    dmx_ingest_poll(&f.rx.in, 1080 + SACN_SOURCE_TIMEOUT_MS + 1, &f.sink);
+    CHECK(!f.rx.in.st.sync_mode);
+}
+
+static void test_paced_frames()
+{
+    // Universes 1-3 spread over the frame period, 5 and 15 ms apart at
+    // 25 Hz with a few ms of jitter, joined mid-frame, universe 1 lost once
+    // (its sequence skips). Only the frame joined in and the one missing
+    // universe 1 are partial; every other commit is one whole frame.
+    dmx_chan_map map[DMX_CHANNELS] = { { 1, 1, 510 }, {}, {}, {} };
+    fixture f(map);
+    static const uint32_t at[3] = { 0, 5, 20 };
+    for (int fr = 0; fr < 40; fr++) {
+        for (int u = 0; u < 3; u++) {
+            if ((fr == 0 || fr == 20) && u == 0) continue;
+            uint32_t t = 1000 + (uint32_t)fr * 40 + at[u] + (uint32_t)((fr * 7 + u * 3) % 4);
+            size_t n = build_data(f.pkt, 1, 1 + u, (uint8_t)fr, (uint8_t)fr, 510);
+            sacn_rx_packet(&f.rx, f.pkt, n, t, &f.sink);
+        }
+    }
+    CHECK_EQ(f.rx.in.st.frames, 41);
+    CHECK_EQ(f.rx.in.st.partial, 2);
+    CHECK_EQ(f.rx.in.uni[0].lost, 1);
+    int whole = 0;
+    for (auto &fr : f.ts.shown)
+        if (fr[0] == fr[170] && fr[0] == fr[509]) whole++;
+    CHECK_EQ(whole, 40);
+    CHECK(f.ts.shown.back()[509] == CRGB(39, 39, 39));
+}
+
+
+static bool replay(fixture &f, const char *path)
+{
+    host_pcap cap;
+    if (!host_pcap_open(&cap, path)) {
+        host_pcap_close(&cap);
+        return false;
+    }
+    host_pcap_pkt p;
+    while (host_pcap_next(&cap, &p)) {
+        if (p.dport != SACN_PORT) continue;
+        uint32_t now = (uint32_t)(p.ts_us / 1000);
+        dmx_ingest_poll(&f.rx.in, now, &f.sink);
+        sacn_rx_packet(&f.rx, p.data, p.len, now, &f.sink);
+    }
+    host_pcap_close(&cap);
+    return true;
+}
+
+static void test_capture_sources()
+{
+    // Sources A and C at priority 100, B at 150 for frames 10-24, then
+    // terminated (see captures/gen_sacn.py). Pixels carry (frame,
+    // universe, source).
+    dmx_chan_map map[DMX_CHANNELS] = { { 1, 1, 200 }, {}, {}, {} };
+    fixture f(map);
+    CHECK(replay(f, CAPTURES "sacn_sources.pcap"));
+
+    int from_a = 0, from_b = 0, mixed = 0;
+    for (size_t i = 1; i < f.ts.shown.size(); i++) {
+        const std::vector<CRGB> &fr = f.ts.shown[i];
+        CHECK(fr[0].b != 3 && fr[0].b != 4);                    // C never, preview never
+        if (fr[0].b == 1 && fr[199].b == 1) from_a++;
+        if (fr[0].b == 2 && fr[199].b == 2) from_b++;
+        if (fr[0].r != fr[199].r) mixed++;
+    }
+    CHECK_EQ(from_b, 15);
+    CHECK(from_a >= 23);
+    CHECK(f.ts.shown.back()[0] == CRGB(39, 1, 1));
+    CHECK(f.ts.shown.back()[199] == CRGB(39, 2, 1));
+    CHECK_EQ(mixed, 0);
+
+    for (int u = 0; u < 2; u++) {
+        CHECK_EQ(f.rx.uni[u].terminated, 1);
+        CHECK_EQ(f.rx.uni[u].switches, 3);                    // A, B, A again
+        CHECK_EQ(f.rx.uni[u].sources, 2);
+    }
+    CHECK_EQ(f.rx.in.uni[0].late, 1);
+    CHECK_EQ(f.rx.in.uni[0].lost, 0);
+}
+
+static void test_capture_sync()
+{
+    // 20 frames over universes 10-11 synchronized on 7000, then 10 without.
+    dmx_chan_map map[DMX_CHANNELS] = { { 10, 1, 340 }, {}, {}, {} };
+    fixture f(map);
+    CHECK(replay(f, CAPTURES "sacn_sync.pcap"));
+    CHECK_EQ(f.rx.in.st.syncs, 20);
+    CHECK_EQ(f.rx.in.st.frames, 1 + 20 + 10);
+    CHECK(!f.rx.in.st.sync_mode);
+    for (size_t i = 1; i < f.ts.shown.size(); i++)
+        CHECK(f.ts.shown[i][0].r == f.ts.shown[i][339].r);
+    CHECK(f.ts.shown.back()[0] == CRGB(29, 10, 5));
+}
+
+
+// 32 universes at 44 Hz -- four channels of 1360 pixels, eight universes
+// each -- for 60 s of traffic. Every frame after the first (which only
+// learns the universes) must come out whole, and the parse + ingest path
+// must keep up with plenty of room to spare.
+static void throughput(const char *proto, bool sacn)
+{
+    const int frames = 44 * 60, nuni = 32, npix = 8 * DMX_PIXELS_PER_UNIVERSE;
+    dmx_chan_map map[DMX_CHANNELS];
+    for (int ch = 0; ch < DMX_CHANNELS; ch++) map[ch] = { 1 + ch * 8, 1, npix };
+
+    // Count commits instead of keeping every frame
+    static test_sink ts;
+    for (int ch = 0; ch < DMX_CHANNELS; ch++) ts.pix[ch].assign(npix, CRGB(0, 0, 0));
+    static int commits;
+    commits = 0;
+    dmx_sink sink = { ts_buf, [](void *) { commits++; }, &ts };
+
+    static sacn_rx sr;
+    static dmx_ingest ar;
+    dmx_ingest *in;
+    if (sacn) { sacn_rx_init(&sr); sacn_rx_configure(&sr, map); in = &sr.in; }
+    else      { artnet_rx_init(&ar); dmx_ingest_configure(&ar, map); in = &ar; }
+
+    static uint8_t pkts[32][126 + 512];
+    size_t lens[32];
+    for (int u = 0; u < nuni; u++) {
+        if (sacn) {
+            lens[u] = build_data(pkts[u], 1, 1 + u, 0, (uint8_t)u, 510);
+        } else {
+            uint8_t *p = pkts[u];
+            memcpy(p, "Art-Net", 8);
+            p[8] = 0x00; p[9] = 0x50; p[10] = 0; p[11] = 14; p[13] = 0;
+            p[14] = (uint8_t)(1 + u); p[15] = 0; p[16] = 510 >> 8; p[17] = 510 & 0xFF;
+            memset(p + 18, u, 510);
+            lens[u] = 18 + 510;
+        }
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int f = 0; f < frames; f++) {
+        uint32_t now = 1000 + (uint32_t)(f * 1000 / 44);
+        uint8_t seq = (uint8_t)(f % 255 + 1);
+        for (int u = 0; u < nuni; u++) {
+            pkts[u][sacn ? 111 : 12] = seq;
+            pkts[u][sacn ? 126 : 18] = (uint8_t)f;          // first slot carries the frame
+            if (sacn) sacn_rx_packet(&sr, pkts[u], lens[u], now, &sink);
+            else      artnet_rx_packet(&ar, pkts[u], lens[u], now, &sink);
+            dmx_ingest_poll(in, now, &sink);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double secs = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
+    double pps = (double)frames * nuni / (secs > 0 ? secs : 1e-9);
+    printf("        %s: %d packets in %.1f ms, %.0f packets/s (need %d)\n",
+           proto, frames * nuni, secs * 1000, pps, 44 * nuni);
+
+    CHECK_EQ(commits, frames + 1);
+    CHECK_EQ(in->st.frames, frames + 1);
+    CHECK_EQ(in->st.partial, 1);
+    CHECK_EQ(in->st.packets, frames * nuni);
+    CHECK(ts.pix[3][npix - 1] == CRGB(31, 31, 31));
+    CHECK(pps > 20.0 * 44 * nuni);
+}
+
+static void test_throughput_sacn()   { throughput("sACN", true); }
+static void test_throughput_artnet() { throughput("ArtNet", false); }
+
+
+int main()
+{
+    printf("=== sacn_rx host tests ===\n");
+    RUN(test_parse);
+    RUN(test_arbitration);
+    RUN(test_sequence);
+    RUN(test_sync);
+    RUN(test_paced_frames);
+    RUN(test_capture_sources);
+    RUN(test_capture_sync);
+    RUN(test_throughput_sacn);
+    RUN(test_throughput_artnet);
+    return DONE("sacn_rx");
+}
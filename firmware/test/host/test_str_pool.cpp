@@ -0,0 +1,200 @@
+// Host test for str_pool, the WASM host string pool's bookkeeping: size
+// classes, O(1) reuse, splitting, giving the top block back to the bump
+// pointer, merging on demand, rejecting bad frees, and stats under random
+// churn.
+
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include "str_pool.h"
+#include "host_test.h"
+
+#define BASE 0x8000
+
+static str_pool sp;
+
+
+static void test_classes()
+{
+    CHECK(str_pool_init(&sp, BASE, 28 * 1024));
+    CHECK_EQ(sp.st.size, 28 * 1024);
+    CHECK_EQ(str_pool_alloc(&sp, 1), BASE);
+    CHECK_EQ(str_pool_alloc(&sp, 17), BASE + 16);
+    CHECK_EQ(str_pool_alloc(&sp, 100), BASE + 48);
+    CHECK_EQ(str_pool_block_size(&sp, BASE), 16);
+    CHECK_EQ(str_pool_block_size(&sp, BASE + 16), 32);
+    CHECK_EQ(str_pool_block_size(&sp, BASE + 48), 128);
+    CHECK_EQ(sp.st.used, 176);
+    CHECK_EQ(sp.st.blocks, 3);
+
+    // Bigger than the pool, or than any class
+    CHECK_EQ(str_pool_alloc(&sp, 28 * 1024), 0);
+    CHECK_EQ(str_pool_alloc(&sp, 0x7FFFFFFF), 0);
+    CHECK_EQ(sp.st.fails, 2);
+    str_pool_release(&sp);
+}
+
+
+static void test_free()
+{
+    str_pool_init(&sp, BASE, 4096);
+    uint32_t a = str_pool_alloc(&sp, 20);
+    uint32_t b = str_pool_alloc(&sp, 20);
+    uint32_t c = str_pool_alloc(&sp, 20);
+
+    // Only the start of a live block frees
+    CHECK_EQ(str_pool_free(&sp, a + 16), 0);
+    CHECK_EQ(str_pool_free(&sp, a + 4), 0);
+    CHECK_EQ(str_pool_free(&sp, 0x100), 0);
+    CHECK_EQ(str_pool_free(&sp, BASE + 4096), 0);
+    CHECK_EQ(str_pool_free(&sp, c + 32), 0);     // past the bump pointer
+    CHECK_EQ(str_pool_free(&sp, b), 32);
+    CHECK_EQ(str_pool_free(&sp, b), 0);
+    CHECK_EQ(str_pool_block_size(&sp, b), 0);
+    CHECK_EQ(sp.st.free_listed, 32);
+
+    // Its class reuses it first
+    CHECK_EQ(str_pool_alloc(&sp, 32), b);
+    CHECK_EQ(sp.st.free_listed, 0);
+
+    // Freeing the top block gives it back to the bump pointer
+    CHECK_EQ(str_pool_free(&sp, c), 32);
+    CHECK_EQ(sp.st.free_listed, 0);
+    CHECK_EQ(str_pool_alloc(&sp, 64), c);
+    CHECK_EQ(sp.st.peak, 128);
+    str_pool_release(&sp);
+}
+
+
+static void test_split()
+{
+    str_pool_init(&sp, BASE, 512);
+    uint32_t a = str_pool_alloc(&sp, 256);
+    uint32_t b = str_pool_alloc(&sp, 256);
+    CHECK(a && b);
+    CHECK_EQ(str_pool_alloc(&sp, 16), 0);
+    str_pool_free(&sp, a);
+
+    // A 16-byte request splits the free 256: one block of each smaller
+    // class is left, and each is found without another split
+    CHECK_EQ(str_pool_alloc(&sp, 16), a);
+    CHECK_EQ(sp.st.free_listed, 240);
+    CHECK_EQ(str_pool_alloc(&sp, 128), a + 128);
+    CHECK_EQ(str_pool_alloc(&sp, 16), a + 16);
+    CHECK_EQ(str_pool_alloc(&sp, 64), a + 64);
+    CHECK_EQ(str_pool_alloc(&sp, 32), a + 32);
+    CHECK_EQ(sp.st.free_listed, 0);
+    CHECK_EQ(sp.st.used, 512);
+    CHECK_EQ(str_pool_alloc(&sp, 1), 0);
+    str_pool_release(&sp);
+}
+
+
+static void test_coalesce()
+{
+    str_pool_init(&sp, BASE, 512);
+    uint32_t p[32];
+    for (int i = 0; i < 32; i++) p[i] = str_pool_alloc(&sp, 16);
+    CHECK_EQ(p[31], BASE + 496);
+
+    // Every other block free: the space is there, but in no one block
+    for (int i = 0; i < 32; i += 2) str_pool_free(&sp, p[i]);
+    CHECK_EQ(sp.st.free_listed, 256);
+    CHECK_EQ(str_pool_alloc(&sp, 32), 0);
+    CHECK_EQ(sp.st.coalesces, 1);
+    CHECK_EQ(sp.st.fails, 1);
+    CHECK_EQ(sp.st.free_listed, 256);
+    CHECK_EQ(str_pool_alloc(&sp, 16), p[30]);    // lists still work after
+    str_pool_free(&sp, p[30]);
+
+    // Free the first 256 bytes in 16-byte blocks: merged into one on demand
+    for (int i = 1; i < 16; i += 2) str_pool_free(&sp, p[i]);
+    CHECK_EQ(str_pool_alloc(&sp, 256), BASE);
+    CHECK_EQ(sp.st.coalesces, 2);
+    CHECK_EQ(sp.st.free_listed, 8 * 16);
+
+    // A run reaching the top goes back to the bump pointer
+    for (int i = 17; i < 32; i += 2) str_pool_free(&sp, p[i]);
+    CHECK_EQ(sp.bump, 31);
+    CHECK_EQ(str_pool_alloc(&sp, 256), BASE + 256);
+    CHECK_EQ(sp.st.coalesces, 3);
+    CHECK_EQ(sp.bump, 32);
+    CHECK_EQ(sp.st.free_listed, 0);
+    str_pool_release(&sp);
+}
+
+
+static void test_placement()
+{
+    // Rounded inward to granules
+    str_pool_init(&sp, BASE + 4, 100);
+    CHECK_EQ(sp.start, BASE + 16);
+    CHECK_EQ(sp.ngran, 5);
+    CHECK(!str_pool_contains(&sp, BASE + 4));
+    CHECK(str_pool_contains(&sp, BASE + 16 + 79));
+    CHECK(!str_pool_contains(&sp, BASE + 16 + 80));
+    str_pool_release(&sp);
+
+    // Empty: every allocation fails, nothing is contained
+    str_pool_init(&sp, BASE, 8);
+    CHECK_EQ(sp.ngran, 0);
+    CHECK_EQ(str_pool_alloc(&sp, 1), 0);
+    CHECK(!str_pool_contains(&sp, BASE));
+    str_pool_release(&sp);
+}
+
+
+static void test_churn()
+{
+    str_pool_init(&sp, BASE, 28 * 1024);
+    std::map<uint32_t, uint32_t> live;      // address -> requested size
+    srand(7);
+    bool ok = true;
+    for (int i = 0; i < 50000; i++) {
+        if (live.size() < 200 && (live.empty() || rand() % 3)) {
+            uint32_t n = 1 + rand() % (rand() % 8 ? 80 : 1500);
+            uint32_t p = str_pool_alloc(&sp, n);
+            if (!p) continue;
+            if (p < BASE || p + n > BASE + 28 * 1024) ok = false;
+            if (str_pool_block_size(&sp, p) < n) ok = false;
+            // No overlap with its neighbours
+            auto next = live.lower_bound(p);
+            if (next != live.end() && p + str_pool_block_size(&sp, p) > next->first) ok = false;
+            if (next != live.begin()) {
+                auto prev = std::prev(next);
+                if (prev->first + str_pool_block_size(&sp, prev->first) > p) ok = false;
+            }
+            live[p] = n;
+        } else {
+            auto it = live.begin();
+            std::advance(it, rand() % live.size());
+            if (!str_pool_free(&sp, it->first)) ok = false;
+            live.erase(it);
+        }
+    }
+    CHECK(ok);
+    CHECK_EQ(sp.st.blocks, (uint32_t)live.size());
+    uint32_t used = 0;
+    for (auto &e : live) used += str_pool_block_size(&sp, e.first);
+    CHECK_EQ(sp.st.used, used);
+    CHECK(sp.st.peak >= used);
+    CHECK(sp.st.used + sp.st.free_listed <= sp.st.size);
+
+    for (auto &e : live) str_pool_free(&sp, e.first);
+    CHECK_EQ(sp.st.used, 0);
+    CHECK_EQ(sp.st.blocks, 0);
+    str_pool_release(&sp);
+}
+
+
+int main()
+{
+    printf("=== str_pool host tests ===\n");
+    RUN(test_classes);
+    RUN(test_free);
+    RUN(test_split);
+    RUN(test_coalesce);
+    RUN(test_placement);
+    RUN(test_churn);
+    return DONE("str_pool");
+}
@@ -0,0 +1,215 @@
+// Host test for wasm_lines, the reader for the "conez.lines" table release
+// builds carry in place of __line stores: finding the section among
+// others, lookups at and between entries, rejecting malformed tables, and
+// the whole path on the firmware's wasm3 fork -- a trap's backtrace offset
+// mapped back to its line when the runtime maps code, and not otherwise.
+
+#include <string.h>
+#include <vector>
+#include "wasm3.h"
+#include "m3_env.h"
+#include "wasm_lines.h"
+#include "host_test.h"
+
+typedef std::vector<uint8_t> bytes;
+
+extern "C" M3Result m3_Yield(void)
+{
+    return m3Err_none;
+}
+
+
+static void put_uleb(bytes &b, uint32_t v)
+{
+    do {
+        uint8_t c = v & 0x7F;
+        v >>= 7;
+        b.push_back(v ? c | 0x80 : c);
+    } while (v);
+}
+
+static void put_sleb(bytes &b, int32_t v)
+{
+    for (;;) {
+        uint8_t c = v & 0x7F;
+        v >>= 7;
+        if ((v == 0 && !(c & 0x40)) || (v == -1 && (c & 0x40))) { b.push_back(c); return; }
+        b.push_back(c | 0x80);
+    }
+}
+
+static void put_section(bytes &m, int id, const bytes &content)
+{
+    m.push_back((uint8_t)id);
+    put_uleb(m, (uint32_t)content.size());
+    m.insert(m.end(), content.begin(), content.end());
+}
+
+static void put_custom(bytes &m, const char *name, const bytes &payload)
+{
+    bytes c;
+    put_uleb(c, (uint32_t)strlen(name));
+    c.insert(c.end(), name, name + strlen(name));
+    c.insert(c.end(), payload.begin(), payload.end());
+    put_section(m, 0, c);
+}
+
+// Table payload from absolute (offset, line) pairs
+static bytes table(const uint32_t (*ents)[2], int n, uint32_t version = 1)
+{
+    bytes t;
+    put_uleb(t, version);
+    put_uleb(t, (uint32_t)n);
+    uint32_t off = 0, line = 0;
+    for (int i = 0; i < n; i++) {
+        put_uleb(t, ents[i][0] - off);
+        put_sleb(t, (int32_t)(ents[i][1] - line));
+        off = ents[i][0];
+        line = ents[i][1];
+    }
+    return t;
+}
+
+static bytes header()
+{
+    return bytes{ 0, 'a', 's', 'm', 1, 0, 0, 0 };
+}
+
+
+static const uint32_t ents[][2] = {
+    { 100, 0 }, { 100, 5 }, { 104, 6 }, { 120, 300 }, { 200, 2 }, { 200, 0 }, { 230, 9 },
+};
+
+static void test_lookup()
+{
+    bytes m = header();
+    put_section(m, 5, bytes{ 1, 0, 1 });            // (memory 1)
+    put_custom(m, "name", bytes{ 0, 1, 2 });
+    put_custom(m, "conez.lines", table(ents, 7));
+
+    wasm_lines wl;
+    CHECK(wasm_lines_find(&wl, m.data(), m.size()));
+    CHECK_EQ(wl.count, 7);
+    CHECK_EQ(wasm_lines_lookup(&wl, 0), 0);         // before the first entry
+    CHECK_EQ(wasm_lines_lookup(&wl, 99), 0);
+    CHECK_EQ(wasm_lines_lookup(&wl, 100), 5);       // the later of two at one offset
+    CHECK_EQ(wasm_lines_lookup(&wl, 103), 5);
+    CHECK_EQ(wasm_lines_lookup(&wl, 104), 6);
+    CHECK_EQ(wasm_lines_lookup(&wl, 150), 300);     // multi-byte deltas both ways
+    CHECK_EQ(wasm_lines_lookup(&wl, 200), 0);
+    CHECK_EQ(wasm_lines_lookup(&wl, 229), 0);
+    CHECK_EQ(wasm_lines_lookup(&wl, 230), 9);
+    CHECK_EQ(wasm_lines_lookup(&wl, 0xFFFFFFFF), 9);
+}
+
+
+static void test_absent()
+{
+    bytes m = header();
+    put_section(m, 5, bytes{ 1, 0, 1 });
+    put_custom(m, "conez.line", table(ents, 7));    // not quite the name
+
+    wasm_lines wl;
+    CHECK(!wasm_lines_find(&wl, m.data(), m.size()));
+    CHECK(wl.ents == NULL);
+    CHECK_EQ(wasm_lines_lookup(&wl, 104), 0);
+}
+
+
+static void test_malformed()
+{
+    wasm_lines wl;
+
+    // Not a module
+    bytes m = header();
+    m[1] = 'b';
+    put_custom(m, "conez.lines", table(ents, 7));
+    CHECK(!wasm_lines_find(&wl, m.data(), m.size()));
+    CHECK(!wasm_lines_find(&wl, m.data(), 4));
+
+    // A newer version isn't guessed at
+    m = header();
+    put_custom(m, "conez.lines", table(ents, 7, 2));
+    CHECK(!wasm_lines_find(&wl, m.data(), m.size()));
+
+    // More entries claimed than the section holds
+    m = header();
+    bytes t = table(ents, 7);
+    t[1] = 8;
+    put_custom(m, "conez.lines", t);
+    CHECK(!wasm_lines_find(&wl, m.data(), m.size()));
+    CHECK_EQ(wasm_lines_lookup(&wl, 230), 0);
+
+    // Section running past the end of the file, at every cut
+    m = header();
+    put_custom(m, "conez.lines", table(ents, 7));
+    for (size_t len = 8; len < m.size(); len++)
+        CHECK(!wasm_lines_find(&wl, m.data(), len));
+    CHECK(wasm_lines_find(&wl, m.data(), m.size()));
+}
+
+
+// (func (export "div") (param i32 i32) (result i32)
+//   local.get 0  local.get 1  i32.div_s)
+// with line 41 from the function's first byte and 42 from the divide
+static bytes div_module(uint32_t *div_at)
+{
+    bytes m = header();
+    put_section(m, 1, bytes{ 1, 0x60, 2, 0x7F, 0x7F, 1, 0x7F });
+    put_section(m, 3, bytes{ 1, 0 });
+    put_section(m, 7, bytes{ 1, 3, 'd', 'i', 'v', 0, 0 });
+    bytes body{ 0, 0x20, 0, 0x20, 1, 0x6D, 0x0B };
+    bytes code{ 1, (uint8_t)body.size() };
+    code.insert(code.end(), body.begin(), body.end());
+    put_section(m, 10, code);
+    uint32_t code_at = (uint32_t)(m.size() - body.size() + 1);
+    *div_at = code_at + 4;
+    const uint32_t lines[][2] = { { code_at, 41 }, { *div_at, 42 } };
+    put_custom(m, "conez.lines", table(lines, 2));
+    return m;
+}
+
+static void test_trap()
+{
+    uint32_t div_at;
+    bytes m = div_module(&div_at);
+    CHECK_EQ(m[div_at], 0x6D);
+    wasm_lines wl;
+    CHECK(wasm_lines_find(&wl, m.data(), m.size()));
+
+    for (int map = 0; map <= 1; map++) {
+        IM3Environment env = m3_NewEnvironment();
+        IM3Runtime rt = m3_NewRuntime(env, 8 * 1024, NULL);
+        rt->mapCode = map;
+        IM3Module module;
+        M3Result r = m3_ParseModule(env, &module, m.data(), (uint32_t)m.size());
+        if (!r) r = m3_LoadModule(rt, module);
+        IM3Function f = NULL;
+        if (!r) r = m3_FindFunction(&f, rt, "div");
+        CHECK(r == m3Err_none);
+        if (r) { m3_FreeRuntime(rt); m3_FreeEnvironment(env); continue; }
+
+        CHECK(m3_CallV(f, 7, 2) == m3Err_none);
+        CHECK(m3_CallV(f, 7, 0) == m3Err_trapDivisionByZero);
+        IM3BacktraceInfo bt = m3_GetBacktrace(rt);
+        CHECK(bt && bt->frames);
+        if (bt && bt->frames) {
+            uint32_t off = bt->frames->moduleOffset;
+            CHECK_EQ(off, map ? div_at : 0);
+            CHECK_EQ(wasm_lines_lookup(&wl, off), map ? 42 : 0);
+        }
+        m3_FreeRuntime(rt);
+        m3_FreeEnvironment(env);
+    }
+}
+
+
+int main()
+{
+    printf("=== wasm_lines host tests ===\n");
+    RUN(test_lookup);
+    RUN(test_absent);
+    RUN(test_malformed);
+    RUN(test_trap);
+    return DONE("wasm_lines");
+}
@@ -0,0 +1,129 @@
+// Host test for linear memory in PSRAM (ResizeMemory on the firmware's
+// wasm3 fork, psram build): a new memory reads as zero even where the
+// allocator hands back PSRAM another program left dirty, and memory.grow
+// keeps the old contents and zeroes the added pages -- both when resizing
+// in place and when cloning the preallocated block. The compilers' --shrink
+// pass leaves zero runs out of data segments on the strength of this.
+
+#include <string.h>
+#include <vector>
+#include "wasm3.h"
+#include "m3_env.h"
+#include "m3_psram_glue.h"
+#include "wasm_internal.h"
+#include "psram_sim.h"
+#include "host_test.h"
+
+extern "C" M3Result m3_Yield(void)
+{
+    return m3Err_none;
+}
+
+static const uint32_t PAGE = d_m3MemPageSize;
+
+// (memory 2 4)
+static const uint8_t mod[] = { 0, 'a', 's', 'm', 1, 0, 0, 0, 5, 4, 1, 1, 2, 4 };
+
+// Fill (then free) a PSRAM block large enough that every later allocation
+// lands on dirty chip memory.
+static void dirty_psram(void)
+{
+    uint32_t a = psram_malloc(16 * PAGE);
+    psram_memset(a, 0xA5, 16 * PAGE);
+    psram_free(a);
+}
+
+static IM3Runtime load(IM3Environment env)
+{
+    IM3Runtime rt = m3_NewRuntime(env, 8 * 1024, NULL);
+    IM3Module module;
+    M3Result r = m3_ParseModule(env, &module, mod, sizeof(mod));
+    if (!r) r = m3_LoadModule(rt, module);
+    CHECK(r == NULL);
+    return rt;
+}
+
+static bool all_zero(IM3Runtime rt, uint32_t off, uint32_t len)
+{
+    std::vector<uint8_t> b(len, 0xFF);
+    wasm_mem_read(rt, off, b.data(), len);
+    for (uint8_t c : b)
+        if (c) return false;
+    return true;
+}
+
+static uint32_t read32(IM3Runtime rt, uint32_t off)
+{
+    uint32_t v = 0;
+    wasm_mem_read(rt, off, &v, sizeof(v));
+    return v;
+}
+
+
+static void test_new_memory_zeroed(void)
+{
+    psram_sim_init(PSRAM_SIM_FREQ_DEFAULT, PSRAM_SIM_BURST_NS);
+    dirty_psram();
+    IM3Environment env = m3_NewEnvironment();
+    IM3Runtime rt = load(env);
+    CHECK_EQ(wasm_mem_size(rt), 2 * PAGE);
+    CHECK(all_zero(rt, 0, 2 * PAGE));
+    m3_FreeRuntime(rt);
+    m3_FreeEnvironment(env);
+}
+
+static void test_grow_keeps_and_zeroes(void)
+{
+    psram_sim_init(PSRAM_SIM_FREQ_DEFAULT, PSRAM_SIM_BURST_NS);
+    dirty_psram();
+    IM3Environment env = m3_NewEnvironment();
+    IM3Runtime rt = load(env);
+    uint32_t lo = 0x11223344, hi = 0x55667788;
+    wasm_mem_write(rt, 16, &lo, sizeof(lo));
+    wasm_mem_write(rt, 2 * PAGE - 4, &hi, sizeof(hi));
+
+    CHECK(ResizeMemory(rt, 3) == NULL);
+    CHECK_EQ(wasm_mem_size(rt), 3 * PAGE);
+    CHECK_EQ(read32(rt, 16), lo);
+    CHECK_EQ(read32(rt, 2 * PAGE - 4), hi);
+    CHECK(all_zero(rt, 2 * PAGE, PAGE));
+    m3_FreeRuntime(rt);
+    m3_FreeEnvironment(env);
+}
+
+// wasm_wrapper.cpp's preallocated block is cloned, not resized, on grow
+static void test_grow_prealloc_clone(void)
+{
+    psram_sim_init(PSRAM_SIM_FREQ_DEFAULT, PSRAM_SIM_BURST_NS);
+    dirty_psram();
+    IM3Environment env = m3_NewEnvironment();
+    IM3Runtime rt = load(env);
+    M3MemoryHeader *pre = rt->memory.mallocated;
+    pre->prealloc = true;
+    uint32_t hi = 0x0BADF00D;
+    wasm_mem_write(rt, 2 * PAGE - 4, &hi, sizeof(hi));
+
+    CHECK(ResizeMemory(rt, 4) == NULL);
+    CHECK(rt->memory.mallocated != pre);
+    CHECK_EQ(wasm_mem_size(rt), 4 * PAGE);
+    CHECK_EQ(read32(rt, 2 * PAGE - 4), hi);
+    CHECK(all_zero(rt, 2 * PAGE, 2 * PAGE));
+    m3_FreeRuntime(rt);
+    m3_FreeEnvironment(env);
+
+    // The runtime leaves the original to its owner
+    m3_psram_tlb_release(pre);
+    psram_free(pre->psram_addr);
+    m3_Free(pre->dram_buf);
+    m3_Free(pre);
+}
+
+
+int main(void)
+{
+    printf("=== wasm_memory host tests ===\n");
+    RUN(test_new_memory_zeroed);
+    RUN(test_grow_keeps_and_zeroes);
+    RUN(test_grow_prealloc_clone);
+    return DONE("wasm_memory");
+}
@@ -0,0 +1,443 @@
+// Host benchmark for the wasm3 fork: runs a .wasm program with linear
+// memory in DRAM or in simulated SPI PSRAM (psram_sim.h), depending on how
+// the fork was built (see the Makefile), and reports interpreter time on
+// this machine plus, for PSRAM, the page cache hit rate and the modelled SPI
+// bus time the same run would spend on the board.
+//
+//   wasm_bench_psram [-f MHz] [-b burst_ns] [-n loops] [-t ms] [-l leds] file.wasm
+//   wasm_bench_psram [-f MHz] [-b burst_ns] [-n loops] -p frame_bytes
+//
+// Programs run as on the device: setup() then loop() (n times, default 1),
+// or _start()/main(). -t stops a program that never returns (an effect
+// with its own main loop) after that much host time, the way the stop
+// button does on the board. millis, delay_ms, should_stop, host_printf, the
+// print_* family, and a bump malloc/calloc above _heap_ptr are provided;
+// every other import is a no-op returning 0. -l makes led_count() report
+// that many LEDs per channel, so effects walk their strings.
+//
+// -p instead plays back a file of frames into linear memory above the DRAM
+// window, the way file_read and file_map_get do, and compares the old
+// 256-byte staging copy with wasm_mem_fread, per frame and through a 16 KB
+// mapped window. Host stdio stands in for LittleFS, so only the copy and
+// PSRAM costs carry over to the board, not the absolute rates.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "wasm3.h"
+#include "m3_env.h"
+#include "wasm_internal.h"
+#include "psram_sim.h"
+
+static double now_ms(void)
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static double t_start;
+static double t_limit;      // ms, 0 = run to completion
+static int32_t leds;        // led_count() result
+
+
+// The interpreter calls this every d_m3FuelQuantum back-edges/calls, as it
+// does the firmware's stop check.
+extern "C" M3Result m3_Yield(void)
+{
+    if (t_limit > 0 && now_ms() - t_start > t_limit) return m3Err_trapExit;
+    return m3Err_none;
+}
+
+
+// ---------- Imports ----------
+
+m3ApiRawFunction(b_millis)
+{
+    m3ApiReturnType(int32_t);
+    m3ApiReturn((int32_t)(now_ms() - t_start));
+}
+
+m3ApiRawFunction(b_delay_ms)
+{
+    m3ApiSuccess();
+}
+
+m3ApiRawFunction(b_led_count)
+{
+    m3ApiReturnType(int32_t);
+    m3ApiReturn(leds);
+}
+
+m3ApiRawFunction(b_should_stop)
+{
+    m3ApiReturnType(int32_t);
+    m3ApiReturn(0);
+}
+
+// Enough of wasm_format.cpp's printf for benchmark output: flags, width,
+// precision, and d/i/u/x/X/c/s/f conversions from the wasm32 va_list.
+m3ApiRawFunction(b_host_printf)
+{
+    m3ApiReturnType(int32_t);
+    m3ApiGetArg(int32_t, fmt_ptr);
+    m3ApiGetArg(int32_t, args_ptr);
+
+    char fmt[512];
+    int n = wasm_mem_read_str(runtime, (uint32_t)fmt_ptr, fmt, sizeof(fmt));
+    uint32_t ap = (uint32_t)args_ptr;
+    int out = 0;
+    for (int i = 0; i < n; i++) {
+        if (fmt[i] != '%') { putchar(fmt[i]); out++; continue; }
+        char spec[32];
+        int sp = 0;
+        spec[sp++] = '%';
+        i++;
+        while (i < n && strchr("-+ #0123456789.l", fmt[i]) && sp < 28) {
+            if (fmt[i] != 'l') spec[sp++] = fmt[i];
+            i++;
+        }
+        if (i >= n) break;
+        char conv = fmt[i];
+        spec[sp++] = conv;
+        spec[sp] = 0;
+        if (conv == '%') { putchar('%'); out++; continue; }
+        if (conv == 'f' || conv == 'g' || conv == 'e') {
+            double d;
+            wasm_mem_read(runtime, ap, &d, 8); ap += 8;
+            out += printf(spec, d);
+        } else if (conv == 's') {
+            int32_t p;
+            char s[256];
+            wasm_mem_read(runtime, ap, &p, 4); ap += 4;
+            wasm_mem_read_str(runtime, (uint32_t)p, s, sizeof(s));
+            out += printf(spec, s);
+        } else {
+            int32_t v;
+            wasm_mem_read(runtime, ap, &v, 4); ap += 4;
+            out += printf(spec, v);
+        }
+    }
+    m3ApiReturn(out);
+}
+
+m3ApiRawFunction(b_print_i32)
+{
+    m3ApiGetArg(int32_t, val);
+    printf("%d\n", val);
+    m3ApiSuccess();
+}
+
+m3ApiRawFunction(b_print_f32)
+{
+    m3ApiGetArg(float, val);
+    printf("%f\n", val);
+    m3ApiSuccess();
+}
+
+m3ApiRawFunction(b_print_i64)
+{
+    m3ApiGetArg(int64_t, val);
+    printf("%lld\n", (long long)val);
+    m3ApiSuccess();
+}
+
+m3ApiRawFunction(b_print_f64)
+{
+    m3ApiGetArg(double, val);
+    printf("%g\n", val);
+    m3ApiSuccess();
+}
+
+m3ApiRawFunction(b_print_str)
+{
+    m3ApiGetArg(int32_t, offset);
+    m3ApiGetArg(int32_t, len);
+    for (int32_t i = 0; i < len; i++) {
+        char c;
+        wasm_mem_read(runtime, (uint32_t)(offset + i), &c, 1);
+        putchar(c);
+    }
+    putchar('\n');
+    m3ApiSuccess();
+}
+
+// Never reuses memory: enough for DIM arrays and a benchmark's buffers
+static uint32_t heap_bump;
+
+m3ApiRawFunction(b_malloc)
+{
+    m3ApiReturnType(int32_t);
+    m3ApiGetArg(int32_t, size);
+    uint32_t n = ((uint32_t)(size > 0 ? size : 1) + 3) & ~3u;
+    if (!heap_bump || heap_bump + n > wasm_mem_size(runtime)) m3ApiReturn(0);
+    uint32_t p = heap_bump;
+    heap_bump += n;
+    wasm_mem_set(runtime, p, 0, n);
+    m3ApiReturn((int32_t)p);
+}
+
+m3ApiRawFunction(b_calloc)
+{
+    m3ApiReturnType(int32_t);
+    m3ApiGetArg(int32_t, nmemb);
+    m3ApiGetArg(int32_t, size);
+    int64_t total = (int64_t)nmemb * size;
+    uint32_t n = ((uint32_t)(total > 0 && total < 0x7FFFFFFF ? total : 1) + 3) & ~3u;
+    if (!heap_bump || heap_bump + n > wasm_mem_size(runtime)) m3ApiReturn(0);
+    uint32_t p = heap_bump;
+    heap_bump += n;
+    wasm_mem_set(runtime, p, 0, n);
+    m3ApiReturn((int32_t)p);
+}
+
+m3ApiRawFunction(b_stub)
+{
+    *_sp = 0;
+    m3ApiSuccess();
+}
+
+static char type_char(u8 t)
+{
+    switch (t) {
+    case c_m3Type_i64: return 'I';
+    case c_m3Type_f32: return 'f';
+    case c_m3Type_f64: return 'F';
+    default:           return 'i';
+    }
+}
+
+// Link what the benchmarks use, then stub the rest with their own signatures.
+static int link_imports(IM3Module module)
+{
+    m3_LinkRawFunction(module, "env", "millis", "i()", b_millis);
+    m3_LinkRawFunction(module, "env", "delay_ms", "v(i)", b_delay_ms);
+    m3_LinkRawFunction(module, "env", "should_stop", "i()", b_should_stop);
+    m3_LinkRawFunction(module, "env", "led_count", "i(i)", b_led_count);
+    m3_LinkRawFunction(module, "env", "host_printf", "i(ii)", b_host_printf);
+    m3_LinkRawFunction(module, "env", "print_i32", "v(i)", b_print_i32);
+    m3_LinkRawFunction(module, "env", "print_f32", "v(f)", b_print_f32);
+    m3_LinkRawFunction(module, "env", "print_i64", "v(I)", b_print_i64);
+    m3_LinkRawFunction(module, "env", "print_f64", "v(F)", b_print_f64);
+    m3_LinkRawFunction(module, "env", "print_str", "v(ii)", b_print_str);
+    m3_LinkRawFunction(module, "env", "malloc", "i(i)", b_malloc);
+    m3_LinkRawFunction(module, "env", "calloc", "i(ii)", b_calloc);
+
+    IM3Global heap = m3_FindGlobal(module, "_heap_ptr");
+    M3TaggedValue v;
+    if (heap && !m3_GetGlobal(heap, &v)) heap_bump = v.value.i32;
+
+    int stubbed = 0;
+    for (u32 i = 0; i < module->numFuncImports; i++) {
+        IM3Function f = &module->functions[i];
+        if (f->compiled) continue;
+        IM3FuncType t = f->funcType;
+        char sig[64];
+        int p = 0;
+        sig[p++] = t->numRets ? type_char(t->types[0]) : 'v';
+        sig[p++] = '(';
+        for (u16 a = 0; a < t->numArgs && p < 60; a++)
+            sig[p++] = type_char(t->types[t->numRets + a]);
+        sig[p++] = ')';
+        sig[p] = 0;
+        if (!m3_LinkRawFunction(module, f->import.moduleUtf8, f->import.fieldUtf8, sig, b_stub))
+            stubbed++;
+    }
+    return stubbed;
+}
+
+
+// ---------- Frame playback ----------
+
+#define PLAY_FRAMES     1000
+#define PLAY_DST        0x10000             // past the DRAM window
+#define PLAY_WINDOW     (16 * 1024)
+#define STAGED_BUFSIZ   128                 // newlib's default on the ESP32
+
+enum { PLAY_STAGED, PLAY_DIRECT, PLAY_MAPPED };
+
+// One pass over the file: frame i lands at PLAY_DST (or somewhere in the
+// window). Returns the frames read.
+static int play_pass(IM3Runtime rt, FILE *f, int mode, uint32_t frame)
+{
+    fseek(f, 0, SEEK_SET);
+    uint32_t win_start = 0, win_len = 0;
+    int frames = 0;
+    for (uint32_t off = 0;; off += frame) {
+        if (mode == PLAY_STAGED) {
+            // file_read before zero-copy
+            uint32_t got = 0;
+            while (got < frame) {
+                uint8_t tmp[256];
+                uint32_t chunk = frame - got < sizeof(tmp) ? frame - got : (uint32_t)sizeof(tmp);
+                uint32_t n = (uint32_t)fread(tmp, 1, chunk, f);
+                wasm_mem_write(rt, PLAY_DST + got, tmp, n);
+                got += n;
+                if (n < chunk) break;
+            }
+            if (got < frame) break;
+        } else if (mode == PLAY_DIRECT) {
+            if (wasm_mem_fread(rt, PLAY_DST, frame, f) < frame) break;
+        } else {
+            // file_map_get
+            if (off + frame > win_start + win_len) {
+                fseek(f, off, SEEK_SET);
+                win_start = off;
+                win_len = (uint32_t)wasm_mem_fread(rt, PLAY_DST, PLAY_WINDOW, f);
+                if (win_len < frame) break;
+            }
+        }
+        frames++;
+    }
+    return frames;
+}
+
+static int playback(uint32_t frame, int loops)
+{
+    static const char *names[] = { "staged 256 B", "zero-copy", "mapped 16 KB" };
+    if (frame == 0 || frame > PLAY_WINDOW) { fprintf(stderr, "-p: 1..%d bytes\n", PLAY_WINDOW); return 1; }
+
+    // Smallest module with a memory: (memory 2)
+    static const uint8_t mod[] = { 0, 'a', 's', 'm', 1, 0, 0, 0, 5, 3, 1, 0, 2 };
+    IM3Environment env = m3_NewEnvironment();
+    IM3Runtime rt = m3_NewRuntime(env, 8 * 1024, NULL);
+    IM3Module module;
+    M3Result r = m3_ParseModule(env, &module, mod, sizeof(mod));
+    if (!r) r = m3_LoadModule(rt, module);
+    if (r) { fprintf(stderr, "playback: %s\n", r); return 1; }
+
+    FILE *f = tmpfile();
+    if (!f) { perror("tmpfile"); return 1; }
+    uint8_t *buf = (uint8_t *)malloc(frame);
+    for (int i = 0; i < PLAY_FRAMES; i++) {
+        memset(buf, i, frame);
+        fwrite(buf, 1, frame, f);
+    }
+    fflush(f);
+    free(buf);
+
+#if d_m3UsePsramMemory
+    printf("--- playback: %d frames of %u B, PSRAM linear memory, %u B DRAM window\n",
+           PLAY_FRAMES, (unsigned)frame, (unsigned)d_m3PsramDramWindow);
+#else
+    printf("--- playback: %d frames of %u B, DRAM linear memory\n", PLAY_FRAMES, (unsigned)frame);
+#endif
+    for (int mode = PLAY_STAGED; mode <= PLAY_MAPPED; mode++) {
+        setvbuf(f, NULL, _IOFBF, mode == PLAY_STAGED ? STAGED_BUFSIZ : WASM_FILE_BUF_SIZE);
+#if d_m3UsePsramMemory
+        psram_sim_stats before = *psram_sim_get_stats();
+#endif
+        int frames = 0;
+        double t0 = now_ms();
+        for (int i = 0; i < loops; i++) frames += play_pass(rt, f, mode, frame);
+        double ms = now_ms() - t0;
+        if (frames != PLAY_FRAMES * loops) { fprintf(stderr, "playback: short read\n"); return 1; }
+        printf("  %-13s %8.1f MB/s %8.0f frames/s", names[mode],
+               (double)frames * frame / 1e3 / ms, frames / ms * 1e3);
+#if d_m3UsePsramMemory
+        psram_cache_flush();
+        const psram_sim_stats *st = psram_sim_get_stats();
+        printf("  modelled SPI %6.1f ms (%.1f us/frame)",
+               (st->spi_ns - before.spi_ns) / 1e6, (st->spi_ns - before.spi_ns) / 1e3 / frames);
+#endif
+        printf("\n");
+    }
+    fclose(f);
+    m3_FreeRuntime(rt);
+    m3_FreeEnvironment(env);
+    return 0;
+}
+
+
+// ---------- Main ----------
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: wasm_bench [-f MHz] [-b burst_ns] [-n loops] [-t ms] [-l leds] file.wasm\n"
+                    "       wasm_bench [-f MHz] [-b burst_ns] [-n loops] -p frame_bytes\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t freq = PSRAM_SIM_FREQ_DEFAULT;
+    uint32_t burst = PSRAM_SIM_BURST_NS;
+    int loops = 1;
+    uint32_t frame = 0;
+    const char *path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-f") && i + 1 < argc)      freq = (uint32_t)atoi(argv[++i]) * 1000000;
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc) burst = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc) loops = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) t_limit = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-l") && i + 1 < argc) leds = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-p") && i + 1 < argc) frame = (uint32_t)atoi(argv[++i]);
+        else if (argv[i][0] == '-' || path)              usage();
+        else                                             path = argv[i];
+    }
+    if (freq == 0 || !path == !frame) usage();
+    if (frame) {
+        psram_sim_init(freq, burst);
+        return playback(frame, loops);
+    }
+
+    FILE *f = fopen(path, "rb");
+    if (!f) { perror(path); return 1; }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *wasm = (uint8_t *)malloc(size);
+    if (fread(wasm, 1, size, f) != (size_t)size) { perror(path); return 1; }
+    fclose(f);
+
+    psram_sim_init(freq, burst);
+
+    IM3Environment env = m3_NewEnvironment();
+    IM3Runtime rt = m3_NewRuntime(env, 8 * 1024, NULL);
+    IM3Module module;
+    M3Result r = m3_ParseModule(env, &module, wasm, size);
+    if (!r) r = m3_LoadModule(rt, module);
+    if (r) { fprintf(stderr, "%s: %s\n", path, r); return 1; }
+    int stubbed = link_imports(module);
+
+    IM3Function fsetup = NULL, floop = NULL, fstart = NULL;
+    m3_FindFunction(&fsetup, rt, "setup");
+    m3_FindFunction(&floop, rt, "loop");
+    if (m3_FindFunction(&fstart, rt, "_start")) m3_FindFunction(&fstart, rt, "main");
+    if (!fsetup && !floop && !fstart) { fprintf(stderr, "%s: no entry point\n", path); return 1; }
+
+    t_start = now_ms();
+    r = m3_RunStart(module);
+    if (!r && fsetup) r = m3_CallV(fsetup);
+    for (int i = 0; !r && floop && i < loops; i++) r = m3_CallV(floop);
+    if (!r && !fsetup && !floop) r = m3_CallV(fstart);
+    double host_ms = now_ms() - t_start;
+    fflush(stdout);
+    if (r && r != m3Err_trapExit) { fprintf(stderr, "%s: %s\n", path, r); return 1; }
+
+#if d_m3UsePsramMemory
+    printf("--- %s: PSRAM linear memory, %u B DRAM window, %u MHz SPI, %u ns/burst\n",
+           path, (unsigned)d_m3PsramDramWindow, (unsigned)(freq / 1000000), (unsigned)burst);
+#else
+    printf("--- %s: DRAM linear memory%s\n", path, d_m3FuseOps ? "" : ", no op fusion");
+#endif
+    printf("  host time     %10.1f ms\n", host_ms);
+    if (stubbed) printf("  stubbed       %10d imports\n", stubbed);
+#if d_m3UsePsramMemory
+    const psram_sim_stats *st = psram_sim_get_stats();
+    uint32_t hits = psram_cache_hits(), misses = psram_cache_misses();
+    printf("  PSRAM access  %10llu reads, %llu writes\n",
+           (unsigned long long)st->reads, (unsigned long long)st->writes);
+    printf("  cache         %10u hits, %u misses (%.2f%% hit)\n",
+           hits, misses, hits + misses ? 100.0 * hits / (hits + misses) : 100.0);
+    printf("  SPI           %10llu read bursts (%llu B), %llu write bursts (%llu B)\n",
+           (unsigned long long)st->read_bursts, (unsigned long long)st->read_bytes,
+           (unsigned long long)st->write_bursts, (unsigned long long)st->write_bytes);
+    printf("  modelled SPI  %10.1f ms\n", st->spi_ns / 1e6);
+#endif
+    m3_FreeRuntime(rt);
+    m3_FreeEnvironment(env);
+    free(wasm);
+    return 0;
+}
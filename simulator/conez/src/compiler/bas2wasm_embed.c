@@ -19,6 +19,7 @@
 #include "expr.c"
 #include "stmt.c"
 #include "assemble.c"
+#include "runtime.c"
 
 // main.c provides bw_compile(), bas2wasm_compile_buffer(), bas2wasm_reset()
 #include "main.c"
@@ -21,6 +21,7 @@
 #include "type_ops.c"
 #include "expr.c"
 #include "stmt.c"
+#include "opt.c"
 #include "assemble.c"
 
 // main.c provides cw_compile(), c2wasm_compile_buffer(), c2wasm_reset()
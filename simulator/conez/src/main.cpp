@@ -68,6 +68,9 @@ int main(int argc, char *argv[])
         }
     }
 
+    // Firmware settings from the sandbox's /config.ini (led.fps)
+    simConfigLoadIni(cfg);
+
     // bas2wasm: explicit --bas2wasm, or auto-detect from project tree
     if (parser.isSet("bas2wasm")) {
         cfg.bas2wasm_path = parser.value("bas2wasm").toStdString();
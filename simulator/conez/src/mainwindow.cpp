@@ -320,7 +320,7 @@ void MainWindow::cmdHelp()
         "  cat {filename}                      Show file contents\n"
         "  clear                               Clear console\n"
         "  cp {source} {dest}                  Copy file\n"
-        "  cue [load|start|stop|status]        Cue timeline engine\n"
+        "  cue [load|start|stop|status|stats]  Cue timeline engine\n"
         "  deflate {file} [output] [level]     Compress file to gzip format\n"
         "  del {filename}                      Delete file\n"
         "  df                                  Show filesystem usage\n"
@@ -946,8 +946,35 @@ void MainWindow::cmdCue(const QStringList &args)
         cueEngine().start(offset);
     } else if (sub == "stop") {
         cueEngine().stop();
+    } else if (sub == "stats") {
+        auto &eng = cueEngine();
+        if (args.size() >= 3 && args[2].toLower() == "reset") {
+            eng.resetTiming();
+            m_console->appendText("cue: timing stats reset\n");
+            return;
+        }
+        CueTimingStats st = eng.timingStats();
+        m_console->appendText("Cue Timing:\n");
+        m_console->appendText(QString("  Fires:    %1\n").arg(st.fires));
+        m_console->appendText(QString("  Late:     p50 %1 ms  p99 %2 ms  max %3 ms\n")
+            .arg(st.late_p50_ms).arg(st.late_p99_ms).arg(st.late_max_ms));
+        m_console->appendText(QString("  Loops:    %1\n").arg(st.loops));
+        m_console->appendText(QString("  Jitter:   p50 %1 us  p99 %2 us  max %3 us\n")
+            .arg(st.jitter_p50_us).arg(st.jitter_p99_us).arg(st.jitter_max_us));
+        m_console->appendText(QString("  Max gap:  %1 us\n").arg(st.gap_max_us));
+        const CueHist &h = eng.latenessHistogram();
+        if (st.fires > 0) {
+            m_console->appendText("  Lateness histogram:\n");
+            for (int i = 0; i <= h.nedges; i++) {
+                if (!h.counts[i]) continue;
+                if (i < h.nedges)
+                    m_console->appendText(QString("    <= %1 ms  %2\n").arg(h.edges[i], 4).arg(h.counts[i]));
+                else
+                    m_console->appendText(QString("     > %1 ms  %2\n").arg(h.edges[i - 1], 4).arg(h.counts[i]));
+            }
+        }
     } else {
-        m_console->appendText("Usage: cue [load <path> | start [ms] | stop | status]\n");
+        m_console->appendText("Usage: cue [load <path> | start [ms] | stop | status | stats [reset]]\n");
     }
 }
 
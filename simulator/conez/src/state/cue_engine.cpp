@@ -5,6 +5,7 @@
 
 #include <QFile>
 #include <QDateTime>
+#include <chrono>
 #include <cmath>
 #include <cstring>
 
@@ -36,6 +37,53 @@ GeoResult xyToPolar(float x1, float y1, float x2, float y2)
     return result;
 }
 
+// ---------- Timing histograms ----------
+
+// Same bucket edges as firmware cue.cpp.
+static const uint32_t s_lateEdgesMs[] = {
+    0, 1, 2, 3, 5, 8, 12, 16, 20, 33, 50, 100, 250, 500, 1000
+};
+static const uint32_t s_jitterEdgesUs[] = {
+    50, 100, 250, 500, 1000, 2000, 4000, 8000, 16000, 33000, 66000,
+    133000, 250000, 500000, 1000000
+};
+
+void CueHist::reset()
+{
+    memset(counts, 0, sizeof(counts));
+    total = 0;
+    max = 0;
+}
+
+void CueHist::record(uint32_t v)
+{
+    int i = 0;
+    while (i < nedges && v > edges[i]) i++;
+    counts[i]++;
+    total++;
+    if (v > max) max = v;
+}
+
+uint32_t CueHist::percentile(uint32_t pct) const
+{
+    if (total == 0) return 0;
+    uint32_t rank = (uint32_t)(((uint64_t)total * pct + 99) / 100);
+    if (rank == 0) rank = 1;
+    uint32_t cum = 0;
+    for (int i = 0; i <= nedges; i++) {
+        cum += counts[i];
+        if (cum >= rank)
+            return (i < nedges && edges[i] < max) ? edges[i] : max;
+    }
+    return max;
+}
+
+static int64_t steadyUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 // ---------- Singleton ----------
 
 CueEngine &cueEngine()
@@ -50,6 +98,10 @@ CueEngine::CueEngine(QObject *parent)
     : QObject(parent)
 {
     m_timer.setInterval(33);  // ~30 Hz
+    m_lateHist.edges = s_lateEdgesMs;
+    m_lateHist.nedges = (int)(sizeof(s_lateEdgesMs) / sizeof(s_lateEdgesMs[0]));
+    m_jitterHist.edges = s_jitterEdgesUs;
+    m_jitterHist.nedges = (int)(sizeof(s_jitterEdgesUs) / sizeof(s_jitterEdgesUs[0]));
     connect(&m_timer, &QTimer::timeout, this, &CueEngine::tick);
 }
 
@@ -111,7 +163,7 @@ bool CueEngine::load(const QString &path)
     }
 
     m_cues = std::move(newCues);
-    m_rt.assign(m_cues.size(), CueRt{0, false});
+    m_rt.assign(m_cues.size(), CueRt{0, false, false});
     m_firedCount = 0;
     m_playing.store(false);
     m_loadedFile = path;
@@ -143,8 +195,10 @@ void CueEngine::start(qint64 offsetMs)
         if (eff < 0) eff = 0;
         m_rt[i].effStart = eff;
         m_rt[i].fired = false;
+        m_rt[i].catchup = eff < offsetMs;
     }
     m_firedCount = 0;
+    resetTiming();
 
     m_playing.store(true);
     m_timer.start();
@@ -175,6 +229,20 @@ void CueEngine::tick()
     qint64 start = m_startEpochMs.load();
     uint32_t elapsed_ms = (now > start) ? (uint32_t)(now - start) : 0;
 
+    // Loop-to-loop jitter (see firmware cue_loop)
+    int64_t nowUs = steadyUs();
+    if (m_lastTickUs != 0) {
+        int64_t gap = nowUs - m_lastTickUs;
+        if (gap > (int64_t)m_gapMaxUs) m_gapMaxUs = (gap > UINT32_MAX) ? UINT32_MAX : (uint32_t)gap;
+        if (m_lastGapUs >= 0) {
+            int64_t d = gap - m_lastGapUs;
+            if (d < 0) d = -d;
+            m_jitterHist.record((d > UINT32_MAX) ? UINT32_MAX : (uint32_t)d);
+        }
+        m_lastGapUs = gap;
+    }
+    m_lastTickUs = nowUs;
+
     // Fire every cue whose precomputed effective start has arrived and hasn't
     // fired yet (see the CueRt comment) so a spatially-offset cue can't stall
     // the ones after it.
@@ -182,8 +250,15 @@ void CueEngine::tick()
         if (m_rt[i].fired) continue;
         if (m_rt[i].effStart > (int64_t)elapsed_ms) continue;  // not yet — keep scanning
 
-        if (cueMatches(m_cues[i].group))
+        if (cueMatches(m_cues[i].group)) {
+            if (!m_rt[i].catchup) {
+                qint64 due = start + m_rt[i].effStart;
+                qint64 fire = QDateTime::currentMSecsSinceEpoch();
+                qint64 late = (fire > due) ? fire - due : 0;
+                m_lateHist.record((late > UINT32_MAX) ? UINT32_MAX : (uint32_t)late);
+            }
             dispatchCue(&m_cues[i]);
+        }
         m_rt[i].fired = true;
         m_firedCount++;
     }
@@ -195,6 +270,30 @@ void CueEngine::tick()
     }
 }
 
+CueTimingStats CueEngine::timingStats() const
+{
+    CueTimingStats st;
+    st.fires         = m_lateHist.total;
+    st.late_p50_ms   = m_lateHist.percentile(50);
+    st.late_p99_ms   = m_lateHist.percentile(99);
+    st.late_max_ms   = m_lateHist.max;
+    st.loops         = m_jitterHist.total;
+    st.jitter_p50_us = m_jitterHist.percentile(50);
+    st.jitter_p99_us = m_jitterHist.percentile(99);
+    st.jitter_max_us = m_jitterHist.max;
+    st.gap_max_us    = m_gapMaxUs;
+    return st;
+}
+
+void CueEngine::resetTiming()
+{
+    m_lateHist.reset();
+    m_jitterHist.reset();
+    m_lastTickUs = 0;
+    m_lastGapUs = -1;
+    m_gapMaxUs = 0;
+}
+
 bool CueEngine::cueMatches(uint16_t group) const
 {
     int mode  = group >> 12;
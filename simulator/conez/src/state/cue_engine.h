@@ -82,6 +82,32 @@ struct GeoResult {
 void latlonToMeters(float lat_deg, float lon_deg, float *x, float *y);
 GeoResult xyToPolar(float x1, float y1, float x2, float y2);
 
+// ---------- Timing instrumentation (mirrors firmware cue_timing_stats) ----------
+
+// Lateness per fired cue in ms (now - due), loop-to-loop jitter of tick() in
+// us. Percentiles are bucket upper bounds clamped to the observed max, with
+// the same bucket edges as the firmware so the two can be compared directly.
+struct CueTimingStats {
+    uint32_t fires = 0;
+    uint32_t late_p50_ms = 0, late_p99_ms = 0, late_max_ms = 0;
+    uint32_t loops = 0;
+    uint32_t jitter_p50_us = 0, jitter_p99_us = 0, jitter_max_us = 0;
+    uint32_t gap_max_us = 0;
+};
+
+struct CueHist {
+    static constexpr int MAX_BUCKETS = 16;
+    const uint32_t *edges = nullptr;
+    int nedges = 0;
+    uint32_t counts[MAX_BUCKETS] = {};
+    uint32_t total = 0;
+    uint32_t max = 0;
+
+    void reset();
+    void record(uint32_t v);
+    uint32_t percentile(uint32_t pct) const;
+};
+
 // ---------- CueEngine ----------
 
 class CueEngine : public QObject {
@@ -99,6 +125,10 @@ public:
     int cueFiredCount() const { return m_firedCount; }
     QString loadedFile() const { return m_loadedFile; }
 
+    CueTimingStats timingStats() const;
+    const CueHist &latenessHistogram() const { return m_lateHist; }
+    void resetTiming();
+
     void setOutputCallback(std::function<void(const QString&)> cb) { m_output = cb; }
 
 private slots:
@@ -115,7 +145,9 @@ private:
     // (base + spatial offset) and whether it fired. A fired flag rather than a
     // single cursor is required because spatial offsets make effective start
     // times non-monotonic -- one offset cue must not block later cues.
-    struct CueRt { int64_t effStart; bool fired; };
+    // catchup: already overdue at start() (offset start), kept out of the
+    // lateness histogram.
+    struct CueRt { int64_t effStart; bool fired; bool catchup; };
     std::vector<CueRt> m_rt;
     int m_firedCount = 0;
     std::atomic<bool> m_playing{false};
@@ -125,6 +157,12 @@ private:
     float m_myX = 0, m_myY = 0;
     float m_originX = 0, m_originY = 0;
 
+    CueHist m_lateHist;
+    CueHist m_jitterHist;
+    int64_t m_lastTickUs = 0;     // steady_clock us of previous playing tick, 0 = none
+    int64_t m_lastGapUs = -1;
+    uint32_t m_gapMaxUs = 0;
+
     QTimer m_timer;
     QString m_loadedFile;
     std::function<void(const QString&)> m_output;
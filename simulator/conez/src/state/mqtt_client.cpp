@@ -8,6 +8,7 @@
 
 #include "mqtt_client.h"
 #include "sim_config.h"
+#include "cue_engine.h"
 #include <QDateTime>
 #include <cstring>
 
@@ -586,7 +587,18 @@ void SimMqttClient::onHeartbeatTimer()
     auto uptime = std::chrono::steady_clock::now() - cfg.start_time;
     auto uptimeSec = std::chrono::duration_cast<std::chrono::seconds>(uptime).count();
 
-    QString payload = QString("{\"uptime\":%1,\"sim\":true}").arg(uptimeSec);
+    QString payload = QString("{\"uptime\":%1,\"sim\":true").arg(uptimeSec);
+
+    // Same "cue" timing object as the firmware heartbeat (node_status.cpp)
+    CueTimingStats ct = cueEngine().timingStats();
+    if (ct.fires > 0 || ct.loops > 0) {
+        payload += QString(",\"cue\":{\"fires\":%1,\"late_p50_ms\":%2,\"late_p99_ms\":%3,"
+                           "\"late_max_ms\":%4,\"jitter_p50_us\":%5,\"jitter_p99_us\":%6,"
+                           "\"jitter_max_us\":%7}")
+            .arg(ct.fires).arg(ct.late_p50_ms).arg(ct.late_p99_ms).arg(ct.late_max_ms)
+            .arg(ct.jitter_p50_us).arg(ct.jitter_p99_us).arg(ct.jitter_max_us);
+    }
+    payload += "}";
     QByteArray topicUtf8 = m_topicStatus.toUtf8();
 
     uint8_t buf[BUF_SIZE];
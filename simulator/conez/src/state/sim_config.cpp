@@ -1,5 +1,10 @@
 #include "sim_config.h"
 
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
 static SimConfig s_config;
 
 SimConfig &simConfig()
@@ -11,3 +16,44 @@ SimConfig &simConfig()
     }
     return s_config;
 }
+
+static char *trim(char *s)
+{
+    while (*s == ' ' || *s == '\t') s++;
+    char *end = s + strlen(s);
+    while (end > s && (end[-1] == ' ' || end[-1] == '\t')) *--end = '\0';
+    return s;
+}
+
+// Same line rules as the firmware's config_parse_ini()
+void simConfigLoadIni(SimConfig &cfg)
+{
+    FILE *f = fopen((cfg.sandbox_path + "/config.ini").c_str(), "r");
+    if (!f)
+        return;
+
+    char line[128];
+    char section[16] = "";
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#' || line[0] == ';')
+            continue;
+        if (line[0] == '[') {
+            char *end = strchr(line, ']');
+            if (end) {
+                *end = '\0';
+                snprintf(section, sizeof(section), "%s", line + 1);
+            }
+            continue;
+        }
+        char *eq = strchr(line, '=');
+        if (!eq)
+            continue;
+        *eq = '\0';
+        const char *key   = trim(line);
+        const char *value = trim(eq + 1);
+        if (strcasecmp(section, "led") == 0 && strcasecmp(key, "fps") == 0)
+            cfg.led_fps = atoi(value);
+    }
+    fclose(f);
+}
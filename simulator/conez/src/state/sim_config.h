@@ -9,6 +9,7 @@ struct SimConfig {
     int led_count2 = 50;
     int led_count3 = 50;
     int led_count4 = 50;
+    int led_fps = 30;       // led.fps from the sandbox /config.ini, as on the firmware
 
     std::string sandbox_path = "/tmp/conez_sandbox";
     std::string bas2wasm_path = "bas2wasm";
@@ -42,4 +43,8 @@ struct SimConfig {
 
 SimConfig &simConfig();
 
+// Read the firmware keys the simulator honours (led.fps) from /config.ini in
+// the sandbox directory. Missing file or keys leave the defaults.
+void simConfigLoadIni(SimConfig &cfg);
+
 #endif
@@ -21,6 +21,7 @@ M3Result link_deflate_imports(IM3Module module);
 void wasm_close_all_files();
 void wasm_reset_gamma();
 void wasm_string_pool_reset();
+void wasm_string_pool_init(IM3Runtime runtime);     // after low_heap_init()
 void low_heap_init(uint32_t start);
 void low_heap_reset(void);
 
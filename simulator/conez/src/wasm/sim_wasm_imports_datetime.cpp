@@ -1,5 +1,7 @@
 #include "sim_wasm_imports.h"
 #include "sim_wasm_runtime.h"
+#include "sim_config.h"
+#include "frame_clock.h"
 #include "m3_env.h"
 
 #include <chrono>
@@ -15,6 +17,21 @@ m3ApiRawFunction(m3_get_epoch_ms) {
     m3ApiReturn(ms);
 }
 
+// Frame n starts at epoch n/fps, as on the firmware: led.fps clamped the
+// same way, and the same frame_clock arithmetic, so the simulator and real
+// cones agree on frame numbers.
+m3ApiRawFunction(m3_get_frame) {
+    m3ApiReturnType(int64_t);
+    auto now = std::chrono::system_clock::now();
+    int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+    m3ApiReturn((int64_t)frame_clock_index((uint64_t)us, frame_clock_clamp_fps(simConfig().led_fps)));
+}
+
+m3ApiRawFunction(m3_get_frame_rate) {
+    m3ApiReturnType(int32_t);
+    m3ApiReturn((int32_t)frame_clock_clamp_fps(simConfig().led_fps));
+}
+
 m3ApiRawFunction(m3_millis) {
     m3ApiReturnType(int32_t);
     auto elapsed = std::chrono::steady_clock::now() - s_boot_time;
@@ -128,6 +145,8 @@ M3Result link_datetime_imports(IM3Module module)
     LINK("time_valid",      "i()", m3_time_valid)
     LINK("get_uptime_ms",   "I()", m3_get_uptime_ms)
     LINK("get_last_comm_ms","I()", m3_get_last_comm_ms)
+    LINK("get_frame",       "I()", m3_get_frame)
+    LINK("get_frame_rate",  "i()", m3_get_frame_rate)
 
     LINK("get_year",        "i()", m3_get_year)
     LINK("get_month",       "i()", m3_get_month)
@@ -19,6 +19,10 @@ static DIR  *wasm_dirs [WASM_MAX_OPEN_DIRS]  = {};
 // Stored alongside each dir handle: the fully-resolved sandbox path
 static std::string wasm_dir_path[WASM_MAX_OPEN_DIRS];
 
+// file_map() views, parallel to wasm_files (see the firmware's FileMap)
+struct FileMap { uint32_t buf, cap, start, len; };
+static FileMap wasm_maps[WASM_MAX_OPEN_FILES] = {};
+
 void wasm_close_all_files()
 {
     for (int i = 0; i < WASM_MAX_OPEN_FILES; i++) {
@@ -27,6 +31,7 @@ void wasm_close_all_files()
     for (int i = 0; i < WASM_MAX_OPEN_DIRS; i++) {
         if (wasm_dirs[i]) { closedir(wasm_dirs[i]); wasm_dirs[i] = nullptr; }
     }
+    memset(wasm_maps, 0, sizeof(wasm_maps));
 }
 
 // ---- Mode table (matches conez_api.h FILE_MODE_*) ----
@@ -139,6 +144,7 @@ m3ApiRawFunction(m3_file_close)
     if (file_handle_ok(handle)) {
         fclose(wasm_files[handle]);
         wasm_files[handle] = nullptr;
+        wasm_maps[handle] = FileMap{};
     }
     m3ApiSuccess();
 }
@@ -171,6 +177,7 @@ m3ApiRawFunction(m3_file_write)
     uint8_t *mem = m3_GetMemory(runtime, &mem_size, 0);
     if (!mem || len <= 0 || (uint32_t)buf_ptr + len > mem_size) m3ApiReturn(-1);
 
+    wasm_maps[handle].len = 0;
     int wr = (int)fwrite(mem + buf_ptr, 1, len, wasm_files[handle]);
     fflush(wasm_files[handle]);
     m3ApiReturn(wr);
@@ -224,6 +231,7 @@ m3ApiRawFunction(m3_file_truncate)
     m3ApiGetArg(int32_t, length);
     if (!file_handle_ok(handle) || length < 0) m3ApiReturn(-1);
     fflush(wasm_files[handle]);
+    wasm_maps[handle].len = 0;
     int fd = fileno(wasm_files[handle]);
     if (fd < 0) m3ApiReturn(-1);
     m3ApiReturn(ftruncate(fd, length) == 0 ? 0 : -1);
@@ -307,6 +315,7 @@ m3ApiRawFunction(m3_file_writeln)
     if (!mem || (uint32_t)str_ptr >= mem_size) m3ApiReturn(-1);
 
     int len = wasm_strlen(mem, mem_size, (uint32_t)str_ptr);
+    wasm_maps[handle].len = 0;
     if (len > 0) {
         if ((int)fwrite(mem + str_ptr, 1, len, wasm_files[handle]) != len) m3ApiReturn(-1);
     }
@@ -315,6 +324,56 @@ m3ApiRawFunction(m3_file_writeln)
     m3ApiReturn(0);
 }
 
+// ============================================================================
+//                              Mapped views
+// ============================================================================
+
+m3ApiRawFunction(m3_file_map)
+{
+    m3ApiReturnType(int32_t);
+    m3ApiGetArg(int32_t, handle);
+    m3ApiGetArg(int32_t, buf_ptr);
+    m3ApiGetArg(int32_t, buf_len);
+    if (!file_handle_ok(handle)) m3ApiReturn(-1);
+    uint32_t mem_size = 0;
+    uint8_t *mem = m3_GetMemory(runtime, &mem_size, 0);
+    if (!mem || buf_ptr == 0 || buf_len <= 0 || (uint64_t)(uint32_t)buf_ptr + buf_len > mem_size)
+        m3ApiReturn(-1);
+    wasm_maps[handle] = FileMap{(uint32_t)buf_ptr, (uint32_t)buf_len, 0, 0};
+    m3ApiReturn(0);
+}
+
+m3ApiRawFunction(m3_file_map_get)
+{
+    m3ApiReturnType(int32_t);
+    m3ApiGetArg(int32_t, handle);
+    m3ApiGetArg(int32_t, offset);
+    m3ApiGetArg(int32_t, len);
+    if (!file_handle_ok(handle)) m3ApiReturn(0);
+    FileMap *m = &wasm_maps[handle];
+    if (!m->buf || offset < 0 || len <= 0 || (uint32_t)len > m->cap) m3ApiReturn(0);
+
+    uint32_t off = (uint32_t)offset;
+    if (off < m->start || (uint64_t)off + len > (uint64_t)m->start + m->len) {
+        uint32_t mem_size = 0;
+        uint8_t *mem = m3_GetMemory(runtime, &mem_size, 0);
+        m->len = 0;
+        if (!mem || (uint64_t)m->buf + m->cap > mem_size) m3ApiReturn(0);
+        if (fseek(wasm_files[handle], offset, SEEK_SET) != 0) m3ApiReturn(0);
+        m->start = off;
+        m->len = (uint32_t)fread(mem + m->buf, 1, m->cap, wasm_files[handle]);
+        if ((uint32_t)len > m->len) m3ApiReturn(0);
+    }
+    m3ApiReturn((int32_t)(m->buf + (off - m->start)));
+}
+
+m3ApiRawFunction(m3_file_unmap)
+{
+    m3ApiGetArg(int32_t, handle);
+    if (file_handle_ok(handle)) wasm_maps[handle] = FileMap{};
+    m3ApiSuccess();
+}
+
 // ============================================================================
 //                           Path-based API
 // ============================================================================
@@ -478,6 +537,9 @@ M3Result link_file_imports(IM3Module module)
     LINK("file_readln",     "i(iii)",  m3_file_readln)
     LINK("file_readln_str", "i(i)",    m3_file_readln_str)
     LINK("file_writeln",    "i(ii)",   m3_file_writeln)
+    LINK("file_map",        "i(iii)",  m3_file_map)
+    LINK("file_map_get",    "i(iii)",  m3_file_map_get)
+    LINK("file_unmap",      "v(i)",    m3_file_unmap)
 
     LINK("file_stat",       "i(ii)",   m3_file_stat)
     LINK("file_delete",     "i(i)",    m3_file_delete)
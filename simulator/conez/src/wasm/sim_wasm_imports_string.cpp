@@ -1,5 +1,6 @@
 #include "sim_wasm_imports.h"
 #include "m3_env.h"
+#include "str_pool.h"
 
 #include <cstring>
 #include <cstdlib>
@@ -8,11 +9,16 @@
 #include <algorithm>
 
 // ---- String pool allocator (mirrors firmware) ----
-// Pool region in WASM linear memory: 0x8000..0xF000 (28KB)
+// The firmware's size-class allocator (firmware/src/wasm/str_pool.cpp) over
+// its default region of WASM linear memory, 0x8000..0xF000 (28KB).
 
 #define STR_POOL_BASE  0x8000
 #define STR_POOL_END   0xF000
-#define STR_MAX_ALLOCS 128
+
+static str_pool s_pool;
+
+// Low heap state (allocator below), bounded by where the pool starts
+#define LOW_HEAP_MAX_ALLOCS 32
 
 struct StrAlloc {
     uint32_t offset;
@@ -20,74 +26,45 @@ struct StrAlloc {
     bool in_use;
 };
 
-static StrAlloc allocs[STR_MAX_ALLOCS];
-static int alloc_count = 0;
-static uint32_t bump_ptr = STR_POOL_BASE;
+static StrAlloc low_allocs[LOW_HEAP_MAX_ALLOCS];
+static int low_nallocs = 0;
+static uint32_t low_heap_start = 0;
+static uint32_t low_heap_end = STR_POOL_BASE;
+static uint32_t low_heap_bump = 0;
+
+// After module load, so the pool stays clear of the program's data
+void wasm_string_pool_init(IM3Runtime runtime)
+{
+    uint32_t ms = 0;
+    m3_GetMemory(runtime, &ms, 0);
+    uint32_t start = std::max<uint32_t>(STR_POOL_BASE, low_heap_start);
+    uint32_t end = std::min<uint32_t>(STR_POOL_END, ms);
+    str_pool_init(&s_pool, start, end > start ? end - start : 0);
+    low_heap_end = start;
+}
 
 void wasm_string_pool_reset()
 {
-    alloc_count = 0;
-    bump_ptr = STR_POOL_BASE;
+    str_pool_release(&s_pool);
 }
 
 uint32_t pool_alloc(IM3Runtime runtime, int size)
 {
     if (size <= 0) size = 1;
-    size = (size + 3) & ~3; // 4-byte align
-
-    // Try freed blocks first (first-fit)
-    for (int i = 0; i < alloc_count; i++) {
-        if (!allocs[i].in_use && allocs[i].size >= (uint32_t)size) {
-            allocs[i].in_use = true;
-            uint32_t ms = 0;
-            uint8_t *mem = m3_GetMemory(runtime, &ms, 0);
-            if (mem && allocs[i].offset + (uint32_t)size <= ms)
-                memset(mem + allocs[i].offset, 0, (size_t)size);
-            return allocs[i].offset;
-        }
-    }
-
-    // Bump allocate
-    if (bump_ptr + size > STR_POOL_END) return 0; // OOM
-    if (alloc_count >= STR_MAX_ALLOCS) return 0;
-
-    uint32_t ptr = bump_ptr;
-    bump_ptr += size;
-
-    allocs[alloc_count].offset = ptr;
-    allocs[alloc_count].size = size;
-    allocs[alloc_count].in_use = true;
-    alloc_count++;
+    uint32_t ptr = str_pool_alloc(&s_pool, (uint32_t)size);
+    if (!ptr) return 0;
 
     uint32_t ms = 0;
     uint8_t *mem = m3_GetMemory(runtime, &ms, 0);
+    size = (size + 3) & ~3;
     if (mem && ptr + (uint32_t)size <= ms)
         memset(mem + ptr, 0, (size_t)size);
-
     return ptr;
 }
 
 static void pool_free(uint32_t ptr)
 {
-    for (int i = 0; i < alloc_count; i++) {
-        if (allocs[i].offset == ptr && allocs[i].in_use) {
-            allocs[i].in_use = false;
-            if (ptr + allocs[i].size == bump_ptr) {
-                bump_ptr = ptr;
-                alloc_count--;
-            }
-            return;
-        }
-    }
-}
-
-static uint32_t pool_size(uint32_t ptr)
-{
-    for (int i = 0; i < alloc_count; i++) {
-        if (allocs[i].offset == ptr && allocs[i].in_use)
-            return allocs[i].size;
-    }
-    return 0;
+    str_pool_free(&s_pool, ptr);
 }
 
 static uint32_t pool_realloc(IM3Runtime runtime, uint32_t ptr, int size)
@@ -98,8 +75,7 @@ static uint32_t pool_realloc(IM3Runtime runtime, uint32_t ptr, int size)
         return 0;
     }
 
-    size = (size + 3) & ~3;
-    uint32_t old_size = pool_size(ptr);
+    uint32_t old_size = str_pool_block_size(&s_pool, ptr);
     if (old_size == 0) return 0;
     if (old_size >= (uint32_t)size) return ptr;
 
@@ -117,14 +93,7 @@ static uint32_t pool_realloc(IM3Runtime runtime, uint32_t ptr, int size)
 }
 
 // ---- Low Heap (DIM arrays, user malloc/calloc) ----
-// Grows upward from _heap_ptr toward STR_POOL_BASE (0x8000).
-
-#define LOW_HEAP_MAX_ALLOCS 32
-
-static StrAlloc low_allocs[LOW_HEAP_MAX_ALLOCS];
-static int low_nallocs = 0;
-static uint32_t low_heap_start = 0;
-static uint32_t low_heap_bump = 0;
+// Grows upward from _heap_ptr toward the string pool (0x8000).
 
 void low_heap_init(uint32_t start)
 {
@@ -156,7 +125,7 @@ static uint32_t low_heap_alloc(IM3Runtime runtime, int size)
         }
     }
 
-    if (low_heap_bump + size > STR_POOL_BASE) return 0;
+    if (low_heap_bump + size > low_heap_end) return 0;
     if (low_nallocs >= LOW_HEAP_MAX_ALLOCS) return 0;
 
     uint32_t off = low_heap_bump;
@@ -273,10 +242,10 @@ m3ApiRawFunction(m3_malloc) {
 // void free(i32 ptr) — dispatch by address range
 m3ApiRawFunction(m3_free) {
     m3ApiGetArg(int32_t, ptr);
-    if ((uint32_t)ptr < STR_POOL_BASE)
-        low_heap_free((uint32_t)ptr);
-    else
+    if (str_pool_contains(&s_pool, (uint32_t)ptr))
         pool_free((uint32_t)ptr);
+    else
+        low_heap_free((uint32_t)ptr);
     m3ApiSuccess();
 }
 
@@ -299,10 +268,10 @@ m3ApiRawFunction(m3_realloc) {
     m3ApiGetArg(int32_t, ptr);
     m3ApiGetArg(int32_t, size);
     uint32_t result;
-    if ((uint32_t)ptr < STR_POOL_BASE)
-        result = low_heap_realloc(runtime, (uint32_t)ptr, size);
-    else
+    if (str_pool_contains(&s_pool, (uint32_t)ptr))
         result = pool_realloc(runtime, (uint32_t)ptr, size);
+    else
+        result = low_heap_realloc(runtime, (uint32_t)ptr, size);
     m3ApiReturn((int32_t)result);
 }
 
@@ -473,24 +442,34 @@ m3ApiRawFunction(m3_str_instr) {
 }
 
 // i32 basic_str_mid_assign(i32 dst, i32 start, i32 len, i32 src)
+// Returns a new pool string: dst may be a literal in the data section,
+// which --shrink shares with equal literals and literal suffixes.
 m3ApiRawFunction(m3_str_mid_assign) {
     m3ApiReturnType(int32_t);
     m3ApiGetArg(int32_t, dst);
     m3ApiGetArg(int32_t, start);
     m3ApiGetArg(int32_t, len);
     m3ApiGetArg(int32_t, src);
+    if (dst == 0) { m3ApiReturn(0); }
     uint32_t ms = 0;
     uint8_t *mem = m3_GetMemory(runtime, &ms, 0);
-    if (!mem) { m3ApiReturn(dst); }
+    if (!mem) { m3ApiReturn(0); }
     int dlen = wasm_strlen(mem, ms, dst);
     int slen = wasm_strlen(mem, ms, src);
     int idx = start - 1;
-    if (idx < 0 || idx >= dlen) { m3ApiReturn(dst); }
+    if (idx < 0) idx = 0;
     int copy = len;
+    if (copy < 0) copy = 0;
     if (copy > slen) copy = slen;
-    if (idx + copy > dlen) copy = dlen - idx;
-    memcpy(mem + dst + idx, mem + src, copy);
-    m3ApiReturn(dst);
+    if (idx >= dlen) copy = 0;          // start beyond string: a copy of it
+    else if (idx + copy > dlen) copy = dlen - idx;
+    uint32_t r = pool_alloc(runtime, dlen + 1);
+    if (!r) { m3ApiReturn(0); }
+    mem = m3_GetMemory(runtime, &ms, 0);
+    memcpy(mem + r, mem + dst, dlen);
+    if (copy > 0) memcpy(mem + r + idx, mem + src, copy);
+    mem[r + dlen] = 0;
+    m3ApiReturn((int32_t)r);
 }
 
 // Type conversions
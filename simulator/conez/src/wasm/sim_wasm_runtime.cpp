@@ -2,6 +2,7 @@
 #include "sim_wasm_imports.h"
 #include "wasm3.h"
 #include "m3_env.h"
+#include "wasm_lines.h"
 
 #include <cstdio>
 #include <cstdlib>
@@ -10,7 +11,7 @@
 #include <chrono>
 
 #define WASM3_STACK_SIZE (8 * 1024)
-#define WASM_YIELD_INTERVAL 1000
+#define WASM_TIME_SLICE_MS 20    // longest stretch between sleeps (see m3_Yield)
 
 // ---- Thread-local current runtime ----
 static thread_local SimWasmRuntime *tl_currentRuntime = nullptr;
@@ -19,15 +20,18 @@ SimWasmRuntime *currentRuntime() { return tl_currentRuntime; }
 void setCurrentRuntime(SimWasmRuntime *rt) { tl_currentRuntime = rt; }
 
 // ---- m3_Yield override ----
-static thread_local uint32_t yield_counter = 0;
+// Called by wasm3 each time the runtime's fuel (d_m3FuelQuantum loop
+// back-edges/calls) runs out.
+static thread_local std::chrono::steady_clock::time_point slice_start;
 
 extern "C" M3Result m3_Yield()
 {
-    if (++yield_counter >= WASM_YIELD_INTERVAL) {
-        yield_counter = 0;
+    auto now = std::chrono::steady_clock::now();
+    if (now - slice_start >= std::chrono::milliseconds(WASM_TIME_SLICE_MS)) {
         auto *rt = currentRuntime();
         if (rt) rt->flushOutput();
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        slice_start = std::chrono::steady_clock::now();
     }
 
     auto *rt = currentRuntime();
@@ -242,9 +246,19 @@ void SimWasmRuntime::run(const std::string &wasmPath)
         return;
     }
 
-    // Look up __line global for BASIC line tracking
+    // Source line of the last error: release builds (--release) carry a
+    // line table to look the trap's offset up in, others keep __line
+    // current. wasm3 is built with d_m3RecordBacktraces here, so every
+    // runtime maps its code.
+    wasm_lines lines;
+    wasm_lines_find(&lines, wasm_buf, wasm_size);
     IM3Global g_line = m3_FindGlobal(module, "__line");
     auto get_basic_line = [&]() -> int {
+        IM3BacktraceInfo bt = lines.ents ? m3_GetBacktrace(runtime) : nullptr;
+        if (bt && bt->frames) {
+            int ln = wasm_lines_lookup(&lines, bt->frames->moduleOffset);
+            if (ln) return ln;
+        }
         if (!g_line) return 0;
         M3TaggedValue val;
         if (m3_GetGlobal(g_line, &val) == m3Err_none)
@@ -263,6 +277,7 @@ void SimWasmRuntime::run(const std::string &wasmPath)
     } else {
         low_heap_init(0);
     }
+    wasm_string_pool_init(runtime);
 
     emitOutput("wasm: running " + wasmPath + "\n");
 
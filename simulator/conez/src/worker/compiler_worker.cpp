@@ -14,10 +14,10 @@ extern "C" {
 
 /* --- bas2wasm embedded API --- */
 typedef void (*bw_diag_fn)(const char *msg, void *ctx);
-extern bw_diag_fn bw_on_error;
-extern bw_diag_fn bw_on_info;
-extern void *bw_cb_ctx;
-extern jmp_buf bw_bail;
+extern thread_local bw_diag_fn bw_on_error;
+extern thread_local bw_diag_fn bw_on_info;
+extern thread_local void *bw_cb_ctx;
+extern thread_local jmp_buf bw_bail;
 
 typedef struct { uint8_t *data; int len, cap; } bw_Buf;
 #define Buf bw_Buf
@@ -28,10 +28,10 @@ void bw_buf_free(bw_Buf *b);
 
 /* --- c2wasm embedded API --- */
 typedef void (*cw_diag_fn)(const char *msg, void *ctx);
-extern cw_diag_fn cw_on_error;
-extern cw_diag_fn cw_on_info;
-extern void *cw_cb_ctx;
-extern jmp_buf cw_bail;
+extern thread_local cw_diag_fn cw_on_error;
+extern thread_local cw_diag_fn cw_on_info;
+extern thread_local void *cw_cb_ctx;
+extern thread_local jmp_buf cw_bail;
 
 typedef struct { uint8_t *data; int len, cap; } cw_Buf;
 #define Buf cw_Buf
@@ -144,4 +144,8 @@
 #   define d_m3SkipMemoryBoundsCheck            0       // skip memory bounds checks
 # endif
 
+# ifndef d_m3FuelQuantum
+#   define d_m3FuelQuantum                      4096    // loop back-edges + calls between m3_Yield() checks
+# endif
+
 #endif // m3_config_h
@@ -177,6 +177,7 @@ IM3Runtime  m3_NewRuntime  (IM3Environment i_environment, u32 i_stackSizeInBytes
 
         runtime->environment = i_environment;
         runtime->userdata = i_userdata;
+        runtime->fuel = d_m3FuelQuantum;
 
         runtime->stack = m3_Malloc (i_stackSizeInBytes + 4*sizeof (m3slot_t)); // TODO: more precise stack checks
 
@@ -294,7 +295,9 @@ M3Result  EvaluateExpression  (IM3Module i_module, void * o_expressed, u8 i_type
 
         if (not result)
         {
-            m3ret_t r = Call (m3code, stack, NULL, d_m3OpDefaultArgs);
+            // straight into the code: there's no memory (and so no runtime)
+            // to burn fuel against, and a constant expression can't loop
+            m3ret_t r = ((IM3Operation) (* m3code)) (m3code + 1, stack, NULL, d_m3OpDefaultArgs);
 
             if (r == 0)
             {                                                                               m3log (runtime, "expression result: %s", SPrintValue (stack, i_type));
@@ -106,10 +106,21 @@ d_m3BeginExternC
 #endif
 
 
+// Execution budget. Every call and every loop back-edge burns one unit of
+// the runtime's fuel; when it runs out, m3_Yield() gets to yield the CPU or
+// stop the program. Code between two of these points is straight-line, so
+// the time between checks stays bounded even in loops that make no calls.
+#define d_m3BurnFuel()                                      \
+    if (UNLIKELY(--_mem->runtime->fuel <= 0)) {             \
+        _mem->runtime->fuel = d_m3FuelQuantum;              \
+        m3ret_t _yld = m3_Yield ();                         \
+        if (UNLIKELY(_yld)) return _yld;                    \
+    }
+
+
 d_m3RetSig  Call  (d_m3OpSig)
 {
-    m3ret_t possible_trap = m3_Yield ();
-    if (UNLIKELY(possible_trap)) return possible_trap;
+    d_m3BurnFuel ();
 
     nextOpDirect();
 }
@@ -1186,9 +1197,9 @@ d_m3Op  (ContinueLoop)
 {
     m3StackCheck();
 
-    // TODO: this is where execution can "escape" the M3 code and callback to the client / fiber switch
-    // OR it can go in the Loop operation. I think it's best to do here. adding code to the loop operation
-    // has the potential to increase its native-stack usage. (don't forget ContinueLoopIf too.)
+    // back-edges are metered here rather than in op_Loop, which would grow
+    // its native stack frame (and it nests once per loop level)
+    d_m3BurnFuel ();
 
     void * loopId = immediate (void *);
     return loopId;
@@ -1202,6 +1213,7 @@ d_m3Op  (ContinueLoopIf)
 
     if (condition)
     {
+        d_m3BurnFuel ();
         return loopId;
     }
     else nextOp ();
@@ -48,8 +48,11 @@ void buf_section(Buf *out, int id, Buf *content);
 #define GLOBAL_HEAP      1   /* _heap_ptr: bump allocator pointer (mut i32) */
 #define GLOBAL_DATA_BASE 2   /* address of DATA table in linear memory */
 #define GLOBAL_DATA_IDX  3   /* current READ index (0-based) */
+#define GLOBAL_STR_TOP   4   /* --inline-strings: string arena top (mut i32) */
+#define GLOBAL_FIRST_VAR (inline_strings ? 5 : 4)
 
 #define OP_UNREACHABLE   0x00
+#define OP_NOP           0x01
 #define OP_BLOCK         0x02
 #define OP_LOOP          0x03
 #define OP_IF            0x04
@@ -75,6 +78,7 @@ void buf_section(Buf *out, int id, Buf *content);
 #define OP_I32_CONST     0x41
 #define OP_I64_CONST     0x42
 #define OP_F32_CONST     0x43
+#define OP_F64_CONST     0x44
 #define OP_I32_EQZ       0x45
 #define OP_I32_EQ        0x46
 #define OP_I32_NE        0x47
@@ -82,6 +86,12 @@ void buf_section(Buf *out, int id, Buf *content);
 #define OP_I32_GT_S      0x4A
 #define OP_I32_LE_S      0x4C
 #define OP_I32_GE_S      0x4E
+#define OP_I32_LT_U      0x49
+#define OP_I32_GT_U      0x4B
+#define OP_I32_LE_U      0x4D
+#define OP_I32_GE_U      0x4F
+#define OP_I32_LOAD8_U   0x2D
+#define OP_I32_STORE8    0x3A
 #define OP_F32_EQ        0x5B
 #define OP_F32_NE        0x5C
 #define OP_F32_LT        0x5D
@@ -99,6 +109,9 @@ void buf_section(Buf *out, int id, Buf *content);
 #define OP_I32_MUL       0x6C
 #define OP_I32_DIV_S     0x6D
 #define OP_I32_REM_S     0x6F
+#define OP_I32_DIV_U     0x6E
+#define OP_I32_REM_U     0x70
+#define OP_I32_SHL       0x74
 #define OP_I32_AND       0x71
 #define OP_I32_OR        0x72
 #define OP_I64_ADD       0x7C
@@ -125,9 +138,15 @@ void buf_section(Buf *out, int id, Buf *content);
 #define OP_F32_CONVERT_I32_S 0xB2
 #define OP_F32_CONVERT_I64_S 0xB4
 
+/* 0xFC-prefixed (bulk memory); the sub-opcode follows as a ULEB */
+#define OP_MISC_PREFIX   0xFC
+#define MISC_MEMORY_COPY 0x0A
+#define MISC_MEMORY_FILL 0x0B
+
 #define WASM_I32  0x7F
 #define WASM_I64  0x7E
 #define WASM_F32  0x7D
+#define WASM_F64  0x7C
 #define WASM_VOID 0x40
 
 /* ================================================================
@@ -182,11 +201,12 @@ enum {
     IMP_MALLOC, IMP_FREE, IMP_CALLOC, IMP_REALLOC,
     IMP_INFLATE_FILE, IMP_INFLATE_FILE_TO_MEM, IMP_INFLATE_MEM,
     IMP_DEFLATE_FILE, IMP_DEFLATE_MEM_TO_FILE, IMP_DEFLATE_MEM,
+    IMP_GET_FRAME, IMP_GET_FRAME_RATE,
     IMP_COUNT
 };
 
 extern const ImportDef imp_defs[IMP_COUNT];
-extern uint8_t imp_used[IMP_COUNT];
+extern BW_TLS uint8_t imp_used[IMP_COUNT];
 
 /* ================================================================
  *  Compiler State
@@ -209,6 +229,7 @@ extern uint8_t imp_used[IMP_COUNT];
   #define BW_MAX_LOCALS   256
   #define BW_MAX_FIXUPS   512
 #endif
+#define VAR_HASH_SIZE MAX_VARS    /* power of two */
 #define FMT_BUF_SIZE 256
 #define FILE_TABLE_BASE 0xF100  /* 4 i32 handles at 0xF100..0xF10F */
 
@@ -233,6 +254,7 @@ typedef struct {
     int is_const;       /* 1 if declared with CONST */
     int dim_count;      /* number of DIM dimensions (0 if not an array) */
     int is_declared;    /* 1 = forward-declared via DECLARE, 0 = defined */
+    uint16_t hash_next; /* next older var in its var_hash bucket, index+1 (0=end) */
 } Var;
 
 typedef struct {
@@ -244,6 +266,10 @@ typedef struct {
     int sub_var;            /* variable index of SUB, -1 for setup */
     int call_fixups[BW_MAX_FIXUPS];   /* code offsets of call target LEB128s */
     int ncall_fixups;
+    Buf lines;              /* --release: (code offset, line) int pairs, one
+                             * per __line store, in code order */
+    int str_mark;           /* --inline-strings: local holding the arena mark
+                             * temps are reset to, -1 until first needed */
 } FuncCtx;
 
 enum { CTRL_WHILE, CTRL_FOR, CTRL_IF, CTRL_SELECT, CTRL_DO };
@@ -257,6 +283,8 @@ typedef struct {
     int if_extra_ends;  /* IF: extra nesting from ELSE IF chains */
     int for_step_local; /* FOR STEP: WASM local index for step value */
     int for_has_step;   /* FOR: 1 if explicit STEP, 0 otherwise */
+    int str_mark_save;  /* SELECT on a string (--inline-strings): local with
+                         * the enclosing arena mark, -1 otherwise */
 } CtrlEntry;
 
 /* DATA items (compile-time collection, assembled into data section) */
@@ -279,55 +307,79 @@ typedef struct {
 
 /* Global compiler state */
 #ifdef BAS2WASM_EMBEDDED
-extern Var *vars;
-extern FuncCtx *func_bufs;
-extern CtrlEntry *ctrl_stk;
+extern BW_TLS Var *vars;
+extern BW_TLS uint16_t *var_hash;
+extern BW_TLS FuncCtx *func_bufs;
+extern BW_TLS CtrlEntry *ctrl_stk;
   #ifdef BAS2WASM_USE_PSRAM
-extern uint32_t data_buf;       /* PSRAM address */
-extern uint32_t data_items;     /* PSRAM address */
+extern BW_TLS uint32_t data_buf;       /* PSRAM address */
+extern BW_TLS uint32_t data_items;     /* PSRAM address */
   #else
-extern char *data_buf;
-extern DataItem *data_items;
+extern BW_TLS char *data_buf;
+extern BW_TLS DataItem *data_items;
   #endif
 #else
-extern Var vars[MAX_VARS];
-extern FuncCtx func_bufs[MAX_FUNCS];
-extern CtrlEntry ctrl_stk[MAX_CTRL];
-extern char data_buf[MAX_STRINGS];
-extern DataItem data_items[MAX_DATA_ITEMS];
+extern BW_TLS Var vars[MAX_VARS];
+extern BW_TLS uint16_t var_hash[VAR_HASH_SIZE];
+extern BW_TLS FuncCtx func_bufs[MAX_FUNCS];
+extern BW_TLS CtrlEntry ctrl_stk[MAX_CTRL];
+extern BW_TLS char data_buf[MAX_STRINGS];
+extern BW_TLS DataItem data_items[MAX_DATA_ITEMS];
 #endif
-extern int nvar;
-extern int nfuncs;
-extern int cur_func;
-extern int ctrl_sp;
-extern int block_depth;
-
-extern int data_len;
-
-extern int ndata_items;
+extern BW_TLS int nvar;
+extern BW_TLS int nfuncs;
+extern BW_TLS int cur_func;
+extern BW_TLS int ctrl_sp;
+extern BW_TLS int block_depth;
 
-extern char *source;
-extern int source_owned;        /* 1 = compiler owns `source`, must free */
-extern char bw_include_dir[256];/* dir prefix for $INCLUDE files ("" = none) */
-extern int src_len;
-extern int src_pos;
-extern char line_buf[512];
-extern char *lp;
-extern int line_num;
+extern BW_TLS int data_len;
 
-extern int tok, tokv, ungot;
-extern int64_t tokq;
-extern int tok_num_is_i64;
-extern float tokf;
-extern char tokn[16];
+extern BW_TLS int ndata_items;
 
-extern VType vstack[64];
-extern int vsp;
+extern int release_mode;        /* --release: __line stores become a
+                                 * conez.lines table (assemble.c); a setting
+                                 * shared by all threads, not per-thread state */
+extern int inline_strings;      /* --inline-strings: string ops run in the
+                                 * module (runtime.c); shared like release_mode */
+extern int shrink_mode;         /* --shrink: size pass over the finished module, */
+extern int size_report;         /* --size-report: what it saves (assemble.c) */
 
-extern int had_error;
-extern int option_base;
-
-extern FoldSlot fold_p, fold_a, fold_b;
+typedef struct {
+    int before[12], after[12];          /* bytes per section id, header included */
+    int funcs, imports, types, locals;  /* dropped by the size pass */
+    int data_bytes;                     /* data left to memory's zeros or merged */
+    int str_bytes;                      /* string literal bytes shared */
+    int skipped;                        /* module not understood, left as is */
+} ShrinkStats;
+extern BW_TLS ShrinkStats shrink_stats;
+extern BW_TLS Buf str_lits;     /* offsets of the string literals, for --shrink */
+int  find_string(const char *s, int len);
+void note_string(int off);
+void trim_strings(void);
+int  shared_literal(int off);
+
+extern BW_TLS char *source;
+extern BW_TLS int source_owned;        /* 1 = compiler owns `source`, must free */
+extern BW_TLS char bw_include_dir[256];/* dir prefix for $INCLUDE files ("" = none) */
+extern BW_TLS int src_len;
+extern BW_TLS int src_pos;
+extern BW_TLS char line_buf[512];
+extern BW_TLS char *lp;
+extern BW_TLS int line_num;
+
+extern BW_TLS int tok, tokv, ungot;
+extern BW_TLS int64_t tokq;
+extern BW_TLS int tok_num_is_i64;
+extern BW_TLS float tokf;
+extern BW_TLS char tokn[16];
+
+extern BW_TLS VType vstack[64];
+extern BW_TLS int vsp;
+
+extern BW_TLS int had_error;
+extern BW_TLS int option_base;
+
+extern BW_TLS FoldSlot fold_p, fold_a, fold_b;
 
 /* ================================================================
  *  Lexer tokens
@@ -368,9 +420,18 @@ static inline void error_at(const char *msg) {
     had_error = 1;
 }
 
+/* Every name the lexer meets (keywords aside) goes through add_var, so
+ * names hash to buckets chained through Var.hash_next. Chains hold
+ * index+1 so a zeroed table is empty. */
+static inline unsigned var_hash_of(const char *name) {
+    uint32_t h = 2166136261u;                   /* FNV-1a */
+    while (*name) h = (h ^ (uint8_t)*name++) * 16777619u;
+    return h & (VAR_HASH_SIZE - 1);
+}
+
 static inline int find_var(const char *name) {
-    for (int i = 0; i < nvar; i++)
-        if (strcmp(vars[i].name, name) == 0) return i;
+    for (int i = var_hash[var_hash_of(name)]; i; i = vars[i - 1].hash_next)
+        if (strcmp(vars[i - 1].name, name) == 0) return i - 1;
     return -1;
 }
 
@@ -393,7 +454,10 @@ static inline int add_var(const char *name) {
     } else {
         vars[nvar].type = T_I32;
     }
-    vars[nvar].global_idx = nvar + 4;
+    vars[nvar].global_idx = nvar + GLOBAL_FIRST_VAR;
+    unsigned h = var_hash_of(vars[nvar].name);
+    vars[nvar].hash_next = var_hash[h];
+    var_hash[h] = (uint16_t)(nvar + 1);
     return nvar++;
 }
 
@@ -444,7 +508,9 @@ static inline void dbuf_set(int pos, char c) {
 #endif
 }
 
-static inline int add_string(const char *s, int len) {
+/* Append a string to the data section. One patched after it's added
+ * (FORMAT's) must come from here, never shared. */
+static inline int append_string(const char *s, int len) {
     if (data_len + len + 1 > MAX_STRINGS) { error_at("string table full"); return 0; }
     int off = data_len;
 #ifdef BAS2WASM_USE_PSRAM
@@ -459,6 +525,15 @@ static inline int add_string(const char *s, int len) {
     return off;
 }
 
+/* Under --shrink, equal strings share storage */
+static inline int add_string(const char *s, int len) {
+    int off = shrink_mode ? find_string(s, len) : -1;
+    if (off >= 0) { shrink_stats.str_bytes += len + 1; return off; }
+    off = append_string(s, len);
+    if (shrink_mode) note_string(off);
+    return off;
+}
+
 static inline void vpush(VType t) {
     if (vsp >= 64) { error_at("expression too complex"); return; }
     vstack[vsp++] = t;
@@ -504,6 +579,17 @@ static inline void emit_call(int func_idx) {
     buf_uleb(CODE, func_idx);
     if (func_idx < IMP_COUNT) imp_used[func_idx] = 1;
 }
+/* Statement boundary: __line = line_num. With --release the store is
+ * logged so assemble_to_buf() can drop it and map its offset instead. */
+static inline void emit_line_mark(void) {
+    FuncCtx *f = &func_bufs[cur_func];
+    if (release_mode) {
+        int m[2] = { f->code.len, line_num };
+        buf_bytes(&f->lines, m, sizeof(m));
+    }
+    emit_i32_const(line_num);
+    buf_byte(CODE, OP_GLOBAL_SET); buf_uleb(CODE, GLOBAL_LINE);
+}
 static inline void emit_global_get(int idx) {
     buf_byte(CODE, OP_GLOBAL_GET); buf_uleb(CODE, idx);
 }
@@ -534,6 +620,10 @@ static inline void emit_i64_load(int offset) {
 static inline void emit_i64_store(int offset) {
     buf_byte(CODE, OP_I64_STORE); buf_uleb(CODE, 3); buf_uleb(CODE, offset);
 }
+/* memory.copy [dst src n], memory index 0 (memmove semantics) */
+static inline void emit_memory_copy(void) {
+    buf_byte(CODE, OP_MISC_PREFIX); buf_uleb(CODE, MISC_MEMORY_COPY); buf_byte(CODE, 0); buf_byte(CODE, 0);
+}
 static inline void emit_block(void)  { buf_byte(CODE, OP_BLOCK); buf_byte(CODE, WASM_VOID); block_depth++; }
 static inline void emit_loop(void)   { buf_byte(CODE, OP_LOOP);  buf_byte(CODE, WASM_VOID); block_depth++; }
 static inline void emit_if_void(void){ buf_byte(CODE, OP_IF);    buf_byte(CODE, WASM_VOID); block_depth++; }
@@ -606,18 +696,42 @@ void need(int t);
 /* expr.c */
 void expr(void);
 void base_expr(void);
+void add_operand(void);
 int compile_builtin_expr(const char *name);
 
 /* stmt.c */
 void stmt(void);
 
 /* assemble.c */
+Buf  shrink_module(const Buf *in);
 Buf  assemble_to_buf(void);
 void assemble(const char *outpath);
 
 /* stmt.c */
 void stmt_reset(void);
 
+/* runtime.c — the in-module string runtime (--inline-strings) */
+#define STR_RT_BASE    (IMP_COUNT + MAX_FUNCS)  /* emit_call() index of helper 0 */
+#define STR_ARENA_SIZE 4096                     /* temp arena after the data */
+void emit_str_op(int imp);
+void emit_str_set_global(int g);
+void emit_str_assign(void);
+void emit_str_append(void);
+void emit_str_dup(void);
+void emit_str_mid_assign(void);
+void str_temp_begin(void);
+void str_stmt_begin(void);
+void str_func_exit(int at_end);
+int  str_mark_raise(void);
+void str_mark_restore(int save);
+int  str_literal(int off);
+void str_rt_reset(void);
+int  str_rt_close(void);
+int  str_rt_slot(int h);
+void str_rt_sig(int k, int *np, int *nr);
+void str_rt_prologue(Buf *out, const FuncCtx *f);
+void str_rt_code(Buf *sec, int first_func, const int *imp_remap, uint32_t arena_end);
+
 /* main.c */
 void bw_compile(void);
 
@@ -8,10 +8,10 @@
 #include <stdarg.h>
 
 /* --- Callback state --- */
-bw_diag_fn bw_on_error = NULL;
-bw_diag_fn bw_on_info  = NULL;
-void *bw_cb_ctx = NULL;
-jmp_buf bw_bail;
+BW_TLS bw_diag_fn bw_on_error = NULL;
+BW_TLS bw_diag_fn bw_on_info  = NULL;
+BW_TLS void *bw_cb_ctx = NULL;
+BW_TLS jmp_buf bw_bail;
 
 /* --- Memory wrappers --- */
 void *bw_malloc(size_t n)           { return malloc(n); }
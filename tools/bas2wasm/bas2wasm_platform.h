@@ -10,15 +10,35 @@
 #include <stddef.h>
 #include <setjmp.h>
 
+/* Compiler state is per thread, so threads can compile at once (--jobs,
+ * the simulator's compiler workers). BAS2WASM_NO_TLS keeps plain globals
+ * for the firmware, where a task's TLS block comes out of its stack. */
+#if defined(BAS2WASM_NO_TLS)
+#define BW_TLS
+#elif defined(__cplusplus)
+#define BW_TLS thread_local
+#elif defined(_MSC_VER)
+#define BW_TLS __declspec(thread)
+#else
+#define BW_TLS _Thread_local
+#endif
+
+/* Phase marks: BW_PHASE(parse) before the first source line is read,
+ * BW_PHASE(assemble) before linking, BW_PHASE(done) after. Nothing
+ * unless the includer defines it (tools/compile_bench times them). */
+#ifndef BW_PHASE
+#define BW_PHASE(p) ((void)0)
+#endif
+
 /* --- Diagnostic callbacks (always visible for API consumers) --- */
 typedef void (*bw_diag_fn)(const char *msg, void *ctx);
 
 #ifdef BAS2WASM_EMBEDDED
 
-extern bw_diag_fn bw_on_error;
-extern bw_diag_fn bw_on_info;
-extern void *bw_cb_ctx;
-extern jmp_buf bw_bail;
+extern BW_TLS bw_diag_fn bw_on_error;
+extern BW_TLS bw_diag_fn bw_on_info;
+extern BW_TLS void *bw_cb_ctx;
+extern BW_TLS jmp_buf bw_bail;
 
 /* --- Memory --- */
 void *bw_malloc(size_t n);
@@ -66,6 +86,7 @@ void     bw_psram_write(uint32_t addr, const void *src, size_t len);
 #define tok            bw_tok
 #define vars           bw_vars
 #define nvar           bw_nvar
+#define var_hash       bw_var_hash
 #define data_buf       bw_data_buf
 #define data_len       bw_data_len
 #define data_items     bw_data_items
@@ -86,6 +107,17 @@ void     bw_psram_write(uint32_t addr, const void *src, size_t len);
 #define fold_a         bw_fold_a
 #define fold_b         bw_fold_b
 #define source_owned   bw_source_owned
+#define release_mode   bw_release_mode
+#define inline_strings bw_inline_strings
+#define shrink_mode    bw_shrink_mode
+#define size_report    bw_size_report
+#define shrink_stats   bw_shrink_stats
+#define shrink_module  bw_shrink_module
+#define str_lits       bw_str_lits
+#define find_string    bw_find_string
+#define note_string    bw_note_string
+#define trim_strings   bw_trim_strings
+#define shared_literal bw_shared_literal
 
 #else /* standalone */
 
@@ -98,7 +130,10 @@ void     bw_psram_write(uint32_t addr, const void *src, size_t len);
 #define bw_free     free
 #define bw_error(fmt, ...)  fprintf(stderr, fmt, ##__VA_ARGS__)
 #define bw_info(fmt, ...)   printf(fmt, ##__VA_ARGS__)
-#define bw_fatal(fmt, ...)  do { fprintf(stderr, fmt, ##__VA_ARGS__); exit(1); } while(0)
+extern BW_TLS jmp_buf *bw_job_bail;
+#define bw_fatal(fmt, ...)  do { fprintf(stderr, fmt, ##__VA_ARGS__); \
+                                 if (bw_job_bail) longjmp(*bw_job_bail, 1); \
+                                 exit(1); } while(0)
 
 #endif /* BAS2WASM_EMBEDDED */
 
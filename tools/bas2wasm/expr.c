@@ -258,6 +258,8 @@ static const SimpleBI simple_bi[] = {
     {"UPTIME",      0, IMP_MILLIS,       0},
     {"UPTIME&",     0, IMP_MILLIS64,     0},
     {"CUEELAPSED&", 0, IMP_CUE_ELAPSED,  0},
+    {"FRAME&",      0, IMP_GET_FRAME,    0},
+    {"FRAMERATE",   0, IMP_GET_FRAME_RATE, 0},
     {"BATPCT",      0, IMP_GET_BATTERY_PERCENTAGE, 1},
     {"BATRUNTIME",  0, IMP_GET_BATTERY_RUNTIME,    1},
     {"SUNAZ",       0, IMP_GET_SUN_AZIMUTH,        1},
@@ -403,7 +405,7 @@ int compile_builtin_expr(const char *name) {
             if (b->arg_types[i] == 1) coerce_i32();
         }
         need(TOK_RP);
-        emit_call(b->imp);
+        emit_str_op(b->imp);
         vsp = base_vsp;
         vpush(b->result);
         return 1;
@@ -782,18 +784,51 @@ int compile_builtin_expr(const char *name) {
         emit_local_set(val); emit_local_set(end);
         emit_local_set(start); emit_local_set(arr);
         vpop(); vpop(); vpop(); vpop();   /* consume arr, start, end, val arg types */
-        int i = alloc_local();
-        emit_local_get(start); emit_local_set(i);
-        emit_block(); emit_loop();
-            emit_local_get(i); emit_local_get(end); emit_op(OP_I32_GT_S);
-            emit_br_if(1);
-            emit_local_get(arr); emit_local_get(i);
-            emit_i32_const(4); emit_op(OP_I32_MUL); emit_op(OP_I32_ADD);
-            emit_local_get(val);
-            emit_i32_store(0);
-            emit_local_get(i); emit_i32_const(1); emit_op(OP_I32_ADD); emit_local_set(i);
-            emit_br(0);
-        emit_end(); emit_end();
+        /* arr is the DIM header: [ndims][ubound...][data]. Clamp the range
+         * to the first dimension, store the first element, then double the
+         * filled run with memory.copy: log2(n) bulk copies instead of a
+         * store per element. */
+        int base = alloc_local(), bytes = alloc_local(), done = alloc_local();
+        emit_local_get(start); emit_i32_const(option_base);
+        emit_local_get(start); emit_i32_const(option_base); emit_op(OP_I32_GT_S);
+        emit_op(OP_SELECT); emit_local_set(start);
+        emit_local_get(arr);
+        emit_if_void();
+            emit_local_get(end); emit_local_get(arr); emit_i32_load(4);
+            emit_local_get(end); emit_local_get(arr); emit_i32_load(4); emit_op(OP_I32_LT_S);
+            emit_op(OP_SELECT); emit_local_set(end);
+            emit_local_get(start); emit_local_get(end); emit_op(OP_I32_LE_S);
+            emit_if_void();
+                emit_local_get(arr);
+                emit_local_get(arr); emit_i32_load(0);
+                emit_i32_const(1); emit_op(OP_I32_ADD);
+                emit_local_get(start); emit_op(OP_I32_ADD);
+                emit_i32_const(option_base); emit_op(OP_I32_SUB);
+                emit_i32_const(4); emit_op(OP_I32_MUL); emit_op(OP_I32_ADD);
+                emit_local_set(base);
+                emit_local_get(base); emit_local_get(val); emit_i32_store(0);
+                emit_local_get(end); emit_local_get(start); emit_op(OP_I32_SUB);
+                emit_i32_const(1); emit_op(OP_I32_ADD);
+                emit_i32_const(4); emit_op(OP_I32_MUL); emit_local_set(bytes);
+                emit_i32_const(4); emit_local_set(done);
+                emit_block(); emit_loop();
+                    emit_local_get(done); emit_local_get(bytes); emit_op(OP_I32_GE_S);
+                    emit_br_if(1);
+                    /* copy min(done, bytes - done) from base to base + done */
+                    emit_local_get(base); emit_local_get(done); emit_op(OP_I32_ADD);
+                    emit_local_get(base);
+                    emit_local_get(done);
+                    emit_local_get(bytes); emit_local_get(done); emit_op(OP_I32_SUB);
+                    emit_local_get(done);
+                    emit_local_get(bytes); emit_local_get(done); emit_op(OP_I32_SUB);
+                    emit_op(OP_I32_LT_S);
+                    emit_op(OP_SELECT);
+                    emit_memory_copy();
+                    emit_local_get(done); emit_i32_const(2); emit_op(OP_I32_MUL); emit_local_set(done);
+                    emit_br(0);
+                emit_end(); emit_end();
+            emit_end();
+        emit_end();
         emit_i32_const(0); vpush(T_I32);
         return 1;
     }
@@ -825,26 +860,26 @@ int compile_builtin_expr(const char *name) {
         expr(); need(TOK_RP);
         VType t = vpop();
         if (t == T_F32) {
-            emit_call(IMP_STR_FROM_FLOAT);
+            emit_str_op(IMP_STR_FROM_FLOAT);
         } else if (t == T_I64) {
-            emit_call(IMP_STR_FROM_I64);
+            emit_str_op(IMP_STR_FROM_I64);
         } else {
-            emit_call(IMP_STR_FROM_INT);
+            emit_str_op(IMP_STR_FROM_INT);
         }
         vpush(T_STR);
         return 1;
     }
     /* INSTR — optional 3rd arg */
     if (strcmp(name, "INSTR") == 0) {
-        expr(); need(TOK_COMMA);
-        expr();
+        expr(); vpop(); need(TOK_COMMA);
+        expr(); vpop();
         if (want(TOK_COMMA)) {
-            expr(); coerce_i32();
+            expr(); coerce_i32(); vpop();
         } else {
             emit_i32_const(1);
         }
         need(TOK_RP);
-        emit_call(IMP_STR_INSTR);
+        emit_str_op(IMP_STR_INSTR);
         vpush(T_I32);
         return 1;
     }
@@ -939,7 +974,7 @@ void base_expr(void) {
         emit_f32_const(tokf);
         vpush(T_F32);
     } else if (want(TOK_STRING)) {
-        emit_i32_const(tokv);
+        emit_i32_const(inline_strings ? str_literal(tokv) : shared_literal(tokv));
         vpush(T_STR);
     } else if (want(TOK_NAME)) {
         int var = tokv;
@@ -999,7 +1034,8 @@ void base_expr(void) {
                     vpush(T_F32);
                 } else if (vars[var].type == T_STR) {
                     emit_i32_load(0);          /* load pointer */
-                    emit_call(IMP_STR_COPY);   /* return fresh duplicate */
+                    if (!inline_strings)       /* (the runtime's strings are borrowed) */
+                        emit_call(IMP_STR_COPY);   /* return fresh duplicate */
                     vpush(T_STR);
                 } else {
                     emit_i32_load(0);
@@ -1031,6 +1067,8 @@ void base_expr(void) {
                 } else {
                     if (nargs != vars[var].param_count)
                         error_at("wrong number of arguments");
+                    if (inline_strings && vars[var].type == T_STR)
+                        str_temp_begin();   /* it returns a temp */
                     emit_call(IMP_COUNT + vars[var].func_local_idx);
                 }
                 vpush(vars[var].type_set ? vars[var].type : T_I32);
@@ -1155,6 +1193,11 @@ static void factor(void) {
     }
 }
 
+/* One operand of + or - */
+void add_operand(void) {
+    factor();
+}
+
 static void addition(void) {
     factor();
     while (want(0), tok >= TOK_ADD && tok <= TOK_SUB) {
@@ -1163,7 +1206,7 @@ static void addition(void) {
         factor();
         if (op == TOK_ADD && vsp >= 2 && vstack[vsp-1] == T_STR && vstack[vsp-2] == T_STR) {
             vpop(); vpop();
-            emit_call(IMP_STR_CONCAT);
+            emit_str_op(IMP_STR_CONCAT);
             vpush(T_STR);
         } else if (vsp >= 2 && (vstack[vsp-1] == T_STR || vstack[vsp-2] == T_STR)) {
             error_at("cannot mix strings and numbers with + or -");
@@ -1183,7 +1226,7 @@ static void relation(void) {
         addition();
         if (vsp >= 2 && vstack[vsp-1] == T_STR && vstack[vsp-2] == T_STR) {
             vpop(); vpop();
-            emit_call(IMP_STR_CMP);
+            emit_str_op(IMP_STR_CMP);
             switch (op) {
             case TOK_EQ: emit_op(OP_I32_EQZ); break;
             case TOK_NE: emit_i32_const(0); emit_op(OP_I32_NE); break;
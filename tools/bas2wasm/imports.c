@@ -150,10 +150,12 @@ const ImportDef imp_defs[IMP_COUNT] = {
     [IMP_DEFLATE_FILE]   = {"deflate_file",          2,{_I,_I},         1,{_I}},
     [IMP_DEFLATE_MEM_TO_FILE]={"deflate_mem_to_file",3,{_I,_I,_I},      1,{_I}},
     [IMP_DEFLATE_MEM]    = {"deflate_mem",           4,{_I,_I,_I,_I},   1,{_I}},
+    [IMP_GET_FRAME]      = {"get_frame",             0,{},              1,{_L}},
+    [IMP_GET_FRAME_RATE] = {"get_frame_rate",        0,{},              1,{_I}},
 };
 #undef _I
 #undef _L
 #pragma pop_macro("_L")
 #undef _F
 
-uint8_t imp_used[IMP_COUNT];
+BW_TLS uint8_t imp_used[IMP_COUNT];
@@ -36,8 +36,8 @@ static const char *kwd[] = {
  * ================================================================ */
 #define BW_MAX_INCLUDE_DEPTH 8
 typedef struct { int restore_line; int end_pos; } BwIncFrame;
-static BwIncFrame bw_inc_stk[BW_MAX_INCLUDE_DEPTH];
-static int bw_inc_sp;
+static BW_TLS BwIncFrame bw_inc_stk[BW_MAX_INCLUDE_DEPTH];
+static BW_TLS int bw_inc_sp;
 
 void bw_include_reset(void) { bw_inc_sp = 0; }
 
@@ -3,70 +3,75 @@
  */
 #include "bas2wasm.h"
 
-/* Global compiler state definitions */
+/* Global compiler state, one copy per thread (BW_TLS) */
 #ifdef BAS2WASM_EMBEDDED
-Var *vars;
-FuncCtx *func_bufs;
-CtrlEntry *ctrl_stk;
+BW_TLS Var *vars;
+BW_TLS uint16_t *var_hash;
+BW_TLS FuncCtx *func_bufs;
+BW_TLS CtrlEntry *ctrl_stk;
   #ifdef BAS2WASM_USE_PSRAM
-uint32_t data_buf;
-uint32_t data_items;
+BW_TLS uint32_t data_buf;
+BW_TLS uint32_t data_items;
   #else
-char *data_buf;
-DataItem *data_items;
+BW_TLS char *data_buf;
+BW_TLS DataItem *data_items;
   #endif
 #else
-Var vars[MAX_VARS];
-FuncCtx func_bufs[MAX_FUNCS];
-CtrlEntry ctrl_stk[MAX_CTRL];
-char data_buf[MAX_STRINGS];
-DataItem data_items[MAX_DATA_ITEMS];
+BW_TLS Var vars[MAX_VARS];
+BW_TLS uint16_t var_hash[VAR_HASH_SIZE];
+BW_TLS FuncCtx func_bufs[MAX_FUNCS];
+BW_TLS CtrlEntry ctrl_stk[MAX_CTRL];
+BW_TLS char data_buf[MAX_STRINGS];
+BW_TLS DataItem data_items[MAX_DATA_ITEMS];
 #endif
-int nvar;
-int nfuncs;
-int cur_func;
-int ctrl_sp;
-int block_depth;
+BW_TLS int nvar;
+BW_TLS int nfuncs;
+BW_TLS int cur_func;
+BW_TLS int ctrl_sp;
+BW_TLS int block_depth;
 
-int data_len;
+BW_TLS int data_len;
 
-int ndata_items;
+BW_TLS int ndata_items;
 
-char *source;
-int source_owned;   /* 1 = we bw_malloc'd `source` and must free it */
-char bw_include_dir[256];   /* dir prefix for $INCLUDE files ("" = none) */
-int src_len;
-int src_pos;
-char line_buf[512];
-char *lp;
-int line_num;
+BW_TLS char *source;
+BW_TLS int source_owned;   /* 1 = we bw_malloc'd `source` and must free it */
+BW_TLS char bw_include_dir[256];   /* dir prefix for $INCLUDE files ("" = none) */
+BW_TLS int src_len;
+BW_TLS int src_pos;
+BW_TLS char line_buf[512];
+BW_TLS char *lp;
+BW_TLS int line_num;
 
-int tok, tokv, ungot;
-int64_t tokq;
-int tok_num_is_i64;
-float tokf;
-char tokn[16];
+BW_TLS int tok, tokv, ungot;
+BW_TLS int64_t tokq;
+BW_TLS int tok_num_is_i64;
+BW_TLS float tokf;
+BW_TLS char tokn[16];
 
-VType vstack[64];
-int vsp;
+BW_TLS VType vstack[64];
+BW_TLS int vsp;
 
-int had_error;
-int option_base;
+BW_TLS int had_error;
+BW_TLS int option_base;
 
-FoldSlot fold_p, fold_a, fold_b;
+BW_TLS FoldSlot fold_p, fold_a, fold_b;
 
 void bw_compile(void) {
     nfuncs = 1;
     buf_init(&func_bufs[0].code);
+    buf_init(&func_bufs[0].lines);
     func_bufs[0].nparams = 0;
     func_bufs[0].nlocals = 0;
     func_bufs[0].ncall_fixups = 0;
     func_bufs[0].sub_var = -1;
+    func_bufs[0].str_mark = -1;
     cur_func = 0;
     block_depth = 0;
     ctrl_sp = 0;
     vsp = 0;
     nvar = 0;
+    memset(var_hash, 0, VAR_HASH_SIZE * sizeof(uint16_t));
     data_len = 0;
     ndata_items = 0;
     had_error = 0;
@@ -78,6 +83,9 @@ void bw_compile(void) {
     fold_a.valid = 0;
     fold_b.valid = 0;
     memset(imp_used, 0, sizeof(imp_used));
+    str_rt_reset();
+    str_lits.len = 0;
+    shrink_stats.str_bytes = 0;
 
     /* Initialize file handle table to -1 (closed) */
     for (int i = 0; i < 4; i++) {
@@ -86,6 +94,7 @@ void bw_compile(void) {
         emit_i32_store(0);
     }
 
+    BW_PHASE(parse);
     while (next_line()) {
         ungot = 0;
         vsp = 0;
@@ -118,6 +127,7 @@ Buf bas2wasm_compile_buffer(const char *src, int len) {
 
 #ifdef BAS2WASM_EMBEDDED
     vars = (Var *)bw_calloc(MAX_VARS, sizeof(Var));
+    var_hash = (uint16_t *)bw_calloc(VAR_HASH_SIZE, sizeof(uint16_t));
     func_bufs = (FuncCtx *)bw_calloc(MAX_FUNCS, sizeof(FuncCtx));
     ctrl_stk = (CtrlEntry *)bw_calloc(MAX_CTRL, sizeof(CtrlEntry));
 #ifdef BAS2WASM_USE_PSRAM
@@ -127,7 +137,7 @@ Buf bas2wasm_compile_buffer(const char *src, int len) {
     data_buf = (char *)bw_calloc(MAX_STRINGS, 1);
     data_items = (DataItem *)bw_calloc(MAX_DATA_ITEMS, sizeof(DataItem));
 #endif
-    if (!vars || !func_bufs || !ctrl_stk || !data_buf || !data_items) {
+    if (!vars || !var_hash || !func_bufs || !ctrl_stk || !data_buf || !data_items) {
         bw_error("bas2wasm: out of memory\n");
         bas2wasm_reset();
         return result;
@@ -156,7 +166,9 @@ Buf bas2wasm_compile_buffer(const char *src, int len) {
         return result;  /* len == 0 signals error */
     }
 
+    BW_PHASE(assemble);
     result = assemble_to_buf();
+    BW_PHASE(done);
     return result;
 }
 
@@ -166,11 +178,14 @@ void bas2wasm_reset(void) {
     if (func_bufs)
 #endif
     {
-        for (int i = 0; i < nfuncs; i++)
+        for (int i = 0; i < nfuncs; i++) {
             buf_free(&func_bufs[i].code);
+            buf_free(&func_bufs[i].lines);
+        }
     }
 #ifdef BAS2WASM_EMBEDDED
     bw_free(vars);       vars = NULL;
+    bw_free(var_hash);   var_hash = NULL;
     bw_free(func_bufs);  func_bufs = NULL;
     bw_free(ctrl_stk);   ctrl_stk = NULL;
 #ifdef BAS2WASM_USE_PSRAM
@@ -196,6 +211,8 @@ void bas2wasm_reset(void) {
     fold_b.valid = 0;
     memset(imp_used, 0, sizeof(imp_used));
     stmt_reset();
+    str_rt_reset();
+    buf_free(&str_lits);
     if (source_owned && source) bw_free(source);
     source_owned = 0;
     source = NULL;
@@ -205,7 +222,7 @@ void bas2wasm_reset(void) {
 }
 
 const char *bas2wasm_version_string(void) {
-    static char buf[64];
+    static BW_TLS char buf[64];
     snprintf(buf, sizeof(buf), "bas2wasm %d.%02d.%04d (API %d, %d imports)",
              BAS2WASM_VERSION_MAJOR, BAS2WASM_VERSION_MINOR, BUILD_NUMBER,
              CONEZ_API_VERSION, IMP_COUNT);
@@ -218,9 +235,156 @@ const char *bas2wasm_version_string(void) {
 
 #ifndef BAS2WASM_EMBEDDED
 
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+BW_TLS jmp_buf *bw_job_bail;
+
+/* Default output: replace .bas with .wasm */
+static void default_output(const char *inpath, char *out, size_t n) {
+    strncpy(out, inpath, n - 6);
+    out[n - 6] = '\0';
+    char *dot = strrchr(out, '.');
+    if (dot) strcpy(dot, ".wasm");
+    else strncat(out, ".wasm", n - strlen(out) - 1);
+}
+
+/* Read the input into `source`; 0 on failure */
+static int read_source(const char *inpath) {
+    FILE *fp = fopen(inpath, "r");
+    if (!fp) { fprintf(stderr, "Cannot open %s\n", inpath); return 0; }
+    fseek(fp, 0, SEEK_END);
+    src_len = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    source = malloc(src_len + 1);
+    if ((int)fread(source, 1, src_len, fp) != src_len) {
+        fprintf(stderr, "Read error on %s\n", inpath);
+        free(source);
+        source = NULL;
+        fclose(fp);
+        return 0;
+    }
+    source[src_len] = 0;
+    fclose(fp);
+    source_owned = 1;   /* so $INCLUDE splices can free intermediates */
+
+    /* $INCLUDE files resolve relative to the input file's directory. */
+    const char *slash = strrchr(inpath, '/');
+    size_t dlen = slash ? (size_t)(slash - inpath + 1) : 0;
+    if (dlen >= sizeof(bw_include_dir)) dlen = sizeof(bw_include_dir) - 1;
+    memcpy(bw_include_dir, inpath, dlen);
+    bw_include_dir[dlen] = 0;
+    return 1;
+}
+
+/* ---- --jobs N: compile many files (a show directory) on N threads ----
+ *
+ * Compiler state is per thread (BW_TLS), so each worker claims the next
+ * file and compiles it as the single-file path would. A fatal error
+ * longjmps back to the worker through bw_job_bail and fails only that
+ * file. Messages from different files may interleave line by line. */
+
+typedef struct {
+    char **files;
+    int nfiles;
+    int next;           /* next file to claim */
+    int failed;
+    pthread_mutex_t lock;
+} Batch;
+
+static int batch_compile(const char *inpath) {
+    char outpath[512];
+    default_output(inpath, outpath, sizeof(outpath));
+
+    volatile int ok = 0;
+    if (setjmp(*bw_job_bail) == 0 && read_source(inpath)) {
+        bw_compile();
+        if (!had_error) {
+            assemble(outpath);
+            ok = 1;
+        }
+    }
+    if (!ok) fprintf(stderr, "%s: compilation failed.\n", inpath);
+    bas2wasm_reset();
+    return ok;
+}
+
+static void *batch_worker(void *arg) {
+    Batch *b = (Batch *)arg;
+    jmp_buf bail;
+    bw_job_bail = &bail;
+    for (;;) {
+        pthread_mutex_lock(&b->lock);
+        int i = b->next++;
+        pthread_mutex_unlock(&b->lock);
+        if (i >= b->nfiles) break;
+        if (!batch_compile(b->files[i])) {
+            pthread_mutex_lock(&b->lock);
+            b->failed++;
+            pthread_mutex_unlock(&b->lock);
+        }
+    }
+    bw_job_bail = NULL;
+    return NULL;
+}
+
+static int cmp_str(const void *a, const void *b) {
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/* Add a file, or every .bas file directly inside a directory */
+static void batch_add(Batch *b, const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        b->files = realloc(b->files, (b->nfiles + 1) * sizeof(char *));
+        b->files[b->nfiles++] = strdup(path);
+        return;
+    }
+    DIR *d = opendir(path);
+    if (!d) { fprintf(stderr, "Cannot open directory %s\n", path); b->failed++; return; }
+    int first = b->nfiles;
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        int len = strlen(e->d_name);
+        if (len < 5 || strcmp(e->d_name + len - 4, ".bas") != 0) continue;
+        char *f = malloc(strlen(path) + len + 2);
+        sprintf(f, "%s/%s", path, e->d_name);
+        b->files = realloc(b->files, (b->nfiles + 1) * sizeof(char *));
+        b->files[b->nfiles++] = f;
+    }
+    closedir(d);
+    qsort(b->files + first, b->nfiles - first, sizeof(char *), cmp_str);
+}
+
+static int batch_main(int jobs, char **inputs, int ninputs) {
+    Batch b = { NULL, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER };
+    for (int i = 0; i < ninputs; i++)
+        batch_add(&b, inputs[i]);
+    if (jobs > b.nfiles) jobs = b.nfiles;
+
+    pthread_t *tids = malloc((jobs > 0 ? jobs : 1) * sizeof(pthread_t));
+    int started = 0;
+    for (; started < jobs; started++)
+        if (pthread_create(&tids[started], NULL, batch_worker, &b) != 0) break;
+    if (started == 0 && b.nfiles > 0)
+        batch_worker(&b);       /* no threads to be had: compile them here */
+    for (int i = 0; i < started; i++)
+        pthread_join(tids[i], NULL);
+    free(tids);
+
+    printf("bas2wasm: %d files, %d failed\n", b.nfiles, b.failed);
+    for (int i = 0; i < b.nfiles; i++) free(b.files[i]);
+    free(b.files);
+    return b.failed ? 1 : 0;
+}
+
 int main(int argc, char **argv) {
     const char *inpath = NULL;
     const char *outpath = NULL;
+    int jobs = 0;
+    char **inputs = malloc(argc * sizeof(char *));
+    int ninputs = 0;
 
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-o") == 0 && i+1 < argc) {
@@ -230,8 +394,22 @@ int main(int argc, char **argv) {
                    BAS2WASM_VERSION_MAJOR, BAS2WASM_VERSION_MINOR, BUILD_NUMBER,
                    CONEZ_API_VERSION, IMP_COUNT);
             return 0;
+        } else if (strcmp(argv[i], "--release") == 0) {
+            release_mode = 1;
+        } else if (strcmp(argv[i], "--inline-strings") == 0) {
+            inline_strings = 1;
+        } else if (strcmp(argv[i], "--shrink") == 0) {
+            shrink_mode = 1;
+        } else if (strcmp(argv[i], "--size-report") == 0) {
+            size_report = 1;
+        } else if (strcmp(argv[i], "--jobs") == 0 && i+1 < argc) {
+            jobs = atoi(argv[++i]);
+            if (jobs < 1) {
+                fprintf(stderr, "--jobs needs a thread count of at least 1\n");
+                return 1;
+            }
         } else if (argv[i][0] != '-') {
-            inpath = argv[i];
+            inpath = inputs[ninputs++] = argv[i];
         } else {
             fprintf(stderr, "Unknown option: %s\n", argv[i]);
             return 1;
@@ -239,48 +417,30 @@ int main(int argc, char **argv) {
     }
 
     if (!inpath) {
-        fprintf(stderr, "Usage: bas2wasm input.bas [-o output.wasm]\n");
+        fprintf(stderr, "Usage: bas2wasm input.bas [--release] [--inline-strings] [--shrink] [--size-report]\n"
+                        "                [-o output.wasm]\n"
+                        "       bas2wasm --jobs N <file.bas|dir>... [--release] [--inline-strings] [--shrink]\n");
         return 1;
     }
 
-    /* Default output: replace .bas with .wasm */
+    if (jobs) {
+        if (outpath) {
+            fprintf(stderr, "-o can't be used with --jobs\n");
+            return 1;
+        }
+        int ret = batch_main(jobs, inputs, ninputs);
+        free(inputs);
+        return ret;
+    }
+    free(inputs);
+
     char default_out[512];
     if (!outpath) {
-        strncpy(default_out, inpath, sizeof(default_out)-6);
-        default_out[sizeof(default_out)-6] = '\0';
-        char *dot = strrchr(default_out, '.');
-        if (dot) strcpy(dot, ".wasm");
-        else strncat(default_out, ".wasm", sizeof(default_out) - strlen(default_out) - 1);
+        default_output(inpath, default_out, sizeof(default_out));
         outpath = default_out;
     }
 
-    /* Read input file */
-    FILE *fp = fopen(inpath, "r");
-    if (!fp) { fprintf(stderr, "Cannot open %s\n", inpath); return 1; }
-    fseek(fp, 0, SEEK_END);
-    src_len = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-    source = malloc(src_len + 1);
-    if ((int)fread(source, 1, src_len, fp) != src_len) {
-        fprintf(stderr, "Read error on %s\n", inpath);
-        free(source);
-        fclose(fp);
-        return 1;
-    }
-    source[src_len] = 0;
-    fclose(fp);
-    source_owned = 1;   /* so $INCLUDE splices can free intermediates */
-
-    /* $INCLUDE files resolve relative to the input file's directory. */
-    {
-        const char *slash = strrchr(inpath, '/');
-        if (slash) {
-            size_t dlen = (size_t)(slash - inpath + 1);
-            if (dlen >= sizeof(bw_include_dir)) dlen = sizeof(bw_include_dir) - 1;
-            memcpy(bw_include_dir, inpath, dlen);
-            bw_include_dir[dlen] = 0;
-        }
-    }
+    if (!read_source(inpath)) return 1;
 
     printf("bas2wasm %d.%02d.%04d compiling %s...\n",
            BAS2WASM_VERSION_MAJOR, BAS2WASM_VERSION_MINOR, BUILD_NUMBER, inpath);
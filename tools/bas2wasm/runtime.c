@@ -0,0 +1,651 @@
+/*
+ * runtime.c — in-module string runtime (--inline-strings)
+ *
+ * By default every string operation is a host import (basic_str_*): one
+ * wasm3 call, a pool allocation and a copy through the host's memory glue
+ * per LEFT$, +, or STR$, and the pool block a temporary lands in is never
+ * given back. With --inline-strings the same operations are small wasm
+ * functions appended to the module, and strings carry their length:
+ *
+ *     [cap i32][len i32] chars... NUL
+ *                        ^ the value is a pointer here, so host imports
+ *                          that take a C string (VAL, FORMAT, files) still do
+ *
+ * 0 is the empty string. Literals sit in the data section with cap 0.
+ * Temporaries (the result of +, MID$, STR$...) are bumped out of a fixed
+ * arena after the data, also cap 0, and the arena is reset at the start of
+ * the next statement that makes one: a function keeps the arena top it was
+ * entered with in a local (its "mark") and each such statement sets the top
+ * back to it. Nothing a statement leaves behind is still referenced by
+ * then -- variables own their buffers. A variable's buffer is a host pool
+ * block (basic_str_alloc) with cap = usable bytes; assignment copies into
+ * it in place when the new value fits and grows it to the next power of two
+ * when not, so `A$ = A$ + X$` appends in place.
+ *
+ * A temp that doesn't fit in the arena falls back to the host pool and is
+ * left there, as every temp is without --inline-strings; running out of
+ * both traps (unreachable) rather than continuing with a null string.
+ *
+ * The helpers are only emitted when used (str_rt_close), after the
+ * program's own functions; code refers to helper h as STR_RT_BASE + h
+ * until assemble_to_buf() knows where they land.
+ */
+#include "bas2wasm.h"
+
+int inline_strings;
+
+enum {
+    H_LEN, H_ALLOC, H_CONCAT, H_CMP, H_MID, H_LEFT, H_RIGHT, H_CASE,
+    H_TRIM, H_FILL, H_CHR, H_ASC, H_INSTR, H_FROM_INT, H_ADOPT,
+    H_BLOCK, H_RELEASE, H_ASSIGN, H_APPEND, H_MID_ASSIGN,
+    H_COUNT
+};
+
+/* Per helper: params, extra i32 locals, results (0/1), helpers and
+ * imports it calls (-1 ends each list) */
+typedef struct {
+    int np, nl, nr;
+    int8_t calls[3];
+    int8_t imps[2];
+} RtDef;
+
+#define NONE  { -1, -1, -1 }
+#define NOIMP { -1, -1 }
+#define I_ALLOC 0   /* index into rt_imps[] */
+#define I_FREE  1
+
+static const int rt_imps[2] = { IMP_STR_ALLOC, IMP_STR_FREE };
+
+static const RtDef rt_defs[H_COUNT] = {
+    [H_LEN]        = { 1, 0, 1, NONE,                           NOIMP },
+    [H_ALLOC]      = { 1, 2, 1, NONE,                           { I_ALLOC, -1 } },
+    [H_CONCAT]     = { 2, 3, 1, { H_LEN, H_ALLOC, -1 },         NOIMP },
+    [H_CMP]        = { 2, 6, 1, { H_LEN, -1, -1 },              NOIMP },
+    [H_MID]        = { 3, 3, 1, { H_LEN, H_ALLOC, -1 },         NOIMP },
+    [H_LEFT]       = { 2, 0, 1, { H_MID, -1, -1 },              NOIMP },
+    [H_RIGHT]      = { 2, 1, 1, { H_LEN, H_MID, -1 },           NOIMP },
+    [H_CASE]       = { 2, 6, 1, { H_LEN, H_ALLOC, -1 },         NOIMP },
+    [H_TRIM]       = { 2, 3, 1, { H_LEN, H_MID, -1 },           NOIMP },
+    [H_FILL]       = { 2, 1, 1, { H_ALLOC, -1, -1 },            NOIMP },
+    [H_CHR]        = { 1, 2, 1, { H_ALLOC, -1, -1 },            NOIMP },
+    [H_ASC]        = { 1, 0, 1, NONE,                           NOIMP },
+    [H_INSTR]      = { 3, 5, 1, { H_LEN, -1, -1 },              NOIMP },
+    [H_FROM_INT]   = { 1, 5, 1, { H_ALLOC, -1, -1 },            NOIMP },
+    [H_ADOPT]      = { 1, 2, 1, { H_ALLOC, -1, -1 },            { I_FREE, -1 } },
+    [H_BLOCK]      = { 1, 2, 1, NONE,                           { I_ALLOC, -1 } },
+    [H_RELEASE]    = { 1, 0, 0, NONE,                           { I_FREE, -1 } },
+    [H_ASSIGN]     = { 2, 2, 1, { H_LEN, H_BLOCK, H_RELEASE },  NOIMP },
+    [H_APPEND]     = { 2, 4, 1, { H_LEN, H_BLOCK, H_RELEASE },  NOIMP },
+    [H_MID_ASSIGN] = { 4, 3, 0, { H_LEN, -1, -1 },              NOIMP },
+};
+
+#undef NONE
+#undef NOIMP
+
+static BW_TLS uint8_t rt_used[H_COUNT];
+static BW_TLS int rt_slot[H_COUNT];     /* position among emitted helpers */
+static BW_TLS int rt_nslots;
+static BW_TLS int stmt_has_temp;        /* arena already reset this statement */
+
+void str_rt_reset(void) {
+    memset(rt_used, 0, sizeof(rt_used));
+    rt_nslots = 0;
+    stmt_has_temp = 0;
+}
+
+static void emit_helper(int h) {
+    rt_used[h] = 1;
+    emit_call(STR_RT_BASE + h);
+}
+
+/* ================================================================
+ *  Temporaries and the arena mark
+ * ================================================================ */
+
+static int func_mark(void) {
+    FuncCtx *f = &func_bufs[cur_func];
+    if (f->str_mark < 0) f->str_mark = alloc_local();
+    return f->str_mark;
+}
+
+void str_stmt_begin(void) {
+    stmt_has_temp = 0;
+}
+
+/* Before the first op in a statement that makes a temporary: drop the
+ * previous statements' temporaries */
+void str_temp_begin(void) {
+    if (stmt_has_temp) return;
+    stmt_has_temp = 1;
+    emit_local_get(func_mark());
+    emit_global_set(GLOBAL_STR_TOP);
+}
+
+/* SELECT CASE on a string keeps its selector, a temp, alive across the
+ * CASE statements: raise the mark over it until END SELECT. Returns the
+ * local holding the old mark. */
+int str_mark_raise(void) {
+    int mark = func_mark();
+    int save = alloc_local();
+    emit_local_get(mark);
+    emit_local_set(save);
+    emit_global_get(GLOBAL_STR_TOP);
+    emit_local_set(mark);
+    return save;
+}
+
+void str_mark_restore(int save) {
+    emit_local_get(save);
+    emit_local_set(func_mark());
+}
+
+/* Leaving a function that doesn't return a string: its temporaries are
+ * dead, so put the top back where the caller had it. A RETURN can come
+ * before the function's first temp in the source but run after it; at
+ * END SUB (at_end) it's known whether there are any. */
+void str_func_exit(int at_end) {
+    if (at_end && func_bufs[cur_func].str_mark < 0) return;
+    emit_local_get(func_mark());
+    emit_global_set(GLOBAL_STR_TOP);
+}
+
+/* ================================================================
+ *  Code generation hooks
+ * ================================================================ */
+
+/* A string op the default build imports: the host call, or the helper
+ * doing the same job in the module (same stack in, same result out) */
+void emit_str_op(int imp) {
+    if (!inline_strings) { emit_call(imp); return; }
+    switch (imp) {
+    case IMP_STR_LEN:    emit_helper(H_LEN); return;
+    case IMP_STR_ASC:    emit_helper(H_ASC); return;
+    case IMP_STR_CMP:    emit_helper(H_CMP); return;
+    case IMP_STR_INSTR:  emit_helper(H_INSTR); return;
+    case IMP_STR_FREE:   emit_helper(H_RELEASE); return;
+    case IMP_STR_TO_INT:
+    case IMP_STR_TO_I64:
+    case IMP_STR_TO_FLOAT: emit_call(imp); return;
+    default: break;
+    }
+    str_temp_begin();
+    switch (imp) {
+    case IMP_STR_CONCAT:   emit_helper(H_CONCAT); break;
+    case IMP_STR_MID:      emit_helper(H_MID); break;
+    case IMP_STR_LEFT:     emit_helper(H_LEFT); break;
+    case IMP_STR_RIGHT:    emit_helper(H_RIGHT); break;
+    case IMP_STR_CHR:      emit_helper(H_CHR); break;
+    case IMP_STR_FROM_INT: emit_helper(H_FROM_INT); break;
+    case IMP_STR_UPPER:    emit_i32_const(1); emit_helper(H_CASE); break;
+    case IMP_STR_LOWER:    emit_i32_const(0); emit_helper(H_CASE); break;
+    case IMP_STR_LTRIM:    emit_i32_const(1); emit_helper(H_TRIM); break;
+    case IMP_STR_RTRIM:    emit_i32_const(2); emit_helper(H_TRIM); break;
+    case IMP_STR_TRIM:     emit_i32_const(3); emit_helper(H_TRIM); break;
+    case IMP_STR_SPACE:    emit_i32_const(' '); emit_helper(H_FILL); break;
+    case IMP_STR_REPEAT:   emit_helper(H_FILL); break;
+    default:
+        /* The host formats it (STR$ of a float, HEX$, a file line...):
+         * copy the C string into a temp and give the pool block back */
+        emit_call(imp);
+        emit_helper(H_ADOPT);
+        break;
+    }
+}
+
+/* [old new] -> the value for the variable that held `old`, which owns it */
+void emit_str_assign(void) {
+    emit_helper(H_ASSIGN);
+}
+
+/* [dst src] -> dst with src appended, dst owning its buffer */
+void emit_str_append(void) {
+    emit_helper(H_APPEND);
+}
+
+/* Store the string on the stack in global g, which owns its value */
+void emit_str_set_global(int g) {
+    int new_val = alloc_local();
+    emit_local_set(new_val);
+    emit_global_get(g);
+    if (inline_strings) {
+        emit_local_get(new_val);
+        emit_str_assign();
+    } else {
+        emit_call(IMP_STR_FREE);
+        emit_local_get(new_val);
+    }
+    emit_global_set(g);
+}
+
+/* Copy the string on the stack into a fresh temp */
+void emit_str_dup(void) {
+    str_temp_begin();
+    emit_i32_const(0);
+    emit_helper(H_CONCAT);
+}
+
+/* [dst start count src] -> overwrite dst's chars in place */
+void emit_str_mid_assign(void) {
+    emit_helper(H_MID_ASSIGN);
+}
+
+/* The literal the lexer left at data offset `off`, as a headered string;
+ * returns its value (the address of its first char) */
+int str_literal(int off) {
+    char s[512];
+    int len = 0;
+    for (;;) {
+#ifdef BAS2WASM_USE_PSRAM
+        char c;
+        bw_psram_read(data_buf + off + len, &c, 1);
+#else
+        char c = data_buf[off + len];
+#endif
+        if (c == 0 || len >= (int)sizeof(s) - 1) break;
+        s[len++] = c;
+    }
+    if (off + len + 1 == data_len) data_len = off;     /* it was the last one */
+    uint8_t hdr[8] = { 0, 0, 0, 0, (uint8_t)len, (uint8_t)(len >> 8), 0, 0 };
+#ifndef BAS2WASM_USE_PSRAM
+    if (shrink_mode) {
+        /* An equal literal with these same 8 bytes before it will do */
+        int at = find_string(s, len);
+        if (at >= 8 && at % 4 == 0 && memcmp(data_buf + at - 8, hdr, 8) == 0) {
+            shrink_stats.str_bytes += len + 1;
+            return at;
+        }
+    }
+#endif
+    int at = (data_len + 3) & ~3;
+    if (at + 8 + len + 1 > MAX_STRINGS) { error_at("string table full"); return 0; }
+    while (data_len < at) dbuf_set(data_len++, 0);
+    for (int i = 0; i < 8; i++)
+        dbuf_set(data_len++, (char)hdr[i]);
+    at = append_string(s, len);     /* the header must stay in front of it */
+    if (shrink_mode) note_string(at);
+    return at;
+}
+
+/* ================================================================
+ *  Assembly
+ * ================================================================ */
+
+/* Pull in what the used helpers call and give each its place. Returns the
+ * number of helper functions to emit. */
+int str_rt_close(void) {
+    for (int h = H_COUNT - 1; h >= 0; h--) {
+        if (!rt_used[h]) continue;
+        for (int i = 0; i < 3 && rt_defs[h].calls[i] >= 0; i++)
+            rt_used[rt_defs[h].calls[i]] = 1;
+        for (int i = 0; i < 2 && rt_defs[h].imps[i] >= 0; i++)
+            imp_used[rt_imps[rt_defs[h].imps[i]]] = 1;
+    }
+    rt_nslots = 0;
+    for (int h = 0; h < H_COUNT; h++)
+        if (rt_used[h]) rt_slot[h] = rt_nslots++;
+    return rt_nslots;
+}
+
+/* Slot of the helper a call site names (STR_RT_BASE + h) */
+int str_rt_slot(int h) {
+    return rt_slot[h];
+}
+
+/* Param and result counts (all i32) of the helper in slot k */
+void str_rt_sig(int k, int *np, int *nr) {
+    for (int h = 0; h < H_COUNT; h++) {
+        if (rt_used[h] && rt_slot[h] == k) {
+            *np = rt_defs[h].np;
+            *nr = rt_defs[h].nr;
+            return;
+        }
+    }
+    *np = *nr = 0;
+}
+
+/* Set the function's mark before anything in it runs */
+void str_rt_prologue(Buf *out, const FuncCtx *f) {
+    if (f->str_mark < 0) return;
+    buf_byte(out, OP_GLOBAL_GET); buf_uleb(out, GLOBAL_STR_TOP);
+    buf_byte(out, OP_LOCAL_SET); buf_uleb(out, f->str_mark);
+}
+
+/* --- A small assembler for the helper bodies --- */
+
+static BW_TLS Buf *rb;
+static BW_TLS int rt_first;             /* function index of slot 0 */
+static BW_TLS const int *rt_remap;      /* import remap */
+static BW_TLS uint32_t rt_arena_end;
+
+static void r_op(int op)      { buf_byte(rb, op); }
+static void r_get(int l)      { buf_byte(rb, OP_LOCAL_GET); buf_uleb(rb, l); }
+static void r_set(int l)      { buf_byte(rb, OP_LOCAL_SET); buf_uleb(rb, l); }
+static void r_tee(int l)      { buf_byte(rb, OP_LOCAL_TEE); buf_uleb(rb, l); }
+static void r_k(int32_t v)    { buf_byte(rb, OP_I32_CONST); buf_sleb(rb, v); }
+static void r_load(void)      { buf_byte(rb, OP_I32_LOAD); buf_uleb(rb, 2); buf_uleb(rb, 0); }
+static void r_store(void)     { buf_byte(rb, OP_I32_STORE); buf_uleb(rb, 2); buf_uleb(rb, 0); }
+static void r_load8(void)     { buf_byte(rb, OP_I32_LOAD8_U); buf_uleb(rb, 0); buf_uleb(rb, 0); }
+static void r_store8(void)    { buf_byte(rb, OP_I32_STORE8); buf_uleb(rb, 0); buf_uleb(rb, 0); }
+static void r_call(int h)     { buf_byte(rb, OP_CALL); buf_uleb(rb, rt_first + rt_slot[h]); }
+static void r_import(int imp) { buf_byte(rb, OP_CALL); buf_uleb(rb, rt_remap[imp]); }
+static void r_if(void)        { buf_byte(rb, OP_IF); buf_byte(rb, WASM_VOID); }
+static void r_if_i32(void)    { buf_byte(rb, OP_IF); buf_byte(rb, WASM_I32); }
+static void r_block(void)     { buf_byte(rb, OP_BLOCK); buf_byte(rb, WASM_VOID); }
+static void r_loop(void)      { buf_byte(rb, OP_LOOP); buf_byte(rb, WASM_VOID); }
+static void r_br(int d)       { buf_byte(rb, OP_BR); buf_uleb(rb, d); }
+static void r_br_if(int d)    { buf_byte(rb, OP_BR_IF); buf_uleb(rb, d); }
+static void r_copy(void)      { buf_byte(rb, OP_MISC_PREFIX); buf_uleb(rb, MISC_MEMORY_COPY); buf_byte(rb, 0); buf_byte(rb, 0); }
+static void r_fill(void)      { buf_byte(rb, OP_MISC_PREFIX); buf_uleb(rb, MISC_MEMORY_FILL); buf_byte(rb, 0); }
+
+/* local a = a > b ? a : b (signed); min when `lt` */
+static void r_clamp(int a, int b, int lt) {
+    r_get(a); r_get(b); r_get(a); r_get(b); r_op(lt ? OP_I32_LT_S : OP_I32_GT_S);
+    r_op(OP_SELECT); r_set(a);
+}
+/* local a = max(a, 0) */
+static void r_clamp0(int a) {
+    r_get(a); r_k(0); r_get(a); r_k(0); r_op(OP_I32_GT_S);
+    r_op(OP_SELECT); r_set(a);
+}
+/* local l += 1 */
+static void r_inc(int l) { r_get(l); r_k(1); r_op(OP_I32_ADD); r_set(l); }
+/* [p n] -> p's len = n and the NUL after it */
+static void r_set_len(int p, int n) {
+    r_get(p); r_k(4); r_op(OP_I32_SUB); r_get(n); r_store();
+    r_get(p); r_get(n); r_op(OP_I32_ADD); r_k(0); r_store8();
+}
+/* [c] -> isspace(c), with c also left in local t */
+static void r_isspace(int t) {
+    r_tee(t); r_k(' '); r_op(OP_I32_EQ);
+    r_get(t); r_k(9); r_op(OP_I32_SUB); r_k(5); r_op(OP_I32_LT_U);
+    r_op(OP_I32_OR);
+}
+
+static void gen_body(int h) {
+    switch (h) {
+    case H_LEN:         /* (p) */
+        r_get(0); r_if_i32();
+        r_get(0); r_k(4); r_op(OP_I32_SUB); r_load();
+        r_op(OP_ELSE); r_k(0); r_op(OP_END);
+        break;
+
+    case H_ALLOC:       /* (n) p next: a temp of n chars, arena or pool */
+        buf_byte(rb, OP_GLOBAL_GET); buf_uleb(rb, GLOBAL_STR_TOP); r_tee(1);
+        r_get(0); r_k(12); r_op(OP_I32_ADD); r_k(-4); r_op(OP_I32_AND);
+        r_op(OP_I32_ADD); r_tee(2);
+        r_k((int32_t)rt_arena_end); r_op(OP_I32_GT_U); r_if();
+            r_get(0); r_k(9); r_op(OP_I32_ADD); r_import(IMP_STR_ALLOC); r_tee(1);
+            r_op(OP_I32_EQZ); r_if(); r_op(OP_UNREACHABLE); r_op(OP_END);
+        r_op(OP_ELSE);
+            r_get(2); buf_byte(rb, OP_GLOBAL_SET); buf_uleb(rb, GLOBAL_STR_TOP);
+        r_op(OP_END);
+        r_get(1); r_k(0); r_store();
+        r_get(1); r_k(8); r_op(OP_I32_ADD); r_set(1);
+        r_set_len(1, 0);
+        r_get(1);
+        break;
+
+    case H_CONCAT:      /* (a b) la lb p */
+        r_get(0); r_call(H_LEN); r_set(2);
+        r_get(1); r_call(H_LEN); r_set(3);
+        r_get(2); r_get(3); r_op(OP_I32_ADD); r_call(H_ALLOC); r_tee(4);
+        r_get(0); r_get(2); r_copy();
+        r_get(4); r_get(2); r_op(OP_I32_ADD); r_get(1); r_get(3); r_copy();
+        r_get(4);
+        break;
+
+    case H_CMP:         /* (a b) la lb n i ca cb: strcmp's sign */
+        r_get(0); r_call(H_LEN); r_set(2);
+        r_get(1); r_call(H_LEN); r_set(3);
+        r_get(2); r_get(3); r_get(2); r_get(3); r_op(OP_I32_LT_U); r_op(OP_SELECT); r_set(4);
+        r_block(); r_loop();
+            r_get(5); r_get(4); r_op(OP_I32_GE_U); r_br_if(1);
+            r_get(0); r_get(5); r_op(OP_I32_ADD); r_load8(); r_tee(6);
+            r_get(1); r_get(5); r_op(OP_I32_ADD); r_load8(); r_tee(7);
+            r_op(OP_I32_NE); r_if(); r_get(6); r_get(7); r_op(OP_I32_SUB); r_op(OP_RETURN); r_op(OP_END);
+            r_inc(5); r_br(0);
+        r_op(OP_END); r_op(OP_END);
+        r_get(2); r_get(3); r_op(OP_I32_SUB);
+        break;
+
+    case H_MID:         /* (s start count) slen st n */
+        r_get(0); r_call(H_LEN); r_set(3);
+        r_get(1); r_k(1); r_op(OP_I32_SUB); r_set(4);
+        r_clamp0(4);
+        r_clamp(4, 3, 1);
+        r_get(2); r_set(5);
+        r_clamp0(5);
+        r_get(3); r_get(4); r_op(OP_I32_SUB); r_set(1);    /* chars left */
+        r_clamp(5, 1, 1);
+        r_get(5); r_call(H_ALLOC); r_tee(1);
+        r_get(0); r_get(4); r_op(OP_I32_ADD); r_get(5); r_copy();
+        r_get(1);
+        break;
+
+    case H_LEFT:        /* (s n) */
+        r_get(0); r_k(1); r_get(1); r_call(H_MID);
+        break;
+
+    case H_RIGHT:       /* (s n) slen */
+        r_get(0); r_call(H_LEN); r_set(2);
+        r_clamp0(1);
+        r_clamp(1, 2, 1);
+        r_get(0); r_get(2); r_get(1); r_op(OP_I32_SUB); r_k(1); r_op(OP_I32_ADD);
+        r_get(1); r_call(H_MID);
+        break;
+
+    case H_CASE:        /* (s upper) n p i lo delta c: A-Z +32, or a-z -32 */
+        r_get(0); r_call(H_LEN); r_set(2);
+        r_get(2); r_call(H_ALLOC); r_set(3);
+        r_k('A'); r_get(1); r_k(32); r_op(OP_I32_MUL); r_op(OP_I32_ADD); r_set(5);
+        r_k(32); r_get(1); r_k(64); r_op(OP_I32_MUL); r_op(OP_I32_SUB); r_set(6);
+        r_block(); r_loop();
+            r_get(4); r_get(2); r_op(OP_I32_GE_U); r_br_if(1);
+            r_get(3); r_get(4); r_op(OP_I32_ADD);
+            r_get(0); r_get(4); r_op(OP_I32_ADD); r_load8(); r_tee(7);
+            r_get(6); r_op(OP_I32_ADD);
+            r_get(7);
+            r_get(7); r_get(5); r_op(OP_I32_SUB); r_k(26); r_op(OP_I32_LT_U);
+            r_op(OP_SELECT); r_store8();
+            r_inc(4); r_br(0);
+        r_op(OP_END); r_op(OP_END);
+        r_get(3);
+        break;
+
+    case H_TRIM:        /* (s mode) st end c: mode 1 left, 2 right, 3 both */
+        r_get(0); r_call(H_LEN); r_set(3);
+        r_get(1); r_k(1); r_op(OP_I32_AND); r_if();
+            r_block(); r_loop();
+                r_get(2); r_get(3); r_op(OP_I32_GE_U); r_br_if(1);
+                r_get(0); r_get(2); r_op(OP_I32_ADD); r_load8(); r_isspace(4);
+                r_op(OP_I32_EQZ); r_br_if(1);
+                r_inc(2); r_br(0);
+            r_op(OP_END); r_op(OP_END);
+        r_op(OP_END);
+        r_get(1); r_k(2); r_op(OP_I32_AND); r_if();
+            r_block(); r_loop();
+                r_get(3); r_get(2); r_op(OP_I32_LE_U); r_br_if(1);
+                r_get(0); r_get(3); r_op(OP_I32_ADD); r_k(1); r_op(OP_I32_SUB); r_load8(); r_isspace(4);
+                r_op(OP_I32_EQZ); r_br_if(1);
+                r_get(3); r_k(1); r_op(OP_I32_SUB); r_set(3); r_br(0);
+            r_op(OP_END); r_op(OP_END);
+        r_op(OP_END);
+        r_get(0); r_get(2); r_k(1); r_op(OP_I32_ADD); r_get(3); r_get(2); r_op(OP_I32_SUB);
+        r_call(H_MID);
+        break;
+
+    case H_FILL:        /* (n c) p: n clamped to 0..4096 like the host's */
+        r_clamp0(0);
+        r_get(0); r_k(4096); r_get(0); r_k(4096); r_op(OP_I32_LT_S); r_op(OP_SELECT); r_set(0);
+        r_get(0); r_call(H_ALLOC); r_tee(2);
+        r_get(1); r_get(0); r_fill();
+        r_get(2);
+        break;
+
+    case H_CHR:         /* (code) c p: CHR$(0) is "" */
+        r_get(0); r_k(255); r_op(OP_I32_AND); r_tee(1);
+        r_k(0); r_op(OP_I32_NE); r_call(H_ALLOC); r_tee(2);
+        r_get(1); r_store8();
+        r_get(2);
+        break;
+
+    case H_ASC:         /* (s) */
+        r_get(0); r_if_i32(); r_get(0); r_load8(); r_op(OP_ELSE); r_k(0); r_op(OP_END);
+        break;
+
+    case H_INSTR:       /* (h nd start) hl nl i j last: 1-based, 0 = none */
+        r_get(0); r_op(OP_I32_EQZ); r_get(1); r_op(OP_I32_EQZ); r_op(OP_I32_OR);
+        r_if(); r_k(0); r_op(OP_RETURN); r_op(OP_END);
+        r_get(0); r_call(H_LEN); r_set(3);
+        r_get(1); r_call(H_LEN); r_set(4);
+        r_get(2); r_k(1); r_op(OP_I32_SUB); r_set(5);
+        r_clamp0(5);
+        r_get(5); r_get(3); r_op(OP_I32_GE_S); r_if(); r_k(0); r_op(OP_RETURN); r_op(OP_END);
+        r_get(3); r_get(4); r_op(OP_I32_SUB); r_set(7);
+        r_block(); r_loop();
+            r_get(5); r_get(7); r_op(OP_I32_GT_S); r_br_if(1);
+            r_k(0); r_set(6);
+            r_block(); r_loop();
+                r_get(6); r_get(4); r_op(OP_I32_GE_S);
+                r_if(); r_get(5); r_k(1); r_op(OP_I32_ADD); r_op(OP_RETURN); r_op(OP_END);
+                r_get(0); r_get(5); r_op(OP_I32_ADD); r_get(6); r_op(OP_I32_ADD); r_load8();
+                r_get(1); r_get(6); r_op(OP_I32_ADD); r_load8();
+                r_op(OP_I32_NE); r_br_if(1);
+                r_inc(6); r_br(0);
+            r_op(OP_END); r_op(OP_END);
+            r_inc(5); r_br(0);
+        r_op(OP_END); r_op(OP_END);
+        r_k(0);
+        break;
+
+    case H_FROM_INT:    /* (v) neg u n p t: "%ld" */
+        r_get(0); r_k(0); r_op(OP_I32_LT_S); r_set(1);
+        r_k(0); r_get(0); r_op(OP_I32_SUB); r_get(0); r_get(1); r_op(OP_SELECT); r_set(2);
+        r_get(1); r_set(3);
+        r_get(2); r_set(5);
+        r_loop();
+            r_inc(3);
+            r_get(5); r_k(10); r_op(OP_I32_DIV_U); r_tee(5); r_br_if(0);
+        r_op(OP_END);
+        r_get(3); r_call(H_ALLOC); r_tee(4);
+        r_get(3); r_op(OP_I32_ADD); r_set(5);
+        r_loop();
+            r_get(5); r_k(1); r_op(OP_I32_SUB); r_tee(5);
+            r_get(2); r_k(10); r_op(OP_I32_REM_U); r_k('0'); r_op(OP_I32_ADD); r_store8();
+            r_get(2); r_k(10); r_op(OP_I32_DIV_U); r_tee(2); r_br_if(0);
+        r_op(OP_END);
+        r_get(1); r_if(); r_get(4); r_k('-'); r_store8(); r_op(OP_END);
+        r_get(4);
+        break;
+
+    case H_ADOPT:       /* (c) n p: host C string -> temp, block freed */
+        r_get(0); r_if();
+            r_block(); r_loop();
+                r_get(0); r_get(1); r_op(OP_I32_ADD); r_load8(); r_op(OP_I32_EQZ); r_br_if(1);
+                r_inc(1); r_br(0);
+            r_op(OP_END); r_op(OP_END);
+        r_op(OP_END);
+        r_get(1); r_call(H_ALLOC); r_tee(2);
+        r_get(0); r_get(1); r_copy();
+        r_get(0); r_import(IMP_STR_FREE);
+        r_get(2);
+        break;
+
+    case H_BLOCK:       /* (n) size b: an owned buffer for n chars */
+        r_k(32); r_set(1);
+        r_block(); r_loop();
+            r_get(1); r_get(0); r_k(9); r_op(OP_I32_ADD); r_op(OP_I32_GE_U); r_br_if(1);
+            r_get(1); r_k(1); r_op(OP_I32_SHL); r_set(1); r_br(0);
+        r_op(OP_END); r_op(OP_END);
+        r_get(1); r_import(IMP_STR_ALLOC); r_tee(2);
+        r_op(OP_I32_EQZ); r_if(); r_op(OP_UNREACHABLE); r_op(OP_END);
+        r_get(2); r_get(1); r_k(9); r_op(OP_I32_SUB); r_store();
+        r_get(2); r_k(8); r_op(OP_I32_ADD);
+        break;
+
+    case H_RELEASE:     /* (p) */
+        r_get(0); r_if(); r_get(0); r_k(8); r_op(OP_I32_SUB); r_import(IMP_STR_FREE); r_op(OP_END);
+        break;
+
+    case H_ASSIGN:      /* (old src) n p: src copied into old's buffer or a new one */
+        r_get(0); r_get(1); r_op(OP_I32_EQ); r_if(); r_get(0); r_op(OP_RETURN); r_op(OP_END);
+        r_get(1); r_call(H_LEN); r_set(2);
+        r_get(0); r_if();
+            r_get(0); r_k(8); r_op(OP_I32_SUB); r_load(); r_get(2); r_op(OP_I32_GE_U); r_if();
+                r_get(0); r_get(1); r_get(2); r_copy();
+                r_set_len(0, 2);
+                r_get(0); r_op(OP_RETURN);
+            r_op(OP_END);
+        r_op(OP_ELSE);
+            r_get(2); r_op(OP_I32_EQZ); r_if(); r_k(0); r_op(OP_RETURN); r_op(OP_END);
+        r_op(OP_END);
+        r_get(2); r_call(H_BLOCK); r_tee(3);
+        r_get(1); r_get(2); r_copy();
+        r_set_len(3, 2);
+        r_get(0); r_call(H_RELEASE);
+        r_get(3);
+        break;
+
+    case H_APPEND:      /* (dst src) la lb p total: dst owns its buffer */
+        r_get(1); r_call(H_LEN); r_tee(3); r_op(OP_I32_EQZ);
+        r_if(); r_get(0); r_op(OP_RETURN); r_op(OP_END);
+        r_get(0); r_call(H_LEN); r_set(2);
+        r_get(2); r_get(3); r_op(OP_I32_ADD); r_set(5);
+        r_get(0); r_if();
+            r_get(0); r_k(8); r_op(OP_I32_SUB); r_load(); r_get(5); r_op(OP_I32_GE_U); r_if();
+                r_get(0); r_get(2); r_op(OP_I32_ADD); r_get(1); r_get(3); r_copy();
+                r_set_len(0, 5);
+                r_get(0); r_op(OP_RETURN);
+            r_op(OP_END);
+        r_op(OP_END);
+        r_get(5); r_call(H_BLOCK); r_tee(4);
+        r_get(0); r_get(2); r_copy();
+        r_get(4); r_get(2); r_op(OP_I32_ADD); r_get(1); r_get(3); r_copy();
+        r_set_len(4, 5);
+        r_get(0); r_call(H_RELEASE);
+        r_get(4);
+        break;
+
+    case H_MID_ASSIGN:  /* (dst start count src) dl s n: length unchanged */
+        r_get(0); r_op(OP_I32_EQZ); r_if(); r_op(OP_RETURN); r_op(OP_END);
+        r_get(0); r_call(H_LEN); r_set(4);
+        r_get(1); r_k(1); r_op(OP_I32_SUB); r_set(5);
+        r_clamp0(5);
+        r_get(5); r_get(4); r_op(OP_I32_GE_S); r_if(); r_op(OP_RETURN); r_op(OP_END);
+        r_get(2); r_set(6);
+        r_clamp0(6);
+        r_get(3); r_call(H_LEN); r_set(1);
+        r_clamp(6, 1, 1);
+        r_get(4); r_get(5); r_op(OP_I32_SUB); r_set(1);
+        r_clamp(6, 1, 1);
+        r_get(0); r_get(5); r_op(OP_I32_ADD); r_get(3); r_get(6); r_copy();
+        break;
+    }
+}
+
+/* Function bodies (locals, code, end) of every used helper, in slot order.
+ * first_func: function index of slot 0; arena_end: first byte past the
+ * temp arena. */
+void str_rt_code(Buf *sec, int first_func, const int *imp_remap, uint32_t arena_end) {
+    rt_first = first_func;
+    rt_remap = imp_remap;
+    rt_arena_end = arena_end;
+    for (int h = 0; h < H_COUNT; h++) {
+        if (!rt_used[h]) continue;
+        Buf body; buf_init(&body);
+        rb = &body;
+        if (rt_defs[h].nl) {
+            buf_uleb(&body, 1);
+            buf_uleb(&body, rt_defs[h].nl);
+            buf_byte(&body, WASM_I32);
+        } else {
+            buf_uleb(&body, 0);
+        }
+        gen_body(h);
+        buf_byte(&body, OP_END);
+        buf_uleb(sec, body.len);
+        buf_bytes(sec, body.data, body.len);
+        buf_free(&body);
+    }
+    rb = NULL;
+}
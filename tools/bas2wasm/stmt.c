@@ -3,7 +3,7 @@
  */
 #include "bas2wasm.h"
 
-static int prints_fmt_off = -1;
+static BW_TLS int prints_fmt_off = -1;
 
 void stmt_reset(void) {
     prints_fmt_off = -1;
@@ -13,7 +13,7 @@ static void compile_format(void) {
     need(TOK_STRING);
     int raw_off = tokv;
     char raw[512];
-    int raw_len = data_len - raw_off;
+    int raw_len = data_len - raw_off;   /* the literal is the table's last */
     if (raw_len < 0) raw_len = 0;
     if (raw_len >= (int)sizeof(raw)) raw_len = (int)sizeof(raw) - 1;
 #ifdef BAS2WASM_USE_PSRAM
@@ -51,7 +51,7 @@ static void compile_format(void) {
     }
     cfmt[ci++] = '\n'; cfmt[ci] = 0;
     data_len = raw_off;
-    int fmt_off = add_string(cfmt, ci);
+    int fmt_off = append_string(cfmt, ci);     /* patched below: never shared */
 
     int nargs = 0;
     while (want(TOK_COMMA)) {
@@ -142,10 +142,12 @@ static void compile_declare(void) {
     vars[var].func_local_idx = fi;
     FuncCtx *f = &func_bufs[fi];
     buf_init(&f->code);
+    buf_init(&f->lines);
     f->nparams = 0;
     f->nlocals = 0;
     f->ncall_fixups = 0;
     f->sub_var = var;
+    f->str_mark = -1;
 
     int params[8], np = 0;
     if (!want(TOK_EOF)) {
@@ -189,10 +191,12 @@ static void compile_sub(void) {
         vars[var].func_local_idx = fi;
         FuncCtx *fc = &func_bufs[fi];
         buf_init(&fc->code);
+        buf_init(&fc->lines);
         fc->nparams = 0;
         fc->nlocals = 0;
         fc->ncall_fixups = 0;
         fc->sub_var = var;
+        fc->str_mark = -1;
     }
     FuncCtx *f = &func_bufs[fi];
 
@@ -236,9 +240,15 @@ static void compile_sub(void) {
         emit_local_set(saved[i]);
     }
     for (int i = 0; i < np; i++) {
-        emit_local_get(i);
-        if (vars[params[i]].type == T_STR)
-            emit_call(IMP_STR_COPY);
+        if (inline_strings && vars[params[i]].type == T_STR) {
+            emit_i32_const(0);
+            emit_local_get(i);
+            emit_str_assign();
+        } else {
+            emit_local_get(i);
+            if (vars[params[i]].type == T_STR)
+                emit_call(IMP_STR_COPY);
+        }
         emit_global_set(vars[params[i]].global_idx);
     }
 
@@ -262,7 +272,7 @@ static void close_sub(void) {
         int pvar = vars[var].param_vars[i];
         if (vars[pvar].type == T_STR) {
             emit_global_get(vars[pvar].global_idx);
-            emit_call(IMP_STR_FREE);
+            emit_str_op(IMP_STR_FREE);
         }
         emit_local_get(np + i);
         emit_global_set(vars[pvar].global_idx);
@@ -272,12 +282,14 @@ static void close_sub(void) {
         int lvar = vars[var].local_vars[i];
         if (vars[lvar].type == T_STR) {
             emit_global_get(vars[lvar].global_idx);
-            emit_call(IMP_STR_FREE);
+            emit_str_op(IMP_STR_FREE);
         }
         emit_local_get(np + np + i);
         emit_global_set(vars[lvar].global_idx);
     }
 
+    if (inline_strings && !(vars[var].type_set && vars[var].type == T_STR))
+        str_func_exit(1);
     if (vars[var].type_set && vars[var].type == T_F32)
         emit_f32_const(0.0f);
     else if (vars[var].type_set && vars[var].type == T_I64)
@@ -335,6 +347,8 @@ static void compile_end(void) {
         int extras = ctrl_stk[ctrl_sp].if_extra_ends;
         for (int i = 0; i < extras; i++) emit_end();
         emit_end();
+        if (ctrl_stk[ctrl_sp].str_mark_save >= 0)
+            str_mark_restore(ctrl_stk[ctrl_sp].str_mark_save);
     } else {
         error_at("unexpected END");
     }
@@ -454,7 +468,8 @@ static void compile_const(void) {
     expr();
     VType et = vpop();
     if (vars[var].type == T_STR) {
-        emit_global_set(vars[var].global_idx);
+        if (inline_strings) emit_str_set_global(vars[var].global_idx);
+        else emit_global_set(vars[var].global_idx);
     } else {
         if (!vars[var].type_set) {
             vars[var].type = et;
@@ -659,7 +674,7 @@ static void compile_dim_core(int preserve) {
                 emit_op(OP_I32_MUL);
                 emit_op(OP_I32_ADD);
                 emit_i32_load(0);
-                emit_call(IMP_STR_FREE);
+                emit_str_op(IMP_STR_FREE);
                 emit_local_get(idx_local);
                 emit_i32_const(1);
                 emit_op(OP_I32_ADD);
@@ -758,83 +773,138 @@ static void compile_dim_core(int preserve) {
             emit_local_set(old_str[d]);
         }
 
-        /* Nested loops over old extents. Each level's counter is reset to
-         * 0 just before its loop opens (so the inner counter restarts on
-         * every outer iteration — the bug if you only reset once upfront). */
-        for (int d = 0; d < ndims; d++) {
-            emit_i32_const(0);
-            emit_local_set(idx[d]);
-            emit_block();
-            emit_loop();
-            emit_local_get(idx[d]);
-            emit_local_get(old_ext[d]);
-            emit_op(OP_I32_GE_S);
-            emit_br_if(1);
-        }
+        if (!(vars[var].type_set && vars[var].type == T_STR)) {
+            /* Numeric arrays have nothing to free, so copy the intersection
+             * a row at a time: rows run along the last dimension and are
+             * contiguous in both buffers, one memory.copy each. The outer
+             * loops run to min(old, new) extent (old_ext is reused for it;
+             * the strides are already computed). */
+            int last = ndims - 1;
+            int row_bytes = alloc_local();
+            for (int d = 0; d < ndims; d++) {
+                emit_local_get(old_ext[d]);
+                emit_local_get(new_ext[d]);
+                emit_local_get(old_ext[d]);
+                emit_local_get(new_ext[d]);
+                emit_op(OP_I32_LT_S);
+                emit_op(OP_SELECT);
+                emit_local_set(old_ext[d]);
+            }
+            emit_local_get(old_ext[last]);
+            emit_i32_const(elem_size);
+            emit_op(OP_I32_MUL);
+            emit_local_set(row_bytes);
 
-        /* in_range = AND_d (idx[d] < new_ext[d]) */
-        emit_i32_const(1);
-        for (int d = 0; d < ndims; d++) {
-            emit_local_get(idx[d]);
-            emit_local_get(new_ext[d]);
-            emit_op(OP_I32_LT_S);
-            emit_op(OP_I32_AND);
-        }
-        emit_local_set(in_range);
+            for (int d = 0; d < last; d++) {
+                emit_i32_const(0);
+                emit_local_set(idx[d]);
+                emit_block();
+                emit_loop();
+                emit_local_get(idx[d]);
+                emit_local_get(old_ext[d]);
+                emit_op(OP_I32_GE_S);
+                emit_br_if(1);
+            }
 
-        /* old_off = sum(idx[d] * old_str[d]) */
-        emit_i32_const(0);
-        for (int d = 0; d < ndims; d++) {
-            emit_local_get(idx[d]);
-            emit_local_get(old_str[d]);
-            emit_op(OP_I32_MUL);
+            /* dst = new_data + sum(idx[d] * new_str[d]) * elem_size */
+            emit_global_get(vars[var].global_idx);
+            emit_i32_const((ndims + 1) * 4);
             emit_op(OP_I32_ADD);
-        }
-        emit_local_set(old_off);
-
-        emit_local_get(in_range);
-        emit_if_void();
-            /* In intersection: copy element. new_off = sum(idx[d] * new_str[d]) */
             emit_i32_const(0);
-            for (int d = 0; d < ndims; d++) {
+            for (int d = 0; d < last; d++) {
                 emit_local_get(idx[d]);
                 emit_local_get(new_str[d]);
                 emit_op(OP_I32_MUL);
                 emit_op(OP_I32_ADD);
             }
-            emit_local_set(new_off);
-
-            /* dest = new_data + new_off * elem_size */
-            emit_global_get(vars[var].global_idx);
-            emit_i32_const((ndims + 1) * 4);
-            emit_op(OP_I32_ADD);
-            emit_local_get(new_off);
             emit_i32_const(elem_size);
             emit_op(OP_I32_MUL);
             emit_op(OP_I32_ADD);
 
-            /* src = old_data + old_off * elem_size; load value */
+            /* src = old_data + sum(idx[d] * old_str[d]) * elem_size */
             emit_local_get(old_ptr_local);
             emit_i32_const((ndims + 1) * 4);
             emit_op(OP_I32_ADD);
-            emit_local_get(old_off);
+            emit_i32_const(0);
+            for (int d = 0; d < last; d++) {
+                emit_local_get(idx[d]);
+                emit_local_get(old_str[d]);
+                emit_op(OP_I32_MUL);
+                emit_op(OP_I32_ADD);
+            }
             emit_i32_const(elem_size);
             emit_op(OP_I32_MUL);
             emit_op(OP_I32_ADD);
-            if (elem_size == 8) {
-                emit_i64_load(0);
-                emit_i64_store(0);
-            } else if (vars[var].type_set && vars[var].type == T_F32) {
-                emit_f32_load(0);
-                emit_f32_store(0);
-            } else {
-                /* Includes T_STR — moves the i32 pool pointer as-is. */
-                emit_i32_load(0);
-                emit_i32_store(0);
+
+            emit_local_get(row_bytes);
+            emit_memory_copy();
+
+            for (int d = last - 1; d >= 0; d--) {
+                emit_local_get(idx[d]);
+                emit_i32_const(1);
+                emit_op(OP_I32_ADD);
+                emit_local_set(idx[d]);
+                emit_br(0);
+                emit_end();
+                emit_end();
             }
-        emit_else();
-            /* Dropped element. For string arrays, free its pool string. */
-            if (vars[var].type_set && vars[var].type == T_STR) {
+        } else {
+            /* Nested loops over old extents. Each level's counter is reset to
+             * 0 just before its loop opens (so the inner counter restarts on
+             * every outer iteration — the bug if you only reset once upfront). */
+            for (int d = 0; d < ndims; d++) {
+                emit_i32_const(0);
+                emit_local_set(idx[d]);
+                emit_block();
+                emit_loop();
+                emit_local_get(idx[d]);
+                emit_local_get(old_ext[d]);
+                emit_op(OP_I32_GE_S);
+                emit_br_if(1);
+            }
+
+            /* in_range = AND_d (idx[d] < new_ext[d]) */
+            emit_i32_const(1);
+            for (int d = 0; d < ndims; d++) {
+                emit_local_get(idx[d]);
+                emit_local_get(new_ext[d]);
+                emit_op(OP_I32_LT_S);
+                emit_op(OP_I32_AND);
+            }
+            emit_local_set(in_range);
+
+            /* old_off = sum(idx[d] * old_str[d]) */
+            emit_i32_const(0);
+            for (int d = 0; d < ndims; d++) {
+                emit_local_get(idx[d]);
+                emit_local_get(old_str[d]);
+                emit_op(OP_I32_MUL);
+                emit_op(OP_I32_ADD);
+            }
+            emit_local_set(old_off);
+
+            emit_local_get(in_range);
+            emit_if_void();
+                /* In intersection: copy element. new_off = sum(idx[d] * new_str[d]) */
+                emit_i32_const(0);
+                for (int d = 0; d < ndims; d++) {
+                    emit_local_get(idx[d]);
+                    emit_local_get(new_str[d]);
+                    emit_op(OP_I32_MUL);
+                    emit_op(OP_I32_ADD);
+                }
+                emit_local_set(new_off);
+
+                /* dest = new_data + new_off * elem_size */
+                emit_global_get(vars[var].global_idx);
+                emit_i32_const((ndims + 1) * 4);
+                emit_op(OP_I32_ADD);
+                emit_local_get(new_off);
+                emit_i32_const(elem_size);
+                emit_op(OP_I32_MUL);
+                emit_op(OP_I32_ADD);
+
+                /* src = old_data + old_off * elem_size; load value */
                 emit_local_get(old_ptr_local);
                 emit_i32_const((ndims + 1) * 4);
                 emit_op(OP_I32_ADD);
@@ -842,21 +912,43 @@ static void compile_dim_core(int preserve) {
                 emit_i32_const(elem_size);
                 emit_op(OP_I32_MUL);
                 emit_op(OP_I32_ADD);
-                emit_i32_load(0);
-                emit_call(IMP_STR_FREE);
-            }
-        emit_end();
-
-        /* Close loops in reverse: increment idx[d], br back to loop start,
-         * end loop, end block. */
-        for (int d = ndims - 1; d >= 0; d--) {
-            emit_local_get(idx[d]);
-            emit_i32_const(1);
-            emit_op(OP_I32_ADD);
-            emit_local_set(idx[d]);
-            emit_br(0);
-            emit_end();
+                if (elem_size == 8) {
+                    emit_i64_load(0);
+                    emit_i64_store(0);
+                } else if (vars[var].type_set && vars[var].type == T_F32) {
+                    emit_f32_load(0);
+                    emit_f32_store(0);
+                } else {
+                    /* Includes T_STR — moves the i32 pool pointer as-is. */
+                    emit_i32_load(0);
+                    emit_i32_store(0);
+                }
+            emit_else();
+                /* Dropped element. For string arrays, free its pool string. */
+                if (vars[var].type_set && vars[var].type == T_STR) {
+                    emit_local_get(old_ptr_local);
+                    emit_i32_const((ndims + 1) * 4);
+                    emit_op(OP_I32_ADD);
+                    emit_local_get(old_off);
+                    emit_i32_const(elem_size);
+                    emit_op(OP_I32_MUL);
+                    emit_op(OP_I32_ADD);
+                    emit_i32_load(0);
+                    emit_str_op(IMP_STR_FREE);
+                }
             emit_end();
+
+            /* Close loops in reverse: increment idx[d], br back to loop start,
+             * end loop, end block. */
+            for (int d = ndims - 1; d >= 0; d--) {
+                emit_local_get(idx[d]);
+                emit_i32_const(1);
+                emit_op(OP_I32_ADD);
+                emit_local_set(idx[d]);
+                emit_br(0);
+                emit_end();
+                emit_end();
+            }
         }
 
         /* Free old buffer now that all kept strings have been moved and
@@ -945,7 +1037,7 @@ static void compile_erase(void) {
                 emit_op(OP_I32_MUL);
                 emit_op(OP_I32_ADD);
                 emit_i32_load(0);
-                emit_call(IMP_STR_FREE);
+                emit_str_op(IMP_STR_FREE);
 
                 emit_local_get(idx_local);
                 emit_i32_const(1);
@@ -982,6 +1074,17 @@ static void compile_local(void) {
     } while (want(TOK_COMMA));
 }
 
+/* Jumping out of string SELECTs skips their END SELECT: put back the mark
+ * the outermost one at or above ctrl_stk[from] raised */
+static void restore_select_mark(int from) {
+    for (int i = from; i < ctrl_sp; i++) {
+        if (ctrl_stk[i].kind == CTRL_SELECT && ctrl_stk[i].str_mark_save >= 0) {
+            str_mark_restore(ctrl_stk[i].str_mark_save);
+            return;
+        }
+    }
+}
+
 static void compile_return(void) {
     if (cur_func == 0) {
         emit_return();
@@ -997,7 +1100,9 @@ static void compile_return(void) {
     if (!want(TOK_EOF)) {
         ungot = 1;
         expr();
-        if (sub_is_str) { /* no coercion — string is already i32 pointer */ }
+        if (sub_is_str) {   /* no coercion — string is already i32 pointer */
+            if (inline_strings) emit_str_dup();  /* outlive the LOCALs freed below */
+        }
         else if (sub_is_float) coerce_f32();
         else if (sub_is_i64) coerce_i64();
         else coerce_i32();
@@ -1009,7 +1114,7 @@ static void compile_return(void) {
             int pvar = vars[sub_var].param_vars[i];
             if (vars[pvar].type == T_STR) {
                 emit_global_get(vars[pvar].global_idx);
-                emit_call(IMP_STR_FREE);
+                emit_str_op(IMP_STR_FREE);
             }
             emit_local_get(np + i);
             emit_global_set(vars[pvar].global_idx);
@@ -1018,12 +1123,16 @@ static void compile_return(void) {
             int lvar = vars[sub_var].local_vars[i];
             if (vars[lvar].type == T_STR) {
                 emit_global_get(vars[lvar].global_idx);
-                emit_call(IMP_STR_FREE);
+                emit_str_op(IMP_STR_FREE);
             }
             emit_local_get(np + np + i);
             emit_global_set(vars[lvar].global_idx);
         }
 
+        if (inline_strings && !sub_is_str) {
+            restore_select_mark(0);
+            str_func_exit(0);
+        }
         emit_local_get(ret_local);
         emit_return();
     } else {
@@ -1031,7 +1140,7 @@ static void compile_return(void) {
             int pvar = vars[sub_var].param_vars[i];
             if (vars[pvar].type == T_STR) {
                 emit_global_get(vars[pvar].global_idx);
-                emit_call(IMP_STR_FREE);
+                emit_str_op(IMP_STR_FREE);
             }
             emit_local_get(np + i);
             emit_global_set(vars[pvar].global_idx);
@@ -1040,11 +1149,15 @@ static void compile_return(void) {
             int lvar = vars[sub_var].local_vars[i];
             if (vars[lvar].type == T_STR) {
                 emit_global_get(vars[lvar].global_idx);
-                emit_call(IMP_STR_FREE);
+                emit_str_op(IMP_STR_FREE);
             }
             emit_local_get(np + np + i);
             emit_global_set(vars[lvar].global_idx);
         }
+        if (inline_strings && !sub_is_str) {
+            restore_select_mark(0);
+            str_func_exit(0);
+        }
         if (sub_is_float) emit_f32_const(0.0f);
         else if (sub_is_i64) emit_i64_const(0);
         else emit_i32_const(0);
@@ -1064,7 +1177,14 @@ static void compile_select(void) {
     } else {
         test_local = alloc_local();
     }
-    emit_local_set(test_local);
+    int mark_save = -1;
+    if (inline_strings && test_type == T_STR) {
+        emit_str_dup();             /* the CASEs may reassign what it came from */
+        emit_local_set(test_local);
+        mark_save = str_mark_raise();
+    } else {
+        emit_local_set(test_local);
+    }
 
     emit_block();
 
@@ -1074,6 +1194,7 @@ static void compile_select(void) {
     ctrl_stk[ctrl_sp].for_limit_local = (int)test_type;
     ctrl_stk[ctrl_sp].break_depth = block_depth;
     ctrl_stk[ctrl_sp].if_extra_ends = 0;
+    ctrl_stk[ctrl_sp].str_mark_save = mark_save;
     ctrl_sp++;
 }
 
@@ -1122,7 +1243,7 @@ static void compile_case(void) {
             } else if (test_type == T_STR) {
                 emit_local_get(test_local);
                 expr(); vpop();
-                emit_call(IMP_STR_CMP);
+                emit_str_op(IMP_STR_CMP);
                 switch (op) {
                 case TOK_EQ: emit_op(OP_I32_EQZ); break;
                 case TOK_NE: emit_i32_const(0); emit_op(OP_I32_NE); break;
@@ -1167,7 +1288,7 @@ static void compile_case(void) {
             } else if (test_type == T_STR) {
                 emit_local_get(test_local);
                 expr(); vpop();
-                emit_call(IMP_STR_CMP);
+                emit_str_op(IMP_STR_CMP);
                 emit_op(OP_I32_EQZ);
             } else {
                 emit_local_get(test_local);
@@ -1268,6 +1389,7 @@ static void compile_exit(void) {
     }
     if (found < 0) { error_at(errmsg); return; }
 
+    restore_select_mark(found + 1);
     emit_br(block_depth - ctrl_stk[found].break_depth);
 }
 
@@ -1329,7 +1451,7 @@ static void compile_data(void) {
             item.fval = neg ? -tokf : tokf;
         } else if (!neg && want(TOK_STRING)) {
             item.type = T_STR;
-            item.str_off = tokv;
+            item.str_off = inline_strings ? str_literal(tokv) : shared_literal(tokv);
         } else {
             error_at("expected number or string in DATA");
             return;
@@ -1362,13 +1484,8 @@ static void compile_read(void) {
         if (vars[var].type == T_STR) {
             emit_local_get(addr);
             emit_i32_load(4);
-            emit_call(IMP_STR_COPY);
-            int new_val = alloc_local();
-            emit_local_set(new_val);
-            emit_global_get(vars[var].global_idx);
-            emit_call(IMP_STR_FREE);
-            emit_local_get(new_val);
-            emit_global_set(vars[var].global_idx);
+            if (!inline_strings) emit_call(IMP_STR_COPY);
+            emit_str_set_global(vars[var].global_idx);
         } else if (vars[var].type_set && vars[var].type == T_F32) {
             int tag = alloc_local();
             emit_local_get(addr);
@@ -1465,12 +1582,16 @@ static void compile_mid_assign(void) {
     emit_local_get(start_local);
     emit_local_get(len_local);
     emit_local_get(repl_local);
+    if (inline_strings) {           /* the variable owns its buffer */
+        emit_str_mid_assign();
+        return;
+    }
     emit_call(IMP_STR_MID_ASSIGN);
 
     int result = alloc_local();
     emit_local_set(result);
     emit_global_get(vars[target].global_idx);
-    emit_call(IMP_STR_FREE);
+    emit_str_op(IMP_STR_FREE);
     emit_local_get(result);
     emit_global_set(vars[target].global_idx);
 }
@@ -1614,37 +1735,72 @@ static void compile_input_file(void) {
 
     emit_i32_const(FILE_TABLE_BASE + (ch - 1) * 4);
     emit_i32_load(0);
-    emit_call(IMP_FILE_READLN);
-
     if (vars[var].type == T_STR) {
-        int new_val = alloc_local();
-        emit_local_set(new_val);
-        emit_global_get(vars[var].global_idx);
-        emit_call(IMP_STR_FREE);
-        emit_local_get(new_val);
-        emit_global_set(vars[var].global_idx);
+        emit_str_op(IMP_FILE_READLN);
+        emit_str_set_global(vars[var].global_idx);
     } else if (vars[var].type == T_F32) {
+        emit_call(IMP_FILE_READLN);
         emit_call(IMP_STR_TO_FLOAT);
         if (!vars[var].type_set) { vars[var].type = T_F32; vars[var].type_set = 1; }
         emit_global_set(vars[var].global_idx);
     } else if (vars[var].type == T_I64) {
+        emit_call(IMP_FILE_READLN);
         emit_call(IMP_STR_TO_I64);
         emit_global_set(vars[var].global_idx);
     } else {
+        emit_call(IMP_FILE_READLN);
         emit_call(IMP_STR_TO_INT);
         if (!vars[var].type_set) { vars[var].type = T_I32; vars[var].type_set = 1; }
         emit_global_set(vars[var].global_idx);
     }
 }
 
+/* --inline-strings: `A$ = A$ + X$ + ...` appends to A$'s buffer in place
+ * instead of building the sum as a temp and copying it back. The operands
+ * are all evaluated first, as the sum's would be. Returns 0, having
+ * consumed nothing, when the right-hand side doesn't start with `A$ +`. */
+static int compile_str_append(int var) {
+    char *save_lp = lp;
+    int save_data_len = data_len;
+    if (vars[var].mode != VAR_NORMAL || read_tok() != TOK_NAME || tokv != var
+        || read_tok() != TOK_ADD) {
+        lp = save_lp;
+        data_len = save_data_len;
+        ungot = 0;
+        return 0;
+    }
+    int parts[16], n = 0;
+    do {
+        if (n >= 16) { error_at("expression too complex"); return 1; }
+        /* A bare read of var is its own buffer, which the appends grow:
+         * copy it first so every operand sees the value before the statement */
+        save_lp = lp;
+        save_data_len = data_len;
+        int self = read_tok() == TOK_NAME && tokv == var;
+        lp = save_lp;
+        data_len = save_data_len;
+        ungot = 0;
+        add_operand();
+        if (vpop() != T_STR) { error_at("cannot mix strings and numbers with + or -"); return 1; }
+        if (self) emit_str_dup();
+        parts[n] = alloc_local();
+        emit_local_set(parts[n++]);
+    } while (want(TOK_ADD));
+    for (int i = 0; i < n; i++) {
+        emit_global_get(vars[var].global_idx);
+        emit_local_get(parts[i]);
+        emit_str_append();
+        emit_global_set(vars[var].global_idx);
+    }
+    return 1;
+}
+
 void stmt(void) {
     int t = read_tok();
     if (had_error) return;
 
-    if (t != TOK_EOF) {
-        emit_i32_const(line_num);
-        emit_global_set(GLOBAL_LINE);
-    }
+    if (t != TOK_EOF) emit_line_mark();
+    str_stmt_begin();
 
     switch (t) {
     case TOK_EOF: break;
@@ -1737,15 +1893,11 @@ void stmt(void) {
         }
         if (want(TOK_EQ)) {
             if (vars[var].is_const) { error_at("cannot assign to CONST"); break; }
+            if (inline_strings && vars[var].type == T_STR && compile_str_append(var)) break;
             expr();
             VType et = vpop();
             if (vars[var].type == T_STR) {
-                int new_val = alloc_local();
-                emit_local_set(new_val);
-                emit_global_get(vars[var].global_idx);
-                emit_call(IMP_STR_FREE);
-                emit_local_get(new_val);
-                emit_global_set(vars[var].global_idx);
+                emit_str_set_global(vars[var].global_idx);
             } else {
                 if (!vars[var].type_set) {
                     vars[var].type = et;
@@ -1768,12 +1920,21 @@ void stmt(void) {
                     expr(); coerce_to(T_STR); vpop();
                     int new_val = alloc_local();
                     emit_local_set(new_val);
-                    emit_local_get(addr_local);
-                    emit_i32_load(0);            /* old pointer */
-                    emit_call(IMP_STR_FREE);
-                    emit_local_get(addr_local);
-                    emit_local_get(new_val);
-                    emit_i32_store(0);
+                    if (inline_strings) {
+                        emit_local_get(addr_local);
+                        emit_local_get(addr_local);
+                        emit_i32_load(0);
+                        emit_local_get(new_val);
+                        emit_str_assign();
+                        emit_i32_store(0);
+                    } else {
+                        emit_local_get(addr_local);
+                        emit_i32_load(0);            /* old pointer */
+                        emit_str_op(IMP_STR_FREE);
+                        emit_local_get(addr_local);
+                        emit_local_get(new_val);
+                        emit_i32_store(0);
+                    }
                 } else {
                     expr(); coerce_to(vars[var].type_set ? vars[var].type : T_I32); vpop();
                     int val_local = alloc_local_for_vtype(vars[var].type_set ? vars[var].type : T_I32);
@@ -1809,6 +1970,7 @@ void stmt(void) {
                     }
                     if (vars[var].mode == VAR_SUB && nargs != vars[var].param_count)
                         error_at("wrong number of arguments");
+                    if (inline_strings && vars[var].type == T_STR) str_temp_begin();
                     emit_call(IMP_COUNT + vars[var].func_local_idx);
                     vpush(vars[var].type_set ? vars[var].type : T_I32);
                 }
@@ -1837,6 +1999,7 @@ void stmt(void) {
                 if (vars[var].mode == VAR_SUB) {
                     if (nargs != vars[var].param_count)
                         error_at("wrong number of arguments");
+                    if (inline_strings && vars[var].type == T_STR) str_temp_begin();
                     emit_call(IMP_COUNT + vars[var].func_local_idx);
                     emit_drop();
                 } else {
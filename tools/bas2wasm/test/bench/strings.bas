@@ -0,0 +1,37 @@
+' String-building workload for `make bench`: the kind of per-frame status
+' line and text-scroll effects build, run enough times to show the cost of
+' each string operation. Host-pool temps live until the program ends, so
+' the frame count is kept to what the 28 KB pool holds on that path.
+
+FUNCTION PAD$ S$, N
+  LOCAL R$
+  R$ = S$
+  WHILE LEN(R$) < N
+    R$ = R$ + " "
+  WEND
+  RETURN R$
+END FUNCTION
+
+MSG$ = "ConeZ status: all cones nominal"
+SUM = 0
+FOR FRAME = 1 TO 100
+  ' Status line: label, counter, padded to a fixed width
+  LINE$ = "F" + STR$(FRAME) + ":" + UCASE$(LEFT$(MSG$, 5))
+  LINE$ = PAD$(LINE$, 24) + "|"
+
+  ' Scroller: a window sliding along the message
+  POS = FRAME MOD LEN(MSG$) + 1
+  WIN$ = MID$(MSG$ + "   " + MSG$, POS, 16)
+
+  ' Bar graph built a character at a time
+  BAR$ = ""
+  FOR I = 1 TO FRAME MOD 20
+    BAR$ = BAR$ + CHR$(35)
+  NEXT
+  BAR$ = BAR$ + STRING$(20 - LEN(BAR$), 46)
+
+  IF INSTR(WIN$, "cones") > 0 THEN SUM = SUM + 1
+  IF TRIM$(RIGHT$(LINE$, 3)) = "|" THEN SUM = SUM + 2
+  SUM = SUM + LEN(LINE$) + LEN(WIN$) + LEN(BAR$) + ASC(BAR$)
+NEXT
+FORMAT "%", SUM
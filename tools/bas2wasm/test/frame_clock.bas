@@ -0,0 +1,11 @@
+' EXPECTED:
+' 30
+' 100
+' 1
+
+' LED frame clock builtins
+R = FRAMERATE()
+F& = FRAME&()
+> R
+> STR$(F&)
+IF FRAME&() >= F& THEN > 1
@@ -0,0 +1,79 @@
+' EXPECTED:
+' [abcabcabcabcabcabcabcabcabcabc] 30
+' [xyzxyzxyzxyzxyzxyzxyzxyzxyz] 27
+' [World] [d] [] [Hell]
+' [Hel] [Hello] [] [ld] [Hello World] []
+' [MIXED CASE 42] [mixed case 42]
+' [a b] [a b  ] [  a b]
+' 3 8 0 0 1
+' [-17] 0 72 [*****] 1
+' two
+' other
+' [olleh]
+' [x-y-z] 3
+' [HeXXo] [HeXXo]
+
+' String operations that --inline-strings compiles into the module's own
+' runtime instead of host calls; the output must match the host pool's.
+
+' Appends in a loop and onto itself
+A$ = ""
+FOR I = 1 TO 10
+  A$ = A$ + "abc"
+NEXT
+FORMAT "[$] %", A$, LEN(A$)
+B$ = "xyz"
+B$ = B$ + B$ + B$
+B$ = B$ + B$ + B$
+FORMAT "[$] %", B$, LEN(B$)
+
+' Slicing past either end
+H$ = "Hello World"
+FORMAT "[$] [$] [$] [$]", MID$(H$, 7, 99), MID$(H$, 11, 1), MID$(H$, 20, 3), MID$(H$, 1, 4)
+FORMAT "[$] [$] [$] [$] [$] [$]", LEFT$(H$, 3), LEFT$(H$, 5), LEFT$(H$, 0), RIGHT$(H$, 2), LEFT$(H$, 99), RIGHT$(H$, 0)
+
+' Case and trimming
+M$ = "Mixed Case 42"
+FORMAT "[$] [$]", UCASE$(M$), LCASE$(M$)
+T$ = "  a b  "
+FORMAT "[$] [$] [$]", TRIM$(T$), LTRIM$(T$), RTRIM$(T$)
+
+' Searching
+N = 0
+IF INSTR(H$, "World") > 0 THEN N = N + 1
+FORMAT "% % % % %", INSTR("abcabc", "ca"), INSTR("abcabcabc", "bc", 6), INSTR("abc", "x"), INSTR("", "a"), N
+
+' Conversions and fills
+FORMAT "[$] % % [$] %", STR$(-17), ASC(""), ASC(H$), STRING$(5, 42), LEN(CHR$(65))
+
+' SELECT CASE on a string expression
+FOR I = 1 TO 2
+  SELECT CASE LEFT$("twofold", 3 * I)
+    CASE "two"
+      FORMAT "two"
+    CASE ELSE
+      FORMAT "other"
+  END SELECT
+NEXT
+
+' A string FUNCTION building its result with a LOCAL
+FUNCTION REV$ S$
+  LOCAL R$
+  R$ = ""
+  FOR J = LEN(S$) TO 1 STEP -1
+    R$ = R$ + MID$(S$, J, 1)
+  NEXT
+  RETURN R$
+END FUNCTION
+FORMAT "[$]", REV$("hello")
+
+' String arrays and MID$ assignment
+DIM P$(3)
+P$(1) = "x"
+P$(2) = P$(1) + "-y"
+P$(3) = P$(2) + "-z"
+FORMAT "[$] %", P$(3), INSTR(P$(3), "y")
+Q$ = "Hello"
+MID$(Q$, 3, 2) = "XXXX"
+P$(1) = Q$
+FORMAT "[$] [$]", Q$, P$(1)
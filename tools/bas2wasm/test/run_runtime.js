@@ -22,6 +22,8 @@ const { execFileSync } = require('child_process');
 
 const testDir = __dirname;
 const bas2wasm = path.resolve(testDir, '..', 'bas2wasm');
+// Extra compiler flags, e.g. BAS2WASM_FLAGS=--release
+const FLAGS = (process.env.BAS2WASM_FLAGS || '').split(/\s+/).filter(Boolean);
 const tmpDir = fs.mkdtempSync('/tmp/bas2wasm_runtime_');
 process.on('exit', () => fs.rmSync(tmpDir, { recursive: true, force: true }));
 
@@ -82,12 +84,36 @@ function makeImports(state) {
         mem[p + s.length] = 0;
     };
     const strAlloc = (size) => {
-        // bump allocator in pool region
+        // bump allocator in pool region; --bench reuses freed blocks by
+        // size class, as the firmware pool does, and tracks what's live
+        const b = state.bench;
+        if (b) {
+            size = (size + 7) & ~7;
+            b.allocs++;
+            b.live += size;
+            b.peak = Math.max(b.peak, b.live);
+            const list = b.free.get(size);
+            if (list && list.length) {
+                const p = list.pop();
+                b.size.set(p, size);
+                return p;
+            }
+        }
         if (state.strBump + size > STR_POOL_END) return 0;
         const p = state.strBump;
         state.strBump += size;
+        if (b) b.size.set(p, size);
         return p;
     };
+    const strFree = (p) => {
+        const b = state.bench, size = b && b.size.get(p);
+        if (!size) return 0;       // constants, temps and stale pointers
+        b.size.delete(p);
+        b.live -= size;
+        if (!b.free.has(size)) b.free.set(size, []);
+        b.free.get(size).push(p);
+        return 0;
+    };
     const strCopy = (src) => {
         const s = readStr(src);
         const p = strAlloc(s.length + 1);
@@ -147,7 +173,7 @@ function makeImports(state) {
 
             // ---- String pool ----
             basic_str_alloc: (n) => strAlloc(Number(n) + 1),
-            basic_str_free: noop,
+            basic_str_free: strFree,
             basic_str_len: (p) => readStr(p).length,
             basic_str_copy: (p) => strCopy(p),
             basic_str_concat: (a, b) => {
@@ -240,15 +266,15 @@ function makeImports(state) {
                 const p = strAlloc(s.length + 1); writeStr(p, s); return p;
             },
             basic_str_mid_assign: (target, start, len, replacement) => {
-                // Replace in place; return target pointer
-                const mem = memU8();
-                const rep = readStr(replacement);
-                let pos = start - 1;
-                for (let i = 0; i < len && i < rep.length; i++) {
-                    if (mem[target + pos + i] === 0) break;
-                    mem[target + pos + i] = rep.charCodeAt(i) & 0xff;
-                }
-                return target;
+                // A new pool string, as the firmware's: the target may be
+                // a literal in the data section, shared under --shrink
+                const d = readStr(target), rep = readStr(replacement);
+                const s0 = Math.max(start - 1, 0);
+                let n = Math.min(Math.max(len, 0), rep.length);
+                if (s0 + n > d.length) n = Math.max(d.length - s0, 0);
+                const p = strAlloc(d.length + 1);
+                writeStr(p, d.slice(0, s0) + rep.slice(0, n) + d.slice(s0 + n));
+                return p;
             },
 
             // ---- Math ----
@@ -307,6 +333,7 @@ function makeImports(state) {
             get_day_of_week: ret0, get_day_of_year: ret0,
             get_is_leap_year: ret0, time_valid: ret0,
             cue_playing: ret0, cue_elapsed: () => 0n,
+            get_frame: () => 100n, get_frame_rate: () => 30,
 
             lut_load: ret0, lut_get: ret0, lut_size: ret0,
             lut_set: noop, lut_save: ret0, lut_check: ret0,
@@ -327,7 +354,7 @@ function makeImports(state) {
 function runFile(fullpath, name) {
     const wasmPath = path.join(tmpDir, name + '.wasm');
     try {
-        execFileSync(bas2wasm, [fullpath, '-o', wasmPath], { stdio: 'pipe' });
+        execFileSync(bas2wasm, [...FLAGS, fullpath, '-o', wasmPath], { stdio: 'pipe' });
     } catch (e) {
         return { error: 'compile error' };
     }
@@ -337,6 +364,9 @@ function runFile(fullpath, name) {
         const module = new WebAssembly.Module(bytes);
         const inst = new WebAssembly.Instance(module, makeImports(state));
         state.instance = inst;
+        // DIM arrays come from the low heap, which starts where the
+        // module's data (and --inline-strings' temp arena) ends; never at 0
+        state.dimBump = Math.max(0x100, (inst.exports._heap_ptr.value + 7) & ~7);
         if (inst.exports.setup) inst.exports.setup();   // bas2wasm exports setup()
     } catch (e) {
         return { error: 'run error: ' + e.message };
@@ -344,6 +374,62 @@ function runFile(fullpath, name) {
     return { ok: true, output: state.output.trim() };
 }
 
+// --bench: run test/bench/*.bas with and without --inline-strings and
+// compare host calls, pool traffic, module size and run time. Both builds
+// must print the same thing.
+function benchFile(fullpath, name, flags) {
+    const wasmPath = path.join(tmpDir, name + '.wasm');
+    execFileSync(bas2wasm, [...flags, fullpath, '-o', wasmPath], { stdio: 'pipe' });
+    const bytes = fs.readFileSync(wasmPath);
+    const bench = { calls: 0, strCalls: 0, allocs: 0, live: 0, peak: 0,
+                    size: new Map(), free: new Map() };
+    const state = { output: '', instance: null, strBump: STR_POOL_START,
+                    dimBump: 0x100, bench };
+    const imports = makeImports(state);
+    for (const [k, fn] of Object.entries(imports.env)) {
+        const isStr = k.startsWith('basic_str_');
+        imports.env[k] = (...a) => {
+            bench.calls++;
+            if (isStr) bench.strCalls++;
+            return fn(...a);
+        };
+    }
+    const inst = new WebAssembly.Instance(new WebAssembly.Module(bytes), imports);
+    state.instance = inst;
+    state.dimBump = Math.max(0x100, (inst.exports._heap_ptr.value + 7) & ~7);
+    const t0 = process.hrtime.bigint();
+    inst.exports.setup();
+    const ms = Number(process.hrtime.bigint() - t0) / 1e6;
+    return { bench, ms, bytes: bytes.length, output: state.output.trim() };
+}
+
+if (process.argv.includes('--bench')) {
+    const dir = path.join(testDir, 'bench');
+    const files = fs.readdirSync(dir).filter(f => f.endsWith('.bas')).sort();
+    let bad = 0;
+    console.log('=== bas2wasm string runtime benchmark ===\n');
+    for (const file of files) {
+        const name = path.basename(file, '.bas');
+        const fullpath = path.join(dir, file);
+        const host = benchFile(fullpath, name, FLAGS);
+        const inl = benchFile(fullpath, name, [...FLAGS, '--inline-strings']);
+        const row = (label, r) => console.log(
+            `  ${label.padEnd(8)} ${String(r.bytes).padStart(7)} B  ` +
+            `${String(r.bench.calls).padStart(8)} calls  ` +
+            `${String(r.bench.strCalls).padStart(8)} str  ` +
+            `${String(r.bench.allocs).padStart(7)} allocs  ` +
+            `${String(r.bench.peak).padStart(6)} B peak  ${r.ms.toFixed(2).padStart(8)} ms`);
+        console.log(`${name}:`);
+        row('host', host);
+        row('inline', inl);
+        if (host.output !== inl.output) {
+            console.log(`  ${RED}output differs${NC}: ${JSON.stringify(host.output)} vs ${JSON.stringify(inl.output)}`);
+            bad++;
+        }
+    }
+    process.exit(bad ? 1 : 0);
+}
+
 // --generate: snapshot current output into a `' EXPECTED:` block for any
 // non-reject test that lacks one, runs cleanly, and prints something.
 // Inserted at the top of the file (BASIC has no __LINE__-style sensitivity).
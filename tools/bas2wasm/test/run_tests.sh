@@ -133,6 +133,113 @@ if [ -d "$EXAMPLES_DIR" ]; then
     done
 fi
 
+echo ""
+
+# --- --inline-strings: the positive tests and examples with the in-module
+# string runtime must compile and validate too ---
+echo "--- inline strings ---"
+ninl=0
+for src in "$SCRIPT_DIR"/*.bas "$EXAMPLES_DIR"/*.bas; do
+    [ -f "$src" ] || continue
+    name=$(basename "$src" .bas)
+    case "$name" in reject_*) continue ;; esac
+    wasm="$TMPDIR/inline_${name}.wasm"
+
+    out=$("$BAS2WASM" --inline-strings "$src" -o "$wasm" 2>&1)
+    rc=$?
+    if [ $rc -ne 0 ]; then
+        echo -e "  ${RED}FAIL${NC}  inline/$name  (compile error, exit $rc)"
+        [ -n "$out" ] && echo "        $out" | head -5
+        fail=$((fail + 1))
+        continue
+    fi
+    if [ -n "$VALIDATE" ] && ! vout=$($VALIDATE "$wasm" 2>&1); then
+        echo -e "  ${RED}FAIL${NC}  inline/$name  (wasm-validate failed)"
+        echo "        $vout" | head -5
+        fail=$((fail + 1))
+        continue
+    fi
+    ninl=$((ninl + 1))
+done
+if [ $ninl -gt 0 ]; then
+    echo -e "  ${GREEN}PASS${NC}  --inline-strings  ($ninl files)"
+    pass=$((pass + 1))
+fi
+
+echo ""
+
+# --- --shrink: every positive test again, through the size pass, with and
+#     without --inline-strings. Each must validate, be understood, and
+#     come out no larger ---
+echo "--- shrink ---"
+nshr=0; saved=0
+for mode in "" --inline-strings; do
+    for src in "$SCRIPT_DIR"/*.bas "$EXAMPLES_DIR"/*.bas; do
+        [ -f "$src" ] || continue
+        name=$(basename "$src" .bas)
+        case "$name" in reject_*) continue ;; esac
+        wasm="$TMPDIR/shrink_${name}.wasm"
+        big="$TMPDIR/shrink_${name}_linked.wasm"
+
+        "$BAS2WASM" $mode --release "$src" -o "$big" >/dev/null 2>&1
+        out=$("$BAS2WASM" $mode --release --shrink --size-report "$src" -o "$wasm" 2>&1)
+        rc=$?
+        if [ $rc -ne 0 ] || echo "$out" | grep -q "not understood"; then
+            echo -e "  ${RED}FAIL${NC}  shrink/$name $mode  (exit $rc)"
+            echo "$out" | grep -v "Wrote\|imports,\|compiling" | head -5
+            fail=$((fail + 1))
+            continue
+        fi
+        if [ -n "$VALIDATE" ] && ! vout=$($VALIDATE "$wasm" 2>&1); then
+            echo -e "  ${RED}FAIL${NC}  shrink/$name $mode  (wasm-validate failed)"
+            echo "        $vout" | head -5
+            fail=$((fail + 1))
+            continue
+        fi
+        a=$(stat -c%s "$big" 2>/dev/null || stat -f%z "$big" 2>/dev/null)
+        b=$(stat -c%s "$wasm" 2>/dev/null || stat -f%z "$wasm" 2>/dev/null)
+        if [ "$b" -gt "$a" ]; then
+            echo -e "  ${RED}FAIL${NC}  shrink/$name $mode  (grew from $a to $b bytes)"
+            fail=$((fail + 1))
+            continue
+        fi
+        saved=$((saved + a - b))
+        nshr=$((nshr + 1))
+    done
+done
+if [ $nshr -gt 0 ]; then
+    echo -e "  ${GREEN}PASS${NC}  --shrink  ($nshr files, $saved bytes saved)"
+    pass=$((pass + 1))
+fi
+
+echo ""
+
+# --- --jobs: the positive tests again, on 4 threads, must match the above ---
+echo "--- batch ---"
+BATCH="$TMPDIR/batch"
+mkdir -p "$BATCH"
+cp "$SCRIPT_DIR"/*.bi "$BATCH"/
+for src in "$SCRIPT_DIR"/*.bas; do
+    case "$(basename "$src")" in reject_*) continue ;; esac
+    cp "$src" "$BATCH"/
+done
+out=$("$BAS2WASM" --jobs 4 "$BATCH" 2>&1)
+rc=$?
+ndiff=0
+for wasm in "$BATCH"/*.wasm; do
+    cmp -s "$wasm" "$TMPDIR/$(basename "$wasm")" || ndiff=$((ndiff + 1))
+done
+nsrc=$(ls "$BATCH"/*.bas | wc -l)
+nout=$(ls "$BATCH"/*.wasm 2>/dev/null | wc -l)
+if [ $rc -eq 0 ] && [ $ndiff -eq 0 ] && [ "$nout" -eq "$nsrc" ]; then
+    echo -e "  ${GREEN}PASS${NC}  --jobs 4  ($nout files, identical output)"
+    pass=$((pass + 1))
+else
+    echo -e "  ${RED}FAIL${NC}  --jobs 4  (exit $rc, $nout of $nsrc built, $ndiff differ)"
+    echo "$out" | grep -v "Wrote\|imports,\|compiling" | head -5
+    fail=$((fail + 1))
+fi
+
 echo ""
 echo "=== Results: $pass passed, $fail failed ==="
 
@@ -0,0 +1,33 @@
+' SETARRAY(arr, start, end, value) fills A(start)..A(end) with repeated
+' memory.copy. The range is clamped to the array; the header (UBOUND)
+' and elements outside the range are left alone.
+
+' EXPECTED:
+' 10
+' 7
+' 7
+' 7
+' -2
+' -2
+' 7
+' 3
+' 99
+' 99
+' 0
+
+DIM A(10)
+S = SETARRAY(A, 1, 10, 7)
+> UBOUND(A)
+> A(1)
+> A(10)
+> A(2)
+S = SETARRAY(A, 3, 5, -2)
+> A(3)
+> A(5)
+> A(6)
+DIM B(300)
+S = SETARRAY(B, 4, 500, 99)
+> UBOUND(B) / 100
+> B(4)
+> B(300)
+> B(3)
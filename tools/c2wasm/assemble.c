@@ -5,8 +5,8 @@
 
 /* Function type deduplication */
 typedef struct { int np; uint8_t p[8]; int nr; uint8_t r[2]; } FType;
-static FType ftypes[128];
-static int nftypes;
+static CW_TLS FType ftypes[128];
+static CW_TLS int nftypes;
 
 static int find_or_add_ftype(int np, const uint8_t *p, int nr, const uint8_t *r) {
     for (int i = 0; i < nftypes; i++) {
@@ -32,6 +32,655 @@ static int find_func_by_name(const char *name) {
     return -1;
 }
 
+int release_mode;
+
+static int uleb_size(uint32_t v) {
+    int n = 1;
+    while (v >= 0x80) { v >>= 7; n++; }
+    return n;
+}
+
+/* conez.lines payload: version, entry count, then one (offset, line) pair
+ * per entry as deltas from the one before (uleb, sleb), offsets ascending.
+ * An offset is a module byte offset -- what wasm3 reports for a trap -- and
+ * holds from there to the next entry's. Each function opens with line 0
+ * unless a statement starts right at its first byte, so code before the
+ * first mapped statement isn't charged to the previous function. */
+static void write_line_table(Buf *sec, const int *code_at) {
+    Buf ent; buf_init(&ent);
+    int n = 0, prev_off = 0, prev_line = 0;
+    for (int i = 0; i < nfuncs; i++) {
+        const int *mark = (const int *)func_bufs[i].lines.data;
+        int nmark = func_bufs[i].lines.len / (int)(2 * sizeof(int));
+        for (int k = -1; k < nmark; k++) {
+            int off = code_at[i] + (k < 0 ? 0 : mark[2 * k]);
+            int line = k < 0 ? 0 : mark[2 * k + 1];
+            if (k < 0 && nmark > 0 && mark[0] == 0) continue;
+            if (n > 0 && line == prev_line) continue;
+            buf_uleb(&ent, off - prev_off);
+            buf_sleb(&ent, line - prev_line);
+            prev_off = off; prev_line = line;
+            n++;
+        }
+    }
+    buf_uleb(sec, 1);
+    buf_uleb(sec, n);
+    buf_bytes(sec, ent.data, ent.len);
+    buf_free(&ent);
+}
+
+/* ================================================================
+ *  Size pass (--shrink)
+ *
+ *  Modules reach the cones over the LoRa dist carousel, where every byte
+ *  is airtime. With --shrink, assemble_to_buf() hands the finished module
+ *  to shrink_module(), which rewrites it:
+ *
+ *    - functions no export reaches through calls are dropped (at -O2, a
+ *      static helper inlined at every call site), then the imports and
+ *      types nothing left uses; equal types are merged
+ *    - locals nothing reads or writes are dropped, and the rest grouped
+ *      by type, most used first: one declaration per type, and the
+ *      busiest locals get the one-byte indices
+ *    - every immediate is rewritten at its shortest
+ *    - data segments lose exact duplicates and their zero runs, which
+ *      memory already holds
+ *    - conez.lines offsets move with the code
+ *
+ *  Equal string literals are shared before that, as they're added
+ *  (add_string): only the compiler knows which constants are addresses.
+ *  A module the pass doesn't fully understand is returned unchanged.
+ * ================================================================ */
+
+int shrink_mode;
+int size_report;
+CW_TLS ShrinkStats shrink_stats;
+CW_TLS Buf str_lits;
+
+/* Forget the literals past data_len: whoever moved it back (sizeof's
+ * operand is compiled, then discarded) took them */
+void trim_strings(void) {
+    const int *off = (const int *)str_lits.data;
+    while (str_lits.len > 0 && off[str_lits.len / (int)sizeof(int) - 1] >= data_len)
+        str_lits.len -= sizeof(int);
+}
+
+/* --shrink: the offset of an earlier literal holding s, or -1. An exact
+ * match first, else one that ends with s ("%d\n" inside "x=%d\n"). */
+int find_string(const char *s, int len) {
+    trim_strings();
+    const int *off = (const int *)str_lits.data;
+    int n = str_lits.len / (int)sizeof(int);
+    for (int pass = 0; pass < 2; pass++)
+        for (int i = n - 1; i >= 0; i--) {
+            int l = (int)strlen(data_buf + off[i]);
+            if (pass == 0 ? l != len : l <= len) continue;
+            if (memcmp(data_buf + off[i] + l - len, s, len) == 0)
+                return off[i] + l - len;
+        }
+    return -1;
+}
+
+/* Smallest run of zeros worth splitting a data segment at: a segment
+ * header (flags, i32.const offset, end, length) is 5-8 bytes */
+#define SHRINK_ZERO_RUN 8
+
+typedef struct { const uint8_t *p, *end; int bad; } SkRd;
+
+static uint32_t sk_uleb(SkRd *r) {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35 && r->p < r->end; shift += 7) {
+        uint8_t b = *r->p++;
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    r->bad = 1;
+    return 0;
+}
+
+static int64_t sk_sleb(SkRd *r) {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 70 && r->p < r->end; shift += 7) {
+        uint8_t b = *r->p++;
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            if (shift < 57 && (b & 0x40)) v |= ~(uint64_t)0 << (shift + 7);
+            return (int64_t)v;
+        }
+    }
+    r->bad = 1;
+    return 0;
+}
+
+static uint8_t sk_byte(SkRd *r) {
+    if (r->p < r->end) return *r->p++;
+    r->bad = 1;
+    return 0;
+}
+
+static const uint8_t *sk_skip(SkRd *r, uint32_t n) {
+    const uint8_t *at = r->p;
+    if (n > (uint32_t)(r->end - r->p)) r->bad = 1;
+    else r->p += n;
+    return at;
+}
+
+typedef struct { const uint8_t *at; int len; const uint8_t *params; int np; } ShType;
+typedef struct { const uint8_t *at; int len; uint32_t idx; } ShRef;    /* entry up to its index */
+typedef struct { uint32_t off; const uint8_t *b; int len; } ShSeg;
+
+typedef struct {
+    const uint8_t *mod;
+    int nimp, nfunc;            /* imported, defined functions */
+    const ShType *types;
+    uint32_t *ftype;            /* defined function -> type index */
+    const uint8_t **body;       /* defined function -> its local declarations */
+    int *body_len;
+    uint8_t *live;              /* function index -> reached from an export */
+    int *queue, nq;
+    int *fmap;                  /* function index -> new index */
+    int nloc;                   /* params + locals of the body being walked */
+    int *uses, *lmap;           /* local -> uses, new index */
+    Buf map;                    /* (old module offset, new code offset) pairs */
+} Shrink;
+
+static void sk_pair(Buf *map, int old_at, int new_at) {
+    int pair[2] = { old_at, new_at };
+    buf_bytes(map, pair, sizeof(pair));
+}
+
+static void sk_reach(Shrink *sk, uint32_t f) {
+    if (sk->live[f]) return;
+    sk->live[f] = 1;
+    if ((int)f >= sk->nimp) sk->queue[sk->nq++] = f - sk->nimp;
+}
+
+/* One body's instructions. Without out, marks the functions it calls and
+ * counts its local uses; with out, writes it back renumbered, immediates
+ * at their shortest. 0 for an instruction the pass doesn't know. */
+static int sk_walk(Shrink *sk, SkRd *r, Buf *out) {
+    while (r->p < r->end) {
+        if (out) sk_pair(&sk->map, (int)(r->p - sk->mod), out->len);
+        uint8_t op = *r->p++;
+        if (out) buf_byte(out, op);
+        switch (op) {
+        case OP_BLOCK: case OP_LOOP: case OP_IF: {
+            uint8_t bt = sk_byte(r);
+            if (bt != WASM_VOID && (bt < WASM_F64 || bt > WASM_I32)) return 0;
+            if (out) buf_byte(out, bt);
+            break;
+        }
+        case OP_BR: case OP_BR_IF: case OP_GLOBAL_GET: case OP_GLOBAL_SET: {
+            uint32_t v = sk_uleb(r);
+            if (out) buf_uleb(out, v);
+            break;
+        }
+        case 0x0E: {    /* br_table: count, then count + 1 depths */
+            uint32_t n = sk_uleb(r);
+            if (out) buf_uleb(out, n);
+            for (uint32_t i = 0; i <= n && !r->bad; i++) {
+                uint32_t d = sk_uleb(r);
+                if (out) buf_uleb(out, d);
+            }
+            break;
+        }
+        case OP_CALL: {
+            uint32_t f = sk_uleb(r);
+            if (f >= (uint32_t)(sk->nimp + sk->nfunc)) return 0;
+            if (out) buf_uleb(out, sk->fmap[f]);
+            else sk_reach(sk, f);
+            break;
+        }
+        case OP_LOCAL_GET: case OP_LOCAL_SET: case OP_LOCAL_TEE: {
+            uint32_t x = sk_uleb(r);
+            if (x >= (uint32_t)sk->nloc) return 0;
+            if (out) buf_uleb(out, sk->lmap[x]);
+            else sk->uses[x]++;
+            break;
+        }
+        case OP_I32_CONST: {
+            int64_t v = sk_sleb(r);
+            if (out) buf_sleb(out, (int32_t)v);
+            break;
+        }
+        case OP_I64_CONST: {
+            int64_t v = sk_sleb(r);
+            if (out) buf_sleb64(out, v);
+            break;
+        }
+        case OP_F32_CONST: case OP_F64_CONST: {
+            int n = op == OP_F32_CONST ? 4 : 8;
+            const uint8_t *at = sk_skip(r, n);
+            if (out && !r->bad) buf_bytes(out, at, n);
+            break;
+        }
+        case 0x3F: case 0x40: {     /* memory.size, memory.grow: memory 0 */
+            uint8_t m = sk_byte(r);
+            if (out) buf_byte(out, m);
+            break;
+        }
+        case OP_MISC_PREFIX: {
+            /* 0-7 are the saturating truncations; copy and fill name
+             * their memories by byte */
+            uint32_t sub = sk_uleb(r);
+            int n = sub <= 7 ? 0 : sub == MISC_MEMORY_COPY ? 2 : sub == MISC_MEMORY_FILL ? 1 : -1;
+            if (n < 0) return 0;
+            const uint8_t *at = sk_skip(r, n);
+            if (out && !r->bad) { buf_uleb(out, sub); buf_bytes(out, at, n); }
+            break;
+        }
+        default:
+            if (op >= OP_I32_LOAD && op <= 0x3E) {     /* align, offset */
+                uint32_t align = sk_uleb(r), offset = sk_uleb(r);
+                if (out) { buf_uleb(out, align); buf_uleb(out, offset); }
+            } else if (!(op >= OP_I32_EQZ && op <= 0xC4) && op != OP_UNREACHABLE && op != OP_NOP
+                       && op != OP_ELSE && op != OP_END && op != OP_RETURN
+                       && op != OP_DROP && op != OP_SELECT) {
+                return 0;
+            }
+        }
+        if (r->bad) return 0;
+    }
+    return 1;
+}
+
+/* Defined function fi: without out, marks what it calls; with out, writes
+ * its body (declarations and code) with the used locals renumbered */
+static int sk_body(Shrink *sk, int fi, Buf *out) {
+    SkRd r = { sk->body[fi], sk->body[fi] + sk->body_len[fi], 0 };
+    const ShType *t = &sk->types[sk->ftype[fi]];
+    uint32_t ngroups = sk_uleb(&r);
+    const uint8_t *decl = r.p;
+    int64_t nloc = t->np;
+    for (uint32_t g = 0; g < ngroups && !r.bad && nloc <= 50000; g++) {
+        nloc += sk_uleb(&r);
+        sk_byte(&r);
+    }
+    if (r.bad || nloc > 50000) return 0;
+
+    uint8_t *ltype = cw_malloc(nloc + 1);
+    int *uses = cw_malloc((nloc + 1) * sizeof(int));
+    int *lmap = cw_malloc((nloc + 1) * sizeof(int));
+    int *order = cw_malloc((nloc + 1) * sizeof(int));
+    memcpy(ltype, t->params, t->np);
+    memset(uses, 0, nloc * sizeof(int));
+    SkRd d = { decl, r.p, 0 };
+    for (int x = t->np; x < nloc; ) {
+        uint32_t c = sk_uleb(&d);
+        uint8_t ty = sk_byte(&d);
+        while (c--) ltype[x++] = ty;
+    }
+
+    sk->nloc = (int)nloc;
+    sk->uses = uses;
+    sk->lmap = lmap;
+    SkRd code = r;
+    int ok = sk_walk(sk, &code, NULL);
+    if (ok && out) {
+        /* Used locals, each type's together (the busiest type first), the
+         * busiest first within a type */
+        int tot[4] = {0, 0, 0, 0}, rank[4], n = 0;
+        for (int x = t->np; x < nloc; x++) {
+            if (ltype[x] < WASM_F64 || ltype[x] > WASM_I32) { ok = 0; break; }
+            tot[WASM_I32 - ltype[x]] += uses[x];
+        }
+        for (int a = 0; a < 4; a++) {
+            rank[a] = 0;
+            for (int b = 0; b < 4; b++)
+                if (tot[b] > tot[a] || (tot[b] == tot[a] && b < a)) rank[a]++;
+        }
+        for (int x = t->np; ok && x < nloc; x++) {
+            if (!uses[x]) continue;
+            int k = n++;
+            for (; k > 0; k--) {
+                int y = order[k - 1];
+                int ry = rank[WASM_I32 - ltype[y]], rx = rank[WASM_I32 - ltype[x]];
+                if (ry < rx || (ry == rx && uses[y] >= uses[x])) break;
+                order[k] = y;
+            }
+            order[k] = x;
+        }
+        for (int x = 0; x < t->np; x++) lmap[x] = x;
+        for (int k = 0; k < n; k++) lmap[order[k]] = t->np + k;
+        shrink_stats.locals += (int)nloc - t->np - n;
+
+        int nruns = 0;
+        for (int k = 0; k < n; k++)
+            if (k == 0 || ltype[order[k]] != ltype[order[k - 1]]) nruns++;
+        if (ok) {
+            buf_uleb(out, nruns);
+            for (int k = 0; k < n; ) {
+                int c = 1;
+                while (k + c < n && ltype[order[k + c]] == ltype[order[k]]) c++;
+                buf_uleb(out, c);
+                buf_byte(out, ltype[order[k]]);
+                k += c;
+            }
+            ok = sk_walk(sk, &r, out);
+        }
+    }
+    cw_free(ltype);
+    cw_free(uses);
+    cw_free(lmap);
+    cw_free(order);
+    return ok;
+}
+
+/* Data segments without duplicates or zero runs, into sec; how many */
+static int sk_data(const ShSeg *seg, int nseg, Buf *sec) {
+    Buf chunks; buf_init(&chunks);
+    int overlap = 0, nkeep = 0, before = 0, after = 0;
+    ShSeg *keep = cw_malloc((nseg + 1) * sizeof(ShSeg));
+    for (int i = 0; i < nseg; i++) {
+        int dup = 0;
+        for (int j = 0; j < nkeep && !dup; j++)
+            dup = keep[j].off == seg[i].off && keep[j].len == seg[i].len
+                  && memcmp(keep[j].b, seg[i].b, seg[i].len) == 0;
+        before += seg[i].len;
+        if (dup) continue;
+        for (int j = 0; j < nkeep; j++)
+            if (seg[i].off < keep[j].off + (uint32_t)keep[j].len
+                && keep[j].off < seg[i].off + (uint32_t)seg[i].len) overlap = 1;
+        keep[nkeep++] = seg[i];
+    }
+    for (int i = 0; i < nkeep; i++) {
+        const uint8_t *b = keep[i].b;
+        int len = keep[i].len;
+        if (overlap) {      /* a later segment's zeros may overwrite */
+            buf_bytes(&chunks, &keep[i], sizeof(ShSeg));
+            continue;
+        }
+        for (int j = 0; j < len; ) {
+            while (j < len && b[j] == 0) j++;
+            if (j == len) break;
+            ShSeg c = { keep[i].off + j, b + j, 0 };
+            int e = j;
+            while (j < len) {
+                if (b[j]) { e = ++j; continue; }
+                int z = j;
+                while (j < len && b[j] == 0) j++;
+                if (j == len || j - z >= SHRINK_ZERO_RUN) break;
+            }
+            c.len = e - (int)(c.b - b);
+            buf_bytes(&chunks, &c, sizeof(ShSeg));
+        }
+    }
+    const ShSeg *c = (const ShSeg *)chunks.data;
+    int n = chunks.len / (int)sizeof(ShSeg);
+    buf_uleb(sec, n);
+    for (int i = 0; i < n; i++) {
+        buf_byte(sec, 0x00);
+        buf_byte(sec, OP_I32_CONST); buf_sleb(sec, (int32_t)c[i].off); buf_byte(sec, OP_END);
+        buf_uleb(sec, c[i].len);
+        buf_bytes(sec, c[i].b, c[i].len);
+        after += c[i].len;
+    }
+    shrink_stats.data_bytes += before - after;
+    buf_free(&chunks);
+    cw_free(keep);
+    return n;
+}
+
+/* conez.lines with each offset moved to where its code went, entries in
+ * dropped functions gone. code_base: new module offset of the code
+ * section's contents. */
+static int sk_lines(Shrink *sk, SkRd *r, uint32_t count, int code_base, Buf *sec) {
+    const int *map = (const int *)sk->map.data;
+    int nmap = sk->map.len / (int)(2 * sizeof(int));
+    Buf ent; buf_init(&ent);
+    int n = 0, prev_off = 0, prev_line = 0;
+    uint32_t off = 0;
+    int32_t line = 0;
+    for (uint32_t i = 0; i < count && !r->bad; i++) {
+        off += sk_uleb(r);
+        line += (int32_t)sk_sleb(r);
+        int lo = 0, hi = nmap - 1, k = -1;
+        while (lo <= hi) {
+            int mid = (lo + hi) / 2;
+            if ((uint32_t)map[2 * mid] <= off) { k = mid; lo = mid + 1; }
+            else hi = mid - 1;
+        }
+        if (k < 0 || map[2 * k + 1] < 0) continue;
+        int at = code_base + map[2 * k + 1] + (int)(off - map[2 * k]);
+        if (n > 0 && line == prev_line) continue;
+        buf_uleb(&ent, at - prev_off);
+        buf_sleb(&ent, line - prev_line);
+        prev_off = at; prev_line = line;
+        n++;
+    }
+    buf_str(sec, "conez.lines");
+    buf_uleb(sec, 1);
+    buf_uleb(sec, n);
+    buf_bytes(sec, ent.data, ent.len);
+    buf_free(&ent);
+    return !r->bad && r->p == r->end;
+}
+
+Buf shrink_module(const Buf *in) {
+    int str_bytes = shrink_stats.str_bytes;
+    memset(&shrink_stats, 0, sizeof(shrink_stats));
+    shrink_stats.str_bytes = str_bytes;
+
+    struct { int id; const uint8_t *p; uint32_t len; } sec[16];
+    int nsec = 0, ntypes = 0, nexp = 0, nseg = 0, ok = 0;
+    int code_sec = -1, lines_sec = -1, nall = 0, nf = 0, nt = 0, code_base = 0;
+    ShType *types = NULL; ShRef *imp = NULL, *exp = NULL; ShSeg *seg = NULL;
+    int *tmap = NULL;
+    Shrink sk; memset(&sk, 0, sizeof(sk));
+    sk.mod = in->data;
+    Buf out; buf_init(&out);
+    SkRd r = { in->data + 8, in->data + in->len, 0 };
+
+    if (in->len < 8 || memcmp(in->data, "\0asm\1\0\0\0", 8) != 0) goto done;
+    while (r.p < r.end) {
+        const uint8_t *at = r.p;
+        int id = sk_byte(&r);
+        uint32_t len = sk_uleb(&r);
+        const uint8_t *p = sk_skip(&r, len);
+        if (r.bad || nsec == 16 || id > 11 || id == 4 || id == 8 || id == 9) goto done;
+        for (int i = 0; i < nsec; i++)
+            if (id && sec[i].id == id) goto done;
+        sec[nsec].id = id; sec[nsec].p = p; sec[nsec].len = len;
+        nsec++;
+        shrink_stats.before[id] += (int)(r.p - at);
+    }
+
+    /* --- Read --- */
+    for (int i = 0; i < nsec; i++) {
+        SkRd s = { sec[i].p, sec[i].p + sec[i].len, 0 };
+        int id = sec[i].id;
+        uint32_t n = id ? sk_uleb(&s) : 0;
+        if (n > sec[i].len) goto done;
+        if (id == 1) {
+            types = cw_malloc((n + 1) * sizeof(ShType));
+            for (ntypes = 0; ntypes < (int)n && !s.bad; ntypes++) {
+                ShType *t = &types[ntypes];
+                t->at = s.p;
+                if (sk_byte(&s) != 0x60) goto done;
+                t->np = sk_uleb(&s);
+                t->params = sk_skip(&s, t->np);
+                sk_skip(&s, sk_uleb(&s));
+                t->len = (int)(s.p - t->at);
+            }
+        } else if (id == 2) {
+            imp = cw_malloc((n + 1) * sizeof(ShRef));
+            for (sk.nimp = 0; sk.nimp < (int)n && !s.bad; sk.nimp++) {
+                ShRef *e = &imp[sk.nimp];
+                e->at = s.p;
+                sk_skip(&s, sk_uleb(&s));
+                sk_skip(&s, sk_uleb(&s));
+                if (sk_byte(&s) != 0x00) goto done;    /* functions only */
+                e->len = (int)(s.p - e->at);
+                e->idx = sk_uleb(&s);
+                if (e->idx >= (uint32_t)ntypes) goto done;
+            }
+        } else if (id == 3) {
+            sk.ftype = cw_malloc((n + 1) * sizeof(uint32_t));
+            for (sk.nfunc = 0; sk.nfunc < (int)n && !s.bad; sk.nfunc++)
+                if ((sk.ftype[sk.nfunc] = sk_uleb(&s)) >= (uint32_t)ntypes) goto done;
+        } else if (id == 7) {
+            exp = cw_malloc((n + 1) * sizeof(ShRef));
+            for (nexp = 0; nexp < (int)n && !s.bad; nexp++) {
+                ShRef *e = &exp[nexp];
+                e->at = s.p;
+                sk_skip(&s, sk_uleb(&s));
+                sk_byte(&s);
+                e->len = (int)(s.p - e->at);
+                e->idx = sk_uleb(&s);
+            }
+        } else if (id == 10) {
+            if ((int)n != sk.nfunc) goto done;
+            code_sec = i;
+            sk.body = cw_malloc((n + 1) * sizeof(uint8_t *));
+            sk.body_len = cw_malloc((n + 1) * sizeof(int));
+            for (uint32_t k = 0; k < n && !s.bad; k++) {
+                sk.body_len[k] = sk_uleb(&s);
+                sk.body[k] = sk_skip(&s, sk.body_len[k]);
+            }
+        } else if (id == 11) {
+            seg = cw_malloc((n + 1) * sizeof(ShSeg));
+            for (nseg = 0; nseg < (int)n && !s.bad; nseg++) {
+                if (sk_uleb(&s) != 0 || sk_byte(&s) != OP_I32_CONST) goto done;
+                seg[nseg].off = (uint32_t)sk_sleb(&s);
+                if (sk_byte(&s) != OP_END) goto done;
+                seg[nseg].len = sk_uleb(&s);
+                seg[nseg].b = sk_skip(&s, seg[nseg].len);
+            }
+        } else if (id == 0) {
+            uint32_t nlen = sk_uleb(&s);
+            const uint8_t *name = sk_skip(&s, nlen);
+            if (!s.bad && nlen == 11 && memcmp(name, "conez.lines", 11) == 0) {
+                if (code_sec < 0 || sk_uleb(&s) != 1) goto done;
+                lines_sec = i;
+            }
+            s.p = s.end;
+        } else {
+            s.p = s.end;    /* memory, globals: copied as they are */
+        }
+        if (s.bad || s.p != s.end) goto done;
+    }
+    if (code_sec < 0 && sk.nfunc > 0) goto done;
+
+    /* --- Reach: from the exports, through calls --- */
+    nall = sk.nimp + sk.nfunc;
+    sk.types = types;
+    sk.live = cw_malloc(nall + 1);
+    sk.queue = cw_malloc((nall + 1) * sizeof(int));
+    sk.fmap = cw_malloc((nall + 1) * sizeof(int));
+    memset(sk.live, 0, nall);
+    for (int i = 0; i < nexp; i++)
+        if (exp[i].at[exp[i].len - 1] == 0x00) {
+            if (exp[i].idx >= (uint32_t)nall) goto done;
+            sk_reach(&sk, exp[i].idx);
+        }
+    while (sk.nq > 0)
+        if (!sk_body(&sk, sk.queue[--sk.nq], NULL)) goto done;
+    nf = 0;
+    for (int f = 0; f < nall; f++) {
+        sk.fmap[f] = sk.live[f] ? nf++ : -1;
+        if (!sk.live[f]) shrink_stats.funcs++;
+        if (!sk.live[f] && f < sk.nimp) shrink_stats.imports++;
+    }
+    shrink_stats.funcs -= shrink_stats.imports;
+
+    /* Types still used, equal ones merged */
+    tmap = cw_malloc((ntypes + 1) * sizeof(int));
+    for (int t = 0; t < ntypes; t++) tmap[t] = -1;
+    for (int f = 0; f < nall; f++)
+        if (sk.live[f]) tmap[f < sk.nimp ? imp[f].idx : sk.ftype[f - sk.nimp]] = 0;
+    nt = 0;
+    for (int t = 0; t < ntypes; t++) {
+        if (tmap[t] < 0) { shrink_stats.types++; continue; }
+        tmap[t] = -2;
+        for (int u = 0; u < t && tmap[t] == -2; u++)
+            if (tmap[u] >= 0 && types[u].len == types[t].len
+                && memcmp(types[u].at, types[t].at, types[t].len) == 0) tmap[t] = tmap[u];
+        if (tmap[t] == -2) tmap[t] = nt++;
+        else shrink_stats.types++;
+    }
+
+    /* --- Write --- */
+    buf_bytes(&out, in->data, 8);
+    for (int i = 0; i < nsec; i++) {
+        Buf s; buf_init(&s);
+        int id = sec[i].id, at = out.len, keep = 1;
+        if (id == 1) {
+            buf_uleb(&s, nt);
+            for (int t = 0, next = 0; t < ntypes; t++)
+                if (tmap[t] == next) { buf_bytes(&s, types[t].at, types[t].len); next++; }
+        } else if (id == 2) {
+            int n = 0;
+            for (int f = 0; f < sk.nimp; f++) n += sk.live[f];
+            buf_uleb(&s, n);
+            for (int f = 0; f < sk.nimp; f++)
+                if (sk.live[f]) {
+                    buf_bytes(&s, imp[f].at, imp[f].len);
+                    buf_uleb(&s, tmap[imp[f].idx]);
+                }
+            keep = n > 0;
+        } else if (id == 3) {
+            buf_uleb(&s, nf - (sk.nimp - shrink_stats.imports));
+            for (int f = 0; f < sk.nfunc; f++)
+                if (sk.live[sk.nimp + f]) buf_uleb(&s, tmap[sk.ftype[f]]);
+        } else if (id == 7) {
+            buf_uleb(&s, nexp);
+            for (int e = 0; e < nexp; e++) {
+                buf_bytes(&s, exp[e].at, exp[e].len);
+                buf_uleb(&s, exp[e].at[exp[e].len - 1] == 0x00 ? (uint32_t)sk.fmap[exp[e].idx] : exp[e].idx);
+            }
+        } else if (id == 10) {
+            buf_uleb(&s, nf - (sk.nimp - shrink_stats.imports));
+            for (int f = 0; f < sk.nfunc; f++) {
+                /* the body's size LEB, the byte before its declarations */
+                int old_at = (int)(sk.body[f] - in->data) - uleb_size(sk.body_len[f]);
+                if (!sk.live[sk.nimp + f]) { sk_pair(&sk.map, old_at, -1); continue; }
+                sk_pair(&sk.map, old_at, s.len);
+                int first = sk.map.len / (int)(2 * sizeof(int));
+                Buf body; buf_init(&body);
+                int walked = sk_body(&sk, f, &body);
+                int shift = s.len + uleb_size(body.len);
+                int *pair = (int *)sk.map.data;
+                for (int k = first; k < sk.map.len / (int)(2 * sizeof(int)); k++)
+                    pair[2 * k + 1] += shift;
+                buf_uleb(&s, body.len);
+                buf_bytes(&s, body.data, body.len);
+                buf_free(&body);
+                if (!walked) { buf_free(&s); goto done; }
+            }
+            code_base = out.len + 1 + uleb_size(s.len);
+        } else if (id == 11) {
+            keep = sk_data(seg, nseg, &s) > 0;
+        } else if (i == lines_sec) {
+            SkRd lr = { sec[i].p, sec[i].p + sec[i].len, 0 };
+            sk_skip(&lr, sk_uleb(&lr));
+            sk_uleb(&lr);
+            uint32_t count = sk_uleb(&lr);
+            if (!sk_lines(&sk, &lr, count, code_base, &s)) { buf_free(&s); goto done; }
+        } else {
+            buf_bytes(&s, sec[i].p, sec[i].len);
+        }
+        if (keep) buf_section(&out, id, &s);
+        buf_free(&s);
+        shrink_stats.after[id] += out.len - at;
+    }
+    ok = 1;
+
+done:
+    if (!ok) {
+        /* Not a module this pass understands: leave it as it is */
+        memset(&shrink_stats, 0, sizeof(shrink_stats));
+        shrink_stats.str_bytes = str_bytes;
+        shrink_stats.skipped = 1;
+        out.len = 0;
+        buf_bytes(&out, in->data, in->len);
+    }
+    cw_free(types); cw_free(imp); cw_free(exp); cw_free(seg); cw_free(tmap);
+    cw_free(sk.ftype); cw_free(sk.body); cw_free(sk.body_len);
+    cw_free(sk.live); cw_free(sk.queue); cw_free(sk.fmap);
+    buf_free(&sk.map);
+    return out;
+}
+
 Buf assemble_to_buf(void) {
     nftypes = 0;
     Buf out; buf_init(&out);
@@ -49,10 +698,24 @@ Buf assemble_to_buf(void) {
         else imp_remap[i] = -1;
     }
 
-    /* --- Patch call targets in all code buffers --- */
+    /* --- Optimize (before call targets are renumbered) --- */
+    memset(&opt_stats, 0, sizeof(opt_stats));
+    if (opt_level > 0)
+        opt_scan_globals();
+    if (opt_level >= 2)
+        opt_inline();
+    if (opt_level > 0)
+        for (int i = 0; i < nfuncs; i++)
+            opt_function(&func_bufs[i]);
+    CW_PHASE(link);
+
+    /* --- Patch call targets in all code buffers; with --release, drop the
+     *     __line stores and move their log entries to where they were --- */
     for (int i = 0; i < nfuncs; i++) {
         FuncCtx *f = &func_bufs[i];
-        if (f->ncall_fixups == 0) continue;
+        int *mark = (int *)f->lines.data;
+        int nmark = f->lines.len / (int)(2 * sizeof(int));
+        if (f->ncall_fixups == 0 && nmark == 0) continue;
         /* Sort fixups by code position (for-loop increment splicing can
          * produce out-of-order entries) */
         for (int a = 0; a < f->ncall_fixups - 1; a++)
@@ -63,9 +726,18 @@ Buf assemble_to_buf(void) {
                     f->call_fixups[b] = tmp;
                 }
         Buf nc; buf_init(&nc);
-        int fix = 0;
+        int fix = 0, mk = 0;
         for (int pos = 0; pos < f->code.len; ) {
-            if (fix < f->ncall_fixups && pos == f->call_fixups[fix]) {
+            if (mk < nmark && pos == mark[2 * mk]) {
+                /* i32.const <line>; global.set __line */
+                const uint8_t *c = f->code.data;
+                if (c[pos++] != OP_I32_CONST) break;
+                while (pos < f->code.len && (c[pos] & 0x80)) pos++;
+                pos++;
+                if (pos + 2 > f->code.len || c[pos] != OP_GLOBAL_SET || c[pos + 1] != GLOBAL_LINE) break;
+                pos += 2;
+                mark[2 * mk++] = nc.len;
+            } else if (fix < f->ncall_fixups && pos == f->call_fixups[fix]) {
                 uint32_t old_idx = 0; int shift = 0; uint8_t b;
                 do {
                     b = f->code.data[pos++];
@@ -87,6 +759,10 @@ Buf assemble_to_buf(void) {
             cw_fatal("c2wasm: BUG: %d call fixups unconsumed in %s\n",
                     f->ncall_fixups - fix, f->name ? f->name : "?");
         }
+        if (mk != nmark) {
+            cw_fatal("c2wasm: BUG: %d __line stores not found in %s\n",
+                    nmark - mk, f->name ? f->name : "?");
+        }
         cw_free(f->code.data);
         f->code = nc;
     }
@@ -246,6 +922,7 @@ Buf assemble_to_buf(void) {
     }
 
     /* --- Code Section (10) --- */
+    int code_at[MAX_FUNCS];     /* module offset of each function's code */
     {
         Buf sec; buf_init(&sec);
         buf_uleb(&sec, nfuncs);
@@ -274,12 +951,16 @@ Buf assemble_to_buf(void) {
                 }
             }
 
+            int hdr = body.len;
             buf_bytes(&body, f->code.data, f->code.len);
 
             buf_uleb(&sec, body.len);
+            code_at[i] = sec.len + hdr;
             buf_bytes(&sec, body.data, body.len);
             buf_free(&body);
         }
+        int sec_at = out.len + 1 + uleb_size(sec.len);
+        for (int i = 0; i < nfuncs; i++) code_at[i] += sec_at;
         buf_section(&out, 10, &sec);
         buf_free(&sec);
     }
@@ -296,9 +977,52 @@ Buf assemble_to_buf(void) {
         buf_free(&sec);
     }
 
+    /* --- Line table (custom section, --release) --- */
+    if (release_mode) {
+        Buf sec; buf_init(&sec);
+        buf_str(&sec, "conez.lines");
+        write_line_table(&sec, code_at);
+        buf_section(&out, 0, &sec);
+        buf_free(&sec);
+    }
+
+    /* --- Size pass; --size-report runs it just to measure --- */
+    if (shrink_mode || size_report) {
+        Buf small = shrink_module(&out);
+        if (shrink_mode) { buf_free(&out); out = small; }
+        else buf_free(&small);
+    }
+
     return out;
 }
 
+static void print_size_report(void) {
+    static const char *const name[12] = {
+        "custom", "type", "import", "function", NULL, "memory",
+        "global", "export", NULL, NULL, "code", "data",
+    };
+    static const int order[] = { 1, 2, 3, 5, 6, 7, 10, 11, 0 };
+    const ShrinkStats *s = &shrink_stats;
+    if (s->skipped) {
+        cw_info("  size: module not understood, left as linked\n");
+        return;
+    }
+    int before = 8, after = 8;
+    cw_info("  %-9s %7s %7s\n", "section", "linked", "shrunk");
+    for (int i = 0; i < (int)(sizeof(order) / sizeof(order[0])); i++) {
+        int id = order[i];
+        if (!s->before[id] && !s->after[id]) continue;
+        cw_info("  %-9s %7d %7d\n", name[id], s->before[id], s->after[id]);
+        before += s->before[id];
+        after += s->after[id];
+    }
+    cw_info("  %-9s %7d %7d  (%d bytes, %.1f%%)\n", "total", before, after,
+            after - before, 100.0 * (after - before) / before);
+    cw_info("  dropped %d functions, %d imports, %d types, %d locals, %d data bytes;"
+            " %d string bytes shared%s\n", s->funcs, s->imports, s->types, s->locals,
+            s->data_bytes, s->str_bytes, shrink_mode ? "" : " (only under --shrink)");
+}
+
 void assemble(const char *outpath) {
     Buf out = assemble_to_buf();
 
@@ -318,5 +1042,14 @@ void assemble(const char *outpath) {
         if (imp_used[i]) num_imp++;
     cw_info("  %d imports, %d functions, %d globals, %d bytes data\n",
            num_imp, nfuncs, nglobals, data_len);
+    if (opt_level > 0)
+        cw_info("  -O%d: %d -> %d instructions, %d -> %d locals (%d -> %d frame bytes)\n",
+               opt_level, opt_stats.ins_before, opt_stats.ins_after,
+               opt_stats.locals_before, opt_stats.locals_after,
+               opt_stats.frame_before, opt_stats.frame_after);
+    if (opt_stats.inlined)
+        cw_info("  -O%d: inlined %d call sites\n", opt_level, opt_stats.inlined);
+    if (size_report)
+        print_size_report();
     buf_free(&out);
 }
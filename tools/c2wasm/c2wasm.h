@@ -200,6 +200,11 @@ void buf_section(Buf *out, int id, Buf *content);
 #define OP_F64_CONVERT_I64_U 0xBA
 #define OP_F64_PROMOTE_F32   0xBB
 
+/* 0xFC-prefixed (bulk memory); the sub-opcode follows as a ULEB */
+#define OP_MISC_PREFIX   0xFC
+#define MISC_MEMORY_COPY 0x0A
+#define MISC_MEMORY_FILL 0x0B
+
 #define WASM_I32  0x7F
 #define WASM_I64  0x7E
 #define WASM_F32  0x7D
@@ -250,6 +255,7 @@ enum {
     IMP_FILE_SIZE, IMP_FILE_SEEK, IMP_FILE_TELL, IMP_FILE_EOF,
     IMP_FILE_TRUNCATE, IMP_FILE_FLUSH,
     IMP_FILE_READLN, IMP_FILE_READLN_STR, IMP_FILE_WRITELN,
+    IMP_FILE_MAP, IMP_FILE_MAP_GET, IMP_FILE_UNMAP,
     IMP_FILE_STAT, IMP_FILE_DELETE, IMP_FILE_RENAME,
     IMP_FILE_MKDIR, IMP_FILE_RMDIR,
     IMP_DIR_OPEN, IMP_DIR_READ, IMP_DIR_CLOSE,
@@ -262,11 +268,12 @@ enum {
     IMP_MALLOC, IMP_FREE, IMP_CALLOC, IMP_REALLOC,
     IMP_INFLATE_FILE, IMP_INFLATE_FILE_TO_MEM, IMP_INFLATE_MEM,
     IMP_DEFLATE_FILE, IMP_DEFLATE_MEM_TO_FILE, IMP_DEFLATE_MEM,
+    IMP_GET_FRAME, IMP_GET_FRAME_RATE,
     IMP_COUNT
 };
 
 extern const ImportDef imp_defs[IMP_COUNT];
-extern uint8_t imp_used[IMP_COUNT];
+extern CW_TLS uint8_t imp_used[IMP_COUNT];
 
 /* ================================================================
  *  C Type System
@@ -345,11 +352,11 @@ typedef struct {
 } StructType;
 
 #ifdef C2WASM_EMBEDDED
-extern StructType *struct_types;
+extern CW_TLS StructType *struct_types;
 #else
-extern StructType struct_types[MAX_STRUCT_TYPES];
+extern CW_TLS StructType struct_types[MAX_STRUCT_TYPES];
 #endif
-extern int n_struct_types;
+extern CW_TLS int n_struct_types;
 
 int struct_find(const char *tag);         /* -1 if not found */
 int struct_register(const char *tag);     /* create incomplete, or return existing */
@@ -375,6 +382,7 @@ int struct_find_field(int sid, const char *name);  /* field index, -1 if missing
 #define CW_MAX_LOCALS  256
 #define CW_MAX_FIXUPS  1024
 #endif
+#define SYM_HASH_SIZE MAX_SYMS    /* power of two */
 #define FMT_BUF_ADDR 0xF000
 
 typedef enum {
@@ -401,10 +409,13 @@ typedef struct {
     int idx;            /* WASM global/local/func index */
     int imp_id;         /* IMP_xxx for imports, -1 otherwise */
     int scope;          /* scope depth (0=global) */
+    uint16_t hash;      /* sym_hash bucket of the name it was added under */
+    uint16_t hash_next; /* next older symbol in that bucket, index+1 (0=end) */
     /* function info */
     int param_count;
     CType param_types[8];
     int is_static;
+    int is_inline;      /* declared inline: -O2 inlines it more eagerly */
     int is_const;       /* 1 if variable is const-qualified */
     int is_defined;     /* 1 if function body has been compiled */
     int is_float_macro; /* 1 if macro value is a float */
@@ -453,6 +464,8 @@ typedef struct {
     CType return_type;
     int call_fixups[CW_MAX_FIXUPS];
     int ncall_fixups;
+    Buf lines;           /* --release: (code offset, line) int pairs, one per
+                          * __line store, in code order */
 } FuncCtx;
 
 /* ================================================================
@@ -493,7 +506,7 @@ enum {
     TOK_IF, TOK_ELSE, TOK_FOR, TOK_WHILE, TOK_DO, TOK_SWITCH,
     TOK_CASE, TOK_DEFAULT, TOK_BREAK, TOK_CONTINUE, TOK_RETURN,
     TOK_INT, TOK_FLOAT, TOK_DOUBLE, TOK_VOID, TOK_CHAR,
-    TOK_STATIC, TOK_CONST, TOK_UNSIGNED, TOK_LONG,
+    TOK_STATIC, TOK_INLINE, TOK_CONST, TOK_UNSIGNED, TOK_LONG,
     TOK_SHORT, TOK_SIGNED, TOK_BOOL, TOK_STRUCT,
     TOK_INT8, TOK_INT16, TOK_INT32, TOK_INT64, TOK_SIZE_T,
     TOK_UINT8, TOK_UINT16, TOK_UINT32, TOK_UINT64,
@@ -507,52 +520,72 @@ enum {
  * ================================================================ */
 
 #ifdef C2WASM_EMBEDDED
-extern Symbol *syms;
-extern FuncCtx *func_bufs;
-extern CtrlEntry *ctrl_stk;
-extern char *data_buf;
+extern CW_TLS Symbol *syms;
+extern CW_TLS uint16_t *sym_hash;
+extern CW_TLS FuncCtx *func_bufs;
+extern CW_TLS CtrlEntry *ctrl_stk;
+extern CW_TLS char *data_buf;
 #else
-extern Symbol syms[MAX_SYMS];
-extern FuncCtx func_bufs[MAX_FUNCS];
-extern CtrlEntry ctrl_stk[MAX_CTRL];
-extern char data_buf[MAX_STRINGS];
+extern CW_TLS Symbol syms[MAX_SYMS];
+extern CW_TLS uint16_t sym_hash[SYM_HASH_SIZE];
+extern CW_TLS FuncCtx func_bufs[MAX_FUNCS];
+extern CW_TLS CtrlEntry ctrl_stk[MAX_CTRL];
+extern CW_TLS char data_buf[MAX_STRINGS];
 #endif
-extern int nsym;
-extern int cur_scope;
-extern int nfuncs;
-extern int cur_func;
-extern int ctrl_sp;
-extern int block_depth;
-extern int data_len;
-
-extern char *source;
-extern int src_len;
-extern int src_pos;
-extern int line_num;
-extern char *src_file;
-
-extern int tok;
-extern int tok_ival;
-extern int64_t tok_i64;
-extern int tok_int_is_64;
-extern int tok_int_unsigned;
-extern float tok_fval;
-extern double tok_dval;      /* double-precision float literal value */
-extern char tok_sval[1024];  /* string/name value */
-extern int tok_slen;         /* string literal length */
-
-extern int had_error;
-extern int nglobals;    /* number of WASM globals (0=_heap_ptr, 1+=user) */
+extern CW_TLS int nsym;
+extern CW_TLS int cur_scope;
+extern CW_TLS int nfuncs;
+extern CW_TLS int cur_func;
+extern CW_TLS int ctrl_sp;
+extern CW_TLS int block_depth;
+extern CW_TLS int data_len;
+
+extern CW_TLS char *source;
+extern CW_TLS int src_len;
+extern CW_TLS int src_pos;
+extern CW_TLS int line_num;
+extern CW_TLS char *src_file;
+
+extern CW_TLS int tok;
+extern CW_TLS int tok_ival;
+extern CW_TLS int64_t tok_i64;
+extern CW_TLS int tok_int_is_64;
+extern CW_TLS int tok_int_unsigned;
+extern CW_TLS float tok_fval;
+extern CW_TLS double tok_dval;      /* double-precision float literal value */
+extern CW_TLS char tok_sval[1024];  /* string/name value */
+extern CW_TLS int tok_slen;         /* string literal length */
+
+extern CW_TLS int had_error;
+extern CW_TLS int nglobals;    /* number of WASM globals (0=_heap_ptr, 1+=user) */
 
 #define GLOBAL_HEAP_PTR 0
 #define GLOBAL_LINE     1
 
-extern int has_setup;
-extern int has_loop;
-extern int type_had_pointer;
-extern int type_had_const;
-extern int type_had_unsigned;
-extern int type_last_struct_id;   /* struct ID after parse_type_spec, or -1 */
+extern int release_mode;    /* --release: __line stores become a conez.lines
+                             * table (assemble.c). Like opt_level, a setting
+                             * shared by all threads, not per-thread state */
+extern int shrink_mode;     /* --shrink: size pass over the finished module, */
+extern int size_report;     /* --size-report: what it saves (assemble.c) */
+
+typedef struct {
+    int before[12], after[12];          /* bytes per section id, header included */
+    int funcs, imports, types, locals;  /* dropped by the size pass */
+    int data_bytes;                     /* data left to memory's zeros or merged */
+    int str_bytes;                      /* string literal bytes shared */
+    int skipped;                        /* module not understood, left as is */
+} ShrinkStats;
+extern CW_TLS ShrinkStats shrink_stats;
+extern CW_TLS Buf str_lits; /* offsets of the string literals, for --shrink */
+int find_string(const char *s, int len);
+void trim_strings(void);
+
+extern CW_TLS int has_setup;
+extern CW_TLS int has_loop;
+extern CW_TLS int type_had_pointer;
+extern CW_TLS int type_had_const;
+extern CW_TLS int type_had_unsigned;
+extern CW_TLS int type_last_struct_id;   /* struct ID after parse_type_spec, or -1 */
 
 /* ================================================================
  *  Helpers
@@ -574,18 +607,31 @@ static inline void error_fmt(const char *fmt, ...) {
     error_at(buf);
 }
 
+/* Symbols live on a stack (syms[0..nsym)) that scopes push and pop, and
+ * each name hashes to a bucket chaining its symbols newest first, so a
+ * lookup walks only same-bucket symbols and the first match is still the
+ * innermost. Chains hold index+1 so a zeroed table is empty. */
+static inline unsigned sym_hash_of(const char *name) {
+    uint32_t h = 2166136261u;                   /* FNV-1a */
+    while (*name) h = (h ^ (uint8_t)*name++) * 16777619u;
+    return h & (SYM_HASH_SIZE - 1);
+}
+
 static inline Symbol *find_sym(const char *name) {
-    /* Search from end to find innermost scope first */
-    for (int i = nsym - 1; i >= 0; i--)
-        if (strcmp(syms[i].name, name) == 0 && syms[i].scope <= cur_scope)
-            return &syms[i];
+    for (int i = sym_hash[sym_hash_of(name)]; i; i = syms[i - 1].hash_next) {
+        Symbol *s = &syms[i - 1];
+        if (s->scope <= cur_scope && strcmp(s->name, name) == 0)
+            return s;
+    }
     return NULL;
 }
 
 static inline Symbol *find_sym_kind(const char *name, SymKind kind) {
-    for (int i = nsym - 1; i >= 0; i--)
-        if (syms[i].kind == kind && strcmp(syms[i].name, name) == 0)
-            return &syms[i];
+    for (int i = sym_hash[sym_hash_of(name)]; i; i = syms[i - 1].hash_next) {
+        Symbol *s = &syms[i - 1];
+        if (s->kind == kind && strcmp(s->name, name) == 0)
+            return s;
+    }
     return NULL;
 }
 
@@ -598,20 +644,43 @@ static inline Symbol *add_sym(const char *name, SymKind kind, CType ct) {
     s->ctype = ct;
     s->imp_id = -1;
     s->scope = cur_scope;
+    s->hash = (uint16_t)sym_hash_of(s->name);
+    s->hash_next = sym_hash[s->hash];
+    sym_hash[s->hash] = (uint16_t)nsym;
     return s;
 }
 
+/* Pop symbols until n remain. Each popped symbol heads its bucket, being
+ * the newest. (#undef blanks a name but leaves it in the bucket it was
+ * added under, hence s->hash.) */
+static inline void drop_syms(int n) {
+    while (nsym > n) {
+        Symbol *s = &syms[--nsym];
+        sym_hash[s->hash] = s->hash_next;
+#ifdef C2WASM_EMBEDDED
+        cw_free(s->macro_val);      /* a block-scoped #define's value */
+        s->macro_val = NULL;
+#endif
+    }
+}
+
+/* Literals are read-only (writing one is undefined), so under --shrink
+ * equal ones share storage */
 static inline int add_string(const char *s, int len) {
+    int off = shrink_mode ? find_string(s, len) : -1;
+    if (off >= 0) { shrink_stats.str_bytes += len + 1; return off; }
     if (data_len + len + 1 > MAX_STRINGS) { error_at("string table full"); return 0; }
-    int off = data_len;
+    off = data_len;
     memcpy(data_buf + data_len, s, len);
     data_buf[data_len + len] = 0;
     data_len += len + 1;
+    if (shrink_mode) buf_bytes(&str_lits, &off, sizeof(off));
     return off;
 }
 
 static inline int add_data_zeros(int size, int align) {
     if (align < 1) align = 1;
+    if (shrink_mode) trim_strings();
     int off = (data_len + (align - 1)) & ~(align - 1);
     if (off + size > MAX_STRINGS) { error_at("data section full"); return 0; }
     if (off > data_len) memset(data_buf + data_len, 0, off - data_len);
@@ -663,7 +732,7 @@ typedef struct {
     float   fval32;
     double  fval64;
 } FoldSlot;
-extern FoldSlot fold_p, fold_a, fold_b;
+extern CW_TLS FoldSlot fold_p, fold_a, fold_b;
 
 /* ================================================================
  *  Emit Helpers
@@ -715,6 +784,17 @@ static inline void emit_call(int func_idx) {
     buf_uleb(CODE, func_idx);
     if (func_idx < IMP_COUNT) imp_used[func_idx] = 1;
 }
+/* Statement boundary: __line = line_num. With --release the store is
+ * logged so assemble_to_buf() can drop it and map its offset instead. */
+static inline void emit_line_mark(void) {
+    FuncCtx *f = &func_bufs[cur_func];
+    if (release_mode) {
+        int m[2] = { f->code.len, line_num };
+        buf_bytes(&f->lines, m, sizeof(m));
+    }
+    emit_i32_const(line_num);
+    buf_byte(CODE, OP_GLOBAL_SET); buf_uleb(CODE, GLOBAL_LINE);
+}
 static inline void emit_global_get(int idx) {
     buf_byte(CODE, OP_GLOBAL_GET); buf_uleb(CODE, idx);
 }
@@ -742,6 +822,13 @@ static inline void emit_f32_load(int offset) {
 static inline void emit_f32_store(int offset) {
     buf_byte(CODE, OP_F32_STORE); buf_uleb(CODE, 2); buf_uleb(CODE, offset);
 }
+/* memory.copy [dst src n] and memory.fill [dst byte n], memory index 0 */
+static inline void emit_memory_copy(void) {
+    buf_byte(CODE, OP_MISC_PREFIX); buf_uleb(CODE, MISC_MEMORY_COPY); buf_byte(CODE, 0); buf_byte(CODE, 0);
+}
+static inline void emit_memory_fill(void) {
+    buf_byte(CODE, OP_MISC_PREFIX); buf_uleb(CODE, MISC_MEMORY_FILL); buf_byte(CODE, 0);
+}
 static inline void emit_block(void)  { buf_byte(CODE, OP_BLOCK); buf_byte(CODE, WASM_VOID); block_depth++; }
 static inline void emit_loop(void)   { buf_byte(CODE, OP_LOOP);  buf_byte(CODE, WASM_VOID); block_depth++; }
 static inline void emit_if_void(void){ buf_byte(CODE, OP_IF);    buf_byte(CODE, WASM_VOID); block_depth++; }
@@ -919,13 +1006,28 @@ int is_type_keyword(int t);
 /* expr.c */
 CType expr(void);
 CType assignment_expr(void);
+void struct_copy_from_expr(int struct_id);
 
 /* stmt.c */
 void parse_top_level(void);
 void parse_block(void);
 void parse_stmt(void);
 
+/* opt.c */
+typedef struct {
+    int ins_before, ins_after;          /* instructions, all functions */
+    int locals_before, locals_after;
+    int frame_before, frame_after;      /* wasm3 frame bytes of those locals */
+    int inlined;                        /* call sites inlined */
+} OptStats;
+extern int opt_level;                   /* 0 (default), 1 = -O1, 2 = -O2 */
+extern CW_TLS OptStats opt_stats;
+void opt_scan_globals(void);
+void opt_function(FuncCtx *f);
+void opt_inline(void);
+
 /* assemble.c */
+Buf shrink_module(const Buf *in);
 Buf assemble_to_buf(void);
 void assemble(const char *outpath);
 
@@ -14,5 +14,6 @@
 #include "type_ops.c"
 #include "expr.c"
 #include "stmt.c"
+#include "opt.c"
 #include "assemble.c"
 #include "main.c"
@@ -8,10 +8,10 @@
 #include <stdarg.h>
 
 /* --- Callback state --- */
-cw_diag_fn cw_on_error = NULL;
-cw_diag_fn cw_on_info  = NULL;
-void *cw_cb_ctx = NULL;
-jmp_buf cw_bail;
+CW_TLS cw_diag_fn cw_on_error = NULL;
+CW_TLS cw_diag_fn cw_on_info  = NULL;
+CW_TLS void *cw_cb_ctx = NULL;
+CW_TLS jmp_buf cw_bail;
 
 /* --- Memory wrappers --- */
 /* All allocation failures longjmp via cw_fatal so callers can use the result
@@ -10,14 +10,37 @@
 #include <stddef.h>
 #include <setjmp.h>
 
+/* Compiler state is per thread, so threads can compile at once (--jobs,
+ * the simulator's compiler workers). C2WASM_NO_TLS keeps plain globals:
+ * the firmware defines it because ESP-IDF carves every task's TLS block
+ * out of its stack, and it compiles one program at a time anyway. */
+#if defined(C2WASM_NO_TLS)
+#define CW_TLS
+#elif defined(__cplusplus)
+#define CW_TLS thread_local
+#elif defined(_MSC_VER)
+#define CW_TLS __declspec(thread)
+#else
+#define CW_TLS _Thread_local
+#endif
+
+/* Phase marks: the compiler calls CW_PHASE(parse) as it starts reading
+ * tokens, CW_PHASE(assemble) before assemble_to_buf(), CW_PHASE(link)
+ * there once the -O passes are done, and CW_PHASE(done) at the end.
+ * Nothing unless the includer defines it (tools/compile_bench times
+ * them). */
+#ifndef CW_PHASE
+#define CW_PHASE(p) ((void)0)
+#endif
+
 #ifdef C2WASM_EMBEDDED
 
-/* --- Diagnostic callbacks --- */
+/* --- Diagnostic callbacks (per thread, like the rest of the state) --- */
 typedef void (*cw_diag_fn)(const char *msg, void *ctx);
-extern cw_diag_fn cw_on_error;
-extern cw_diag_fn cw_on_info;
-extern void *cw_cb_ctx;
-extern jmp_buf cw_bail;
+extern CW_TLS cw_diag_fn cw_on_error;
+extern CW_TLS cw_diag_fn cw_on_info;
+extern CW_TLS void *cw_cb_ctx;
+extern CW_TLS jmp_buf cw_bail;
 
 /* --- Memory --- */
 void *cw_malloc(size_t n);
@@ -72,6 +95,7 @@ void  cw_fatal(const char *fmt, ...);    /* calls on_error + longjmp */
 #define assemble       cw_assemble
 #define syms           cw_syms
 #define nsym           cw_nsym
+#define sym_hash       cw_sym_hash
 #define cur_scope      cw_cur_scope
 #define nglobals       cw_nglobals
 #define has_setup      cw_has_setup
@@ -83,6 +107,19 @@ void  cw_fatal(const char *fmt, ...);    /* calls on_error + longjmp */
 #define fold_p         cw_fold_p
 #define fold_a         cw_fold_a
 #define fold_b         cw_fold_b
+#define opt_level      cw_opt_level
+#define opt_stats      cw_opt_stats
+#define opt_function   cw_opt_function
+#define opt_inline     cw_opt_inline
+#define opt_scan_globals cw_opt_scan_globals
+#define release_mode   cw_release_mode
+#define shrink_mode    cw_shrink_mode
+#define size_report    cw_size_report
+#define shrink_stats   cw_shrink_stats
+#define shrink_module  cw_shrink_module
+#define str_lits       cw_str_lits
+#define find_string    cw_find_string
+#define trim_strings   cw_trim_strings
 
 #else /* standalone */
 
@@ -109,7 +146,12 @@ static inline void *cw_calloc(size_t n, size_t sz) {
 #define cw_error(fmt, ...)  fprintf(stderr, fmt, ##__VA_ARGS__)
 #define cw_info(fmt, ...)   printf(fmt, ##__VA_ARGS__)
 #define cw_warn(fmt, ...)   fprintf(stderr, fmt, ##__VA_ARGS__)
-#define cw_fatal(fmt, ...)  do { fprintf(stderr, fmt, ##__VA_ARGS__); exit(1); } while(0)
+/* A --jobs worker points cw_job_bail at its jmp_buf so a fatal error ends
+ * that file's compile rather than the whole run. */
+extern CW_TLS jmp_buf *cw_job_bail;
+#define cw_fatal(fmt, ...)  do { fprintf(stderr, fmt, ##__VA_ARGS__); \
+                                 if (cw_job_bail) longjmp(*cw_job_bail, 1); \
+                                 exit(1); } while(0)
 
 #endif /* C2WASM_EMBEDDED */
 
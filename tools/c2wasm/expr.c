@@ -16,17 +16,17 @@ static void emit_sym_load(Symbol *sym);
 static void emit_sym_store(Symbol *sym);
 
 /* Track the last variable symbol accessed for postfix ++/-- */
-static Symbol *last_var_sym = NULL;
+static CW_TLS Symbol *last_var_sym = NULL;
 
 /* Lvalue tracking for assignment to array elements/pointers */
-static int lvalue_addr_local = -1;  /* Local holding address for complex lvalue, or -1 */
-static CType lvalue_type = CT_INT;  /* Type of the lvalue */
+static CW_TLS int lvalue_addr_local = -1;  /* Local holding address for complex lvalue, or -1 */
+static CW_TLS CType lvalue_type = CT_INT;  /* Type of the lvalue */
 
 /* Lightweight expression pointer metadata (side-channel alongside CType). */
-static int expr_last_is_ptr = 0;
-static int expr_last_elem_size = 4;
-static int expr_last_has_type = 0;
-static TypeInfo expr_last_type;
+static CW_TLS int expr_last_is_ptr = 0;
+static CW_TLS int expr_last_elem_size = 4;
+static CW_TLS int expr_last_has_type = 0;
+static CW_TLS TypeInfo expr_last_type;
 
 static void expr_set_scalar_type(CType ct) {
     expr_last_has_type = 1;
@@ -548,7 +548,7 @@ static CType primary_expr(void) {
             sf->ncall_fixups = save_fixups; /* discard any fixups from expr */
             sf->nlocals = save_nlocals;     /* discard any locals from expr */
             data_len = save_data_len;       /* discard any string literals from expr */
-            nsym = save_nsym;               /* discard any symbols from expr */
+            drop_syms(save_nsym);           /* discard any symbols from expr */
             type_last_struct_id = save_struct_id;
             n_struct_types = save_n_structs;
             memcpy(imp_used, save_imp_used, sizeof(imp_used));
@@ -578,6 +578,33 @@ static CType primary_expr(void) {
             if (strcmp(name, "printf") == 0) return compile_printf_call();
             if (strcmp(name, "print") == 0) return compile_print_call();
 
+            /* memset/memcpy/memmove lower to memory.fill / memory.copy
+             * (memory.copy has memmove semantics) unless the program
+             * defines its own. All return dst. */
+            if ((strcmp(name, "memset") == 0 || strcmp(name, "memcpy") == 0 ||
+                 strcmp(name, "memmove") == 0) && !find_sym_kind(name, SYM_FUNC)) {
+                int is_fill = (name[3] == 's');
+                next_token(); /* skip '(' */
+                emit_coerce(assignment_expr(), CT_INT);
+                int dst = alloc_local(WASM_I32);
+                emit_local_tee(dst);
+                expect(TOK_COMMA);
+                emit_coerce(assignment_expr(), CT_INT);
+                expect(TOK_COMMA);
+                emit_coerce(assignment_expr(), CT_INT);
+                expect(TOK_RPAREN);
+                if (is_fill) emit_memory_fill();
+                else emit_memory_copy();
+                emit_local_get(dst);
+                lvalue_addr_local = -1;
+                last_var_sym = NULL;
+                expr_last_has_type = 1;
+                expr_last_type = type_pointer(type_base(CT_VOID));
+                expr_last_is_ptr = 1;
+                expr_last_elem_size = 1;
+                return CT_INT;
+            }
+
             /* WASM-native math builtins (single opcode, no import needed) */
             {
                 int opcode = 0;
@@ -682,6 +709,9 @@ static CType primary_expr(void) {
             expr_last_elem_size = expr_last_is_ptr ? type_element_size(sym->type_info) : ctype_sizeof(sym->ctype);
             expr_last_has_type = 1;
             expr_last_type = sym->type_info;
+            /* A struct-by-value global keeps its base address as an i32
+             * (ctype CT_INT); as a value it is a struct, like a local one */
+            if (type_is_struct(sym->type_info)) return CT_STRUCT;
         } else if (sym->kind == SYM_IMPORT) {
             /* Calling import as a variable? Shouldn't happen. */
             error_fmt("'%s' is a function, not a variable", name);
@@ -1568,6 +1598,36 @@ static CType prec_expr(int min_prec) {
 
 /* ---- Ternary and assignment ---- */
 
+/* Struct assignment and initialisation. Stack on entry: [dst_addr]. Parses
+ * the right-hand side, which must be a struct of the same type (a struct
+ * value is its address), and copies it over dst with memory.copy. */
+void struct_copy_from_expr(int struct_id) {
+    CType rhs = assignment_expr();
+    if (rhs != CT_STRUCT || !expr_last_has_type || !type_is_struct(expr_last_type)
+        || expr_last_type.struct_id != struct_id) {
+        error_fmt("incompatible type in assignment to 'struct %s'", struct_types[struct_id].tag);
+        return;
+    }
+    emit_i32_const(struct_types[struct_id].size);
+    emit_memory_copy();
+}
+
+/* lhs = rhs for a struct lvalue whose address is on the stack; the result
+ * is the lvalue, like any other struct-valued expression. */
+static CType struct_assign(TypeInfo t) {
+    int dst = alloc_local(WASM_I32);
+    emit_local_tee(dst);
+    struct_copy_from_expr(t.struct_id);
+    emit_local_get(dst);
+    lvalue_addr_local = -1;
+    last_var_sym = NULL;
+    expr_last_has_type = 1;
+    expr_last_type = t;
+    expr_last_is_ptr = 0;
+    expr_last_elem_size = struct_types[t.struct_id].size;
+    return CT_STRUCT;
+}
+
 CType assignment_expr(void) {
     /* Fast path for simple name-based assignment forms to avoid
      * pre-loading the lvalue on stack. */
@@ -1583,8 +1643,11 @@ CType assignment_expr(void) {
             Symbol *sym = find_sym(name);
             if (!sym) { error_fmt("undefined variable '%s'", name); return CT_INT; }
             if (type_is_array(sym->type_info)) { error_fmt("assignment to array '%s' is not allowed", name); return CT_INT; }
-            if (type_is_struct(sym->type_info)) { error_fmt("struct assignment not supported (use field-by-field copy)"); return CT_INT; }
             if (sym->is_const) error_fmt("assignment to const variable '%s'", name);
+            if (type_is_struct(sym->type_info)) {
+                emit_sym_load(sym);
+                return struct_assign(sym->type_info);
+            }
             CType rhs = assignment_expr();
             /* C11 6.5.16.1: assigning an integer to a pointer requires an
              * explicit cast; the sole exception is a null pointer constant
@@ -1707,6 +1770,15 @@ CType assignment_expr(void) {
     
     /* Check for assignment operators */
     if (tok == TOK_ASSIGN) {
+        /* Struct lvalue (variable, member, element): its address is on the stack */
+        if (lhs_type == CT_STRUCT && expr_last_has_type && type_is_struct(expr_last_type)) {
+            if (last_var_sym && last_var_sym->is_const)
+                error_fmt("assignment to const variable '%s'", last_var_sym->name);
+            TypeInfo t = expr_last_type;
+            next_token(); /* skip '=' */
+            return struct_assign(t);
+        }
+
         /* Simple assignment: lvalue = expr */
         if (last_var_sym == NULL && lvalue_addr_local < 0) {
             error_at("left side of assignment is not an lvalue");
@@ -1725,10 +1797,6 @@ CType assignment_expr(void) {
         if (last_var_sym) {
             /* Simple variable */
             if (last_var_sym->is_const) error_fmt("assignment to const variable '%s'", last_var_sym->name);
-            if (type_is_struct(last_var_sym->type_info)) {
-                error_fmt("struct assignment not supported (use field-by-field copy)");
-                return CT_INT;
-            }
             emit_coerce(rhs, last_var_sym->ctype);
             emit_sym_store_and_reload(last_var_sym);
             expr_last_is_ptr = type_is_pointer(last_var_sym->type_info) || type_is_array(last_var_sym->type_info);
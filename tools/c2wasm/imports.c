@@ -113,6 +113,9 @@ const ImportDef imp_defs[IMP_COUNT] = {
     [IMP_FILE_READLN]    = {"file_readln",          3,{_I,_I,_I},      1,{_I}},
     [IMP_FILE_READLN_STR]= {"file_readln_str",      1,{_I},            1,{_I}},
     [IMP_FILE_WRITELN]   = {"file_writeln",         2,{_I,_I},         1,{_I}},
+    [IMP_FILE_MAP]       = {"file_map",             3,{_I,_I,_I},      1,{_I}},
+    [IMP_FILE_MAP_GET]   = {"file_map_get",         3,{_I,_I,_I},      1,{_I}},
+    [IMP_FILE_UNMAP]     = {"file_unmap",           1,{_I},            0,{}},
     [IMP_FILE_STAT]      = {"file_stat",            2,{_I,_I},         1,{_I}},
     [IMP_FILE_DELETE]    = {"file_delete",          1,{_I},            1,{_I}},
     [IMP_FILE_RENAME]    = {"file_rename",          2,{_I,_I},         1,{_I}},
@@ -152,9 +155,11 @@ const ImportDef imp_defs[IMP_COUNT] = {
     [IMP_DEFLATE_FILE]   = {"deflate_file",          2,{_I,_I},         1,{_I}},
     [IMP_DEFLATE_MEM_TO_FILE]={"deflate_mem_to_file",3,{_I,_I,_I},      1,{_I}},
     [IMP_DEFLATE_MEM]    = {"deflate_mem",           4,{_I,_I,_I,_I},   1,{_I}},
+    [IMP_GET_FRAME]      = {"get_frame",            0,{},              1,{WASM_I64}},
+    [IMP_GET_FRAME_RATE] = {"get_frame_rate",       0,{},              1,{_I}},
 };
 #undef _I
 #undef _F
 #undef _D
 
-uint8_t imp_used[IMP_COUNT];
+CW_TLS uint8_t imp_used[IMP_COUNT];
@@ -3,26 +3,26 @@
  */
 #include "c2wasm.h"
 
-static int peek_tok;
-static int peek_valid;
-static int peek_ival;
-static int64_t peek_i64;
-static int peek_int_is_64;
-static int peek_int_unsigned;
-static float peek_fval;
-static double peek_dval;
-static char peek_sval[1024];
-static int peek_slen;
+static CW_TLS int peek_tok;
+static CW_TLS int peek_valid;
+static CW_TLS int peek_ival;
+static CW_TLS int64_t peek_i64;
+static CW_TLS int peek_int_is_64;
+static CW_TLS int peek_int_unsigned;
+static CW_TLS float peek_fval;
+static CW_TLS double peek_dval;
+static CW_TLS char peek_sval[1024];
+static CW_TLS int peek_slen;
 
 /* Macro expansion depth guard (prevents mutual recursion) */
 #define MAX_MACRO_DEPTH 16
-static int macro_depth;
-static int predefined_counter;
-static char predefined_date[16];
-static char predefined_time[16];
+static CW_TLS int macro_depth;
+static CW_TLS int predefined_counter;
+static CW_TLS char predefined_date[16];
+static CW_TLS char predefined_time[16];
 
 /* Guard to prevent macro expansion during lexer save/restore (e.g., switch pre-scan) */
-static int lexer_save_active = 0;
+static CW_TLS int lexer_save_active = 0;
 
 void lex_init(void) {
     peek_valid = 0;
@@ -35,8 +35,14 @@ void lex_init(void) {
     lexer_save_active = 0;
     predefined_counter = 0;
 
+    /* localtime() shares one buffer between threads */
     time_t now = time(NULL);
-    struct tm *tmv = localtime(&now);
+    struct tm tmbuf;
+#ifdef _MSC_VER
+    struct tm *tmv = localtime_s(&tmbuf, &now) == 0 ? &tmbuf : NULL;
+#else
+    struct tm *tmv = localtime_r(&now, &tmbuf);
+#endif
     if (tmv) {
         strftime(predefined_date, sizeof(predefined_date), "%b %d %Y", tmv);
         strftime(predefined_time, sizeof(predefined_time), "%H:%M:%S", tmv);
@@ -170,6 +176,7 @@ static struct kw keywords[] = {
     {"void",     TOK_VOID},
     {"char",     TOK_CHAR},
     {"static",   TOK_STATIC},
+    {"inline",   TOK_INLINE},
     {"const",    TOK_CONST},
     {"unsigned", TOK_UNSIGNED},
     {"long",     TOK_LONG},
@@ -847,6 +854,7 @@ const char *tok_name(int t) {
     case TOK_WHILE: return "'while'";
     case TOK_DO: return "'do'";
     case TOK_RETURN: return "'return'";
+    case TOK_INLINE: return "'inline'";
     case TOK_INT: return "'int'";
     case TOK_FLOAT: return "'float'";
     case TOK_VOID: return "'void'";
@@ -3,55 +3,58 @@
  */
 #include "c2wasm.h"
 
-/* Global compiler state */
+/* Global compiler state, one copy per thread (CW_TLS) */
 #ifdef C2WASM_EMBEDDED
-Symbol *syms;
-FuncCtx *func_bufs;
-CtrlEntry *ctrl_stk;
-char *data_buf;
+CW_TLS Symbol *syms;
+CW_TLS uint16_t *sym_hash;
+CW_TLS FuncCtx *func_bufs;
+CW_TLS CtrlEntry *ctrl_stk;
+CW_TLS char *data_buf;
 #else
-Symbol syms[MAX_SYMS];
-FuncCtx func_bufs[MAX_FUNCS];
-CtrlEntry ctrl_stk[MAX_CTRL];
-char data_buf[MAX_STRINGS];
+CW_TLS Symbol syms[MAX_SYMS];
+CW_TLS uint16_t sym_hash[SYM_HASH_SIZE];
+CW_TLS FuncCtx func_bufs[MAX_FUNCS];
+CW_TLS CtrlEntry ctrl_stk[MAX_CTRL];
+CW_TLS char data_buf[MAX_STRINGS];
 #endif
-int nsym;
-int cur_scope;
-int nfuncs;
-int cur_func;
-int ctrl_sp;
-int block_depth;
-int data_len;
-
-char *source;
-int src_len;
-int src_pos;
-int line_num;
-char *src_file;
-
-int tok;
-int tok_ival;
-int64_t tok_i64;
-int tok_int_is_64;
-int tok_int_unsigned;
-float tok_fval;
-double tok_dval;
-char tok_sval[1024];
-int tok_slen;
-
-int had_error;
-int nglobals;
-
-int has_setup;
-int has_loop;
-int type_had_pointer;
-int type_had_const;
-int type_had_unsigned;
-int type_last_struct_id;
-
-FoldSlot fold_p, fold_a, fold_b;
+CW_TLS int nsym;
+CW_TLS int cur_scope;
+CW_TLS int nfuncs;
+CW_TLS int cur_func;
+CW_TLS int ctrl_sp;
+CW_TLS int block_depth;
+CW_TLS int data_len;
+
+CW_TLS char *source;
+CW_TLS int src_len;
+CW_TLS int src_pos;
+CW_TLS int line_num;
+CW_TLS char *src_file;
+
+CW_TLS int tok;
+CW_TLS int tok_ival;
+CW_TLS int64_t tok_i64;
+CW_TLS int tok_int_is_64;
+CW_TLS int tok_int_unsigned;
+CW_TLS float tok_fval;
+CW_TLS double tok_dval;
+CW_TLS char tok_sval[1024];
+CW_TLS int tok_slen;
+
+CW_TLS int had_error;
+CW_TLS int nglobals;
+
+CW_TLS int has_setup;
+CW_TLS int has_loop;
+CW_TLS int type_had_pointer;
+CW_TLS int type_had_const;
+CW_TLS int type_had_unsigned;
+CW_TLS int type_last_struct_id;
+
+CW_TLS FoldSlot fold_p, fold_a, fold_b;
 
 void cw_compile(void) {
+    CW_PHASE(parse);
     lex_init();
     preproc_init();
     next_token();
@@ -70,11 +73,12 @@ Buf c2wasm_compile_buffer(const char *src, int len, const char *filename) {
 
 #ifdef C2WASM_EMBEDDED
     syms = (Symbol *)cw_calloc(MAX_SYMS, sizeof(Symbol));
+    sym_hash = (uint16_t *)cw_calloc(SYM_HASH_SIZE, sizeof(uint16_t));
     func_bufs = (FuncCtx *)cw_calloc(MAX_FUNCS, sizeof(FuncCtx));
     ctrl_stk = (CtrlEntry *)cw_calloc(MAX_CTRL, sizeof(CtrlEntry));
     data_buf = (char *)cw_calloc(MAX_STRINGS, 1);
     struct_types = (StructType *)cw_calloc(MAX_STRUCT_TYPES, sizeof(StructType));
-    if (!syms || !func_bufs || !ctrl_stk || !data_buf || !struct_types) {
+    if (!syms || !sym_hash || !func_bufs || !ctrl_stk || !data_buf || !struct_types) {
         cw_error("c2wasm: out of memory\n");
         c2wasm_reset();
         return result;
@@ -100,6 +104,7 @@ Buf c2wasm_compile_buffer(const char *src, int len, const char *filename) {
     /* Globals: 0 = _heap_ptr, 1 = __line */
     nglobals = 2;
     nsym = 0;
+    memset(sym_hash, 0, SYM_HASH_SIZE * sizeof(uint16_t));
     cur_scope = 0;
     nfuncs = 0;
     cur_func = 0;
@@ -116,10 +121,13 @@ Buf c2wasm_compile_buffer(const char *src, int len, const char *filename) {
     n_struct_types = 0;
     fold_p.valid = fold_a.valid = fold_b.valid = 0;
     memset(imp_used, 0, sizeof(imp_used));
+    str_lits.len = 0;
+    shrink_stats.str_bytes = 0;
 
     /* Initialize function buffers */
     for (int i = 0; i < MAX_FUNCS; i++) {
         buf_init(&func_bufs[i].code);
+        buf_init(&func_bufs[i].lines);
         func_bufs[i].name = NULL;
         func_bufs[i].nparams = 0;
         func_bufs[i].nlocals = 0;
@@ -148,7 +156,9 @@ Buf c2wasm_compile_buffer(const char *src, int len, const char *filename) {
         return result;
     }
 
+    CW_PHASE(assemble);
     result = assemble_to_buf();
+    CW_PHASE(done);
     return result;
 }
 
@@ -160,6 +170,7 @@ void c2wasm_reset(void) {
     {
         for (int i = 0; i < MAX_FUNCS; i++) {
             buf_free(&func_bufs[i].code);
+            buf_free(&func_bufs[i].lines);
             cw_free(func_bufs[i].name);
             func_bufs[i].name = NULL;
         }
@@ -171,6 +182,7 @@ void c2wasm_reset(void) {
             cw_free(syms[i].macro_val);
     }
     cw_free(syms); syms = NULL;
+    cw_free(sym_hash); sym_hash = NULL;
     cw_free(func_bufs); func_bufs = NULL;
     cw_free(ctrl_stk); ctrl_stk = NULL;
     cw_free(data_buf); data_buf = NULL;
@@ -193,6 +205,7 @@ void c2wasm_reset(void) {
     type_last_struct_id = -1;
     n_struct_types = 0;
     memset(imp_used, 0, sizeof(imp_used));
+    buf_free(&str_lits);
     cw_free(source);
     source = NULL;
     src_len = 0;
@@ -202,7 +215,7 @@ void c2wasm_reset(void) {
 }
 
 const char *c2wasm_version_string(void) {
-    static char buf[64];
+    static CW_TLS char buf[64];
     snprintf(buf, sizeof(buf), "c2wasm %d.%02d.%04d (API %d, %d imports)",
              C2WASM_VERSION_MAJOR, C2WASM_VERSION_MINOR, BUILD_NUMBER,
              CONEZ_API_VERSION, IMP_COUNT);
@@ -215,17 +228,23 @@ const char *c2wasm_version_string(void) {
 
 #ifndef C2WASM_EMBEDDED
 
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+CW_TLS jmp_buf *cw_job_bail;
+
 static char *read_file(const char *path, int *out_len) {
     FILE *fp = fopen(path, "rb");
-    if (!fp) { fprintf(stderr, "c2wasm: cannot open '%s'\n", path); exit(1); }
+    if (!fp) { fprintf(stderr, "c2wasm: cannot open '%s'\n", path); return NULL; }
     fseek(fp, 0, SEEK_END);
     long sz = ftell(fp);
     fseek(fp, 0, SEEK_SET);
     char *buf = malloc(sz + 1);
-    if (!buf) { fprintf(stderr, "c2wasm: out of memory\n"); fclose(fp); exit(1); }
+    if (!buf) { fprintf(stderr, "c2wasm: out of memory\n"); fclose(fp); return NULL; }
     if ((long)fread(buf, 1, sz, fp) != sz) {
         fprintf(stderr, "c2wasm: read error on '%s'\n", path);
-        fclose(fp); free(buf); exit(1);
+        fclose(fp); free(buf); return NULL;
     }
     buf[sz] = 0;
     fclose(fp);
@@ -233,9 +252,133 @@ static char *read_file(const char *path, int *out_len) {
     return buf;
 }
 
+/* Default output: replace .c with .wasm */
+static void default_output(const char *infile, char *out, size_t n) {
+    int len = strlen(infile);
+    if (len > 2 && strcmp(infile + len - 2, ".c") == 0)
+        snprintf(out, n, "%.*s.wasm", len - 2, infile);
+    else
+        snprintf(out, n, "%s.wasm", infile);
+}
+
+/* ---- --jobs N: compile many files (a show directory) on N threads ----
+ *
+ * Every thread has its own compiler state (CW_TLS), so each worker just
+ * claims the next file and runs the library entry point on it. A fatal
+ * error longjmps back to the worker through cw_job_bail and fails only
+ * that file. Messages from different files may interleave line by line. */
+
+typedef struct {
+    char **files;
+    int nfiles;
+    int next;           /* next file to claim */
+    int failed;
+    pthread_mutex_t lock;
+} Batch;
+
+static int batch_compile(const char *infile) {
+    int len;
+    char *src = read_file(infile, &len);
+    if (!src) return 0;
+    char outfile[512];
+    default_output(infile, outfile, sizeof(outfile));
+
+    volatile int ok = 0;
+    if (setjmp(*cw_job_bail) == 0) {
+        Buf out = c2wasm_compile_buffer(src, len, infile);
+        if (out.len > 0) {
+            FILE *fp = fopen(outfile, "wb");
+            if (fp && (int)fwrite(out.data, 1, out.len, fp) == out.len) {
+                printf("Wrote %d bytes to %s\n", out.len, outfile);
+                ok = 1;
+            } else {
+                fprintf(stderr, "c2wasm: cannot write %s\n", outfile);
+            }
+            if (fp) fclose(fp);
+        }
+        buf_free(&out);
+    }
+    if (!ok) fprintf(stderr, "c2wasm: %s: compilation failed\n", infile);
+    c2wasm_reset();
+    free(src);
+    return ok;
+}
+
+static void *batch_worker(void *arg) {
+    Batch *b = (Batch *)arg;
+    jmp_buf bail;
+    cw_job_bail = &bail;
+    for (;;) {
+        pthread_mutex_lock(&b->lock);
+        int i = b->next++;
+        pthread_mutex_unlock(&b->lock);
+        if (i >= b->nfiles) break;
+        if (!batch_compile(b->files[i])) {
+            pthread_mutex_lock(&b->lock);
+            b->failed++;
+            pthread_mutex_unlock(&b->lock);
+        }
+    }
+    cw_job_bail = NULL;
+    return NULL;
+}
+
+static int cmp_str(const void *a, const void *b) {
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/* Add a file, or every .c file directly inside a directory */
+static void batch_add(Batch *b, const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        b->files = realloc(b->files, (b->nfiles + 1) * sizeof(char *));
+        b->files[b->nfiles++] = strdup(path);
+        return;
+    }
+    DIR *d = opendir(path);
+    if (!d) { fprintf(stderr, "c2wasm: cannot open directory '%s'\n", path); b->failed++; return; }
+    int first = b->nfiles;
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        int len = strlen(e->d_name);
+        if (len < 3 || strcmp(e->d_name + len - 2, ".c") != 0) continue;
+        char *f = malloc(strlen(path) + len + 2);
+        sprintf(f, "%s/%s", path, e->d_name);
+        b->files = realloc(b->files, (b->nfiles + 1) * sizeof(char *));
+        b->files[b->nfiles++] = f;
+    }
+    closedir(d);
+    qsort(b->files + first, b->nfiles - first, sizeof(char *), cmp_str);
+}
+
+static int batch_main(int jobs, char **inputs, int ninputs) {
+    Batch b = { NULL, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER };
+    for (int i = 0; i < ninputs; i++)
+        batch_add(&b, inputs[i]);
+    if (jobs > b.nfiles) jobs = b.nfiles;
+
+    pthread_t *tids = malloc((jobs > 0 ? jobs : 1) * sizeof(pthread_t));
+    int started = 0;
+    for (; started < jobs; started++)
+        if (pthread_create(&tids[started], NULL, batch_worker, &b) != 0) break;
+    if (started == 0 && b.nfiles > 0)
+        batch_worker(&b);       /* no threads to be had: compile them here */
+    for (int i = 0; i < started; i++)
+        pthread_join(tids[i], NULL);
+    free(tids);
+
+    printf("c2wasm: %d files, %d failed\n", b.nfiles, b.failed);
+    for (int i = 0; i < b.nfiles; i++) free(b.files[i]);
+    free(b.files);
+    return b.failed ? 1 : 0;
+}
+
 int main(int argc, char **argv) {
     const char *infile = NULL;
     const char *outfile = NULL;
+    int jobs = 0;
+    char **inputs = malloc(argc * sizeof(char *));
+    int ninputs = 0;
 
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--version") == 0 || strcmp(argv[i], "-v") == 0) {
@@ -243,10 +386,25 @@ int main(int argc, char **argv) {
                    C2WASM_VERSION_MAJOR, C2WASM_VERSION_MINOR, BUILD_NUMBER,
                    CONEZ_API_VERSION, IMP_COUNT);
             return 0;
+        } else if (strcmp(argv[i], "-O0") == 0 || strcmp(argv[i], "-O1") == 0
+                   || strcmp(argv[i], "-O2") == 0 || strcmp(argv[i], "-O") == 0) {
+            opt_level = argv[i][2] ? argv[i][2] - '0' : 1;
+        } else if (strcmp(argv[i], "--release") == 0) {
+            release_mode = 1;
+        } else if (strcmp(argv[i], "--shrink") == 0) {
+            shrink_mode = 1;
+        } else if (strcmp(argv[i], "--size-report") == 0) {
+            size_report = 1;
         } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
             outfile = argv[++i];
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+            if (jobs < 1) {
+                fprintf(stderr, "c2wasm: --jobs needs a thread count of at least 1\n");
+                return 1;
+            }
         } else if (argv[i][0] != '-') {
-            infile = argv[i];
+            infile = inputs[ninputs++] = argv[i];
         } else {
             fprintf(stderr, "c2wasm: unknown option '%s'\n", argv[i]);
             return 1;
@@ -254,23 +412,32 @@ int main(int argc, char **argv) {
     }
 
     if (!infile) {
-        fprintf(stderr, "Usage: c2wasm <input.c> [-o output.wasm]\n");
+        fprintf(stderr, "Usage: c2wasm <input.c> [-O0|-O1|-O2] [--release] [--shrink] [--size-report]\n"
+                        "              [-o output.wasm]\n"
+                        "       c2wasm --jobs N <file.c|dir>... [-O0|-O1|-O2] [--release] [--shrink]\n");
         return 1;
     }
 
-    /* Default output: replace .c with .wasm */
+    if (jobs) {
+        if (outfile) {
+            fprintf(stderr, "c2wasm: -o can't be used with --jobs\n");
+            return 1;
+        }
+        int ret = batch_main(jobs, inputs, ninputs);
+        free(inputs);
+        return ret;
+    }
+    free(inputs);
+
     char default_out[256];
     if (!outfile) {
-        int len = strlen(infile);
-        if (len > 2 && strcmp(infile + len - 2, ".c") == 0)
-            snprintf(default_out, sizeof(default_out), "%.*s.wasm", len - 2, infile);
-        else
-            snprintf(default_out, sizeof(default_out), "%s.wasm", infile);
+        default_output(infile, default_out, sizeof(default_out));
         outfile = default_out;
     }
 
-    src_file = strdup(infile);
     source = read_file(infile, &src_len);
+    if (!source) return 1;
+    src_file = strdup(infile);
     src_pos = 0;
     line_num = 1;
 
@@ -278,8 +445,10 @@ int main(int argc, char **argv) {
     nglobals = 2;
 
     /* Initialize function buffers */
-    for (int i = 0; i < MAX_FUNCS; i++)
+    for (int i = 0; i < MAX_FUNCS; i++) {
         buf_init(&func_bufs[i].code);
+        buf_init(&func_bufs[i].lines);
+    }
 
     cw_compile();
 
@@ -313,6 +482,7 @@ cleanup:
     free(src_file);
     for (int i = 0; i < MAX_FUNCS; i++) {
         buf_free(&func_bufs[i].code);
+        buf_free(&func_bufs[i].lines);
         free(func_bufs[i].name);
     }
     return ret;
@@ -0,0 +1,2599 @@
+/*
+ * opt.c — optional middle end (-O1 / -O2)
+ *
+ * Codegen writes wasm bytes straight into each function's buffer. With an
+ * optimization level set, assemble_to_buf() first hands every function to
+ * opt_function(): the code is decoded into an instruction array (the IR),
+ * rewritten by the passes below until nothing changes, and re-encoded with
+ * call_fixups (and with --release the log of __line stores) rebuilt to match.
+ *
+ *   -O1  constant propagation through locals (across blocks and loops),
+ *        copy propagation, constant and branch folding, a few algebraic
+ *        identities, unreachable-code removal, dropping unused pure values
+ *        and loads that can't trap, reading never-stored globals as
+ *        constants, unwrapping blocks nothing branches to, and packing
+ *        locals with disjoint lifetimes into shared slots
+ *   -O2  -O1 plus common-subexpression elimination within a basic block,
+ *        dead local stores, global stores (mostly __line) overwritten
+ *        before anything could observe them, loop-invariant code motion,
+ *        strength reduction of loop counters, and, first of all, inlining
+ *        small static leaf functions into their callers (opt_inline)
+ *
+ * Basic blocks split at every control instruction, so each pass only ever
+ * reasons about straight-line code plus, for the dataflow ones, the CFG the
+ * structured control instructions describe. A function the decoder doesn't
+ * fully understand is left exactly as codegen wrote it. Nothing here moves
+ * a trap or changes what __line says when one happens.
+ */
+#include "c2wasm.h"
+#include <math.h>
+
+int opt_level;
+CW_TLS OptStats opt_stats;
+
+/* Globals that no function stores to keep their initial value, so a
+ * global.get of one is a constant (opt_scan_globals): the global's wasm
+ * type and value bits, type 0 for any other global */
+static CW_TLS uint8_t gfixed[MAX_SYMS + 2];
+static CW_TLS int64_t gfixed_bits[MAX_SYMS + 2];
+
+#define OPX_DEAD    0xFFFF
+#define OPX_COPY    (0xFC00 | MISC_MEMORY_COPY)
+#define OPX_FILL    (0xFC00 | MISC_MEMORY_FILL)
+#define OPT_MAX_ITERS 16
+
+typedef struct {
+    uint16_t op;        /* opcode, 0xFC00|sub for prefixed ones, OPX_DEAD */
+    uint8_t  bt;        /* block type, or a load/store's alignment */
+    int      tee;       /* >= 0: a local.tee of this local follows (CSE) */
+    int64_t  imm;       /* const bits, index, depth or memarg offset */
+} OIns;
+
+typedef struct {
+    FuncCtx *f;
+    OIns *ins, *tmp_ins;
+    int n, cap;
+    int nloc, nlocals;          /* params + locals; locals only */
+    uint8_t ltype[8 + CW_MAX_LOCALS];
+    uint8_t *gtype;
+    int ngtype;
+    int bad;                    /* decode/alloc failure: keep the original */
+    /* structure, from scan_structure() */
+    int *match;                 /* opener <-> its end; else -> its if */
+    int *else_of;               /* if -> its else, or -1 */
+    int *target;                /* br/br_if -> opener of the label, -1 = function */
+    int *bb_of, *bb_start;      /* bb_start[nbb] == n */
+    int nbb, scap;
+    struct SVal *sv;            /* stack simulation scratch */
+    OIns *q_ins;                /* instructions queued for insertion ... */
+    int *q_at;                  /* ... before these positions by compact() */
+    int nq, qcap;
+} Opt;
+
+/* ================================================================
+ *  Opcode information
+ * ================================================================ */
+
+enum { OK_NONE, OK_CONST, OK_NUM, OK_LOAD, OK_STORE };
+
+typedef struct {
+    uint8_t kind, npop, npush;
+    uint8_t rt;         /* result type, 0 = none */
+    uint8_t trap;       /* may trap */
+} OpInfo;
+
+/* Loads, stores, consts and the numeric ops; 0 for anything else */
+static int num_info(int op, OpInfo *oi) {
+    static const uint8_t load_t[14] = {
+        WASM_I32, WASM_I64, WASM_F32, WASM_F64,
+        WASM_I32, WASM_I32, WASM_I32, WASM_I32,
+        WASM_I64, WASM_I64, WASM_I64, WASM_I64, WASM_I64, WASM_I64 };
+    static const uint8_t const_t[4] = { WASM_I32, WASM_I64, WASM_F32, WASM_F64 };
+    memset(oi, 0, sizeof(*oi));
+    oi->kind = OK_NUM; oi->npush = 1; oi->npop = 1;
+    if (op >= 0x28 && op <= 0x35) {
+        oi->kind = OK_LOAD; oi->rt = load_t[op - 0x28]; oi->trap = 1;
+    } else if (op >= 0x36 && op <= 0x3E) {
+        oi->kind = OK_STORE; oi->npop = 2; oi->npush = 0; oi->trap = 1;
+    } else if (op >= OP_I32_CONST && op <= OP_F64_CONST) {
+        oi->kind = OK_CONST; oi->npop = 0; oi->rt = const_t[op - OP_I32_CONST];
+    } else if (op == OP_I32_EQZ || op == OP_I64_EQZ) {
+        oi->rt = WASM_I32;
+    } else if (op >= 0x46 && op <= 0x66) {
+        oi->npop = 2; oi->rt = WASM_I32;
+    } else if (op >= 0x67 && op <= 0x69) {
+        oi->rt = WASM_I32;
+    } else if (op >= 0x6A && op <= 0x78) {
+        oi->npop = 2; oi->rt = WASM_I32; oi->trap = op >= OP_I32_DIV_S && op <= OP_I32_REM_U;
+    } else if (op >= 0x79 && op <= 0x7B) {
+        oi->rt = WASM_I64;
+    } else if (op >= 0x7C && op <= 0x8A) {
+        oi->npop = 2; oi->rt = WASM_I64; oi->trap = op >= OP_I64_DIV_S && op <= OP_I64_REM_U;
+    } else if (op >= 0x8B && op <= 0x91) {
+        oi->rt = WASM_F32;
+    } else if (op >= 0x92 && op <= 0x98) {
+        oi->npop = 2; oi->rt = WASM_F32;
+    } else if (op >= 0x99 && op <= 0x9F) {
+        oi->rt = WASM_F64;
+    } else if (op >= 0xA0 && op <= 0xA6) {
+        oi->npop = 2; oi->rt = WASM_F64;
+    } else if (op >= 0xA7 && op <= 0xBF) {
+        if (op <= 0xAB || op == 0xBC)      oi->rt = WASM_I32;
+        else if (op <= 0xB1 || op == 0xBD) oi->rt = WASM_I64;
+        else if (op <= 0xB6 || op == 0xBE) oi->rt = WASM_F32;
+        else                               oi->rt = WASM_F64;
+        oi->trap = (op >= 0xA8 && op <= 0xAB) || (op >= 0xAE && op <= 0xB1);
+    } else if (op >= 0xC0 && op <= 0xC4) {
+        oi->rt = op <= 0xC1 ? WASM_I32 : WASM_I64;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+static int is_ctrl(int op) {
+    switch (op) {
+    case OP_UNREACHABLE: case OP_BLOCK: case OP_LOOP: case OP_IF: case OP_ELSE:
+    case OP_END: case OP_BR: case OP_BR_IF: case OP_RETURN:
+        return 1;
+    }
+    return 0;
+}
+
+static int is_opener(int op) { return op == OP_BLOCK || op == OP_LOOP || op == OP_IF; }
+
+static void call_sig(Opt *o, int64_t idx, int *np, uint8_t *rt) {
+    if (idx >= 0 && idx < IMP_COUNT) {
+        *np = imp_defs[idx].np;
+        *rt = imp_defs[idx].nr ? imp_defs[idx].r[0] : 0;
+    } else if (idx >= IMP_COUNT && idx < IMP_COUNT + nfuncs) {
+        FuncCtx *g = &func_bufs[idx - IMP_COUNT];
+        *np = g->nparams;
+        *rt = g->return_type == CT_VOID ? 0 : ctype_to_wasm(g->return_type);
+    } else {
+        o->bad = 1; *np = 0; *rt = 0;
+    }
+}
+
+/* Stack effect and result type of any instruction */
+static void effect(Opt *o, const OIns *in, int *npop, int *npush, uint8_t *rt) {
+    OpInfo oi;
+    *npop = *npush = 0; *rt = 0;
+    switch (in->op) {
+    case OP_IF: case OP_BR_IF: case OP_DROP:
+    case OP_LOCAL_SET: case OP_GLOBAL_SET:
+        *npop = 1; break;
+    case OP_SELECT:
+        *npop = 3; *npush = 1; break;
+    case OP_LOCAL_GET:
+        *npush = 1; *rt = o->ltype[in->imm]; break;
+    case OP_LOCAL_TEE:
+        *npop = 1; *npush = 1; *rt = o->ltype[in->imm]; break;
+    case OP_GLOBAL_GET:
+        *npush = 1; *rt = o->gtype[in->imm]; break;
+    case OP_CALL: {
+        int np; call_sig(o, in->imm, &np, rt);
+        *npop = np; *npush = *rt != 0;
+        break;
+    }
+    case OPX_COPY: case OPX_FILL:
+        *npop = 3; break;
+    default:
+        if (num_info(in->op, &oi)) { *npop = oi.npop; *npush = oi.npush; *rt = oi.rt; }
+        break;
+    }
+}
+
+/* Trapping or externally visible: ends a run of unobserved global stores */
+static int observes(int op) {
+    OpInfo oi;
+    if (op == OP_CALL || op == OP_UNREACHABLE || op == OPX_COPY || op == OPX_FILL) return 1;
+    return num_info(op, &oi) && oi.trap;
+}
+
+/* ================================================================
+ *  Constant evaluation
+ *
+ *  Values are raw bits in an int64: i32 sign-extended, f32 as its 32-bit
+ *  pattern. Float results that are NaN or subnormal aren't folded (the
+ *  target FPU needn't agree on either), nor are min/max, nor anything that
+ *  would trap.
+ * ================================================================ */
+
+static float   bits_f32(int64_t v) { uint32_t u = (uint32_t)v; float f; memcpy(&f, &u, 4); return f; }
+static double  bits_f64(int64_t v) { double d; memcpy(&d, &v, 8); return d; }
+static int64_t f32_bits(float f)   { uint32_t u; memcpy(&u, &f, 4); return u; }
+static int64_t f64_bits(double d)  { int64_t v; memcpy(&v, &d, 8); return v; }
+static int64_t i32_bits(uint32_t v) { return (int32_t)v; }
+
+static int f32_ok(float f)  { return !isnan(f) && fpclassify(f) != FP_SUBNORMAL; }
+static int f64_ok(double d) { return !isnan(d) && fpclassify(d) != FP_SUBNORMAL; }
+
+#define RET32(x)  do { *r = i32_bits((uint32_t)(x)); return 1; } while (0)
+#define RET64(x)  do { *r = (int64_t)(uint64_t)(x); return 1; } while (0)
+#define RETF(x)   do { float  _v = (x); if (!f32_ok(_v)) return 0; *r = f32_bits(_v); return 1; } while (0)
+#define RETD(x)   do { double _v = (x); if (!f64_ok(_v)) return 0; *r = f64_bits(_v); return 1; } while (0)
+
+static int eval_unop(int op, int64_t a, int64_t *r) {
+    uint32_t ua = (uint32_t)a;
+    uint64_t la = (uint64_t)a;
+    float fa = bits_f32(a);
+    double da = bits_f64(a);
+    int fok = f32_ok(fa), dok = f64_ok(da);
+
+    switch (op) {
+    case OP_I32_EQZ: RET32(ua == 0);
+    case OP_I64_EQZ: RET32(la == 0);
+    case 0x67: RET32(ua ? __builtin_clz(ua) : 32);
+    case 0x68: RET32(ua ? __builtin_ctz(ua) : 32);
+    case 0x69: RET32(__builtin_popcount(ua));
+    case 0x79: RET64(la ? __builtin_clzll(la) : 64);
+    case 0x7A: RET64(la ? __builtin_ctzll(la) : 64);
+    case 0x7B: RET64(__builtin_popcountll(la));
+    case OP_F32_ABS: *r = ua & 0x7FFFFFFFu; return 1;
+    case OP_F32_NEG: *r = ua ^ 0x80000000u; return 1;
+    case OP_F64_ABS: *r = (int64_t)(la & 0x7FFFFFFFFFFFFFFFull); return 1;
+    case OP_F64_NEG: *r = (int64_t)(la ^ 0x8000000000000000ull); return 1;
+    case 0xBC: RET32(ua);
+    case 0xBD: RET64(la);
+    case 0xBE: *r = ua; return 1;
+    case 0xBF: *r = a; return 1;
+    case OP_I32_WRAP_I64:     RET32((uint32_t)la);
+    case OP_I64_EXTEND_I32_S: RET64((int64_t)(int32_t)ua);
+    case OP_I64_EXTEND_I32_U: RET64((uint64_t)ua);
+    case 0xC0: RET32((int32_t)(int8_t)ua);
+    case 0xC1: RET32((int32_t)(int16_t)ua);
+    case 0xC2: RET64((int64_t)(int8_t)la);
+    case 0xC3: RET64((int64_t)(int16_t)la);
+    case 0xC4: RET64((int64_t)(int32_t)la);
+    }
+    if (op >= 0x8D && op <= 0x91 && !fok) return 0;
+    if (op >= 0x9B && op <= 0x9F && !dok) return 0;
+    switch (op) {
+    case OP_F32_CEIL:  RETF(ceilf(fa));
+    case OP_F32_FLOOR: RETF(floorf(fa));
+    case OP_F32_TRUNC: RETF(truncf(fa));
+    case 0x90:         RETF(rintf(fa));
+    case OP_F32_SQRT:  if (fa < 0) return 0; RETF(sqrtf(fa));
+    case OP_F64_CEIL:  RETD(ceil(da));
+    case OP_F64_FLOOR: RETD(floor(da));
+    case OP_F64_TRUNC: RETD(trunc(da));
+    case 0x9E:         RETD(rint(da));
+    case OP_F64_SQRT:  if (da < 0) return 0; RETD(sqrt(da));
+    }
+    /* Float -> int: only in range (out of range traps) */
+    if (op >= OP_I32_TRUNC_F32_S && op <= OP_I64_TRUNC_F64_U && op != OP_I64_EXTEND_I32_S
+        && op != OP_I64_EXTEND_I32_U) {
+        int from64 = op == OP_I32_TRUNC_F64_S || op == OP_I32_TRUNC_F64_U
+                  || op == OP_I64_TRUNC_F64_S || op == OP_I64_TRUNC_F64_U;
+        if (from64 ? !dok : !fok) return 0;
+        double x = from64 ? da : fa;
+        switch (op) {
+        case OP_I32_TRUNC_F32_S: case OP_I32_TRUNC_F64_S:
+            if (!(x > -2147483649.0 && x < 2147483648.0)) return 0;
+            RET32((int32_t)x);
+        case OP_I32_TRUNC_F32_U: case OP_I32_TRUNC_F64_U:
+            if (!(x > -1.0 && x < 4294967296.0)) return 0;
+            RET32((uint32_t)x);
+        case OP_I64_TRUNC_F32_S: case OP_I64_TRUNC_F64_S:
+            if (!(x >= -9223372036854775808.0 && x < 9223372036854775808.0)) return 0;
+            RET64((int64_t)x);
+        case OP_I64_TRUNC_F32_U: case OP_I64_TRUNC_F64_U:
+            if (!(x > -1.0 && x < 18446744073709551616.0)) return 0;
+            RET64((uint64_t)x);
+        }
+    }
+    switch (op) {
+    case OP_F32_CONVERT_I32_S: RETF((float)(int32_t)ua);
+    case OP_F32_CONVERT_I32_U: RETF((float)ua);
+    case OP_F32_CONVERT_I64_S: RETF((float)(int64_t)la);
+    case OP_F32_CONVERT_I64_U: RETF((float)la);
+    case OP_F32_DEMOTE_F64:    if (!dok) return 0; RETF((float)da);
+    case OP_F64_CONVERT_I32_S: RETD((double)(int32_t)ua);
+    case OP_F64_CONVERT_I32_U: RETD((double)ua);
+    case OP_F64_CONVERT_I64_S: RETD((double)(int64_t)la);
+    case OP_F64_CONVERT_I64_U: RETD((double)la);
+    case OP_F64_PROMOTE_F32:   if (!fok) return 0; RETD((double)fa);
+    }
+    return 0;
+}
+
+static int eval_binop(int op, int64_t a, int64_t b, int64_t *r) {
+    if ((op >= 0x46 && op <= 0x4F) || (op >= 0x6A && op <= 0x78)) {
+        uint32_t x = (uint32_t)a, y = (uint32_t)b;
+        int32_t sx = (int32_t)x, sy = (int32_t)y;
+        unsigned k = y & 31;
+        switch (op) {
+        case OP_I32_EQ:   RET32(x == y);
+        case OP_I32_NE:   RET32(x != y);
+        case OP_I32_LT_S: RET32(sx < sy);
+        case OP_I32_LT_U: RET32(x < y);
+        case OP_I32_GT_S: RET32(sx > sy);
+        case OP_I32_GT_U: RET32(x > y);
+        case OP_I32_LE_S: RET32(sx <= sy);
+        case OP_I32_LE_U: RET32(x <= y);
+        case OP_I32_GE_S: RET32(sx >= sy);
+        case OP_I32_GE_U: RET32(x >= y);
+        case OP_I32_ADD:  RET32(x + y);
+        case OP_I32_SUB:  RET32(x - y);
+        case OP_I32_MUL:  RET32(x * y);
+        case OP_I32_DIV_S: if (!y || (sx == INT32_MIN && sy == -1)) return 0; RET32(sx / sy);
+        case OP_I32_DIV_U: if (!y) return 0; RET32(x / y);
+        case OP_I32_REM_S: if (!y) return 0; if (sy == -1) RET32(0); RET32(sx % sy);
+        case OP_I32_REM_U: if (!y) return 0; RET32(x % y);
+        case OP_I32_AND:  RET32(x & y);
+        case OP_I32_OR:   RET32(x | y);
+        case OP_I32_XOR:  RET32(x ^ y);
+        case OP_I32_SHL:  RET32(x << k);
+        case OP_I32_SHR_S: RET32(sx >> k);
+        case OP_I32_SHR_U: RET32(x >> k);
+        case 0x77: RET32(k ? (x << k) | (x >> (32 - k)) : x);
+        case 0x78: RET32(k ? (x >> k) | (x << (32 - k)) : x);
+        }
+        return 0;
+    }
+    if ((op >= 0x51 && op <= 0x5A) || (op >= 0x7C && op <= 0x8A)) {
+        uint64_t x = (uint64_t)a, y = (uint64_t)b;
+        int64_t sx = a, sy = b;
+        unsigned k = (unsigned)(y & 63);
+        switch (op) {
+        case OP_I64_EQ:   RET32(x == y);
+        case OP_I64_NE:   RET32(x != y);
+        case OP_I64_LT_S: RET32(sx < sy);
+        case OP_I64_LT_U: RET32(x < y);
+        case OP_I64_GT_S: RET32(sx > sy);
+        case OP_I64_GT_U: RET32(x > y);
+        case OP_I64_LE_S: RET32(sx <= sy);
+        case OP_I64_LE_U: RET32(x <= y);
+        case OP_I64_GE_S: RET32(sx >= sy);
+        case OP_I64_GE_U: RET32(x >= y);
+        case OP_I64_ADD:  RET64(x + y);
+        case OP_I64_SUB:  RET64(x - y);
+        case OP_I64_MUL:  RET64(x * y);
+        case OP_I64_DIV_S: if (!y || (sx == INT64_MIN && sy == -1)) return 0; RET64(sx / sy);
+        case OP_I64_DIV_U: if (!y) return 0; RET64(x / y);
+        case OP_I64_REM_S: if (!y) return 0; if (sy == -1) RET64(0); RET64(sx % sy);
+        case OP_I64_REM_U: if (!y) return 0; RET64(x % y);
+        case OP_I64_AND:  RET64(x & y);
+        case OP_I64_OR:   RET64(x | y);
+        case OP_I64_XOR:  RET64(x ^ y);
+        case OP_I64_SHL:  RET64(x << k);
+        case OP_I64_SHR_S: RET64(sx >> k);
+        case OP_I64_SHR_U: RET64(x >> k);
+        case 0x89: RET64(k ? (x << k) | (x >> (64 - k)) : x);
+        case 0x8A: RET64(k ? (x >> k) | (x << (64 - k)) : x);
+        }
+        return 0;
+    }
+    if ((op >= 0x5B && op <= 0x60) || (op >= 0x92 && op <= 0x98)) {
+        float x = bits_f32(a), y = bits_f32(b);
+        if (op == 0x98) { *r = ((uint32_t)a & 0x7FFFFFFFu) | ((uint32_t)b & 0x80000000u); return 1; }
+        if (!f32_ok(x) || !f32_ok(y)) return 0;
+        switch (op) {
+        case OP_F32_EQ: RET32(x == y);
+        case OP_F32_NE: RET32(x != y);
+        case OP_F32_LT: RET32(x < y);
+        case OP_F32_GT: RET32(x > y);
+        case OP_F32_LE: RET32(x <= y);
+        case OP_F32_GE: RET32(x >= y);
+        case OP_F32_ADD: RETF(x + y);
+        case OP_F32_SUB: RETF(x - y);
+        case OP_F32_MUL: RETF(x * y);
+        case OP_F32_DIV: RETF(x / y);
+        }
+        return 0;
+    }
+    if ((op >= 0x61 && op <= 0x66) || (op >= 0xA0 && op <= 0xA6)) {
+        double x = bits_f64(a), y = bits_f64(b);
+        if (op == 0xA6) {
+            *r = (int64_t)(((uint64_t)a & 0x7FFFFFFFFFFFFFFFull) | ((uint64_t)b & 0x8000000000000000ull));
+            return 1;
+        }
+        if (!f64_ok(x) || !f64_ok(y)) return 0;
+        switch (op) {
+        case OP_F64_EQ: RET32(x == y);
+        case OP_F64_NE: RET32(x != y);
+        case OP_F64_LT: RET32(x < y);
+        case OP_F64_GT: RET32(x > y);
+        case OP_F64_LE: RET32(x <= y);
+        case OP_F64_GE: RET32(x >= y);
+        case OP_F64_ADD: RETD(x + y);
+        case OP_F64_SUB: RETD(x - y);
+        case OP_F64_MUL: RETD(x * y);
+        case OP_F64_DIV: RETD(x / y);
+        }
+        return 0;
+    }
+    return 0;
+}
+
+/* x op c == x: 0 for add/sub/or/xor/shifts/rotates, 1 for mul/div, -1 for and */
+static int rhs_identity(int op, int64_t c) {
+    int is64 = op >= 0x7C && op <= 0x8A;
+    if (!is64 && !(op >= 0x6A && op <= 0x78)) return 0;
+    int base = is64 ? op - (0x7C - 0x6A) : op;
+    int64_t v = is64 ? c : (int32_t)c;
+    switch (base) {
+    case OP_I32_ADD: case OP_I32_SUB: case OP_I32_OR: case OP_I32_XOR:
+        return v == 0;
+    case OP_I32_SHL: case OP_I32_SHR_S: case OP_I32_SHR_U: case 0x77: case 0x78:
+        return (v & (is64 ? 63 : 31)) == 0;
+    case OP_I32_MUL: case OP_I32_DIV_S: case OP_I32_DIV_U:
+        return v == 1;
+    case OP_I32_AND:
+        return v == -1;
+    }
+    return 0;
+}
+
+/* c op x == x for the commutative ones */
+static int lhs_identity(int op, int64_t c) {
+    int is64 = op >= 0x7C && op <= 0x8A;
+    int base = is64 ? op - (0x7C - 0x6A) : op;
+    int64_t v = is64 ? c : (int32_t)c;
+    switch (base) {
+    case OP_I32_ADD: case OP_I32_OR: case OP_I32_XOR: return v == 0;
+    case OP_I32_MUL: return v == 1;
+    case OP_I32_AND: return v == -1;
+    }
+    return 0;
+}
+
+/* eqz(a cmp b) == a !cmp b, for the integer compares */
+static int invert_cmp(int op) {
+    static const uint8_t inv[10] = {
+        OP_I32_NE, OP_I32_EQ, OP_I32_GE_S, OP_I32_GE_U, OP_I32_LE_S,
+        OP_I32_LE_U, OP_I32_GT_S, OP_I32_GT_U, OP_I32_LT_S, OP_I32_LT_U };
+    if (op >= OP_I32_EQ && op <= OP_I32_GE_U) return inv[op - OP_I32_EQ];
+    if (op >= OP_I64_EQ && op <= OP_I64_GE_U) return inv[op - OP_I64_EQ] + (OP_I64_EQ - OP_I32_EQ);
+    return 0;
+}
+
+static void set_const(OIns *in, uint8_t t, int64_t bits) {
+    in->op = t == WASM_I64 ? OP_I64_CONST : t == WASM_F32 ? OP_F32_CONST
+           : t == WASM_F64 ? OP_F64_CONST : OP_I32_CONST;
+    in->imm = bits;
+    in->bt = 0;
+}
+
+/* ================================================================
+ *  Decode / encode / bookkeeping
+ * ================================================================ */
+
+static int rd_uleb(const uint8_t **p, const uint8_t *end, uint64_t *v) {
+    uint64_t r = 0; int shift = 0;
+    for (;;) {
+        if (*p >= end || shift > 63) return 0;
+        uint8_t b = *(*p)++;
+        r |= (uint64_t)(b & 0x7F) << shift;
+        shift += 7;
+        if (!(b & 0x80)) break;
+    }
+    *v = r;
+    return 1;
+}
+
+static int rd_sleb(const uint8_t **p, const uint8_t *end, int64_t *v) {
+    int64_t r = 0; int shift = 0; uint8_t b;
+    do {
+        if (*p >= end || shift > 63) return 0;
+        b = *(*p)++;
+        r |= (int64_t)(b & 0x7F) << shift;
+        shift += 7;
+    } while (b & 0x80);
+    if (shift < 64 && (b & 0x40)) r |= -((int64_t)1 << shift);
+    *v = r;
+    return 1;
+}
+
+static OIns *add_ins(Opt *o) {
+    if (o->n == o->cap) {
+        int nc = o->cap ? o->cap * 2 : 256;
+        OIns *ni = (OIns *)cw_realloc(o->ins, nc * sizeof(OIns));
+        if (!ni) { o->bad = 1; return NULL; }
+        o->ins = ni; o->cap = nc;
+    }
+    OIns *in = &o->ins[o->n++];
+    memset(in, 0, sizeof(*in));
+    in->tee = -1;
+    return in;
+}
+
+static int decode(Opt *o) {
+    const uint8_t *p = o->f->code.data, *end = p + o->f->code.len;
+    OpInfo oi;
+    while (p < end) {
+        int op = *p++;
+        uint64_t u; int64_t s;
+        if (op == OP_NOP) continue;
+        OIns *in = add_ins(o);
+        if (!in) return 0;
+        in->op = op;
+        switch (op) {
+        case OP_BLOCK: case OP_LOOP: case OP_IF:
+            if (p >= end) return 0;
+            in->bt = *p++;
+            if (in->bt != WASM_VOID && in->bt != WASM_I32 && in->bt != WASM_I64
+                && in->bt != WASM_F32 && in->bt != WASM_F64) return 0;
+            break;
+        case OP_BR: case OP_BR_IF: case OP_CALL:
+            if (!rd_uleb(&p, end, &u)) return 0;
+            in->imm = (int64_t)u;
+            break;
+        case OP_LOCAL_GET: case OP_LOCAL_SET: case OP_LOCAL_TEE:
+            if (!rd_uleb(&p, end, &u) || u >= (uint64_t)o->nloc) return 0;
+            in->imm = (int64_t)u;
+            break;
+        case OP_GLOBAL_GET: case OP_GLOBAL_SET:
+            if (!rd_uleb(&p, end, &u) || u >= (uint64_t)o->ngtype) return 0;
+            in->imm = (int64_t)u;
+            break;
+        case OP_I32_CONST: case OP_I64_CONST:
+            if (!rd_sleb(&p, end, &s)) return 0;
+            in->imm = op == OP_I32_CONST ? (int32_t)s : s;
+            break;
+        case OP_F32_CONST: {
+            if (end - p < 4) return 0;
+            uint32_t b; memcpy(&b, p, 4); p += 4;
+            in->imm = b;
+            break;
+        }
+        case OP_F64_CONST:
+            if (end - p < 8) return 0;
+            memcpy(&in->imm, p, 8); p += 8;
+            break;
+        case OP_MISC_PREFIX:
+            if (!rd_uleb(&p, end, &u)) return 0;
+            if (u == MISC_MEMORY_COPY) { if (end - p < 2 || p[0] || p[1]) return 0; p += 2; }
+            else if (u == MISC_MEMORY_FILL) { if (end - p < 1 || p[0]) return 0; p += 1; }
+            else return 0;
+            in->op = 0xFC00 | (int)u;
+            break;
+        case OP_UNREACHABLE: case OP_ELSE: case OP_END: case OP_RETURN:
+        case OP_DROP: case OP_SELECT:
+            break;
+        default:
+            if (!num_info(op, &oi) || oi.kind == OK_CONST) return 0;
+            if (oi.kind == OK_LOAD || oi.kind == OK_STORE) {
+                if (!rd_uleb(&p, end, &u) || u > 3) return 0;
+                in->bt = (uint8_t)u;
+                if (!rd_uleb(&p, end, &u)) return 0;
+                in->imm = (int64_t)u;
+            }
+            break;
+        }
+    }
+    return o->n > 0 && o->ins[o->n - 1].op == OP_END;
+}
+
+static void encode(Opt *o) {
+    FuncCtx *f = o->f;
+    Buf nc; buf_init(&nc);
+    f->ncall_fixups = 0;
+    f->lines.len = 0;
+    int prev_at = 0;
+    for (int i = 0; i < o->n; i++) {
+        OIns *in = &o->ins[i];
+        /* --release: relog the __line stores that are still there */
+        if (release_mode && in->op == OP_GLOBAL_SET && in->imm == GLOBAL_LINE
+            && i > 0 && in[-1].op == OP_I32_CONST) {
+            int m[2] = { prev_at, (int)in[-1].imm };
+            buf_bytes(&f->lines, m, sizeof(m));
+        }
+        prev_at = nc.len;
+        if (in->op >= 0xFC00) {
+            buf_byte(&nc, OP_MISC_PREFIX);
+            buf_uleb(&nc, in->op & 0xFF);
+            buf_byte(&nc, 0);
+            if (in->op == OPX_COPY) buf_byte(&nc, 0);
+            continue;
+        }
+        buf_byte(&nc, (uint8_t)in->op);
+        switch (in->op) {
+        case OP_BLOCK: case OP_LOOP: case OP_IF:
+            buf_byte(&nc, in->bt); break;
+        case OP_CALL:
+            f->call_fixups[f->ncall_fixups++] = nc.len;
+            buf_uleb(&nc, (uint32_t)in->imm); break;
+        case OP_BR: case OP_BR_IF:
+        case OP_LOCAL_GET: case OP_LOCAL_SET: case OP_LOCAL_TEE:
+        case OP_GLOBAL_GET: case OP_GLOBAL_SET:
+            buf_uleb(&nc, (uint32_t)in->imm); break;
+        case OP_I32_CONST: buf_sleb(&nc, (int32_t)in->imm); break;
+        case OP_I64_CONST: buf_sleb64(&nc, in->imm); break;
+        case OP_F32_CONST: { uint32_t b = (uint32_t)in->imm; buf_bytes(&nc, &b, 4); break; }
+        case OP_F64_CONST: buf_bytes(&nc, &in->imm, 8); break;
+        default: {
+            OpInfo oi;
+            if (num_info(in->op, &oi) && (oi.kind == OK_LOAD || oi.kind == OK_STORE)) {
+                buf_uleb(&nc, in->bt);
+                buf_uleb(&nc, (uint32_t)in->imm);
+            }
+            break;
+        }
+        }
+    }
+    buf_free(&f->code);
+    f->code = nc;
+    f->nlocals = o->nlocals;
+    memcpy(f->local_types, o->ltype + f->nparams, o->nlocals);
+}
+
+static void kill_range(Opt *o, int a, int b) {
+    for (int i = a; i <= b; i++) o->ins[i].op = OPX_DEAD;
+}
+
+/* All instructions strictly between a and b are dead */
+static int gap_dead(Opt *o, int a, int b) {
+    for (int i = a + 1; i < b; i++)
+        if (o->ins[i].op != OPX_DEAD) return 0;
+    return 1;
+}
+
+static int next_live(Opt *o, int i) {
+    for (i++; i < o->n && o->ins[i].op == OPX_DEAD; i++) ;
+    return i;
+}
+
+static int prev_live(Opt *o, int i) {
+    for (i--; i >= 0 && o->ins[i].op == OPX_DEAD; i--) ;
+    return i;
+}
+
+/* Queue a copy of `in` for insertion before position at (compact() places
+ * it; several at one position keep their order) */
+static void queue_ins(Opt *o, int at, OIns in) {
+    if (o->nq == o->qcap) {
+        int c = o->qcap ? o->qcap * 2 : 32;
+        OIns *ni = (OIns *)cw_realloc(o->q_ins, c * sizeof(OIns));
+        if (ni) o->q_ins = ni;
+        int *na = (int *)cw_realloc(o->q_at, c * sizeof(int));
+        if (na) o->q_at = na;
+        if (!ni || !na) { o->bad = 1; return; }
+        o->qcap = c;
+    }
+    in.tee = -1;
+    o->q_ins[o->nq] = in;
+    o->q_at[o->nq++] = at;
+}
+
+/* Drop dead instructions, materialize CSE tees, insert queued instructions */
+static void compact(Opt *o) {
+    int extra = o->nq;
+    for (int i = 0; i < o->n; i++)
+        if (o->ins[i].op != OPX_DEAD && o->ins[i].tee >= 0) extra++;
+    OIns *out = o->ins;
+    if (extra) {
+        out = (OIns *)cw_malloc((o->n + extra) * sizeof(OIns));
+        if (!out) { o->bad = 1; return; }
+    }
+    /* Stable sort of the queue by position */
+    for (int a = 1; a < o->nq; a++) {
+        OIns qi = o->q_ins[a];
+        int qa = o->q_at[a], j = a;
+        for (; j > 0 && o->q_at[j - 1] > qa; j--) {
+            o->q_ins[j] = o->q_ins[j - 1];
+            o->q_at[j] = o->q_at[j - 1];
+        }
+        o->q_ins[j] = qi;
+        o->q_at[j] = qa;
+    }
+    int k = 0, q = 0;
+    for (int i = 0; i < o->n; i++) {
+        while (q < o->nq && o->q_at[q] <= i) out[k++] = o->q_ins[q++];
+        OIns in = o->ins[i];
+        if (in.op == OPX_DEAD) continue;
+        int tee = in.tee;
+        in.tee = -1;
+        out[k++] = in;
+        if (tee >= 0) {
+            OIns t = { OP_LOCAL_TEE, 0, -1, tee };
+            out[k++] = t;
+        }
+    }
+    while (q < o->nq) out[k++] = o->q_ins[q++];
+    o->nq = 0;
+    if (extra) {
+        cw_free(o->ins);
+        o->ins = out;
+        o->cap = o->n + extra;
+    }
+    o->n = k;
+}
+
+/* Block structure, branch targets and basic blocks */
+static int scan_structure(Opt *o) {
+    if (o->scap < o->n + 1) {
+        int c = o->n + 1;
+        int **arrs[] = { &o->match, &o->else_of, &o->target, &o->bb_of, &o->bb_start };
+        for (int a = 0; a < 5; a++) {
+            int *p = (int *)cw_realloc(*arrs[a], c * sizeof(int));
+            if (!p) { o->bad = 1; return 0; }
+            *arrs[a] = p;
+        }
+        o->scap = c;
+    }
+    int *stk = o->bb_of;        /* reused as the opener stack until filled */
+    int sp = 0;
+    o->nbb = 0;
+    for (int i = 0; i < o->n; i++) {
+        int op = o->ins[i].op;
+        o->match[i] = -1; o->else_of[i] = -1; o->target[i] = -1;
+        if (i == 0 || is_ctrl(o->ins[i - 1].op)) o->bb_start[o->nbb++] = i;
+        switch (op) {
+        case OP_BLOCK: case OP_LOOP: case OP_IF:
+            stk[sp++] = i;
+            break;
+        case OP_ELSE:
+            if (!sp || o->ins[stk[sp - 1]].op != OP_IF) { o->bad = 1; return 0; }
+            o->else_of[stk[sp - 1]] = i;
+            o->match[i] = stk[sp - 1];
+            break;
+        case OP_END:
+            if (sp) {
+                int op_i = stk[--sp];
+                o->match[op_i] = i;
+                o->match[i] = op_i;
+            } else if (i != o->n - 1) {
+                o->bad = 1; return 0;
+            }
+            break;
+        case OP_BR: case OP_BR_IF:
+            if (o->ins[i].imm > sp) { o->bad = 1; return 0; }
+            o->target[i] = o->ins[i].imm < sp ? stk[sp - 1 - o->ins[i].imm] : -1;
+            break;
+        }
+    }
+    if (sp) { o->bad = 1; return 0; }
+    o->bb_start[o->nbb] = o->n;
+    for (int b = 0; b < o->nbb; b++)
+        for (int i = o->bb_start[b]; i < o->bb_start[b + 1]; i++)
+            o->bb_of[i] = b;
+    return 1;
+}
+
+/* Where a branch to the label opened at t lands (o->n = function exit) */
+static int label_dest(Opt *o, int t) {
+    if (t < 0) return o->n;
+    return o->ins[t].op == OP_LOOP ? t + 1 : o->match[t] + 1;
+}
+
+/* Successor blocks of block b (o->nbb = exit); returns the count */
+static int succs(Opt *o, int b, int out[2]) {
+    int e = o->bb_start[b + 1] - 1;
+    int k = 0, d[2];
+    switch (o->ins[e].op) {
+    case OP_IF:
+        d[k++] = e + 1;
+        d[k++] = o->else_of[e] >= 0 ? o->else_of[e] + 1 : o->match[e] + 1;
+        break;
+    case OP_ELSE:
+        d[k++] = o->match[o->match[e]] + 1;
+        break;
+    case OP_END:
+        d[k++] = o->match[e] < 0 ? o->n : e + 1;
+        break;
+    case OP_BR:
+        d[k++] = label_dest(o, o->target[e]);
+        break;
+    case OP_BR_IF:
+        d[k++] = e + 1;
+        d[k++] = label_dest(o, o->target[e]);
+        break;
+    case OP_RETURN: case OP_UNREACHABLE:
+        break;
+    default:
+        d[k++] = e + 1;
+        break;
+    }
+    for (int j = 0; j < k; j++)
+        out[j] = d[j] >= o->n ? o->nbb : o->bb_of[d[j]];
+    return k;
+}
+
+/* The instruction that pushed the value t slots below the top of the stack
+ * just before i, or -1 if it is a block result or lies past a branch or an
+ * enclosing opener. Needs scan_structure() */
+static int producer(Opt *o, int i, int t) {
+    for (int j = i - 1; j >= 0; j--) {
+        OIns *in = &o->ins[j];
+        int np, npush;
+        uint8_t rt;
+        if (in->op == OP_END) {
+            int op = o->match[j];
+            if (op < 0 || op >= j) return -1;
+            npush = o->ins[op].bt != WASM_VOID;
+            if (t < npush) return -1;
+            t += (o->ins[op].op == OP_IF) - npush;
+            j = op;
+            continue;
+        }
+        if (is_ctrl(in->op)) return -1;
+        effect(o, in, &np, &npush, &rt);
+        if (t < npush) return j;
+        t += np - npush;
+    }
+    return -1;
+}
+
+/* ================================================================
+ *  Stack simulation
+ * ================================================================ */
+
+typedef struct SVal {
+    int start, prod;        /* the run of instructions computing it (start
+                             * -1: not one run); prod produced it */
+    uint8_t t;              /* wasm type, 0 = unknown */
+    uint8_t pure;           /* the run can go: no side effects, no traps */
+    uint8_t c;              /* known constant `bits` */
+    uint8_t removable;      /* (CSE) no side effects; may trap */
+    int64_t bits;
+    int aux;                /* instruction of `!= 0` / inner eqz (conditions) */
+    int src, sver;          /* (propagation) copy of local src at version sver */
+    int vn, cost;           /* (CSE) value number, ops it took */
+} SVal;
+
+typedef struct { SVal *v; int sp, cap; } Stk;
+
+static SVal sv_unknown(void) {
+    SVal u;
+    memset(&u, 0, sizeof(u));
+    u.start = u.prod = u.aux = u.src = u.vn = -1;
+    return u;
+}
+
+static void spush(Stk *s, SVal v) { if (s->sp < s->cap) s->v[s->sp++] = v; }
+
+static void spop(Stk *s, SVal *out, int k) {
+    for (int j = k - 1; j >= 0; j--)
+        out[j] = s->sp ? s->v[--s->sp] : sv_unknown();
+}
+
+/* Start of the run formed by v[0..k) and instruction i, or -1 */
+static int run_of(Opt *o, const SVal *v, int k, int i) {
+    for (int j = 0; j < k; j++) {
+        if (v[j].start < 0) return -1;
+        if (!gap_dead(o, v[j].prod, j + 1 < k ? v[j + 1].start : i)) return -1;
+    }
+    return k ? v[0].start : i;
+}
+
+static int sim_init(Opt *o, Stk *s) {
+    SVal *p = (SVal *)cw_realloc(o->sv, (o->n + 4) * sizeof(SVal));
+    if (!p) { o->bad = 1; return 0; }
+    o->sv = p;
+    s->v = p; s->sp = 0; s->cap = o->n + 4;
+    return 1;
+}
+
+/* ================================================================
+ *  Constant and copy propagation (-O1)
+ *
+ *  Forward dataflow over the CFG: per block entry, each local is either a
+ *  known constant or not (locals start at 0, params unknown). Reads of a
+ *  constant local become the constant; a read of a local that holds a copy
+ *  of another (still unchanged) local reads that one instead, within a block.
+ * ================================================================ */
+
+typedef struct { uint8_t nac; int64_t v; } PCell;
+
+static int prop_block(Opt *o, int b, PCell *st, int *ver, int *cp, int *cps, int *cpv,
+                      int rewrite) {
+    Stk s;
+    int ch = 0;
+    if (!sim_init(o, &s)) return 0;
+    for (int x = 0; x < o->nloc; x++) cp[x] = -1;
+    for (int i = o->bb_start[b]; i < o->bb_start[b + 1]; i++) {
+        OIns *in = &o->ins[i];
+        if (in->op == OPX_DEAD) continue;
+        int np, npush; uint8_t rt;
+        SVal v[3], r = sv_unknown();
+        effect(o, in, &np, &npush, &rt);
+        if (np > 3) { s.sp = s.sp > np ? s.sp - np : 0; np = 0; }
+        spop(&s, v, np);
+        r.t = rt;
+        int x = (int)in->imm;
+        OpInfo oi;
+        switch (in->op) {
+        case OP_LOCAL_GET:
+            if (!st[x].nac) {
+                if (rewrite) { set_const(in, o->ltype[x], st[x].v); ch = 1; }
+                r.c = 1; r.bits = st[x].v;
+                break;
+            }
+            if (cp[x] >= 0 && ver[x] == cpv[x] && ver[cp[x]] == cps[x]) {
+                if (rewrite) { in->imm = cp[x]; ch = 1; }
+                x = cp[x];
+            }
+            r.src = x; r.sver = ver[x];
+            break;
+        case OP_GLOBAL_GET:
+            if (x < MAX_SYMS + 2 && gfixed[x]) {
+                if (rewrite) { set_const(in, gfixed[x], gfixed_bits[x]); ch = 1; }
+                r.c = 1; r.bits = gfixed_bits[x];
+            }
+            break;
+        case OP_LOCAL_SET: case OP_LOCAL_TEE:
+            st[x].nac = !v[0].c;
+            st[x].v = v[0].c ? v[0].bits : 0;
+            ver[x]++;
+            cp[x] = -1;
+            if (v[0].src >= 0 && v[0].src != x && ver[v[0].src] == v[0].sver) {
+                cp[x] = v[0].src; cps[x] = v[0].sver; cpv[x] = ver[x];
+            }
+            if (in->op == OP_LOCAL_TEE) {
+                r = v[0]; r.t = rt;
+                r.src = x; r.sver = ver[x];
+            }
+            break;
+        case OP_SELECT:
+            if (v[2].c) r = (int32_t)v[2].bits ? v[0] : v[1];
+            else if (v[0].c && v[1].c && v[0].bits == v[1].bits) r = v[0];
+            r.src = -1;
+            break;
+        default:
+            if (!num_info(in->op, &oi)) break;
+            if (oi.kind == OK_CONST) { r.c = 1; r.bits = in->imm; }
+            else if (oi.kind == OK_NUM) {
+                int64_t res;
+                if (oi.npop == 1 && v[0].c && eval_unop(in->op, v[0].bits, &res)) { r.c = 1; r.bits = res; }
+                if (oi.npop == 2 && v[0].c && v[1].c && eval_binop(in->op, v[0].bits, v[1].bits, &res)) { r.c = 1; r.bits = res; }
+            }
+            break;
+        }
+        if (npush) spush(&s, r);
+    }
+    return ch;
+}
+
+static int pass_propagate(Opt *o) {
+    int nb = o->nbb, nl = o->nloc, ch = 0;
+    PCell *in = (PCell *)cw_calloc((size_t)nb * (nl ? nl : 1), sizeof(PCell));
+    PCell *cur = (PCell *)cw_calloc(nl ? nl : 1, sizeof(PCell));
+    uint8_t *reached = (uint8_t *)cw_calloc(nb, 1);
+    int *ver = (int *)cw_calloc(nl ? nl : 1, 4 * sizeof(int));
+    if (!in || !cur || !reached || !ver) { o->bad = 1; goto done; }
+    int *cp = ver + nl, *cps = cp + nl, *cpv = cps + nl;
+
+    for (int x = 0; x < o->f->nparams; x++) in[x].nac = 1;
+    reached[0] = 1;
+    for (int changed = 1; changed; ) {
+        changed = 0;
+        for (int b = 0; b < nb; b++) {
+            if (!reached[b]) continue;
+            memcpy(cur, in + (size_t)b * nl, nl * sizeof(PCell));
+            prop_block(o, b, cur, ver, cp, cps, cpv, 0);
+            int sb[2], ns = succs(o, b, sb);
+            for (int j = 0; j < ns; j++) {
+                if (sb[j] >= nb) continue;
+                PCell *d = in + (size_t)sb[j] * nl;
+                if (!reached[sb[j]]) {
+                    memcpy(d, cur, nl * sizeof(PCell));
+                    reached[sb[j]] = 1;
+                    changed = 1;
+                    continue;
+                }
+                for (int x = 0; x < nl; x++) {
+                    if (d[x].nac || (!cur[x].nac && cur[x].v == d[x].v)) continue;
+                    d[x].nac = 1;
+                    changed = 1;
+                }
+            }
+        }
+    }
+    for (int b = 0; b < nb; b++) {
+        if (!reached[b]) continue;
+        memcpy(cur, in + (size_t)b * nl, nl * sizeof(PCell));
+        ch |= prop_block(o, b, cur, ver, cp, cps, cpv, 1);
+    }
+done:
+    cw_free(in); cw_free(cur); cw_free(reached); cw_free(ver);
+    return ch;
+}
+
+/* ================================================================
+ *  Folding (-O1)
+ *
+ *  Within each basic block: constant operands fold, identities vanish,
+ *  eqz of a compare inverts it, conditions lose a redundant `!= 0`, const
+ *  br_if/if/select pick their arm, drops of pure values disappear together
+ *  with the value, `local.set x; local.get x` becomes `local.tee x`, and a
+ *  br or br_if to the end that immediately follows becomes a fall-through.
+ * ================================================================ */
+
+/* Remove `!= 0` or `eqz(eqz(x))` from a value only used as a condition */
+static int strip_cond(Opt *o, const SVal *v, int i) {
+    if (v->aux < 0 || v->prod < 0 || !gap_dead(o, v->prod, i)) return 0;
+    OIns *p = &o->ins[v->prod], *a = &o->ins[v->aux];
+    if (!((p->op == OP_I32_NE && a->op == OP_I32_CONST && a->imm == 0)
+          || (p->op == OP_I32_EQZ && a->op == OP_I32_EQZ)))
+        return 0;
+    kill_range(o, v->aux, v->aux);
+    kill_range(o, v->prod, v->prod);
+    return 1;
+}
+
+static int pass_fold(Opt *o) {
+    Stk s;
+    int ch = 0;
+    if (!sim_init(o, &s)) return 0;
+    for (int b = 0; b < o->nbb; b++) {
+        int first = o->bb_start[b];
+        /* The frame's operand stack is empty at the start of this block */
+        int empty = first == 0 || (is_opener(o->ins[first - 1].op) || o->ins[first - 1].op == OP_ELSE);
+        s.sp = 0;
+        for (int i = first; i < o->bb_start[b + 1]; i++) {
+            OIns *in = &o->ins[i];
+            if (in->op == OPX_DEAD) continue;
+            int np, npush; uint8_t rt;
+            SVal v[3], r = sv_unknown();
+            OpInfo oi;
+            effect(o, in, &np, &npush, &rt);
+            if (np > 3) { s.sp = s.sp > np ? s.sp - np : 0; np = 0; empty = 0; }
+            spop(&s, v, np);
+            r.t = rt;
+            switch (in->op) {
+            case OP_LOCAL_GET: case OP_GLOBAL_GET:
+                r.start = r.prod = i; r.pure = 1;
+                break;
+            case OP_DROP:
+                /* Whatever runs between the value and the drop is balanced
+                 * above it, so neither needs to be adjacent */
+                if (v[0].pure && v[0].start >= 0) {
+                    kill_range(o, v[0].start, v[0].prod);
+                    kill_range(o, i, i);
+                    ch = 1;
+                } else if (v[0].prod >= 0 && o->ins[v[0].prod].op == OP_LOCAL_TEE) {
+                    o->ins[v[0].prod].op = OP_LOCAL_SET;
+                    kill_range(o, i, i);
+                    ch = 1;
+                }
+                break;
+            case OP_LOCAL_SET: {
+                if (v[0].start == v[0].prod && v[0].prod >= 0 && gap_dead(o, v[0].prod, i)
+                    && o->ins[v[0].prod].op == OP_LOCAL_GET && o->ins[v[0].prod].imm == in->imm) {
+                    kill_range(o, v[0].prod, i);     /* x = x */
+                    ch = 1;
+                    break;
+                }
+                int j = next_live(o, i);
+                if (j < o->bb_start[b + 1] && o->ins[j].op == OP_LOCAL_GET && o->ins[j].imm == in->imm) {
+                    in->op = OP_LOCAL_TEE;
+                    kill_range(o, j, j);
+                    r.t = o->ltype[in->imm];
+                    r.start = run_of(o, v, 1, i);
+                    r.prod = i;
+                    npush = 1;
+                    ch = 1;
+                }
+                break;
+            }
+            case OP_LOCAL_TEE:
+                if (v[0].start == v[0].prod && v[0].prod >= 0 && gap_dead(o, v[0].prod, i)
+                    && o->ins[v[0].prod].op == OP_LOCAL_GET && o->ins[v[0].prod].imm == in->imm) {
+                    kill_range(o, i, i);
+                    r = v[0];
+                    ch = 1;
+                    break;
+                }
+                r.start = run_of(o, v, 1, i);
+                r.prod = i;
+                break;
+            case OP_SELECT:
+                r.t = v[0].t ? v[0].t : v[1].t;
+                if (v[2].c && run_of(o, &v[2], 1, i) >= 0) {
+                    if ((int32_t)v[2].bits) {
+                        if (v[1].pure && run_of(o, &v[1], 2, i) >= 0) {
+                            kill_range(o, v[1].start, i);
+                            r = v[0];
+                            ch = 1;
+                            break;
+                        }
+                    } else if (v[0].pure && run_of(o, v, 3, i) >= 0) {
+                        kill_range(o, v[0].start, v[1].start - 1);
+                        kill_range(o, v[2].start, i);
+                        r = v[1];
+                        ch = 1;
+                        break;
+                    }
+                }
+                r.start = run_of(o, v, 3, i);
+                r.prod = i;
+                r.pure = r.start >= 0 && v[0].pure && v[1].pure && v[2].pure;
+                break;
+            case OP_BR_IF:
+                if (v[0].c && run_of(o, v, 1, i) >= 0) {
+                    kill_range(o, v[0].start, i - 1);
+                    if ((int32_t)v[0].bits) in->op = OP_BR;
+                    else kill_range(o, i, i);
+                    ch = 1;
+                } else if (o->target[i] >= 0 && o->ins[o->target[i]].op != OPX_DEAD
+                           && o->ins[o->target[i]].op != OP_LOOP
+                           && next_live(o, i) == o->match[o->target[i]]) {
+                    in->op = OP_DROP;
+                    ch = 1;
+                } else {
+                    ch |= strip_cond(o, &v[0], i);
+                }
+                break;
+            case OP_IF:
+                if (v[0].c && run_of(o, v, 1, i) >= 0) {
+                    int e = o->else_of[i], end = o->match[i];
+                    kill_range(o, v[0].start, i - 1);
+                    if ((int32_t)v[0].bits) {
+                        in->op = OP_BLOCK;
+                        if (e >= 0) kill_range(o, e, end - 1);
+                    } else if (e >= 0) {
+                        o->ins[e].op = OP_BLOCK;
+                        o->ins[e].bt = in->bt;
+                        kill_range(o, i, e - 1);
+                    } else {
+                        kill_range(o, i, end);
+                    }
+                    ch = 1;
+                } else {
+                    ch |= strip_cond(o, &v[0], i);
+                }
+                break;
+            case OP_BR: {
+                int t = o->target[i];
+                /* Falling into the end does the same, given the block's
+                 * stack holds exactly its result */
+                if (empty && t >= 0 && o->ins[t].op != OPX_DEAD && o->ins[t].op != OP_LOOP
+                    && s.sp == (o->ins[t].bt != WASM_VOID)
+                    && next_live(o, i) == o->match[t]) {
+                    kill_range(o, i, i);
+                    ch = 1;
+                }
+                break;
+            }
+            default:
+                if (!num_info(in->op, &oi)) break;
+                if (oi.kind == OK_CONST) {
+                    r.start = r.prod = i; r.pure = 1; r.c = 1; r.bits = in->imm;
+                    break;
+                }
+                r.start = run_of(o, v, oi.npop, i);
+                r.prod = i;
+                if (oi.kind != OK_NUM) break;
+                r.pure = r.start >= 0 && !oi.trap && v[0].pure && (oi.npop < 2 || v[1].pure);
+                if (r.start >= 0 && v[0].c && (oi.npop < 2 || v[1].c)) {
+                    int64_t res;
+                    if (oi.npop == 1 ? eval_unop(in->op, v[0].bits, &res)
+                                     : eval_binop(in->op, v[0].bits, v[1].bits, &res)) {
+                        kill_range(o, r.start, i - 1);
+                        set_const(in, oi.rt, res);
+                        r.c = 1; r.bits = res; r.pure = 1;
+                        ch = 1;
+                        break;
+                    }
+                }
+                if (oi.npop == 2) {
+                    if (v[1].c && run_of(o, &v[1], 1, i) >= 0 && rhs_identity(in->op, v[1].bits)) {
+                        kill_range(o, v[1].start, i);
+                        r = v[0];
+                        ch = 1;
+                        break;
+                    }
+                    if (v[0].c && run_of(o, v, 2, i) >= 0 && lhs_identity(in->op, v[0].bits)) {
+                        kill_range(o, v[0].start, v[1].start - 1);
+                        kill_range(o, i, i);
+                        r = v[1];
+                        ch = 1;
+                        break;
+                    }
+                    if ((in->op == OP_I32_EQ || in->op == OP_I64_EQ) && v[1].c && v[1].bits == 0
+                        && run_of(o, &v[1], 1, i) >= 0) {
+                        kill_range(o, v[1].start, i - 1);
+                        in->op = in->op == OP_I32_EQ ? OP_I32_EQZ : OP_I64_EQZ;
+                        r.start = run_of(o, v, 1, i);
+                        r.pure = r.start >= 0 && v[0].pure;
+                        ch = 1;
+                        break;
+                    }
+                    if (in->op == OP_I32_NE && v[1].c && v[1].bits == 0 && run_of(o, &v[1], 1, i) >= 0)
+                        r.aux = v[1].prod;
+                } else if (in->op == OP_I32_EQZ && v[0].prod >= 0 && gap_dead(o, v[0].prod, i)) {
+                    int inv = invert_cmp(o->ins[v[0].prod].op);
+                    if (inv) {
+                        o->ins[v[0].prod].op = inv;
+                        kill_range(o, i, i);
+                        r = v[0];
+                        r.aux = -1;
+                        ch = 1;
+                        break;
+                    }
+                    if (o->ins[v[0].prod].op == OP_I32_EQZ) r.aux = v[0].prod;
+                }
+                break;
+            }
+            if (npush) spush(&s, r);
+        }
+    }
+    return ch;
+}
+
+/* ================================================================
+ *  Structure (-O1): unreachable code, empty constructs, unused labels
+ * ================================================================ */
+
+static int pass_structure(Opt *o) {
+    int ch = 0;
+    /* Code after br/return/unreachable, up to the end of its construct */
+    for (int i = 0; i < o->n; i++) {
+        int op = o->ins[i].op;
+        if (op != OP_BR && op != OP_RETURN && op != OP_UNREACHABLE) continue;
+        int depth = 0;
+        for (int j = i + 1; j < o->n; j++) {
+            int oj = o->ins[j].op;
+            if (oj == OPX_DEAD) continue;
+            if (is_opener(oj)) depth++;
+            else if (oj == OP_END) { if (!depth) break; depth--; }
+            else if (oj == OP_ELSE && !depth) break;
+            o->ins[j].op = OPX_DEAD;
+            ch = 1;
+        }
+    }
+    if (ch) return ch;      /* rescan before relying on targets */
+
+    uint8_t *targeted = (uint8_t *)cw_calloc(o->n, 1);
+    if (!targeted) { o->bad = 1; return 0; }
+    for (int i = 0; i < o->n; i++)
+        if ((o->ins[i].op == OP_BR || o->ins[i].op == OP_BR_IF) && o->target[i] >= 0)
+            targeted[o->target[i]] = 1;
+
+    for (int i = 0; i < o->n; i++) {
+        OIns *in = &o->ins[i];
+        if (!is_opener(in->op)) continue;
+        int e = o->match[i];
+        if (in->bt != WASM_VOID) {
+            /* A typed block nothing branches to is just its body */
+            if (in->op == OP_IF || targeted[i]) continue;
+        } else if (in->op == OP_IF) {
+            int el = o->else_of[i];
+            int then_empty = next_live(o, i) == (el >= 0 ? el : e);
+            if (then_empty && (el < 0 || next_live(o, el) == e)) {
+                in->op = OP_DROP;
+                if (el >= 0) kill_range(o, el, el);
+                kill_range(o, e, e);
+                ch = 1;
+            }
+            continue;
+        }
+        if (next_live(o, i) == e || !targeted[i]) {
+            for (int j = i + 1; j < e; j++) {
+                OIns *bj = &o->ins[j];
+                if ((bj->op == OP_BR || bj->op == OP_BR_IF) && o->target[j] < i) bj->imm--;
+            }
+            kill_range(o, i, i);
+            kill_range(o, e, e);
+            ch = 1;
+        }
+    }
+    cw_free(targeted);
+    return ch;
+}
+
+/* ================================================================
+ *  Dead loads (-O1)
+ *
+ *  Codegen reads an lvalue on both sides of a store to it (`a[i] = v`
+ *  leaves a dropped load of a[i] before and after the store). A dropped
+ *  load only matters if it traps. It can't once the same bytes were
+ *  accessed through the same, unchanged address local, since memory never
+ *  shrinks. Nor does it matter when an access that traps whenever it would
+ *  follows, with nothing observable in between. A load from a constant
+ *  address inside the data segment never traps.
+ * ================================================================ */
+
+typedef struct { int x, w; int64_t off; } MemFact;
+
+#define MAX_MEM_FACTS 16
+
+/* Bytes a load or store touches */
+static int mem_width(int op) {
+    static const uint8_t w[23] = {
+        4, 8, 4, 8, 1, 1, 2, 2, 1, 1, 2, 2, 4, 4,      /* loads */
+        4, 8, 4, 8, 1, 2, 1, 2, 4 };                    /* stores */
+    return op >= 0x28 && op <= 0x3E ? w[op - 0x28] : 0;
+}
+
+/* The local the load or store at i takes its address from (a local.get,
+ * or a tee if `tee` is set, with no write to the local before the access),
+ * or -1 */
+static int addr_local(Opt *o, int i, int tee) {
+    int a = producer(o, i, o->ins[i].op >= 0x36 ? 1 : 0);
+    if (a < 0 || !(o->ins[a].op == OP_LOCAL_GET || (tee && o->ins[a].op == OP_LOCAL_TEE)))
+        return -1;
+    for (int j = a + 1; j < i; j++)
+        if ((o->ins[j].op == OP_LOCAL_SET || o->ins[j].op == OP_LOCAL_TEE)
+            && o->ins[j].imm == o->ins[a].imm) return -1;
+    return (int)o->ins[a].imm;
+}
+
+/* Before the end of the block, after i, comes an access of at least w
+ * bytes at the same address, and nothing before it that could be seen */
+static int same_access_follows(Opt *o, int i, int end, int x, int64_t off, int w) {
+    for (int j = next_live(o, i); j < end; j = next_live(o, j)) {
+        OIns *in = &o->ins[j];
+        OpInfo oi;
+        int is_num = num_info(in->op, &oi);
+        if (is_num && (oi.kind == OK_LOAD || oi.kind == OK_STORE))
+            return addr_local(o, j, 0) == x && in->imm == off && mem_width(in->op) >= w;
+        if (is_num) {
+            if (oi.trap) return 0;
+        } else if (in->op == OP_LOCAL_SET || in->op == OP_LOCAL_TEE) {
+            if (in->imm == x) return 0;
+        } else if (in->op != OP_LOCAL_GET && in->op != OP_GLOBAL_GET
+                   && in->op != OP_DROP && in->op != OP_SELECT) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+static int pass_dead_loads(Opt *o) {
+    MemFact f[MAX_MEM_FACTS];
+    int ch = 0;
+    for (int b = 0; b < o->nbb; b++) {
+        int nf = 0, end = o->bb_start[b + 1];
+        for (int i = o->bb_start[b]; i < end; i++) {
+            OIns *in = &o->ins[i];
+            OpInfo oi;
+            if (in->op == OP_LOCAL_SET || in->op == OP_LOCAL_TEE) {
+                for (int k = 0; k < nf; k++)
+                    if (f[k].x == in->imm) f[k--] = f[--nf];
+                continue;
+            }
+            if (!num_info(in->op, &oi) || (oi.kind != OK_LOAD && oi.kind != OK_STORE)) continue;
+            int x = addr_local(o, i, 1), w = mem_width(in->op), d = next_live(o, i);
+            int a = producer(o, i, 0);
+            int fixed = oi.kind == OK_LOAD && a >= 0 && o->ins[a].op == OP_I32_CONST
+                        && (uint32_t)o->ins[a].imm + in->imm + w <= (int64_t)data_len;
+            if (x < 0 && !fixed) continue;
+            if (oi.kind == OK_LOAD && d < end && o->ins[d].op == OP_DROP) {
+                int k;
+                for (k = 0; k < nf; k++)
+                    if (f[k].x == x && f[k].off == in->imm && f[k].w >= w) break;
+                if (fixed || k < nf || same_access_follows(o, d, end, x, in->imm, w)) {
+                    in->op = OP_DROP;           /* of the address instead */
+                    in->imm = 0; in->bt = 0;
+                    kill_range(o, d, d);
+                    ch = 1;
+                    continue;
+                }
+            }
+            if (x >= 0 && nf < MAX_MEM_FACTS) f[nf++] = (MemFact){ x, w, in->imm };
+        }
+    }
+    return ch;
+}
+
+/* ================================================================
+ *  Common subexpressions (-O2)
+ *
+ *  Value numbering over each basic block. Locals carry the value number of
+ *  what was stored; globals and memory carry a version bumped by every
+ *  store or call. A repeated computation worth at least two ops becomes a
+ *  local.get of a temp that its first occurrence now tees. Repeating a
+ *  load or a division is safe: the first one would have trapped.
+ * ================================================================ */
+
+typedef struct { int op; int64_t imm; int a, b, c; int first, temp; } VNEnt;
+
+#define OPX_ENTRY 0x1FFFF       /* a local's value on entry to the block */
+
+static int new_local(Opt *o, uint8_t t) {
+    if (o->nlocals >= CW_MAX_LOCALS || !t) return -1;
+    o->ltype[o->nloc] = t;
+    o->nlocals++;
+    return o->nloc++;
+}
+
+static int pass_cse(Opt *o) {
+    Stk s;
+    int ch = 0;
+    if (!sim_init(o, &s)) return 0;
+    VNEnt *tab = (VNEnt *)cw_malloc((o->n + 1) * sizeof(VNEnt));
+    int *lval = (int *)cw_malloc((o->nloc + CW_MAX_LOCALS + 1) * sizeof(int));
+    if (!tab || !lval) { o->bad = 1; goto done; }
+
+    for (int b = 0; b < o->nbb; b++) {
+        int ntab = 0, gver = 0, mver = 0;
+        s.sp = 0;
+        for (int x = 0; x < o->nloc; x++) lval[x] = -1;
+        for (int i = o->bb_start[b]; i < o->bb_start[b + 1]; i++) {
+            OIns *in = &o->ins[i];
+            if (in->op == OPX_DEAD) continue;
+            int np, npush; uint8_t rt;
+            SVal v[3], r = sv_unknown();
+            OpInfo oi;
+            effect(o, in, &np, &npush, &rt);
+            if (np > 3) { s.sp = s.sp > np ? s.sp - np : 0; np = 0; }
+            spop(&s, v, np);
+            r.t = rt;
+            r.start = run_of(o, v, np, i);
+            r.prod = i;
+
+            /* The key this instruction's value is numbered by, if any */
+            int kop = -1, ka = -1, kb = -1, kc = -1, cost = 0, rem = 1;
+            int64_t kimm = 0;
+            int x = (int)in->imm;
+            int is_num = num_info(in->op, &oi);
+            switch (in->op) {
+            case OP_LOCAL_GET:
+                if (lval[x] >= 0) { r.vn = lval[x]; r.removable = 1; }
+                else { kop = OPX_ENTRY; kimm = x; }
+                break;
+            case OP_LOCAL_SET: case OP_LOCAL_TEE:
+                if (v[0].vn < 0) {
+                    tab[ntab].op = OPX_DEAD; tab[ntab].first = -1; tab[ntab].temp = -1;
+                    v[0].vn = ntab++;
+                }
+                lval[x] = v[0].vn;
+                if (in->op == OP_LOCAL_TEE) {
+                    r = v[0];
+                    r.start = run_of(o, v, 1, i);
+                    r.prod = i;
+                    r.removable = 0;
+                }
+                break;
+            case OP_GLOBAL_GET:
+                kop = in->op; kimm = x; ka = gver; cost = 1;
+                break;
+            case OP_GLOBAL_SET:
+                gver++;
+                break;
+            case OP_CALL:
+                gver++; mver++;
+                break;
+            case OPX_COPY: case OPX_FILL:
+                mver++;
+                break;
+            case OP_SELECT:
+                kop = in->op; ka = v[0].vn; kb = v[1].vn; kc = v[2].vn;
+                cost = 1 + v[0].cost + v[1].cost + v[2].cost;
+                rem = v[0].removable && v[1].removable && v[2].removable;
+                r.t = v[0].t ? v[0].t : v[1].t;
+                if (ka < 0 || kb < 0 || kc < 0) kop = -1;
+                break;
+            default:
+                if (!is_num) break;
+                if (oi.kind == OK_STORE) { mver++; break; }
+                kop = in->op; kimm = in->imm;
+                if (oi.kind == OK_CONST) break;
+                cost = 1 + v[0].cost + (oi.npop > 1 ? v[1].cost : 0);
+                rem = v[0].removable && (oi.npop < 2 || v[1].removable);
+                ka = v[0].vn;
+                if (oi.npop > 1) kb = v[1].vn;
+                if (oi.kind == OK_LOAD) { kb = mver; kc = in->bt; }
+                if (ka < 0 || (oi.npop > 1 && kb < 0)) kop = -1;
+                break;
+            }
+
+            if (kop >= 0) {
+                int k;
+                for (k = 0; k < ntab; k++)
+                    if (tab[k].op == kop && tab[k].imm == kimm && tab[k].a == ka
+                        && tab[k].b == kb && tab[k].c == kc) break;
+                r.vn = k;
+                r.cost = cost;
+                r.removable = rem;
+                if (k == ntab) {
+                    VNEnt *e = &tab[ntab++];
+                    e->op = kop; e->imm = kimm; e->a = ka; e->b = kb; e->c = kc;
+                    e->first = i; e->temp = -1;
+                    if (kop == OPX_ENTRY) lval[x] = k;
+                } else if (cost >= 2 && rem && tab[k].first >= 0
+                           && o->ins[tab[k].first].op != OPX_DEAD) {
+                    int st = r.start;
+                    int t = tab[k].temp;
+                    if (st >= 0 && t < 0) {
+                        t = new_local(o, r.t);
+                        if (t >= 0) {
+                            tab[k].temp = t;
+                            o->ins[tab[k].first].tee = t;
+                        }
+                    }
+                    if (st >= 0 && t >= 0) {
+                        kill_range(o, st, i - 1);
+                        in->op = OP_LOCAL_GET;
+                        in->imm = t;
+                        in->bt = 0;
+                        ch = 1;
+                    }
+                }
+            }
+            if (npush) spush(&s, r);
+        }
+    }
+done:
+    cw_free(tab); cw_free(lval);
+    return ch;
+}
+
+/* ================================================================
+ *  Dead stores (-O2)
+ * ================================================================ */
+
+/* Global stores overwritten later in the block with nothing in between
+ * that reads the global, calls out, or could trap (and so report __line) */
+static int pass_dead_globals(Opt *o) {
+    int ch = 0;
+    int *pending = (int *)cw_malloc((o->ngtype + 1) * sizeof(int));
+    if (!pending) { o->bad = 1; return 0; }
+    for (int b = 0; b < o->nbb; b++) {
+        for (int g = 0; g < o->ngtype; g++) pending[g] = -1;
+        for (int i = o->bb_start[b]; i < o->bb_start[b + 1]; i++) {
+            OIns *in = &o->ins[i];
+            if (in->op == OP_GLOBAL_SET) {
+                if (pending[in->imm] >= 0) {
+                    o->ins[pending[in->imm]].op = OP_DROP;
+                    ch = 1;
+                }
+                pending[in->imm] = i;
+            } else if (in->op == OP_GLOBAL_GET) {
+                pending[in->imm] = -1;
+            } else if (observes(in->op)) {
+                for (int g = 0; g < o->ngtype; g++) pending[g] = -1;
+            }
+        }
+    }
+    cw_free(pending);
+    return ch;
+}
+
+#define BIT(set, x)  ((set)[(x) >> 6] & (1ull << ((x) & 63)))
+#define SETB(set, x) ((set)[(x) >> 6] |= (1ull << ((x) & 63)))
+#define CLRB(set, x) ((set)[(x) >> 6] &= ~(1ull << ((x) & 63)))
+
+/* Backward liveness of locals over the CFG. Returns nbb * W words of
+ * live-out sets (W words of bits per block, one bit per local); the next
+ * W words are scratch, and the live-in sets start at 3 * nbb * W. The
+ * caller frees it. */
+static uint64_t *live_out(Opt *o, int W) {
+    int nb = o->nbb;
+    uint64_t *mem = (uint64_t *)cw_calloc((size_t)nb * W * 4 + W, sizeof(uint64_t));
+    if (!mem) { o->bad = 1; return NULL; }
+    uint64_t *lout = mem, *gen = lout + (size_t)nb * W, *kil = gen + (size_t)nb * W,
+             *lin = kil + (size_t)nb * W;
+
+    for (int b = 0; b < nb; b++) {
+        uint64_t *g = gen + (size_t)b * W, *k = kil + (size_t)b * W;
+        for (int i = o->bb_start[b]; i < o->bb_start[b + 1]; i++) {
+            OIns *in = &o->ins[i];
+            int x = (int)in->imm;
+            if (in->op == OP_LOCAL_GET) { if (!BIT(k, x)) SETB(g, x); }
+            else if (in->op == OP_LOCAL_SET || in->op == OP_LOCAL_TEE) SETB(k, x);
+        }
+    }
+    for (int changed = 1; changed; ) {
+        changed = 0;
+        for (int b = nb - 1; b >= 0; b--) {
+            uint64_t *out = lout + (size_t)b * W, *inb = lin + (size_t)b * W;
+            int sb[2], ns = succs(o, b, sb);
+            for (int j = 0; j < ns; j++) {
+                if (sb[j] >= nb) continue;
+                uint64_t *si = lin + (size_t)sb[j] * W;
+                for (int w = 0; w < W; w++) out[w] |= si[w];
+            }
+            for (int w = 0; w < W; w++) {
+                uint64_t nv = gen[(size_t)b * W + w] | (out[w] & ~kil[(size_t)b * W + w]);
+                if (nv != inb[w]) { inb[w] = nv; changed = 1; }
+            }
+        }
+    }
+    return mem;
+}
+
+/* Local stores nothing reads */
+static int pass_dead_locals(Opt *o) {
+    int nb = o->nbb, W = (o->nloc + 63) / 64, ch = 0;
+    if (!W) return 0;
+    uint64_t *lout = live_out(o, W);
+    if (!lout) return 0;
+    uint64_t *live = lout + (size_t)nb * W;
+    for (int b = 0; b < nb; b++) {
+        memcpy(live, lout + (size_t)b * W, W * sizeof(uint64_t));
+        for (int i = o->bb_start[b + 1] - 1; i >= o->bb_start[b]; i--) {
+            OIns *in = &o->ins[i];
+            int x = (int)in->imm;
+            if (in->op == OP_LOCAL_GET) SETB(live, x);
+            else if (in->op == OP_LOCAL_SET || in->op == OP_LOCAL_TEE) {
+                if (BIT(live, x)) CLRB(live, x);
+                else {
+                    if (in->op == OP_LOCAL_SET) in->op = OP_DROP;
+                    else kill_range(o, i, i);
+                    ch = 1;
+                }
+            }
+        }
+    }
+    cw_free(lout);
+    return ch;
+}
+
+/* ================================================================
+ *  Loops (-O2)
+ *
+ *  A wasm loop is entered only by falling into its `loop` opener, so code
+ *  queued right before the opener runs once per entry to the loop: that's
+ *  the preheader the two passes below move work into.
+ *
+ *  Invariant code motion: a pure, non-trapping expression whose operands
+ *  the loop never changes is computed into a new local in the preheader.
+ *  Operands can be locals, globals, and loads from a constant address,
+ *  which is where C globals live. Such a load can't trap when the address
+ *  lies within the data segment. The loop must not call anything, and its
+ *  stores must provably miss the loaded bytes. A lone global.get counts
+ *  too: it is an op in wasm3, where a local.get costs nothing.
+ *
+ *  Strength reduction: a counter `i` whose only write in the loop is
+ *  `i += step` has its derived values, like the `buf + i*3 + 1` of an
+ *  array index, replaced by a pointer local. The pointer is set up in the
+ *  preheader and stepped right after `i`. If the loop then reads `i`
+ *  only in its exit test, and the test's range is known, the test moves
+ *  onto the pointer and `i` disappears.
+ * ================================================================ */
+
+/* --- Value ranges ---
+ * Just enough to bound counters and addresses: constants, +, -, * and <<,
+ * over locals that are loop counters (or constant in the loop at hand).
+ * Bounds are exact int64 values; anything that might wrap as an i32 fails.
+ */
+
+#define RANGE_DEPTH 8
+
+typedef struct { int64_t lo, hi; } Range;
+
+/* `local.get x; step; i32.add|i32.sub; local.set x` in a loop */
+typedef struct { int get, step, op, set; } IvStep;
+
+/* The innermost loop around position pos, or -1 */
+static int loop_around(Opt *o, int pos) {
+    for (int j = pos - 1; j >= 0; j--)
+        if (o->ins[j].op == OP_LOOP && o->match[j] > pos) return j;
+    return -1;
+}
+
+/* Stores to local x inside the loop at L; *w = the last one */
+static int writes_of(Opt *o, int L, int x, int *w) {
+    int k = 0;
+    for (int i = L + 1; i < o->match[L]; i++)
+        if ((o->ins[i].op == OP_LOCAL_SET || o->ins[i].op == OP_LOCAL_TEE) && o->ins[i].imm == x) {
+            k++;
+            *w = i;
+        }
+    return k;
+}
+
+/* x's only store in the loop at L is an i32 step by a constant or by a
+ * local the loop doesn't write, outside any inner loop */
+static int find_step(Opt *o, int L, int x, IvStep *st) {
+    int w = -1;
+    if (o->ltype[x] != WASM_I32 || writes_of(o, L, x, &w) != 1
+        || o->ins[w].op != OP_LOCAL_SET || loop_around(o, w) != L) return 0;
+    int op = prev_live(o, w);
+    if (op <= L || (o->ins[op].op != OP_I32_ADD && o->ins[op].op != OP_I32_SUB)) return 0;
+    int a = producer(o, op, 1), b = producer(o, op, 0);
+    if (a <= L || b <= a || !gap_dead(o, a, b) || !gap_dead(o, b, op)) return 0;
+    if (o->ins[op].op == OP_I32_ADD && o->ins[b].op == OP_LOCAL_GET && o->ins[b].imm == x) {
+        int t = a; a = b; b = t;
+    }
+    if (o->ins[a].op != OP_LOCAL_GET || o->ins[a].imm != x) return 0;
+    if (o->ins[b].op == OP_LOCAL_GET) {
+        int v = (int)o->ins[b].imm, dummy;
+        if (v == x || o->ltype[v] != WASM_I32 || writes_of(o, L, v, &dummy)) return 0;
+    } else if (o->ins[b].op != OP_I32_CONST) {
+        return 0;
+    }
+    st->get = a; st->step = b; st->op = op; st->set = w;
+    return 1;
+}
+
+/* The loop at L starts `local.get x; bound; compare; br_if <out>`: returns
+ * the compare's index, or -1 */
+static int exit_test(Opt *o, int L, int *get, int *bound) {
+    int E = o->match[L];
+    int a = next_live(o, L), b = next_live(o, a), c = next_live(o, b), d = next_live(o, c);
+    if (d >= E || o->ins[a].op != OP_LOCAL_GET || o->ins[d].op != OP_BR_IF) return -1;
+    if (o->ins[b].op != OP_I32_CONST && o->ins[b].op != OP_LOCAL_GET) return -1;
+    if (o->ins[c].op < OP_I32_LT_S || o->ins[c].op > OP_I32_GE_U) return -1;
+    int t = o->target[d];
+    if (t >= L || (t >= 0 && o->match[t] < E)) return -1;
+    *get = a; *bound = b;
+    return c;
+}
+
+static int val_range(Opt *o, int j, Range *r, int d);
+
+/* Range of counter x at position pos in the loop at L (-1: anywhere in
+ * it). The exit test runs first in every iteration and the step at most
+ * once, so x never gets more than one step past the bound; between the
+ * test and the step it is within the bound. */
+static int iv_range(Opt *o, int L, int x, int pos, Range *r, int d) {
+    IvStep st;
+    Range init, n, s;
+    int get, bound, c = exit_test(o, L, &get, &bound);
+    if (c < 0 || o->ins[get].imm != x || !find_step(o, L, x, &st)) return 0;
+    /* the entry value: x's last store in the straight-line code before L */
+    int p = prev_live(o, L);
+    for (; p >= 0; p = prev_live(o, p)) {
+        OIns *in = &o->ins[p];
+        if ((in->op == OP_LOCAL_SET || in->op == OP_LOCAL_TEE) && in->imm == x) break;
+        if (is_ctrl(in->op) && (in->op != OP_BLOCK || in->bt != WASM_VOID)) return 0;
+    }
+    if (p < 0 || o->ins[p].op != OP_LOCAL_SET) return 0;
+    if (!val_range(o, producer(o, p, 0), &init, d + 1) || !val_range(o, bound, &n, d + 1)
+        || !val_range(o, st.step, &s, d + 1)) return 0;
+    if (o->ins[st.op].op == OP_I32_SUB) { int64_t t = s.lo; s.lo = -s.hi; s.hi = -t; }
+    int op = o->ins[c].op;
+    switch (op) {
+    case OP_I32_GE_S: case OP_I32_GE_U:         /* leaves once x >= n */
+        if (s.lo <= 0) return 0;
+        r->lo = init.lo;
+        r->hi = init.hi > n.hi - 1 + s.hi ? init.hi : n.hi - 1 + s.hi;
+        break;
+    case OP_I32_GT_S: case OP_I32_GT_U:
+        if (s.lo <= 0) return 0;
+        r->lo = init.lo;
+        r->hi = init.hi > n.hi + s.hi ? init.hi : n.hi + s.hi;
+        break;
+    case OP_I32_LE_S: case OP_I32_LE_U:
+        if (s.hi >= 0) return 0;
+        r->lo = init.lo < n.lo + 1 + s.lo ? init.lo : n.lo + 1 + s.lo;
+        r->hi = init.hi;
+        break;
+    case OP_I32_LT_S: case OP_I32_LT_U:
+        if (s.hi >= 0) return 0;
+        r->lo = init.lo < n.lo + s.lo ? init.lo : n.lo + s.lo;
+        r->hi = init.hi;
+        break;
+    default:
+        return 0;
+    }
+    if (pos > next_live(o, c) && pos < st.set) {
+        int64_t lim = op <= OP_I32_LT_U ? n.lo : op <= OP_I32_GT_U ? n.hi : op <= OP_I32_LE_U ? n.lo + 1 : n.hi - 1;
+        if (s.lo > 0 && lim < r->hi) r->hi = lim;
+        if (s.hi < 0 && lim > r->lo) r->lo = lim;
+    }
+    /* Unsigned compares agree with signed ones on non-negative values */
+    if ((op & 1) != (OP_I32_LT_S & 1) && (init.lo < 0 || n.lo < 0 || r->lo < 0)) return 0;
+    return r->lo >= INT32_MIN && r->hi <= INT32_MAX;
+}
+
+/* Range of local x just before position pos */
+static int local_range(Opt *o, int pos, int x, Range *r, int d) {
+    for (int L = loop_around(o, pos); L >= 0; L = loop_around(o, L)) {
+        int w;
+        if (writes_of(o, L, x, &w)) return iv_range(o, L, x, pos, r, d);
+    }
+    return 0;
+}
+
+/* Range of the i32 value instruction j pushes */
+static int val_range(Opt *o, int j, Range *r, int d) {
+    Range a, b;
+    if (d > RANGE_DEPTH || j < 0) return 0;
+    OIns *in = &o->ins[j];
+    switch (in->op) {
+    case OP_I32_CONST:
+        r->lo = r->hi = (int32_t)in->imm;
+        return 1;
+    case OP_LOCAL_GET:
+        return o->ltype[in->imm] == WASM_I32 && local_range(o, j, (int)in->imm, r, d + 1);
+    case OP_I32_ADD: case OP_I32_SUB: case OP_I32_MUL: case OP_I32_SHL:
+        if (!val_range(o, producer(o, j, 1), &a, d + 1) || !val_range(o, producer(o, j, 0), &b, d + 1))
+            return 0;
+        break;
+    default:
+        return 0;
+    }
+    switch (in->op) {
+    case OP_I32_ADD: r->lo = a.lo + b.lo; r->hi = a.hi + b.hi; break;
+    case OP_I32_SUB: r->lo = a.lo - b.hi; r->hi = a.hi - b.lo; break;
+    default: {
+        if (in->op == OP_I32_SHL) {
+            if (b.lo != b.hi || b.lo < 0 || b.lo > 30) return 0;
+            b.lo = b.hi = (int64_t)1 << b.lo;
+        }
+        int64_t p[4] = { a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi };
+        r->lo = r->hi = p[0];
+        for (int k = 1; k < 4; k++) {
+            if (p[k] < r->lo) r->lo = p[k];
+            if (p[k] > r->hi) r->hi = p[k];
+        }
+        break;
+    }
+    }
+    return r->lo >= INT32_MIN && r->hi <= INT32_MAX;
+}
+
+/* --- Invariant code motion --- */
+
+/* What the loop opened at L stores to: per-local store counts and the
+ * globals set. Returns 1 if it calls an import, 2 a user function (or
+ * both), 4 if it copies or fills memory */
+static int loop_writes(Opt *o, int L, int *nw, uint8_t *gw) {
+    int calls = 0;
+    memset(nw, 0, o->nloc * sizeof(int));
+    memset(gw, 0, o->ngtype);
+    for (int i = L + 1; i < o->match[L]; i++) {
+        OIns *in = &o->ins[i];
+        if (in->op == OP_LOCAL_SET || in->op == OP_LOCAL_TEE) nw[in->imm]++;
+        else if (in->op == OP_GLOBAL_SET && in->imm < o->ngtype) gw[in->imm] = 1;
+        else if (in->op == OP_CALL) calls |= in->imm < IMP_COUNT ? 1 : 2;
+        else if (in->op == OPX_COPY || in->op == OPX_FILL) calls |= 4;
+    }
+    return calls;
+}
+
+/* The bytes every store in the loop at L may write, as *n ranges in
+ * *out (caller frees); 0 if some store's address isn't known */
+static int loop_stores(Opt *o, int L, Range **out, int *n) {
+    int k = 0, cap = 0;
+    Range *v = NULL;
+    for (int i = L + 1; i < o->match[L]; i++) {
+        Range r;
+        if (o->ins[i].op < 0x36 || o->ins[i].op > 0x3E) continue;
+        if (!val_range(o, producer(o, i, 1), &r, 0)) { cw_free(v); return 0; }
+        if (k == cap) {
+            cap = cap ? cap * 2 : 8;
+            Range *nv = (Range *)cw_realloc(v, cap * sizeof(Range));
+            if (!nv) { cw_free(v); o->bad = 1; return 0; }
+            v = nv;
+        }
+        v[k].lo = r.lo + o->ins[i].imm;
+        v[k++].hi = r.hi + o->ins[i].imm + mem_width(o->ins[i].op) - 1;
+    }
+    *out = v; *n = k;
+    return 1;
+}
+
+/* Compute v into a new local in the preheader of the loop at L */
+static int hoist(Opt *o, int L, const SVal *v) {
+    int t = new_local(o, v->t);
+    if (t < 0) return 0;
+    for (int j = v->start; j <= v->prod; j++)
+        if (o->ins[j].op != OPX_DEAD) queue_ins(o, L, o->ins[j]);
+    queue_ins(o, L, (OIns){ OP_LOCAL_SET, 0, -1, t });
+    kill_range(o, v->start, v->prod - 1);
+    o->ins[v->prod] = (OIns){ OP_LOCAL_GET, 0, -1, t };
+    return 1;
+}
+
+static int pass_licm(Opt *o) {
+    Stk s;
+    int ch = 0;
+    if (!sim_init(o, &s)) return 0;
+    int *nw = (int *)cw_malloc((8 + CW_MAX_LOCALS) * sizeof(int));
+    uint8_t *gw = (uint8_t *)cw_malloc(o->ngtype + 1);
+    if (!nw || !gw) { o->bad = 1; goto done; }
+    /* Outer loops first: what they can't move, an inner loop still may */
+    for (int L = 0; L < o->n; L++) {
+        if (o->ins[L].op != OP_LOOP) continue;
+        int E = o->match[L];
+        int calls = loop_writes(o, L, nw, gw);
+        Range *st = NULL;
+        int nst = -1;                   /* store ranges, once a load asks */
+        for (int b = o->bb_of[L + 1]; b < o->nbb && o->bb_start[b] < E; b++) {
+            s.sp = 0;
+            for (int i = o->bb_start[b]; i < o->bb_start[b + 1]; i++) {
+                OIns *in = &o->ins[i];
+                if (in->op == OPX_DEAD) continue;
+                int np, npush; uint8_t rt;
+                SVal v[3], r = sv_unknown();
+                OpInfo oi;
+                effect(o, in, &np, &npush, &rt);
+                if (np > 3) { s.sp = s.sp > np ? s.sp - np : 0; np = 0; }
+                spop(&s, v, np);
+                r.t = rt;
+                int x = (int)in->imm;
+                int is_num = num_info(in->op, &oi);
+                /* pure: invariant and free to move */
+                if (in->op == OP_LOCAL_GET) {
+                    r.pure = !nw[x];
+                } else if (in->op == OP_GLOBAL_GET) {
+                    r.pure = !gw[x] && !(calls & (x >= 2 ? 2 : 3));
+                    r.cost = 1;
+                } else if (is_num && oi.kind == OK_LOAD) {
+                    OIns *a = v[0].start == v[0].prod && v[0].prod >= 0 ? &o->ins[v[0].prod] : NULL;
+                    int64_t lo = a && a->op == OP_I32_CONST ? (uint32_t)a->imm + in->imm : -1;
+                    if (lo >= 0 && lo + mem_width(in->op) <= data_len && !calls) {
+                        if (nst < 0 && !loop_stores(o, L, &st, &nst)) nst = -2;
+                        r.pure = nst >= 0;
+                        for (int k = 0; r.pure && k < nst; k++)
+                            if (st[k].lo < lo + mem_width(in->op) && st[k].hi >= lo) r.pure = 0;
+                        r.cost = 1;
+                    }
+                } else if (in->op == OP_SELECT || (is_num && !oi.trap && oi.kind != OK_STORE)) {
+                    r.pure = 1;
+                    r.cost = np > 0;
+                    for (int j = 0; j < np; j++) { r.pure &= v[j].pure; r.cost += v[j].cost; }
+                    if (in->op == OP_SELECT) r.t = v[0].t ? v[0].t : v[1].t;
+                }
+                if (r.pure) {
+                    r.start = run_of(o, v, np, i);
+                    r.prod = i;
+                    r.pure = r.start >= 0 && r.t;
+                }
+                if (!r.pure)
+                    for (int j = 0; j < np; j++)
+                        if (v[j].pure && v[j].cost > 0 && hoist(o, L, &v[j])) ch = 1;
+                if (npush) spush(&s, r);
+            }
+        }
+        cw_free(st);
+    }
+done:
+    cw_free(nw); cw_free(gw);
+    return ch;
+}
+
+/* --- Strength reduction --- */
+
+/* An i32 value m*x + c (+ inv), wrapping, in counter x of the loop */
+typedef struct {
+    int start, prod;        /* the run computing it, as for SVal */
+    uint8_t ok;             /* affine in x */
+    uint32_t m, c;
+    int inv;                /* a local the loop doesn't write, or -1 */
+    int cost;               /* wasm3 ops it takes */
+} AVal;
+
+/* Occurrences with the same m, c and inv share one pointer local */
+typedef struct { uint32_t m, c; int inv, cost, t; } IvGroup;
+
+#define IV_MAX_GROUPS 8
+#define IV_MAX_USES   32
+
+static AVal av_unknown(void) {
+    AVal u;
+    memset(&u, 0, sizeof(u));
+    u.start = u.prod = u.inv = -1;
+    return u;
+}
+
+/* The affine value instruction i computes from operands v[0..np) */
+static AVal av_combine(Opt *o, int i, const AVal *v, int np, int x, const int *nw) {
+    OIns *in = &o->ins[i];
+    AVal r = av_unknown();
+    const AVal *a = &v[0], *b = &v[1];
+    switch (in->op) {
+    case OP_I32_CONST:
+        r.c = (uint32_t)in->imm;
+        break;
+    case OP_LOCAL_GET:
+        if (in->imm == x) r.m = 1;
+        else if (o->ltype[in->imm] == WASM_I32 && !nw[in->imm]) r.inv = (int)in->imm;
+        else return r;
+        break;
+    case OP_I32_ADD:
+        if (!a->ok || !b->ok || (a->inv >= 0 && b->inv >= 0)) return r;
+        r.m = a->m + b->m; r.c = a->c + b->c;
+        r.inv = a->inv >= 0 ? a->inv : b->inv;
+        break;
+    case OP_I32_SUB:
+        if (!a->ok || !b->ok || b->inv >= 0) return r;
+        r.m = a->m - b->m; r.c = a->c - b->c; r.inv = a->inv;
+        break;
+    case OP_I32_MUL: case OP_I32_SHL: {
+        if (!a->ok || !b->ok) return r;
+        if (in->op == OP_I32_MUL && !a->m && a->inv < 0) { const AVal *t = a; a = b; b = t; }
+        if (b->m || b->inv >= 0) return r;
+        uint32_t k = in->op == OP_I32_SHL ? 1u << (b->c & 31) : b->c;
+        if (a->inv >= 0 && k != 1) return r;
+        r.m = a->m * k; r.c = a->c * k; r.inv = a->inv;
+        break;
+    }
+    default:
+        return r;
+    }
+    r.start = i;
+    for (int j = 0; j < np; j++) {
+        if (v[j].start < 0 || !gap_dead(o, v[j].prod, j + 1 < np ? v[j + 1].start : i)) return av_unknown();
+        r.cost += v[j].cost;
+    }
+    if (np) { r.start = v[0].start; r.cost++; }
+    r.prod = i;
+    r.ok = 1;
+    return r;
+}
+
+/* x is read on leaving the loop at L */
+static int live_on_exit(Opt *o, int L, int x, const uint64_t *lin, int W) {
+    int E = o->match[L];
+    for (int b = o->bb_of[L + 1]; b < o->nbb && o->bb_start[b] <= E; b++) {
+        int sb[2], ns = succs(o, b, sb);
+        for (int j = 0; j < ns; j++) {
+            if (sb[j] >= o->nbb) continue;
+            int at = o->bb_start[sb[j]];
+            if ((at <= L || at > E) && BIT(lin + (size_t)sb[j] * W, x)) return 1;
+        }
+    }
+    return 0;
+}
+
+/* Reduce the derived values of counter x in the loop at L; returns 1 if
+ * anything changed */
+static int reduce_iv(Opt *o, int L, int x, const int *nw, const uint64_t *lin, int W) {
+    IvStep st;
+    IvGroup g[IV_MAX_GROUPS];
+    int ustart[IV_MAX_USES], uprod[IV_MAX_USES], ugrp[IV_MAX_USES];
+    int ng = 0, nu = 0, gets = 0, used_gets = 0, E = o->match[L];
+    if (!find_step(o, L, x, &st)) return 0;
+
+    /* Occurrences: maximal affine values that aren't x itself */
+    AVal *stk = (AVal *)cw_malloc((o->n + 4) * sizeof(AVal));
+    if (!stk) { o->bad = 1; return 0; }
+    for (int b = o->bb_of[L + 1]; b < o->nbb && o->bb_start[b] < E; b++) {
+        int sp = 0;
+        for (int i = o->bb_start[b]; i < o->bb_start[b + 1]; i++) {
+            OIns *in = &o->ins[i];
+            if (in->op == OPX_DEAD) continue;
+            int np, npush; uint8_t rt;
+            AVal v[3];
+            effect(o, in, &np, &npush, &rt);
+            if (in->op == OP_LOCAL_GET && in->imm == x) gets++;
+            if (np > 3) { sp = sp > np ? sp - np : 0; np = 0; }
+            for (int j = np - 1; j >= 0; j--) v[j] = sp ? stk[--sp] : av_unknown();
+            AVal r = av_combine(o, i, v, np, x, nw);
+            if (!r.ok && i != st.set) {
+                for (int j = 0; j < np; j++) {
+                    if (!v[j].ok || !v[j].m || v[j].cost < 1) continue;
+                    int k = 0;
+                    while (k < ng && (g[k].m != v[j].m || g[k].c != v[j].c || g[k].inv != v[j].inv)) k++;
+                    if (k == IV_MAX_GROUPS || nu == IV_MAX_USES) goto out;
+                    if (k == ng) {
+                        g[ng].m = v[j].m; g[ng].c = v[j].c; g[ng].inv = v[j].inv;
+                        g[ng].cost = 0; ng++;
+                    }
+                    g[k].cost += v[j].cost;
+                    ustart[nu] = v[j].start; uprod[nu] = v[j].prod; ugrp[nu++] = k;
+                    for (int q = v[j].start; q <= v[j].prod; q++)
+                        if (o->ins[q].op == OP_LOCAL_GET && o->ins[q].imm == x) used_gets++;
+                }
+            }
+            if (npush && sp < o->n) stk[sp++] = r;
+        }
+    }
+    cw_free(stk);
+    if (!ng) return 0;
+
+    /* Keep x, paying 2 ops per iteration for each pointer's step, or drop
+     * it, which saves x's own step but needs every group and a test that
+     * can move onto one of them */
+    int keep_gain = 0, drop_gain = 2, lftr = -1, tget, tbound;
+    int64_t e_val = 0;
+    for (int k = 0; k < ng; k++) {
+        if (g[k].cost > 2) keep_gain += g[k].cost - 2;
+        drop_gain += g[k].cost - 2;
+    }
+    int cmp = exit_test(o, L, &tget, &tbound);
+    Range rx;
+    if (cmp >= 0 && o->ins[tget].imm == x && o->ins[tbound].op == OP_I32_CONST
+        && gets == used_gets + 2 && !live_on_exit(o, L, x, lin, W) && iv_range(o, L, x, -1, &rx, 0)) {
+        int uns = o->ins[cmp].op & 1;
+        int64_t n = (int32_t)o->ins[tbound].imm;
+        for (int k = 0; k < ng && lftr < 0; k++) {
+            int64_t m = (int32_t)g[k].m, c = (int32_t)g[k].c;
+            if (g[k].inv >= 0 || m <= 0 || m > 0x7FFFFFFF) continue;
+            int64_t lo = m * rx.lo + c, hi = m * rx.hi + c, e = m * n + c;
+            if (lo < (uns ? 0 : INT32_MIN) || hi > INT32_MAX || e < (uns ? 0 : INT32_MIN) || e > INT32_MAX)
+                continue;
+            lftr = k;
+            e_val = e;
+        }
+    }
+    int drop = lftr >= 0 && drop_gain > 0 && drop_gain >= keep_gain;
+    if (!drop && keep_gain <= 0) return 0;
+    if (o->nlocals + ng + 1 > CW_MAX_LOCALS) return 0;
+
+    /* Pointers, set up in the preheader and stepped right after x */
+    int sm = -1;
+    OIns sv = o->ins[st.step];
+    for (int k = 0; k < ng; k++) {
+        g[k].t = -1;
+        if (!drop && g[k].cost <= 2) continue;
+        g[k].t = new_local(o, WASM_I32);
+        queue_ins(o, L, (OIns){ OP_LOCAL_GET, 0, -1, x });
+        if (g[k].m != 1) {
+            queue_ins(o, L, (OIns){ OP_I32_CONST, 0, -1, i32_bits(g[k].m) });
+            queue_ins(o, L, (OIns){ OP_I32_MUL, 0, -1, 0 });
+        }
+        if (g[k].c) {
+            queue_ins(o, L, (OIns){ OP_I32_CONST, 0, -1, i32_bits(g[k].c) });
+            queue_ins(o, L, (OIns){ OP_I32_ADD, 0, -1, 0 });
+        }
+        if (g[k].inv >= 0) {
+            queue_ins(o, L, (OIns){ OP_LOCAL_GET, 0, -1, g[k].inv });
+            queue_ins(o, L, (OIns){ OP_I32_ADD, 0, -1, 0 });
+        }
+        queue_ins(o, L, (OIns){ OP_LOCAL_SET, 0, -1, g[k].t });
+        OIns inc = sv;
+        if (sv.op == OP_I32_CONST) {
+            inc.imm = i32_bits((uint32_t)sv.imm * g[k].m);
+        } else if (g[k].m != 1) {
+            /* a local step times m, once */
+            if (sm < 0) {
+                sm = new_local(o, WASM_I32);
+                queue_ins(o, L, sv);
+                queue_ins(o, L, (OIns){ OP_I32_CONST, 0, -1, i32_bits(g[k].m) });
+                queue_ins(o, L, (OIns){ OP_I32_MUL, 0, -1, 0 });
+                queue_ins(o, L, (OIns){ OP_LOCAL_SET, 0, -1, sm });
+            }
+            inc = (OIns){ OP_LOCAL_GET, 0, -1, sm };
+        }
+        queue_ins(o, st.set + 1, (OIns){ OP_LOCAL_GET, 0, -1, g[k].t });
+        queue_ins(o, st.set + 1, inc);
+        queue_ins(o, st.set + 1, o->ins[st.op]);
+        queue_ins(o, st.set + 1, (OIns){ OP_LOCAL_SET, 0, -1, g[k].t });
+    }
+    for (int u = 0; u < nu; u++) {
+        int t = g[ugrp[u]].t;
+        if (t < 0) continue;
+        kill_range(o, ustart[u], uprod[u] - 1);
+        o->ins[uprod[u]] = (OIns){ OP_LOCAL_GET, 0, -1, t };
+    }
+    if (drop) {
+        kill_range(o, st.get, st.set);
+        o->ins[tget].imm = g[lftr].t;
+        set_const(&o->ins[tbound], WASM_I32, i32_bits((uint32_t)e_val));
+    }
+    return 1;
+out:
+    cw_free(stk);
+    return 0;
+}
+
+static int pass_ivs(Opt *o) {
+    int nb = o->nbb, W = (o->nloc + 63) / 64, ch = 0, done_to = -1;
+    if (!W) return 0;
+    int *nw = (int *)cw_malloc((8 + CW_MAX_LOCALS) * sizeof(int));
+    uint8_t *gw = (uint8_t *)cw_malloc(o->ngtype + 1);
+    uint64_t *lout = nw && gw ? live_out(o, W) : NULL;
+    if (!lout) { o->bad = 1; goto done; }
+    uint64_t *lin = lout + (size_t)3 * nb * W;
+    /* The new pointers aren't in the liveness sets, so once a loop is
+     * changed its inner loops wait for the next round */
+    for (int L = 0; L < o->n && !o->bad; L++) {
+        if (o->ins[L].op != OP_LOOP || L < done_to) continue;
+        int nloc = o->nloc;
+        loop_writes(o, L, nw, gw);
+        for (int x = 0; x < nloc; x++) {
+            if (nw[x] != 1 || !reduce_iv(o, L, x, nw, lin, W)) continue;
+            ch = 1;
+            done_to = o->match[L];
+            break;
+        }
+    }
+done:
+    cw_free(lout); cw_free(nw); cw_free(gw);
+    return ch;
+}
+
+/* ================================================================
+ *  Local slot coalescing (-O1)
+ *
+ *  Codegen gives every C local and temporary its own wasm local, and
+ *  wasm3 reserves frame space for each one on every call. Two locals of
+ *  the same type can share a slot when neither is written while the other
+ *  is live (Chaitin's interference rule; a plain copy a = b doesn't make
+ *  a and b interfere). Locals are then greedily packed into the lowest
+ *  free slot, parameters included once they are dead, preferring the slot
+ *  of the local they were copied from so the copy becomes a no-op that
+ *  pass_fold removes. Slots are laid out grouped by type.
+ *
+ *  Non-parameter locals start out as 0, so a local read before any write
+ *  on some path (live on entry) shares with no parameter and no other
+ *  local live on entry.
+ * ================================================================ */
+
+static int pass_coalesce(Opt *o) {
+    int nb = o->nbb, nloc = o->nloc, np = nloc - o->nlocals;
+    int W = (nloc + 63) / 64;
+    if (o->nlocals == 0) return 0;
+    uint64_t *lout = live_out(o, W);
+    if (!lout) return 0;
+    uint64_t *live = lout + (size_t)nb * W;
+    /* adj: interference rows; sadj: per slot, the union of its members' rows */
+    uint64_t *adj = (uint64_t *)cw_calloc((size_t)nloc * W * 2, sizeof(uint64_t));
+    int *map = (int *)cw_malloc((size_t)nloc * 4 * sizeof(int));
+    if (!adj || !map) { o->bad = 1; cw_free(lout); cw_free(adj); cw_free(map); return 0; }
+    uint64_t *sadj = adj + (size_t)nloc * W;
+    int *pref = map + nloc, *used = pref + nloc, *order = used + nloc;
+    for (int x = 0; x < nloc; x++) { map[x] = -1; pref[x] = -1; used[x] = x < np; }
+
+#define INTERFERE(a, b) (SETB(adj + (size_t)(a) * W, b), SETB(adj + (size_t)(b) * W, a))
+    for (int b = 0; b < nb; b++) {
+        memcpy(live, lout + (size_t)b * W, W * sizeof(uint64_t));
+        for (int i = o->bb_start[b + 1] - 1; i >= o->bb_start[b]; i--) {
+            OIns *in = &o->ins[i];
+            int x = (int)in->imm;
+            if (in->op == OP_LOCAL_GET) {
+                SETB(live, x);
+                used[x] = 1;
+            } else if (in->op == OP_LOCAL_SET || in->op == OP_LOCAL_TEE) {
+                int src = -1, j = i - 1;
+                while (j >= o->bb_start[b] && o->ins[j].op == OPX_DEAD) j--;
+                if (j >= o->bb_start[b] && o->ins[j].op == OP_LOCAL_GET) {
+                    src = (int)o->ins[j].imm;
+                    if (pref[x] < 0) pref[x] = src;
+                }
+                for (int w = 0; w < W; w++) {
+                    uint64_t m = live[w];
+                    while (m) {
+                        int y = w * 64 + __builtin_ctzll(m);
+                        m &= m - 1;
+                        if (y != x && y != src) INTERFERE(x, y);
+                    }
+                }
+                CLRB(live, x);
+                used[x] = 1;
+            }
+        }
+        if (b == 0) {
+            /* live is now what's live on entry: params hold their
+             * arguments, every other local 0 */
+            for (int x = 0; x < nloc; x++) {
+                if (!BIT(live, x)) continue;
+                for (int y = 0; y < nloc; y++)
+                    if (y != x && (BIT(live, y) || (x >= np && y < np))) INTERFERE(x, y);
+            }
+        }
+    }
+#undef INTERFERE
+
+    /* Parameters keep their slots; each local takes its copy source's slot
+     * if it can, else the lowest compatible one */
+    int nslots = np;
+    for (int x = 0; x < np; x++) {
+        map[x] = x;
+        memcpy(sadj + (size_t)x * W, adj + (size_t)x * W, W * sizeof(uint64_t));
+    }
+    for (int x = np; x < nloc; x++) {
+        if (!used[x]) continue;
+        int s = -1, p = pref[x] >= 0 ? map[pref[x]] : -1;
+        if (p >= 0 && o->ltype[p < np ? p : order[p]] == o->ltype[x]
+            && !BIT(sadj + (size_t)p * W, x))
+            s = p;
+        for (int c = 0; s < 0 && c < nslots; c++)
+            if (o->ltype[c < np ? c : order[c]] == o->ltype[x] && !BIT(sadj + (size_t)c * W, x))
+                s = c;
+        if (s < 0) { s = nslots++; order[s] = x; }
+        map[x] = s;
+        uint64_t *row = adj + (size_t)x * W, *srow = sadj + (size_t)s * W;
+        for (int w = 0; w < W; w++) srow[w] |= row[w];
+    }
+
+    /* New slots, grouped by type in order of first use */
+    static const uint8_t tord[4] = { WASM_I32, WASM_I64, WASM_F32, WASM_F64 };
+    int *renum = used;          /* slot -> final index, reusing used[] */
+    int k = np;
+    for (int t = 0; t < 4; t++)
+        for (int c = np; c < nslots; c++)
+            if (o->ltype[order[c]] == tord[t]) renum[c] = k++;
+    for (int c = 0; c < np; c++) renum[c] = c;
+
+    int ch = k != nloc;
+    for (int x = np; x < nloc; x++)
+        if (map[x] >= 0 && renum[map[x]] != x) ch = 1;
+    if (ch) {
+        uint8_t nt[8 + CW_MAX_LOCALS];
+        memcpy(nt, o->ltype, np);
+        for (int c = np; c < nslots; c++) nt[renum[c]] = o->ltype[order[c]];
+        for (int i = 0; i < o->n; i++) {
+            OIns *in = &o->ins[i];
+            if (in->op == OP_LOCAL_GET || in->op == OP_LOCAL_SET || in->op == OP_LOCAL_TEE)
+                in->imm = renum[map[in->imm]];
+        }
+        memcpy(o->ltype, nt, k);
+        o->nloc = k;
+        o->nlocals = k - np;
+    }
+    cw_free(lout); cw_free(adj); cw_free(map);
+    return ch;
+}
+
+/* ================================================================
+ *  Driver
+ * ================================================================ */
+
+static int run_pass(Opt *o, int (*pass)(Opt *)) {
+    if (o->bad || !scan_structure(o)) return 0;
+    int ch = pass(o);
+    if (ch && !o->bad) compact(o);
+    return ch && !o->bad;
+}
+
+/* wasm3 (32-bit slots) gives each i32/f32 local 4 bytes, i64/f64 8 */
+static int frame_bytes(const uint8_t *t, int n) {
+    int k = 0;
+    for (int i = 0; i < n; i++) k += t[i] == WASM_I64 || t[i] == WASM_F64 ? 8 : 4;
+    return k;
+}
+
+static int count_live(Opt *o) {
+    int k = 0;
+    for (int i = 0; i < o->n; i++) k += o->ins[i].op != OPX_DEAD;
+    return k;
+}
+
+/* Decode f into o; 0 (with o still safe to close) if it can't be */
+static int opt_open(Opt *o, FuncCtx *f) {
+    memset(o, 0, sizeof(*o));
+    o->f = f;
+    o->nloc = f->nparams + f->nlocals;
+    o->nlocals = f->nlocals;
+    memcpy(o->ltype, f->param_wasm_types, f->nparams);
+    memcpy(o->ltype + f->nparams, f->local_types, f->nlocals);
+
+    o->ngtype = nglobals;
+    o->gtype = (uint8_t *)cw_malloc(nglobals ? nglobals : 1);
+    if (!o->gtype) return 0;
+    for (int g = 0; g < nglobals; g++) o->gtype[g] = WASM_I32;
+    for (int i = 0; i < nsym; i++)
+        if (syms[i].kind == SYM_GLOBAL && syms[i].idx >= 0 && syms[i].idx < nglobals)
+            o->gtype[syms[i].idx] = ctype_to_wasm(syms[i].ctype);
+    return decode(o) && !o->bad;
+}
+
+static void opt_close(Opt *o) {
+    cw_free(o->ins);
+    cw_free(o->gtype);
+    cw_free(o->match); cw_free(o->else_of); cw_free(o->target);
+    cw_free(o->bb_of); cw_free(o->bb_start);
+    cw_free(o->sv);
+    cw_free(o->q_ins); cw_free(o->q_at);
+    memset(o, 0, sizeof(*o));
+}
+
+static void optimize(Opt *o) {
+    for (int iter = 0; iter < OPT_MAX_ITERS && !o->bad; iter++) {
+        int ch = 0;
+        ch |= run_pass(o, pass_propagate);
+        ch |= run_pass(o, pass_fold);
+        ch |= run_pass(o, pass_structure);
+        ch |= run_pass(o, pass_dead_loads);
+        if (opt_level >= 2) {
+            ch |= run_pass(o, pass_cse);
+            ch |= run_pass(o, pass_dead_globals);
+            ch |= run_pass(o, pass_dead_locals);
+            ch |= run_pass(o, pass_licm);
+            ch |= run_pass(o, pass_ivs);
+        }
+        if (!ch) break;
+    }
+    /* Coalescing turns copies into self-copies; clean those up */
+    if (run_pass(o, pass_coalesce)) {
+        for (int iter = 0; iter < OPT_MAX_ITERS && !o->bad; iter++) {
+            int ch = run_pass(o, pass_fold);
+            if (opt_level >= 2) ch |= run_pass(o, pass_dead_locals);
+            if (!ch) break;
+        }
+    }
+}
+
+/* Which user globals no function ever stores to. They aren't exported, so
+ * nothing else can change them either (a static array's base address is
+ * the usual one). */
+void opt_scan_globals(void) {
+    int ng = nglobals < MAX_SYMS + 2 ? nglobals : MAX_SYMS + 2;
+    memset(gfixed, 0, sizeof(gfixed));
+    for (int i = 0; i < nsym; i++) {
+        const Symbol *s = &syms[i];
+        if (s->kind != SYM_GLOBAL || s->idx < 2 || s->idx >= ng) continue;
+        uint8_t t = ctype_to_wasm(s->ctype);
+        gfixed[s->idx] = t;
+        gfixed_bits[s->idx] = t == WASM_F64 ? f64_bits(s->init_dval)
+                            : t == WASM_F32 ? f32_bits(s->init_fval)
+                            : t == WASM_I64 ? s->init_llval : (int64_t)s->init_ival;
+    }
+    for (int i = 0; i < nfuncs; i++) {
+        Opt o;
+        if (!opt_open(&o, &func_bufs[i])) memset(gfixed, 0, sizeof(gfixed));
+        for (int j = 0; j < o.n; j++)
+            if (o.ins[j].op == OP_GLOBAL_SET && o.ins[j].imm < ng) gfixed[o.ins[j].imm] = 0;
+        opt_close(&o);
+    }
+}
+
+void opt_function(FuncCtx *f) {
+    Opt o;
+    if (opt_open(&o, f)) {
+        int before = o.n, locals_before = f->nlocals;
+        int frame_before = frame_bytes(f->local_types, f->nlocals);
+        optimize(&o);
+        if (!o.bad) {
+            encode(&o);
+            opt_stats.ins_before += before;
+            opt_stats.ins_after += count_live(&o);
+            opt_stats.locals_before += locals_before;
+            opt_stats.locals_after += f->nlocals;
+            opt_stats.frame_before += frame_before;
+            opt_stats.frame_after += frame_bytes(f->local_types, f->nlocals);
+        }
+    }
+    opt_close(&o);
+}
+
+/* ================================================================
+ *  Inlining (-O2)
+ *
+ *  A call to a small static function becomes a block holding a copy of the
+ *  callee's body: the arguments are stored into fresh locals (its
+ *  parameters), its own locals are zeroed the way a call would find them,
+ *  and each return becomes a branch out of the block. That saves wasm3's
+ *  call setup and the m3_Yield check every call makes, and lets the passes
+ *  above see through the helper (constant arguments fold, the zeroing and
+ *  argument copies mostly disappear, locals coalesce with the caller's).
+ *
+ *  Every function is optimized first, so callees are sized as they will
+ *  end up. Only callees that make no calls to other user functions are
+ *  inlined, so recursion can't happen; rounds repeat, so a helper whose own
+ *  helpers were inlined qualifies in the next one. The callee itself stays
+ *  in the module. Growth is capped per module.
+ * ================================================================ */
+
+#define INLINE_MAX_INS      40      /* size limit for a static callee */
+#define INLINE_MAX_INS_HINT 120     /* ... for one declared inline */
+#define INLINE_GROWTH_PCT   25      /* module may grow by this much */
+#define INLINE_MIN_GROWTH   200     /* ... or by this many instructions */
+#define INLINE_ROUNDS       4
+
+static const Symbol *func_sym(int fi) {
+    for (int i = 0; i < nsym; i++)
+        if (syms[i].kind == SYM_FUNC && syms[i].idx == IMP_COUNT + fi) return &syms[i];
+    return NULL;
+}
+
+/* Instructions one call site of callee c adds */
+static int inline_cost(const Opt *c) {
+    return (c->n - 1) + c->nloc + c->nlocals + 1;
+}
+
+/* Constant argument k of the call at i, if it can move down to the call */
+static int const_arg(Opt *o, int i, int np, int k) {
+    int j = producer(o, i, np - 1 - k);
+    return j >= 0 && o->ins[j].op >= OP_I32_CONST && o->ins[j].op <= OP_F64_CONST ? j : -1;
+}
+
+static int inline_calls(Opt *o, Opt *fo, const int *ok, int budget) {
+    int ncalls = 0, ninl = 0, extra = 0, nlocals = o->nlocals;
+    for (int i = 0; i < o->n; i++) {
+        OIns *in = &o->ins[i];
+        if (in->op != OP_CALL) continue;
+        int c = (int)in->imm - IMP_COUNT;
+        if (c >= 0 && ok[c] && &fo[c] != o && inline_cost(&fo[c]) <= budget - extra
+            && nlocals + fo[c].nloc <= CW_MAX_LOCALS) {
+            extra += inline_cost(&fo[c]);
+            nlocals += fo[c].nloc;
+            in->tee = c;    /* marks the call to inline */
+            ninl++;
+        }
+    }
+    if (!ninl || !scan_structure(o)) return 0;
+
+    /* Constant arguments are re-emitted beside their parameter's local.set:
+     * left below the inlined block they would hide from propagation */
+    for (int i = 0; i < o->n; i++) {
+        OIns *in = &o->ins[i];
+        if (in->op != OP_CALL || in->tee < 0) continue;
+        int np = fo[in->tee].nloc - fo[in->tee].nlocals;
+        for (int k = 0; k < np; k++) {
+            int j = const_arg(o, i, np, k);
+            if (j >= 0) o->ins[j].tee = -2;
+        }
+    }
+
+    OIns *out = (OIns *)cw_malloc((size_t)(o->n + extra) * sizeof(OIns));
+    if (!out) { o->bad = 1; return 0; }
+    int n = 0;
+    for (int i = 0; i < o->n; i++) {
+        OIns *in = &o->ins[i];
+        if (in->tee == -2) continue;    /* sunk constant argument */
+        if (in->op != OP_CALL || in->tee < 0) { out[n++] = *in; continue; }
+        Opt *c = &fo[in->tee];
+        int base = o->nloc, np = c->nloc - c->nlocals, depth = 0;
+        memcpy(o->ltype + base, c->ltype, c->nloc);
+        o->nloc += c->nloc;
+        o->nlocals += c->nloc;
+        for (int k = np - 1; k >= 0; k--) {
+            int j = const_arg(o, i, np, k);
+            if (j >= 0) { out[n] = o->ins[j]; out[n++].tee = -1; }
+            out[n++] = (OIns){ OP_LOCAL_SET, 0, -1, base + k };
+        }
+        for (int k = np; k < c->nloc; k++) {
+            set_const(&out[n], c->ltype[k], 0);
+            out[n].tee = -1;
+            n++;
+            out[n++] = (OIns){ OP_LOCAL_SET, 0, -1, base + k };
+        }
+        CType rt = c->f->return_type;
+        out[n++] = (OIns){ OP_BLOCK, rt == CT_VOID ? WASM_VOID : ctype_to_wasm(rt), -1, 0 };
+        for (int j = 0; j < c->n - 1; j++) {
+            OIns x = c->ins[j];
+            x.tee = -1;
+            if (is_opener(x.op)) depth++;
+            else if (x.op == OP_END) depth--;
+            else if (x.op == OP_RETURN) { x.op = OP_BR; x.imm = depth; }
+            else if (x.op == OP_LOCAL_GET || x.op == OP_LOCAL_SET || x.op == OP_LOCAL_TEE)
+                x.imm += base;
+            out[n++] = x;
+        }
+        out[n++] = (OIns){ OP_END, 0, -1, 0 };
+    }
+    for (int i = 0; i < n; i++) ncalls += out[i].op == OP_CALL;
+    if (ncalls > CW_MAX_FIXUPS) { cw_free(out); o->bad = 1; return 0; }
+    cw_free(o->ins);
+    o->ins = out;
+    o->n = o->cap = n;
+    return ninl;
+}
+
+void opt_inline(void) {
+    if (nfuncs < 2) return;
+    Opt *fo = (Opt *)cw_calloc(nfuncs, sizeof(Opt));
+    int *ok = (int *)cw_calloc(nfuncs * 2, sizeof(int));    /* + decoded[] */
+    if (!fo || !ok) { cw_free(fo); cw_free(ok); return; }
+    int *decoded = ok + nfuncs;
+    OptStats orig, now;
+    memset(&orig, 0, sizeof(orig));
+    for (int i = 0; i < nfuncs; i++) {
+        if (opt_open(&fo[i], &func_bufs[i])) {
+            orig.ins_before += fo[i].n;
+            orig.locals_before += fo[i].nlocals;
+            orig.frame_before += frame_bytes(fo[i].ltype + fo[i].nloc - fo[i].nlocals, fo[i].nlocals);
+            optimize(&fo[i]);
+            if (!fo[i].bad) encode(&fo[i]);
+        }
+        opt_close(&fo[i]);
+    }
+    int budget = -1;
+    for (int round = 0; round <= INLINE_ROUNDS; round++) {
+        int any = 0;
+        memset(&now, 0, sizeof(now));
+        for (int i = 0; i < nfuncs; i++) {
+            decoded[i] = opt_open(&fo[i], &func_bufs[i]);
+            if (!decoded[i]) continue;
+            now.ins_before += fo[i].n;
+            now.locals_before += fo[i].nlocals;
+            now.frame_before += frame_bytes(fo[i].ltype + fo[i].nloc - fo[i].nlocals, fo[i].nlocals);
+        }
+        if (round == INLINE_ROUNDS) break;
+        if (budget < 0) {
+            budget = now.ins_before * INLINE_GROWTH_PCT / 100;
+            if (budget < INLINE_MIN_GROWTH) budget = INLINE_MIN_GROWTH;
+        }
+        for (int i = 0; i < nfuncs; i++) {
+            const Symbol *s = func_sym(i);
+            int leaf = decoded[i];
+            for (int j = 0; leaf && j < fo[i].n; j++)
+                if (fo[i].ins[j].op == OP_CALL && fo[i].ins[j].imm >= IMP_COUNT) leaf = 0;
+            ok[i] = leaf && s && s->is_static
+                    && fo[i].n - 1 <= (s->is_inline ? INLINE_MAX_INS_HINT : INLINE_MAX_INS);
+        }
+        for (int i = 0; i < nfuncs; i++) {
+            if (!decoded[i]) continue;
+            /* Charged what the caller grew by once the copies are cleaned up */
+            int was = fo[i].n;
+            int k = inline_calls(&fo[i], fo, ok, budget);
+            if (k && !fo[i].bad) optimize(&fo[i]);
+            if (k && !fo[i].bad) {
+                budget -= fo[i].n - was;
+                encode(&fo[i]);
+                opt_stats.inlined += k;
+                any = 1;
+            }
+        }
+        for (int i = 0; i < nfuncs; i++) opt_close(&fo[i]);
+        if (!any) break;
+    }
+    for (int i = 0; i < nfuncs; i++) opt_close(&fo[i]);
+    /* opt_function() counts from here on; report against codegen's output */
+    opt_stats.ins_before += orig.ins_before - now.ins_before;
+    opt_stats.locals_before += orig.locals_before - now.locals_before;
+    opt_stats.frame_before += orig.frame_before - now.frame_before;
+    cw_free(fo);
+    cw_free(ok);
+}
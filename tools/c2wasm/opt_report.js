@@ -0,0 +1,66 @@
+#!/usr/bin/env node
+// Effect of -O1/-O2 on every program: instructions, locals and frame bytes,
+// summed over all functions, as c2wasm reports them. Compiles each
+// positive test and each example at -O1 and -O2 (the -O0 figures are the
+// "before" side of either report).
+//
+//   node opt_report.js [-l]      -l: locals and frame bytes as well
+
+const fs = require('fs');
+const path = require('path');
+const { execFileSync } = require('child_process');
+
+const root = __dirname;
+const full = process.argv.includes('-l');
+const c2wasm = path.join(root, 'c2wasm');
+const out = path.join(fs.mkdtempSync('/tmp/opt_report_'), 'out.wasm');
+process.on('exit', () => fs.rmSync(path.dirname(out), { recursive: true, force: true }));
+
+function sources(dir) {
+    return fs.readdirSync(dir)
+        .filter(f => f.endsWith('.c') && !f.startsWith('reject_'))
+        .sort()
+        .map(f => path.join(dir, f));
+}
+
+// "-O2: 241 -> 288 instructions, 12 -> 9 locals (48 -> 36 frame bytes)"
+function compile(file, level) {
+    let text;
+    try {
+        text = execFileSync(c2wasm, [level, file, '-o', out],
+                            { encoding: 'utf8', stdio: ['ignore', 'pipe', 'ignore'] });
+    } catch (e) {
+        return null;
+    }
+    const m = text.match(/-O\d: (\d+) -> (\d+) instructions, (\d+) -> (\d+) locals \((\d+) -> (\d+) frame bytes\)/);
+    if (!m) return null;
+    const n = m.slice(1).map(Number);
+    return { before: [n[0], n[2], n[4]], after: [n[1], n[3], n[5]] };
+}
+
+function cell(v) {
+    return full ? `${v[0]}/${v[1]}/${v[2]}`.padStart(14) : String(v[0]).padStart(7);
+}
+
+function report(title, files) {
+    const total = [[0, 0, 0], [0, 0, 0], [0, 0, 0]];
+    let count = 0;
+    console.log(`\n${title}`);
+    console.log('  ' + 'Program'.padEnd(24) + [' -O0', ' -O1', ' -O2'].map(h => h.padStart(full ? 14 : 7)).join('') +
+                '   -O2 vs -O0');
+    for (const f of files) {
+        const o1 = compile(f, '-O1');
+        const o2 = compile(f, '-O2');
+        if (!o1 || !o2) continue;
+        const row = [o1.before, o1.after, o2.after];
+        row.forEach((v, i) => v.forEach((x, j) => { total[i][j] += x; }));
+        count++;
+        const pct = row[0][0] ? ((row[2][0] - row[0][0]) * 100 / row[0][0]).toFixed(1) : '0.0';
+        console.log('  ' + path.basename(f).padEnd(24) + row.map(cell).join('') + `   ${pct.padStart(6)}%`);
+    }
+    const pct = ((total[2][0] - total[0][0]) * 100 / total[0][0]).toFixed(1);
+    console.log('  ' + `total (${count})`.padEnd(24) + total.map(cell).join('') + `   ${pct.padStart(6)}%`);
+}
+
+report('tools/wasm/examples', sources(path.join(root, '..', 'wasm', 'examples')));
+report('tools/c2wasm/test', sources(path.join(root, 'test')));
@@ -17,15 +17,15 @@ static int is_ident_start(int c) { return isalpha(c) || c == '_'; }
 #endif
 
 #define MAX_IFDEF_DEPTH 32
-static int ifdef_skip[MAX_IFDEF_DEPTH];
-static int ifdef_had_else[MAX_IFDEF_DEPTH];
-static int ifdef_taken[MAX_IFDEF_DEPTH];
-static int ifdef_depth;
-static int ifdef_overflow;  /* excess nesting beyond MAX_IFDEF_DEPTH */
+static CW_TLS int ifdef_skip[MAX_IFDEF_DEPTH];
+static CW_TLS int ifdef_had_else[MAX_IFDEF_DEPTH];
+static CW_TLS int ifdef_taken[MAX_IFDEF_DEPTH];
+static CW_TLS int ifdef_depth;
+static CW_TLS int ifdef_overflow;  /* excess nesting beyond MAX_IFDEF_DEPTH */
 
-static int api_registered;
-static int pp_macro_eval_depth;
-static int pp_predefined_counter;
+static CW_TLS int api_registered;
+static CW_TLS int pp_macro_eval_depth;
+static CW_TLS int pp_predefined_counter;
 
 /* ---- Include file/line tracking ---- */
 #define MAX_INCLUDE_DEPTH 8
@@ -36,10 +36,10 @@ typedef struct {
     int end_pos;        /* src_pos at which header content ends */
 } IncludeFrame;
 
-static IncludeFrame include_stk[MAX_INCLUDE_DEPTH];
-static int include_sp;
+static CW_TLS IncludeFrame include_stk[MAX_INCLUDE_DEPTH];
+static CW_TLS int include_sp;
 /* Heap-allocated src_file strings for include frames (freed on pop) */
-static char *include_file_strs[MAX_INCLUDE_DEPTH];
+static CW_TLS char *include_file_strs[MAX_INCLUDE_DEPTH];
 
 void preproc_init(void) {
     ifdef_depth = 0;
@@ -188,6 +188,9 @@ static const ApiFunc api_funcs[] = {
     {"file_readln",     IMP_FILE_READLN,     CT_INT,   3, {CT_INT,CT_INT,CT_INT}},
     {"file_readln_str", IMP_FILE_READLN_STR, CT_INT,   1, {CT_INT}},
     {"file_writeln",    IMP_FILE_WRITELN,    CT_INT,   2, {CT_INT,CT_INT}},
+    {"file_map",        IMP_FILE_MAP,        CT_INT,   3, {CT_INT,CT_INT,CT_INT}},
+    {"file_map_get",    IMP_FILE_MAP_GET,    CT_INT,   3, {CT_INT,CT_INT,CT_INT}},
+    {"file_unmap",      IMP_FILE_UNMAP,      CT_VOID,  1, {CT_INT}},
     {"file_stat",       IMP_FILE_STAT,       CT_INT,   2, {CT_INT,CT_INT}},
     {"file_delete",     IMP_FILE_DELETE,     CT_INT,   1, {CT_INT}},
     {"file_rename",     IMP_FILE_RENAME,     CT_INT,   2, {CT_INT,CT_INT}},
@@ -217,6 +220,8 @@ static const ApiFunc api_funcs[] = {
     {"calloc",          IMP_CALLOC,          CT_INT,    2, {CT_INT,CT_INT}},
     {"realloc",         IMP_REALLOC,         CT_INT,    2, {CT_INT,CT_INT}},
     {"get_epoch_ms",    IMP_GET_EPOCH_MS,    CT_LONG_LONG, 0, {}},
+    {"get_frame",       IMP_GET_FRAME,       CT_LONG_LONG, 0, {}},
+    {"get_frame_rate",  IMP_GET_FRAME_RATE,  CT_INT,   0, {}},
     {"get_uptime_ms",   IMP_GET_UPTIME_MS,   CT_LONG_LONG, 0, {}},
     {"get_last_comm_ms",IMP_GET_LAST_COMM_MS,CT_LONG_LONG, 0, {}},
     {"print_i64",       IMP_PRINT_I64,       CT_VOID,  1, {CT_LONG_LONG}},
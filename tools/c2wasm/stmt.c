@@ -4,12 +4,14 @@
 #include "c2wasm.h"
 
 static void parse_local_decl(CType base_type);
-static void parse_func_def(CType ret_type, const char *name, int is_static);
+static void parse_func_def(CType ret_type, const char *name, int is_static, int is_inline);
 
 /* Pop symbols down to given scope level */
 static void pop_scope(int target_scope) {
-    while (nsym > 0 && syms[nsym - 1].scope > target_scope)
-        nsym--;
+    int n = nsym;
+    while (n > 0 && syms[n - 1].scope > target_scope)
+        n--;
+    drop_syms(n);
 }
 
 /* ---- Constant integer expression evaluator (for case labels) ---- */
@@ -300,6 +302,24 @@ static void parse_global_array_initializer(Symbol *s, CType base_type, const int
     parse_global_array_init_level(s, base_type, dims, ndims, 0, 0);
 }
 
+/* char buf[size] = "...": copy the literal (terminator included when it
+ * fits) from the data section and zero the rest of the array. */
+static void emit_local_string_init(int local_idx, int size, const char *str, int len) {
+    int ncopy = (len + 1 < size) ? len + 1 : size;
+    emit_local_get(local_idx);
+    emit_i32_const(add_string(str, len));
+    emit_i32_const(ncopy);
+    emit_memory_copy();
+    if (size > ncopy) {
+        emit_local_get(local_idx);
+        emit_i32_const(ncopy);
+        emit_op(OP_I32_ADD);
+        emit_i32_const(0);
+        emit_i32_const(size - ncopy);
+        emit_memory_fill();
+    }
+}
+
 static void parse_local_array_init_level(int local_idx, CType base_type, int elem_size,
                                          const int *dims, int ndims,
                                          int level, int base_elem_index) {
@@ -360,10 +380,7 @@ static void parse_local_array_init_level(int local_idx, CType base_type, int ele
 /* ---- Statement parser ---- */
 
 void parse_stmt(void) {
-    if (tok != TOK_EOF) {
-        emit_i32_const(line_num);
-        emit_global_set(GLOBAL_LINE);
-    }
+    if (tok != TOK_EOF) emit_line_mark();
 
     if (tok == TOK_LBRACE) {
         parse_block();
@@ -938,54 +955,30 @@ static void parse_local_decl(CType base_type) {
         s->is_lvalue = 1;
 
         if (consumed_array_string_init) {
-            int ncopy = (array_init_len < array_size) ? array_init_len : array_size;
-            for (int i = 0; i < ncopy; i++) {
-                emit_local_get(local_idx);
-                emit_i32_const(i);
-                emit_op(OP_I32_ADD);
-                emit_i32_const((unsigned char)array_init_str[i]);
-                emit_op(OP_I32_STORE8);
-                buf_uleb(CODE, 0);
-                buf_uleb(CODE, 0);
-            }
-            if (array_size > array_init_len) {
-                emit_local_get(local_idx);
-                emit_i32_const(array_init_len);
-                emit_op(OP_I32_ADD);
-                emit_i32_const(0);
-                emit_op(OP_I32_STORE8);
-                buf_uleb(CODE, 0);
-                buf_uleb(CODE, 0);
-            }
+            emit_local_string_init(local_idx, array_size, array_init_str, array_init_len);
         } else if (accept(TOK_ASSIGN)) {
             if (is_array) {
                 if ((var_type == CT_CHAR || var_type == CT_UCHAR) && array_ndims == 1 && tok == TOK_STR_LIT) {
-                    int slen = tok_slen;
-                    int ncopy = (slen < array_size) ? slen : array_size;
-                    for (int i = 0; i < ncopy; i++) {
-                        emit_local_get(local_idx);
-                        emit_i32_const(i);
-                        emit_op(OP_I32_ADD);
-                        emit_i32_const((unsigned char)tok_sval[i]);
-                        emit_op(OP_I32_STORE8);
-                        buf_uleb(CODE, 0);
-                        buf_uleb(CODE, 0);
-                    }
-                    if (array_size > slen) {
-                        emit_local_get(local_idx);
-                        emit_i32_const(slen);
-                        emit_op(OP_I32_ADD);
-                        emit_i32_const(0);
-                        emit_op(OP_I32_STORE8);
-                        buf_uleb(CODE, 0);
-                        buf_uleb(CODE, 0);
-                    }
+                    emit_local_string_init(local_idx, array_size, tok_sval, tok_slen);
                     next_token();
                 } else {
+                    /* Elements without an initializer are zero on every
+                     * entry, not just the first: clear the array, then store */
+                    int total = elem_size;
+                    for (int d = 0; d < array_ndims; d++)
+                        total *= array_dims[d] > 0 ? array_dims[d] : 1;
+                    emit_local_get(local_idx);
+                    emit_i32_const(0);
+                    emit_i32_const(total);
+                    emit_memory_fill();
                     parse_local_array_init_level(local_idx, var_type, elem_size,
                                                  array_dims, array_ndims, 0, 0);
                 }
             }
+            else if (sym_ctype == CT_STRUCT && base_struct_id >= 0) {
+                emit_local_get(local_idx);
+                struct_copy_from_expr(base_struct_id);
+            }
             else {
                 CType rhs = assignment_expr();
                 emit_coerce(rhs, var_type);
@@ -1007,8 +1000,12 @@ void parse_top_level(void) {
     /* Skip stray semicolons */
     if (tok == TOK_SEMI) { next_token(); return; }
 
-    int is_static = 0;
-    if (tok == TOK_STATIC) { is_static = 1; next_token(); }
+    int is_static = 0, is_inline = 0;
+    for (;;) {
+        if (tok == TOK_STATIC) { is_static = 1; next_token(); continue; }
+        if (tok == TOK_INLINE) { is_inline = 1; next_token(); continue; }
+        break;
+    }
 
     /* Parse type specifier */
     int is_const = 0;
@@ -1065,9 +1062,10 @@ void parse_top_level(void) {
 
     /* Function definition or declaration */
     if (tok == TOK_LPAREN) {
-        parse_func_def(base_type, name, is_static);
+        parse_func_def(base_type, name, is_static, is_inline);
         return;
     }
+    if (is_inline) error_at("'inline' is only valid on functions");
 
     /* Global variable declaration */
     if (is_const) {
@@ -1406,7 +1404,7 @@ void parse_top_level(void) {
 
 /* ---- Function definition parser ---- */
 
-static void parse_func_def(CType ret_type, const char *name, int is_static) {
+static void parse_func_def(CType ret_type, const char *name, int is_static, int is_inline) {
     /* Struct return type not supported — must return a pointer */
     if (ret_type == CT_STRUCT && !type_had_pointer) {
         error_at("functions cannot return struct by value (return a pointer instead)");
@@ -1424,6 +1422,7 @@ static void parse_func_def(CType ret_type, const char *name, int is_static) {
     int func_idx = IMP_COUNT + nfuncs;
     FuncCtx *fc = &func_bufs[nfuncs];
     buf_init(&fc->code);
+    buf_init(&fc->lines);
     fc->nparams = 0;
     fc->nlocals = 0;
     fc->ncall_fixups = 0;
@@ -1497,6 +1496,7 @@ static void parse_func_def(CType ret_type, const char *name, int is_static) {
             for (int i = 0; i < fc->nparams; i++)
                 fs->param_types[i] = fc->param_ctypes[i];
             fs->is_static = is_static;
+            fs->is_inline = is_inline;
             fs->scope = 0;
             nfuncs++;
         }
@@ -1533,6 +1533,7 @@ static void parse_func_def(CType ret_type, const char *name, int is_static) {
         func_idx = fs->idx;
         /* Free the temp slot we allocated at nfuncs */
         buf_free(&func_bufs[nfuncs].code);
+        buf_free(&func_bufs[nfuncs].lines);
         cw_free(func_bufs[nfuncs].name);
         func_bufs[nfuncs].name = NULL;
         /* Update the function context to the right slot */
@@ -1546,6 +1547,7 @@ static void parse_func_def(CType ret_type, const char *name, int is_static) {
         fc->ncall_fixups = 0;
 
         buf_init(&fc->code);
+        buf_init(&fc->lines);
         /* Re-parse params into the correct fc */
         /* Actually we already parsed params above — copy them */
         FuncCtx *orig = &func_bufs[nfuncs];
@@ -1562,6 +1564,7 @@ static void parse_func_def(CType ret_type, const char *name, int is_static) {
         fs->scope = 0;
         nfuncs++;
     }
+    fs->is_inline |= is_inline;
     fs->is_defined = 1;
 
     /* Track setup/loop */
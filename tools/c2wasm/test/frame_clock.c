@@ -0,0 +1,23 @@
+/* Test: LED frame clock API (get_frame / get_frame_rate) */
+
+// EXPECTED:
+// 30
+// 3
+// 10
+// 1
+#include <conez_api.h>
+
+void setup(void) {
+    int fps = get_frame_rate();
+    long long frame = get_frame();
+    print_i32(fps);
+
+    /* whole seconds and frame within the second */
+    print_i64(frame / fps);
+    print_i32((int)(frame % fps));
+
+    /* stepping one frame later */
+    print_i32(get_frame() + 1 > frame);
+}
+
+void loop(void) {}
@@ -0,0 +1,87 @@
+/* Test: small static helpers that -O2 inlines -- early returns from
+ * inside loops, every value type, helpers calling helpers, a local the
+ * helper reads before writing (0 on every call), and a recursive helper
+ * that must stay a call */
+
+// EXPECTED:
+// 0
+// 128
+// 255
+// 64
+// 2.5
+// 258
+// 3
+// 1
+// 2
+// 1
+// 7
+// 10
+// 16843267
+#include <conez_api.h>
+
+int calls = 0;
+
+static inline int clamp8(int v) {
+    if (v < 0) return 0;
+    if (v > 255) return 255;
+    return v;
+}
+
+static int lerp8(int a, int b, int t) {
+    return clamp8(a + (b - a) * t / 256);
+}
+
+static float mixf(float a, float b, float t) {
+    return a + (b - a) * t;
+}
+
+static long long pack(int hi, int lo) {
+    return ((long long)hi << 8) | lo;
+}
+
+static int first_over(int limit) {
+    for (int i = 0; i < 10; i++) {
+        if (i * i > limit) return i;
+    }
+    return -1;
+}
+
+static int fresh(void) {
+    int seen;           /* never written before this read */
+    int r = seen + 1;
+    seen = 99;
+    return r;
+}
+
+static void bump(int by) {
+    if (by == 0) return;
+    calls += by;
+}
+
+static int fact_sum(int n) {
+    if (n <= 0) return 0;
+    return n + fact_sum(n - 1);
+}
+
+static unsigned int rgb(int r, int g, int b) {
+    return ((unsigned int)clamp8(r) << 16) | (clamp8(g) << 8) | clamp8(b);
+}
+
+void setup(void) {
+    print_i32(clamp8(-40));
+    print_i32(lerp8(0, 255, 129));
+    print_i32(lerp8(255, 400, 200));
+    print_i32(lerp8(0, 128, 128));
+    print_f32(mixf(1.0f, 4.0f, 0.5f));
+    print_i64(pack(1, 2));
+    print_i32(first_over(5));
+    print_i32(fresh());
+    print_i32(first_over(2));
+    print_i32(fresh());
+    bump(3);
+    bump(0);
+    bump(4);
+    print_i32(calls);
+    print_i32(fact_sum(4));
+    print_i32(rgb(1, 2, 3) + (1 << 24));
+}
@@ -0,0 +1,71 @@
+/* Test: locals that -O1/-O2 can pack into shared slots -- disjoint
+ * lifetimes, copies, a dead parameter, and locals read before any write
+ * (which must still see 0) */
+
+// EXPECTED:
+// 15
+// 21
+// 0
+// 7
+// 7
+// 2.5
+// 45
+// 6
+// 3
+#include <conez_api.h>
+
+int seed = 5;
+
+int disjoint(int n) {
+    int total = 0;
+    {
+        int a = n * 2;
+        total += a;
+    }
+    {
+        int b = n + 1;
+        int c = b;          /* copy: may share b's slot */
+        total += c - 1;
+    }
+    return total;
+}
+
+int dead_param(int unused) {
+    int x;
+    int y = seed + 2;       /* may reuse unused's slot */
+    x = y;
+    return x;
+}
+
+int zero_read(int n) {
+    int acc;                /* no initializer: reads the wasm zero */
+    int i;
+    for (i = 0; i < n; i++) {
+        int t = i * 3;
+        acc = acc + t;
+    }
+    return acc;
+}
+
+float mixed(int n) {
+    int i = n / 2;
+    float f = i + 0.5f;
+    double d = f;
+    int j = (int)d + n;
+    print_i32(j);
+    return f;
+}
+
+void setup(void) {
+    print_i32(disjoint(seed));
+    print_i32(disjoint(seed + 2));
+    int never;
+    print_i32(never);
+    print_i32(dead_param(99));
+    print_f32(mixed(seed));
+    print_i32(zero_read(6));
+    int p = seed + 1;
+    int q = p;
+    print_i32(q);
+    print_i32(q - p + 3);
+}
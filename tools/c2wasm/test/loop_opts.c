@@ -0,0 +1,97 @@
+/* Test: loops that -O2 rewrites -- strided and 2-D indexing, a counter
+ * stepping down or by a variable, a counter read after the loop, one
+ * whose range runs up against INT_MAX, and globals read in a loop with
+ * and without a store to them */
+
+// EXPECTED:
+// 120
+// 55
+// 45
+// 7
+// 4500
+// 96
+// 16
+// 135
+// 255
+#include <conez_api.h>
+
+int buf[48];
+int grid[4][6];
+int scale = 2;
+int total = 0;
+
+int strided(void) {
+    int i;
+    int s = 0;
+    for (i = 0; i < 16; i++) buf[i * 3 + 1] = i;
+    for (i = 0; i < 16; i++) s += buf[i * 3 + 1];
+    return s;
+}
+
+int down(void) {
+    int i;
+    int s = 0;
+    for (i = 10; i > 0; i--) s += buf[i * 3 + 1];
+    return s;
+}
+
+int by_step(int step) {
+    int i;
+    int s = 0;
+    for (i = 0; i < 16; i += step) s += buf[i * 3 + 1];
+    return s;
+}
+
+int first_from(int want) {
+    int i;
+    for (i = 0; i < 16; i++) {
+        if (buf[i * 3 + 1] == want) break;
+    }
+    return i;
+}
+
+int near_max(void) {
+    int i;
+    int s = 0;
+    for (i = 2147483000; i < 2147483600; i += 100) s += (i - 2147483000) * 3;
+    return s;
+}
+
+int grid_sum(void) {
+    int r;
+    int c;
+    int s = 0;
+    for (r = 0; r < 4; r++)
+        for (c = 0; c < 6; c++) grid[r][c] = r + c;
+    for (r = 0; r < 4; r++)
+        for (c = 0; c < 6; c++) s += grid[r][c] * scale / 2;
+    return s;
+}
+
+int scaled(void) {
+    int i;
+    int s = 0;
+    for (i = 0; i < 8; i++) s += scale;
+    return s;
+}
+
+int accumulate(void) {
+    int i;
+    for (i = 0; i < 16; i++) {
+        total += buf[i * 3 + 1];
+        scale = i;
+    }
+    return total + scale;
+}
+
+void setup(void) {
+    print_i32(strided());
+    print_i32(down());
+    print_i32(by_step(3));
+    print_i32(first_from(7));
+    print_i32(near_max());
+    print_i32(grid_sum());
+    print_i32(scaled());
+    print_i32(accumulate());
+    print_i32(accumulate());
+}
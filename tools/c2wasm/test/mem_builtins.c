@@ -0,0 +1,54 @@
+/* memset/memcpy/memmove lower to memory.fill / memory.copy; memmove (and
+ * memcpy) handle overlap. Local array initialisers zero the tail on every
+ * call, not only the first. */
+// EXPECTED:
+// 0
+// 5
+// 12345
+// 11234
+// 23455
+// 1
+// 0
+// 0
+// 0
+#include <conez_api.h>
+
+char buf[16];
+
+int digits(int n) {
+    int v = 0;
+    for (int i = 0; i < n; i++) v = v * 10 + buf[i];
+    return v;
+}
+
+int tail(int first) {
+    char s[8] = "ab";
+    int r = s[7];
+    int a[6] = {1, 2};
+    r += a[5];
+    s[7] = 'x';
+    a[5] = 9;
+    if (first) return 0;
+    return r;
+}
+
+void setup(void) {
+    char *p = memset(buf, 0, sizeof(buf));
+    print_i32(buf[15]);
+    memset(buf + 4, 5, 1);
+    print_i32(buf[4]);
+
+    for (int i = 0; i < 5; i++) buf[i] = (char)(i + 1);
+    memcpy(buf + 8, buf, 5);
+    print_i32(digits(5));
+    memmove(buf + 1, buf, 4);
+    print_i32(digits(5));
+    memmove(buf, buf + 9, 4);
+    buf[4] = 5;
+    print_i32(digits(5));
+    print_i32(p == buf);
+
+    print_i32(tail(1));
+    print_i32(tail(0));
+    print_i32(tail(0));
+}
@@ -24,6 +24,8 @@ const { execFileSync } = require('child_process');
 
 const testDir = __dirname;
 const c2wasm = path.resolve(testDir, '..', 'c2wasm');
+// Extra compiler flags, e.g. C2WASM_FLAGS=-O2
+const FLAGS = (process.env.C2WASM_FLAGS || '').split(/\s+/).filter(Boolean);
 const tmpDir = fs.mkdtempSync('/tmp/c2wasm_runtime_');
 process.on('exit', () => fs.rmSync(tmpDir, { recursive: true, force: true }));
 
@@ -136,6 +138,7 @@ function makeImports(state) {
             get_sunrise: () => 0n, get_sunset: () => 0n,
             sun_valid: ret0, is_daylight: ret0,
             cue_playing: ret0, cue_elapsed: () => 0n,
+            get_frame: () => 100n, get_frame_rate: () => 30,
             get_year: ret0, get_month: ret0, get_day: ret0,
             get_hour: ret0, get_minute: ret0, get_second: ret0,
             get_day_of_week: ret0, get_day_of_year: ret0,
@@ -161,7 +164,7 @@ function makeImports(state) {
 function runFile(fullpath, name) {
     const wasmPath = path.join(tmpDir, name + '.wasm');
     try {
-        execFileSync(c2wasm, [fullpath, '-o', wasmPath], { stdio: 'pipe' });
+        execFileSync(c2wasm, [...FLAGS, fullpath, '-o', wasmPath], { stdio: 'pipe' });
     } catch (e) {
         return { error: 'compile error' };
     }
@@ -25,13 +25,19 @@ if [ ! -x "$C2WASM" ]; then
     exit 1
 fi
 
-# Check for wasm-validate
+# Check for wasm-validate, else let node's WebAssembly do the validating
 VALIDATE=""
 if command -v wasm-validate &>/dev/null; then
     VALIDATE="wasm-validate"
+elif command -v node &>/dev/null; then
+    node_validate() { node -e "new WebAssembly.Module(require('fs').readFileSync(process.argv[1]))" "$1"; }
+    VALIDATE="node_validate"
 fi
 
-echo "=== c2wasm test suite ==="
+# Extra compiler flags, e.g. C2WASM_FLAGS=-O2 (make test runs with and without)
+FLAGS=${C2WASM_FLAGS:-}
+
+echo "=== c2wasm test suite${FLAGS:+ ($FLAGS)} ==="
 echo ""
 
 # --- Positive tests: should compile and validate ---
@@ -44,7 +50,7 @@ for src in "$SCRIPT_DIR"/*.c; do
     esac
 
     wasm="$TMPDIR/${name}.wasm"
-    out=$("$C2WASM" "$src" -o "$wasm" 2>&1)
+    out=$("$C2WASM" $FLAGS "$src" -o "$wasm" 2>&1)
     rc=$?
 
     if [ $rc -ne 0 ]; then
@@ -86,7 +92,7 @@ for src in "$SCRIPT_DIR"/reject_*.c; do
     name=$(basename "$src" .c)
     wasm="$TMPDIR/${name}.wasm"
 
-    out=$("$C2WASM" "$src" -o "$wasm" 2>&1)
+    out=$("$C2WASM" $FLAGS "$src" -o "$wasm" 2>&1)
     rc=$?
 
     if [ $rc -ne 0 ]; then
@@ -111,7 +117,7 @@ if [ -d "$EXAMPLES_DIR" ]; then
         name=$(basename "$src" .c)
         wasm="$TMPDIR/${name}.wasm"
 
-        out=$("$C2WASM" "$src" -o "$wasm" 2>&1)
+        out=$("$C2WASM" $FLAGS "$src" -o "$wasm" 2>&1)
         rc=$?
 
         if [ $rc -ne 0 ]; then
@@ -139,6 +145,78 @@ if [ -d "$EXAMPLES_DIR" ]; then
     done
 fi
 
+echo ""
+
+# --- --shrink: every positive test again, through the size pass. Each
+#     must validate, be understood, and come out no larger ---
+echo "--- shrink ---"
+nshr=0; saved=0
+for src in "$SCRIPT_DIR"/*.c "$EXAMPLES_DIR"/*.c; do
+    [ -f "$src" ] || continue
+    name=$(basename "$src" .c)
+    case "$name" in reject_*) continue ;; esac
+    wasm="$TMPDIR/shrink_${name}.wasm"
+    big="$TMPDIR/shrink_${name}_linked.wasm"
+
+    "$C2WASM" $FLAGS --release "$src" -o "$big" >/dev/null 2>&1
+    out=$("$C2WASM" $FLAGS --release --shrink --size-report "$src" -o "$wasm" 2>&1)
+    rc=$?
+    if [ $rc -ne 0 ] || echo "$out" | grep -q "not understood"; then
+        echo -e "  ${RED}FAIL${NC}  shrink/$name  (exit $rc)"
+        echo "$out" | grep -v "^Wrote" | head -5
+        fail=$((fail + 1))
+        continue
+    fi
+    if [ -n "$VALIDATE" ] && ! vout=$($VALIDATE "$wasm" 2>&1); then
+        echo -e "  ${RED}FAIL${NC}  shrink/$name  (wasm-validate failed)"
+        echo "        $vout" | head -5
+        fail=$((fail + 1))
+        continue
+    fi
+    a=$(stat -c%s "$big" 2>/dev/null || stat -f%z "$big" 2>/dev/null)
+    b=$(stat -c%s "$wasm" 2>/dev/null || stat -f%z "$wasm" 2>/dev/null)
+    if [ "$b" -gt "$a" ]; then
+        echo -e "  ${RED}FAIL${NC}  shrink/$name  (grew from $a to $b bytes)"
+        fail=$((fail + 1))
+        continue
+    fi
+    saved=$((saved + a - b))
+    nshr=$((nshr + 1))
+done
+if [ $nshr -gt 0 ]; then
+    echo -e "  ${GREEN}PASS${NC}  --shrink  ($nshr files, $saved bytes saved)"
+    pass=$((pass + 1))
+fi
+
+echo ""
+
+# --- --jobs: the positive tests again, on 4 threads, must match the above ---
+echo "--- batch ---"
+BATCH="$TMPDIR/batch"
+mkdir -p "$BATCH"
+cp "$SCRIPT_DIR"/*.h "$BATCH"/
+for src in "$SCRIPT_DIR"/*.c; do
+    case "$(basename "$src")" in reject_*) continue ;; esac
+    grep -q "__TIME__" "$src" && continue   # differs by the second
+    cp "$src" "$BATCH"/
+done
+out=$("$C2WASM" $FLAGS --jobs 4 "$BATCH" 2>&1)
+rc=$?
+ndiff=0
+for wasm in "$BATCH"/*.wasm; do
+    cmp -s "$wasm" "$TMPDIR/$(basename "$wasm")" || ndiff=$((ndiff + 1))
+done
+nsrc=$(ls "$BATCH"/*.c | wc -l)
+nout=$(ls "$BATCH"/*.wasm 2>/dev/null | wc -l)
+if [ $rc -eq 0 ] && [ $ndiff -eq 0 ] && [ "$nout" -eq "$nsrc" ]; then
+    echo -e "  ${GREEN}PASS${NC}  --jobs 4  ($nout files, identical output)"
+    pass=$((pass + 1))
+else
+    echo -e "  ${RED}FAIL${NC}  --jobs 4  (exit $rc, $nout of $nsrc built, $ndiff differ)"
+    echo "$out" | grep -v "^Wrote" | head -5
+    fail=$((fail + 1))
+fi
+
 echo ""
 echo "=== Results: $pass passed, $fail failed ==="
 
@@ -0,0 +1,65 @@
+/* Struct-by-value assignment copies the whole struct (memory.copy):
+ *   - name = name, declaration init, chained assignment
+ *   - nested struct members and array elements as either side
+ *   - a file-scope struct as the source
+ *   - the copy is independent of the source afterwards
+ */
+// EXPECTED:
+// 1
+// 2
+// 1
+// 7
+// 3
+// 4
+// 30
+// 7
+// 11
+// 12
+#include <conez_api.h>
+
+struct pt { int x; int y; };
+struct seg { struct pt a; struct pt b; };
+
+struct pt table[3];
+struct pt gp;
+
+void setup(void) {
+    struct pt a;
+    a.x = 1; a.y = 2;
+    struct pt b;
+    b = a;
+    a.x = 9;
+    print_i32(b.x);
+    print_i32(b.y);
+
+    struct pt c = b;
+    b.x = 5;
+    print_i32(c.x);
+
+    struct seg s;
+    s.a.x = 7; s.a.y = 8;
+    s.b = s.a;
+    print_i32(s.b.x);
+
+    table[1].x = 3; table[1].y = 4;
+    struct pt d;
+    struct pt e;
+    e = d = table[1];
+    print_i32(d.x);
+    print_i32(e.y);
+
+    table[2].x = 30;
+    table[0] = table[2];
+    print_i32(table[0].x);
+
+    s.a = c;
+    table[2] = s.b;
+    print_i32(table[2].x);
+
+    gp.x = 11; gp.y = 12;
+    struct pt f = gp;
+    b = gp;
+    gp.x = 0;
+    print_i32(f.x);
+    print_i32(b.y);
+}
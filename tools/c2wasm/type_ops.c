@@ -4,11 +4,11 @@
 #include "c2wasm.h"
 
 #ifdef C2WASM_EMBEDDED
-StructType *struct_types;
+CW_TLS StructType *struct_types;
 #else
-StructType struct_types[MAX_STRUCT_TYPES];
+CW_TLS StructType struct_types[MAX_STRUCT_TYPES];
 #endif
-int n_struct_types;
+CW_TLS int n_struct_types;
 
 /* Create a base type */
 TypeInfo type_base(CType ct) {
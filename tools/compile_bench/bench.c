@@ -0,0 +1,270 @@
+/*
+ * bench.c — compiler throughput benchmark for c2wasm and bas2wasm
+ *
+ * Compiles each .c/.bas file given (or found directly in a directory)
+ * with the embedded builds of the compilers, as the firmware's compile
+ * command and the simulator run them, and prints one JSON document:
+ * per program and optimization level, the time spent lexing, parsing
+ * (with the lexing it drives, and code generation), in c2wasm's -O
+ * passes and assembling, plus the compiler's peak heap use. Lexing is
+ * timed on its own as a lex-only pass. Times are the best of -r runs,
+ * taken in rounds over all the programs.
+ *
+ *   compile_bench [-r runs] [-O levels] <file|dir>...
+ *
+ * -O takes the c2wasm levels to run, e.g. -O 02 (the default) or -O 0.
+ */
+#include "bench.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/* ---- Counting heap ----
+ *
+ * Each block carries its size in a header, so frees and reallocs can
+ * keep `live` exact. The peak is what a device would need free. */
+
+typedef union { size_t n; max_align_t align; } HeapHdr;
+
+static size_t heap_live, heap_peak;
+
+static void *heap_note(HeapHdr *h, size_t n) {
+    if (!h) return NULL;
+    h->n = n;
+    heap_live += n;
+    if (heap_live > heap_peak) heap_peak = heap_live;
+    return h + 1;
+}
+
+void *bench_malloc(size_t n) { return heap_note(malloc(sizeof(HeapHdr) + n), n); }
+
+void *bench_calloc(size_t n, size_t sz) {
+    if (sz && n > ((size_t)-1 - sizeof(HeapHdr)) / sz) return NULL;
+    return heap_note(calloc(1, sizeof(HeapHdr) + n * sz), n * sz);
+}
+
+void *bench_realloc(void *p, size_t n) {
+    if (!p) return bench_malloc(n);
+    if (!n) { bench_free(p); return NULL; }
+    HeapHdr *h = (HeapHdr *)p - 1;
+    size_t old = h->n;
+    HeapHdr *q = realloc(h, sizeof(HeapHdr) + n);
+    if (!q) return NULL;
+    heap_live -= old;
+    return heap_note(q, n);
+}
+
+void bench_free(void *p) {
+    if (!p) return;
+    HeapHdr *h = (HeapHdr *)p - 1;
+    heap_live -= h->n;
+    free(h);
+}
+
+void   bench_heap_mark(void) { heap_peak = heap_live; }
+size_t bench_heap_peak(void) { return heap_peak; }
+size_t bench_heap_live(void) { return heap_live; }
+
+double bench_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* ---- Inputs ---- */
+
+static char *read_file(const char *path, int *len) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) { fprintf(stderr, "compile_bench: cannot open '%s'\n", path); return NULL; }
+    fseek(fp, 0, SEEK_END);
+    long sz = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char *text = malloc(sz + 1);
+    if (!text || (long)fread(text, 1, sz, fp) != sz) {
+        fprintf(stderr, "compile_bench: cannot read '%s'\n", path);
+        fclose(fp); free(text); return NULL;
+    }
+    text[sz] = 0;
+    fclose(fp);
+    *len = (int)sz;
+    return text;
+}
+
+static int has_ext(const char *path, const char *ext) {
+    size_t n = strlen(path), e = strlen(ext);
+    return n > e && strcmp(path + n - e, ext) == 0;
+}
+
+static char **files;
+static int nfiles;
+
+static int cmp_str(const void *a, const void *b) {
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+static void add_file(const char *path) {
+    files = realloc(files, (nfiles + 1) * sizeof(char *));
+    files[nfiles++] = strdup(path);
+}
+
+/* A file, or every .c/.bas directly inside a directory, sorted */
+static void add_input(const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISDIR(st.st_mode)) { add_file(path); return; }
+    DIR *d = opendir(path);
+    if (!d) { fprintf(stderr, "compile_bench: cannot open directory '%s'\n", path); return; }
+    int first = nfiles;
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        if (!has_ext(e->d_name, ".c") && !has_ext(e->d_name, ".bas")) continue;
+        char *f = malloc(strlen(path) + strlen(e->d_name) + 2);
+        sprintf(f, "%s/%s", path, e->d_name);
+        add_file(f);
+        free(f);
+    }
+    closedir(d);
+    qsort(files + first, nfiles - first, sizeof(char *), cmp_str);
+}
+
+/* ---- Output ---- */
+
+static void json_str(const char *s) {
+    putchar('"');
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') printf("\\%c", c);
+        else if (c == '\n') printf("\\n");
+        else if (c < 0x20) printf("\\u%04x", c);
+        else putchar(c);
+    }
+    putchar('"');
+}
+
+static double min_d(double a, double b) { return a < b ? a : b; }
+
+/* One program at one optimization level */
+typedef struct {
+    const char *name;       /* file name, for diagnostics and __FILE__ */
+    char *text;
+    int len, is_c, opt;
+    int ok;                 /* still compiling cleanly */
+    BenchRun first;         /* heap and output: the same every run */
+    double lex, best[PH_COUNT];   /* best[p]: mark p-1 to p */
+} Job;
+
+static int run_job(Job *j, int lex_only, BenchRun *r) {
+    return j->is_c ? bench_c2wasm(j->text, j->len, j->name, j->opt, lex_only, r)
+                   : bench_bas2wasm(j->text, j->len, lex_only, r);
+}
+
+/* A round runs every job once, lex-only and then in full; rounds repeat
+ * so a slow stretch of the host hits all programs alike, and each phase
+ * keeps its best time. */
+static void bench_round(Job *jobs, int njobs, int round) {
+    for (int i = 0; i < njobs; i++) {
+        Job *j = &jobs[i];
+        BenchRun r;
+        if (!j->ok) continue;
+        if (!run_job(j, 1, &r)) { j->ok = 0; j->first = r; continue; }
+        j->lex = round ? min_d(j->lex, r.lex_us) : r.lex_us;
+        if (!run_job(j, 0, &r)) { j->ok = 0; j->first = r; continue; }
+        if (round == 0) j->first = r;
+        for (int p = 1; p < PH_COUNT; p++)
+            j->best[p] = round ? min_d(j->best[p], r.at[p] - r.at[p - 1]) : r.at[p] - r.at[p - 1];
+    }
+}
+
+static void print_job(const Job *j, int first) {
+    int lines = 0;
+    for (int i = 0; i < j->len; i++) lines += j->text[i] == '\n';
+    char name[256];
+    snprintf(name, sizeof(name), "%.*s", (int)(strrchr(j->name, '.') - j->name), j->name);
+
+    printf("%s    {\"compiler\": ", first ? "" : ",\n");
+    json_str(j->is_c ? "c2wasm" : "bas2wasm");
+    printf(", \"program\": ");
+    json_str(name);
+    printf(", \"opt\": %d, \"src_bytes\": %d, \"lines\": %d", j->opt, j->len, lines);
+    if (!j->ok) {
+        printf(", \"error\": ");
+        json_str(j->first.error[0] ? j->first.error : "no output");
+        printf("}");
+        return;
+    }
+    double total = 0;
+    for (int p = 1; p < PH_COUNT; p++) total += j->best[p];
+    printf(", \"out_bytes\": %d,\n     \"lex_us\": %.1f, \"parse_us\": %.1f, \"opt_us\": %.1f,"
+           " \"assemble_us\": %.1f, \"total_us\": %.1f, \"peak_heap\": %zu, \"leaked\": %zu}",
+           j->first.out_len, j->lex, j->best[PH_assemble], j->best[PH_link], j->best[PH_done],
+           total, j->first.peak_heap, j->first.leaked);
+}
+
+int main(int argc, char **argv) {
+    int runs = 5;
+    const char *levels = "02";
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+            if (runs < 1) runs = 1;
+        } else if (strcmp(argv[i], "-O") == 0 && i + 1 < argc) {
+            levels = argv[++i];
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "compile_bench: unknown option '%s'\n", argv[i]);
+            return 1;
+        } else {
+            add_input(argv[i]);
+        }
+    }
+    if (!nfiles) {
+        fprintf(stderr, "Usage: compile_bench [-r runs] [-O levels] <file.c|file.bas|dir>...\n");
+        return 1;
+    }
+
+    Job *jobs = calloc(nfiles * strlen(levels) + nfiles, sizeof(Job));
+    int njobs = 0, failed = 0;
+    for (int f = 0; f < nfiles; f++) {
+        int is_c = has_ext(files[f], ".c");
+        if (!is_c && !has_ext(files[f], ".bas")) {
+            fprintf(stderr, "compile_bench: '%s' is neither .c nor .bas\n", files[f]);
+            failed++;
+            continue;
+        }
+        int len;
+        char *text = read_file(files[f], &len);
+        if (!text) { failed++; continue; }
+        const char *name = strrchr(files[f], '/') ? strrchr(files[f], '/') + 1 : files[f];
+        for (const char *l = is_c ? levels : "0"; *l; l++) {
+            Job *j = &jobs[njobs++];
+            j->name = name;
+            j->text = text;
+            j->len = len;
+            j->is_c = is_c;
+            j->opt = *l - '0';
+            j->ok = 1;
+        }
+    }
+
+    for (int round = 0; round < runs; round++)
+        bench_round(jobs, njobs, round);
+
+    printf("{\n  \"c2wasm\": ");
+    json_str(c2wasm_version_string());
+    printf(",\n  \"bas2wasm\": ");
+    json_str(bas2wasm_version_string());
+    printf(",\n  \"runs\": %d,\n  \"results\": [\n", runs);
+    for (int i = 0; i < njobs; i++) {
+        print_job(&jobs[i], i == 0);
+        failed += !jobs[i].ok;
+        if (i + 1 == njobs || jobs[i + 1].text != jobs[i].text) free(jobs[i].text);
+    }
+    printf("\n  ]\n}\n");
+
+    free(jobs);
+    for (int f = 0; f < nfiles; f++) free(files[f]);
+    free(files);
+    return failed ? 1 : 0;
+}
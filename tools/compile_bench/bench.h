@@ -0,0 +1,45 @@
+/*
+ * bench.h — shared by the compile benchmark's driver (bench.c) and its
+ * two compiler wrappers, each a single-TU embedded build like the
+ * firmware's. Nothing here may collide with the compilers' own names.
+ */
+#ifndef COMPILE_BENCH_H
+#define COMPILE_BENCH_H
+
+#include <stddef.h>
+
+/* Phase marks, in order. The compilers raise parse/assemble/link/done
+ * through CW_PHASE()/BW_PHASE(); start is taken by the wrapper. Only
+ * c2wasm has -O passes and marks link after them; for bas2wasm the
+ * wrapper copies the assemble mark. */
+enum { PH_start, PH_parse, PH_assemble, PH_link, PH_done, PH_COUNT };
+
+typedef struct {
+    double at[PH_COUNT];    /* bench_now_us() at each phase mark */
+    double lex_us;          /* lex-only pass (lex_only runs) */
+    size_t peak_heap;       /* most compiler bytes live at once */
+    size_t leaked;          /* still live after the output and reset */
+    int out_len;            /* module size, 0 on error */
+    char error[160];        /* first diagnostic, "" if none */
+} BenchRun;
+
+/* Counting heap: every compiler allocation comes through here */
+void  *bench_malloc(size_t n);
+void  *bench_realloc(void *p, size_t n);
+void  *bench_calloc(size_t n, size_t sz);
+void   bench_free(void *p);
+void   bench_heap_mark(void);       /* restart the peak at what's live */
+size_t bench_heap_peak(void);
+size_t bench_heap_live(void);
+
+double bench_now_us(void);
+
+/* One compile of text. lex_only stops where parsing would start and
+ * tokenizes the whole source instead. 1 if it got through cleanly. */
+int bench_c2wasm(const char *text, int len, const char *name, int opt,
+                 int lex_only, BenchRun *r);
+int bench_bas2wasm(const char *text, int len, int lex_only, BenchRun *r);
+const char *c2wasm_version_string(void);
+const char *bas2wasm_version_string(void);
+
+#endif /* COMPILE_BENCH_H */
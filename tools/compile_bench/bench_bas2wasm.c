@@ -0,0 +1,96 @@
+/*
+ * bench_bas2wasm.c — bas2wasm built the way the firmware builds it (one
+ * TU, BAS2WASM_EMBEDDED, plain globals, data tables on the heap as on
+ * boards without PSRAM) with its platform layer on the bench's counting
+ * heap, timed at the compiler's phase marks.
+ */
+#include "bench.h"
+#include <stdarg.h>
+
+static BenchRun *run;
+static int lex_only;
+static void phase(int p);
+
+#define BAS2WASM_EMBEDDED
+#define BAS2WASM_NO_TLS
+#define BW_PHASE(p) phase(PH_##p)
+
+#include "buf.c"
+#include "imports.c"
+#include "lexer.c"
+#include "expr.c"
+#include "stmt.c"
+#include "assemble.c"
+#include "runtime.c"
+#include "main.c"
+
+/* ---- Platform layer (bas2wasm_platform.c, on the counting heap) ---- */
+
+BW_TLS jmp_buf bw_bail;
+
+void *bw_malloc(size_t n)           { return bench_malloc(n); }
+void *bw_realloc(void *p, size_t n) { return bench_realloc(p, n); }
+void *bw_calloc(size_t n, size_t s) { return bench_calloc(n, s); }
+void  bw_free(void *p)              { bench_free(p); }
+
+/* Keep the first error; info is dropped */
+static void note_error(const char *fmt, va_list ap) {
+    if (run && !run->error[0])
+        vsnprintf(run->error, sizeof(run->error), fmt, ap);
+}
+
+void bw_error(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    note_error(fmt, ap);
+    va_end(ap);
+    had_error = 1;
+}
+
+void bw_info(const char *fmt, ...) { (void)fmt; }
+
+void bw_fatal(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    note_error(fmt, ap);
+    va_end(ap);
+    had_error = 1;
+    longjmp(bw_bail, 1);
+}
+
+/* ---- Timing ---- */
+
+/* At the parse mark a lex-only run reads every line ($INCLUDEs spliced
+ * in) and tokenizes it to the end, then bails as a fatal error would. */
+static void phase(int p) {
+    run->at[p] = bench_now_us();
+    if (p == PH_assemble) run->at[PH_link] = run->at[p];   /* no -O passes */
+    if (p != PH_parse || !lex_only) return;
+    while (next_line() && !had_error) {
+        while (read_tok() != TOK_EOF && !had_error)
+            ;
+    }
+    run->lex_us = bench_now_us() - run->at[p];
+    longjmp(bw_bail, 1);
+}
+
+int bench_bas2wasm(const char *text, int len, int lex, BenchRun *r) {
+    static Buf out;     /* static: survives the longjmp */
+
+    memset(r, 0, sizeof(*r));
+    run = r;
+    lex_only = lex;
+    buf_init(&out);
+    size_t base = bench_heap_live();
+    bench_heap_mark();
+    r->at[PH_start] = bench_now_us();
+    if (setjmp(bw_bail) == 0)
+        out = bas2wasm_compile_buffer(text, len);
+    r->peak_heap = bench_heap_peak() - base;
+    r->out_len = out.len;
+    buf_free(&out);
+    bas2wasm_reset();
+    r->leaked = bench_heap_live() - base;
+    run = NULL;
+    return !r->error[0] && (lex ? r->lex_us > 0 : r->out_len > 0);
+}
@@ -0,0 +1,107 @@
+/*
+ * bench_c2wasm.c — c2wasm built the way the firmware builds it (one TU,
+ * C2WASM_EMBEDDED, plain globals) with its platform layer on the bench's
+ * counting heap, timed at the compiler's phase marks.
+ */
+#include "bench.h"
+#include <stdarg.h>
+
+static BenchRun *run;
+static int lex_only;
+static void phase(int p);
+
+#define C2WASM_EMBEDDED
+#define C2WASM_NO_TLS
+#define CW_PHASE(p) phase(PH_##p)
+
+/* Embedded symbol names are cut to 32 bytes on purpose, as in
+ * firmware/src/wasm/c2wasm_embed.c */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "c2wasm_all.c"
+#pragma GCC diagnostic pop
+
+/* ---- Platform layer (c2wasm_platform.c, on the counting heap) ---- */
+
+CW_TLS jmp_buf cw_bail;
+
+void *cw_malloc(size_t n) {
+    void *p = bench_malloc(n);
+    if (!p) cw_fatal("out of memory (malloc %u)", (unsigned)n);
+    return p;
+}
+void *cw_realloc(void *p, size_t n) {
+    void *q = bench_realloc(p, n);
+    if (!q && n) cw_fatal("out of memory (realloc %u)", (unsigned)n);
+    return q;
+}
+void *cw_calloc(size_t n, size_t s) {
+    void *p = bench_calloc(n, s);
+    if (!p && n && s) cw_fatal("out of memory (calloc %u*%u)", (unsigned)n, (unsigned)s);
+    return p;
+}
+void cw_free(void *p) { bench_free(p); }
+
+/* Keep the first error; info and warnings are dropped */
+static void note_error(const char *fmt, va_list ap) {
+    if (run && !run->error[0])
+        vsnprintf(run->error, sizeof(run->error), fmt, ap);
+}
+
+void cw_error(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    note_error(fmt, ap);
+    va_end(ap);
+    had_error = 1;
+}
+
+void cw_info(const char *fmt, ...) { (void)fmt; }
+void cw_warn(const char *fmt, ...) { (void)fmt; }
+
+void cw_fatal(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    note_error(fmt, ap);
+    va_end(ap);
+    had_error = 1;
+    longjmp(cw_bail, 1);
+}
+
+/* ---- Timing ---- */
+
+/* At the parse mark a lex-only run tokenizes everything, preprocessor
+ * included, and bails out the way a fatal error would. */
+static void phase(int p) {
+    run->at[p] = bench_now_us();
+    if (p != PH_parse || !lex_only) return;
+    lex_init();
+    preproc_init();
+    while (next_token() != TOK_EOF && !had_error)
+        ;
+    run->lex_us = bench_now_us() - run->at[p];
+    longjmp(cw_bail, 1);
+}
+
+int bench_c2wasm(const char *text, int len, const char *name, int opt,
+                 int lex, BenchRun *r) {
+    static Buf out;     /* static: survives the longjmp */
+
+    memset(r, 0, sizeof(*r));
+    run = r;
+    lex_only = lex;
+    opt_level = opt;
+    buf_init(&out);
+    size_t base = bench_heap_live();
+    bench_heap_mark();
+    r->at[PH_start] = bench_now_us();
+    if (setjmp(cw_bail) == 0)
+        out = c2wasm_compile_buffer(text, len, name);
+    r->peak_heap = bench_heap_peak() - base;
+    r->out_len = out.len;
+    buf_free(&out);
+    c2wasm_reset();
+    r->leaked = bench_heap_live() - base;
+    run = NULL;
+    return !r->error[0] && (lex ? r->lex_us > 0 : r->out_len > 0);
+}
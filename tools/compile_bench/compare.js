@@ -0,0 +1,75 @@
+#!/usr/bin/env node
+// Summarize compile_bench results, or hold them against a baseline run.
+//
+//   node compare.js results.json                 table of the run
+//   node compare.js baseline.json results.json   ...and exit 1 on a regression
+//
+// A regression is a program that stopped compiling or leaks, a peak heap
+// more than --heap-tol percent (default 2) over the baseline, or the
+// whole corpus taking more than --time-tol percent (default 25) longer.
+// Peak heap is exact and repeats run to run. Times only compare on the
+// same machine, and one program's can move 40% between runs on a busy
+// host, so they're shown per program but judged in total.
+
+const fs = require('fs');
+
+const args = process.argv.slice(2);
+let heapTol = 2, timeTol = 25;
+const files = [];
+for (let i = 0; i < args.length; i++) {
+    if (args[i] === '--heap-tol') heapTol = +args[++i];
+    else if (args[i] === '--time-tol') timeTol = +args[++i];
+    else files.push(args[i]);
+}
+if (files.length < 1 || files.length > 2) {
+    console.error('usage: node compare.js [baseline.json] results.json [--heap-tol %] [--time-tol %]');
+    process.exit(1);
+}
+
+const load = f => JSON.parse(fs.readFileSync(f, 'utf8'));
+const key = r => `${r.compiler} ${r.program} -O${r.opt}`;
+const cur = load(files[files.length - 1]);
+const base = files.length === 2 ? new Map(load(files[0]).results.map(r => [key(r), r])) : null;
+
+const ms = us => (us / 1000).toFixed(2).padStart(8);
+const pct = (a, b) => (b > a ? '+' : '') + (100 * (b - a) / a).toFixed(1) + '%';
+
+console.log(`${cur.c2wasm}, ${cur.bas2wasm}, best of ${cur.runs}\n`);
+console.log(`${'program'.padEnd(30)} ${'lines'.padStart(6)} ${'lex ms'.padStart(8)} ${'parse'.padStart(8)} ` +
+            `${'opt'.padStart(8)} ${'asm'.padStart(8)} ${'total'.padStart(8)} ${'us/line'.padStart(8)} ` +
+            `${'heap KB'.padStart(8)}${base ? '  vs baseline' : ''}`);
+
+let regressions = 0, sumBase = 0, sumCur = 0;
+for (const r of cur.results) {
+    const b = base && base.get(key(r));
+    let line = key(r).padEnd(30) + ' ' + String(r.lines).padStart(6) + ' ';
+    if (r.error) {
+        line += `error: ${r.error.trim()}`;
+        if (!b || !b.error) { line += '  REGRESSION'; regressions++; }
+        console.log(line);
+        continue;
+    }
+    line += `${ms(r.lex_us)} ${ms(r.parse_us)} ${ms(r.opt_us)} ${ms(r.assemble_us)} ${ms(r.total_us)} ` +
+            `${(r.total_us / Math.max(r.lines, 1)).toFixed(2).padStart(8)} ` +
+            `${(r.peak_heap / 1024).toFixed(1).padStart(8)}`;
+    if (r.leaked) { line += `  LEAKED ${r.leaked} bytes`; regressions++; }
+    if (b && !b.error) {
+        const notes = [`time ${pct(b.total_us, r.total_us)}`, `heap ${pct(b.peak_heap, r.peak_heap)}`];
+        if (r.peak_heap > b.peak_heap * (1 + heapTol / 100)) { notes.push('HEAP REGRESSION'); regressions++; }
+        sumBase += b.total_us;
+        sumCur += r.total_us;
+        line += '  ' + notes.join(', ');
+    }
+    console.log(line);
+}
+
+if (base && sumBase) {
+    let line = `\nTotal ${ms(sumBase).trim()} -> ${ms(sumCur).trim()} ms (${pct(sumBase, sumCur)})`;
+    if (sumCur > sumBase * (1 + timeTol / 100)) { line += '  TIME REGRESSION'; regressions++; }
+    console.log(line);
+}
+if (base) {
+    console.log(regressions ? `\n${regressions} regression(s) against ${files[0]}`
+                            : `\nNo regressions against ${files[0]}`);
+}
+process.exit(regressions ? 1 : 0);
@@ -0,0 +1,256 @@
+#!/usr/bin/env node
+// Synthetic programs for compile_bench: each family grows one dimension
+// of a program through a few sizes, so the results show how each phase
+// scales with it. Every size must compile with the embedded compilers,
+// whose tables are fixed (c2wasm.h / bas2wasm.h, *_EMBEDDED): 16
+// functions including setup/loop or the BASIC main, 32 open blocks, 4 KB
+// of string data, 256 DATA items, 64 locals per function. The large-input
+// axis is therefore statements, not functions. Scratch locals are not
+// reused, so the statement mixes leave out what takes one each time (a C
+// switch or store to a global; a BASIC FOR, SELECT CASE or string
+// assignment); the nesting and string families use those in bounded
+// numbers instead.
+//
+//   node gen_corpus.js <outdir>
+
+const fs = require('fs');
+const path = require('path');
+
+const outDir = process.argv[2];
+if (!outDir) {
+    console.error('usage: node gen_corpus.js <outdir>');
+    process.exit(1);
+}
+fs.mkdirSync(outDir, { recursive: true });
+
+function write(name, lines) {
+    fs.writeFileSync(path.join(outDir, name), lines.join('\n') + '\n');
+}
+
+// Deterministic filler text, so the corpus (and its timings) repeat
+function words(seed, n) {
+    const w = ['cone', 'pulse', 'amber', 'drift', 'spark', 'tide', 'glow', 'ember',
+               'halo', 'surge', 'fade', 'orbit', 'prism', 'flare', 'dusk', 'wave'];
+    const out = [];
+    for (let i = 0; i < n; i++) out.push(w[(seed * 7 + i * 13) % w.length]);
+    return out.join(' ');
+}
+
+// ---- C ----
+
+// One C statement of a mix that touches the lexer, expressions, control
+// flow, floats, global reads and (one in sixteen) an import call
+function cStmt(i) {
+    const g = i % 8;
+    switch (i % 16) {
+    case 0:  return `a = (a * 31 + b) & 0xFFFF;`;
+    case 1:  return `if (a > b) b = a - c; else c = c + ${i % 97};`;
+    case 2:  return `for (k = 0; k < 4; k++) c += k * a;`;
+    case 3:  return `c = g${g} ^ (a << 3);`;
+    case 4:  return `b = (b + c * 7) % 1021;`;
+    case 5:  return `while (c > 1000) c = c / 2;`;
+    case 6:  return `f = f * 0.5f + (float)(a & 255);`;
+    case 7:  return `if ((a & 3) == 0) b++; else if ((a & 3) == 1) c--; else a ^= b;`;
+    case 8:  return `a += (b > c) ? b - c : c - b;`;
+    case 9:  return `c = (c << 1) | ((a >> ${i % 13}) & 1);`;
+    case 10: return `if (g${g} & 1) { a++; b--; } else { a--; b++; }`;
+    case 11: return `led_set_pixel(0, a & 63, b & 255, c & 255, (int)f & 255);`;
+    case 12: return `b = b * ${3 + i % 29} + g${g};`;
+    case 13: return `do { c -= 3; } while (c > 500);`;
+    case 14: return `f += (a > 100 && b < 50) ? 1.25f : -0.75f;`;
+    default: return `a = g${g} + a - b + c;`;
+    }
+}
+
+function cHelper(name, nstmt, seed, callee) {
+    const body = [`static int ${name}(int x) {`,
+                  `    int a = x + ${seed}, b = ${seed % 17 + 1}, c = 2, k;`,
+                  `    float f = 0.0f;`];
+    for (let i = 0; i < nstmt; i++) body.push('    ' + cStmt(i + seed));
+    if (callee) body.push(`    a += ${callee}(b);`);
+    body.push(`    return a + b + c + (int)f;`, `}`, ``);
+    return body;
+}
+
+function cProgram(helpers, setupBody, loopBody) {
+    return ['#include <conez_api.h>', '',
+            'static int g0, g1, g2, g3, g4, g5, g6, g7;', '',
+            ...helpers,
+            'void setup(void) {', ...setupBody.map(l => '    ' + l), '}', '',
+            'void loop(void) {', ...loopBody.map(l => '    ' + l), '}'];
+}
+
+// Statements: a fixed 12 helpers holding ever more straight-line code
+for (const n of [1000, 2000, 4000, 8000]) {
+    const helpers = [], calls = [];
+    for (let h = 0; h < 12; h++) {
+        helpers.push(...cHelper(`work${h}`, Math.round(n / 12), h * 101, null));
+        calls.push(`acc += work${h}(acc);`);
+    }
+    write(`c_stmts_${n}.c`, cProgram(helpers, ['g0 = 1;'],
+                                     ['static int acc = 0;', ...calls, 'led_show();']));
+}
+
+// Nesting: for/if/while/switch blocks inside each other to depth d
+for (const d of [4, 8, 16, 28]) {
+    const body = ['int acc = 0;'];
+    for (let i = 0; i < d; i++) body.push(`int v${i} = ${i};`);
+    let ind = '';
+    const close = [];
+    for (let i = 0; i < d; i++) {
+        switch (i % 4) {
+        case 0:
+            body.push(`${ind}for (v${i} = 0; v${i} < 2; v${i}++) {`);
+            close.push(`${ind}}`);
+            break;
+        case 1:
+            body.push(`${ind}if (acc >= ${i}) {`);
+            close.push(`${ind}} else { acc += ${i}; }`);
+            break;
+        case 2:
+            body.push(`${ind}while (v${i} < ${i + 1}) {`, `${ind}    v${i}++;`);
+            close.push(`${ind}}`);
+            break;
+        default:
+            body.push(`${ind}switch (acc & 1) {`, `${ind}case 0: {`);
+            close.push(`${ind}} break;\n${ind}default: acc--; break;\n${ind}}`);
+        }
+        ind += '    ';
+        body.push(`${ind}acc += v${i} * ${i + 1};`);
+    }
+    body.push(`${ind}led_set_pixel(0, acc & 63, 0, 0, 0);`);
+    while (close.length) body.push(close.pop());
+    body.push('g0 = acc;');
+    write(`c_nest_${d}.c`, cProgram([], ['g0 = 0;'], body));
+}
+
+// Functions: more and more helpers, each calling the one before
+for (const f of [2, 4, 8, 14]) {
+    const helpers = [];
+    for (let h = 0; h < f; h++)
+        helpers.push(...cHelper(`fn${h}`, 40, h * 37, h ? `fn${h - 1}` : null));
+    write(`c_funcs_${f}.c`, cProgram(helpers, ['g0 = 1;'],
+                                     [`g1 = fn${f - 1}(g0);`, 'led_show();']));
+}
+
+// Strings: distinct literals, at most 100 print calls per function
+for (const s of [16, 32, 64, 128]) {
+    const helpers = [], calls = [];
+    for (let base = 0, h = 0; base < s; base += 100, h++) {
+        helpers.push(`static void msgs${h}(int which) {`);
+        for (let i = base; i < Math.min(base + 100, s); i++)
+            helpers.push(`    if (which == ${i}) print("${i}: ${words(i, 3)}\\n");`);
+        helpers.push('}', '');
+        calls.push(`msgs${h}(g0 % ${s});`);
+    }
+    write(`c_strings_${s}.c`, cProgram(helpers, ['g0 = 0;'], [...calls, 'g0++;']));
+}
+
+// ---- BASIC ----
+
+// One BASIC statement (some span lines) from a mix like cStmt's; the
+// import call comes once in 24, as call sites per function are bounded
+function basStmt(i) {
+    switch (i % 24 == 9 ? 9 : i % 12 == 9 ? 11 : i % 12) {
+    case 0:  return [`A = (A * 31 + B) AND 65535`];
+    case 1:  return [`IF A > B`, `  B = A - C`, `ELSE`, `  C = C + ${i % 97}`, `END IF`];
+    case 2:  return [`K = 0`, `WHILE K < 4`, `  K = K + 1`, `  C = C + K * A`, `WEND`];
+    case 3:  return [`G${i % 6} = G${i % 6} XOR (A * 8)`];
+    case 4:  return [`B = (B + C * 7) MOD 1021`];
+    case 5:  return [`DO WHILE C > 1000`, `  C = C / 2`, `LOOP`];
+    case 6:  return [`F# = F# * 0.5 + A`];
+    case 7:  return [`IF (A AND 3) = 0`, `  B = B + 1`, `ELSEIF (A AND 3) = 1`,
+                     `  C = C - 1`, `END IF`];
+    case 8:  return [`IF B > C THEN A = A + B - C`];
+    case 9:  return [`S = SETLEDCOL(A AND 255, B AND 255, C AND 255)`];
+    case 10: return [`B = B * ${3 + i % 29} + G${i % 6}`];
+    default: return [`G${i % 6} = G${i % 6} + A - B + C`];
+    }
+}
+
+function basSub(name, nstmt, seed, callee) {
+    const body = [`FUNCTION ${name} X`, `  LOCAL A, B, C, K, S, F#`,
+                  `  A = X + ${seed}`, `  B = ${seed % 17 + 1}`, `  C = 2`];
+    for (let i = 0; i < nstmt; i++)
+        for (const l of basStmt(i + seed)) body.push('  ' + l);
+    if (callee) body.push(`  A = A + ${callee}(B)`);
+    body.push(`  RETURN A + B + C`, `END FUNCTION`, ``);
+    return body;
+}
+
+// Statements: a fixed 12 FUNCTIONs holding ever more code
+for (const n of [1000, 2000, 4000, 8000]) {
+    const lines = [], calls = ['ACC = 0'];
+    for (let h = 0; h < 12; h++) {
+        lines.push(...basSub(`WORK${h}`, Math.round(n / 12), h * 101, null));
+        calls.push(`ACC = ACC + WORK${h}(ACC)`);
+    }
+    write(`bas_stmts_${n}.bas`, [...lines, ...calls, 'FORMAT "%", ACC']);
+}
+
+// Nesting: FOR/IF/DO/SELECT blocks inside each other to depth d
+for (const d of [4, 8, 16, 28]) {
+    const lines = ['ACC = 0'];
+    let ind = '';
+    const close = [];
+    for (let i = 0; i < d; i++) {
+        switch (i % 4) {
+        case 0:
+            lines.push(`${ind}FOR V${i} = 1 TO 2`);
+            close.push(`${ind}NEXT`);
+            break;
+        case 1:
+            lines.push(`${ind}IF ACC >= ${i}`);
+            close.push(`${ind}ELSE\n${ind}  ACC = ACC + ${i}\n${ind}END IF`);
+            break;
+        case 2:
+            lines.push(`${ind}V${i} = 0`, `${ind}DO WHILE V${i} < ${i + 1}`, `${ind}  V${i} = V${i} + 1`);
+            close.push(`${ind}LOOP`);
+            break;
+        default:
+            lines.push(`${ind}SELECT CASE ACC AND 1`, `${ind}  CASE 0`);
+            close.push(`${ind}  CASE ELSE\n${ind}    ACC = ACC - 1\n${ind}END SELECT`);
+        }
+        ind += '  ';
+        lines.push(`${ind}ACC = ACC + ${i + 1}`);
+    }
+    while (close.length) lines.push(close.pop());
+    lines.push('FORMAT "%", ACC');
+    write(`bas_nest_${d}.bas`, lines);
+}
+
+// Functions: more and more FUNCTIONs, each calling the one before
+for (const f of [2, 4, 8, 14]) {
+    const lines = [];
+    for (let h = 0; h < f; h++)
+        lines.push(...basSub(`FN${h}`, 30, h * 37, h ? `FN${h - 1}` : null));
+    write(`bas_funcs_${f}.bas`, [...lines, `FORMAT "%", FN${f - 1}(1)`]);
+}
+
+// DATA: numbers and strings, read back in a loop
+for (const k of [32, 64, 128, 248]) {
+    const lines = [];
+    for (let i = 0; i < k; i += 8) {
+        const items = [];
+        for (let j = i; j < i + 8; j++)
+            items.push(j % 2 ? `"${words(j, 1)}${j}"` : `${j * 37 % 1000}`);
+        lines.push(`DATA ${items.join(', ')}`);
+    }
+    lines.push('SUM = 0', `FOR I = 1 TO ${k / 2}`, '  READ N, T$', '  SUM = SUM + N + LEN(T$)',
+               'NEXT', 'FORMAT "%", SUM');
+    write(`bas_data_${k}.bas`, lines);
+}
+
+// Strings: distinct literals, at most 40 per FUNCTION (each assignment
+// takes a local)
+for (const s of [16, 32, 64, 128]) {
+    const lines = [], calls = [];
+    for (let base = 0, h = 0; base < s; base += 40, h++) {
+        lines.push(`FUNCTION MSGS${h}$ W`, '  LOCAL R$', '  R$ = ""');
+        for (let i = base; i < Math.min(base + 40, s); i++)
+            lines.push(`  IF W = ${i} THEN R$ = "${i}: ${words(i, 3)}"`);
+        lines.push('  RETURN R$', 'END FUNCTION', '');
+        calls.push(`FORMAT "$", MSGS${h}$(${s - 1})`);
+    }
+    write(`bas_strings_${s}.bas`, [...lines, ...calls]);
+}
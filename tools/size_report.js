@@ -0,0 +1,89 @@
+#!/usr/bin/env node
+// Module sizes with and without --shrink, raw and deflated the way the
+// LoRa dist carousel sends them (zlib, LP_DIST_ALGO_DEFLATE). Compiles
+// every positive test and example of both compilers twice, release
+// builds as they'd be distributed, and totals each corpus.
+//
+//   node size_report.js [-v]      -v: a line per file as well
+
+const fs = require('fs');
+const path = require('path');
+const zlib = require('zlib');
+const { execFileSync } = require('child_process');
+
+const root = __dirname;
+const verbose = process.argv.includes('-v');
+const tmpDir = fs.mkdtempSync('/tmp/size_report_');
+process.on('exit', () => fs.rmSync(tmpDir, { recursive: true, force: true }));
+
+function sources(dir, ext) {
+    if (!fs.existsSync(dir)) return [];
+    return fs.readdirSync(dir)
+        .filter(f => f.endsWith(ext) && !f.startsWith('reject_'))
+        .sort()
+        .map(f => path.join(dir, f));
+}
+
+const c2wasm = path.join(root, 'c2wasm', 'c2wasm');
+const bas2wasm = path.join(root, 'bas2wasm', 'bas2wasm');
+const cSrc = [...sources(path.join(root, 'c2wasm', 'test'), '.c'),
+              ...sources(path.join(root, 'wasm', 'examples'), '.c')];
+const basSrc = [...sources(path.join(root, 'bas2wasm', 'test'), '.bas'),
+                ...sources(path.join(root, '..', 'firmware', 'data'), '.bas')];
+
+const corpora = [
+    { name: 'c2wasm -O2 --release', tool: c2wasm, flags: ['-O2', '--release'], files: cSrc },
+    { name: 'c2wasm --release', tool: c2wasm, flags: ['--release'], files: cSrc },
+    { name: 'bas2wasm --release', tool: bas2wasm, flags: ['--release'], files: basSrc },
+    { name: 'bas2wasm --release --inline-strings', tool: bas2wasm,
+      flags: ['--release', '--inline-strings'], files: basSrc },
+];
+
+// Raw and deflated size of src built with flags, or null if it won't build
+function build(tool, src, flags) {
+    const out = path.join(tmpDir, 'out.wasm');
+    try {
+        execFileSync(tool, [src, ...flags, '-o', out], { stdio: 'pipe' });
+    } catch (e) {
+        return null;
+    }
+    const wasm = fs.readFileSync(out);
+    return { raw: wasm.length, deflated: zlib.deflateSync(wasm, { level: 9 }).length };
+}
+
+const pct = (a, b) => (a ? (100 * (b - a) / a).toFixed(1) : '0.0') + '%';
+
+for (const tool of [c2wasm, bas2wasm]) {
+    if (!fs.existsSync(tool)) {
+        console.error(`${tool} not found — run 'make' first`);
+        process.exit(1);
+    }
+}
+
+console.log('=== module size: linked vs --shrink ===\n');
+console.log(`${'corpus'.padEnd(38)} ${'files'.padStart(5)}  ` +
+            `${'raw'.padStart(8)} ${'shrunk'.padStart(8)} ${'saved'.padStart(7)}  ` +
+            `${'deflate'.padStart(8)} ${'shrunk'.padStart(8)} ${'saved'.padStart(7)}`);
+for (const c of corpora) {
+    const t = { n: 0, raw: 0, rawS: 0, def: 0, defS: 0 };
+    const rows = [];
+    for (const src of c.files) {
+        const a = build(c.tool, src, c.flags);
+        const b = a && build(c.tool, src, [...c.flags, '--shrink']);
+        if (!a || !b) continue;
+        t.n++;
+        t.raw += a.raw; t.rawS += b.raw;
+        t.def += a.deflated; t.defS += b.deflated;
+        rows.push([path.basename(src), a, b]);
+    }
+    console.log(`${c.name.padEnd(38)} ${String(t.n).padStart(5)}  ` +
+                `${String(t.raw).padStart(8)} ${String(t.rawS).padStart(8)} ${pct(t.raw, t.rawS).padStart(7)}  ` +
+                `${String(t.def).padStart(8)} ${String(t.defS).padStart(8)} ${pct(t.def, t.defS).padStart(7)}`);
+    if (verbose) {
+        for (const [name, a, b] of rows)
+            console.log(`  ${name.padEnd(36)}        ` +
+                        `${String(a.raw).padStart(8)} ${String(b.raw).padStart(8)} ${pct(a.raw, b.raw).padStart(7)}  ` +
+                        `${String(a.deflated).padStart(8)} ${String(b.deflated).padStart(8)} ${pct(a.deflated, b.deflated).padStart(7)}`);
+        console.log('');
+    }
+}
@@ -293,6 +293,15 @@ int64_t get_uptime_ms(void);
 __attribute__((import_module("env"), import_name("get_last_comm_ms")))
 int64_t get_last_comm_ms(void);
 
+/* Current LED frame number. Frame n starts at epoch time n / get_frame_rate()
+ * seconds, so cones with GPS/NTP time agree on it. */
+__attribute__((import_module("env"), import_name("get_frame")))
+int64_t get_frame(void);
+
+/* LED frame rate in frames per second (config led.fps, default 30). */
+__attribute__((import_module("env"), import_name("get_frame_rate")))
+int get_frame_rate(void);
+
 /* ---- Date/Time (calendar fields) ---- */
 
 __attribute__((import_module("env"), import_name("get_year")))
@@ -515,6 +524,22 @@ int file_readln_str(int handle);
 __attribute__((import_module("env"), import_name("file_writeln")))
 int file_writeln(int handle, const char *str);
 
+/* ---- Mapped views (read-only, paged) ----
+ * For walking a file in records, e.g. frame playback. file_map() lends the
+ * host a buffer; file_map_get() returns a pointer into it holding file
+ * bytes [offset, offset+len), refilling the whole buffer in one read only
+ * when that range isn't already there. Returns NULL past EOF or if len
+ * exceeds the buffer. Don't write through the pointer; writing the file
+ * empties the view. Refills move the file position. */
+__attribute__((import_module("env"), import_name("file_map")))
+int file_map(int handle, void *buf, int buf_len);
+
+__attribute__((import_module("env"), import_name("file_map_get")))
+const void *file_map_get(int handle, int offset, int len);
+
+__attribute__((import_module("env"), import_name("file_unmap")))
+void file_unmap(int handle);
+
 /* ---- Path-based operations (no open handle required) ---- */
 
 __attribute__((import_module("env"), import_name("file_stat")))
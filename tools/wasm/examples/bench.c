@@ -1,10 +1,12 @@
 /**
  * bench.c — WASM VM benchmark for ConeZ
  *
- * Three tests:
+ * Five tests:
  *   1. Prime sieve (computation speed)
  *   2. Memory write throughput
  *   3. Memory read throughput
+ *   4. Fill + copy + overlapping move with byte loops
+ *   5. The same with memset/memcpy/memmove (memory.fill / memory.copy)
  *
  * Reports milliseconds elapsed for each test. Run on old vs new firmware
  * to compare DRAM vs PSRAM linear memory performance.
@@ -21,6 +23,11 @@ static unsigned char sieve[SIEVE_SIZE];
 #define MEM_BUF_SIZE 1024
 static unsigned char membuf[MEM_BUF_SIZE];
 
+/* On PSRAM builds bulk_a straddles the 4KB DRAM window, bulk_b is past it */
+#define BULK_SIZE 4096
+static unsigned char bulk_a[BULK_SIZE];
+static unsigned char bulk_b[BULK_SIZE];
+
 /* --- Test 1: Prime sieve --- */
 static int count_primes(void)
 {
@@ -28,8 +35,7 @@ static int count_primes(void)
     int j;
     int count = 0;
 
-    for (i = 0; i < SIEVE_SIZE; i++)
-        sieve[i] = 0;
+    memset(sieve, 0, SIEVE_SIZE);
 
     sieve[0] = 1;
     sieve[1] = 1;
@@ -72,6 +78,48 @@ static int mem_read_test(void)
     return sum;
 }
 
+static int bulk_checksum(void)
+{
+    int i;
+    int sum = 0;
+
+    for (i = 0; i < BULK_SIZE; i++)
+        sum = sum * 31 + bulk_b[i];
+    return sum;
+}
+
+/* --- Test 4: Fill, copy and a one-byte overlapping move, byte by byte --- */
+static int bulk_loop_test(void)
+{
+    int pass;
+    int i;
+
+    for (pass = 0; pass < 100; pass++) {
+        for (i = 0; i < BULK_SIZE; i++)
+            bulk_a[i] = (unsigned char)pass;
+        bulk_a[pass] = 0xFF;
+        for (i = 0; i < BULK_SIZE; i++)
+            bulk_b[i] = bulk_a[i];
+        for (i = BULK_SIZE - 1; i > 0; i--)
+            bulk_b[i] = bulk_b[i - 1];
+    }
+    return bulk_checksum();
+}
+
+/* --- Test 5: The same with bulk-memory ops --- */
+static int bulk_mem_test(void)
+{
+    int pass;
+
+    for (pass = 0; pass < 100; pass++) {
+        memset(bulk_a, pass, BULK_SIZE);
+        bulk_a[pass] = 0xFF;
+        memcpy(bulk_b, bulk_a, BULK_SIZE);
+        memmove(bulk_b + 1, bulk_b, BULK_SIZE - 1);
+    }
+    return bulk_checksum();
+}
+
 void setup(void)
 {
     int t0;
@@ -103,6 +151,19 @@ void setup(void)
     t1 = millis();
     printf("   Checksum: %d, Time: %d ms\n\n", result, t1 - t0);
 
+    /* Bulk: 4KB fill + 4KB copy + 4KB move, x 100 */
+    printf("4. Fill/copy/move, byte loops (4KB x 100)...\n");
+    t0 = millis();
+    result = bulk_loop_test();
+    t1 = millis();
+    printf("   Checksum: %d, Time: %d ms\n\n", result, t1 - t0);
+
+    printf("5. Fill/copy/move, memset/memcpy/memmove (4KB x 100)...\n");
+    t0 = millis();
+    result = bulk_mem_test();
+    t1 = millis();
+    printf("   Checksum: %d, Time: %d ms\n\n", result, t1 - t0);
+
     printf("=== Done ===\n");
 }
 
@@ -0,0 +1,61 @@
+/**
+ * gradient_wave.wasm — Two triangle waves blended across the strip.
+ *
+ * Renders each frame into a local RGB buffer with a handful of small
+ * static helpers (clamp, lerp, wave, pixel packer) — the shape most
+ * effects take — then hands the whole frame to the host at once.
+ *
+ * Demonstrates: led_set_buffer, led_show, delay_ms.
+ *
+ * Build:
+ *   cd tools/wasm
+ *   make
+ */
+
+#include <conez_api.h>
+
+#define NUM_LEDS    150
+#define FRAME_BYTES 450         /* NUM_LEDS * 3; array sizes must be literal */
+
+static uint8_t frame[FRAME_BYTES];
+static int t = 0;
+
+static inline int clamp8(int v) {
+    if (v < 0) return 0;
+    if (v > 255) return 255;
+    return v;
+}
+
+static int lerp8(int a, int b, int f) {
+    return a + (((b - a) * f) >> 8);
+}
+
+/* 0..255..0 over 512 steps */
+static int tri8(int x) {
+    x &= 511;
+    return x < 256 ? x : 511 - x;
+}
+
+static void put_rgb(int i, int r, int g, int b) {
+    frame[i * 3]     = r;
+    frame[i * 3 + 1] = g;
+    frame[i * 3 + 2] = b;
+}
+
+void setup(void) {
+    print("gradient_wave: starting\n");
+}
+
+void loop(void) {
+    for (int i = 0; i < NUM_LEDS; i++) {
+        int w = tri8(i * 8 + t);
+        int r = lerp8(20, 255, w);
+        int g = lerp8(0, 120, tri8(i * 3 - t));
+        int b = clamp8(230 - w - (w >> 2));
+        put_rgb(i, r, g, b);
+    }
+    led_set_buffer(1, frame, NUM_LEDS);
+    led_show();
+    t += 4;
+    delay_ms(20);
+}